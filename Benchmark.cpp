@@ -0,0 +1,719 @@
+// Benchmark.cpp : implementation of the CBenchmark class
+//
+// Run "Tulip.exe /benchmark results.csv" to time loading, saving,
+// undo snapshots, hit-testing, link adjustment, export, previews and
+// layout on generated UML, flowchart, network and dialog diagrams. Sizes
+// can follow the file name, "Tulip.exe /benchmark results.csv 100
+// 1000". No windows are created. Each line of the results is
+// "suite,operation,size,iterations,total_ms,mean_us", so runs can
+// be compared by a script.
+//
+// The memory breakdown of each diagram, with a full undo stack, is
+// written next to the results, to "results-memory.csv". It also
+// has the objects still allocated from the object pools after each
+// suite has deleted its documents, which should all be 0; anything
+// else is a leak in a clone path. The blocks the pools still hold
+// then should also be 0, as clearing a container releases them.
+//
+// Build with "DIAGRAM_NO_POOL" defined to allocate the pooled classes
+// from the heap, and compare "load", "snapshot" and "clear_undo".
+//
+// The "header" suite times the c++ header import on a generated
+// header of one class per size unit. Its "corpus" line in the memory
+// breakdown has the tokens and bytes of the header, so throughput is
+// bytes or tokens over the "lex" and "parse" times.
+//
+// The layout, router, header parsing, undo compression, bounds array
+// and object pool timings come from "CEngineBenchmark", which is also
+// built without MFC as the portable "EngineBenchmark".
+//
+// "Tulip.exe /render diagram image.png" draws a saved diagram with
+// the software renderer and writes it as a PNG, also without any
+// windows, so drawing can be checked against a reference image.
+
+#include "stdafx.h"
+#include "Tulip.h"
+#include "Benchmark.h"
+
+#include "UmlDoc.h"
+#include "FlowchartDoc.h"
+#include "NetDoc.h"
+#include "DialogEditorDoc.h"
+#include "TextFile/TextFile.h"
+#include "DiagramEditor/DiagramRasterRenderer.h"
+#include "DiagramEditor/DiagramThumbnail.h"
+#include "DiagramEditor/RasterExport.h"
+#include "DiagramEditor/VectorExport.h"
+#include "Portable/EngineBenchmark.h"
+
+#include "UMLEditor/Attribute.h"
+#include "UMLEditor/Operation.h"
+#include "UMLEditor/UMLLineSegment.h"
+#include "UMLEditor/HeaderImport.h"
+#include "DiskObject/DiskObject.h"
+
+#ifdef _DEBUG
+#define new DEBUG_NEW
+#endif
+
+// Default diagram sizes
+static const int defaultSizes[] = { 100, 1000, 5000 };
+
+#define BENCHMARK_REPEAT		5		// Load, save and export runs
+#define BENCHMARK_SNAPSHOTS		16		// Undo snapshots, twice the levels kept in memory
+#define BENCHMARK_HITS			1000	// Hit-tested points
+#define BENCHMARK_ADJUSTS		100		// Classes moved for link adjustment
+#define BENCHMARK_RENDER_SIZE	4096	// Largest side of the rendered canvas
+
+// Generated UML diagrams
+#define UML_MEMBERS				8		// Attributes and operations of each class
+#define UML_CLASSES_PER_PACKAGE	100		// One package for each of these classes
+#define UML_SPACING				48		// Space between classes
+
+// Generated headers
+#define HEADER_CLASSES_PER_FILE	50		// Classes in each file of the imported folder
+
+/////////////////////////////////////////////////////////////////////////////
+// CBenchmarkCommandLineInfo
+
+CBenchmarkCommandLineInfo::CBenchmarkCommandLineInfo()
+{
+	m_benchmark = FALSE;
+	m_record = FALSE;
+	m_replay = FALSE;
+	m_render = FALSE;
+}
+
+// Picks out "/benchmark", "/record", "/replay" and "/render" with
+// the files and sizes after them. The diagram to open comes first,
+// and is left to the standard command line, except for "/render"
+// which takes the diagram after it.
+void CBenchmarkCommandLineInfo::ParseParam(const TCHAR* pszParam, BOOL bFlag, BOOL /*bLast*/)
+{
+	if (bFlag)
+	{
+		if (lstrcmpi(pszParam, _T("benchmark")) == 0)
+			m_benchmark = TRUE;
+		else if (lstrcmpi(pszParam, _T("record")) == 0)
+			m_record = TRUE;
+		else if (lstrcmpi(pszParam, _T("replay")) == 0)
+			m_replay = TRUE;
+		else if (lstrcmpi(pszParam, _T("render")) == 0)
+			m_render = TRUE;
+	}
+	else if (m_render)
+	{
+		if (m_input.IsEmpty())
+			m_input = pszParam;
+		else if (m_output.IsEmpty())
+			m_output = pszParam;
+	}
+	else if (m_record || m_replay)
+	{
+		if (m_trace.IsEmpty())
+			m_trace = pszParam;
+		else if (m_replay && m_output.IsEmpty())
+			m_output = pszParam;
+	}
+	else if (m_benchmark)
+	{
+		if (m_output.IsEmpty())
+			m_output = pszParam;
+		else if (_ttoi(pszParam) > 0)
+			m_sizes.Add(_ttoi(pszParam));
+	}
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CBenchmark construction/destruction
+
+CBenchmark::CBenchmark()
+{
+	m_repeat = BENCHMARK_REPEAT;
+	m_seed = 1;
+	::QueryPerformanceFrequency(&m_frequency);
+	m_start.QuadPart = 0;
+}
+
+CBenchmark::~CBenchmark()
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CBenchmark operations
+
+// Runs all suites at each size, and writes the results to "filename".
+BOOL CBenchmark::Run(const CString& filename, const CDWordArray& sizes)
+{
+	CDWordArray run;
+	run.Copy(sizes);
+	if (run.GetSize() == 0)
+	{
+		for (int t = 0; t < _countof(defaultSizes); t++)
+			run.Add(defaultSizes[t]);
+	}
+
+	m_results.RemoveAll();
+	m_results.Add(_T("suite,operation,size,iterations,total_ms,mean_us"));
+	m_memory.RemoveAll();
+	m_memory.Add(_T("suite,stage,size,category,item,count,bytes,storage"));
+
+	INT_PTR max = run.GetSize();
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		int size = static_cast<int>(run[t]);
+		RunUML(size);
+		RunFlowchart(size);
+		RunNetwork(size);
+		RunDialog(size);
+		RunHeader(size);
+	}
+
+	CEngineBenchmark engine;
+	engine.SetRepeat(m_repeat);
+	engine.Run(run, m_results);
+
+	CTextFile file(_T(""), _T("\r\n"));
+	CString output(filename);
+	if (!file.WriteTextFile(output, m_results))
+		return FALSE;
+
+	// "results.csv" gives "results-memory.csv"
+	CString memory(filename);
+	int dot = memory.ReverseFind(_T('.'));
+	if (dot > memory.ReverseFind(_T('\\')))
+		memory.Insert(dot, _T("-memory"));
+	else
+		memory += _T("-memory.csv");
+
+	return file.WriteTextFile(memory, m_memory);
+}
+
+// Sets how many times load, save and export are run.
+void CBenchmark::SetRepeat(int repeat)
+{
+	m_repeat = max(1, repeat);
+}
+
+// Gets how many times load, save and export are run.
+int CBenchmark::GetRepeat() const
+{
+	return m_repeat;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CBenchmark generators
+
+// Generates a UML diagram, see "CEngineBenchmark::GenerateUML".
+void CBenchmark::GenerateUML(CUMLEntityContainer& objs, int classes, int members, int packages)
+{
+	CEngineBenchmark::GenerateUML(objs, classes, members, packages);
+}
+
+// Generates a flowchart, see "CEngineBenchmark::GenerateFlowchart".
+void CBenchmark::GenerateFlowchart(CFlowchartEntityContainer& objs, int steps)
+{
+	CEngineBenchmark::GenerateFlowchart(objs, steps);
+}
+
+// Generates a network, see "CEngineBenchmark::GenerateNetwork".
+void CBenchmark::GenerateNetwork(CNetworkEntityContainer& objs, int symbols)
+{
+	CEngineBenchmark::GenerateNetwork(objs, symbols);
+}
+
+// Generates a dialog, see "CEngineBenchmark::GenerateDialog".
+void CBenchmark::GenerateDialog(CDiagramEntityContainer& objs, int controls)
+{
+	CEngineBenchmark::GenerateDialog(objs, controls);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CBenchmark rendering
+
+// Draws "objs" at 100% with the software renderer, on a canvas
+// covering the paper and every object, and saves it to "filename".
+BOOL CBenchmark::SavePNG(CDiagramEntityContainer* objs, const CString& filename)
+{
+	const CBoundsArray* bounds = objs->GetBounds();
+	CSize size = objs->GetVirtualSize();
+	int width = max(size.cx, static_cast<int>(bounds->GetMax(BOUNDS_RIGHT, 0)) + 1);
+	int height = max(size.cy, static_cast<int>(bounds->GetMax(BOUNDS_BOTTOM, 0)) + 1);
+
+	CDiagramRasterRenderer renderer;
+	if (!renderer.Create(width, height, objs->GetColor()))
+		return FALSE;
+
+	objs->RenderObjects(&renderer, 1.0);
+	return renderer.SavePNG(filename);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CBenchmark suites
+
+// UML diagrams, with link adjustment and layered layout.
+void CBenchmark::RunUML(int size)
+{
+	LPCTSTR suite = _T("uml");
+	CUmlDoc* doc = static_cast<CUmlDoc*>(RUNTIME_CLASS(CUmlDoc)->CreateObject());
+	CUmlDoc* copy = static_cast<CUmlDoc*>(RUNTIME_CLASS(CUmlDoc)->CreateObject());
+	CUMLEntityContainer* objs = doc->GetData();
+	GenerateUML(*objs, size, UML_MEMBERS, size / UML_CLASSES_PER_PACKAGE);
+
+	TimeSerialize(suite, doc, copy, size);
+	TimeSnapshot(suite, objs, size);
+	TimeHitTest(suite, objs, size);
+	TimeExport(suite, objs, EXPORT_HTML, size);
+	TimeRender(suite, objs, size);
+	TimeThumbnail(suite, objs, size);
+
+	// Drag classes at the top level vertically, so their lines get bends
+	CObArray moved;
+	INT_PTR max = objs->GetSize();
+	for (INT_PTR t = 0; t < max && moved.GetSize() < BENCHMARK_ADJUSTS; t++)
+	{
+		CUMLEntityClass* obj = dynamic_cast<CUMLEntityClass*>(objs->GetObjectAt(t));
+		if (obj && obj->GetPackage().IsEmpty())
+			moved.Add(obj);
+	}
+
+	int adjusts = static_cast<int>(moved.GetSize());
+	StartTimer();
+	for (int t = 0; t < adjusts; t++)
+	{
+		CUMLEntity* obj = static_cast<CUMLEntity*>(moved[t]);
+		obj->MoveRect(0, UML_SPACING / 2);
+		objs->AdjustLinkedObjects(obj);
+	}
+	StopTimer(suite, _T("link_adjust"), size, adjusts);
+
+	StartTimer();
+	objs->AutoLayout();
+	StopTimer(suite, _T("auto_layout"), size, 1);
+
+	delete copy;
+	delete doc;
+
+	RecordPools(suite, size);
+}
+
+// Flowcharts, with layered layout.
+void CBenchmark::RunFlowchart(int size)
+{
+	LPCTSTR suite = _T("flowchart");
+	CFlowchartDoc* doc = static_cast<CFlowchartDoc*>(RUNTIME_CLASS(CFlowchartDoc)->CreateObject());
+	CFlowchartDoc* copy = static_cast<CFlowchartDoc*>(RUNTIME_CLASS(CFlowchartDoc)->CreateObject());
+	CFlowchartEntityContainer* objs = doc->GetData();
+	GenerateFlowchart(*objs, size);
+
+	TimeSerialize(suite, doc, copy, size);
+	TimeSnapshot(suite, objs, size);
+	TimeHitTest(suite, objs, size);
+	TimeExport(suite, objs, 0, size);
+	TimeRender(suite, objs, size);
+	TimeThumbnail(suite, objs, size);
+
+	StartTimer();
+	objs->AutoLayout();
+	StopTimer(suite, _T("auto_layout"), size, 1);
+
+	delete copy;
+	delete doc;
+
+	RecordPools(suite, size);
+}
+
+// Network diagrams, with force directed layout.
+void CBenchmark::RunNetwork(int size)
+{
+	LPCTSTR suite = _T("network");
+	CNetDoc* doc = static_cast<CNetDoc*>(RUNTIME_CLASS(CNetDoc)->CreateObject());
+	CNetDoc* copy = static_cast<CNetDoc*>(RUNTIME_CLASS(CNetDoc)->CreateObject());
+	CNetworkEntityContainer* objs = doc->GetData();
+	GenerateNetwork(*objs, size);
+
+	TimeSerialize(suite, doc, copy, size);
+	TimeSnapshot(suite, objs, size);
+	TimeHitTest(suite, objs, size);
+	TimeExport(suite, objs, 0, size);
+	TimeRender(suite, objs, size);
+	TimeThumbnail(suite, objs, size);
+
+	StartTimer();
+	objs->AutoLayout();
+	StopTimer(suite, _T("auto_layout"), size, 1);
+
+	delete copy;
+	delete doc;
+
+	RecordPools(suite, size);
+}
+
+// Dialog templates.
+void CBenchmark::RunDialog(int size)
+{
+	LPCTSTR suite = _T("dialog");
+	CDialogEditorDoc* doc = static_cast<CDialogEditorDoc*>(RUNTIME_CLASS(CDialogEditorDoc)->CreateObject());
+	CDialogEditorDoc* copy = static_cast<CDialogEditorDoc*>(RUNTIME_CLASS(CDialogEditorDoc)->CreateObject());
+	CDiagramEntityContainer* objs = doc->GetData();
+	GenerateDialog(*objs, size);
+
+	TimeSerialize(suite, doc, copy, size);
+	TimeSnapshot(suite, objs, size);
+	TimeHitTest(suite, objs, size);
+	TimeExport(suite, objs, 0, size);
+	TimeRender(suite, objs, size);
+	TimeThumbnail(suite, objs, size);
+
+	delete copy;
+	delete doc;
+
+	RecordPools(suite, size);
+}
+
+// Header import. A generated header of "size" classes is written as
+// files to a temporary folder, which is imported on one thread and on
+// one thread per processor. The classes are finally added to a
+// diagram.
+void CBenchmark::RunHeader(int size)
+{
+	LPCTSTR suite = _T("header");
+	CString text;
+	CEngineBenchmark::GenerateHeader(text, 0, size, UML_MEMBERS);
+
+	// "lex" and "parse" are timed by "CEngineBenchmark"
+	CHeaderParser parser;
+	parser.Parse(text, text.GetLength());
+
+	// The corpus is ASCII, so its length is its size as a file
+	CString line;
+	line.Format(_T("%s,corpus,%i,Header,Tokens,%i,%I64u,disk"), suite, size, parser.GetTokenCount(),
+		static_cast<ULONGLONG>(text.GetLength()));
+	m_memory.Add(line);
+
+	TCHAR path[MAX_PATH];
+	if (!::GetTempPath(MAX_PATH, path))
+		return;
+
+	CString folder(path);
+	folder += _T("tlpheaders");
+	CDiskObject disk;
+	disk.RemoveDirectories(folder);
+	if (!disk.CreateDirectory(folder))
+		return;
+
+	CTextFile file(_T(""), _T("\r\n"));
+	for (int t = 0; t < size; t += HEADER_CLASSES_PER_FILE)
+	{
+		CString contents;
+		CEngineBenchmark::GenerateHeader(contents, t, min(HEADER_CLASSES_PER_FILE, size - t), UML_MEMBERS);
+		CString filename;
+		filename.Format(_T("%s\\Class%i.h"), static_cast<LPCTSTR>(folder), t + 1);
+		file.WriteTextFile(filename, contents);
+	}
+
+	CHeaderImport import;
+	import.SetThreadCount(1);
+	StartTimer();
+	import.Parse(folder);
+	StopTimer(suite, _T("import_folder_1"), size, 1);
+
+	import.SetThreadCount(0);
+	StartTimer();
+	import.Parse(folder);
+	StopTimer(suite, _T("import_folder"), size, 1);
+
+	CUmlDoc* doc = static_cast<CUmlDoc*>(RUNTIME_CLASS(CUmlDoc)->CreateObject());
+	StartTimer();
+	doc->GetData()->ImportFolder(import);
+	StopTimer(suite, _T("import_diagram"), size, 1);
+
+	delete doc;
+	disk.RemoveDirectories(folder);
+
+	RecordPools(suite, size);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CBenchmark common operations
+
+// Saves "doc" to memory through its "Serialize", then loads the
+// result into "copy".
+void CBenchmark::TimeSerialize(LPCTSTR suite, CDocument* doc, CDocument* copy, int size)
+{
+	CMemFile file;
+
+	StartTimer();
+	for (int t = 0; t < m_repeat; t++)
+	{
+		file.SetLength(0);
+		CArchive ar(&file, CArchive::store);
+		doc->Serialize(ar);
+		ar.Close();
+	}
+	StopTimer(suite, _T("save"), size, m_repeat);
+
+	StartTimer();
+	for (int t = 0; t < m_repeat; t++)
+	{
+		file.SeekToBegin();
+		CArchive ar(&file, CArchive::load);
+		copy->Serialize(ar);
+		ar.Close();
+	}
+	StopTimer(suite, _T("load"), size, m_repeat);
+}
+
+// Takes undo snapshots, more than are kept in memory.
+void CBenchmark::TimeSnapshot(LPCTSTR suite, CDiagramEntityContainer* objs, int size)
+{
+	StartTimer();
+	for (int t = 0; t < BENCHMARK_SNAPSHOTS; t++)
+		objs->Snapshot();
+	StopTimer(suite, _T("snapshot"), size, BENCHMARK_SNAPSHOTS);
+
+	RecordMemory(suite, _T("snapshots"), objs, size);
+
+	StartTimer();
+	objs->ClearUndo();
+	StopTimer(suite, _T("clear_undo"), size, 1);
+}
+
+// Hit-tests random points, first by testing every object as the
+// editor does on a click, then through the bounds array.
+void CBenchmark::TimeHitTest(LPCTSTR suite, CDiagramEntityContainer* objs, int size)
+{
+	const CBoundsArray* bounds = objs->GetBounds();
+	int right = static_cast<int>(bounds->GetMax(BOUNDS_RIGHT, 0)) + 1;
+	int bottom = static_cast<int>(bounds->GetMax(BOUNDS_BOTTOM, 0)) + 1;
+
+	CArray< CPoint, CPoint > points;
+	points.SetSize(BENCHMARK_HITS);
+	for (int t = 0; t < BENCHMARK_HITS; t++)
+		points[t] = CPoint(Random(right), Random(bottom));
+
+	StartTimer();
+	for (int t = 0; t < BENCHMARK_HITS; t++)
+	{
+		int count = 0;
+		CDiagramEntity* obj;
+		while ((obj = objs->GetAt(count++)))
+		{
+			if (obj->GetHitCode(points[t]) == DEHT_BODY)
+				break;
+		}
+	}
+	StopTimer(suite, _T("hit_test_scan"), size, BENCHMARK_HITS);
+
+	CDWordArray indices;
+	StartTimer();
+	for (int t = 0; t < BENCHMARK_HITS; t++)
+	{
+		bounds = objs->GetBounds();
+		INT_PTR max = bounds->GetContaining(points[t].x, points[t].y, indices);
+		for (INT_PTR i = 0; i < max; i++)
+		{
+			CDiagramEntity* obj = objs->GetAt(indices[i]);
+			if (obj && obj->GetHitCode(points[t]) == DEHT_BODY)
+				break;
+		}
+	}
+	StopTimer(suite, _T("hit_test_bounds"), size, BENCHMARK_HITS);
+
+	// Nudges, each followed by a hit-test, as when dragging. A moved
+	// object updates its own rectangle, so this should cost about the
+	// same as "hit_test_bounds", not a rebuild of the array per move.
+	// Each object is moved and moved back.
+	INT_PTR count = objs->GetSize();
+	StartTimer();
+	for (int t = 0; t < BENCHMARK_HITS && count; t++)
+	{
+		CDiagramEntity* obj = objs->GetAt((t / 2) % count);
+		obj->MoveRect(t % 2 ? -1 : 1, 0);
+		objs->SetModified(TRUE);
+
+		bounds = objs->GetBounds();
+		INT_PTR max = bounds->GetContaining(points[t].x, points[t].y, indices);
+		for (INT_PTR i = 0; i < max; i++)
+		{
+			CDiagramEntity* hit = objs->GetAt(indices[i]);
+			if (hit && hit->GetHitCode(points[t]) == DEHT_BODY)
+				break;
+		}
+	}
+	StopTimer(suite, _T("move_hit_test"), size, BENCHMARK_HITS);
+}
+
+// Exports the diagram to a string array.
+void CBenchmark::TimeExport(LPCTSTR suite, CDiagramEntityContainer* objs, UINT format, int size)
+{
+	StartTimer();
+	for (int t = 0; t < m_repeat; t++)
+	{
+		CStringArray stra;
+		objs->Export(stra, format);
+	}
+	StopTimer(suite, _T("export"), size, m_repeat);
+}
+
+// Draws the preview saved with the diagram. Saving again without a
+// change keeps the preview, which should only cost a comparison.
+void CBenchmark::TimeThumbnail(LPCTSTR suite, CDiagramEntityContainer* objs, int size)
+{
+	CDiagramThumbnail thumbnail;
+	StartTimer();
+	for (int t = 0; t < m_repeat; t++)
+		thumbnail.Create(objs->GetData());
+	StopTimer(suite, _T("thumbnail"), size, m_repeat);
+
+	thumbnail.Update(objs);
+	StartTimer();
+	for (int t = 0; t < m_repeat; t++)
+		thumbnail.Update(objs);
+	StopTimer(suite, _T("thumbnail_cached"), size, m_repeat);
+}
+
+// Draws the diagram with the software renderer, scaled down so the
+// canvas is at most "BENCHMARK_RENDER_SIZE" on its longest side, and
+// encodes the result as a PNG. Then exports it at full size in tiles,
+// on one thread and on one thread per processor, and to SVG and PDF.
+void CBenchmark::TimeRender(LPCTSTR suite, CDiagramEntityContainer* objs, int size)
+{
+	const CBoundsArray* bounds = objs->GetBounds();
+	double right = bounds->GetMax(BOUNDS_RIGHT, 0) + 1.0;
+	double bottom = bounds->GetMax(BOUNDS_BOTTOM, 0) + 1.0;
+	double zoom = min(1.0, BENCHMARK_RENDER_SIZE / max(right, bottom));
+
+	CDiagramRasterRenderer renderer;
+	if (!renderer.Create(static_cast<int>(right * zoom) + 1, static_cast<int>(bottom * zoom) + 1, objs->GetColor()))
+		return;
+
+	StartTimer();
+	for (int t = 0; t < m_repeat; t++)
+	{
+		renderer.Clear(objs->GetColor());
+		renderer.Reset();
+		objs->RenderObjects(&renderer, zoom);
+	}
+	StopTimer(suite, _T("render"), size, m_repeat);
+
+	TCHAR path[MAX_PATH];
+	TCHAR filename[MAX_PATH];
+	if (!::GetTempPath(MAX_PATH, path) || !::GetTempFileName(path, _T("tlp"), 0, filename))
+		return;
+
+	StartTimer();
+	renderer.SavePNG(filename);
+	StopTimer(suite, _T("render_png"), size, 1);
+
+	CSize full(static_cast<int>(right), static_cast<int>(bottom));
+	CRasterExport tiled;
+	tiled.SetThreadCount(1);
+	StartTimer();
+	tiled.Export(objs, filename, full, 1.0, RGB(255, 255, 255));
+	StopTimer(suite, _T("export_png_1"), size, 1);
+
+	tiled.SetThreadCount(0);
+	StartTimer();
+	tiled.Export(objs, filename, full, 1.0, RGB(255, 255, 255));
+	StopTimer(suite, _T("export_png"), size, 1);
+
+	CVectorExport vector;
+	StartTimer();
+	vector.ExportSVG(objs, filename, full, 1.0, RGB(255, 255, 255));
+	StopTimer(suite, _T("export_svg"), size, 1);
+
+	StartTimer();
+	vector.ExportPDF(objs, filename, full, 1.0);
+	StopTimer(suite, _T("export_pdf"), size, 1);
+
+	::DeleteFile(filename);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CBenchmark timing
+
+// Starts timing an operation.
+void CBenchmark::StartTimer()
+{
+	::QueryPerformanceCounter(&m_start);
+}
+
+// Stops timing an operation, and adds a result line.
+void CBenchmark::StopTimer(LPCTSTR suite, LPCTSTR operation, int size, int iterations)
+{
+	LARGE_INTEGER stop;
+	::QueryPerformanceCounter(&stop);
+
+	double total = static_cast<double>(stop.QuadPart - m_start.QuadPart) * 1000.0 / static_cast<double>(m_frequency.QuadPart);
+	double mean = iterations ? total * 1000.0 / iterations : 0.0;
+
+	CString line;
+	line.Format(_T("%s,%s,%i,%i,%.3f,%.3f"), suite, operation, size, iterations, total, mean);
+	m_results.Add(line);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CBenchmark memory
+
+// Adds the memory breakdown of "objs" to the memory lines.
+void CBenchmark::RecordMemory(LPCTSTR suite, LPCTSTR stage, CDiagramEntityContainer* objs, int size)
+{
+	CDiagramMemoryUsage usage;
+	objs->GetMemoryUsage(usage);
+
+	INT_PTR max = usage.GetSize();
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		CString line;
+		line.Format(_T("%s,%s,%i,%s,%s,%Id,%I64u,%s"), suite, stage, size,
+			static_cast<LPCTSTR>(usage.GetCategory(t)),
+			static_cast<LPCTSTR>(usage.GetItem(t)),
+			usage.GetCount(t),
+			usage.GetBytes(t),
+			usage.IsDisk(t) ? _T("disk") : _T("memory"));
+		m_memory.Add(line);
+	}
+}
+
+// Adds the objects still allocated from the object pools. Called
+// when a suite has deleted its documents, so they should all be 0.
+void CBenchmark::RecordPools(LPCTSTR suite, int size)
+{
+	struct
+	{
+		LPCTSTR				name;
+		const CObjectPool*	pool;
+	} pools[] =
+	{
+		{ _T("CUMLEntityClass"), &CUMLEntityClass::s_pool },
+		{ _T("CUMLLineSegment"), &CUMLLineSegment::s_pool },
+		{ _T("CAttribute"), &CAttribute::s_pool },
+		{ _T("COperation"), &COperation::s_pool },
+		{ _T("CParameter"), &CParameter::s_pool },
+		{ _T("CProperty"), &CProperty::s_pool },
+		{ _T("CFlowchartLink"), &CFlowchartLink::s_pool },
+	};
+
+	for (int t = 0; t < _countof(pools); t++)
+	{
+		INT_PTR live = pools[t].pool->GetLiveCount();
+		CString line;
+		line.Format(_T("%s,deleted,%i,Pools,%s,%Id,%I64u,memory"), suite, size, pools[t].name, live,
+			static_cast<ULONGLONG>(live) * pools[t].pool->GetAllocSize());
+		m_memory.Add(line);
+
+		INT_PTR blocks = pools[t].pool->GetBlockCount();
+		line.Format(_T("%s,deleted,%i,Pool blocks,%s,%Id,%I64u,memory"), suite, size, pools[t].name, blocks,
+			static_cast<ULONGLONG>(blocks) * pools[t].pool->GetBlockSize() * pools[t].pool->GetAllocSize());
+		m_memory.Add(line);
+	}
+}
+
+// Gets a number from 0 to "range" - 1. The sequence is the same
+// for every run, so results can be compared.
+int CBenchmark::Random(int range)
+{
+	m_seed = m_seed * 1103515245 + 12345;
+	return range > 0 ? static_cast<int>((m_seed >> 16) % static_cast<UINT>(range)) : 0;
+}
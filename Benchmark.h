@@ -0,0 +1,82 @@
+// Benchmark.h : interface of the CBenchmark class
+//
+
+#pragma once
+
+#include "UMLEditor/UMLEntityContainer.h"
+#include "FlowchartEditor/FlowchartEntityContainer.h"
+#include "NetworkEditor/NetworkEntityContainer.h"
+
+// Command line for "Tulip.exe /benchmark results.csv [size...]",
+// "Tulip.exe diagram /record trace.txt",
+// "Tulip.exe diagram /replay trace.txt results.csv" and
+// "Tulip.exe /render diagram image.png"
+class CBenchmarkCommandLineInfo : public CCommandLineInfo
+{
+public:
+	CBenchmarkCommandLineInfo();
+	virtual void ParseParam(const TCHAR* pszParam, BOOL bFlag, BOOL bLast);
+
+	BOOL		m_benchmark;	// TRUE if "/benchmark" was given
+	BOOL		m_record;		// TRUE if "/record" was given
+	BOOL		m_replay;		// TRUE if "/replay" was given
+	BOOL		m_render;		// TRUE if "/render" was given
+	CString		m_input;		// Diagram to render
+	CString		m_trace;		// Trace to record to or replay
+	CString		m_output;		// File to write the results to
+	CDWordArray	m_sizes;		// Diagram sizes, empty for the defaults
+};
+
+// Times the diagram models on generated documents, without any windows
+class CBenchmark
+{
+public:
+	CBenchmark();
+	virtual ~CBenchmark();
+
+	// Operations
+	BOOL Run(const CString& filename, const CDWordArray& sizes);
+	void SetRepeat(int repeat);
+	int GetRepeat() const;
+
+	// Generators
+	static void GenerateUML(CUMLEntityContainer& objs, int classes, int members, int packages);
+	static void GenerateFlowchart(CFlowchartEntityContainer& objs, int steps);
+	static void GenerateNetwork(CNetworkEntityContainer& objs, int symbols);
+	static void GenerateDialog(CDiagramEntityContainer& objs, int controls);
+
+	// Rendering
+	static BOOL SavePNG(CDiagramEntityContainer* objs, const CString& filename);
+
+private:
+	// Suites
+	void RunUML(int size);
+	void RunFlowchart(int size);
+	void RunNetwork(int size);
+	void RunDialog(int size);
+	void RunHeader(int size);
+
+	// Operations common to all diagrams
+	void TimeSerialize(LPCTSTR suite, CDocument* doc, CDocument* copy, int size);
+	void TimeSnapshot(LPCTSTR suite, CDiagramEntityContainer* objs, int size);
+	void TimeHitTest(LPCTSTR suite, CDiagramEntityContainer* objs, int size);
+	void TimeExport(LPCTSTR suite, CDiagramEntityContainer* objs, UINT format, int size);
+	void TimeRender(LPCTSTR suite, CDiagramEntityContainer* objs, int size);
+	void TimeThumbnail(LPCTSTR suite, CDiagramEntityContainer* objs, int size);
+
+	// Memory
+	void RecordMemory(LPCTSTR suite, LPCTSTR stage, CDiagramEntityContainer* objs, int size);
+	void RecordPools(LPCTSTR suite, int size);
+
+	// Timing
+	void StartTimer();
+	void StopTimer(LPCTSTR suite, LPCTSTR operation, int size, int iterations);
+	int Random(int range);
+
+	int				m_repeat;		// Times to repeat load, save and export
+	LARGE_INTEGER	m_frequency;	// Performance counter frequency
+	LARGE_INTEGER	m_start;		// Performance counter at "StartTimer"
+	UINT			m_seed;			// Random number state, the same for every run
+	CStringArray	m_results;		// Result lines
+	CStringArray	m_memory;		// Memory breakdown lines
+};
@@ -0,0 +1,455 @@
+/* ==========================================================================
+	File :			BoundsArray.cpp
+
+	Class :			CBoundsArray
+
+	Date :			10/19/26
+
+	Purpose :		"CBoundsArray" keeps the rectangles of the objects in a
+					"CDiagramEntityContainer" as four separate, contiguous
+					arrays of left, top, right and bottom edges.
+
+	Description :	Calculating the total size of a diagram, or finding
+					the objects under a selection rubberband, normally
+					means visiting every object on the heap to read four
+					"double"s. With the edges stored one after the other,
+					the same calculations read memory in sequence, and
+					handle two rectangles at a time with SSE2 when the
+					compiler targets it (always the case for x64 builds,
+					and the default for Win32 since Visual C++ 2012, or
+					"__SSE2__" with other compilers).
+					A plain loop is used for the last rectangle, and for
+					other targets.
+
+					The edges are stored as "double", the same type as
+					in "CDiagramEntity", so the results are exactly the
+					same as when reading the objects.
+
+					Rectangles are not expected to be normalized. The
+					queries normalize each rectangle before testing it.
+
+	Usage :			"CDiagramEntityContainer" owns an array and keeps it
+					updated. Get it with
+					"CDiagramEntityContainer::GetBounds".
+
+   ========================================================================*/
+
+#include "stdafx.h"
+#include "BoundsArray.h"
+
+#if defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 ) || defined( __SSE2__ )
+#define BOUNDS_SSE2
+#include <emmintrin.h>
+#endif
+
+#ifdef _DEBUG
+#define new DEBUG_NEW
+#undef THIS_FILE
+static char THIS_FILE[] = __FILE__;
+#endif
+
+/////////////////////////////////////////////////////////////////////////////
+// CBoundsArray construction/destruction
+
+CBoundsArray::CBoundsArray()
+/* ============================================================
+	Function :		CBoundsArray::CBoundsArray
+	Description :	Constructor
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	m_data = NULL;
+	for (int t = 0; t < 4; t++)
+		m_edges[t] = NULL;
+
+	m_size = 0;
+	m_capacity = 0;
+
+}
+
+CBoundsArray::~CBoundsArray()
+/* ============================================================
+	Function :		CBoundsArray::~CBoundsArray
+	Description :	Destructor
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	delete[] m_data;
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CBoundsArray operations
+
+void CBoundsArray::SetSize(INT_PTR size)
+/* ============================================================
+	Function :		CBoundsArray::SetSize
+	Description :	Sets the number of rectangles in the array.
+	Access :		Public
+
+	Return :		void
+	Parameters :	INT_PTR size	-	New number of
+										rectangles.
+
+	Usage :			Call before setting the rectangles with
+					"SetAt". Existing rectangles are kept, new
+					rectangles are undefined. Throws a
+					"CMemoryException" if the memory could not
+					be allocated.
+
+   ============================================================*/
+{
+
+	ASSERT(size >= 0);
+
+	if (size > m_capacity)
+	{
+		INT_PTR capacity = max(size, m_capacity * 2);
+		double* data = new double[capacity * 4];
+
+		for (int edge = 0; edge < 4; edge++)
+		{
+			double* edges = data + capacity * edge;
+			if (m_size)
+				memcpy(edges, m_edges[edge], m_size * sizeof(double));
+			m_edges[edge] = edges;
+		}
+
+		delete[] m_data;
+		m_data = data;
+		m_capacity = capacity;
+	}
+
+	m_size = size;
+
+}
+
+void CBoundsArray::RemoveAll()
+/* ============================================================
+	Function :		CBoundsArray::RemoveAll
+	Description :	Empties the array.
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Call to remove all rectangles. The memory
+					is kept for reuse.
+
+   ============================================================*/
+{
+
+	m_size = 0;
+
+}
+
+void CBoundsArray::SetAt(INT_PTR index, double left, double top, double right, double bottom)
+/* ============================================================
+	Function :		CBoundsArray::SetAt
+	Description :	Sets the rectangle at "index".
+	Access :		Public
+
+	Return :		void
+	Parameters :	INT_PTR index	-	Index of the rectangle.
+					double left		-	Left edge
+					double top		-	Top edge
+					double right	-	Right edge
+					double bottom	-	Bottom edge
+
+	Usage :			Call to update a rectangle.
+
+   ============================================================*/
+{
+
+	ASSERT(index >= 0 && index < m_size);
+
+	m_edges[BOUNDS_LEFT][index] = left;
+	m_edges[BOUNDS_TOP][index] = top;
+	m_edges[BOUNDS_RIGHT][index] = right;
+	m_edges[BOUNDS_BOTTOM][index] = bottom;
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CBoundsArray queries
+
+double CBoundsArray::GetMin(int edge, double initial) const
+/* ============================================================
+	Function :		CBoundsArray::GetMin
+	Description :	Gets the smallest value of "edge" in the
+					array.
+	Access :		Public
+
+	Return :		double			-	The smallest value, or
+										"initial" if it is
+										smaller.
+	Parameters :	int edge		-	Edge to check, one of
+										the "BOUNDS_"-defines.
+					double initial	-	Start value.
+
+	Usage :			Call to get, for example, the leftmost
+					left edge. "initial" is returned if the
+					array is empty.
+
+   ============================================================*/
+{
+
+	ASSERT(edge >= BOUNDS_LEFT && edge <= BOUNDS_BOTTOM);
+
+	const double* values = m_edges[edge];
+	double result = initial;
+	INT_PTR t = 0;
+
+#ifdef BOUNDS_SSE2
+	__m128d acc = _mm_set1_pd(initial);
+	for (; t + 2 <= m_size; t += 2)
+		acc = _mm_min_pd(acc, _mm_loadu_pd(values + t));
+
+	double lanes[2];
+	_mm_storeu_pd(lanes, acc);
+	result = min(lanes[0], lanes[1]);
+#endif
+
+	for (; t < m_size; t++)
+		result = min(result, values[t]);
+
+	return result;
+
+}
+
+double CBoundsArray::GetMax(int edge, double initial) const
+/* ============================================================
+	Function :		CBoundsArray::GetMax
+	Description :	Gets the largest value of "edge" in the
+					array.
+	Access :		Public
+
+	Return :		double			-	The largest value, or
+										"initial" if it is
+										larger.
+	Parameters :	int edge		-	Edge to check, one of
+										the "BOUNDS_"-defines.
+					double initial	-	Start value.
+
+	Usage :			Call to get, for example, the rightmost
+					right edge. "initial" is returned if the
+					array is empty.
+
+   ============================================================*/
+{
+
+	ASSERT(edge >= BOUNDS_LEFT && edge <= BOUNDS_BOTTOM);
+
+	const double* values = m_edges[edge];
+	double result = initial;
+	INT_PTR t = 0;
+
+#ifdef BOUNDS_SSE2
+	__m128d acc = _mm_set1_pd(initial);
+	for (; t + 2 <= m_size; t += 2)
+		acc = _mm_max_pd(acc, _mm_loadu_pd(values + t));
+
+	double lanes[2];
+	_mm_storeu_pd(lanes, acc);
+	result = max(lanes[0], lanes[1]);
+#endif
+
+	for (; t < m_size; t++)
+		result = max(result, values[t]);
+
+	return result;
+
+}
+
+INT_PTR CBoundsArray::GetIntersecting(double left, double top, double right, double bottom, CDWordArray& indices) const
+/* ============================================================
+	Function :		CBoundsArray::GetIntersecting
+	Description :	Gets the rectangles touching a rectangle.
+	Access :		Public
+
+	Return :		INT_PTR				-	Number of rectangles
+											found.
+	Parameters :	double left			-	Left edge
+					double top			-	Top edge
+					double right		-	Right edge
+					double bottom		-	Bottom edge
+					CDWordArray& indices	-	Gets the indices of
+											the rectangles, in
+											order.
+
+	Usage :			Call to find candidates for a rectangle
+					test, for example for a selection
+					rubberband. Rectangles sharing an edge
+					with the test rectangle are included.
+
+   ============================================================*/
+{
+
+	indices.RemoveAll();
+
+	const double* lefts = m_edges[BOUNDS_LEFT];
+	const double* tops = m_edges[BOUNDS_TOP];
+	const double* rights = m_edges[BOUNDS_RIGHT];
+	const double* bottoms = m_edges[BOUNDS_BOTTOM];
+
+	double testLeft = min(left, right);
+	double testRight = max(left, right);
+	double testTop = min(top, bottom);
+	double testBottom = max(top, bottom);
+
+	INT_PTR t = 0;
+
+#ifdef BOUNDS_SSE2
+	__m128d vleft = _mm_set1_pd(testLeft);
+	__m128d vright = _mm_set1_pd(testRight);
+	__m128d vtop = _mm_set1_pd(testTop);
+	__m128d vbottom = _mm_set1_pd(testBottom);
+
+	for (; t + 2 <= m_size; t += 2)
+	{
+		__m128d l = _mm_loadu_pd(lefts + t);
+		__m128d r = _mm_loadu_pd(rights + t);
+		__m128d tp = _mm_loadu_pd(tops + t);
+		__m128d b = _mm_loadu_pd(bottoms + t);
+
+		__m128d horz = _mm_and_pd(_mm_cmple_pd(_mm_min_pd(l, r), vright), _mm_cmpge_pd(_mm_max_pd(l, r), vleft));
+		__m128d vert = _mm_and_pd(_mm_cmple_pd(_mm_min_pd(tp, b), vbottom), _mm_cmpge_pd(_mm_max_pd(tp, b), vtop));
+
+		int mask = _mm_movemask_pd(_mm_and_pd(horz, vert));
+		if (mask & 1)
+			indices.Add(static_cast<DWORD>(t));
+		if (mask & 2)
+			indices.Add(static_cast<DWORD>(t + 1));
+	}
+#endif
+
+	for (; t < m_size; t++)
+	{
+		if (min(lefts[t], rights[t]) <= testRight && max(lefts[t], rights[t]) >= testLeft &&
+			min(tops[t], bottoms[t]) <= testBottom && max(tops[t], bottoms[t]) >= testTop)
+			indices.Add(static_cast<DWORD>(t));
+	}
+
+	return indices.GetSize();
+
+}
+
+INT_PTR CBoundsArray::GetContaining(double x, double y, CDWordArray& indices) const
+/* ============================================================
+	Function :		CBoundsArray::GetContaining
+	Description :	Gets the rectangles containing a point.
+	Access :		Public
+
+	Return :		INT_PTR				-	Number of rectangles
+											found.
+	Parameters :	double x			-	x-coordinate
+					double y			-	y-coordinate
+					CDWordArray& indices	-	Gets the indices of
+											the rectangles, in
+											order.
+
+	Usage :			Call to find candidates for a hit test.
+					Points on the edges are included.
+
+   ============================================================*/
+{
+
+	indices.RemoveAll();
+
+	const double* lefts = m_edges[BOUNDS_LEFT];
+	const double* tops = m_edges[BOUNDS_TOP];
+	const double* rights = m_edges[BOUNDS_RIGHT];
+	const double* bottoms = m_edges[BOUNDS_BOTTOM];
+
+	INT_PTR t = 0;
+
+#ifdef BOUNDS_SSE2
+	__m128d vx = _mm_set1_pd(x);
+	__m128d vy = _mm_set1_pd(y);
+
+	for (; t + 2 <= m_size; t += 2)
+	{
+		__m128d l = _mm_loadu_pd(lefts + t);
+		__m128d r = _mm_loadu_pd(rights + t);
+		__m128d tp = _mm_loadu_pd(tops + t);
+		__m128d b = _mm_loadu_pd(bottoms + t);
+
+		__m128d horz = _mm_and_pd(_mm_cmple_pd(_mm_min_pd(l, r), vx), _mm_cmpge_pd(_mm_max_pd(l, r), vx));
+		__m128d vert = _mm_and_pd(_mm_cmple_pd(_mm_min_pd(tp, b), vy), _mm_cmpge_pd(_mm_max_pd(tp, b), vy));
+
+		int mask = _mm_movemask_pd(_mm_and_pd(horz, vert));
+		if (mask & 1)
+			indices.Add(static_cast<DWORD>(t));
+		if (mask & 2)
+			indices.Add(static_cast<DWORD>(t + 1));
+	}
+#endif
+
+	for (; t < m_size; t++)
+	{
+		if (min(lefts[t], rights[t]) <= x && max(lefts[t], rights[t]) >= x &&
+			min(tops[t], bottoms[t]) <= y && max(tops[t], bottoms[t]) >= y)
+			indices.Add(static_cast<DWORD>(t));
+	}
+
+	return indices.GetSize();
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CBoundsArray attributes
+
+INT_PTR CBoundsArray::GetSize() const
+/* ============================================================
+	Function :		CBoundsArray::GetSize
+	Description :	Gets the number of rectangles in the array.
+	Access :		Public
+
+	Return :		INT_PTR	-	Number of rectangles.
+	Parameters :	none
+
+	Usage :			Call to get the size of the array.
+
+   ============================================================*/
+{
+
+	return m_size;
+
+}
+
+double CBoundsArray::GetAt(INT_PTR index, int edge) const
+/* ============================================================
+	Function :		CBoundsArray::GetAt
+	Description :	Gets one edge of the rectangle at "index".
+	Access :		Public
+
+	Return :		double			-	The edge.
+	Parameters :	INT_PTR index	-	Index of the rectangle.
+					int edge		-	Edge to get, one of the
+										"BOUNDS_"-defines.
+
+	Usage :			Call to read a single rectangle.
+
+   ============================================================*/
+{
+
+	ASSERT(index >= 0 && index < m_size);
+	ASSERT(edge >= BOUNDS_LEFT && edge <= BOUNDS_BOTTOM);
+
+	return m_edges[edge][index];
+
+}
@@ -0,0 +1,46 @@
+#ifndef _CBOUNDSARRAY_H_3C7E9A15_D2B8_4E61_8F04A97B21C6
+#define _CBOUNDSARRAY_H_3C7E9A15_D2B8_4E61_8F04A97B21C6
+
+///////////////////////////////////////////////////////////
+// File :		BoundsArray.h
+// Created :	10/19/26
+//
+
+// Edges
+#define BOUNDS_LEFT		0
+#define BOUNDS_TOP		1
+#define BOUNDS_RIGHT	2
+#define BOUNDS_BOTTOM	3
+
+class CBoundsArray
+{
+public:
+	// Construction/destruction
+	CBoundsArray();
+	virtual ~CBoundsArray();
+
+	// Operations
+	void	SetSize(INT_PTR size);
+	void	RemoveAll();
+	void	SetAt(INT_PTR index, double left, double top, double right, double bottom);
+
+	// Queries
+	double	GetMin(int edge, double initial) const;
+	double	GetMax(int edge, double initial) const;
+	INT_PTR	GetIntersecting(double left, double top, double right, double bottom, CDWordArray& indices) const;
+	INT_PTR	GetContaining(double x, double y, CDWordArray& indices) const;
+
+	// Attributes
+	INT_PTR	GetSize() const;
+	double	GetAt(INT_PTR index, int edge) const;
+
+private:
+	// Data
+	double*	m_data;			// All four edge arrays, in one block
+	double*	m_edges[4];		// Start of each edge array
+	INT_PTR	m_size;			// Number of rectangles
+	INT_PTR	m_capacity;		// Allocated rectangles
+
+};
+
+#endif //_CBOUNDSARRAY_H_3C7E9A15_D2B8_4E61_8F04A97B21C6
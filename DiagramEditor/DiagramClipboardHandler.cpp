@@ -25,9 +25,13 @@
 					26/6 2004	Added group handling (Unruled Boy).
    ========================================================================
 					13/1 2022	Added auto-generated name support
+   ========================================================================
+					19/10 2026	Added GetMemoryUsage
    ========================================================================*/
 #include "stdafx.h"
 #include "DiagramClipboardHandler.h"
+#include "DiagramTrace.h"
+#include "DiagramMemoryUsage.h"
 #include "DiagramEntityContainer.h"
 #include "GroupFactory.h"
 #include "../UMLEditor/LinkFactory.h"
@@ -186,6 +190,8 @@ void CDiagramClipboardHandler::Paste(CDiagramEntityContainer* container)
 
    ============================================================*/
 {
+	DIAGRAM_TRACE_SPAN(_T("CDiagramClipboardHandler::Paste"));
+
 	CDWordArray	oldgroup;
 	CDWordArray	newgroup;
 
@@ -263,8 +269,10 @@ void CDiagramClipboardHandler::Paste(CDiagramEntityContainer* container)
 		}
 
 		clone->SetGroup(group);
-		container->Add(clone);
 	}
+
+	// Add all the clones to the container in one go
+	container->AddRange(&m_lastPaste);
 }
 
 CObArray* CDiagramClipboardHandler::GetData()
@@ -283,6 +291,35 @@ CObArray* CDiagramClipboardHandler::GetData()
 	return &m_paste;
 }
 
+void CDiagramClipboardHandler::GetMemoryUsage(CDiagramMemoryUsage& usage) const
+/* ============================================================
+	Function :		CDiagramClipboardHandler::GetMemoryUsage
+	Description :	Adds the memory held by the clipboard to
+					"usage".
+	Access :		Public
+
+	Return :		void
+	Parameters :	CDiagramMemoryUsage& usage	-	Breakdown
+													to add to.
+
+	Usage :			Called by the container, with the scope set
+					to "Clipboard". The objects of the last
+					paste belong to the container they were
+					pasted to, so only their array is counted.
+
+   ============================================================*/
+{
+
+	usage.Add(_T("Entities"), _T("Object array"), 1, m_paste.GetSize() * sizeof(CObject*));
+
+	INT_PTR max = m_paste.GetSize();
+	for (INT_PTR t = 0; t < max; t++)
+		static_cast<CDiagramEntity*>(m_paste.GetAt(t))->GetMemoryUsage(usage);
+
+	usage.Add(_T("Last paste"), _T("Object array"), 1, m_lastPaste.GetSize() * sizeof(CObject*));
+
+}
+
 CObArray* CDiagramClipboardHandler::GetPastedData()
 /* ============================================================
 	Function :		CDiagramClipboardHandler::GetPastedData
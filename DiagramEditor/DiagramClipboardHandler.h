@@ -20,6 +20,8 @@ public:
 
 	virtual CObArray* GetData();
 
+	virtual void	GetMemoryUsage(CDiagramMemoryUsage& usage) const;
+
 protected:
 
 	virtual CObArray* GetPastedData();
@@ -109,10 +109,28 @@
 					11/12 2004	Made UnselectAll virtual (Grisha Vinevich)
    ========================================================================
 					09/09 2018	Added Shift support for selecting objects
+					19/10 2026	Up, Down, Front and Bottom reorder a
+								multi-selection in one pass through the
+								container.
+					19/10 2026	Rubberband selection and GetContainingSize
+								use the bounds array of the container.
+					19/10 2026	Added transactions. Keyboard nudges,
+								alignment and MakeSameSizeSelected record
+								one undo step and redraw once.
+					19/10 2026	Added recording and replay of the input
+								events, with the time spent handling and
+								painting each.
+					19/10 2026	Added the performance overlay.
+					19/10 2026	Added ExportPNG, rendering the diagram
+								in tiles on several threads.
+					19/10 2026	Added ExportSVG and ExportPDF.
   ========================================================================*/
 
 #include "stdafx.h"
 #include "DiagramEditor.h"
+#include "DiagramTrace.h"
+#include "RasterExport.h"
+#include "VectorExport.h"
 #include <math.h>
 
 #ifdef _DEBUG
@@ -144,12 +162,21 @@ CDiagramEditor::CDiagramEditor()
 	m_multiSelObj = NULL;
 	m_internalData = NULL;
 
+	m_recorder = NULL;
+	m_replaying = FALSE;
+	m_replayKeys = 0;
+	m_paintTime = 0;
+
+	m_showPerformance = FALSE;
+	ResetPerformance();
+
 	SetInternalBackgroundColor(::GetSysColor(COLOR_WINDOW));
 	m_nonClientBkgndCol = ::GetSysColor(COLOR_3DSHADOW);
 
 	m_bgResize = FALSE;
 	m_bgResizeZone = 10;
 	m_bgResizeSelected = FALSE;
+	m_redrawPending = FALSE;
 	m_markerSize = CSize(8, 8);
 
 	m_popupMenu = NULL;
@@ -376,6 +403,8 @@ CDiagramEntityContainer* CDiagramEditor::GetDiagramEntityContainer() const
 
 }
 
+IMPLEMENT_DYNAMIC(CDiagramEditor, CWnd)
+
 BEGIN_MESSAGE_MAP(CDiagramEditor, CWnd)
 	//{{AFX_MSG_MAP( CDiagramEditor )
 	ON_WM_PAINT()
@@ -428,12 +457,17 @@ void CDiagramEditor::OnPaint()
    ============================================================*/
 {
 
+	LONGLONG start = m_replaying ? CDiagramRecorder::GetCounter() : 0;
+
 	CPaintDC outputdc(this);
 
 	// Getting coordinate data
 	CRect rect;
 	GetClientRect(&rect);
 	Draw(&outputdc, rect);
+
+	if (m_replaying)
+		m_paintTime += CDiagramRecorder::GetCounter() - start;
 }
 
 void CDiagramEditor::Draw(CDC* dc, CRect rect)
@@ -455,6 +489,10 @@ void CDiagramEditor::Draw(CDC* dc, CRect rect)
 
    ============================================================*/
 {
+	DIAGRAM_TRACE_SPAN(_T("CDiagramEditor::Draw"));
+
+	LONGLONG start = CDiagramRecorder::GetCounter();
+
 	// Getting co-ordinate data
 	SCROLLINFO sih{};
 	sih.cbSize = sizeof(SCROLLINFO);
@@ -496,6 +534,9 @@ void CDiagramEditor::Draw(CDC* dc, CRect rect)
 	if (IsMarginVisible())
 		DrawMargins(&memdc, totalRect, zoom);
 
+	m_visited = 0;
+	m_drawn = 0;
+	m_links = 0;
 	DrawObjects(&memdc, zoom);
 
 	if (m_bgResize && m_bgResizeSelected)
@@ -504,6 +545,13 @@ void CDiagramEditor::Draw(CDC* dc, CRect rect)
 	if (GetPanning())
 		DrawPanning(&memdc);
 
+	if (m_showPerformance)
+	{
+		CRect visible(rect);
+		visible.OffsetRect(sih.nPos, siv.nPos);
+		DrawPerformance(&memdc, visible);
+	}
+
 	// Blit the memory CDC to screen
 	dc->BitBlt(0, 0, rect.right, rect.bottom, &memdc, sih.nPos, siv.nPos, SRCCOPY);
 	memdc.SelectObject(oldbmp);
@@ -512,6 +560,9 @@ void CDiagramEditor::Draw(CDC* dc, CRect rect)
 	oldbmp->DeleteObject();
 	bmp.DeleteObject();
 	memdc.DeleteDC();
+
+	m_frameTimes[m_frameCount % PERFORMANCE_FRAMES] = CDiagramRecorder::GetMicroseconds(CDiagramRecorder::GetCounter() - start) / 1000.0;
+	m_frameCount++;
 }
 
 void CDiagramEditor::Print(CDC* dc, CRect rect, double zoom)
@@ -550,6 +601,121 @@ void CDiagramEditor::Print(CDC* dc, CRect rect, double zoom)
 
 }
 
+BOOL CDiagramEditor::ExportPNG(const CString& filename)
+/* ============================================================
+	Function :		CDiagramEditor::ExportPNG
+	Description :	Exports the diagram to a PNG file.
+	Access :		Public
+
+	Return :		BOOL					-	"FALSE" if the
+												file could not be
+												written.
+	Parameters :	const CString& filename	-	File to write.
+
+	Usage :			The virtual size is exported at 100%, on
+					white, as for EMF exports. The image is
+					rendered in tiles on several threads and
+					written a row at a time, so very large
+					diagrams do not need the whole image in
+					memory. An error message is shown if the
+					file could not be written.
+
+   ============================================================*/
+{
+
+	DIAGRAM_TRACE_SPAN(_T("CDiagramEditor::ExportPNG"));
+
+	BOOL result = FALSE;
+	if (m_objs)
+	{
+		UnselectAll();
+
+		CRasterExport raster;
+		result = raster.Export(m_objs, filename, GetVirtualSize(), 1.0, RGB(255, 255, 255));
+	}
+
+	if (!result)
+		AfxMessageBox(AFX_IDP_FAILED_TO_SAVE_DOC);
+
+	return result;
+
+}
+
+BOOL CDiagramEditor::ExportSVG(const CString& filename)
+/* ============================================================
+	Function :		CDiagramEditor::ExportSVG
+	Description :	Exports the diagram to an SVG file.
+	Access :		Public
+
+	Return :		BOOL					-	"FALSE" if the
+												file could not be
+												written.
+	Parameters :	const CString& filename	-	File to write.
+
+	Usage :			The virtual size is exported at 100%, on
+					white, as for EMF exports. The file is
+					written as the objects are drawn. An error
+					message is shown if the file could not be
+					written.
+
+   ============================================================*/
+{
+
+	DIAGRAM_TRACE_SPAN(_T("CDiagramEditor::ExportSVG"));
+
+	BOOL result = FALSE;
+	if (m_objs)
+	{
+		UnselectAll();
+
+		CVectorExport vector;
+		result = vector.ExportSVG(m_objs, filename, GetVirtualSize(), 1.0, RGB(255, 255, 255));
+	}
+
+	if (!result)
+		AfxMessageBox(AFX_IDP_FAILED_TO_SAVE_DOC);
+
+	return result;
+
+}
+
+BOOL CDiagramEditor::ExportPDF(const CString& filename)
+/* ============================================================
+	Function :		CDiagramEditor::ExportPDF
+	Description :	Exports the diagram to a PDF file.
+	Access :		Public
+
+	Return :		BOOL					-	"FALSE" if the
+												file could not be
+												written.
+	Parameters :	const CString& filename	-	File to write.
+
+	Usage :			The virtual size is exported at 100% on A4
+					pages, as many as needed. The file is
+					written a page at a time. An error message
+					is shown if the file could not be written.
+
+   ============================================================*/
+{
+
+	DIAGRAM_TRACE_SPAN(_T("CDiagramEditor::ExportPDF"));
+
+	BOOL result = FALSE;
+	if (m_objs)
+	{
+		UnselectAll();
+
+		CVectorExport vector;
+		result = vector.ExportPDF(m_objs, filename, GetVirtualSize(), 1.0);
+	}
+
+	if (!result)
+		AfxMessageBox(AFX_IDP_FAILED_TO_SAVE_DOC);
+
+	return result;
+
+}
+
 BOOL CDiagramEditor::OnEraseBkgnd(CDC*)
 /* ============================================================
 	Function :		CDiagramEditor::OnEraseBkgnd
@@ -752,14 +918,138 @@ void CDiagramEditor::DrawObjects(CDC* dc, double zoom) const
    ============================================================*/
 {
 
+	DIAGRAM_TRACE_SPAN(_T("CDiagramEditor::DrawObjects"));
+
 	if (m_objs)
 	{
 		int count = 0;
 		CDiagramEntity* obj;
 		while ((obj = m_objs->GetAt(count++)))
 			obj->DrawObject(dc, zoom);
+
+		CountDrawn(count - 1, count - 1);
+	}
+
+}
+
+void CDiagramEditor::DrawPerformance(CDC* dc, CRect rect) const
+/* ============================================================
+	Function :		CDiagramEditor::DrawPerformance
+	Description :	Draws the performance overlay.
+	Access :		Protected
+
+	Return :		void
+	Parameters :	CDC* dc		-	"CDC" to draw to.
+					CRect rect	-	The visible part of the
+									editor.
+
+	Usage :			Virtual. Can be overridden in a derived
+					class to show other counters. Called after
+					the objects are drawn, if the overlay is
+					visible. The bars are the paint times of the
+					kept frames, the line across them 1/60 s.
+
+   ============================================================*/
+{
+
+	CDiagramPerformance perf;
+	GetPerformance(perf);
+
+	CStringArray lines;
+	CString line;
+	line.Format(_T("Paint: %.1f ms, average %.1f, max %.1f"), perf.lastFrame, perf.averageFrame, perf.maxFrame);
+	lines.Add(line);
+	line.Format(_T("Objects: %Id of %Id drawn, %Id links"), perf.drawn, perf.visited, perf.links);
+	lines.Add(line);
+	line.Format(_T("Diagram: %Id objects"), perf.objects);
+	lines.Add(line);
+	line.Format(_T("GDI: %u objects, USER: %u"), perf.gdiObjects, perf.userObjects);
+	lines.Add(line);
+	line.Format(_T("Undo: %Id/%Id levels, %Id objects, %I64u KB spilled"), perf.undoLevels, perf.redoLevels, perf.undoObjects, perf.undoSpilled / 1024);
+	lines.Add(line);
+
+	dc->SelectStockObject(ANSI_VAR_FONT);
+	TEXTMETRIC tm;
+	dc->GetTextMetrics(&tm);
+	int lineHeight = tm.tmHeight;
+	int graphHeight = lineHeight * 2;
+	int width = PERFORMANCE_FRAMES * 3;
+	int count = static_cast<int>(lines.GetSize());
+	for (int t = 0; t < count; t++)
+		width = max(width, dc->GetTextExtent(lines[t]).cx);
+
+	CRect box(rect.left + 8, rect.top + 8, rect.left + width + 16, rect.top + count * lineHeight + graphHeight + 20);
+	dc->FillSolidRect(box, RGB(255, 255, 225));
+	dc->SelectStockObject(BLACK_PEN);
+	dc->SelectStockObject(NULL_BRUSH);
+	dc->Rectangle(box);
+
+	int oldmode = dc->SetBkMode(TRANSPARENT);
+	COLORREF oldcolor = dc->SetTextColor(RGB(0, 0, 0));
+	for (int t = 0; t < count; t++)
+		dc->TextOut(box.left + 4, box.top + 4 + t * lineHeight, lines[t]);
+	dc->SetTextColor(oldcolor);
+	dc->SetBkMode(oldmode);
+
+	// Paint times, oldest to the left
+	CRect graph(box.left + 4, box.bottom - graphHeight - 6, box.left + 4 + PERFORMANCE_FRAMES * 3, box.bottom - 6);
+	double scale = max(perf.maxFrame, 1000.0 / 30.0);
+	int first = max(0, m_frameCount - PERFORMANCE_FRAMES);
+	for (int t = first; t < m_frameCount; t++)
+	{
+		double time = m_frameTimes[t % PERFORMANCE_FRAMES];
+		int height = max(1, static_cast<int>(time / scale * graph.Height()));
+		int left = graph.left + (t - first) * 3;
+		dc->FillSolidRect(left, graph.bottom - height, 2, height, time > 1000.0 / 60.0 ? RGB(192, 0, 0) : RGB(0, 128, 0));
 	}
 
+	int target = graph.bottom - static_cast<int>(1000.0 / 60.0 / scale * graph.Height());
+	dc->MoveTo(graph.left, target);
+	dc->LineTo(graph.right, target);
+
+}
+
+void CDiagramEditor::CountDrawn(INT_PTR visited, INT_PTR drawn) const
+/* ============================================================
+	Function :		CDiagramEditor::CountDrawn
+	Description :	Adds to the object counters of the
+					performance overlay.
+	Access :		Protected
+
+	Return :		void
+	Parameters :	INT_PTR visited	-	Objects looked at.
+					INT_PTR drawn	-	Objects drawn.
+
+	Usage :			Call from "DrawObjects" in derived classes
+					that do not call the base class.
+
+   ============================================================*/
+{
+
+	CDiagramEditor* const local = const_cast<CDiagramEditor* const>(this);
+	local->m_visited += visited;
+	local->m_drawn += drawn;
+
+}
+
+void CDiagramEditor::CountLinks(INT_PTR links) const
+/* ============================================================
+	Function :		CDiagramEditor::CountLinks
+	Description :	Adds to the link counter of the performance
+					overlay.
+	Access :		Protected
+
+	Return :		void
+	Parameters :	INT_PTR links	-	Links resolved.
+
+	Usage :			Call from "DrawObjects" in derived classes
+					that draw links.
+
+   ============================================================*/
+{
+
+	const_cast<CDiagramEditor* const>(this)->m_links += links;
+
 }
 
 void CDiagramEditor::DrawSelectionMarkers(CDC* dc) const
@@ -968,7 +1258,7 @@ void CDiagramEditor::SetInternalVirtualSize(const CSize& size)
 		SetupScrollbars();
 		if (m_hWnd)
 		{
-			RedrawWindow();
+			RequestRedraw();
 		}
 	}
 }
@@ -1051,7 +1341,7 @@ void CDiagramEditor::SetInternalBackgroundColor(COLORREF col)
 		m_objs->SetColor(col);
 		if (m_hWnd)
 		{
-			RedrawWindow();
+			RequestRedraw();
 		}
 	}
 }
@@ -1074,7 +1364,7 @@ void CDiagramEditor::SetNonClientColor(COLORREF col)
 
 	m_nonClientBkgndCol = col;
 	if (m_hWnd)
-		RedrawWindow();
+		RequestRedraw();
 
 }
 
@@ -1101,7 +1391,7 @@ void CDiagramEditor::ShowGrid(BOOL grid)
 		m_objs->ShowGrid(grid);
 		if (m_hWnd)
 		{
-			RedrawWindow();
+			RequestRedraw();
 		}
 	}
 }
@@ -1155,7 +1445,7 @@ void CDiagramEditor::SetGridColor(COLORREF col)
 		m_objs->SetGridColor(col);
 		if (m_hWnd)
 		{
-			RedrawWindow();
+			RequestRedraw();
 		}
 	}
 }
@@ -1208,7 +1498,7 @@ void CDiagramEditor::SetGridSize(CSize size)
 		m_objs->SetGridSize(size);
 		if (m_hWnd)
 		{
-			RedrawWindow();
+			RequestRedraw();
 		}
 	}
 }
@@ -1263,7 +1553,7 @@ void CDiagramEditor::SetGridPenStyle(int style)
 		m_objs->SetGridPenStyle(style);
 		if (m_hWnd)
 		{
-			RedrawWindow();
+			RequestRedraw();
 		}
 	}
 }
@@ -1507,7 +1797,7 @@ void CDiagramEditor::SetMarginColor(COLORREF marginColor)
 		m_objs->SetMarginColor(marginColor);
 		if (m_hWnd)
 		{
-			RedrawWindow();
+			RequestRedraw();
 		}
 	}
 }
@@ -1554,7 +1844,7 @@ void CDiagramEditor::ShowMargin(BOOL show)
 		m_objs->ShowMargin(show);
 		if (m_hWnd)
 		{
-			RedrawWindow();
+			RequestRedraw();
 		}
 	}
 }
@@ -2737,10 +3027,19 @@ void CDiagramEditor::OnLButtonUp(UINT nFlags, CPoint point)
 		if (rect.TopLeft() == rect.BottomRight())
 			rect.InflateRect(1, 1);
 
-		// We loop all objects, checking if we got any overlap.
-		count = 0;
-		while ((obj = m_objs->GetAt(count++)))
+		// We get the objects with a rect touching the
+		// selection from the bounds array, and let the objects
+		// themselves decide if they overlap. The test rect is
+		// inflated, as "BodyInRect" uses the integer rect.
+		CRect test(rect);
+		test.NormalizeRect();
+		test.InflateRect(1, 1);
+
+		CDWordArray hits;
+		INT_PTR max = m_objs->GetBounds()->GetIntersecting(test.left, test.top, test.right, test.bottom, hits);
+		for (INT_PTR t = 0; t < max; t++)
 		{
+			obj = m_objs->GetAt(hits[t]);
 			if (obj->BodyInRect(rect))
 				obj->Select(TRUE);
 		}
@@ -2924,7 +3223,7 @@ void CDiagramEditor::OnKeyDown(UINT nChar, UINT nRepCnt, UINT nFlags)
 			if ((m_keyInterface & KEY_ARROW) && (nChar == VK_DOWN))
 			{
 				offsety = offsetstepy;
-				if (GetAsyncKeyState(VK_SHIFT))
+				if (IsKeyDown(VK_SHIFT))
 					resize = TRUE;
 				else
 					move = TRUE;
@@ -2932,7 +3231,7 @@ void CDiagramEditor::OnKeyDown(UINT nChar, UINT nRepCnt, UINT nFlags)
 			else if ((m_keyInterface & KEY_ARROW) && (nChar == VK_UP))
 			{
 				offsety = -offsetstepy;
-				if (GetAsyncKeyState(VK_SHIFT))
+				if (IsKeyDown(VK_SHIFT))
 					resize = TRUE;
 				else
 					move = TRUE;
@@ -2940,7 +3239,7 @@ void CDiagramEditor::OnKeyDown(UINT nChar, UINT nRepCnt, UINT nFlags)
 			else if ((m_keyInterface & KEY_ARROW) && (nChar == VK_LEFT))
 			{
 				offsetx = -offsetstepx;
-				if (GetAsyncKeyState(VK_SHIFT))
+				if (IsKeyDown(VK_SHIFT))
 					resize = TRUE;
 				else
 					move = TRUE;
@@ -2948,48 +3247,54 @@ void CDiagramEditor::OnKeyDown(UINT nChar, UINT nRepCnt, UINT nFlags)
 			else if ((m_keyInterface & KEY_ARROW) && (nChar == VK_RIGHT))
 			{
 				offsetx = offsetstepx;
-				if (GetAsyncKeyState(VK_SHIFT))
+				if (IsKeyDown(VK_SHIFT))
 					resize = TRUE;
 				else
 					move = TRUE;
 			}
 			else if ((m_keyInterface & KEY_DELETE) && (nChar == VK_DELETE))
 			{
-				if (GetAsyncKeyState(VK_SHIFT))
+				if (IsKeyDown(VK_SHIFT))
 					Cut();
 				else
 					DeleteAllSelected();
 			}
 			else if ((m_keyInterface & KEY_INSERT) && (nChar == VK_INSERT))
 			{
-				if (GetAsyncKeyState(VK_SHIFT))
+				if (IsKeyDown(VK_SHIFT))
 					Paste();
 				else
 					Duplicate();
 			}
-			else if ((m_keyInterface & KEY_CTRL) && nChar == VK_RETURN && GetAsyncKeyState(VK_CONTROL))
+			else if ((m_keyInterface & KEY_CTRL) && nChar == VK_RETURN && IsKeyDown(VK_CONTROL))
 				ShowProperties();
-			else if ((m_keyInterface & KEY_CTRL) && nChar == _TCHAR('A') && GetAsyncKeyState(VK_CONTROL))
+			else if ((m_keyInterface & KEY_CTRL) && nChar == _TCHAR('A') && IsKeyDown(VK_CONTROL))
 				SelectAll();
-			else if ((m_keyInterface & KEY_CTRL) && nChar == _TCHAR('X') && GetAsyncKeyState(VK_CONTROL))
+			else if ((m_keyInterface & KEY_CTRL) && nChar == _TCHAR('X') && IsKeyDown(VK_CONTROL))
 				Cut();
-			else if ((m_keyInterface & KEY_CTRL) && nChar == _TCHAR('V') && GetAsyncKeyState(VK_CONTROL))
+			else if ((m_keyInterface & KEY_CTRL) && nChar == _TCHAR('V') && IsKeyDown(VK_CONTROL))
 				Paste();
-			else if ((m_keyInterface & KEY_CTRL) && nChar == _TCHAR('C') && GetAsyncKeyState(VK_CONTROL))
+			else if ((m_keyInterface & KEY_CTRL) && nChar == _TCHAR('C') && IsKeyDown(VK_CONTROL))
 				Copy();
-			else if ((m_keyInterface & KEY_CTRL) && nChar == _TCHAR('Z') && GetAsyncKeyState(VK_CONTROL))
+			else if ((m_keyInterface & KEY_CTRL) && nChar == _TCHAR('Z') && IsKeyDown(VK_CONTROL))
 				Undo();
-			else if ((m_keyInterface & KEY_CTRL) && nChar == _TCHAR('Y') && GetAsyncKeyState(VK_CONTROL))
+			else if ((m_keyInterface & KEY_CTRL) && nChar == _TCHAR('Y') && IsKeyDown(VK_CONTROL))
 				Redo();
-			else if ((m_keyInterface & KEY_PGUPDOWN) && nChar == VK_NEXT && GetAsyncKeyState(VK_CONTROL))
+			else if ((m_keyInterface & KEY_PGUPDOWN) && nChar == VK_NEXT && IsKeyDown(VK_CONTROL))
 				Bottom();
-			else if ((m_keyInterface & KEY_PGUPDOWN) && nChar == VK_PRIOR && GetAsyncKeyState(VK_CONTROL))
+			else if ((m_keyInterface & KEY_PGUPDOWN) && nChar == VK_PRIOR && IsKeyDown(VK_CONTROL))
 				Front();
 			else if ((m_keyInterface & KEY_PGUPDOWN) && nChar == VK_NEXT)
 				Down();
 			else if ((m_keyInterface & KEY_PGUPDOWN) && nChar == VK_PRIOR)
 				Up();
 
+			// A run of nudges is a single undo step
+			if (move)
+				BeginTransaction(TRANSACTION_NUDGE);
+			else if (resize)
+				BeginTransaction(TRANSACTION_RESIZE);
+
 			if (move)
 			{
 				InsideRestraints(offsetx, offsety);
@@ -3047,7 +3352,10 @@ void CDiagramEditor::OnKeyDown(UINT nChar, UINT nRepCnt, UINT nFlags)
 			}
 
 			if (redraw)
-				RedrawWindow();
+				RequestRedraw();
+
+			if (move || resize)
+				CommitTransaction();
 		}
 
 		if ((m_keyInterface & KEY_ESCAPE) && (nChar == VK_ESCAPE))
@@ -3506,18 +3814,14 @@ CSize CDiagramEditor::GetContainingSize() const
    ============================================================*/
 {
 
-	int count = 0;
-	CDiagramEntity* obj;
 	int maxx = 0;
 	int maxy = 0;
 
 	if (m_objs)
 	{
-		while ((obj = m_objs->GetAt(count++)))
-		{
-			maxx = max(round(obj->GetRight()), maxx);
-			maxy = max(round(obj->GetBottom()), maxy);
-		}
+		const CBoundsArray* bounds = m_objs->GetBounds();
+		maxx = round(bounds->GetMax(BOUNDS_RIGHT, 0));
+		maxy = round(bounds->GetMax(BOUNDS_BOTTOM, 0));
 	}
 
 	return CSize(maxx, maxy);
@@ -4450,6 +4754,7 @@ void CDiagramEditor::LeftAlignSelected()
 
 	if (GetSelectCount() > 1)
 	{
+		BeginTransaction();
 		m_objs->Snapshot();
 		CDiagramEntity* obj = GetSelectedObject();
 		if (obj)
@@ -4468,7 +4773,8 @@ void CDiagramEditor::LeftAlignSelected()
 
 		}
 		SetModified(TRUE);
-		RedrawWindow();
+		RequestRedraw();
+		CommitTransaction();
 	}
 
 }
@@ -4493,6 +4799,7 @@ void CDiagramEditor::RightAlignSelected()
 
 	if (GetSelectCount() > 1)
 	{
+		BeginTransaction();
 		m_objs->Snapshot();
 		CDiagramEntity* obj = GetSelectedObject();
 		if (obj)
@@ -4511,7 +4818,8 @@ void CDiagramEditor::RightAlignSelected()
 
 		}
 		SetModified(TRUE);
-		RedrawWindow();
+		RequestRedraw();
+		CommitTransaction();
 	}
 
 }
@@ -4536,6 +4844,7 @@ void CDiagramEditor::TopAlignSelected()
 
 	if (GetSelectCount() > 1)
 	{
+		BeginTransaction();
 		m_objs->Snapshot();
 		CDiagramEntity* obj = GetSelectedObject();
 		if (obj)
@@ -4554,7 +4863,8 @@ void CDiagramEditor::TopAlignSelected()
 
 		}
 		SetModified(TRUE);
-		RedrawWindow();
+		RequestRedraw();
+		CommitTransaction();
 	}
 
 }
@@ -4579,6 +4889,7 @@ void CDiagramEditor::BottomAlignSelected()
 
 	if (GetSelectCount() > 1)
 	{
+		BeginTransaction();
 		m_objs->Snapshot();
 		CDiagramEntity* obj = GetSelectedObject();
 		if (obj)
@@ -4597,7 +4908,8 @@ void CDiagramEditor::BottomAlignSelected()
 
 		}
 		SetModified(TRUE);
-		RedrawWindow();
+		RequestRedraw();
+		CommitTransaction();
 	}
 
 }
@@ -4622,6 +4934,7 @@ void CDiagramEditor::MakeSameSizeSelected()
 
 	if (GetSelectCount() > 1)
 	{
+		BeginTransaction();
 		m_objs->Snapshot();
 		CDiagramEntity* obj = GetSelectedObject();
 		if (obj)
@@ -4635,7 +4948,8 @@ void CDiagramEditor::MakeSameSizeSelected()
 
 		}
 		SetModified(TRUE);
-		RedrawWindow();
+		RequestRedraw();
+		CommitTransaction();
 	}
 
 }
@@ -4677,11 +4991,11 @@ void CDiagramEditor::Up()
 	Return :		void
 	Parameters :	none
 
-	Usage :			Call to move the selected object one step
+	Usage :			Call to move the selected objects one step
 					up in the z-order.
 					This command should only be callable if
-					"GetSelectCount()" returns 1, that is, if one
-					and only one object is selected.
+					"GetSelectCount()" returns greater than 0
+					i.e. if one or more objects are selected.
 
    ============================================================*/
 {
@@ -4696,6 +5010,12 @@ void CDiagramEditor::Up()
 			RedrawWindow();
 		}
 	}
+	else if (GetSelectCount() > 1)
+	{
+		m_objs->Snapshot();
+		m_objs->UpIf(CDiagramEntityContainer::IsSelectedPredicate);
+		RedrawWindow();
+	}
 }
 
 void CDiagramEditor::Down()
@@ -4708,11 +5028,11 @@ void CDiagramEditor::Down()
 	Return :		void
 	Parameters :	none
 
-	Usage :			Call to move the selected object one step
+	Usage :			Call to move the selected objects one step
 					down in the z-order.
 					This command should only be callable if
-					"GetSelectCount()" returns 1, that is, if one
-					and only one object is selected.
+					"GetSelectCount()" returns greater than 0
+					i.e. if one or more objects are selected.
 
    ============================================================*/
 {
@@ -4727,6 +5047,12 @@ void CDiagramEditor::Down()
 			RedrawWindow();
 		}
 	}
+	else if (GetSelectCount() > 1)
+	{
+		m_objs->Snapshot();
+		m_objs->DownIf(CDiagramEntityContainer::IsSelectedPredicate);
+		RedrawWindow();
+	}
 }
 
 void CDiagramEditor::Front()
@@ -4763,18 +5089,7 @@ void CDiagramEditor::Front()
 		if (obj)
 		{
 			m_objs->Snapshot();
-			CObArray* objs = new CObArray();
-			objs->Copy(*m_objs->GetData());
-			for (int i = 0; i < objs->GetSize(); i++)
-			{
-				CDiagramEntity* obj = (CDiagramEntity*)objs->GetAt(i);
-				if (obj->IsSelected())
-				{
-					m_objs->Front(obj);
-				}
-			}
-
-			delete objs;
+			m_objs->FrontIf(CDiagramEntityContainer::IsSelectedPredicate);
 		}
 
 		RedrawWindow();
@@ -4815,18 +5130,7 @@ void CDiagramEditor::Bottom()
 		if (obj)
 		{
 			m_objs->Snapshot();
-			CObArray* objs = new CObArray();
-			objs->Copy(*m_objs->GetData());
-			for (INT_PTR i = objs->GetSize() - 1; i >= 0; i--)
-			{
-				CDiagramEntity* obj = (CDiagramEntity*)objs->GetAt(i);
-				if (obj->IsSelected())
-				{
-					m_objs->Bottom(obj);
-				}
-			}
-
-			delete objs;
+			m_objs->BottomIf(CDiagramEntityContainer::IsSelectedPredicate);
 		}
 
 		RedrawWindow();
@@ -5108,6 +5412,8 @@ void CDiagramEditor::Paste()
    ============================================================*/
 {
 
+	DIAGRAM_TRACE_SPAN(_T("CDiagramEditor::Paste"));
+
 	// Removes the current selection and pastes the contents
 	// of the data paste-array.
 	if (m_objs)
@@ -5136,6 +5442,8 @@ void CDiagramEditor::Undo()
 
    ============================================================*/
 {
+	DIAGRAM_TRACE_SPAN(_T("CDiagramEditor::Undo"));
+
 	if (m_objs)
 	{
 		m_objs->Undo();
@@ -5157,6 +5465,8 @@ void CDiagramEditor::Redo()
 
    ============================================================*/
 {
+	DIAGRAM_TRACE_SPAN(_T("CDiagramEditor::Redo"));
+
 	if (m_objs)
 	{
 		m_objs->Redo();
@@ -5164,6 +5474,431 @@ void CDiagramEditor::Redo()
 	}
 }
 
+void CDiagramEditor::BeginTransaction(UINT coalesce)
+/* ============================================================
+	Function :		CDiagramEditor::BeginTransaction
+	Description :	Starts a transaction in the data container.
+	Access :		Public
+
+	Return :		void
+	Parameters :	UINT coalesce	-	Key for coalescing, or
+										"TRANSACTION_NONE".
+
+	Usage :			Call before an operation made up of other
+					operations, and "CommitTransaction" or
+					"AbortTransaction" after it. The operation
+					is undone in a single step, see
+					"CDiagramEntityContainer::BeginTransaction".
+					Redraws requested with "RequestRedraw" are
+					deferred until the transaction ends.
+
+   ============================================================*/
+{
+
+	if (m_objs)
+		m_objs->BeginTransaction(coalesce);
+
+}
+
+void CDiagramEditor::CommitTransaction()
+/* ============================================================
+	Function :		CDiagramEditor::CommitTransaction
+	Description :	Ends a transaction in the data container.
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Call after the operation started by
+					"BeginTransaction". The editor is redrawn
+					once if a redraw was requested.
+
+   ============================================================*/
+{
+
+	if (m_objs)
+	{
+		m_objs->CommitTransaction();
+		if (!m_objs->IsInTransaction() && m_redrawPending)
+		{
+			m_redrawPending = FALSE;
+			RedrawWindow();
+		}
+	}
+
+}
+
+void CDiagramEditor::AbortTransaction()
+/* ============================================================
+	Function :		CDiagramEditor::AbortTransaction
+	Description :	Aborts a transaction in the data container.
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Call instead of "CommitTransaction" if the
+					operation fails. The data is restored when
+					the outermost transaction ends.
+
+   ============================================================*/
+{
+
+	if (m_objs)
+	{
+		BOOL restored = m_objs->AbortTransaction();
+		if (!m_objs->IsInTransaction() && (restored || m_redrawPending))
+		{
+			m_redrawPending = FALSE;
+			RedrawWindow();
+		}
+	}
+
+}
+
+void CDiagramEditor::RequestRedraw()
+/* ============================================================
+	Function :		CDiagramEditor::RequestRedraw
+	Description :	Redraws the editor, or defers the redraw to
+					the end of the current transaction.
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Call instead of "RedrawWindow" from
+					operations that may be part of a
+					transaction.
+
+   ============================================================*/
+{
+
+	if (m_objs && m_objs->IsInTransaction())
+		m_redrawPending = TRUE;
+	else
+		RedrawWindow();
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramEditor performance overlay
+
+void CDiagramEditor::ShowPerformance(BOOL show)
+/* ============================================================
+	Function :		CDiagramEditor::ShowPerformance
+	Description :	Shows or hides the performance overlay.
+	Access :		Public
+
+	Return :		void
+	Parameters :	BOOL show	-	"TRUE" to show the overlay.
+
+	Usage :			The overlay shows the paint times of the
+					last frames, the objects and links drawn,
+					the GDI objects of the process and the size
+					of the undo stacks. The counters are kept
+					also when the overlay is hidden, see
+					"GetPerformance".
+
+   ============================================================*/
+{
+
+	m_showPerformance = show;
+	if (m_hWnd)
+		RedrawWindow();
+
+}
+
+BOOL CDiagramEditor::IsPerformanceVisible() const
+/* ============================================================
+	Function :		CDiagramEditor::IsPerformanceVisible
+	Description :	Checks if the performance overlay is shown.
+	Access :		Public
+
+	Return :		BOOL	-	"TRUE" if shown.
+	Parameters :	none
+
+	Usage :			Call for command enabling.
+
+   ============================================================*/
+{
+
+	return m_showPerformance;
+
+}
+
+void CDiagramEditor::GetPerformance(CDiagramPerformance& perf) const
+/* ============================================================
+	Function :		CDiagramEditor::GetPerformance
+	Description :	Gets the counters of the performance
+					overlay.
+	Access :		Public
+
+	Return :		void
+	Parameters :	CDiagramPerformance& perf	-	Gets the
+													counters.
+
+	Usage :			The object and link counters are of the
+					last paint, and the paint times of the last
+					"PERFORMANCE_FRAMES" paints. The others are
+					read when called.
+
+   ============================================================*/
+{
+
+	perf.frames = min(m_frameCount, PERFORMANCE_FRAMES);
+	perf.lastFrame = 0.0;
+	perf.averageFrame = 0.0;
+	perf.maxFrame = 0.0;
+	if (perf.frames)
+	{
+		perf.lastFrame = m_frameTimes[(m_frameCount - 1) % PERFORMANCE_FRAMES];
+		for (int t = 0; t < perf.frames; t++)
+		{
+			perf.averageFrame += m_frameTimes[t];
+			perf.maxFrame = max(perf.maxFrame, m_frameTimes[t]);
+		}
+		perf.averageFrame /= perf.frames;
+	}
+
+	perf.visited = m_visited;
+	perf.drawn = m_drawn;
+	perf.links = m_links;
+
+	perf.gdiObjects = ::GetGuiResources(::GetCurrentProcess(), GR_GDIOBJECTS);
+	perf.userObjects = ::GetGuiResources(::GetCurrentProcess(), GR_USEROBJECTS);
+
+	perf.undoLevels = 0;
+	perf.redoLevels = 0;
+	perf.undoObjects = 0;
+	perf.undoSpilled = 0;
+	perf.objects = 0;
+	if (m_objs)
+	{
+		perf.undoLevels = m_objs->GetUndoLevels();
+		perf.redoLevels = m_objs->GetRedoLevels();
+		perf.undoObjects = m_objs->GetUndoObjectCount();
+		perf.undoSpilled = m_objs->GetUndoSpillSize();
+		perf.objects = m_objs->GetSize();
+	}
+
+}
+
+void CDiagramEditor::ResetPerformance()
+/* ============================================================
+	Function :		CDiagramEditor::ResetPerformance
+	Description :	Clears the paint times and counters.
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Call before a measurement.
+
+   ============================================================*/
+{
+
+	for (int t = 0; t < PERFORMANCE_FRAMES; t++)
+		m_frameTimes[t] = 0.0;
+	m_frameCount = 0;
+	m_visited = 0;
+	m_drawn = 0;
+	m_links = 0;
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramEditor input recording
+
+void CDiagramEditor::SetRecorder(CDiagramRecorder* recorder)
+/* ============================================================
+	Function :		CDiagramEditor::SetRecorder
+	Description :	Starts or stops recording the input events.
+	Access :		Public
+
+	Return :		void
+	Parameters :	CDiagramRecorder* recorder	-	Gets the
+													events,
+													"NULL" to
+													stop.
+
+	Usage :			Call with the document the trace should be
+					replayed against open. The zoom and scroll
+					position are saved with the trace.
+
+   ============================================================*/
+{
+
+	m_recorder = recorder;
+	if (m_recorder && m_hWnd)
+	{
+		CRect rect;
+		GetClientRect(&rect);
+		m_recorder->Start(GetZoom(), CPoint(GetScrollPos(SB_HORZ), GetScrollPos(SB_VERT)), rect.Size());
+	}
+
+}
+
+CDiagramRecorder* CDiagramEditor::GetRecorder() const
+/* ============================================================
+	Function :		CDiagramEditor::GetRecorder
+	Description :	Gets the recorder.
+	Access :		Public
+
+	Return :		CDiagramRecorder*	-	The recorder, "NULL"
+											if not recording.
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	return m_recorder;
+
+}
+
+BOOL CDiagramEditor::Replay(CDiagramRecorder* recorder)
+/* ============================================================
+	Function :		CDiagramEditor::Replay
+	Description :	Sends recorded input events to the editor,
+					and times them.
+	Access :		Public
+
+	Return :		BOOL						-	"FALSE" if
+													the editor
+													has no window.
+	Parameters :	CDiagramRecorder* recorder	-	Events to
+													send.
+
+	Usage :			Call with the document the trace was
+					recorded against open. Each event is sent
+					and the window is updated before the next,
+					without waiting. The time spent in "OnPaint"
+					is the paint time of the event, and the rest
+					the model time. Get the results with
+					"CDiagramRecorder::GetReport".
+
+   ============================================================*/
+{
+
+	if (!m_hWnd || !recorder)
+		return FALSE;
+
+	CDiagramRecorder* saved = m_recorder;
+	m_recorder = NULL;
+
+	SetZoom(recorder->GetZoom());
+	SetHScroll(recorder->GetScroll().x);
+	SetVScroll(recorder->GetScroll().y);
+	RedrawWindow();
+
+	recorder->ClearLatencies();
+	m_replaying = TRUE;
+
+	INT_PTR max = recorder->GetSize();
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		UINT message = recorder->GetEventMessage(t);
+		LPARAM lParam = recorder->GetLParam(t);
+		if (message == WM_MOUSEWHEEL)
+		{
+			// The wheel message has screen coordinates
+			CPoint point(static_cast<short>(LOWORD(lParam)), static_cast<short>(HIWORD(lParam)));
+			ClientToScreen(&point);
+			lParam = MAKELPARAM(point.x, point.y);
+		}
+
+		m_replayKeys = recorder->GetKeys(t);
+		m_paintTime = 0;
+
+		LONGLONG start = CDiagramRecorder::GetCounter();
+		SendMessage(message, recorder->GetWParam(t), lParam);
+		UpdateWindow();
+		LONGLONG total = CDiagramRecorder::GetCounter() - start;
+
+		recorder->SetLatency(t, CDiagramRecorder::GetMicroseconds(total - m_paintTime), CDiagramRecorder::GetMicroseconds(m_paintTime));
+	}
+
+	m_replaying = FALSE;
+	m_replayKeys = 0;
+	m_recorder = saved;
+
+	return TRUE;
+
+}
+
+LRESULT CDiagramEditor::WindowProc(UINT message, WPARAM wParam, LPARAM lParam)
+/* ============================================================
+	Function :		CDiagramEditor::WindowProc
+	Description :	Records input events before they are
+					handled.
+	Access :		Protected
+
+	Return :		LRESULT			-	Message result.
+	Parameters :	UINT message	-	Message.
+					WPARAM wParam	-	Message parameter.
+					LPARAM lParam	-	Message parameter.
+
+	Usage :			Called from MFC. Do not call from code.
+					Ctrl+Enter is not recorded, as it opens
+					the property dialog.
+
+   ============================================================*/
+{
+
+	if (m_recorder && !m_replaying && CDiagramRecorder::IsInputMessage(message) &&
+		!(message == WM_KEYDOWN && wParam == VK_RETURN))
+	{
+		LPARAM param = lParam;
+		if (message == WM_MOUSEWHEEL)
+		{
+			CPoint point(static_cast<short>(LOWORD(lParam)), static_cast<short>(HIWORD(lParam)));
+			ScreenToClient(&point);
+			param = MAKELPARAM(point.x, point.y);
+		}
+
+		UINT keys = 0;
+		if (::GetKeyState(VK_SHIFT) < 0)
+			keys |= RECORD_KEY_SHIFT;
+		if (::GetKeyState(VK_CONTROL) < 0)
+			keys |= RECORD_KEY_CONTROL;
+
+		m_recorder->Record(message, wParam, param, keys);
+	}
+
+	return CWnd::WindowProc(message, wParam, lParam);
+
+}
+
+BOOL CDiagramEditor::IsKeyDown(int key) const
+/* ============================================================
+	Function :		CDiagramEditor::IsKeyDown
+	Description :	Checks if Shift or Ctrl is down.
+	Access :		Protected
+
+	Return :		BOOL		-	"TRUE" if down.
+	Parameters :	int key		-	"VK_SHIFT" or "VK_CONTROL".
+
+	Usage :			Call instead of "GetAsyncKeyState" in key
+					handlers, so that replayed events get the
+					recorded keys.
+
+   ============================================================*/
+{
+
+	if (m_replaying)
+	{
+		if (key == VK_SHIFT)
+			return (m_replayKeys & RECORD_KEY_SHIFT) != 0;
+		if (key == VK_CONTROL)
+			return (m_replayKeys & RECORD_KEY_CONTROL) != 0;
+		return FALSE;
+	}
+
+	return GetAsyncKeyState(key) != 0;
+
+}
+
 void CDiagramEditor::Group()
 /* ============================================================
 	Function :		CDiagramEditor::OnEditGroup
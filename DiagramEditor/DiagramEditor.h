@@ -9,6 +9,7 @@
 #include "DiagramEntity.h"
 #include "DiagramEntityContainer.h"
 #include "DiagramMenu.h"
+#include "DiagramRecorder.h"
 
 // Current mouse mode
 #define MODE_NONE			0
@@ -32,12 +33,35 @@
 #define WHEEL_SCROLL	0
 #define WHEEL_ZOOM		1
 
+// Paint times kept for the performance overlay
+#define PERFORMANCE_FRAMES	60
+
+// Counters shown by the performance overlay
+struct CDiagramPerformance
+{
+	double		lastFrame;		// Paint time of the last frame, in milliseconds
+	double		averageFrame;	// Average paint time of the kept frames
+	double		maxFrame;		// Slowest of the kept frames
+	int			frames;			// Number of kept frames
+	INT_PTR		visited;		// Objects looked at by "DrawObjects" in the last frame
+	INT_PTR		drawn;			// Objects drawn in the last frame
+	INT_PTR		links;			// Links resolved in the last frame
+	DWORD		gdiObjects;		// GDI objects of the process
+	DWORD		userObjects;	// USER objects of the process
+	INT_PTR		undoLevels;
+	INT_PTR		redoLevels;
+	INT_PTR		undoObjects;	// Objects kept in memory by the undo and redo stacks
+	ULONGLONG	undoSpilled;	// Bytes of undo levels spilled to disk
+	INT_PTR		objects;		// Objects in the diagram
+};
+
 /////////////////////////////////////////////////////////////////////////////
 // CDiagramEditor window
 
 class CDiagramEditor : public CWnd
 {
 	friend class CDiagramMenu;
+	DECLARE_DYNAMIC(CDiagramEditor)
 
 public:
 	// Construction/destruction/initialization
@@ -54,6 +78,9 @@ public:
 	// Visuals
 	virtual void	Draw(CDC* dc, CRect rect);
 	virtual void	Print(CDC* dc, CRect rect, double zoom);
+	BOOL			ExportPNG(const CString& filename);
+	BOOL			ExportSVG(const CString& filename);
+	BOOL			ExportPDF(const CString& filename);
 
 protected:
 	virtual void EraseBackground(CDC* dc, CRect rect) const;
@@ -62,6 +89,10 @@ protected:
 	virtual void DrawMargins(CDC* dc, CRect rect, double zoom) const;
 	virtual void DrawObjects(CDC* dc, double zoom) const;
 	virtual void DrawSelectionMarkers(CDC* dc) const;
+	virtual void DrawPerformance(CDC* dc, CRect rect) const;
+
+	void		CountDrawn(INT_PTR visited, INT_PTR drawn) const;
+	void		CountLinks(INT_PTR links) const;
 
 public:
 	// Property Accessors
@@ -165,6 +196,23 @@ public:
 	virtual void		Undo();
 	virtual void		Redo();
 
+	// Transactions
+	void		BeginTransaction(UINT coalesce = TRANSACTION_NONE);
+	void		CommitTransaction();
+	void		AbortTransaction();
+	void		RequestRedraw();
+
+	// Performance overlay
+	void		ShowPerformance(BOOL show);
+	BOOL		IsPerformanceVisible() const;
+	void		GetPerformance(CDiagramPerformance& perf) const;
+	void		ResetPerformance();
+
+	// Input recording
+	void				SetRecorder(CDiagramRecorder* recorder);
+	CDiagramRecorder*	GetRecorder() const;
+	BOOL				Replay(CDiagramRecorder* recorder);
+
 	// Group 
 	void		Group();
 	void		Ungroup();
@@ -218,6 +266,7 @@ protected:
 	// Overrides
 		// ClassWizard generated virtual function overrides
 		//{{AFX_VIRTUAL(CDiagramEditor)
+	virtual LRESULT WindowProc(UINT message, WPARAM wParam, LPARAM lParam);
 		//}}AFX_VIRTUAL
 
 		// Generated message map functions
@@ -261,6 +310,8 @@ protected:
 	virtual void SetHScroll(int pos);
 	virtual void SetVScroll(int pos);
 
+	BOOL		IsKeyDown(int key) const;
+
 private:
 
 	// Run-time states/data
@@ -286,6 +337,7 @@ private:
 	int			m_bgResizeZone;		// Size, in pixels, of resize zone
 	BOOL		m_bgResize;			// TRUE if the paper can be resized
 	BOOL		m_bgResizeSelected;	// TRUE if we are resizing the background
+	BOOL		m_redrawPending;	// TRUE if a redraw is deferred to the end of a transaction
 
 	CSize		m_markerSize;		// Size of selection marker
 
@@ -304,6 +356,20 @@ private:
 	CDiagramEntity* m_drawObj;	// Temporary pointer to object that should be drawn
 	CDiagramEntityContainer* m_internalData;	// Internal data pointer - if external data is not submitted
 
+	// Input recording
+	CDiagramRecorder*	m_recorder;		// Gets the input events, "NULL" if not recording
+	BOOL				m_replaying;	// TRUE while "Replay" sends events
+	UINT				m_replayKeys;	// Modifier keys of the event being replayed
+	LONGLONG			m_paintTime;	// Counter ticks spent in "OnPaint" during a replayed event
+
+	// Performance overlay
+	BOOL		m_showPerformance;
+	double		m_frameTimes[PERFORMANCE_FRAMES];	// Paint times in milliseconds, by frame number modulo "PERFORMANCE_FRAMES"
+	int			m_frameCount;		// Frames painted since the last reset
+	INT_PTR		m_visited;			// Counters of the last "DrawObjects"
+	INT_PTR		m_drawn;
+	INT_PTR		m_links;
+
 public:
 	// Coordinate conversions
 	void		ScreenToVirtual(CRect& rect) const;
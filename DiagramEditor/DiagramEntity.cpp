@@ -76,12 +76,27 @@
 					23/1 2005	Made SetParent/GetParent public.
    ========================================================================
 					13/1 2022	Added auto-generated name support
+   ========================================================================
+					19/10 2026	Added InternStrings
+					19/10 2026	Added kind tags
+					19/10 2026	The edge setters update the bounds array of
+								the parent container.
+					19/10 2026	Added GetMemoryUsage
+					19/10 2026	Added Render and RenderObject, Draw
+								renders to the CDC
+					19/10 2026	RenderObject calls Draw for renderers
+								drawing to a CDC
+					19/10 2026	Added GetID, the name as a numeric id
    ========================================================================*/
 #include "stdafx.h"
 #include "resource.h"
 #include "DiagramEntity.h"
 #include "DiagramEntityContainer.h"
+#include "StringTable.h"
+#include "DiagramMemoryUsage.h"
+#include "DiagramGDIRenderer.h"
 #include "Tokenizer.h"
+#include "../UMLEditor/LinkFactory.h"
 
 #ifdef _DEBUG
 #define new DEBUG_NEW
@@ -107,10 +122,13 @@ CDiagramEntity::CDiagramEntity()
 {
 	SetParent(NULL);
 	SetPropertyDialog(NULL, 0);
+	m_id = LINK_ID_NONE;
 	Clear();
 	SetType(_T("basic"));
 
 	SetGroup(0);
+	m_kind = KIND_NONE;
+	m_boundsIndex = -1;
 }
 
 CDiagramEntity::~CDiagramEntity()
@@ -454,7 +472,9 @@ CString CDiagramEntity::GetDefaultGetString() const
 	Parameters :	none
 
 	Usage :			Call as a part of the saving of objects
-					to disk.
+					to disk. The coordinates are written with
+					all their digits, so that spilled undo
+					levels and saved files read back exactly.
 
    ============================================================*/
 {
@@ -472,7 +492,7 @@ CString CDiagramEntity::GetDefaultGetString() const
 	name.Replace(_T(","), _T("\\comma"));
 	name.Replace(_T("\r\n"), _T("\\newline"));
 
-	str.Format(_T("%s:%f,%f,%f,%f,%s,%s,%i"),
+	str.Format(_T("%s:%.17g,%.17g,%.17g,%.17g,%s,%s,%i"),
 		GetType().GetString(),
 		GetLeft(),
 		GetTop(),
@@ -919,14 +939,87 @@ void CDiagramEntity::Draw(CDC* dc, CRect rect)
 					so creating a memory "CDC" in this function
 					will probably not speed up the function.
 
+					The default implementation calls "Render"
+					with a renderer drawing to "dc". Classes
+					overriding "Render" instead of this function
+					can also be drawn to a memory buffer.
+
+   ============================================================*/
+{
+
+	CDiagramGDIRenderer renderer(dc);
+	Render(&renderer, rect);
+
+}
+
+void CDiagramEntity::Render(CDiagramRenderer* renderer, CRect rect)
+/* ============================================================
+	Function :		CDiagramEntity::Render
+	Description :	Draws the object with a renderer.
+	Access :		Public
+
+	Return :		void
+	Parameters :	CDiagramRenderer* renderer	-	Renderer to
+													draw with.
+					CRect rect					-	The real
+													rectangle of
+													the object.
+
+	Usage :			Override to draw the object to any
+					renderer, not only to a "CDC". The default
+					implementation draws a rectangle, which is
+					also what classes only overriding "Draw"
+					look like when not drawn to a "CDC".
+
+   ============================================================*/
+{
+
+	renderer->SetPen(PS_SOLID, 0, RGB(0, 0, 0));
+	renderer->SetBrush(RGB(255, 255, 255));
+
+	renderer->Rectangle(rect);
+
+}
+
+void CDiagramEntity::RenderObject(CDiagramRenderer* renderer, double zoom)
+/* ============================================================
+	Function :		CDiagramEntity::RenderObject
+	Description :	Top-level rendering function for the
+					object.
+	Access :		Public
+
+	Return :		void
+	Parameters :	CDiagramRenderer* renderer	-	Renderer to
+													draw with.
+					double zoom					-	Zoom level
+													to use.
+
+	Usage :			As "DrawObject", but without selection
+					markers, for exports and snapshots. When
+					the renderer draws to a "CDC", "Draw" is
+					called instead, so entities that only
+					draw with GDI are drawn in full.
+
+					The zoom is only set if it changes, so
+					objects that already have it can be
+					rendered from several threads at once.
+
    ============================================================*/
 {
 
-	dc->SelectStockObject(BLACK_PEN);
-	dc->SelectStockObject(WHITE_BRUSH);
+	if (GetZoom() != zoom)
+		SetZoom(zoom);
 
-	dc->Rectangle(rect);
+	CRect rect(round(GetLeft() * zoom),
+		round(GetTop() * zoom),
+		round(GetRight() * zoom),
+		round(GetBottom() * zoom));
 
+	CDC* dc = renderer->GetDC();
+	if (dc)
+		Draw(dc, rect);
+	else
+		Render(renderer, rect);
 
 }
 
@@ -1290,12 +1383,182 @@ void CDiagramEntity::SetName(CString name)
 
 	Usage :			Call to set the name of the object. Name is
 					a property that the object can use in
-					whatever way it wants.
+					whatever way it wants. Names made by
+					"CLinkFactory" are also kept as numbers,
+					see "GetID".
 
    ============================================================*/
 {
 
+	ULONGLONG id = m_id;
 	m_name = name;
+	if (!CLinkFactory::FromString(m_name, m_id))
+		m_id = LINK_ID_NONE;
+
+	if (m_id != id && m_parent)
+		m_parent->InvalidateObjectIDs();
+
+}
+
+ULONGLONG CDiagramEntity::GetID() const
+/* ============================================================
+	Function :		CDiagramEntity::GetID
+	Description :	Gets the name of the object as a numeric
+					id.
+	Access :		Public
+
+	Return :		ULONGLONG	-	The id, "LINK_ID_NONE" if the
+									name is not a numeric id.
+	Parameters :	none
+
+	Usage :			Links store the ids of the objects they are
+					attached to, and find them with
+					"CDiagramEntityContainer::GetObjectByID".
+
+   ============================================================*/
+{
+
+	return m_id;
+
+}
+
+UINT CDiagramEntity::GetKind() const
+/* ============================================================
+	Function :		CDiagramEntity::GetKind
+	Description :	Gets the kind tag of the object.
+	Access :		Public
+
+	Return :		UINT	-	Kind bits of the object.
+	Parameters :	none
+
+	Usage :			The kind tag has one bit set for each
+					tagged class in the inheritance chain of
+					the object. Containers use it instead of
+					"dynamic_cast" in loops over all objects.
+
+   ============================================================*/
+{
+
+	return m_kind;
+
+}
+
+BOOL CDiagramEntity::IsKind(UINT kind) const
+/* ============================================================
+	Function :		CDiagramEntity::IsKind
+	Description :	Checks if the object is of kind "kind".
+	Access :		Public
+
+	Return :		BOOL		-	"TRUE" if the object is,
+									or derives from, the
+									class tagged "kind".
+	Parameters :	UINT kind	-	Kind bit to test.
+
+	Usage :			Call to test the class of an object
+					without RTTI.
+
+   ============================================================*/
+{
+
+	return (m_kind & kind) != 0;
+
+}
+
+void CDiagramEntity::AddKind(UINT kind)
+/* ============================================================
+	Function :		CDiagramEntity::AddKind
+	Description :	Adds "kind" to the kind tag.
+	Access :		Protected
+
+	Return :		void
+	Parameters :	UINT kind	-	Kind bit to add.
+
+	Usage :			Call from the constructor of a tagged
+					class. Derived classes keep the bits of
+					their base classes, so a test for a base
+					class kind also matches them.
+
+   ============================================================*/
+{
+
+	m_kind |= kind;
+
+}
+
+void CDiagramEntity::InternStrings(CStringTable* table)
+/* ============================================================
+	Function :		CDiagramEntity::InternStrings
+	Description :	Replaces the string members with their
+					interned copies from "table".
+	Access :		Public
+
+	Return :		void
+	Parameters :	CStringTable* table	-	Document string
+											table.
+
+	Usage :			Called by the container when the object is
+					added. Override to intern additional string
+					members that repeat across objects, calling
+					the base class. The name is unique to the
+					object, and is not interned.
+
+   ============================================================*/
+{
+
+	table->InternString(m_type);
+
+}
+
+size_t CDiagramEntity::GetObjectSize() const
+/* ============================================================
+	Function :		CDiagramEntity::GetObjectSize
+	Description :	Gets the size of the object.
+	Access :		Public
+
+	Return :		size_t	-	"sizeof" the class of the
+								object.
+	Parameters :	none
+
+	Usage :			Add "DECLARE_ENTITY_SIZE" to the declaration
+					of derived classes, to return their size.
+
+   ============================================================*/
+{
+
+	return sizeof(CDiagramEntity);
+
+}
+
+void CDiagramEntity::GetMemoryUsage(CDiagramMemoryUsage& usage) const
+/* ============================================================
+	Function :		CDiagramEntity::GetMemoryUsage
+	Description :	Adds the memory held by the object to
+					"usage".
+	Access :		Public
+
+	Return :		void
+	Parameters :	CDiagramMemoryUsage& usage	-	Breakdown
+													to add to.
+
+	Usage :			Called by the container. The object is
+					counted under "Entities" by type. Override
+					to add members held outside the object,
+					calling the base class.
+
+					Embedded property dialogs are part of the
+					object size. Those with a window are also
+					counted under "Property dialogs".
+
+   ============================================================*/
+{
+
+	usage.Add(_T("Entities"), m_type, 1, GetObjectSize());
+	usage.AddString(m_type);
+	usage.AddString(m_title);
+	usage.AddString(m_name);
+
+	if (m_propertydlg && m_propertydlg->m_hWnd)
+		usage.Add(_T("Property dialogs"), m_type, 1, 0);
 
 }
 
@@ -1410,6 +1673,8 @@ void CDiagramEntity::SetLeft(double left)
 {
 
 	m_left = left;
+	if (m_parent)
+		m_parent->UpdateBounds(this);
 
 }
 
@@ -1431,6 +1696,8 @@ void CDiagramEntity::SetRight(double right)
 {
 
 	m_right = right;
+	if (m_parent)
+		m_parent->UpdateBounds(this);
 
 }
 
@@ -1452,6 +1719,8 @@ void CDiagramEntity::SetTop(double top)
 	if (top == m_bottom)
 		top = top;
 	m_top = top;
+	if (m_parent)
+		m_parent->UpdateBounds(this);
 
 }
 
@@ -1473,6 +1742,8 @@ void CDiagramEntity::SetBottom(double bottom)
 {
 
 	m_bottom = bottom;
+	if (m_parent)
+		m_parent->UpdateBounds(this);
 
 }
 
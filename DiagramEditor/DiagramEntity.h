@@ -28,8 +28,24 @@
 
 #define round(a) ( int ) ( a + .5 )
 
+// Entity kind tags. Each library reserves a range of bits,
+// and classes add their bit in the constructor.
+#define KIND_NONE				0x00000000
+#define KIND_UML_MASK			0x0000ff00
+#define KIND_FLOWCHART_MASK		0x00ff0000
+#define KIND_NETWORK_MASK		0xff000000
+
+// Add to the declaration of each entity class, so that
+// "GetObjectSize" returns the size of the actual class.
+#define DECLARE_ENTITY_SIZE(class_name) \
+public: \
+	virtual size_t GetObjectSize() const { return sizeof(class_name); }
+
 class CDiagramEntityContainer;
 class CDiagramPropertyDlg;
+class CStringTable;
+class CDiagramMemoryUsage;
+class CDiagramRenderer;
 
 class CDiagramEntity : public CObject
 {
@@ -99,6 +115,8 @@ public:
 	virtual void	Draw(CDC* dc, CRect rect);
 	virtual HCURSOR GetCursor(int hit) const;
 	virtual void	DrawObject(CDC* dc, double zoom);
+	virtual void	Render(CDiagramRenderer* renderer, CRect rect);
+	void			RenderObject(CDiagramRenderer* renderer, double zoom);
 
 	// Properties
 	virtual CString	GetTitle() const;
@@ -106,10 +124,14 @@ public:
 
 	virtual CString	GetName() const;
 	virtual void	SetName(CString name);
+	ULONGLONG		GetID() const;
 
 	CString			GetType() const;
 	void			SetType(CString type);
 
+	UINT			GetKind() const;
+	BOOL			IsKind(UINT kind) const;
+
 	int				GetGroup() const;
 	void			SetGroup(int group);
 
@@ -122,6 +144,12 @@ public:
 
 	virtual BOOL	AutoGenerateName() const;
 
+	virtual void	InternStrings(CStringTable* table);
+
+	// Memory accounting
+	virtual size_t	GetObjectSize() const;
+	virtual void	GetMemoryUsage(CDiagramMemoryUsage& usage) const;
+
 protected:
 
 	// Selection
@@ -137,6 +165,8 @@ protected:
 
 	void			SetZoom(double zoom);
 
+	void			AddKind(UINT kind);
+
 	void						SetPropertyDialog(CDiagramPropertyDlg* dlg, UINT resid);
 	CDiagramPropertyDlg*		GetPropertyDialog() const;
 
@@ -165,8 +195,12 @@ private:
 	CString m_type;
 	CString m_title;
 	CString m_name;
+	ULONGLONG	m_id;	// "m_name" as a numeric id
 
 	int		m_group;
+	UINT	m_kind;
+
+	INT_PTR	m_boundsIndex;	// Index in the bounds array of the parent
 
 	CDiagramPropertyDlg*		m_propertydlg;
 	UINT						m_propertydlgresid;
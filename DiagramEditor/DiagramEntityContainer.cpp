@@ -91,11 +91,55 @@
 					16/3  2019	Added Redo support, removed PopUndo
    ========================================================================
 					13/1  2022	Added auto-generated name support
+   ========================================================================
+					19/10 2026	Added AddRange, RemoveIf and ReplaceAll
+								to add and remove objects in a single
+								pass. RemoveAllSelected, Undo and Redo
+								use them.
+					19/10 2026	Added FrontIf, BottomIf, UpIf and DownIf
+								to reorder a multi-selection in one pass.
+								Find stops at the first match.
+					19/10 2026	Added a document string table. Strings of
+								added objects are interned.
+					19/10 2026	Names of added objects are reserved in
+								CLinkFactory.
+					19/10 2026	Added a bounds array with the object
+								rectangles. GetTotalSize and GetStartPoint
+								use it. Moved objects update their own
+								entries, and the array is only rebuilt
+								when objects are added, removed or
+								reordered.
+					19/10 2026	Added transactions. Nested operations
+								record a single undo step, and runs of
+								nudges are coalesced.
+					19/10 2026	A coalesced transaction records the
+								rectangles of the objects instead of
+								a copy of the data, so aborting it
+								does not revert the whole run.
+					19/10 2026	Added an entity factory. When it is set,
+								older undo levels are compressed to a
+								temporary file.
+					19/10 2026	Spilled undo levels are saved by the
+								writer thread of the spill, and keep
+								their selection.
+					19/10 2026	Added GetMemoryUsage
+					19/10 2026	Clear releases the unused blocks of the
+								object pools.
+					19/10 2026	Added RenderObjects
+					19/10 2026	Added PrepareRender and RenderRect, to
+								render parts of the diagram from
+								several threads.
+					19/10 2026	Added GetChangeCount
+					19/10 2026	Added GetObjectByID, finding the objects
+								links are attached to through an index
+								sorted by id.
    ========================================================================*/
 
 #include "stdafx.h"
 #include "DiagramEntityContainer.h"
+#include "DiagramTrace.h"
 #include "DiagramEntity.h"
+#include "ObjectPool.h"
 #include "Tokenizer.h"
 #include "GroupFactory.h"
 #include "../UMLEditor/LinkFactory.h"
@@ -126,6 +170,25 @@ CDiagramEntityContainer::CDiagramEntityContainer(CDiagramClipboardHandler* clip)
 {
 
 	m_clip = clip;
+	m_boundsValid = FALSE;
+	m_idsBuilt = 0;
+	m_idChanges = 1;
+	m_changes = 0;
+
+	m_factory = NULL;
+	m_undoMemoryLevels = 8;
+
+	m_transaction = 0;
+	m_transactionKey = TRANSACTION_NONE;
+	m_transactionSnapshot = FALSE;
+	m_transactionCoalesced = FALSE;
+	m_transactionAborted = FALSE;
+	m_coalesce = TRANSACTION_NONE;
+	m_coalesceTick = 0;
+	m_coalesceUndo = 0;
+	m_coalesceGeneration = 0;
+	m_undoGeneration = 0;
+	m_coalesceTime = 1000;
 
 	SetUndoStackSize(0);
 	Clear();
@@ -177,7 +240,8 @@ void CDiagramEntityContainer::Clear()
 	Parameters :	none
 
 	Usage :			Call to remove data from the container. The
-					Paste-array will be kept.
+					Paste-array will be kept. The object pool
+					blocks left unused are released.
 
    ============================================================*/
 {
@@ -185,7 +249,9 @@ void CDiagramEntityContainer::Clear()
 	RemoveAll();
 	ClearUndo();
 	ClearRedo();
+	m_strings.RemoveAll();
 	SetModified(FALSE);
+	CObjectPool::TrimAll();
 
 }
 
@@ -389,12 +455,20 @@ void CDiagramEntityContainer::Add(CDiagramEntity* obj)
 	Parameters :	CDiagramEntity* obj	-	The object to add.
 
 	Usage :			Call to add a new object to the container.
+					The string members of the object are
+					interned in the document string table, and
+					the name is reserved so that new ids will
+					not collide with it.
 
    ============================================================*/
 {
 
 	obj->SetParent(this);
+	obj->InternStrings(&m_strings);
+	CLinkFactory::Reserve(obj->GetName());
 	m_objs.Add(obj);
+	InvalidateBounds();
+	InvalidateObjectIDs();
 	SetModified(TRUE);
 
 }
@@ -440,6 +514,7 @@ void CDiagramEntityContainer::SetAt(INT_PTR index, CDiagramEntity* obj)
 {
 
 	m_objs.SetAt(index, obj);
+	InvalidateBounds();
 	SetModified(TRUE);
 
 }
@@ -465,6 +540,8 @@ void CDiagramEntityContainer::RemoveAt(INT_PTR index)
 	{
 		delete obj;
 		m_objs.RemoveAt(index);
+		InvalidateBounds();
+		InvalidateObjectIDs();
 		SetModified(TRUE);
 	}
 
@@ -499,6 +576,8 @@ void CDiagramEntityContainer::RemoveAll()
 		}
 
 		m_objs.RemoveAll();
+		InvalidateBounds();
+		InvalidateObjectIDs();
 		SetModified(TRUE);
 
 	}
@@ -520,10 +599,136 @@ void CDiagramEntityContainer::RemoveAllSelected()
    ============================================================*/
 {
 
-	INT_PTR max = m_objs.GetSize() - 1;
-	for (INT_PTR t = max; t >= 0; t--)
-		if (GetAt(t)->IsSelected())
-			RemoveAt(t);
+	RemoveIf(IsSelectedPredicate);
+
+}
+
+void CDiagramEntityContainer::AddRange(CObArray* arr)
+/* ============================================================
+	Function :		CDiagramEntityContainer::AddRange
+	Description :	Adds all objects in "arr" to the data.
+	Access :		Public
+
+	Return :		void
+	Parameters :	CObArray* arr	-	The objects to add.
+
+	Usage :			Call to add several new objects to the
+					container at once. The objects are appended
+					in the order of "arr", and the container
+					takes ownership of them. "arr" itself is not
+					modified.
+
+   ============================================================*/
+{
+
+	INT_PTR max = arr->GetSize();
+	if (max)
+	{
+
+		for (INT_PTR t = 0; t < max; t++)
+		{
+			CDiagramEntity* obj = static_cast<CDiagramEntity*>(arr->GetAt(t));
+			obj->SetParent(this);
+			obj->InternStrings(&m_strings);
+			CLinkFactory::Reserve(obj->GetName());
+		}
+
+		m_objs.Append(*arr);
+		InvalidateBounds();
+		InvalidateObjectIDs();
+		SetModified(TRUE);
+
+	}
+
+}
+
+INT_PTR CDiagramEntityContainer::RemoveIf(ENTITYPREDICATE predicate, LPVOID data)
+/* ============================================================
+	Function :		CDiagramEntityContainer::RemoveIf
+	Description :	Removes all objects matching "predicate".
+	Access :		Public
+
+	Return :		INT_PTR					-	The number of
+												removed objects.
+	Parameters :	ENTITYPREDICATE predicate	-	Function
+												returning "TRUE"
+												for objects to
+												remove.
+					LPVOID data				-	Passed to
+												"predicate".
+
+	Usage :			Call to remove a set of objects. The data
+					array is compacted in a single pass, so the
+					cost is linear in the number of objects,
+					regardless of how many are removed.
+					Allocated memory is released. Derived
+					containers that keep data attached to
+					objects should override this function
+					rather than relying on "RemoveAt".
+
+   ============================================================*/
+{
+
+	INT_PTR max = m_objs.GetSize();
+	INT_PTR current = 0;
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		CDiagramEntity* obj = static_cast<CDiagramEntity*>(m_objs.GetAt(t));
+		if (predicate(obj, data))
+			delete obj;
+		else
+			m_objs.SetAt(current++, obj);
+	}
+
+	INT_PTR result = max - current;
+	if (result)
+	{
+		m_objs.SetSize(current);
+		InvalidateBounds();
+		InvalidateObjectIDs();
+		SetModified(TRUE);
+	}
+
+	return result;
+
+}
+
+void CDiagramEntityContainer::ReplaceAll(CObArray* arr)
+/* ============================================================
+	Function :		CDiagramEntityContainer::ReplaceAll
+	Description :	Replaces all data objects with the objects
+					in "arr".
+	Access :		Public
+
+	Return :		void
+	Parameters :	CObArray* arr	-	The new objects.
+
+	Usage :			Call to exchange the complete contents of
+					the container, for example when restoring
+					an undo state. The current objects are
+					deleted, and the container takes ownership
+					of the objects in "arr".
+					The strings are not interned again, as
+					undo states are cloned from objects that
+					already share the interned buffers.
+
+   ============================================================*/
+{
+
+	INT_PTR max = m_objs.GetSize();
+	for (INT_PTR t = 0; t < max; t++)
+		delete static_cast<CDiagramEntity*>(m_objs.GetAt(t));
+
+	m_objs.RemoveAll();
+
+	max = arr->GetSize();
+	for (INT_PTR t = 0; t < max; t++)
+		static_cast<CDiagramEntity*>(arr->GetAt(t))->SetParent(this);
+
+	m_objs.Append(*arr);
+	InvalidateBounds();
+	InvalidateObjectIDs();
+	SetModified(TRUE);
 
 }
 
@@ -994,11 +1199,58 @@ void CDiagramEntityContainer::SetModified(BOOL dirty)
 	Parameters :	BOOL dirty	-	"TRUE" if data is changed.
 
 	Usage :			Call to mark the data as modified.
+					The rectangle array is kept, as moved and
+					resized objects update their own entries.
+					Marking the data as modified also counts
+					a change, see "GetChangeCount".
 
    ============================================================*/
 {
 
 	m_dirty = dirty;
+	if (dirty)
+		m_changes++;
+
+}
+
+UINT CDiagramEntityContainer::GetChangeCount() const
+/* ============================================================
+	Function :		CDiagramEntityContainer::GetChangeCount
+	Description :	Gets the number of changes to the data.
+	Access :		Public
+
+	Return :		UINT	-	The number of times the data
+								was marked as modified.
+	Parameters :	none
+
+	Usage :			Call to see if the data has changed since
+					an earlier call, for example to keep
+					something made from the data until it
+					does. The count is never reset.
+
+   ============================================================*/
+{
+
+	return m_changes;
+
+}
+
+CStringTable* CDiagramEntityContainer::GetStringTable()
+/* ============================================================
+	Function :		CDiagramEntityContainer::GetStringTable
+	Description :	Gets the document string table.
+	Access :		Public
+
+	Return :		CStringTable*	-	The string table.
+	Parameters :	none
+
+	Usage :			Call to intern strings repeated across many
+					objects, such as the current package.
+
+   ============================================================*/
+{
+
+	return &m_strings;
 
 }
 
@@ -1191,6 +1443,7 @@ void CDiagramEntityContainer::Front(CDiagramEntity* obj)
 	{
 		m_objs.RemoveAt(index);
 		m_objs.Add(obj);
+		InvalidateBounds();
 		SetModified(TRUE);
 	}
 
@@ -1215,8 +1468,178 @@ void CDiagramEntityContainer::Bottom(CDiagramEntity* obj)
 	{
 		m_objs.RemoveAt(index);
 		m_objs.InsertAt(0, obj);
+		InvalidateBounds();
+		SetModified(TRUE);
+	}
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramEntityContainer batch z-order
+
+BOOL CDiagramEntityContainer::FrontIf(ENTITYPREDICATE predicate, LPVOID data)
+/* ============================================================
+	Function :		CDiagramEntityContainer::FrontIf
+	Description :	Moves all objects matching "predicate" to
+					the top of the z-order.
+	Access :		Public
+
+	Return :		BOOL					-	"TRUE" if the
+												z-order changed.
+	Parameters :	ENTITYPREDICATE predicate	-	Function
+													returning
+													"TRUE" for
+													objects to
+													move.
+					LPVOID data				-	Passed on to
+												"predicate".
+
+	Usage :			Call to bring several objects to the front
+					at once. The moved objects keep their
+					relative order, as do the rest. This is
+					the same result as calling "Front" for
+					each object from the bottom up, but in a
+					single pass over the data.
+
+   ============================================================*/
+{
+
+	return Partition(predicate, data, TRUE);
+
+}
+
+BOOL CDiagramEntityContainer::BottomIf(ENTITYPREDICATE predicate, LPVOID data)
+/* ============================================================
+	Function :		CDiagramEntityContainer::BottomIf
+	Description :	Moves all objects matching "predicate" to
+					the bottom of the z-order.
+	Access :		Public
+
+	Return :		BOOL					-	"TRUE" if the
+												z-order changed.
+	Parameters :	ENTITYPREDICATE predicate	-	Function
+													returning
+													"TRUE" for
+													objects to
+													move.
+					LPVOID data				-	Passed on to
+												"predicate".
+
+	Usage :			Call to send several objects to the back
+					at once. The moved objects keep their
+					relative order, as do the rest.
+
+   ============================================================*/
+{
+
+	return Partition(predicate, data, FALSE);
+
+}
+
+BOOL CDiagramEntityContainer::UpIf(ENTITYPREDICATE predicate, LPVOID data)
+/* ============================================================
+	Function :		CDiagramEntityContainer::UpIf
+	Description :	Moves all objects matching "predicate" one
+					step up in the z-order.
+	Access :		Public
+
+	Return :		BOOL					-	"TRUE" if the
+												z-order changed.
+	Parameters :	ENTITYPREDICATE predicate	-	Function
+													returning
+													"TRUE" for
+													objects to
+													move.
+					LPVOID data				-	Passed on to
+												"predicate".
+
+	Usage :			Call to move several objects one step up
+					at once. Each matching object swaps place
+					with the non-matching object above it. A
+					run of matching objects already at the top
+					stays where it is, so the moved objects
+					never pass each other.
+
+   ============================================================*/
+{
+
+	BOOL result = FALSE;
+	BOOL blocked = TRUE;
+	for (INT_PTR t = m_objs.GetSize() - 1; t >= 0; t--)
+	{
+		CDiagramEntity* obj = static_cast<CDiagramEntity*>(m_objs.GetAt(t));
+		if (predicate(obj, data))
+		{
+			if (!blocked)
+			{
+				m_objs.SetAt(t, m_objs.GetAt(t + 1));
+				m_objs.SetAt(t + 1, obj);
+				result = TRUE;
+			}
+		}
+		else
+			blocked = FALSE;
+	}
+
+	if (result)
+	{
+		InvalidateBounds();
+		SetModified(TRUE);
+	}
+
+	return result;
+
+}
+
+BOOL CDiagramEntityContainer::DownIf(ENTITYPREDICATE predicate, LPVOID data)
+/* ============================================================
+	Function :		CDiagramEntityContainer::DownIf
+	Description :	Moves all objects matching "predicate" one
+					step down in the z-order.
+	Access :		Public
+
+	Return :		BOOL					-	"TRUE" if the
+												z-order changed.
+	Parameters :	ENTITYPREDICATE predicate	-	Function
+													returning
+													"TRUE" for
+													objects to
+													move.
+					LPVOID data				-	Passed on to
+												"predicate".
+
+	Usage :			Call to move several objects one step down
+					at once. See "UpIf".
+
+   ============================================================*/
+{
+
+	BOOL result = FALSE;
+	BOOL blocked = TRUE;
+	INT_PTR max = m_objs.GetSize();
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		CDiagramEntity* obj = static_cast<CDiagramEntity*>(m_objs.GetAt(t));
+		if (predicate(obj, data))
+		{
+			if (!blocked)
+			{
+				m_objs.SetAt(t, m_objs.GetAt(t - 1));
+				m_objs.SetAt(t - 1, obj);
+				result = TRUE;
+			}
+		}
+		else
+			blocked = FALSE;
+	}
+
+	if (result)
+	{
+		InvalidateBounds();
 		SetModified(TRUE);
 	}
+
+	return result;
+
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -1349,6 +1772,8 @@ void CDiagramEntityContainer::Paste()
    ============================================================*/
 {
 
+	DIAGRAM_TRACE_SPAN(_T("CDiagramEntityContainer::Paste"));
+
 	if (m_clip == NULL)
 		m_clip = &m_internalClip;
 
@@ -1418,17 +1843,171 @@ int CDiagramEntityContainer::Find(CDiagramEntity* testobj)
    ============================================================*/
 {
 
-	int index = -1;
-	CDiagramEntity* obj;
-	int count = 0;
-	while ((obj = GetAt(count)))
+	INT_PTR max = m_objs.GetSize();
+	for (INT_PTR t = 0; t < max; t++)
+		if (m_objs.GetAt(t) == testobj)
+			return static_cast<int>(t);
+
+	return -1;
+
+}
+
+INT_PTR CDiagramEntityContainer::RemoveMarked(const CMapPtrToPtr& marked)
+/* ============================================================
+	Function :		CDiagramEntityContainer::RemoveMarked
+	Description :	Removes all objects that are keys in
+					"marked".
+	Access :		Protected
+
+	Return :		INT_PTR						-	The number of
+													removed objects.
+	Parameters :	const CMapPtrToPtr& marked	-	The objects to
+													remove.
+
+	Usage :			Internal function. Used by derived
+					containers overriding "RemoveIf", when the
+					set of objects to remove must be expanded
+					(for example with attached links) before
+					the data array is compacted.
+
+   ============================================================*/
+{
+
+	INT_PTR result = 0;
+	if (marked.GetCount())
 	{
-		if (obj == testobj)
-			index = count;
-		count++;
+
+		void* value;
+		INT_PTR max = m_objs.GetSize();
+		INT_PTR current = 0;
+		for (INT_PTR t = 0; t < max; t++)
+		{
+			CObject* obj = m_objs.GetAt(t);
+			if (marked.Lookup(obj, value))
+				delete obj;
+			else
+				m_objs.SetAt(current++, obj);
+		}
+
+		result = max - current;
+		if (result)
+		{
+			m_objs.SetSize(current);
+			InvalidateBounds();
+			InvalidateObjectIDs();
+			SetModified(TRUE);
+		}
+
+	}
+
+	return result;
+
+}
+
+BOOL CDiagramEntityContainer::Partition(ENTITYPREDICATE predicate, LPVOID data, BOOL front)
+/* ============================================================
+	Function :		CDiagramEntityContainer::Partition
+	Description :	Stable partition of the data array on
+					"predicate".
+	Access :		Protected
+
+	Return :		BOOL					-	"TRUE" if the
+												order changed.
+	Parameters :	ENTITYPREDICATE predicate	-	Function
+													selecting
+													objects.
+					LPVOID data				-	Passed on to
+												"predicate".
+					BOOL front				-	"TRUE" to put
+												matching
+												objects last
+												(top),
+												"FALSE" to
+												put them
+												first (bottom).
+
+	Usage :			Internal function. Used by "FrontIf" and
+					"BottomIf".
+
+   ============================================================*/
+{
+
+	INT_PTR max = m_objs.GetSize();
+	CObArray moved;
+	moved.SetSize(0, max);
+	INT_PTR current = 0;
+	BOOL result = FALSE;
+
+	if (front)
+	{
+		// Compact the non-matching objects towards the
+		// bottom, then append the matching ones.
+		for (INT_PTR t = 0; t < max; t++)
+		{
+			CObject* obj = m_objs.GetAt(t);
+			if (predicate(static_cast<CDiagramEntity*>(obj), data))
+				moved.Add(obj);
+			else
+			{
+				if (current != t)
+					result = TRUE;
+				m_objs.SetAt(current++, obj);
+			}
+		}
+
+		for (INT_PTR t = 0; t < moved.GetSize(); t++)
+			m_objs.SetAt(current++, moved.GetAt(t));
+	}
+	else
+	{
+		// Compact the non-matching objects towards the
+		// top, then fill in the matching ones below.
+		current = max;
+		for (INT_PTR t = max - 1; t >= 0; t--)
+		{
+			CObject* obj = m_objs.GetAt(t);
+			if (predicate(static_cast<CDiagramEntity*>(obj), data))
+				moved.Add(obj);
+			else
+			{
+				if (--current != t)
+					result = TRUE;
+				m_objs.SetAt(current, obj);
+			}
+		}
+
+		for (INT_PTR t = 0; t < moved.GetSize(); t++)
+			m_objs.SetAt(--current, moved.GetAt(t));
 	}
 
-	return index;
+	if (result)
+	{
+		InvalidateBounds();
+		SetModified(TRUE);
+	}
+
+	return result;
+
+}
+
+BOOL CDiagramEntityContainer::IsSelectedPredicate(CDiagramEntity* obj, LPVOID /*data*/)
+/* ============================================================
+	Function :		CDiagramEntityContainer::IsSelectedPredicate
+	Description :	Predicate matching selected objects.
+	Access :		Public
+
+	Return :		BOOL				-	"TRUE" if "obj" is
+											selected.
+	Parameters :	CDiagramEntity* obj	-	Object to test.
+					LPVOID data			-	Not used.
+
+	Usage :			Used by "RemoveAllSelected", and by the
+					editor for the batch z-order commands.
+
+   ============================================================*/
+{
+
+	return obj->IsSelected();
 
 }
 
@@ -1473,32 +2052,48 @@ void CDiagramEntityContainer::Undo()
 
    ============================================================*/
 {
+	DIAGRAM_TRACE_SPAN(_T("CDiagramEntityContainer::Undo"));
+
 	if (m_undo.GetSize())
 	{
+		// A transaction can't continue an undo step that
+		// has been undone
+		InvalidateCoalescing();
+
+		// We get the last entry from the undo-stack,
+		// reading it back if it is spilled. If it
+		// can't be read, the current data is kept so
+		// the stacks stay in step
+		CUndoItem* undo = static_cast<CUndoItem*>(m_undo.GetAt(m_undo.GetUpperBound()));
+		BOOL loaded = LoadUndoItem(undo);
+
 		// Push the current state to the redo stack
 		Push(&m_redo);
 
-		// We remove all current data
-		RemoveAll();
-
-		// We get the last entry from the undo-stack
-		// and clone it into the container data
-		CUndoItem* undo = static_cast<CUndoItem*>(m_undo.GetAt(m_undo.GetUpperBound()));
-		INT_PTR count = (undo->arr).GetSize();
-		for (INT_PTR t = 0; t < count; t++)
+		if (loaded)
 		{
-			CDiagramEntity* obj = static_cast<CDiagramEntity*>((undo->arr).GetAt(t));
-			Add(obj->Clone());
-		}
+			// Clone the entry into the container data,
+			// replacing all current data
+			INT_PTR count = (undo->arr).GetSize();
+			CObArray arr;
+			arr.SetSize(count);
+			for (INT_PTR t = 0; t < count; t++)
+			{
+				CDiagramEntity* obj = static_cast<CDiagramEntity*>((undo->arr).GetAt(t));
+				arr.SetAt(t, obj->Clone());
+			}
+
+			ReplaceAll(&arr);
 
-		// Set the background color
-		SetColor(undo->col);
+			// Set the background color
+			SetColor(undo->col);
 
-		// Set the saved virtual size as well
-		SetVirtualSize(undo->pt);
+			// Set the saved virtual size as well
+			SetVirtualSize(undo->pt);
+		}
 
 		// We remove the entry from the undo-stack
-		delete undo;
+		DeleteUndoItem(undo);
 
 		m_undo.RemoveAt(m_undo.GetUpperBound());
 	}
@@ -1518,9 +2113,16 @@ void CDiagramEntityContainer::Snapshot()
 					If the undo stack has a maximum size and
 					the stack will grow above the stack limit,
 					the first undo array will be removed.
+					Inside a transaction, only the first call
+					is recorded.
 
    ============================================================*/
 {
+	DIAGRAM_TRACE_SPAN(_T("CDiagramEntityContainer::Snapshot"));
+
+	if (!BeginSnapshot())
+		return;
+
 	// Clear the redo stack
 	ClearRedo();
 
@@ -1548,10 +2150,11 @@ void CDiagramEntityContainer::ClearUndo()
 	{
 		CUndoItem* undo = static_cast<CUndoItem*>(m_undo.GetAt(t));
 		// Remove the stack entry itself.
-		delete undo;
+		DeleteUndoItem(undo);
 	}
 
 	m_undo.RemoveAll();
+	InvalidateCoalescing();
 
 }
 
@@ -1611,149 +2214,1018 @@ int CDiagramEntityContainer::GetUndoStackSize() const
 
 }
 
-void CDiagramEntityContainer::Redo()
+void CDiagramEntityContainer::SetEntityFactory(ENTITYFACTORY factory)
 /* ============================================================
-	Function :		CDiagramEntityContainer::Redo
-	Description :	Sets the container data to the last entry
+	Function :		CDiagramEntityContainer::SetEntityFactory
+	Description :	Sets the function recreating objects from
+					their string representation.
+	Access :		Public
+
+	Return :		void
+	Parameters :	ENTITYFACTORY factory	-	Factory, "NULL"
+												to keep all
+												undo levels in
+												memory.
+
+	Usage :			With a factory, undo levels beyond
+					"GetUndoMemoryLevels" are saved with
+					"GetString", compressed and written to a
+					temporary file, and read back when they
+					are undone or redone. Call before any undo
+					levels are recorded.
+
+   ============================================================*/
+{
+
+	m_factory = factory;
+
+}
+
+void CDiagramEntityContainer::SetUndoMemoryLevels(int levels)
+/* ============================================================
+	Function :		CDiagramEntityContainer::SetUndoMemoryLevels
+	Description :	Sets the number of undo levels kept in
+					memory.
+	Access :		Public
+
+	Return :		void
+	Parameters :	int levels	-	Levels on each of the undo
+									and redo stacks. -1 keeps
+									all levels in memory.
+
+	Usage :			Only used if an entity factory is set.
+
+   ============================================================*/
+{
+
+	m_undoMemoryLevels = levels;
+
+}
+
+int CDiagramEntityContainer::GetUndoMemoryLevels() const
+/* ============================================================
+	Function :		CDiagramEntityContainer::GetUndoMemoryLevels
+	Description :	Gets the number of undo levels kept in
+					memory.
+	Access :		Public
+
+	Return :		int		-	Levels on each stack.
+	Parameters :	none
+
+	Usage :			Call to get the number of levels that are
+					not spilled to disk.
+
+   ============================================================*/
+{
+
+	return m_undoMemoryLevels;
+
+}
+
+void CDiagramEntityContainer::Redo()
+/* ============================================================
+	Function :		CDiagramEntityContainer::Redo
+	Description :	Sets the container data to the last entry
 					in the redo stack.
 	Access :		Public
 
-	Return :		void
+	Return :		void
+	Parameters :	none
+
+	Usage :			Call to redo the last operation
+
+   ============================================================*/
+{
+
+	DIAGRAM_TRACE_SPAN(_T("CDiagramEntityContainer::Redo"));
+
+	if (m_redo.GetSize())
+	{
+		// A transaction can't continue an undo step that
+		// has been redone
+		InvalidateCoalescing();
+
+		// We get the last entry from the redo-stack,
+		// reading it back if it is spilled. If it
+		// can't be read, the current data is kept so
+		// the stacks stay in step
+		CUndoItem* redo = static_cast<CUndoItem*>(m_redo.GetAt(m_redo.GetUpperBound()));
+		BOOL loaded = LoadUndoItem(redo);
+
+		// Push the current state to the undo stack
+		Push(&m_undo);
+
+		if (loaded)
+		{
+			// Clone the entry into the container data,
+			// replacing all current data
+			INT_PTR count = (redo->arr).GetSize();
+			CObArray arr;
+			arr.SetSize(count);
+			for (INT_PTR t = 0; t < count; t++)
+			{
+				CDiagramEntity* obj = static_cast<CDiagramEntity*>((redo->arr).GetAt(t));
+				arr.SetAt(t, obj->Clone());
+			}
+
+			ReplaceAll(&arr);
+
+			// Set the background color
+			SetColor(redo->col);
+
+			// Set the saved virtual size as well
+			SetVirtualSize(redo->pt);
+		}
+
+		// We remove the entry from the redo-stack
+		DeleteUndoItem(redo);
+
+		m_redo.RemoveAt(m_redo.GetUpperBound());
+	}
+}
+
+void CDiagramEntityContainer::Push(CObArray* stack)
+/* ============================================================
+	Function :		CDiagramEntityContainer::PushRedo
+	Description :	Copies the current state of the data to
+					the specified stack.
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Call to add the current state to the stack.
+					If the stack has a maximum size and
+					the stack will grow above the stack limit,
+					the first array will be removed.
+					Older levels are spilled to disk if an
+					entity factory is set.
+
+   ============================================================*/
+{
+	if (m_maxstacksize > 0 && stack->GetSize() == m_maxstacksize)
+	{
+		DeleteUndoItem(static_cast<CUndoItem*>(stack->GetAt(0)));
+		stack->RemoveAt(0);
+	}
+
+	CUndoItem* item = new CUndoItem;
+
+	while (!item && stack->GetSize())
+	{
+		// We seem - however unlikely - to be out of memory.
+		// Remove first element in stack and try again
+		DeleteUndoItem(static_cast<CUndoItem*>(stack->GetAt(0)));
+		stack->RemoveAt(0);
+		item = new CUndoItem;
+	}
+
+	if (item)
+	{
+		// Save the background color
+		item->col = GetColor();
+
+		// Save current virtual size
+		item->pt = GetVirtualSize();
+
+		// Save all objects
+		INT_PTR count = m_objs.GetSize();
+		for (INT_PTR t = 0; t < count; t++)
+			(item->arr).Add(GetAt(t)->Clone());
+
+		// Add to stack
+		stack->Add(item);
+		SpillStack(stack);
+	}
+}
+
+void CDiagramEntityContainer::ClearRedo()
+/* ============================================================
+	Function :		CDiagramEntityContainer::ClearRedo
+	Description :	Remove all redo arrays from the redo stack
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Call to clear the redo-stack. All memory will
+					be deleted.
+
+   ============================================================*/
+{
+
+	INT_PTR count = m_redo.GetSize() - 1;
+	for (INT_PTR t = count; t >= 0; t--)
+	{
+		CUndoItem* redo = static_cast<CUndoItem*>(m_redo.GetAt(t));
+		// Remove the stack entry itself.
+		DeleteUndoItem(redo);
+	}
+
+	m_redo.RemoveAll();
+
+}
+
+BOOL CDiagramEntityContainer::IsRedoPossible() const
+/* ============================================================
+	Function :		CDiagramEntityContainer::IsRedoPossible
+	Description :	Check if it is possible to redo.
+	Access :		Public
+
+	Return :		BOOL	-	"TRUE" if redo is possible.
+	Parameters :	none
+
+	Usage :			Use this call for command enabling
+
+   ============================================================*/
+{
+
+	return m_redo.GetSize() > 0;
+
+}
+
+INT_PTR CDiagramEntityContainer::GetUndoLevels() const
+/* ============================================================
+	Function :		CDiagramEntityContainer::GetUndoLevels
+	Description :	Gets the number of entries on the undo
+					stack.
+	Access :		Public
+
+	Return :		INT_PTR	-	Undo levels, in memory or
+								spilled.
+	Parameters :	none
+
+	Usage :			Call to get undo statistics.
+
+   ============================================================*/
+{
+
+	return m_undo.GetSize();
+
+}
+
+INT_PTR CDiagramEntityContainer::GetRedoLevels() const
+/* ============================================================
+	Function :		CDiagramEntityContainer::GetRedoLevels
+	Description :	Gets the number of entries on the redo
+					stack.
+	Access :		Public
+
+	Return :		INT_PTR	-	Redo levels, in memory or
+								spilled.
+	Parameters :	none
+
+	Usage :			Call to get undo statistics.
+
+   ============================================================*/
+{
+
+	return m_redo.GetSize();
+
+}
+
+INT_PTR CDiagramEntityContainer::GetUndoObjectCount() const
+/* ============================================================
+	Function :		CDiagramEntityContainer::GetUndoObjectCount
+	Description :	Counts the objects kept in memory by the
+					undo and redo stacks.
+	Access :		Public
+
+	Return :		INT_PTR	-	Number of cloned objects.
+	Parameters :	none
+
+	Usage :			Spilled levels are not counted, see
+					"GetUndoSpillSize".
+
+   ============================================================*/
+{
+
+	INT_PTR result = 0;
+	const CObArray* stacks[2] = { &m_undo, &m_redo };
+	for (int s = 0; s < 2; s++)
+	{
+		INT_PTR max = stacks[s]->GetSize();
+		for (INT_PTR t = 0; t < max; t++)
+		{
+			CUndoItem* item = static_cast<CUndoItem*>(stacks[s]->GetAt(t));
+			if (item->spill == -1)
+				result += item->arr.GetSize();
+		}
+	}
+
+	return result;
+
+}
+
+ULONGLONG CDiagramEntityContainer::GetUndoSpillSize() const
+/* ============================================================
+	Function :		CDiagramEntityContainer::GetUndoSpillSize
+	Description :	Gets the size of the file holding the
+					spilled undo levels.
+	Access :		Public
+
+	Return :		ULONGLONG	-	Size in bytes, 0 if nothing
+									is spilled.
+	Parameters :	none
+
+	Usage :			Call to get undo statistics.
+
+   ============================================================*/
+{
+
+	return m_spill.GetFileSize();
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramEntityContainer memory accounting
+
+void CDiagramEntityContainer::GetMemoryUsage(CDiagramMemoryUsage& usage) const
+/* ============================================================
+	Function :		CDiagramEntityContainer::GetMemoryUsage
+	Description :	Adds the memory held by the container to
+					"usage".
+	Access :		Public
+
+	Return :		void
+	Parameters :	CDiagramMemoryUsage& usage	-	Breakdown
+													to add to.
+
+	Usage :			Call to get a breakdown of the memory of
+					the diagram, the undo and redo stacks and
+					the clipboard, for example to choose the
+					undo stack size. Override to add data of
+					derived containers, calling the base class.
+
+					The objects are added first, so strings
+					shared with the undo stack, the clipboard
+					and the string table are counted with the
+					diagram. Objects left in the undo stack or
+					the clipboard by a leaking clone will show
+					under their scope.
+
+					The clipboard can be shared by several
+					containers, and is then counted by each.
+
+   ============================================================*/
+{
+
+	CString scope = usage.GetScope();
+
+	// The diagram
+	INT_PTR max = m_objs.GetSize();
+	usage.Add(_T("Entities"), _T("Object array"), 1, max * sizeof(CObject*));
+	for (INT_PTR t = 0; t < max; t++)
+		static_cast<CDiagramEntity*>(m_objs.GetAt(t))->GetMemoryUsage(usage);
+
+	// Undo and redo levels
+	const CObArray* stacks[2] = { &m_undo, &m_redo };
+	LPCTSTR scopes[2] = { _T("Undo"), _T("Redo") };
+	for (int s = 0; s < 2; s++)
+	{
+		usage.SetScope(scopes[s]);
+		INT_PTR levels = stacks[s]->GetSize();
+		for (INT_PTR t = 0; t < levels; t++)
+		{
+			CUndoItem* item = static_cast<CUndoItem*>(stacks[s]->GetAt(t));
+			if (item->spill == -1)
+			{
+				INT_PTR objects = item->arr.GetSize();
+				usage.Add(_T("Levels"), _T("In memory"), 1, sizeof(CUndoItem) + sizeof(CObject*) + objects * sizeof(CObject*));
+				for (INT_PTR i = 0; i < objects; i++)
+					static_cast<CDiagramEntity*>(item->arr.GetAt(i))->GetMemoryUsage(usage);
+			}
+			else
+			{
+				usage.Add(_T("Levels"), _T("Spilled"), 1, sizeof(CUndoItem) + sizeof(CObject*));
+			}
+		}
+	}
+
+	usage.SetScope(scope);
+	ULONGLONG spilled = m_spill.GetFileSize();
+	if (spilled)
+		usage.AddDisk(_T("Undo"), _T("Spill file"), 1, spilled);
+
+	// The clipboard
+	if (m_clip)
+	{
+		usage.SetScope(_T("Clipboard"));
+		m_clip->GetMemoryUsage(usage);
+		usage.SetScope(scope);
+	}
+
+	// Strings no object uses any longer
+	m_strings.GetMemoryUsage(usage);
+
+	// The bounds array and the data it was built from
+	usage.Add(_T("Bounds"), _T("Rectangles"), m_bounds.GetSize(), m_bounds.GetSize() * 4 * sizeof(double));
+	usage.Add(_T("Bounds"), _T("Object array"), 1, m_boundsObjs.GetSize() * sizeof(CObject*));
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramEntityContainer rendering
+
+void CDiagramEntityContainer::RenderObjects(CDiagramRenderer* renderer, double zoom)
+/* ============================================================
+	Function :		CDiagramEntityContainer::RenderObjects
+	Description :	Renders all objects, bottom to top.
+	Access :		Public
+
+	Return :		void
+	Parameters :	CDiagramRenderer* renderer	-	Renderer to
+													draw with.
+					double zoom					-	Zoom level.
+
+	Usage :			Draws the diagram without an editor, for
+					snapshots and exports. Selection markers
+					are not drawn. Override "PrepareRender"
+					and "RenderRect" to draw links or other
+					data kept by the container.
+
+   ============================================================*/
+{
+
+	DIAGRAM_TRACE_SPAN(_T("CDiagramEntityContainer::RenderObjects"));
+
+	PrepareRender(zoom);
+
+	// Everything
+	RenderRect(renderer, CRect(INT_MIN / 2, INT_MIN / 2, INT_MAX / 2, INT_MAX / 2), zoom);
+
+}
+
+void CDiagramEntityContainer::PrepareRender(double zoom)
+/* ============================================================
+	Function :		CDiagramEntityContainer::PrepareRender
+	Description :	Brings everything "RenderRect" reads up
+					to date.
+	Access :		Public
+
+	Return :		void
+	Parameters :	double zoom	-	Zoom level.
+
+	Usage :			Call before "RenderRect", from the thread
+					owning the data. Sets the zoom of all
+					objects and updates the bounds. Override to
+					update data drawn by "RenderRect", and call
+					the base class.
+
+   ============================================================*/
+{
+
+	INT_PTR count = GetSize();
+	for (INT_PTR t = 0; t < count; t++)
+	{
+		CDiagramEntity* obj = GetAt(t);
+		if (obj->GetZoom() != zoom)
+			obj->SetZoom(zoom);
+	}
+
+	GetBounds();
+
+}
+
+void CDiagramEntityContainer::RenderRect(CDiagramRenderer* renderer, const CRect& rect, double zoom)
+/* ============================================================
+	Function :		CDiagramEntityContainer::RenderRect
+	Description :	Renders the objects touching a rectangle,
+					bottom to top.
+	Access :		Public
+
+	Return :		void
+	Parameters :	CDiagramRenderer* renderer	-	Renderer to
+													draw with.
+					const CRect& rect			-	Rectangle to
+													draw, zoomed.
+					double zoom					-	Zoom level.
+
+	Usage :			Call "PrepareRender" first. Objects are
+					culled with the bounds, widened by
+					"RENDER_MARGIN". Nothing is changed, so
+					tiles of the same diagram can be rendered
+					from several threads at once, each with its
+					own renderer.
+
+   ============================================================*/
+{
+
+	const CBoundsArray* bounds = GetBounds();
+	CDWordArray indices;
+	INT_PTR count = bounds->GetIntersecting(
+		rect.left / zoom - RENDER_MARGIN,
+		rect.top / zoom - RENDER_MARGIN,
+		rect.right / zoom + RENDER_MARGIN,
+		rect.bottom / zoom + RENDER_MARGIN,
+		indices);
+
+	for (INT_PTR t = 0; t < count; t++)
+		GetAt(indices[t])->RenderObject(renderer, zoom);
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramEntityContainer transactions
+
+void CDiagramEntityContainer::BeginTransaction(UINT coalesce)
+/* ============================================================
+	Function :		CDiagramEntityContainer::BeginTransaction
+	Description :	Starts a transaction.
+	Access :		Public
+
+	Return :		void
+	Parameters :	UINT coalesce	-	Key for coalescing, or
+										"TRANSACTION_NONE".
+
+	Usage :			Call before an operation made up of other
+					operations, and "CommitTransaction" or
+					"AbortTransaction" after it. Transactions
+					can be nested. Only the first "Snapshot"
+					inside the outermost transaction is
+					recorded, so the whole operation is undone
+					in one step.
+					If "coalesce" is the same as for the last
+					committed transaction, less than
+					"GetCoalesceTime" ago and with no other
+					undo step, undo or redo in between, the
+					transaction continues the undo step of the
+					last one.
+					This makes a run of keyboard nudges a
+					single undo step. Instead of a copy of the
+					data, only the rectangles of the objects
+					are recorded, so that it can be aborted on
+					its own. Coalesced transactions should
+					only move and resize objects.
+
+   ============================================================*/
+{
+
+	if (m_transaction == 0)
+	{
+		m_transactionKey = coalesce;
+		m_transactionAborted = FALSE;
+		m_transactionSnapshot = FALSE;
+		m_transactionCoalesced = (coalesce != TRANSACTION_NONE &&
+			coalesce == m_coalesce &&
+			GetUndo()->GetSize() == m_coalesceUndo &&
+			m_undoGeneration == m_coalesceGeneration &&
+			::GetTickCount() - m_coalesceTick <= m_coalesceTime);
+	}
+
+	m_transaction++;
+
+}
+
+void CDiagramEntityContainer::CommitTransaction()
+/* ============================================================
+	Function :		CDiagramEntityContainer::CommitTransaction
+	Description :	Ends a transaction.
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Call after the operation started by
+					"BeginTransaction". If an inner transaction
+					was aborted, ending the outermost
+					transaction aborts it as well.
+
+   ============================================================*/
+{
+
+	if (m_transaction > 0)
+	{
+		if (m_transaction == 1 && m_transactionAborted)
+		{
+			AbortTransaction();
+		}
+		else if (--m_transaction == 0 && m_transactionSnapshot)
+		{
+			m_transactionObjs.RemoveAll();
+
+			// A later transaction with the same key may
+			// continue this undo step
+			m_coalesce = m_transactionKey;
+			m_coalesceTick = ::GetTickCount();
+			m_coalesceUndo = GetUndo()->GetSize();
+			m_coalesceGeneration = m_undoGeneration;
+		}
+	}
+
+}
+
+BOOL CDiagramEntityContainer::AbortTransaction()
+/* ============================================================
+	Function :		CDiagramEntityContainer::AbortTransaction
+	Description :	Ends a transaction, restoring the data to
+					the state before it.
+	Access :		Public
+
+	Return :		BOOL	-	"TRUE" if the data was restored.
+	Parameters :	none
+
+	Usage :			Call instead of "CommitTransaction" if the
+					operation fails. Aborting an inner
+					transaction only marks the outermost one,
+					the data is restored when it ends. The
+					data is restored from the state recorded
+					by the first "Snapshot" in the
+					transaction. Operations calling
+					"Snapshot" before changing the data are
+					restored correctly. A coalesced
+					transaction only restores the rectangles
+					of the objects, so it only reverts
+					itself, not the run it continued.
+
+   ============================================================*/
+{
+
+	BOOL result = FALSE;
+	if (m_transaction > 0)
+	{
+		m_transactionAborted = TRUE;
+		if (--m_transaction == 0)
+		{
+			m_coalesce = TRANSACTION_NONE;
+			if (m_transactionSnapshot && m_transactionCoalesced)
+			{
+				result = RestoreTransactionRects();
+			}
+			else if (m_transactionSnapshot && IsUndoPossible())
+			{
+				// Undo also pushes the current state to the
+				// redo stack, which the transaction had cleared
+				Undo();
+				ClearRedo();
+				result = TRUE;
+			}
+		}
+	}
+
+	return result;
+
+}
+
+BOOL CDiagramEntityContainer::IsInTransaction() const
+/* ============================================================
+	Function :		CDiagramEntityContainer::IsInTransaction
+	Description :	Checks if a transaction is running.
+	Access :		Public
+
+	Return :		BOOL	-	"TRUE" if in a transaction.
+	Parameters :	none
+
+	Usage :			Call to check if work, such as redrawing,
+					can be deferred to the end of the
+					transaction.
+
+   ============================================================*/
+{
+
+	return m_transaction > 0;
+
+}
+
+void CDiagramEntityContainer::SetCoalesceTime(DWORD time)
+/* ============================================================
+	Function :		CDiagramEntityContainer::SetCoalesceTime
+	Description :	Sets the time a run of transactions is
+					coalesced over.
+	Access :		Public
+
+	Return :		void
+	Parameters :	DWORD time	-	Time in milliseconds.
+
+	Usage :			A transaction is coalesced with the previous
+					one if it starts less than "time"
+					milliseconds after it was committed. The
+					default is one second.
+
+   ============================================================*/
+{
+
+	m_coalesceTime = time;
+
+}
+
+DWORD CDiagramEntityContainer::GetCoalesceTime() const
+/* ============================================================
+	Function :		CDiagramEntityContainer::GetCoalesceTime
+	Description :	Gets the time a run of transactions is
+					coalesced over.
+	Access :		Public
+
+	Return :		DWORD	-	Time in milliseconds.
+	Parameters :	none
+
+	Usage :			Call to get the coalescing time.
+
+   ============================================================*/
+{
+
+	return m_coalesceTime;
+
+}
+
+void CDiagramEntityContainer::InvalidateCoalescing()
+/* ============================================================
+	Function :		CDiagramEntityContainer::InvalidateCoalescing
+	Description :	Stops the next transaction from continuing
+					the undo step of the last one.
+	Access :		Protected
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Called when the undo stack is undone,
+					redone or cleared. The size of the stack
+					can be the same afterwards, so the number
+					of such changes is compared as well. Call
+					from overrides of "Undo" and "Redo" that
+					do not call the base class.
+
+   ============================================================*/
+{
+
+	m_undoGeneration++;
+
+}
+
+BOOL CDiagramEntityContainer::BeginSnapshot()
+/* ============================================================
+	Function :		CDiagramEntityContainer::BeginSnapshot
+	Description :	Checks if a snapshot should be recorded.
+	Access :		Protected
+
+	Return :		BOOL	-	"TRUE" if the snapshot should
+								be recorded.
 	Parameters :	none
 
-	Usage :			Call to redo the last operation
+	Usage :			Call first in "Snapshot" and its overrides,
+					returning if "FALSE". Inside a transaction,
+					only the first snapshot is recorded. A
+					coalesced transaction continues the undo
+					step of the last one, so it records no
+					snapshot, only the rectangles of the
+					objects. Outside a transaction, any
+					snapshot ends a run of coalesced
+					transactions.
 
    ============================================================*/
 {
 
-	if (m_redo.GetSize())
+	if (m_transaction > 0)
 	{
-		// Push the current state to the undo stack
-		Push(&m_undo);
-
-		// We remove all current data
-		RemoveAll();
+		if (m_transactionSnapshot)
+			return FALSE;
 
-		// We get the last entry from the redo-stack
-		// and clone it into the container data
-		CUndoItem* redo = static_cast<CUndoItem*>(m_redo.GetAt(m_redo.GetUpperBound()));
-		INT_PTR count = (redo->arr).GetSize();
-		for (INT_PTR t = 0; t < count; t++)
+		m_transactionSnapshot = TRUE;
+		if (m_transactionCoalesced)
 		{
-			CDiagramEntity* obj = static_cast<CDiagramEntity*>((redo->arr).GetAt(t));
-			Add(obj->Clone());
+			SaveTransactionRects();
+			return FALSE;
 		}
+	}
+	else
+	{
+		m_coalesce = TRANSACTION_NONE;
+	}
 
-		// Set the background color
-		SetColor(redo->col);
-
-		// Set the saved virtual size as well
-		SetVirtualSize(redo->pt);
-
-		// We remove the entry from the redo-stack
-		delete redo;
+	return TRUE;
 
-		m_redo.RemoveAt(m_redo.GetUpperBound());
-	}
 }
 
-void CDiagramEntityContainer::Push(CObArray* stack)
+void CDiagramEntityContainer::SaveTransactionRects()
 /* ============================================================
-	Function :		CDiagramEntityContainer::PushRedo
-	Description :	Copies the current state of the data to
-					the specified stack.
-	Access :		Public
+	Function :		CDiagramEntityContainer::SaveTransactionRects
+	Description :	Records the objects and their rectangles.
+	Access :		Private
 
 	Return :		void
 	Parameters :	none
 
-	Usage :			Call to add the current state to the stack.
-					If the stack has a maximum size and
-					the stack will grow above the stack limit,
-					the first array will be removed.
+	Usage :			Called by "BeginSnapshot" in a coalesced
+					transaction, in place of a snapshot. All
+					objects are recorded, as moving an object
+					can also move the lines attached to it.
 
    ============================================================*/
 {
-	if (m_maxstacksize > 0 && stack->GetSize() == m_maxstacksize)
+
+	INT_PTR max = m_objs.GetSize();
+	m_transactionObjs.Copy(m_objs);
+	m_transactionRects.SetSize(max);
+	for (INT_PTR t = 0; t < max; t++)
 	{
-		delete stack->GetAt(0);
-		stack->RemoveAt(0);
+		CDiagramEntity* obj = static_cast<CDiagramEntity*>(m_objs.GetAt(t));
+		m_transactionRects.SetAt(t, obj->GetLeft(), obj->GetTop(), obj->GetRight(), obj->GetBottom());
 	}
 
-	CUndoItem* item = new CUndoItem;
+}
 
-	while (!item && stack->GetSize())
+BOOL CDiagramEntityContainer::RestoreTransactionRects()
+/* ============================================================
+	Function :		CDiagramEntityContainer::RestoreTransactionRects
+	Description :	Moves the objects back to the rectangles
+					recorded by "SaveTransactionRects".
+	Access :		Private
+
+	Return :		BOOL	-	"TRUE" if the data was restored.
+	Parameters :	none
+
+	Usage :			Called when a coalesced transaction is
+					aborted. If objects were added or removed
+					since they were recorded, the data can't
+					be restored and is left as it is.
+
+   ============================================================*/
+{
+
+	BOOL result = FALSE;
+	INT_PTR max = m_transactionObjs.GetSize();
+	if (max == m_objs.GetSize())
 	{
-		// We seem - however unlikely - to be out of memory.
-		// Remove first element in stack and try again
-		delete stack->GetAt(0);
-		stack->RemoveAt(0);
-		item = new CUndoItem;
+		INT_PTR t = 0;
+		while (t < max && m_transactionObjs.GetAt(t) == m_objs.GetAt(t))
+			t++;
+
+		if (t == max)
+		{
+			for (t = 0; t < max; t++)
+			{
+				CDiagramEntity* obj = static_cast<CDiagramEntity*>(m_objs.GetAt(t));
+				obj->SetRect(m_transactionRects.GetAt(t, BOUNDS_LEFT), m_transactionRects.GetAt(t, BOUNDS_TOP),
+					m_transactionRects.GetAt(t, BOUNDS_RIGHT), m_transactionRects.GetAt(t, BOUNDS_BOTTOM));
+			}
+
+			SetModified(TRUE);
+			result = TRUE;
+		}
 	}
 
-	if (item)
+	m_transactionObjs.RemoveAll();
+	return result;
+
+}
+
+void CDiagramEntityContainer::SpillStack(CObArray* stack)
+/* ============================================================
+	Function :		CDiagramEntityContainer::SpillStack
+	Description :	Moves the older levels of a stack to the
+					spill file.
+	Access :		Protected
+
+	Return :		void
+	Parameters :	CObArray* stack	-	Undo or redo stack.
+
+	Usage :			Called by "Push" after a level is added.
+					The objects of each level are handed to
+					the spill, which saves them with
+					"GetString", one per line, and deletes
+					them on its writer thread. The selection
+					is not part of the string, and is kept in
+					the level. A level that can't be spilled
+					is kept in memory.
+
+   ============================================================*/
+{
+
+	if (!m_factory || m_undoMemoryLevels < 0)
+		return;
+
+	for (INT_PTR t = stack->GetSize() - m_undoMemoryLevels - 1; t >= 0; t--)
 	{
-		// Save the background color
-		item->col = GetColor();
+		CUndoItem* item = static_cast<CUndoItem*>(stack->GetAt(t));
 
-		// Save current virtual size
-		item->pt = GetVirtualSize();
+		// Levels below a spilled one are spilled as well
+		if (item->spill != -1)
+			break;
 
-		// Save all objects
-		INT_PTR count = m_objs.GetSize();
-		for (INT_PTR t = 0; t < count; t++)
-			(item->arr).Add(GetAt(t)->Clone());
+		INT_PTR count = (item->arr).GetSize();
+		(item->selected).SetSize(count);
+		for (INT_PTR i = 0; i < count; i++)
+			(item->selected)[i] = static_cast<BYTE>(static_cast<CDiagramEntity*>((item->arr).GetAt(i))->IsSelected());
 
-		// Add to stack
-		stack->Add(item);
+		item->spill = m_spill.Write(item->arr, SaveSpilled);
+		if (item->spill == -1)
+		{
+			(item->selected).RemoveAll();
+			return;
+		}
 	}
+
 }
 
-void CDiagramEntityContainer::ClearRedo()
+void CDiagramEntityContainer::SaveSpilled(const CObArray& objects, CString& data)
 /* ============================================================
-	Function :		CDiagramEntityContainer::ClearRedo
-	Description :	Remove all redo arrays from the redo stack
-	Access :		Public
+	Function :		CDiagramEntityContainer::SaveSpilled
+	Description :	Saves the objects of a spilled level.
+	Access :		Protected
 
 	Return :		void
-	Parameters :	none
+	Parameters :	const CObArray& objects	-	Objects of the
+												level.
+					CString& data			-	Gets the
+												objects, one
+												per line.
 
-	Usage :			Call to clear the redo-stack. All memory will
-					be deleted.
+	Usage :			Called by the writer thread of the spill.
+					Only "GetString" is called on the objects,
+					which are copies owned by the spill.
 
    ============================================================*/
 {
 
-	INT_PTR count = m_redo.GetSize() - 1;
-	for (INT_PTR t = count; t >= 0; t--)
+	INT_PTR count = objects.GetSize();
+	for (INT_PTR i = 0; i < count; i++)
 	{
-		CUndoItem* redo = static_cast<CUndoItem*>(m_redo.GetAt(t));
-		// Remove the stack entry itself.
-		delete redo;
+		if (i)
+			data += _T("\r\n");
+		data += static_cast<const CDiagramEntity*>(objects.GetAt(i))->GetString();
 	}
 
-	m_redo.RemoveAll();
+}
+
+BOOL CDiagramEntityContainer::LoadUndoItem(CUndoItem* item)
+/* ============================================================
+	Function :		CDiagramEntityContainer::LoadUndoItem
+	Description :	Reads a spilled level back into memory.
+	Access :		Protected
+
+	Return :		BOOL			-	"FALSE" if the spill
+										file could not be read.
+	Parameters :	CUndoItem* item	-	Level to read.
+
+	Usage :			Call before the objects of a level are
+					used. Does nothing if the level is in
+					memory. The objects are selected as they
+					were when the level was spilled.
+
+   ============================================================*/
+{
+
+	if (item->spill == -1)
+		return TRUE;
+
+	CString data;
+	BOOL result = m_spill.Read(item->spill, data);
+	if (result)
+	{
+		int length = data.GetLength();
+		int start = 0;
+		INT_PTR line = 0;
+		while (start < length)
+		{
+			int end = data.Find(_T("\r\n"), start);
+			if (end == -1)
+				end = length;
+
+			CDiagramEntity* obj = m_factory(data.Mid(start, end - start));
+			if (obj)
+			{
+				obj->Select(line < (item->selected).GetSize() && (item->selected)[line]);
+				(item->arr).Add(obj);
+			}
+
+			start = end + 2;
+			line++;
+		}
+	}
+
+	m_spill.Free(item->spill);
+	item->spill = -1;
+	(item->selected).RemoveAll();
+
+	return result;
 
 }
 
-BOOL CDiagramEntityContainer::IsRedoPossible() const
+void CDiagramEntityContainer::DeleteUndoItem(CUndoItem* item)
 /* ============================================================
-	Function :		CDiagramEntityContainer::IsRedoPossible
-	Description :	Check if it is possible to redo.
-	Access :		Public
+	Function :		CDiagramEntityContainer::DeleteUndoItem
+	Description :	Deletes a level of the undo or redo stack.
+	Access :		Protected
 
-	Return :		BOOL	-	"TRUE" if redo is possible.
-	Parameters :	none
+	Return :		void
+	Parameters :	CUndoItem* item	-	Level to delete.
 
-	Usage :			Use this call for command enabling
+	Usage :			Releases the spill block of the level as
+					well.
 
    ============================================================*/
 {
 
-	return m_redo.GetSize() > 0;
+	if (item->spill != -1)
+		m_spill.Free(item->spill);
+
+	delete item;
 
 }
 
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramEntityContainer private helpers
+
 CObArray* CDiagramEntityContainer::GetData()
 /* ============================================================
 	Function :		CDiagramEntityContainer::GetData
@@ -1915,22 +3387,10 @@ CSize CDiagramEntityContainer::GetTotalSize()
    ============================================================*/
 {
 	CPoint start = GetStartPoint();
-	double width = 0;
-	double height = 0;
-
-	CDiagramEntity* obj;
-	int count = 0;
-	while ((obj = GetAt(count)))
-	{
-
-		width = max(width, obj->GetLeft());
-		width = max(width, obj->GetRight());
-		height = max(height, obj->GetTop());
-		height = max(height, obj->GetBottom());
-
-		count++;
+	const CBoundsArray* bounds = GetBounds();
 
-	}
+	double width = bounds->GetMax(BOUNDS_RIGHT, bounds->GetMax(BOUNDS_LEFT, 0));
+	double height = bounds->GetMax(BOUNDS_BOTTOM, bounds->GetMax(BOUNDS_TOP, 0));
 
 	return CSize(round(width - start.x), round(height - start.y));
 
@@ -1954,25 +3414,244 @@ CPoint CDiagramEntityContainer::GetStartPoint()
    ============================================================*/
 {
 
-	double startx = 2000.0;
-	double starty = 2000.0;
+	const CBoundsArray* bounds = GetBounds();
 
-	CDiagramEntity* obj;
-	int count = 0;
+	double startx = bounds->GetMin(BOUNDS_RIGHT, bounds->GetMin(BOUNDS_LEFT, 2000.0));
+	double starty = bounds->GetMin(BOUNDS_BOTTOM, bounds->GetMin(BOUNDS_TOP, 2000.0));
 
-	while ((obj = GetAt(count)))
+	return CPoint(round(startx), round(starty));
+
+}
+
+const CBoundsArray* CDiagramEntityContainer::GetBounds()
+/* ============================================================
+	Function :		CDiagramEntityContainer::GetBounds
+	Description :	Gets the rectangles of the objects in the
+					container.
+	Access :		Public
+
+	Return :		const CBoundsArray*	-	The rectangles.
+	Parameters :	none
+
+	Usage :			Call to run calculations over the object
+					rectangles without visiting the objects.
+					Index "t" in the array is the rectangle of
+					"GetAt( t )". The array is rebuilt if
+					objects have been added, removed or
+					reordered since the last call, and is
+					updated directly when objects are moved
+					or resized. The pointer is valid until the
+					container is destroyed.
+
+   ============================================================*/
+{
+
+	INT_PTR max = m_objs.GetSize();
+	if (m_boundsValid && max == m_boundsObjs.GetSize())
 	{
+		// The array could have been changed through
+		// "GetData", so the object order is checked.
+		// This only compares two arrays of pointers.
+		if (max == 0 || memcmp(m_objs.GetData(), m_boundsObjs.GetData(), max * sizeof(CObject*)) == 0)
+			return &m_bounds;
+	}
 
-		startx = min(startx, obj->GetLeft());
-		startx = min(startx, obj->GetRight());
-		starty = min(starty, obj->GetTop());
-		starty = min(starty, obj->GetBottom());
+	m_boundsObjs.Copy(m_objs);
+	m_bounds.SetSize(max);
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		static_cast<CDiagramEntity*>(m_objs.GetAt(t))->m_boundsIndex = t;
 
-		count++;
+		CDiagramEntity* obj = GetAt(t);
+		m_bounds.SetAt(t, obj->GetLeft(), obj->GetTop(), obj->GetRight(), obj->GetBottom());
+	}
+
+	m_boundsValid = TRUE;
+
+	return &m_bounds;
+
+}
+
+void CDiagramEntityContainer::InvalidateBounds()
+/* ============================================================
+	Function :		CDiagramEntityContainer::InvalidateBounds
+	Description :	Marks the rectangle array as outdated.
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Called when objects are added, removed or
+					reordered. Call from derived classes if
+					"GetAt" will return other objects than
+					before, for example when the current UML
+					package is changed, and after removing
+					objects through "GetData".
+
+   ============================================================*/
+{
+
+	m_boundsValid = FALSE;
+
+}
+
+void CDiagramEntityContainer::UpdateBounds(CDiagramEntity* obj)
+/* ============================================================
+	Function :		CDiagramEntityContainer::UpdateBounds
+	Description :	Updates the rectangle of "obj" in the
+					rectangle array.
+	Access :		Public
+
+	Return :		void
+	Parameters :	CDiagramEntity* obj	-	Object that was moved
+											or resized.
+
+	Usage :			Called by "CDiagramEntity" when an edge is
+					changed. Objects that are not in the
+					container, such as undo and clipboard
+					copies, are ignored.
+
+   ============================================================*/
+{
 
+	if (!m_boundsValid)
+		return;
+
+	INT_PTR index = obj->m_boundsIndex;
+	if (index >= 0 && index < m_boundsObjs.GetSize() && m_boundsObjs.GetAt(index) == obj)
+	{
+		if (GetAt(index) == obj)
+			m_bounds.SetAt(index, obj->GetLeft(), obj->GetTop(), obj->GetRight(), obj->GetBottom());
 	}
 
-	return CPoint(round(startx), round(starty));
+}
+
+static int CompareObjectIDs(const void* a, const void* b)
+{
+	ULONGLONG first = *static_cast<const ULONGLONG*>(a);
+	ULONGLONG second = *static_cast<const ULONGLONG*>(b);
+	return first < second ? -1 : (first > second ? 1 : 0);
+}
+
+CDiagramEntity* CDiagramEntityContainer::GetObjectByID(ULONGLONG id) const
+/* ============================================================
+	Function :		CDiagramEntityContainer::GetObjectByID
+	Description :	Gets the object with a numeric id.
+	Access :		Public
+
+	Return :		CDiagramEntity*	-	The object, "NULL" if
+										there is none.
+	Parameters :	ULONGLONG id	-	Id to find, see
+										"CDiagramEntity::GetID".
+
+	Usage :			Call to find the object a link is attached
+					to. Searches all objects, not only those
+					returned by "GetAt". The objects are kept
+					sorted by id in an index, rebuilt after
+					objects have been added, removed or
+					renamed.
+
+   ============================================================*/
+{
+
+	if (id == LINK_ID_NONE)
+		return NULL;
+
+	if (m_idsBuilt != m_idChanges)
+		BuildObjectIDs();
+
+	return FindObjectID(id);
+
+}
+
+void CDiagramEntityContainer::InvalidateObjectIDs()
+/* ============================================================
+	Function :		CDiagramEntityContainer::InvalidateObjectIDs
+	Description :	Marks the id index as outdated.
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Called when objects are added or removed,
+					and by "CDiagramEntity::SetName" when the
+					id of an object changes. Call from derived
+					classes after removing objects through
+					"GetData".
+
+   ============================================================*/
+{
+
+	m_idChanges++;
+
+}
+
+CDiagramEntity* CDiagramEntityContainer::FindObjectID(ULONGLONG id) const
+/* ============================================================
+	Function :		CDiagramEntityContainer::FindObjectID
+	Description :	Looks up an id in the id index.
+	Access :		Private
+
+	Return :		CDiagramEntity*	-	The object, "NULL" if
+										the id is not in the
+										index.
+	Parameters :	ULONGLONG id	-	Id to find.
+
+	Usage :			Internal function, a binary search of
+					"m_ids".
+
+   ============================================================*/
+{
+
+	INT_PTR low = 0;
+	INT_PTR high = m_ids.GetSize() - 1;
+	while (low <= high)
+	{
+		INT_PTR mid = (low + high) / 2;
+		const CObjectID& entry = m_ids[mid];
+		if (entry.id < id)
+			low = mid + 1;
+		else if (entry.id > id)
+			high = mid - 1;
+		else
+			return entry.obj;
+	}
+
+	return NULL;
+
+}
+
+void CDiagramEntityContainer::BuildObjectIDs() const
+/* ============================================================
+	Function :		CDiagramEntityContainer::BuildObjectIDs
+	Description :	Rebuilds the id index.
+	Access :		Private
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Internal function. Objects without a
+					numeric id are left out.
+
+   ============================================================*/
+{
+
+	m_ids.RemoveAll();
+	INT_PTR max = m_objs.GetSize();
+	m_ids.SetSize(0, max);
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		CObjectID entry;
+		entry.obj = static_cast<CDiagramEntity*>(m_objs.GetAt(t));
+		entry.id = entry.obj->GetID();
+		if (entry.id != LINK_ID_NONE)
+			m_ids.Add(entry);
+	}
+
+	if (m_ids.GetSize())
+		qsort(m_ids.GetData(), m_ids.GetSize(), sizeof(CObjectID), CompareObjectIDs);
+
+	m_idsBuilt = m_idChanges;
 
 }
 
@@ -1,14 +1,34 @@
 #ifndef _DIAGRAMENTITYCONTAINER_H_
 #define _DIAGRAMENTITYCONTAINER_H_
 class CDiagramEntity;
+class CDiagramRenderer;
 #include "DiagramClipboardHandler.h"
 #include "UndoItem.h"
+#include "StringTable.h"
+#include "BoundsArray.h"
+#include "UndoSpill.h"
+#include "DiagramMemoryUsage.h"
 
 // Restraint modes
 #define RESTRAINT_NONE		0
 #define RESTRAINT_VIRTUAL	1
 #define RESTRAINT_MARGIN	2
 
+// Coalescing transactions
+#define TRANSACTION_NONE	0
+#define TRANSACTION_NUDGE	1
+#define TRANSACTION_RESIZE	2
+
+// Drawing outside the object rectangles, such as arrow heads,
+// included when culling for "RenderRect"
+#define RENDER_MARGIN		16
+
+// Predicate for batch removal
+typedef BOOL (*ENTITYPREDICATE)(CDiagramEntity* obj, LPVOID data);
+
+// Creates an object from its "GetString" representation
+typedef CDiagramEntity* (*ENTITYFACTORY)(const CString& str);
+
 class CDiagramEntityContainer {
 
 public:
@@ -33,6 +53,19 @@ public:
 	virtual void	RemoveAllSelected();
 	virtual void	Remove(CDiagramEntity* obj);
 
+	// Batch data access
+	virtual void	AddRange(CObArray* arr);
+	virtual INT_PTR	RemoveIf(ENTITYPREDICATE predicate, LPVOID data = NULL);
+	virtual void	ReplaceAll(CObArray* arr);
+
+	// Batch z-order
+	virtual BOOL	FrontIf(ENTITYPREDICATE predicate, LPVOID data = NULL);
+	virtual BOOL	BottomIf(ENTITYPREDICATE predicate, LPVOID data = NULL);
+	virtual BOOL	UpIf(ENTITYPREDICATE predicate, LPVOID data = NULL);
+	virtual BOOL	DownIf(ENTITYPREDICATE predicate, LPVOID data = NULL);
+
+	static BOOL		IsSelectedPredicate(CDiagramEntity* obj, LPVOID data);
+
 	void			SetVirtualSize(CSize size);
 	CSize			GetVirtualSize() const;
 
@@ -66,6 +99,9 @@ public:
 
 	void			SetModified(BOOL dirty);
 	BOOL			IsModified() const;
+	UINT			GetChangeCount() const;
+
+	CStringTable*	GetStringTable();
 
 	virtual void	SelectAll();
 	virtual void	UnselectAll();
@@ -79,12 +115,37 @@ public:
 	virtual void	ClearUndo();
 	void			SetUndoStackSize(int maxstacksize);
 	int				GetUndoStackSize() const;
+	void			SetEntityFactory(ENTITYFACTORY factory);
+	void			SetUndoMemoryLevels(int levels);
+	int				GetUndoMemoryLevels() const;
 
 	// Redo handling
 	virtual void	Redo();
 	BOOL			IsRedoPossible() const;
 	virtual void	ClearRedo();
 
+	// Undo statistics
+	INT_PTR			GetUndoLevels() const;
+	INT_PTR			GetRedoLevels() const;
+	INT_PTR			GetUndoObjectCount() const;
+	ULONGLONG		GetUndoSpillSize() const;
+
+	// Memory accounting
+	virtual void	GetMemoryUsage(CDiagramMemoryUsage& usage) const;
+
+	// Rendering
+	virtual void	RenderObjects(CDiagramRenderer* renderer, double zoom);
+	virtual void	PrepareRender(double zoom);
+	virtual void	RenderRect(CDiagramRenderer* renderer, const CRect& rect, double zoom);
+
+	// Transactions
+	void			BeginTransaction(UINT coalesce = TRANSACTION_NONE);
+	void			CommitTransaction();
+	BOOL			AbortTransaction();
+	BOOL			IsInTransaction() const;
+	void			SetCoalesceTime(DWORD time);
+	DWORD			GetCoalesceTime() const;
+
 	// Group handling
 	virtual void	Group();
 	virtual void	Ungroup();
@@ -111,19 +172,41 @@ public:
 	CSize					GetTotalSize();
 	CPoint					GetStartPoint();
 
+	// Bounds
+	const CBoundsArray*		GetBounds();
+	void					InvalidateBounds();
+	void					UpdateBounds(CDiagramEntity* obj);
+
+	// Ids
+	CDiagramEntity*			GetObjectByID(ULONGLONG id) const;
+	void					InvalidateObjectIDs();
+
 protected:
 	CObArray*				GetPaste();
 	CObArray*				GetUndo();
 	CObArray*				GetRedo();
 	int						Find(CDiagramEntity* obj);
+	INT_PTR					RemoveMarked(const CMapPtrToPtr& marked);
+	BOOL					Partition(ENTITYPREDICATE predicate, LPVOID data, BOOL front);
+	BOOL					BeginSnapshot();
+	void					InvalidateCoalescing();
+	void					SpillStack(CObArray* stack);
+	static void				SaveSpilled(const CObArray& objects, CString& data);
+	BOOL					LoadUndoItem(CUndoItem* item);
+	void					DeleteUndoItem(CUndoItem* item);
 
 private:
+	CDiagramEntity*			FindObjectID(ULONGLONG id) const;
+	void					BuildObjectIDs() const;
 
 	// Data
 	CObArray		m_objs;
 	CObArray		m_redo;
 	CObArray		m_undo;
 	int				m_maxstacksize;
+	ENTITYFACTORY	m_factory;			// Recreates spilled undo levels, NULL if they are kept in memory
+	int				m_undoMemoryLevels;	// Undo levels kept in memory on each stack
+	CUndoSpill		m_spill;			// Older undo levels
 	CSize			m_virtualSize;
 	COLORREF		m_color; // Current bg color
 
@@ -145,12 +228,47 @@ private:
 	CDiagramClipboardHandler*	m_clip;
 	CDiagramClipboardHandler	m_internalClip;
 
+	CStringTable	m_strings;			// Interned strings repeated across objects
+
+	CBoundsArray	m_bounds;			// Object rectangles, in "GetAt" order
+	CObArray		m_boundsObjs;		// The data "m_bounds" was built from
+	BOOL			m_boundsValid;		// FALSE if "m_bounds" must be rebuilt
+
+	// An object in the id index, the id first for sorting
+	struct CObjectID
+	{
+		ULONGLONG			id;
+		CDiagramEntity*		obj;
+	};
+
+	mutable CArray< CObjectID, CObjectID& >	m_ids;	// Objects with a numeric id, sorted by id
+	mutable UINT	m_idsBuilt;			// "m_idChanges" when "m_ids" was built
+	UINT			m_idChanges;		// Times objects were added, removed or renamed
+
+	// Transactions
+	int				m_transaction;		// Nesting depth, 0 if none
+	UINT			m_transactionKey;	// Coalescing key of the outermost transaction
+	BOOL			m_transactionSnapshot;	// TRUE if the undo step of the transaction is recorded
+	BOOL			m_transactionCoalesced;	// TRUE if the transaction continues the last undo step
+	BOOL			m_transactionAborted;	// TRUE if a level was aborted
+	CObArray		m_transactionObjs;	// The data when a coalesced transaction started
+	CBoundsArray	m_transactionRects;	// Their rectangles, to abort it with
+	UINT			m_coalesce;			// Key of the last committed transaction, 0 if it can't be continued
+	DWORD			m_coalesceTick;		// When it was committed
+	INT_PTR			m_coalesceUndo;		// Size of the undo stack after it
+	UINT			m_coalesceGeneration;	// "m_undoGeneration" when it was committed
+	UINT			m_undoGeneration;	// Times the undo stack was undone, redone or cleared
+	DWORD			m_coalesceTime;		// Milliseconds a run of transactions is coalesced over
+
 	// State
 	BOOL			m_dirty;
+	UINT			m_changes;	// Times the data was marked as modified
 
 	// Helpers
 	void			Swap(INT_PTR index1, INT_PTR index2);
 	void			SetAt(INT_PTR index, CDiagramEntity* obj);
+	void			SaveTransactionRects();
+	BOOL			RestoreTransactionRects();
 
 };
 
@@ -0,0 +1,533 @@
+/* ==========================================================================
+	File :			DiagramGDIRenderer.cpp
+
+	Class :			CDiagramGDIRenderer
+
+	Date :			10/19/26
+
+	Purpose :		"CDiagramGDIRenderer" implements "CDiagramRenderer"
+					on a "CDC".
+
+	Description :	The renderer owns the pen, brush and font it
+					creates. The stock black pen and white brush are
+					used instead of creating objects when they match,
+					as entities used them directly before.
+
+					Text and background colors and the background mode
+					are restored, and the stock objects selected, when
+					the renderer is destroyed, so the "CDC" is left as
+					entity "Draw" functions left it.
+
+					"SetClipRect" saves the "CDC" state the first time,
+					and "ResetClip" restores it.
+
+	Usage :			Create on the stack around a "CDC", and pass to
+					"CDiagramEntity::Render". The base class "Draw"
+					does this, so entities that implement "Render" are
+					drawn by the editor without other changes.
+
+   ========================================================================*/
+
+#include "stdafx.h"
+#include "DiagramGDIRenderer.h"
+
+#ifdef _DEBUG
+#define new DEBUG_NEW
+#undef THIS_FILE
+static char THIS_FILE[] = __FILE__;
+#endif
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramGDIRenderer construction/destruction
+
+CDiagramGDIRenderer::CDiagramGDIRenderer(CDC* dc)
+/* ============================================================
+	Function :		CDiagramGDIRenderer::CDiagramGDIRenderer
+	Description :	Constructor
+	Access :		Public
+
+	Return :		void
+	Parameters :	CDC* dc	-	"CDC" to draw to.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	m_dc = dc;
+	m_saved = 0;
+	m_bkMode = dc->GetBkMode();
+	m_textColor = dc->GetTextColor();
+	m_bkColor = dc->GetBkColor();
+
+}
+
+CDiagramGDIRenderer::~CDiagramGDIRenderer()
+/* ============================================================
+	Function :		CDiagramGDIRenderer::~CDiagramGDIRenderer
+	Description :	Destructor
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Restores the "CDC" and deletes the objects
+					created.
+
+   ============================================================*/
+{
+
+	ResetClip();
+
+	m_dc->SelectStockObject(BLACK_PEN);
+	m_dc->SelectStockObject(WHITE_BRUSH);
+	m_dc->SelectStockObject(DEFAULT_GUI_FONT);
+	m_dc->SetBkMode(m_bkMode);
+	m_dc->SetTextColor(m_textColor);
+	m_dc->SetBkColor(m_bkColor);
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramGDIRenderer pens, brushes and fonts
+
+void CDiagramGDIRenderer::SetPen(int style, int width, COLORREF color)
+/* ============================================================
+	Function :		CDiagramGDIRenderer::SetPen
+	Description :	Sets the pen for lines and outlines.
+	Access :		Public
+
+	Return :		void
+	Parameters :	int style		-	"PS_SOLID", "PS_DASH",
+										"PS_DOT" or "PS_NULL"
+					int width		-	Width in pixels, 0 for
+										the thinnest line.
+					COLORREF color	-	Color of the pen.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	if (style == PS_NULL)
+	{
+		m_dc->SelectStockObject(NULL_PEN);
+		return;
+	}
+
+	m_dc->SelectStockObject(BLACK_PEN);
+	if (m_pen.m_hObject)
+		m_pen.DeleteObject();
+
+	if (style == PS_SOLID && width <= 1 && color == RGB(0, 0, 0))
+		return;
+
+	m_pen.CreatePen(style, width, color);
+	m_dc->SelectObject(&m_pen);
+
+}
+
+void CDiagramGDIRenderer::SetBrush(COLORREF color)
+/* ============================================================
+	Function :		CDiagramGDIRenderer::SetBrush
+	Description :	Sets the brush for filled shapes.
+	Access :		Public
+
+	Return :		void
+	Parameters :	COLORREF color	-	Color of the brush.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	m_dc->SelectStockObject(WHITE_BRUSH);
+	if (m_brush.m_hObject)
+		m_brush.DeleteObject();
+
+	if (color == RGB(255, 255, 255))
+		return;
+
+	if (color == RGB(0, 0, 0))
+	{
+		m_dc->SelectStockObject(BLACK_BRUSH);
+		return;
+	}
+
+	m_brush.CreateSolidBrush(color);
+	m_dc->SelectObject(&m_brush);
+
+}
+
+void CDiagramGDIRenderer::SetNullBrush()
+/* ============================================================
+	Function :		CDiagramGDIRenderer::SetNullBrush
+	Description :	Draws shapes without filling them.
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	m_dc->SelectStockObject(NULL_BRUSH);
+
+}
+
+void CDiagramGDIRenderer::SetFont(LPCTSTR face, int height, int weight, BOOL italic, BOOL underline)
+/* ============================================================
+	Function :		CDiagramGDIRenderer::SetFont
+	Description :	Sets the font for text.
+	Access :		Public
+
+	Return :		void
+	Parameters :	LPCTSTR face	-	Font face name.
+					int height		-	Height, as for
+										"CreateFont".
+					int weight		-	Weight, "FW_NORMAL" or
+										"FW_BOLD".
+					BOOL italic		-	"TRUE" for italic.
+					BOOL underline	-	"TRUE" for underlined.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	m_dc->SelectStockObject(DEFAULT_GUI_FONT);
+	if (m_font.m_hObject)
+		m_font.DeleteObject();
+
+	m_font.CreateFont(height, 0, 0, 0, weight, static_cast<BYTE>(italic), static_cast<BYTE>(underline), 0, 0, 0, 0, 0, 0, face);
+	m_dc->SelectObject(&m_font);
+
+}
+
+void CDiagramGDIRenderer::SetTextColor(COLORREF color)
+/* ============================================================
+	Function :		CDiagramGDIRenderer::SetTextColor
+	Description :	Sets the text color.
+	Access :		Public
+
+	Return :		void
+	Parameters :	COLORREF color	-	Color of text.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	m_dc->SetTextColor(color);
+
+}
+
+void CDiagramGDIRenderer::SetBkColor(COLORREF color)
+/* ============================================================
+	Function :		CDiagramGDIRenderer::SetBkColor
+	Description :	Sets the text background color.
+	Access :		Public
+
+	Return :		void
+	Parameters :	COLORREF color	-	Color behind text.
+
+	Usage :			Used when the background mode is
+					"OPAQUE".
+
+   ============================================================*/
+{
+
+	m_dc->SetBkColor(color);
+
+}
+
+void CDiagramGDIRenderer::SetBkMode(int mode)
+/* ============================================================
+	Function :		CDiagramGDIRenderer::SetBkMode
+	Description :	Sets the text background mode.
+	Access :		Public
+
+	Return :		void
+	Parameters :	int mode	-	"OPAQUE" or "TRANSPARENT".
+
+	Usage :
+
+   ============================================================*/
+{
+
+	m_dc->SetBkMode(mode);
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramGDIRenderer shapes
+
+void CDiagramGDIRenderer::Line(CPoint from, CPoint to)
+/* ============================================================
+	Function :		CDiagramGDIRenderer::Line
+	Description :	Draws a line with the current pen.
+	Access :		Public
+
+	Return :		void
+	Parameters :	CPoint from	-	Start of the line.
+					CPoint to	-	End of the line, not drawn.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	m_dc->MoveTo(from);
+	m_dc->LineTo(to);
+
+}
+
+void CDiagramGDIRenderer::Polyline(const CPoint* points, int count)
+/* ============================================================
+	Function :		CDiagramGDIRenderer::Polyline
+	Description :	Draws connected lines with the current pen.
+	Access :		Public
+
+	Return :		void
+	Parameters :	const CPoint* points	-	Points to connect.
+					int count				-	Number of points.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	m_dc->Polyline(points, count);
+
+}
+
+void CDiagramGDIRenderer::Polygon(const CPoint* points, int count)
+/* ============================================================
+	Function :		CDiagramGDIRenderer::Polygon
+	Description :	Draws a filled and outlined polygon.
+	Access :		Public
+
+	Return :		void
+	Parameters :	const CPoint* points	-	Corners.
+					int count				-	Number of corners.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	m_dc->Polygon(points, count);
+
+}
+
+void CDiagramGDIRenderer::Rectangle(const CRect& rect)
+/* ============================================================
+	Function :		CDiagramGDIRenderer::Rectangle
+	Description :	Draws a filled and outlined rectangle.
+	Access :		Public
+
+	Return :		void
+	Parameters :	const CRect& rect	-	Rectangle to draw.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	m_dc->Rectangle(rect);
+
+}
+
+void CDiagramGDIRenderer::RoundRect(const CRect& rect, CPoint corner)
+/* ============================================================
+	Function :		CDiagramGDIRenderer::RoundRect
+	Description :	Draws a filled and outlined rectangle with
+					rounded corners.
+	Access :		Public
+
+	Return :		void
+	Parameters :	const CRect& rect	-	Rectangle to draw.
+					CPoint corner		-	Width and height of
+											the corner ellipses.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	m_dc->RoundRect(rect, corner);
+
+}
+
+void CDiagramGDIRenderer::Ellipse(const CRect& rect)
+/* ============================================================
+	Function :		CDiagramGDIRenderer::Ellipse
+	Description :	Draws a filled and outlined ellipse.
+	Access :		Public
+
+	Return :		void
+	Parameters :	const CRect& rect	-	Bounding rectangle.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	m_dc->Ellipse(rect);
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramGDIRenderer text and images
+
+void CDiagramGDIRenderer::DrawText(const CString& text, const CRect& rect, UINT format)
+/* ============================================================
+	Function :		CDiagramGDIRenderer::DrawText
+	Description :	Draws text in a rectangle.
+	Access :		Public
+
+	Return :		void
+	Parameters :	const CString& text	-	Text to draw.
+					const CRect& rect	-	Rectangle to draw in.
+					UINT format			-	"DT_"-flags, as for
+											"CDC::DrawText".
+
+	Usage :
+
+   ============================================================*/
+{
+
+	CRect r(rect);
+	m_dc->DrawText(text, r, format);
+
+}
+
+CSize CDiagramGDIRenderer::GetTextExtent(const CString& text)
+/* ============================================================
+	Function :		CDiagramGDIRenderer::GetTextExtent
+	Description :	Measures a line of text in the current
+					font.
+	Access :		Public
+
+	Return :		CSize				-	Size of the text.
+	Parameters :	const CString& text	-	Text to measure.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	return m_dc->GetTextExtent(text);
+
+}
+
+void CDiagramGDIRenderer::DrawBitmap(UINT resid, const CRect& rect, CSize source, COLORREF transparent)
+/* ============================================================
+	Function :		CDiagramGDIRenderer::DrawBitmap
+	Description :	Draws a bitmap resource, stretched to
+					"rect".
+	Access :		Public
+
+	Return :		void
+	Parameters :	UINT resid				-	Bitmap resource.
+					const CRect& rect		-	Where to draw.
+					CSize source			-	Part of the bitmap
+												to draw, from the
+												top left.
+					COLORREF transparent	-	Color not drawn.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	HBITMAP hbitmap = (HBITMAP)::LoadImage(AfxGetResourceHandle(),
+		MAKEINTRESOURCE(resid),
+		IMAGE_BITMAP,
+		0, 0,
+		LR_CREATEDIBSECTION
+	);
+
+	if (hbitmap)
+	{
+		CDC memDC;
+		memDC.CreateCompatibleDC(m_dc);
+		CBitmap* bitmap = CBitmap::FromHandle(hbitmap);
+		CBitmap* oldbitmap = memDC.SelectObject(bitmap);
+		m_dc->TransparentBlt(rect.left, rect.top, rect.Width(), rect.Height(), &memDC, 0, 0, source.cx, source.cy, transparent);
+		memDC.SelectObject(oldbitmap);
+		bitmap->DeleteObject();
+	}
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramGDIRenderer clipping
+
+void CDiagramGDIRenderer::SetClipRect(const CRect& rect)
+/* ============================================================
+	Function :		CDiagramGDIRenderer::SetClipRect
+	Description :	Limits drawing to a rectangle.
+	Access :		Public
+
+	Return :		void
+	Parameters :	const CRect& rect	-	Rectangle to draw in.
+
+	Usage :			The rectangle is combined with the clipping
+					of the "CDC" when the renderer was created.
+
+   ============================================================*/
+{
+
+	if (m_saved == 0)
+		m_saved = m_dc->SaveDC();
+
+	m_dc->IntersectClipRect(rect);
+
+}
+
+void CDiagramGDIRenderer::ResetClip()
+/* ============================================================
+	Function :		CDiagramGDIRenderer::ResetClip
+	Description :	Removes the clipping set by "SetClipRect".
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	if (m_saved)
+	{
+		m_dc->RestoreDC(m_saved);
+		m_saved = 0;
+	}
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramGDIRenderer attributes
+
+CDC* CDiagramGDIRenderer::GetDC() const
+/* ============================================================
+	Function :		CDiagramGDIRenderer::GetDC
+	Description :	Gets the "CDC" drawn to.
+	Access :		Public
+
+	Return :		CDC*	-	The "CDC".
+	Parameters :	none
+
+	Usage :			"CDiagramEntity::RenderObject" uses it to
+					draw entities that only have a GDI "Draw".
+
+   ============================================================*/
+{
+
+	return m_dc;
+
+}
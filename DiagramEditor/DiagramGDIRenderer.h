@@ -0,0 +1,60 @@
+#ifndef _CDIAGRAMGDIRENDERER_H_8B2E6D41_C07A_4F35_9D1E56B3A2C84
+#define _CDIAGRAMGDIRENDERER_H_8B2E6D41_C07A_4F35_9D1E56B3A2C84
+
+///////////////////////////////////////////////////////////
+// File :		DiagramGDIRenderer.h
+// Created :	10/19/26
+//
+
+#include "DiagramRenderer.h"
+
+// Draws to a "CDC"
+class CDiagramGDIRenderer : public CDiagramRenderer
+{
+public:
+	// Construction/destruction
+	CDiagramGDIRenderer(CDC* dc);
+	virtual ~CDiagramGDIRenderer();
+
+	// Overrides
+	virtual void	SetPen(int style, int width, COLORREF color);
+	virtual void	SetBrush(COLORREF color);
+	virtual void	SetNullBrush();
+	virtual void	SetFont(LPCTSTR face, int height, int weight = FW_NORMAL, BOOL italic = FALSE, BOOL underline = FALSE);
+	virtual void	SetTextColor(COLORREF color);
+	virtual void	SetBkColor(COLORREF color);
+	virtual void	SetBkMode(int mode);
+
+	virtual void	Line(CPoint from, CPoint to);
+	virtual void	Polyline(const CPoint* points, int count);
+	virtual void	Polygon(const CPoint* points, int count);
+	virtual void	Rectangle(const CRect& rect);
+	virtual void	RoundRect(const CRect& rect, CPoint corner);
+	virtual void	Ellipse(const CRect& rect);
+
+	virtual void	DrawText(const CString& text, const CRect& rect, UINT format);
+	virtual CSize	GetTextExtent(const CString& text);
+	virtual void	DrawBitmap(UINT resid, const CRect& rect, CSize source, COLORREF transparent);
+
+	virtual void	SetClipRect(const CRect& rect);
+	virtual void	ResetClip();
+
+	// Attributes
+	virtual CDC*	GetDC() const;
+
+private:
+	// Data
+	CDC*		m_dc;
+	CPen		m_pen;
+	CBrush		m_brush;
+	CFont		m_font;
+	int			m_saved;		// "SaveDC" before clipping, 0 if not clipped
+
+	// Restored when done
+	int			m_bkMode;
+	COLORREF	m_textColor;
+	COLORREF	m_bkColor;
+
+};
+
+#endif //_CDIAGRAMGDIRENDERER_H_8B2E6D41_C07A_4F35_9D1E56B3A2C84
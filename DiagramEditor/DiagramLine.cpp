@@ -23,6 +23,7 @@
 
 #include "stdafx.h"
 #include "DiagramLine.h"
+#include "DiagramRenderer.h"
 #include "Tokenizer.h"
 
 #ifdef _DEBUG
@@ -211,26 +212,28 @@ int CDiagramLine::GetHitCode(CPoint point) const
 
 }
 
-void CDiagramLine::Draw(CDC* dc, CRect rect)
+void CDiagramLine::Render(CDiagramRenderer* renderer, CRect rect)
 /* ============================================================
-	Function :		CDiagramLine::Draw
+	Function :		CDiagramLine::Render
 	Description :	Draws the object.
 	Access :		Public
 
 	Return :		void
-	Parameters :	CDC* dc		-	"CDC" to draw to
-					CRect rect	-	True (zoomed) rectangle to
-									draw to.
+	Parameters :	CDiagramRenderer* renderer	-	Renderer to
+													draw with.
+					CRect rect					-	True (zoomed)
+													rectangle to
+													draw to.
 
-	Usage :			Called from "CDiagramEditor::DrawObjects".
+	Usage :			Called from "Draw", and when rendering
+					without a "CDC".
 
    ============================================================*/
 {
 
-	dc->SelectStockObject(BLACK_PEN);
+	renderer->SetPen(PS_SOLID, 0, RGB(0, 0, 0));
 
-	dc->MoveTo(rect.TopLeft());
-	dc->LineTo(rect.BottomRight());
+	renderer->Line(rect.TopLeft(), rect.BottomRight());
 
 }
 
@@ -7,13 +7,15 @@
 
 class CDiagramLine : public CDiagramEntity
 {
+	DECLARE_ENTITY_SIZE(CDiagramLine)
+
 public:
 	CDiagramLine();
 	virtual ~CDiagramLine();
 
 	virtual CDiagramEntity* Clone();
 	static	CDiagramEntity* CreateFromString(const CString& str);
-	virtual void			Draw(CDC* dc, CRect rect);
+	virtual void			Render(CDiagramRenderer* renderer, CRect rect);
 	virtual int				GetHitCode(CPoint point) const;
 	virtual int				GetHitCode(const CPoint& point, const CRect& rect) const;
 	virtual HCURSOR			GetCursor(int hit) const;
@@ -0,0 +1,569 @@
+/* ==========================================================================
+	File :			DiagramMemoryUsage.cpp
+
+	Class :			CDiagramMemoryUsage
+
+	Date :			10/19/26
+
+	Purpose :		"CDiagramMemoryUsage" collects a breakdown of the
+					memory held by a diagram - entities by type, UML
+					members, strings, undo levels, the clipboard, links
+					and property dialogs - as object counts and bytes.
+
+	Description :	Containers and entities report to the breakdown
+					with "Add", giving a category, an item and the
+					number of objects and bytes to add to it. Lines with
+					the same category and item are summed.
+
+					The bytes are estimates: "sizeof" of the objects,
+					the slots of the arrays holding them, and the
+					buffers of their strings. Heap overhead and unused
+					array capacity are not counted.
+
+					"CString" buffers are shared between copies, and
+					interned strings are shared between all objects of
+					a document. "AddString" counts each buffer only
+					the first time it is seen, so undo levels and
+					clipboard objects cloned from the diagram add
+					nothing for the strings they share with it.
+
+					"SetScope" prefixes the categories of the lines
+					added after it, so that the objects of the undo
+					stack can be told from those of the diagram while
+					reported by the same code.
+
+					"AddDisk" adds a line for bytes that are not in
+					memory, such as the undo spill file. They are not
+					part of "GetTotalBytes".
+
+	Usage :			Call "GetMemoryUsage" of a container, then
+					"GetReport" for CSV lines or "GetSummary" for text
+					to show.
+
+   ========================================================================*/
+
+#include "stdafx.h"
+#include "DiagramMemoryUsage.h"
+
+#ifdef _DEBUG
+#define new DEBUG_NEW
+#undef THIS_FILE
+static char THIS_FILE[] = __FILE__;
+#endif
+
+static CString FormatBytes(ULONGLONG bytes)
+{
+	CString result;
+	if (bytes < 1024)
+		result.Format(_T("%I64u bytes"), bytes);
+	else if (bytes < 1024 * 1024)
+		result.Format(_T("%.1f KB"), static_cast<double>(bytes) / 1024.0);
+	else
+		result.Format(_T("%.1f MB"), static_cast<double>(bytes) / (1024.0 * 1024.0));
+
+	return result;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramMemoryUsage construction/destruction
+
+CDiagramMemoryUsage::CDiagramMemoryUsage()
+/* ============================================================
+	Function :		CDiagramMemoryUsage::CDiagramMemoryUsage
+	Description :	Constructor
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+}
+
+CDiagramMemoryUsage::~CDiagramMemoryUsage()
+/* ============================================================
+	Function :		CDiagramMemoryUsage::~CDiagramMemoryUsage
+	Description :	Destructor
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramMemoryUsage operations
+
+void CDiagramMemoryUsage::Add(LPCTSTR category, LPCTSTR item, INT_PTR count, ULONGLONG bytes)
+/* ============================================================
+	Function :		CDiagramMemoryUsage::Add
+	Description :	Adds objects held in memory to the
+					breakdown.
+	Access :		Public
+
+	Return :		void
+	Parameters :	LPCTSTR category	-	Category, such as
+											"Entities".
+					LPCTSTR item		-	Item in the category,
+											such as the type of
+											the objects.
+					INT_PTR count		-	Number of objects.
+					ULONGLONG bytes		-	Bytes they hold.
+
+	Usage :			The current scope is prefixed to
+					"category".
+
+   ============================================================*/
+{
+
+	AddEntry(category, item, count, bytes, FALSE);
+
+}
+
+void CDiagramMemoryUsage::AddDisk(LPCTSTR category, LPCTSTR item, INT_PTR count, ULONGLONG bytes)
+/* ============================================================
+	Function :		CDiagramMemoryUsage::AddDisk
+	Description :	Adds objects held on disk to the breakdown.
+	Access :		Public
+
+	Return :		void
+	Parameters :	LPCTSTR category	-	Category
+					LPCTSTR item		-	Item in the category
+					INT_PTR count		-	Number of objects.
+					ULONGLONG bytes		-	Bytes on disk.
+
+	Usage :			Used for the undo spill file. The bytes are
+					not part of "GetTotalBytes".
+
+   ============================================================*/
+{
+
+	AddEntry(category, item, count, bytes, TRUE);
+
+}
+
+void CDiagramMemoryUsage::AddString(const CString& str)
+/* ============================================================
+	Function :		CDiagramMemoryUsage::AddString
+	Description :	Adds the buffer of a string to the
+					breakdown, unless it is already counted.
+	Access :		Public
+
+	Return :		void
+	Parameters :	const CString& str	-	String to add.
+
+	Usage :			Call for the string members of an object.
+					Empty strings share a static buffer and are
+					not counted.
+
+   ============================================================*/
+{
+
+	if (str.IsEmpty())
+		return;
+
+	void* buffer = const_cast<LPTSTR>(str.GetString());
+	void* seen;
+	if (m_strings.Lookup(buffer, seen))
+		return;
+
+	m_strings.SetAt(buffer, buffer);
+	Add(_T("Strings"), _T("Buffers"), 1, sizeof(ATL::CStringData) + (str.GetAllocLength() + 1) * sizeof(TCHAR));
+
+}
+
+void CDiagramMemoryUsage::AddStrings(const CStringArray& stra)
+/* ============================================================
+	Function :		CDiagramMemoryUsage::AddStrings
+	Description :	Adds the strings of an array, and the array
+					itself, to the breakdown.
+	Access :		Public
+
+	Return :		void
+	Parameters :	const CStringArray& stra	-	Array to add.
+
+	Usage :			Call for the string array members of an
+					object.
+
+   ============================================================*/
+{
+
+	INT_PTR max = stra.GetSize();
+	if (max)
+		Add(_T("Strings"), _T("Arrays"), 1, max * sizeof(CString));
+
+	for (INT_PTR t = 0; t < max; t++)
+		AddString(stra[t]);
+
+}
+
+void CDiagramMemoryUsage::RemoveAll()
+/* ============================================================
+	Function :		CDiagramMemoryUsage::RemoveAll
+	Description :	Empties the breakdown.
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Call to collect a new breakdown with the
+					same object. Strings are counted anew.
+
+   ============================================================*/
+{
+
+	m_entries.RemoveAll();
+	m_index.RemoveAll();
+	m_strings.RemoveAll();
+	m_scope.Empty();
+
+}
+
+void CDiagramMemoryUsage::SetScope(LPCTSTR scope)
+/* ============================================================
+	Function :		CDiagramMemoryUsage::SetScope
+	Description :	Sets the prefix of the categories added
+					from now on.
+	Access :		Public
+
+	Return :		void
+	Parameters :	LPCTSTR scope	-	Prefix, such as "Undo",
+										or an empty string for
+										none.
+
+	Usage :			Call before reporting the objects of an undo
+					level or the clipboard, and reset afterwards.
+
+   ============================================================*/
+{
+
+	m_scope = scope;
+
+}
+
+CString CDiagramMemoryUsage::GetScope() const
+/* ============================================================
+	Function :		CDiagramMemoryUsage::GetScope
+	Description :	Gets the prefix of the categories added.
+	Access :		Public
+
+	Return :		CString	-	The scope, empty if none.
+	Parameters :	none
+
+	Usage :			Call to restore the scope after changing it.
+
+   ============================================================*/
+{
+
+	return m_scope;
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramMemoryUsage results
+
+INT_PTR CDiagramMemoryUsage::GetSize() const
+/* ============================================================
+	Function :		CDiagramMemoryUsage::GetSize
+	Description :	Gets the number of lines in the breakdown.
+	Access :		Public
+
+	Return :		INT_PTR	-	Number of lines.
+	Parameters :	none
+
+	Usage :			Lines are kept in the order their category
+					and item were first added.
+
+   ============================================================*/
+{
+
+	return m_entries.GetSize();
+
+}
+
+CString CDiagramMemoryUsage::GetCategory(INT_PTR index) const
+/* ============================================================
+	Function :		CDiagramMemoryUsage::GetCategory
+	Description :	Gets the category of a line, with the
+					scope prefix.
+	Access :		Public
+
+	Return :		CString			-	The category.
+	Parameters :	INT_PTR index	-	Line to get.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	return m_entries[index].category;
+
+}
+
+CString CDiagramMemoryUsage::GetItem(INT_PTR index) const
+/* ============================================================
+	Function :		CDiagramMemoryUsage::GetItem
+	Description :	Gets the item of a line.
+	Access :		Public
+
+	Return :		CString			-	The item.
+	Parameters :	INT_PTR index	-	Line to get.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	return m_entries[index].item;
+
+}
+
+INT_PTR CDiagramMemoryUsage::GetCount(INT_PTR index) const
+/* ============================================================
+	Function :		CDiagramMemoryUsage::GetCount
+	Description :	Gets the number of objects of a line.
+	Access :		Public
+
+	Return :		INT_PTR			-	Number of objects.
+	Parameters :	INT_PTR index	-	Line to get.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	return m_entries[index].count;
+
+}
+
+ULONGLONG CDiagramMemoryUsage::GetBytes(INT_PTR index) const
+/* ============================================================
+	Function :		CDiagramMemoryUsage::GetBytes
+	Description :	Gets the bytes of a line.
+	Access :		Public
+
+	Return :		ULONGLONG		-	Estimated bytes.
+	Parameters :	INT_PTR index	-	Line to get.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	return m_entries[index].bytes;
+
+}
+
+BOOL CDiagramMemoryUsage::IsDisk(INT_PTR index) const
+/* ============================================================
+	Function :		CDiagramMemoryUsage::IsDisk
+	Description :	Checks if the bytes of a line are on disk.
+	Access :		Public
+
+	Return :		BOOL			-	"TRUE" if added with
+										"AddDisk".
+	Parameters :	INT_PTR index	-	Line to check.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	return m_entries[index].disk;
+
+}
+
+ULONGLONG CDiagramMemoryUsage::GetTotalBytes() const
+/* ============================================================
+	Function :		CDiagramMemoryUsage::GetTotalBytes
+	Description :	Gets the bytes of all lines held in memory.
+	Access :		Public
+
+	Return :		ULONGLONG	-	Estimated bytes.
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	ULONGLONG result = 0;
+	INT_PTR max = m_entries.GetSize();
+	for (INT_PTR t = 0; t < max; t++)
+		if (!m_entries[t].disk)
+			result += m_entries[t].bytes;
+
+	return result;
+
+}
+
+ULONGLONG CDiagramMemoryUsage::GetCategoryBytes(const CString& category) const
+/* ============================================================
+	Function :		CDiagramMemoryUsage::GetCategoryBytes
+	Description :	Gets the bytes of all lines of a category.
+	Access :		Public
+
+	Return :		ULONGLONG				-	Estimated bytes.
+	Parameters :	const CString& category	-	Category, with
+												the scope prefix.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	ULONGLONG result = 0;
+	INT_PTR max = m_entries.GetSize();
+	for (INT_PTR t = 0; t < max; t++)
+		if (m_entries[t].category == category)
+			result += m_entries[t].bytes;
+
+	return result;
+
+}
+
+void CDiagramMemoryUsage::GetReport(CStringArray& stra) const
+/* ============================================================
+	Function :		CDiagramMemoryUsage::GetReport
+	Description :	Gets the breakdown as CSV lines.
+	Access :		Public
+
+	Return :		void
+	Parameters :	CStringArray& stra	-	Array to add the
+											lines to.
+
+	Usage :			The first line is the header
+					"category,item,count,bytes,storage".
+
+   ============================================================*/
+{
+
+	stra.Add(_T("category,item,count,bytes,storage"));
+
+	INT_PTR max = m_entries.GetSize();
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		const CEntry& entry = m_entries[t];
+		CString line;
+		line.Format(_T("%s,%s,%Id,%I64u,%s"),
+			static_cast<LPCTSTR>(entry.category),
+			static_cast<LPCTSTR>(entry.item),
+			entry.count,
+			entry.bytes,
+			entry.disk ? _T("disk") : _T("memory"));
+		stra.Add(line);
+	}
+
+}
+
+CString CDiagramMemoryUsage::GetSummary() const
+/* ============================================================
+	Function :		CDiagramMemoryUsage::GetSummary
+	Description :	Gets the breakdown as text, by category.
+	Access :		Public
+
+	Return :		CString	-	The breakdown.
+	Parameters :	none
+
+	Usage :			Call to show the breakdown to the user.
+
+   ============================================================*/
+{
+
+	CString result;
+	CStringArray categories;
+	INT_PTR max = m_entries.GetSize();
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		BOOL found = FALSE;
+		for (INT_PTR i = 0; i < categories.GetSize() && !found; i++)
+			found = (categories[i] == m_entries[t].category);
+		if (!found)
+			categories.Add(m_entries[t].category);
+	}
+
+	INT_PTR count = categories.GetSize();
+	for (INT_PTR i = 0; i < count; i++)
+	{
+		CString line;
+		line.Format(_T("%s: %s\n"),
+			static_cast<LPCTSTR>(categories[i]),
+			static_cast<LPCTSTR>(FormatBytes(GetCategoryBytes(categories[i]))));
+		result += line;
+
+		for (INT_PTR t = 0; t < max; t++)
+		{
+			const CEntry& entry = m_entries[t];
+			if (entry.category == categories[i])
+			{
+				line.Format(_T("    %s: %Id, %s%s\n"),
+					static_cast<LPCTSTR>(entry.item),
+					entry.count,
+					static_cast<LPCTSTR>(FormatBytes(entry.bytes)),
+					entry.disk ? _T(" on disk") : _T(""));
+				result += line;
+			}
+		}
+	}
+
+	CString total;
+	total.Format(_T("\nTotal in memory: %s"), static_cast<LPCTSTR>(FormatBytes(GetTotalBytes())));
+	result += total;
+
+	return result;
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramMemoryUsage helpers
+
+void CDiagramMemoryUsage::AddEntry(LPCTSTR category, LPCTSTR item, INT_PTR count, ULONGLONG bytes, BOOL disk)
+/* ============================================================
+	Function :		CDiagramMemoryUsage::AddEntry
+	Description :	Adds to the line of "category" and "item",
+					creating it if needed.
+	Access :		Private
+
+	Return :		void
+	Parameters :	LPCTSTR category	-	Category, without the
+											scope.
+					LPCTSTR item		-	Item in the category.
+					INT_PTR count		-	Number of objects.
+					ULONGLONG bytes		-	Bytes they hold.
+					BOOL disk			-	"TRUE" if on disk.
+
+	Usage :			Called from "Add" and "AddDisk".
+
+   ============================================================*/
+{
+
+	CString name(category);
+	if (!m_scope.IsEmpty())
+		name = m_scope + _T(": ") + name;
+
+	CString key = name + _T("\t") + item;
+	void* index;
+	if (m_index.Lookup(key, index))
+	{
+		CEntry& entry = m_entries[reinterpret_cast<INT_PTR>(index) - 1];
+		entry.count += count;
+		entry.bytes += bytes;
+	}
+	else
+	{
+		CEntry entry;
+		entry.category = name;
+		entry.item = item;
+		entry.count = count;
+		entry.bytes = bytes;
+		entry.disk = disk;
+		m_index.SetAt(key, reinterpret_cast<void*>(m_entries.Add(entry) + 1));
+	}
+
+}
@@ -0,0 +1,62 @@
+#ifndef _CDIAGRAMMEMORYUSAGE_H_6C2E9A41_D83B_4F17_A05E7B19C3D82
+#define _CDIAGRAMMEMORYUSAGE_H_6C2E9A41_D83B_4F17_A05E7B19C3D82
+
+///////////////////////////////////////////////////////////
+// File :		DiagramMemoryUsage.h
+// Created :	10/19/26
+//
+
+class CDiagramMemoryUsage
+{
+public:
+	// Construction/destruction
+	CDiagramMemoryUsage();
+	virtual ~CDiagramMemoryUsage();
+
+	// Operations
+	void		Add(LPCTSTR category, LPCTSTR item, INT_PTR count, ULONGLONG bytes);
+	void		AddDisk(LPCTSTR category, LPCTSTR item, INT_PTR count, ULONGLONG bytes);
+	void		AddString(const CString& str);
+	void		AddStrings(const CStringArray& stra);
+	void		RemoveAll();
+
+	void		SetScope(LPCTSTR scope);
+	CString		GetScope() const;
+
+	// Results
+	INT_PTR		GetSize() const;
+	CString		GetCategory(INT_PTR index) const;
+	CString		GetItem(INT_PTR index) const;
+	INT_PTR		GetCount(INT_PTR index) const;
+	ULONGLONG	GetBytes(INT_PTR index) const;
+	BOOL		IsDisk(INT_PTR index) const;
+
+	ULONGLONG	GetTotalBytes() const;
+	ULONGLONG	GetCategoryBytes(const CString& category) const;
+
+	void		GetReport(CStringArray& stra) const;
+	CString		GetSummary() const;
+
+private:
+	// An accumulated line of the breakdown
+	struct CEntry
+	{
+		CString		category;
+		CString		item;
+		INT_PTR		count;
+		ULONGLONG	bytes;
+		BOOL		disk;		// TRUE if "bytes" are on disk, not in memory
+	};
+
+	// Data
+	CArray< CEntry, CEntry& >	m_entries;
+	CMapStringToPtr				m_index;	// Entry index + 1, by category and item
+	CMapPtrToPtr				m_strings;	// String buffers already counted
+	CString						m_scope;	// Prefix of the categories added
+
+	// Helpers
+	void		AddEntry(LPCTSTR category, LPCTSTR item, INT_PTR count, ULONGLONG bytes, BOOL disk);
+
+};
+
+#endif //_CDIAGRAMMEMORYUSAGE_H_6C2E9A41_D83B_4F17_A05E7B19C3D82
@@ -0,0 +1,918 @@
+/* ==========================================================================
+	File :			DiagramPDFRenderer.cpp
+
+	Class :			CDiagramPDFRenderer
+
+	Date :			10/19/26
+
+	Purpose :		"CDiagramPDFRenderer" writes what entities draw as
+					a PDF file, streamed to disk a page at a time.
+
+	Description :	Each page is a content stream written as it is
+					drawn, with its length in an object of its own
+					after it, so nothing of the page is kept. The
+					offsets of the objects are kept for the cross
+					reference table, which is a few numbers a page.
+
+					Text uses the standard Helvetica and Courier fonts
+					with the Windows code page, so no fonts are
+					embedded, and the widths "CDiagramVectorRenderer"
+					measures with are the widths the viewer uses.
+					Colors, line width and dashes are only written
+					when they change.
+
+					Bitmaps are image objects with the transparent
+					color masked, written once each when the file is
+					closed, as an image cannot be written inside a
+					content stream. All pages share one resource
+					dictionary, also written then.
+
+					The pages are in the drawing coordinates, with y
+					down, moved half a pixel so that one pixel lines
+					cover the same pixels as in the editor.
+
+	Usage :			Call "Open", then "BeginPage" with the part of the
+					drawing each page shows, render the objects
+					touching it, and call "EndPage". "Close" finishes
+					the file.
+
+   ========================================================================*/
+
+#include "stdafx.h"
+#include "DiagramPDFRenderer.h"
+
+#ifdef _DEBUG
+#define new DEBUG_NEW
+#undef THIS_FILE
+static char THIS_FILE[] = __FILE__;
+#endif
+
+// Fixed objects
+#define PDF_CATALOG		1
+#define PDF_PAGES		2
+#define PDF_RESOURCES	3
+#define PDF_FONTS		4		// Eight fonts, "/F1" - "/F8"
+#define PDF_FIRST		12		// First object written while drawing
+
+#define BEZIER_KAPPA	.5523	// Control point distance for a quarter ellipse
+
+static const char* fontNames[] = {
+	"Helvetica", "Helvetica-Bold", "Helvetica-Oblique", "Helvetica-BoldOblique",
+	"Courier", "Courier-Bold", "Courier-Oblique", "Courier-BoldOblique"
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramPDFRenderer construction/destruction
+
+CDiagramPDFRenderer::CDiagramPDFRenderer()
+/* ============================================================
+	Function :		CDiagramPDFRenderer::CDiagramPDFRenderer
+	Description :	Constructor
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	m_objects = PDF_FIRST;
+
+	m_page = FALSE;
+	m_paper = CSize(0, 0);
+	m_contents = 0;
+	m_start = 0;
+	m_clipped = FALSE;
+
+	ForgetState();
+
+}
+
+CDiagramPDFRenderer::~CDiagramPDFRenderer()
+/* ============================================================
+	Function :		CDiagramPDFRenderer::~CDiagramPDFRenderer
+	Description :	Destructor
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Closes the file if it is open.
+
+   ============================================================*/
+{
+
+	if (IsOpen())
+		Close();
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramPDFRenderer operations
+
+BOOL CDiagramPDFRenderer::Open(const CString& filename)
+/* ============================================================
+	Function :		CDiagramPDFRenderer::Open
+	Description :	Creates the file and writes the header.
+	Access :		Public
+
+	Return :		BOOL					-	"TRUE" if the file
+												was created.
+	Parameters :	const CString& filename	-	File to create.
+
+	Usage :			Add pages with "BeginPage" and "EndPage",
+					then call "Close".
+
+   ============================================================*/
+{
+
+	if (!OpenFile(filename))
+		return FALSE;
+
+	m_offsets.RemoveAll();
+	m_pages.RemoveAll();
+	m_objects = PDF_FIRST;
+	m_images.RemoveAll();
+	m_imageObjects.RemoveAll();
+	m_imageIds.RemoveAll();
+	m_imageColors.RemoveAll();
+	m_imageSizes.RemoveAll();
+	m_page = FALSE;
+	m_clipped = FALSE;
+
+	// The second line marks the file as binary
+	Write("%PDF-1.4\n%\xE2\xE3\xCF\xD3\n");
+
+	return TRUE;
+
+}
+
+BOOL CDiagramPDFRenderer::Close()
+/* ============================================================
+	Function :		CDiagramPDFRenderer::Close
+	Description :	Writes the images, fonts, page tree and
+					cross reference table, and closes the file.
+	Access :		Public
+
+	Return :		BOOL	-	"FALSE" if the file could not
+								be written.
+	Parameters :	none
+
+	Usage :			Ends the current page. An empty page is
+					added if there are none.
+
+   ============================================================*/
+{
+
+	if (!IsOpen())
+		return FALSE;
+
+	if (!m_pages.GetSize() && !m_page)
+		BeginPage(CSize(2 * PDF_MARGIN + 1, 2 * PDF_MARGIN + 1), CRect(0, 0, 1, 1), 1.0);
+	if (m_page)
+		EndPage();
+
+	INT_PTR images = m_imageObjects.GetSize();
+	for (INT_PTR t = 0; t < images; t++)
+		WriteImage(static_cast<int>(t));
+
+	int fonts = static_cast<int>(_countof(fontNames));
+	for (int t = 0; t < fonts; t++)
+	{
+		BeginObject(PDF_FONTS + t);
+		WriteFormat("<< /Type /Font /Subtype /Type1 /BaseFont /%s /Encoding /WinAnsiEncoding >>\nendobj\n", fontNames[t]);
+	}
+
+	BeginObject(PDF_RESOURCES);
+	Write("<< /ProcSet [/PDF /Text /ImageC] /Font <<");
+	for (int t = 0; t < fonts; t++)
+		WriteFormat(" /F%d %d 0 R", t + 1, PDF_FONTS + t);
+	Write(" >>");
+	if (images)
+	{
+		Write(" /XObject <<");
+		for (INT_PTR t = 0; t < images; t++)
+			WriteFormat(" /Im%d %d 0 R", static_cast<int>(t), m_imageObjects[t]);
+		Write(" >>");
+	}
+	Write(" >>\nendobj\n");
+
+	BeginObject(PDF_PAGES);
+	Write("<< /Type /Pages /Kids [");
+	INT_PTR pages = m_pages.GetSize();
+	for (INT_PTR t = 0; t < pages; t++)
+		WriteFormat(" %d 0 R", m_pages[t]);
+	WriteFormat(" ] /Count %d >>\nendobj\n", static_cast<int>(pages));
+
+	BeginObject(PDF_CATALOG);
+	WriteFormat("<< /Type /Catalog /Pages %d 0 R >>\nendobj\n", PDF_PAGES);
+
+	// Cross reference table, each entry exactly 20 bytes
+	DWORD xref = GetBytesWritten();
+	WriteFormat("xref\n0 %d\n0000000000 65535 f \n", m_objects);
+	for (int t = 1; t < m_objects; t++)
+		WriteFormat("%010lu 00000 n \n", t < m_offsets.GetSize() ? m_offsets[t] : 0);
+	WriteFormat("trailer\n<< /Size %d /Root %d 0 R >>\nstartxref\n%lu\n%%%%EOF\n", m_objects, PDF_CATALOG, xref);
+
+	return CloseFile();
+
+}
+
+void CDiagramPDFRenderer::BeginPage(CSize paper, const CRect& area, double scale)
+/* ============================================================
+	Function :		CDiagramPDFRenderer::BeginPage
+	Description :	Starts a page.
+	Access :		Public
+
+	Return :		void
+	Parameters :	CSize paper			-	Size of the page in
+											points.
+					const CRect& area	-	Part of the drawing
+											shown on the page.
+					double scale		-	Points per pixel.
+
+	Usage :			"area" is drawn "PDF_MARGIN" points from
+					the top left corner of the page, and
+					nothing outside it shows.
+
+   ============================================================*/
+{
+
+	if (m_page)
+		EndPage();
+
+	m_paper = paper;
+	m_contents = m_objects++;
+	int length = m_objects++;
+
+	BeginObject(m_contents);
+	WriteFormat("<< /Length %d 0 R >>\nstream\n", length);
+	m_start = GetBytesWritten();
+
+	WriteFormat("%.4f 0 0 %.4f %d %d cm\n", scale, -scale, PDF_MARGIN, paper.cy - PDF_MARGIN);
+	WriteFormat("1 0 0 1 %d %d cm\n", -area.left, -area.top);
+	WriteFormat("%d %d %d %d re W n\n", area.left, area.top, area.Width(), area.Height());
+	Write("1 0 0 1 .5 .5 cm\n");
+
+	m_page = TRUE;
+	m_clipped = FALSE;
+	ForgetState();
+
+}
+
+void CDiagramPDFRenderer::EndPage()
+/* ============================================================
+	Function :		CDiagramPDFRenderer::EndPage
+	Description :	Ends the current page.
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Writes the length of the content stream
+					and the page object.
+
+   ============================================================*/
+{
+
+	if (!m_page)
+		return;
+
+	ResetClip();
+	DWORD length = GetBytesWritten() - m_start;
+	Write("endstream\nendobj\n");
+
+	BeginObject(m_contents + 1);
+	WriteFormat("%lu\nendobj\n", length);
+
+	int page = m_objects++;
+	BeginObject(page);
+	WriteFormat("<< /Type /Page /Parent %d 0 R /MediaBox [0 0 %d %d] /Resources %d 0 R /Contents %d 0 R >>\nendobj\n",
+		PDF_PAGES, m_paper.cx, m_paper.cy, PDF_RESOURCES, m_contents);
+	m_pages.Add(page);
+
+	m_page = FALSE;
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramPDFRenderer attributes
+
+int CDiagramPDFRenderer::GetPageCount() const
+/* ============================================================
+	Function :		CDiagramPDFRenderer::GetPageCount
+	Description :	Gets the number of pages finished.
+	Access :		Public
+
+	Return :		int		-	Number of pages.
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	return static_cast<int>(m_pages.GetSize());
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramPDFRenderer overrides
+
+void CDiagramPDFRenderer::Line(CPoint from, CPoint to)
+/* ============================================================
+	Function :		CDiagramPDFRenderer::Line
+	Description :	Draws a line with the pen.
+	Access :		Public
+
+	Return :		void
+	Parameters :	CPoint from	-	Start of the line.
+					CPoint to	-	End of the line.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	LPCSTR op = BeginPaint(FALSE, TRUE);
+	if (op)
+		WriteFormat("%d %d m %d %d l %s\n", from.x, from.y, to.x, to.y, op);
+
+}
+
+void CDiagramPDFRenderer::Polyline(const CPoint* points, int count)
+/* ============================================================
+	Function :		CDiagramPDFRenderer::Polyline
+	Description :	Draws connected lines with the pen.
+	Access :		Public
+
+	Return :		void
+	Parameters :	const CPoint* points	-	Points to connect.
+					int count				-	Number of points.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	LPCSTR op = BeginPaint(FALSE, TRUE);
+	if (!op || count < 2)
+		return;
+
+	WriteFormat("%d %d m", points[0].x, points[0].y);
+	for (int t = 1; t < count; t++)
+		WriteFormat(" %d %d l", points[t].x, points[t].y);
+	WriteFormat(" %s\n", op);
+
+}
+
+void CDiagramPDFRenderer::Polygon(const CPoint* points, int count)
+/* ============================================================
+	Function :		CDiagramPDFRenderer::Polygon
+	Description :	Draws a filled and outlined polygon.
+	Access :		Public
+
+	Return :		void
+	Parameters :	const CPoint* points	-	Corners.
+					int count				-	Number of corners.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	LPCSTR op = BeginPaint(TRUE, TRUE);
+	if (!op || count < 2)
+		return;
+
+	WriteFormat("%d %d m", points[0].x, points[0].y);
+	for (int t = 1; t < count; t++)
+		WriteFormat(" %d %d l", points[t].x, points[t].y);
+	WriteFormat(" h %s\n", op);
+
+}
+
+void CDiagramPDFRenderer::Rectangle(const CRect& rect)
+/* ============================================================
+	Function :		CDiagramPDFRenderer::Rectangle
+	Description :	Draws a filled and outlined rectangle.
+	Access :		Public
+
+	Return :		void
+	Parameters :	const CRect& rect	-	Rectangle to draw.
+
+	Usage :			As in GDI, the right and bottom edges are
+					outside the rectangle.
+
+   ============================================================*/
+{
+
+	LPCSTR op = BeginPaint(TRUE, TRUE);
+	if (!op)
+		return;
+
+	CRect r(rect);
+	r.NormalizeRect();
+	WriteFormat("%d %d %d %d re %s\n", r.left, r.top, max(r.Width() - 1, 0), max(r.Height() - 1, 0), op);
+
+}
+
+void CDiagramPDFRenderer::RoundRect(const CRect& rect, CPoint corner)
+/* ============================================================
+	Function :		CDiagramPDFRenderer::RoundRect
+	Description :	Draws a filled and outlined rectangle with
+					rounded corners.
+	Access :		Public
+
+	Return :		void
+	Parameters :	const CRect& rect	-	Rectangle to draw.
+					CPoint corner		-	Width and height of
+											the corner ellipses.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	LPCSTR op = BeginPaint(TRUE, TRUE);
+	if (!op)
+		return;
+
+	CRect r(rect);
+	r.NormalizeRect();
+	double x0 = r.left;
+	double y0 = r.top;
+	double x1 = r.right - 1;
+	double y1 = r.bottom - 1;
+	double rx = min(static_cast<double>(abs(corner.x)) / 2, (x1 - x0) / 2);
+	double ry = min(static_cast<double>(abs(corner.y)) / 2, (y1 - y0) / 2);
+	double kx = rx * (1 - BEZIER_KAPPA);
+	double ky = ry * (1 - BEZIER_KAPPA);
+
+	WriteFormat("%.2f %.2f m %.2f %.2f l\n", x0 + rx, y0, x1 - rx, y0);
+	WriteFormat("%.2f %.2f %.2f %.2f %.2f %.2f c %.2f %.2f l\n", x1 - kx, y0, x1, y0 + ky, x1, y0 + ry, x1, y1 - ry);
+	WriteFormat("%.2f %.2f %.2f %.2f %.2f %.2f c %.2f %.2f l\n", x1, y1 - ky, x1 - kx, y1, x1 - rx, y1, x0 + rx, y1);
+	WriteFormat("%.2f %.2f %.2f %.2f %.2f %.2f c %.2f %.2f l\n", x0 + kx, y1, x0, y1 - ky, x0, y1 - ry, x0, y0 + ry);
+	WriteFormat("%.2f %.2f %.2f %.2f %.2f %.2f c h %s\n", x0, y0 + ky, x0 + kx, y0, x0 + rx, y0, op);
+
+}
+
+void CDiagramPDFRenderer::Ellipse(const CRect& rect)
+/* ============================================================
+	Function :		CDiagramPDFRenderer::Ellipse
+	Description :	Draws a filled and outlined ellipse.
+	Access :		Public
+
+	Return :		void
+	Parameters :	const CRect& rect	-	Bounding rectangle.
+
+	Usage :			Drawn as four Bezier curves.
+
+   ============================================================*/
+{
+
+	LPCSTR op = BeginPaint(TRUE, TRUE);
+	if (!op)
+		return;
+
+	CRect r(rect);
+	r.NormalizeRect();
+	double cx = static_cast<double>(r.left + r.right - 1) / 2;
+	double cy = static_cast<double>(r.top + r.bottom - 1) / 2;
+	double rx = static_cast<double>(max(r.Width() - 1, 0)) / 2;
+	double ry = static_cast<double>(max(r.Height() - 1, 0)) / 2;
+	double kx = rx * BEZIER_KAPPA;
+	double ky = ry * BEZIER_KAPPA;
+
+	WriteFormat("%.2f %.2f m\n", cx + rx, cy);
+	WriteFormat("%.2f %.2f %.2f %.2f %.2f %.2f c\n", cx + rx, cy + ky, cx + kx, cy + ry, cx, cy + ry);
+	WriteFormat("%.2f %.2f %.2f %.2f %.2f %.2f c\n", cx - kx, cy + ry, cx - rx, cy + ky, cx - rx, cy);
+	WriteFormat("%.2f %.2f %.2f %.2f %.2f %.2f c\n", cx - rx, cy - ky, cx - kx, cy - ry, cx, cy - ry);
+	WriteFormat("%.2f %.2f %.2f %.2f %.2f %.2f c h %s\n", cx + kx, cy - ry, cx + rx, cy - ky, cx + rx, cy, op);
+
+}
+
+void CDiagramPDFRenderer::DrawBitmap(UINT resid, const CRect& rect, CSize source, COLORREF transparent)
+/* ============================================================
+	Function :		CDiagramPDFRenderer::DrawBitmap
+	Description :	Draws a bitmap, stretched to "rect".
+	Access :		Public
+
+	Return :		void
+	Parameters :	UINT resid				-	Bitmap resource.
+					const CRect& rect		-	Where to draw.
+					CSize source			-	Part of the bitmap
+												to draw, from the
+												top left.
+					COLORREF transparent	-	Color not drawn.
+
+	Usage :			The bitmap is loaded the first time to get
+					its size, and written by "Close".
+
+   ============================================================*/
+{
+
+	if (!m_page || rect.Width() <= 0 || rect.Height() <= 0 || source.cx <= 0 || source.cy <= 0)
+		return;
+
+	CString key;
+	key.Format(_T("%u/%06X"), resid, transparent);
+
+	int image;
+	void* value;
+	if (m_images.Lookup(key, value))
+		image = static_cast<int>(reinterpret_cast<INT_PTR>(value));
+	else
+	{
+		int width;
+		int height;
+		CByteArray rgba;
+		if (LoadBitmapRGBA(resid, width, height, rgba))
+		{
+			image = static_cast<int>(m_imageObjects.Add(m_objects++));
+			m_imageIds.Add(resid);
+			m_imageColors.Add(transparent);
+			m_imageSizes.Add(MAKELONG(width, height));
+		}
+		else
+			image = -1;
+
+		m_images.SetAt(key, reinterpret_cast<void*>(static_cast<INT_PTR>(image)));
+	}
+
+	if (image == -1)
+		return;
+
+	// The whole image scaled so that "source" fills "rect", clipped to "rect"
+	double width = static_cast<double>(rect.Width()) * LOWORD(m_imageSizes[image]) / source.cx;
+	double height = static_cast<double>(rect.Height()) * HIWORD(m_imageSizes[image]) / source.cy;
+	WriteFormat("q %.2f %.2f %d %d re W n\n", rect.left - .5, rect.top - .5, rect.Width(), rect.Height());
+	WriteFormat("%.4f 0 0 %.4f %.2f %.2f cm /Im%d Do Q\n", width, -height, rect.left - .5, rect.top - .5 + height, image);
+
+}
+
+void CDiagramPDFRenderer::SetClipRect(const CRect& rect)
+/* ============================================================
+	Function :		CDiagramPDFRenderer::SetClipRect
+	Description :	Limits drawing to a rectangle.
+	Access :		Public
+
+	Return :		void
+	Parameters :	const CRect& rect	-	Rectangle to draw in.
+
+	Usage :			Replaces any earlier clipping rectangle.
+
+   ============================================================*/
+{
+
+	if (!m_page)
+		return;
+
+	ResetClip();
+
+	CRect r(rect);
+	r.NormalizeRect();
+	WriteFormat("q %.2f %.2f %d %d re W n\n", r.left - .5, r.top - .5, r.Width(), r.Height());
+	m_clipped = TRUE;
+
+}
+
+void CDiagramPDFRenderer::ResetClip()
+/* ============================================================
+	Function :		CDiagramPDFRenderer::ResetClip
+	Description :	Removes the clipping rectangle.
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Restoring the state also restores the
+					colors and line set before clipping, so
+					they are written again when next used.
+
+   ============================================================*/
+{
+
+	if (m_clipped)
+	{
+		Write("Q\n");
+		ForgetState();
+	}
+	m_clipped = FALSE;
+
+}
+
+void CDiagramPDFRenderer::DrawTextLine(const CString& line, const CRect& rect, UINT /*format*/)
+/* ============================================================
+	Function :		CDiagramPDFRenderer::DrawTextLine
+	Description :	Draws a line of text.
+	Access :		Protected
+
+	Return :		void
+	Parameters :	const CString& line	-	Text to draw.
+					const CRect& rect	-	Rectangle of the line.
+					UINT format			-	Not used, "rect" is
+											already aligned.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	if (!m_page)
+		return;
+
+	if (m_bkMode == OPAQUE)
+	{
+		SetFillColor(m_bkColor);
+		WriteFormat("%.2f %.2f %d %d re f\n", rect.left - .5, rect.top - .5, rect.Width(), rect.Height());
+	}
+
+	int font = 1;
+	if (IsFixedPitch())
+		font += 4;
+	if (IsItalic())
+		font += 2;
+	if (IsBold())
+		font++;
+
+	// The text matrix flips y back, so the glyphs are upright
+	SetFillColor(m_textColor);
+	WriteFormat("BT /F%d %d Tf 1 0 0 -1 %d %d Tm (", font, m_fontHeight, rect.left, rect.top + GetAscent());
+	WriteString(line);
+	Write(") Tj ET\n");
+
+	if (IsUnderline())
+		WriteFormat("%d %d %d %d re f\n", rect.left, rect.top + GetAscent() + 1, GetTextExtent(line).cx, max(m_fontHeight / 12, 1));
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramPDFRenderer private helpers
+
+void CDiagramPDFRenderer::BeginObject(int object)
+/* ============================================================
+	Function :		CDiagramPDFRenderer::BeginObject
+	Description :	Starts an object.
+	Access :		Private
+
+	Return :		void
+	Parameters :	int object	-	Object number.
+
+	Usage :			Records the offset for the cross reference
+					table.
+
+   ============================================================*/
+{
+
+	m_offsets.SetAtGrow(object, GetBytesWritten());
+	WriteFormat("%d 0 obj\n", object);
+
+}
+
+void CDiagramPDFRenderer::ForgetState()
+/* ============================================================
+	Function :		CDiagramPDFRenderer::ForgetState
+	Description :	Marks the graphics state as unknown.
+	Access :		Private
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Call when a page starts or the state is
+					restored, so the next colors and line are
+					written.
+
+   ============================================================*/
+{
+
+	m_strokeColor = CLR_INVALID;
+	m_fillColor = CLR_INVALID;
+	m_lineWidth = -1;
+	m_lineStyle = -1;
+
+}
+
+LPCSTR CDiagramPDFRenderer::BeginPaint(BOOL fill, BOOL stroke)
+/* ============================================================
+	Function :		CDiagramPDFRenderer::BeginPaint
+	Description :	Writes the state for painting a shape.
+	Access :		Private
+
+	Return :		LPCSTR		-	Operator painting the path,
+									"NULL" if nothing would be
+									painted.
+	Parameters :	BOOL fill	-	"TRUE" if the shape is
+									filled with the brush.
+					BOOL stroke	-	"TRUE" if the shape is
+									outlined with the pen.
+
+	Usage :			Call before writing the path, as the state
+					cannot be changed inside a path.
+
+   ============================================================*/
+{
+
+	if (!m_page)
+		return NULL;
+
+	fill = fill && m_fill;
+	stroke = stroke && m_penStyle != PS_NULL;
+
+	if (fill)
+		SetFillColor(m_brushColor);
+
+	if (stroke)
+	{
+		if (m_strokeColor != m_penColor)
+			WriteColor(m_penColor, "RG");
+		if (m_lineWidth != m_penWidth)
+			WriteFormat("%d w\n", m_penWidth);
+		if (m_lineStyle != m_penStyle)
+		{
+			switch (m_penStyle)
+			{
+			case PS_DASH:
+				Write("[18 6] 0 d\n");
+				break;
+			case PS_DOT:
+				Write("[3 3] 0 d\n");
+				break;
+			case PS_DASHDOT:
+				Write("[9 6 3 6] 0 d\n");
+				break;
+			case PS_DASHDOTDOT:
+				Write("[9 3 3 3 3 3] 0 d\n");
+				break;
+			default:
+				Write("[] 0 d\n");
+				break;
+			}
+		}
+
+		m_strokeColor = m_penColor;
+		m_lineWidth = m_penWidth;
+		m_lineStyle = m_penStyle;
+	}
+
+	if (fill && stroke)
+		return "B";
+	if (fill)
+		return "f";
+	if (stroke)
+		return "S";
+
+	return NULL;
+
+}
+
+void CDiagramPDFRenderer::SetFillColor(COLORREF color)
+/* ============================================================
+	Function :		CDiagramPDFRenderer::SetFillColor
+	Description :	Writes the fill color if it changed.
+	Access :		Private
+
+	Return :		void
+	Parameters :	COLORREF color	-	Color to fill with.
+
+	Usage :			The fill color is also the text color.
+
+   ============================================================*/
+{
+
+	if (m_fillColor == color)
+		return;
+
+	WriteColor(color, "rg");
+	m_fillColor = color;
+
+}
+
+void CDiagramPDFRenderer::WriteColor(COLORREF color, LPCSTR op)
+/* ============================================================
+	Function :		CDiagramPDFRenderer::WriteColor
+	Description :	Writes a color operator.
+	Access :		Private
+
+	Return :		void
+	Parameters :	COLORREF color	-	Color.
+					LPCSTR op		-	"RG" for lines, "rg"
+										for fills.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	WriteFormat("%.3f %.3f %.3f %s\n",
+		static_cast<double>(GetRValue(color)) / 255,
+		static_cast<double>(GetGValue(color)) / 255,
+		static_cast<double>(GetBValue(color)) / 255,
+		op);
+
+}
+
+void CDiagramPDFRenderer::WriteString(const CString& text)
+/* ============================================================
+	Function :		CDiagramPDFRenderer::WriteString
+	Description :	Writes text for a string in parentheses.
+	Access :		Private
+
+	Return :		void
+	Parameters :	const CString& text	-	Text to write.
+
+	Usage :			Converted to the Windows code page of the
+					fonts. Parentheses and backslashes are
+					escaped, and bytes outside ASCII written
+					as octal.
+
+   ============================================================*/
+{
+
+	CByteArray bytes;
+	Encode(text, 1252, bytes);
+
+	INT_PTR size = bytes.GetSize();
+	for (INT_PTR t = 0; t < size; t++)
+	{
+		BYTE c = bytes[t];
+		if (c == '(' || c == ')' || c == '\\')
+		{
+			Write("\\");
+			Write(&c, 1);
+		}
+		else if (c >= 128)
+			WriteFormat("\\%03o", c);
+		else if (c >= 32)
+			Write(&c, 1);
+	}
+
+}
+
+void CDiagramPDFRenderer::WriteImage(int image)
+/* ============================================================
+	Function :		CDiagramPDFRenderer::WriteImage
+	Description :	Writes an image object.
+	Access :		Private
+
+	Return :		void
+	Parameters :	int image	-	Index of the image.
+
+	Usage :			The image is loaded again, one row is
+					converted at a time. Pixels of the
+					transparent color are masked.
+
+   ============================================================*/
+{
+
+	int width;
+	int height;
+	CByteArray rgba;
+	if (!LoadBitmapRGBA(m_imageIds[image], width, height, rgba))
+	{
+		width = 0;
+		height = 0;
+	}
+
+	// Keep the size given when drawing, so the object matches the pages
+	int stored = static_cast<int>(LOWORD(m_imageSizes[image]));
+	int storedHeight = static_cast<int>(HIWORD(m_imageSizes[image]));
+	BOOL ok = (width == stored && height == storedHeight);
+	width = stored;
+	height = storedHeight;
+
+	COLORREF transparent = m_imageColors[image];
+	BeginObject(m_imageObjects[image]);
+	WriteFormat("<< /Type /XObject /Subtype /Image /Width %d /Height %d /ColorSpace /DeviceRGB /BitsPerComponent 8 /Mask [%d %d %d %d %d %d] /Length %d >>\nstream\n",
+		width, height,
+		GetRValue(transparent), GetRValue(transparent),
+		GetGValue(transparent), GetGValue(transparent),
+		GetBValue(transparent), GetBValue(transparent),
+		width * height * 3);
+
+	CByteArray row;
+	row.SetSize(width * 3);
+	BYTE* out = row.GetData();
+	for (int y = 0; y < height; y++)
+	{
+		if (ok)
+		{
+			const BYTE* in = rgba.GetData() + static_cast<size_t>(y) * width * 4;
+			for (int x = 0; x < width; x++)
+			{
+				out[x * 3] = in[x * 4];
+				out[x * 3 + 1] = in[x * 4 + 1];
+				out[x * 3 + 2] = in[x * 4 + 2];
+			}
+		}
+		else
+			memset(out, 255, width * 3);
+
+		Write(out, width * 3);
+	}
+
+	Write("\nendstream\nendobj\n");
+
+}
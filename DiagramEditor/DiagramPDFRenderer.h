@@ -0,0 +1,84 @@
+#ifndef _CDIAGRAMPDFRENDERER_H_07B6A3D2_E54C_4F18_9B2D7C61E0A84
+#define _CDIAGRAMPDFRENDERER_H_07B6A3D2_E54C_4F18_9B2D7C61E0A84
+
+///////////////////////////////////////////////////////////
+// File :		DiagramPDFRenderer.h
+// Created :	10/19/26
+//
+
+#include "DiagramVectorRenderer.h"
+
+#define PDF_MARGIN		36		// Page margin, in points
+
+// Streams PDF to a file, one page at a time
+class CDiagramPDFRenderer : public CDiagramVectorRenderer
+{
+public:
+	// Construction/destruction
+	CDiagramPDFRenderer();
+	virtual ~CDiagramPDFRenderer();
+
+	// Operations
+	BOOL			Open(const CString& filename);
+	BOOL			Close();
+
+	void			BeginPage(CSize paper, const CRect& area, double scale);
+	void			EndPage();
+
+	// Attributes
+	int				GetPageCount() const;
+
+	// Overrides
+	virtual void	Line(CPoint from, CPoint to);
+	virtual void	Polyline(const CPoint* points, int count);
+	virtual void	Polygon(const CPoint* points, int count);
+	virtual void	Rectangle(const CRect& rect);
+	virtual void	RoundRect(const CRect& rect, CPoint corner);
+	virtual void	Ellipse(const CRect& rect);
+
+	virtual void	DrawBitmap(UINT resid, const CRect& rect, CSize source, COLORREF transparent);
+
+	virtual void	SetClipRect(const CRect& rect);
+	virtual void	ResetClip();
+
+protected:
+	virtual void	DrawTextLine(const CString& line, const CRect& rect, UINT format);
+
+private:
+	// Objects
+	CDWordArray		m_offsets;		// File offset of each object, by number
+	int				m_objects;		// Next object number
+	CDWordArray		m_pages;		// Page objects
+
+	// Images, drawn as XObjects written by "Close"
+	CMapStringToPtr	m_images;		// Image number by resource and transparent color
+	CDWordArray		m_imageObjects;
+	CDWordArray		m_imageIds;
+	CDWordArray		m_imageColors;
+	CDWordArray		m_imageSizes;	// Width in the low word, height in the high word
+
+	// Current page
+	BOOL			m_page;
+	CSize			m_paper;
+	int				m_contents;		// Content stream object
+	DWORD			m_start;		// File offset of the stream data
+	BOOL			m_clipped;
+
+	// Graphics state written to the page, so it is only written when it changes
+	COLORREF		m_strokeColor;
+	COLORREF		m_fillColor;
+	int				m_lineWidth;
+	int				m_lineStyle;
+
+	// Helpers
+	void	BeginObject(int object);
+	void	ForgetState();
+	LPCSTR	BeginPaint(BOOL fill, BOOL stroke);
+	void	SetFillColor(COLORREF color);
+	void	WriteColor(COLORREF color, LPCSTR op);
+	void	WriteString(const CString& text);
+	void	WriteImage(int image);
+
+};
+
+#endif //_CDIAGRAMPDFRENDERER_H_07B6A3D2_E54C_4F18_9B2D7C61E0A84
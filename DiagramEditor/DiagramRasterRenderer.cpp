@@ -0,0 +1,1434 @@
+/* ==========================================================================
+	File :			DiagramRasterRenderer.cpp
+
+	Class :			CDiagramRasterRenderer
+
+	Date :			10/19/26
+
+	Purpose :		"CDiagramRasterRenderer" is a "CDiagramRenderer"
+					drawing to a 32-bit RGBA buffer in memory, without
+					GDI. The result does not depend on the display,
+					fonts or drivers of the machine, so it can be
+					compared between runs and saved as a PNG for
+					golden images and render benchmarks.
+
+	Description :	Shapes follow the GDI conventions, so entities look
+					as in the editor: lines do not include the end
+					point, rectangles cover "left" to "right" - 1,
+					filled shapes are outlined with the pen.
+
+					Lines use Bresenham's algorithm. "PS_DASH" and
+					"PS_DOT" use fixed patterns of 18/6 and 3/3
+					pixels, and wide pens stamp a square. Polygons
+					are filled with the even-odd rule, sampling at
+					pixel centers. Ellipses and rounded rectangles are
+					filled a row at a time, and the outline joins the
+					ends of the rows.
+
+					Text uses a built-in 5x7 font, scaled to the font
+					height, whatever the face. Bold text is drawn
+					twice, italic text slants the rows of the glyphs,
+					and underlined text gets a line in the bottom row
+					of the cell. Characters outside ASCII are drawn as
+					"?".
+
+					Bitmaps are loaded from the resources the first
+					time they are drawn, or can be set with
+					"SetBitmap". They are scaled with nearest
+					neighbor sampling.
+
+					"SetOrigin" moves the canvas over the drawing, so
+					parts of a large drawing can be rendered to a
+					smaller canvas.
+
+	Usage :			Call "Create", then pass the renderer to
+					"CDiagramEntityContainer::RenderObjects" or
+					"CDiagramEntity::RenderObject". Read the result
+					with "GetRow" or save it with "SavePNG".
+
+   ========================================================================*/
+
+#include "stdafx.h"
+#include "DiagramRasterRenderer.h"
+#include "PNGWriter.h"
+#include <math.h>
+
+#ifdef _DEBUG
+#define new DEBUG_NEW
+#undef THIS_FILE
+static char THIS_FILE[] = __FILE__;
+#endif
+
+// Dash patterns, pixels on and off
+#define DASH_ON		18
+#define DASH_OFF	6
+#define DOT_ON		3
+#define DOT_OFF		3
+
+// 5x7 font for ASCII 32 - 126, a byte for each column, top row in bit 0
+static const BYTE font5x7[95][5] = {
+	{ 0x00, 0x00, 0x00, 0x00, 0x00 }, { 0x00, 0x00, 0x5F, 0x00, 0x00 }, { 0x00, 0x07, 0x00, 0x07, 0x00 }, { 0x14, 0x7F, 0x14, 0x7F, 0x14 },
+	{ 0x24, 0x2A, 0x7F, 0x2A, 0x12 }, { 0x23, 0x13, 0x08, 0x64, 0x62 }, { 0x36, 0x49, 0x55, 0x22, 0x50 }, { 0x00, 0x05, 0x03, 0x00, 0x00 },
+	{ 0x00, 0x1C, 0x22, 0x41, 0x00 }, { 0x00, 0x41, 0x22, 0x1C, 0x00 }, { 0x14, 0x08, 0x3E, 0x08, 0x14 }, { 0x08, 0x08, 0x3E, 0x08, 0x08 },
+	{ 0x00, 0x50, 0x30, 0x00, 0x00 }, { 0x08, 0x08, 0x08, 0x08, 0x08 }, { 0x00, 0x60, 0x60, 0x00, 0x00 }, { 0x20, 0x10, 0x08, 0x04, 0x02 },
+	{ 0x3E, 0x51, 0x49, 0x45, 0x3E }, { 0x00, 0x42, 0x7F, 0x40, 0x00 }, { 0x42, 0x61, 0x51, 0x49, 0x46 }, { 0x21, 0x41, 0x45, 0x4B, 0x31 },
+	{ 0x18, 0x14, 0x12, 0x7F, 0x10 }, { 0x27, 0x45, 0x45, 0x45, 0x39 }, { 0x3C, 0x4A, 0x49, 0x49, 0x30 }, { 0x01, 0x71, 0x09, 0x05, 0x03 },
+	{ 0x36, 0x49, 0x49, 0x49, 0x36 }, { 0x06, 0x49, 0x49, 0x29, 0x1E }, { 0x00, 0x36, 0x36, 0x00, 0x00 }, { 0x00, 0x56, 0x36, 0x00, 0x00 },
+	{ 0x08, 0x14, 0x22, 0x41, 0x00 }, { 0x14, 0x14, 0x14, 0x14, 0x14 }, { 0x00, 0x41, 0x22, 0x14, 0x08 }, { 0x02, 0x01, 0x51, 0x09, 0x06 },
+	{ 0x32, 0x49, 0x79, 0x41, 0x3E }, { 0x7E, 0x11, 0x11, 0x11, 0x7E }, { 0x7F, 0x49, 0x49, 0x49, 0x36 }, { 0x3E, 0x41, 0x41, 0x41, 0x22 },
+	{ 0x7F, 0x41, 0x41, 0x22, 0x1C }, { 0x7F, 0x49, 0x49, 0x49, 0x41 }, { 0x7F, 0x09, 0x09, 0x09, 0x01 }, { 0x3E, 0x41, 0x49, 0x49, 0x7A },
+	{ 0x7F, 0x08, 0x08, 0x08, 0x7F }, { 0x00, 0x41, 0x7F, 0x41, 0x00 }, { 0x20, 0x40, 0x41, 0x3F, 0x01 }, { 0x7F, 0x08, 0x14, 0x22, 0x41 },
+	{ 0x7F, 0x40, 0x40, 0x40, 0x40 }, { 0x7F, 0x02, 0x0C, 0x02, 0x7F }, { 0x7F, 0x04, 0x08, 0x10, 0x7F }, { 0x3E, 0x41, 0x41, 0x41, 0x3E },
+	{ 0x7F, 0x09, 0x09, 0x09, 0x06 }, { 0x3E, 0x41, 0x51, 0x21, 0x5E }, { 0x7F, 0x09, 0x19, 0x29, 0x46 }, { 0x46, 0x49, 0x49, 0x49, 0x31 },
+	{ 0x01, 0x01, 0x7F, 0x01, 0x01 }, { 0x3F, 0x40, 0x40, 0x40, 0x3F }, { 0x1F, 0x20, 0x40, 0x20, 0x1F }, { 0x3F, 0x40, 0x38, 0x40, 0x3F },
+	{ 0x63, 0x14, 0x08, 0x14, 0x63 }, { 0x07, 0x08, 0x70, 0x08, 0x07 }, { 0x61, 0x51, 0x49, 0x45, 0x43 }, { 0x00, 0x7F, 0x41, 0x41, 0x00 },
+	{ 0x02, 0x04, 0x08, 0x10, 0x20 }, { 0x00, 0x41, 0x41, 0x7F, 0x00 }, { 0x04, 0x02, 0x01, 0x02, 0x04 }, { 0x40, 0x40, 0x40, 0x40, 0x40 },
+	{ 0x00, 0x01, 0x02, 0x04, 0x00 }, { 0x20, 0x54, 0x54, 0x54, 0x78 }, { 0x7F, 0x48, 0x44, 0x44, 0x38 }, { 0x38, 0x44, 0x44, 0x44, 0x20 },
+	{ 0x38, 0x44, 0x44, 0x48, 0x7F }, { 0x38, 0x54, 0x54, 0x54, 0x18 }, { 0x08, 0x7E, 0x09, 0x01, 0x02 }, { 0x0C, 0x52, 0x52, 0x52, 0x3E },
+	{ 0x7F, 0x08, 0x04, 0x04, 0x78 }, { 0x00, 0x44, 0x7D, 0x40, 0x00 }, { 0x20, 0x40, 0x44, 0x3D, 0x00 }, { 0x7F, 0x10, 0x28, 0x44, 0x00 },
+	{ 0x00, 0x41, 0x7F, 0x40, 0x00 }, { 0x7C, 0x04, 0x18, 0x04, 0x78 }, { 0x7C, 0x08, 0x04, 0x04, 0x78 }, { 0x38, 0x44, 0x44, 0x44, 0x38 },
+	{ 0x7C, 0x14, 0x14, 0x14, 0x08 }, { 0x08, 0x14, 0x14, 0x18, 0x7C }, { 0x7C, 0x08, 0x04, 0x04, 0x08 }, { 0x48, 0x54, 0x54, 0x54, 0x20 },
+	{ 0x04, 0x3F, 0x44, 0x40, 0x20 }, { 0x3C, 0x40, 0x40, 0x20, 0x7C }, { 0x1C, 0x20, 0x40, 0x20, 0x1C }, { 0x3C, 0x40, 0x30, 0x40, 0x3C },
+	{ 0x44, 0x28, 0x10, 0x28, 0x44 }, { 0x0C, 0x50, 0x50, 0x50, 0x3C }, { 0x44, 0x64, 0x54, 0x4C, 0x44 }, { 0x00, 0x08, 0x36, 0x41, 0x00 },
+	{ 0x00, 0x00, 0x7F, 0x00, 0x00 }, { 0x00, 0x41, 0x36, 0x08, 0x00 }, { 0x02, 0x01, 0x02, 0x04, 0x02 }
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramRasterRenderer construction/destruction
+
+CDiagramRasterRenderer::CDiagramRasterRenderer()
+/* ============================================================
+	Function :		CDiagramRasterRenderer::CDiagramRasterRenderer
+	Description :	Constructor
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Call "Create" before drawing.
+
+   ============================================================*/
+{
+
+	m_pixels = NULL;
+	m_width = 0;
+	m_height = 0;
+	m_origin = CPoint(0, 0);
+	m_clip.SetRectEmpty();
+	Reset();
+
+}
+
+CDiagramRasterRenderer::~CDiagramRasterRenderer()
+/* ============================================================
+	Function :		CDiagramRasterRenderer::~CDiagramRasterRenderer
+	Description :	Destructor
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	delete[] m_pixels;
+	ClearImages();
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramRasterRenderer canvas
+
+BOOL CDiagramRasterRenderer::Create(int width, int height, COLORREF background)
+/* ============================================================
+	Function :		CDiagramRasterRenderer::Create
+	Description :	Creates the canvas.
+	Access :		Public
+
+	Return :		BOOL				-	"FALSE" if the size
+											is empty or too
+											large.
+	Parameters :	int width			-	Width in pixels.
+					int height			-	Height in pixels.
+					COLORREF background	-	Color to fill the
+											canvas with.
+
+	Usage :			Can be called again to resize the canvas.
+					The origin and drawing state are reset.
+
+   ============================================================*/
+{
+
+	if (width <= 0 || height <= 0 || static_cast<ULONGLONG>(width) * height > 0x10000000)
+		return FALSE;
+
+	delete[] m_pixels;
+	m_pixels = NULL;
+
+	TRY
+	{
+		m_pixels = new BYTE[static_cast<size_t>(width) * height * 4];
+	}
+	CATCH(CMemoryException, e)
+	{
+		e->Delete();
+		m_width = 0;
+		m_height = 0;
+		return FALSE;
+	}
+	END_CATCH
+
+	m_width = width;
+	m_height = height;
+	m_origin = CPoint(0, 0);
+	Reset();
+	Clear(background);
+
+	return TRUE;
+
+}
+
+void CDiagramRasterRenderer::Clear(COLORREF background)
+/* ============================================================
+	Function :		CDiagramRasterRenderer::Clear
+	Description :	Fills the canvas with a color.
+	Access :		Public
+
+	Return :		void
+	Parameters :	COLORREF background	-	Color to fill with.
+
+	Usage :			Ignores the clipping.
+
+   ============================================================*/
+{
+
+	if (!m_pixels)
+		return;
+
+	BYTE* row = m_pixels;
+	for (int x = 0; x < m_width; x++)
+	{
+		row[x * 4] = GetRValue(background);
+		row[x * 4 + 1] = GetGValue(background);
+		row[x * 4 + 2] = GetBValue(background);
+		row[x * 4 + 3] = 255;
+	}
+
+	for (int y = 1; y < m_height; y++)
+		memcpy(m_pixels + static_cast<size_t>(y) * m_width * 4, row, m_width * 4);
+
+}
+
+void CDiagramRasterRenderer::Reset()
+/* ============================================================
+	Function :		CDiagramRasterRenderer::Reset
+	Description :	Resets the drawing state.
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Sets the state of a new "CDC": black pen,
+					white brush, black text on an opaque white
+					background, and no clipping.
+
+   ============================================================*/
+{
+
+	m_penStyle = PS_SOLID;
+	m_penWidth = 1;
+	m_penColor = RGB(0, 0, 0);
+	m_dash = 0;
+	m_fill = TRUE;
+	m_brushColor = RGB(255, 255, 255);
+	m_fontHeight = 11;
+	m_fontWeight = FW_NORMAL;
+	m_fontItalic = FALSE;
+	m_fontUnderline = FALSE;
+	m_textColor = RGB(0, 0, 0);
+	m_bkColor = RGB(255, 255, 255);
+	m_bkMode = OPAQUE;
+	ResetClip();
+
+}
+
+int CDiagramRasterRenderer::GetWidth() const
+/* ============================================================
+	Function :		CDiagramRasterRenderer::GetWidth
+	Description :	Gets the width of the canvas.
+	Access :		Public
+
+	Return :		int		-	Width in pixels.
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	return m_width;
+
+}
+
+int CDiagramRasterRenderer::GetHeight() const
+/* ============================================================
+	Function :		CDiagramRasterRenderer::GetHeight
+	Description :	Gets the height of the canvas.
+	Access :		Public
+
+	Return :		int		-	Height in pixels.
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	return m_height;
+
+}
+
+void CDiagramRasterRenderer::SetOrigin(CPoint origin)
+/* ============================================================
+	Function :		CDiagramRasterRenderer::SetOrigin
+	Description :	Sets the drawing coordinate of the top
+					left pixel of the canvas.
+	Access :		Public
+
+	Return :		void
+	Parameters :	CPoint origin	-	New origin.
+
+	Usage :			Call before drawing to render a part of a
+					drawing larger than the canvas. Clipping
+					is reset.
+
+   ============================================================*/
+{
+
+	m_origin = origin;
+	ResetClip();
+
+}
+
+CPoint CDiagramRasterRenderer::GetOrigin() const
+/* ============================================================
+	Function :		CDiagramRasterRenderer::GetOrigin
+	Description :	Gets the drawing coordinate of the top
+					left pixel of the canvas.
+	Access :		Public
+
+	Return :		CPoint	-	The origin.
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	return m_origin;
+
+}
+
+const BYTE* CDiagramRasterRenderer::GetRow(int y) const
+/* ============================================================
+	Function :		CDiagramRasterRenderer::GetRow
+	Description :	Gets a row of pixels.
+	Access :		Public
+
+	Return :		const BYTE*	-	"width" * 4 bytes of red,
+									green, blue and alpha, or
+									"NULL" if "y" is outside
+									the canvas.
+	Parameters :	int y		-	Row, 0 at the top of the
+									canvas.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	if (!m_pixels || y < 0 || y >= m_height)
+		return NULL;
+
+	return m_pixels + static_cast<size_t>(y) * m_width * 4;
+
+}
+
+COLORREF CDiagramRasterRenderer::GetPixel(int x, int y) const
+/* ============================================================
+	Function :		CDiagramRasterRenderer::GetPixel
+	Description :	Gets the color of a pixel.
+	Access :		Public
+
+	Return :		COLORREF	-	The color, black outside
+									the canvas.
+	Parameters :	int x		-	Column on the canvas.
+					int y		-	Row on the canvas.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	const BYTE* row = GetRow(y);
+	if (!row || x < 0 || x >= m_width)
+		return RGB(0, 0, 0);
+
+	return RGB(row[x * 4], row[x * 4 + 1], row[x * 4 + 2]);
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramRasterRenderer images
+
+void CDiagramRasterRenderer::SetBitmap(UINT resid, int width, int height, const BYTE* rgba)
+/* ============================================================
+	Function :		CDiagramRasterRenderer::SetBitmap
+	Description :	Sets the image drawn for a bitmap resource.
+	Access :		Public
+
+	Return :		void
+	Parameters :	UINT resid			-	Resource id.
+					int width			-	Width of the image.
+					int height			-	Height of the image.
+					const BYTE* rgba	-	"width" * "height" * 4
+											bytes, top row first.
+
+	Usage :			Use to draw without the resources, or to
+					share images loaded once between several
+					renderers. The data is copied.
+
+   ============================================================*/
+{
+
+	void* ptr = NULL;
+	if (m_images.Lookup(static_cast<WORD>(resid), ptr))
+		delete static_cast<CImage*>(ptr);
+
+	CImage* image = new CImage;
+	image->width = max(width, 0);
+	image->height = max(height, 0);
+	image->rgba.SetSize(image->width * image->height * 4);
+	if (image->rgba.GetSize())
+		memcpy(image->rgba.GetData(), rgba, image->rgba.GetSize());
+
+	m_images.SetAt(static_cast<WORD>(resid), image);
+
+}
+
+const CDiagramRasterRenderer::CImage* CDiagramRasterRenderer::GetImage(UINT resid)
+/* ============================================================
+	Function :		CDiagramRasterRenderer::GetImage
+	Description :	Gets the image for a bitmap resource.
+	Access :		Private
+
+	Return :		const CImage*	-	The image, empty if the
+										resource could not be
+										loaded.
+	Parameters :	UINT resid		-	Resource id.
+
+	Usage :			Loads the bitmap the first time.
+
+   ============================================================*/
+{
+
+	void* ptr = NULL;
+	if (m_images.Lookup(static_cast<WORD>(resid), ptr))
+		return static_cast<CImage*>(ptr);
+
+	CImage* image = new CImage;
+	LoadBitmapRGBA(resid, image->width, image->height, image->rgba);
+
+	m_images.SetAt(static_cast<WORD>(resid), image);
+	return image;
+
+}
+
+void CDiagramRasterRenderer::ClearImages()
+/* ============================================================
+	Function :		CDiagramRasterRenderer::ClearImages
+	Description :	Deletes the images.
+	Access :		Private
+
+	Return :		void
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	POSITION pos = m_images.GetStartPosition();
+	while (pos)
+	{
+		WORD key;
+		void* ptr;
+		m_images.GetNextAssoc(pos, key, ptr);
+		delete static_cast<CImage*>(ptr);
+	}
+
+	m_images.RemoveAll();
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramRasterRenderer output
+
+BOOL CDiagramRasterRenderer::SavePNG(const CString& filename) const
+/* ============================================================
+	Function :		CDiagramRasterRenderer::SavePNG
+	Description :	Saves the canvas as a PNG file.
+	Access :		Public
+
+	Return :		BOOL					-	"TRUE" if saved.
+	Parameters :	const CString& filename	-	File to save to.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	if (!m_pixels)
+		return FALSE;
+
+	CPNGWriter writer;
+	if (!writer.Open(filename, m_width, m_height))
+		return FALSE;
+
+	for (int y = 0; y < m_height; y++)
+		writer.WriteRow(GetRow(y));
+
+	return writer.Close();
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramRasterRenderer pens, brushes and fonts
+
+void CDiagramRasterRenderer::SetPen(int style, int width, COLORREF color)
+/* ============================================================
+	Function :		CDiagramRasterRenderer::SetPen
+	Description :	Sets the pen for lines and outlines.
+	Access :		Public
+
+	Return :		void
+	Parameters :	int style		-	"PS_SOLID", "PS_DASH",
+										"PS_DOT" or "PS_NULL".
+										Other styles are solid.
+					int width		-	Width in pixels, 0 for
+										the thinnest line.
+					COLORREF color	-	Color of the pen.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	m_penStyle = style;
+	m_penWidth = max(width, 1);
+	m_penColor = color;
+
+}
+
+void CDiagramRasterRenderer::SetBrush(COLORREF color)
+/* ============================================================
+	Function :		CDiagramRasterRenderer::SetBrush
+	Description :	Sets the brush for filled shapes.
+	Access :		Public
+
+	Return :		void
+	Parameters :	COLORREF color	-	Color of the brush.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	m_fill = TRUE;
+	m_brushColor = color;
+
+}
+
+void CDiagramRasterRenderer::SetNullBrush()
+/* ============================================================
+	Function :		CDiagramRasterRenderer::SetNullBrush
+	Description :	Draws shapes without filling them.
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	m_fill = FALSE;
+
+}
+
+void CDiagramRasterRenderer::SetFont(LPCTSTR /*face*/, int height, int weight, BOOL italic, BOOL underline)
+/* ============================================================
+	Function :		CDiagramRasterRenderer::SetFont
+	Description :	Sets the font for text.
+	Access :		Public
+
+	Return :		void
+	Parameters :	LPCTSTR face	-	Not used, the built-in
+										font is used for all
+										faces.
+					int height		-	Height, as for
+										"CreateFont".
+					int weight		-	Weight, "FW_BOLD" or
+										heavier draws bold.
+					BOOL italic		-	"TRUE" for italic.
+					BOOL underline	-	"TRUE" for underlined.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	m_fontHeight = max(abs(height), 1);
+	m_fontWeight = weight;
+	m_fontItalic = italic;
+	m_fontUnderline = underline;
+
+}
+
+void CDiagramRasterRenderer::SetTextColor(COLORREF color)
+/* ============================================================
+	Function :		CDiagramRasterRenderer::SetTextColor
+	Description :	Sets the text color.
+	Access :		Public
+
+	Return :		void
+	Parameters :	COLORREF color	-	Color of text.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	m_textColor = color;
+
+}
+
+void CDiagramRasterRenderer::SetBkColor(COLORREF color)
+/* ============================================================
+	Function :		CDiagramRasterRenderer::SetBkColor
+	Description :	Sets the text background color.
+	Access :		Public
+
+	Return :		void
+	Parameters :	COLORREF color	-	Color behind text.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	m_bkColor = color;
+
+}
+
+void CDiagramRasterRenderer::SetBkMode(int mode)
+/* ============================================================
+	Function :		CDiagramRasterRenderer::SetBkMode
+	Description :	Sets the text background mode.
+	Access :		Public
+
+	Return :		void
+	Parameters :	int mode	-	"OPAQUE" or "TRANSPARENT".
+
+	Usage :
+
+   ============================================================*/
+{
+
+	m_bkMode = mode;
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramRasterRenderer shapes
+
+void CDiagramRasterRenderer::Line(CPoint from, CPoint to)
+/* ============================================================
+	Function :		CDiagramRasterRenderer::Line
+	Description :	Draws a line with the current pen.
+	Access :		Public
+
+	Return :		void
+	Parameters :	CPoint from	-	Start of the line.
+					CPoint to	-	End of the line, not drawn.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	m_dash = 0;
+	Stroke(from - m_origin, to - m_origin);
+
+}
+
+void CDiagramRasterRenderer::Polyline(const CPoint* points, int count)
+/* ============================================================
+	Function :		CDiagramRasterRenderer::Polyline
+	Description :	Draws connected lines with the current pen.
+	Access :		Public
+
+	Return :		void
+	Parameters :	const CPoint* points	-	Points to connect.
+					int count				-	Number of points.
+
+	Usage :			Dashes continue from one line to the next.
+
+   ============================================================*/
+{
+
+	m_dash = 0;
+	for (int t = 1; t < count; t++)
+		Stroke(points[t - 1] - m_origin, points[t] - m_origin);
+
+}
+
+void CDiagramRasterRenderer::Polygon(const CPoint* points, int count)
+/* ============================================================
+	Function :		CDiagramRasterRenderer::Polygon
+	Description :	Draws a filled and outlined polygon.
+	Access :		Public
+
+	Return :		void
+	Parameters :	const CPoint* points	-	Corners.
+					int count				-	Number of corners.
+
+	Usage :			Filled with the even-odd rule, as the
+					default "ALTERNATE" fill mode of a "CDC".
+
+   ============================================================*/
+{
+
+	if (count < 2)
+		return;
+
+	if (m_fill)
+	{
+		int top = points[0].y;
+		int bottom = points[0].y;
+		for (int t = 1; t < count; t++)
+		{
+			top = min(top, points[t].y);
+			bottom = max(bottom, points[t].y);
+		}
+
+		top = max(top - m_origin.y, m_clip.top);
+		bottom = min(bottom - m_origin.y, m_clip.bottom);
+
+		CArray< double, double > xs;
+		for (int y = top; y < bottom; y++)
+		{
+			// Crossings at the pixel center
+			double center = static_cast<double>(y + m_origin.y) + 0.5;
+			xs.RemoveAll();
+			for (int t = 0; t < count; t++)
+			{
+				CPoint p0 = points[t];
+				CPoint p1 = points[(t + 1) % count];
+				if (p0.y == p1.y)
+					continue;
+
+				if (center >= min(p0.y, p1.y) && center < max(p0.y, p1.y))
+				{
+					double x = p0.x + (center - p0.y) * (p1.x - p0.x) / static_cast<double>(p1.y - p0.y);
+
+					// Insertion sort, there are few crossings
+					INT_PTR pos = xs.GetSize();
+					while (pos > 0 && xs[pos - 1] > x)
+						pos--;
+					xs.InsertAt(pos, x);
+				}
+			}
+
+			for (INT_PTR t = 0; t + 1 < xs.GetSize(); t += 2)
+			{
+				int left = static_cast<int>(ceil(xs[t] - 0.5)) - m_origin.x;
+				int right = static_cast<int>(ceil(xs[t + 1] - 0.5)) - m_origin.x;
+				FillSpan(y, left, right, m_brushColor);
+			}
+		}
+	}
+
+	m_dash = 0;
+	for (int t = 0; t < count; t++)
+		Stroke(points[t] - m_origin, points[(t + 1) % count] - m_origin);
+
+}
+
+void CDiagramRasterRenderer::Rectangle(const CRect& rect)
+/* ============================================================
+	Function :		CDiagramRasterRenderer::Rectangle
+	Description :	Draws a filled and outlined rectangle.
+	Access :		Public
+
+	Return :		void
+	Parameters :	const CRect& rect	-	Rectangle to draw.
+
+	Usage :			The outline is drawn inside "rect".
+
+   ============================================================*/
+{
+
+	CRect r(rect);
+	r.NormalizeRect();
+	r.OffsetRect(-m_origin);
+	if (r.IsRectEmpty())
+		return;
+
+	if (m_fill)
+		FillRect(r, m_brushColor);
+
+	CPoint pts[4];
+	pts[0] = CPoint(r.left, r.top);
+	pts[1] = CPoint(r.right - 1, r.top);
+	pts[2] = CPoint(r.right - 1, r.bottom - 1);
+	pts[3] = CPoint(r.left, r.bottom - 1);
+	Outline(pts, 4);
+
+}
+
+void CDiagramRasterRenderer::RoundRect(const CRect& rect, CPoint corner)
+/* ============================================================
+	Function :		CDiagramRasterRenderer::RoundRect
+	Description :	Draws a filled and outlined rectangle with
+					rounded corners.
+	Access :		Public
+
+	Return :		void
+	Parameters :	const CRect& rect	-	Rectangle to draw.
+					CPoint corner		-	Width and height of
+											the corner ellipses.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	CRect r(rect);
+	r.NormalizeRect();
+	r.OffsetRect(-m_origin);
+
+	double rx = min(static_cast<double>(abs(corner.x)) / 2, static_cast<double>(r.Width()) / 2);
+	double ry = min(static_cast<double>(abs(corner.y)) / 2, static_cast<double>(r.Height()) / 2);
+	RoundedShape(r, rx, ry);
+
+}
+
+void CDiagramRasterRenderer::Ellipse(const CRect& rect)
+/* ============================================================
+	Function :		CDiagramRasterRenderer::Ellipse
+	Description :	Draws a filled and outlined ellipse.
+	Access :		Public
+
+	Return :		void
+	Parameters :	const CRect& rect	-	Bounding rectangle.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	CRect r(rect);
+	r.NormalizeRect();
+	r.OffsetRect(-m_origin);
+
+	RoundedShape(r, static_cast<double>(r.Width()) / 2, static_cast<double>(r.Height()) / 2);
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramRasterRenderer text and images
+
+void CDiagramRasterRenderer::DrawText(const CString& text, const CRect& rect, UINT format)
+/* ============================================================
+	Function :		CDiagramRasterRenderer::DrawText
+	Description :	Draws text in a rectangle.
+	Access :		Public
+
+	Return :		void
+	Parameters :	const CString& text	-	Text to draw.
+					const CRect& rect	-	Rectangle to draw in.
+					UINT format			-	"DT_"-flags.
+
+	Usage :			Supports "DT_SINGLELINE", "DT_WORDBREAK",
+					"DT_CENTER", "DT_RIGHT", "DT_VCENTER",
+					"DT_BOTTOM" and "DT_NOCLIP". Prefix
+					characters are not handled.
+
+   ============================================================*/
+{
+
+	CRect r(rect);
+	r.OffsetRect(-m_origin);
+
+	CStringArray lines;
+	BreakLines(text, r.Width(), format, lines);
+
+	int height = GetLineHeight();
+	int y = r.top;
+	if (format & DT_SINGLELINE)
+	{
+		if (format & DT_VCENTER)
+			y = r.top + (r.Height() - height) / 2;
+		else if (format & DT_BOTTOM)
+			y = r.bottom - height;
+	}
+
+	CRect clip(m_clip);
+	if (!(format & DT_NOCLIP))
+	{
+		CRect bounds(r);
+		bounds.NormalizeRect();
+		m_clip.IntersectRect(m_clip, bounds);
+	}
+
+	INT_PTR count = lines.GetSize();
+	for (INT_PTR t = 0; t < count; t++)
+	{
+		int width = GetLineWidth(lines[t]);
+		int x = r.left;
+		if (format & DT_CENTER)
+			x = r.left + (r.Width() - width) / 2;
+		else if (format & DT_RIGHT)
+			x = r.right - width;
+
+		if (m_bkMode == OPAQUE)
+			FillRect(CRect(x, y, x + width, y + height), m_bkColor);
+
+		DrawLine(lines[t], x, y);
+		y += height;
+	}
+
+	m_clip = clip;
+
+}
+
+CSize CDiagramRasterRenderer::GetTextExtent(const CString& text)
+/* ============================================================
+	Function :		CDiagramRasterRenderer::GetTextExtent
+	Description :	Measures a line of text in the current
+					font.
+	Access :		Public
+
+	Return :		CSize				-	Size of the text.
+	Parameters :	const CString& text	-	Text to measure.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	return CSize(GetLineWidth(text), GetLineHeight());
+
+}
+
+void CDiagramRasterRenderer::DrawBitmap(UINT resid, const CRect& rect, CSize source, COLORREF transparent)
+/* ============================================================
+	Function :		CDiagramRasterRenderer::DrawBitmap
+	Description :	Draws a bitmap, stretched to "rect".
+	Access :		Public
+
+	Return :		void
+	Parameters :	UINT resid				-	Bitmap resource.
+					const CRect& rect		-	Where to draw.
+					CSize source			-	Part of the bitmap
+												to draw, from the
+												top left.
+					COLORREF transparent	-	Color not drawn.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	const CImage* image = GetImage(resid);
+	CRect r(rect);
+	r.OffsetRect(-m_origin);
+	if (!image->width || r.Width() <= 0 || r.Height() <= 0)
+		return;
+
+	int width = min(static_cast<int>(source.cx), image->width);
+	int height = min(static_cast<int>(source.cy), image->height);
+
+	CRect draw;
+	if (!draw.IntersectRect(r, m_clip))
+		return;
+
+	BYTE red = GetRValue(transparent);
+	BYTE green = GetGValue(transparent);
+	BYTE blue = GetBValue(transparent);
+	const BYTE* data = image->rgba.GetData();
+	for (int y = draw.top; y < draw.bottom; y++)
+	{
+		int sy = (y - r.top) * height / r.Height();
+		const BYTE* src = data + static_cast<size_t>(sy) * image->width * 4;
+		BYTE* dst = m_pixels + (static_cast<size_t>(y) * m_width) * 4;
+		for (int x = draw.left; x < draw.right; x++)
+		{
+			const BYTE* pixel = src + ((x - r.left) * width / r.Width()) * 4;
+			if (pixel[3] == 0 || (pixel[0] == red && pixel[1] == green && pixel[2] == blue))
+				continue;
+
+			dst[x * 4] = pixel[0];
+			dst[x * 4 + 1] = pixel[1];
+			dst[x * 4 + 2] = pixel[2];
+			dst[x * 4 + 3] = 255;
+		}
+	}
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramRasterRenderer clipping
+
+void CDiagramRasterRenderer::SetClipRect(const CRect& rect)
+/* ============================================================
+	Function :		CDiagramRasterRenderer::SetClipRect
+	Description :	Limits drawing to a rectangle.
+	Access :		Public
+
+	Return :		void
+	Parameters :	const CRect& rect	-	Rectangle to draw in.
+
+	Usage :			Combined with the current clipping, as
+					for a "CDC".
+
+   ============================================================*/
+{
+
+	CRect r(rect);
+	r.NormalizeRect();
+	r.OffsetRect(-m_origin);
+	if (!m_clip.IntersectRect(m_clip, r))
+		m_clip.SetRectEmpty();
+
+}
+
+void CDiagramRasterRenderer::ResetClip()
+/* ============================================================
+	Function :		CDiagramRasterRenderer::ResetClip
+	Description :	Removes the clipping.
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	m_clip.SetRect(0, 0, m_width, m_height);
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramRasterRenderer private helpers, in canvas coordinates
+
+void CDiagramRasterRenderer::Plot(int x, int y, COLORREF color)
+/* ============================================================
+	Function :		CDiagramRasterRenderer::Plot
+	Description :	Sets a pixel, if inside the clipping.
+	Access :		Private
+
+	Return :		void
+	Parameters :	int x			-	Column.
+					int y			-	Row.
+					COLORREF color	-	Color to set.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	if (x < m_clip.left || x >= m_clip.right || y < m_clip.top || y >= m_clip.bottom)
+		return;
+
+	BYTE* pixel = m_pixels + (static_cast<size_t>(y) * m_width + x) * 4;
+	pixel[0] = GetRValue(color);
+	pixel[1] = GetGValue(color);
+	pixel[2] = GetBValue(color);
+	pixel[3] = 255;
+
+}
+
+void CDiagramRasterRenderer::FillSpan(int y, int left, int right, COLORREF color)
+/* ============================================================
+	Function :		CDiagramRasterRenderer::FillSpan
+	Description :	Fills pixels on a row.
+	Access :		Private
+
+	Return :		void
+	Parameters :	int y			-	Row.
+					int left		-	First column.
+					int right		-	Column after the last.
+					COLORREF color	-	Color to fill with.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	if (y < m_clip.top || y >= m_clip.bottom)
+		return;
+
+	left = max(left, m_clip.left);
+	right = min(right, m_clip.right);
+
+	BYTE* pixel = m_pixels + (static_cast<size_t>(y) * m_width + left) * 4;
+	for (int x = left; x < right; x++)
+	{
+		pixel[0] = GetRValue(color);
+		pixel[1] = GetGValue(color);
+		pixel[2] = GetBValue(color);
+		pixel[3] = 255;
+		pixel += 4;
+	}
+
+}
+
+void CDiagramRasterRenderer::FillRect(const CRect& rect, COLORREF color)
+/* ============================================================
+	Function :		CDiagramRasterRenderer::FillRect
+	Description :	Fills a rectangle.
+	Access :		Private
+
+	Return :		void
+	Parameters :	const CRect& rect	-	Rectangle to fill.
+					COLORREF color		-	Color to fill with.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	int top = max(rect.top, m_clip.top);
+	int bottom = min(rect.bottom, m_clip.bottom);
+	for (int y = top; y < bottom; y++)
+		FillSpan(y, rect.left, rect.right, color);
+
+}
+
+void CDiagramRasterRenderer::Stamp(int x, int y)
+/* ============================================================
+	Function :		CDiagramRasterRenderer::Stamp
+	Description :	Draws a point of a line with the pen.
+	Access :		Private
+
+	Return :		void
+	Parameters :	int x	-	Column.
+					int y	-	Row.
+
+	Usage :			Wide pens draw a square centered on the
+					point.
+
+   ============================================================*/
+{
+
+	if (m_penWidth <= 1)
+	{
+		Plot(x, y, m_penColor);
+		return;
+	}
+
+	int half = m_penWidth / 2;
+	FillRect(CRect(x - half, y - half, x - half + m_penWidth, y - half + m_penWidth), m_penColor);
+
+}
+
+void CDiagramRasterRenderer::Stroke(CPoint from, CPoint to)
+/* ============================================================
+	Function :		CDiagramRasterRenderer::Stroke
+	Description :	Draws a line with the pen, without the end
+					point.
+	Access :		Private
+
+	Return :		void
+	Parameters :	CPoint from	-	Start of the line.
+					CPoint to	-	End of the line.
+
+	Usage :			Continues the dash pattern from "m_dash".
+
+   ============================================================*/
+{
+
+	if (m_penStyle == PS_NULL)
+		return;
+
+	int on = 0;
+	int period = 0;
+	if (m_penStyle == PS_DASH)
+	{
+		on = DASH_ON;
+		period = DASH_ON + DASH_OFF;
+	}
+	else if (m_penStyle == PS_DOT)
+	{
+		on = DOT_ON;
+		period = DOT_ON + DOT_OFF;
+	}
+
+	int dx = abs(to.x - from.x);
+	int dy = -abs(to.y - from.y);
+	int sx = from.x < to.x ? 1 : -1;
+	int sy = from.y < to.y ? 1 : -1;
+	int err = dx + dy;
+	int x = from.x;
+	int y = from.y;
+
+	while (x != to.x || y != to.y)
+	{
+		if (!period || m_dash % period < on)
+			Stamp(x, y);
+		m_dash++;
+
+		int e2 = 2 * err;
+		if (e2 >= dy)
+		{
+			err += dy;
+			x += sx;
+		}
+		if (e2 <= dx)
+		{
+			err += dx;
+			y += sy;
+		}
+	}
+
+}
+
+void CDiagramRasterRenderer::Outline(const CPoint* points, int count)
+/* ============================================================
+	Function :		CDiagramRasterRenderer::Outline
+	Description :	Draws a closed outline with the pen.
+	Access :		Private
+
+	Return :		void
+	Parameters :	const CPoint* points	-	Corners.
+					int count				-	Number of corners.
+
+	Usage :			If all corners are the same, a single
+					point is drawn.
+
+   ============================================================*/
+{
+
+	m_dash = 0;
+	BOOL point = TRUE;
+	for (int t = 1; t < count && point; t++)
+		point = (points[t] == points[0]);
+
+	if (point)
+	{
+		if (count && m_penStyle != PS_NULL)
+			Stamp(points[0].x, points[0].y);
+		return;
+	}
+
+	for (int t = 0; t < count; t++)
+		Stroke(points[t], points[(t + 1) % count]);
+
+}
+
+void CDiagramRasterRenderer::RoundedShape(const CRect& rect, double rx, double ry)
+/* ============================================================
+	Function :		CDiagramRasterRenderer::RoundedShape
+	Description :	Draws a filled and outlined rectangle with
+					elliptic corners.
+	Access :		Private
+
+	Return :		void
+	Parameters :	const CRect& rect	-	Normalized rectangle.
+					double rx			-	Horizontal radius of
+											the corners.
+					double ry			-	Vertical radius of
+											the corners.
+
+	Usage :			An ellipse has radii of half the width and
+					height.
+
+   ============================================================*/
+{
+
+	int height = rect.Height();
+	if (height <= 0 || rect.Width() <= 0)
+		return;
+
+	// The outline runs down the left side and up the right side
+	CArray< CPoint, CPoint > outline;
+	outline.SetSize(height * 2);
+
+	for (int y = 0; y < height; y++)
+	{
+		double center = y + 0.5;
+		double dy = 0;
+		if (center < ry)
+			dy = ry - center;
+		else if (center > height - ry)
+			dy = center - (height - ry);
+
+		int inset = 0;
+		if (dy > 0 && ry > 0)
+		{
+			double ratio = dy / ry;
+			inset = static_cast<int>(rx * (1 - sqrt(max(0.0, 1 - ratio * ratio))) + .5);
+		}
+
+		int left = rect.left + inset;
+		int right = max(left, rect.right - 1 - inset);
+		if (m_fill)
+			FillSpan(rect.top + y, left, right + 1, m_brushColor);
+
+		outline[y] = CPoint(left, rect.top + y);
+		outline[height * 2 - 1 - y] = CPoint(right, rect.top + y);
+	}
+
+	Outline(outline.GetData(), height * 2);
+
+}
+
+double CDiagramRasterRenderer::GetCell() const
+/* ============================================================
+	Function :		CDiagramRasterRenderer::GetCell
+	Description :	Gets the size of a font pixel.
+	Access :		Private
+
+	Return :		double	-	Size in canvas pixels.
+	Parameters :	none
+
+	Usage :			A character cell is 6 by 11 font pixels,
+					with the 5x7 glyph two pixels down.
+
+   ============================================================*/
+{
+
+	return static_cast<double>(m_fontHeight) / 10;
+
+}
+
+int CDiagramRasterRenderer::GetLineHeight() const
+/* ============================================================
+	Function :		CDiagramRasterRenderer::GetLineHeight
+	Description :	Gets the height of a line of text.
+	Access :		Private
+
+	Return :		int		-	Height in pixels.
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	return max(static_cast<int>(GetCell() * 11 + .5), 1);
+
+}
+
+int CDiagramRasterRenderer::GetLineWidth(const CString& line) const
+/* ============================================================
+	Function :		CDiagramRasterRenderer::GetLineWidth
+	Description :	Gets the width of a line of text.
+	Access :		Private
+
+	Return :		int					-	Width in pixels.
+	Parameters :	const CString& line	-	Text to measure.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	return static_cast<int>(floor(GetCell() * 6 * line.GetLength()));
+
+}
+
+void CDiagramRasterRenderer::DrawLine(const CString& line, int x, int y)
+/* ============================================================
+	Function :		CDiagramRasterRenderer::DrawLine
+	Description :	Draws a line of text.
+	Access :		Private
+
+	Return :		void
+	Parameters :	const CString& line	-	Text to draw.
+					int x				-	Left of the text.
+					int y				-	Top of the text.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	double advance = GetCell() * 6;
+	int length = line.GetLength();
+	for (int t = 0; t < length; t++)
+	{
+		int left = x + static_cast<int>(floor(advance * t));
+		DrawGlyph(line[t], left, y);
+		if (m_fontWeight >= FW_BOLD)
+			DrawGlyph(line[t], left + 1, y);
+	}
+
+	if (m_fontUnderline && length)
+	{
+		double cell = GetCell();
+		int top = y + static_cast<int>(floor(cell * 10));
+		int bottom = max(top + 1, y + static_cast<int>(floor(cell * 11)));
+		FillRect(CRect(x, top, x + GetLineWidth(line), bottom), m_textColor);
+	}
+
+}
+
+void CDiagramRasterRenderer::DrawGlyph(TCHAR c, int x, int y)
+/* ============================================================
+	Function :		CDiagramRasterRenderer::DrawGlyph
+	Description :	Draws a character.
+	Access :		Private
+
+	Return :		void
+	Parameters :	TCHAR c	-	Character to draw.
+					int x	-	Left of the character cell.
+					int y	-	Top of the character cell.
+
+	Usage :			Italic shifts each row right by a quarter
+					of a font pixel for each row above the
+					baseline.
+
+   ============================================================*/
+{
+
+	int index = static_cast<int>(c) - 32;
+	if (index < 0 || index >= 95)
+		index = _T('?') - 32;
+
+	double cell = GetCell();
+	const BYTE* glyph = font5x7[index];
+	for (int col = 0; col < 5; col++)
+	{
+		int left = x + static_cast<int>(floor(cell * col));
+		int right = max(left + 1, x + static_cast<int>(floor(cell * (col + 1))));
+		for (int row = 0; row < 8; row++)
+		{
+			if (glyph[col] & (1 << row))
+			{
+				int top = y + static_cast<int>(floor(cell * (row + 2)));
+				int bottom = max(top + 1, y + static_cast<int>(floor(cell * (row + 3))));
+				int slant = m_fontItalic ? static_cast<int>(floor(cell * max(6 - row, 0) / 4)) : 0;
+				FillRect(CRect(left + slant, top, right + slant, bottom), m_textColor);
+			}
+		}
+	}
+
+}
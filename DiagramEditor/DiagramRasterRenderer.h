@@ -0,0 +1,114 @@
+#ifndef _CDIAGRAMRASTERRENDERER_H_8D51F3A6_2C97_4B0E_A6F4D90B38E27
+#define _CDIAGRAMRASTERRENDERER_H_8D51F3A6_2C97_4B0E_A6F4D90B38E27
+
+///////////////////////////////////////////////////////////
+// File :		DiagramRasterRenderer.h
+// Created :	10/19/26
+//
+
+#include "DiagramRenderer.h"
+
+// Draws to an RGBA buffer in memory
+class CDiagramRasterRenderer : public CDiagramRenderer
+{
+public:
+	// Construction/destruction
+	CDiagramRasterRenderer();
+	virtual ~CDiagramRasterRenderer();
+
+	// Canvas
+	BOOL			Create(int width, int height, COLORREF background);
+	void			Clear(COLORREF background);
+	void			Reset();
+
+	int				GetWidth() const;
+	int				GetHeight() const;
+	void			SetOrigin(CPoint origin);
+	CPoint			GetOrigin() const;
+
+	const BYTE*		GetRow(int y) const;
+	COLORREF		GetPixel(int x, int y) const;
+
+	// Images
+	void			SetBitmap(UINT resid, int width, int height, const BYTE* rgba);
+
+	// Output
+	BOOL			SavePNG(const CString& filename) const;
+
+	// Overrides
+	virtual void	SetPen(int style, int width, COLORREF color);
+	virtual void	SetBrush(COLORREF color);
+	virtual void	SetNullBrush();
+	virtual void	SetFont(LPCTSTR face, int height, int weight = FW_NORMAL, BOOL italic = FALSE, BOOL underline = FALSE);
+	virtual void	SetTextColor(COLORREF color);
+	virtual void	SetBkColor(COLORREF color);
+	virtual void	SetBkMode(int mode);
+
+	virtual void	Line(CPoint from, CPoint to);
+	virtual void	Polyline(const CPoint* points, int count);
+	virtual void	Polygon(const CPoint* points, int count);
+	virtual void	Rectangle(const CRect& rect);
+	virtual void	RoundRect(const CRect& rect, CPoint corner);
+	virtual void	Ellipse(const CRect& rect);
+
+	virtual void	DrawText(const CString& text, const CRect& rect, UINT format);
+	virtual CSize	GetTextExtent(const CString& text);
+	virtual void	DrawBitmap(UINT resid, const CRect& rect, CSize source, COLORREF transparent);
+
+	virtual void	SetClipRect(const CRect& rect);
+	virtual void	ResetClip();
+
+private:
+	// An image registered with "SetBitmap" or loaded from the resources
+	struct CImage
+	{
+		int			width;
+		int			height;
+		CByteArray	rgba;
+	};
+
+	// Canvas
+	BYTE*		m_pixels;
+	int			m_width;
+	int			m_height;
+	CPoint		m_origin;		// Drawing coordinate of the top left pixel
+	CRect		m_clip;			// In canvas coordinates
+
+	// Drawing state
+	int			m_penStyle;
+	int			m_penWidth;
+	COLORREF	m_penColor;
+	int			m_dash;			// Pixels stepped since the line started, for dashed pens
+	BOOL		m_fill;
+	COLORREF	m_brushColor;
+	int			m_fontHeight;
+	int			m_fontWeight;
+	BOOL		m_fontItalic;
+	BOOL		m_fontUnderline;
+	COLORREF	m_textColor;
+	COLORREF	m_bkColor;
+	int			m_bkMode;
+
+	CMapWordToPtr	m_images;	// "CImage" by resource id
+
+	// Helpers
+	void	Plot(int x, int y, COLORREF color);
+	void	FillSpan(int y, int left, int right, COLORREF color);
+	void	FillRect(const CRect& rect, COLORREF color);
+	void	Stamp(int x, int y);
+	void	Stroke(CPoint from, CPoint to);
+	void	Outline(const CPoint* points, int count);
+	void	RoundedShape(const CRect& rect, double rx, double ry);
+
+	double	GetCell() const;
+	int		GetLineHeight() const;
+	int		GetLineWidth(const CString& line) const;
+	void	DrawLine(const CString& line, int x, int y);
+	void	DrawGlyph(TCHAR c, int x, int y);
+
+	const CImage*	GetImage(UINT resid);
+	void			ClearImages();
+
+};
+
+#endif //_CDIAGRAMRASTERRENDERER_H_8D51F3A6_2C97_4B0E_A6F4D90B38E27
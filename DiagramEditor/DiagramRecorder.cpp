@@ -0,0 +1,808 @@
+/* ==========================================================================
+	File :			DiagramRecorder.cpp
+
+	Class :			CDiagramRecorder
+
+	Date :			10/19/26
+
+	Purpose :		"CDiagramRecorder" holds the mouse and keyboard
+					input sent to a "CDiagramEditor", so that it can be
+					saved as a trace and sent again later to measure
+					how long the editor takes to handle each event.
+
+	Description :	The editor calls "Record" for each input message
+					while a recorder is attached. Mouse coordinates are
+					kept in client coordinates, also for the wheel, and
+					the state of the Shift and Ctrl keys is kept with
+					each event, as the editor reads them with
+					"GetAsyncKeyState".
+
+					"CDiagramEditor::Replay" sends the events again and
+					sets the time spent in the handlers and in painting
+					for each with "SetLatency". "GetReport" gives the
+					percentiles of these times for each kind of event.
+
+					A trace is a text file with a line
+					"trace:zoom,x,y,width,height;" with the state of the
+					editor when the recording started, followed by one
+					line "event:time,message,wparam,lparam,keys;" for
+					each event.
+
+	Usage :			Attach with "CDiagramEditor::SetRecorder", and save
+					the trace with "Save". Load it with "Load" and pass
+					it to "CDiagramEditor::Replay" with the same
+					document open.
+
+   ========================================================================*/
+
+#include "stdafx.h"
+#include "DiagramRecorder.h"
+#include "Tokenizer.h"
+#include <math.h>
+
+#ifdef _DEBUG
+#define new DEBUG_NEW
+#undef THIS_FILE
+static char THIS_FILE[] = __FILE__;
+#endif
+
+// Messages that can be recorded, and their names in the trace.
+// Double clicks and the right and middle buttons are left out, as
+// they open dialogs and menus or start timers, which would stop a
+// replay.
+static const struct
+{
+	UINT	message;
+	LPCTSTR	name;
+} recordMessages[] = {
+	{ WM_LBUTTONDOWN, _T("lbuttondown") },
+	{ WM_LBUTTONUP, _T("lbuttonup") },
+	{ WM_MOUSEMOVE, _T("mousemove") },
+	{ WM_MOUSEWHEEL, _T("mousewheel") },
+	{ WM_KEYDOWN, _T("keydown") }
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramRecorder construction/destruction
+
+CDiagramRecorder::CDiagramRecorder()
+/* ============================================================
+	Function :		CDiagramRecorder::CDiagramRecorder
+	Description :	Constructor
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	Clear();
+
+}
+
+CDiagramRecorder::~CDiagramRecorder()
+/* ============================================================
+	Function :		CDiagramRecorder::~CDiagramRecorder
+	Description :	Destructor
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramRecorder recording
+
+void CDiagramRecorder::Start(double zoom, CPoint scroll, CSize client)
+/* ============================================================
+	Function :		CDiagramRecorder::Start
+	Description :	Starts a new recording.
+	Access :		Public
+
+	Return :		void
+	Parameters :	double zoom		-	Zoom of the editor.
+					CPoint scroll	-	Scroll position of the
+										editor.
+					CSize client	-	Client size of the editor.
+
+	Usage :			Called by "CDiagramEditor::SetRecorder".
+					Replays start from this state.
+
+   ============================================================*/
+{
+
+	m_events.RemoveAll();
+	m_recording = TRUE;
+	m_start = ::GetTickCount();
+	m_zoom = zoom;
+	m_scroll = scroll;
+	m_client = client;
+
+}
+
+void CDiagramRecorder::Record(UINT message, WPARAM wParam, LPARAM lParam, UINT keys)
+/* ============================================================
+	Function :		CDiagramRecorder::Record
+	Description :	Adds an event to the recording.
+	Access :		Public
+
+	Return :		void
+	Parameters :	UINT message	-	Input message.
+					WPARAM wParam	-	Message parameter.
+					LPARAM lParam	-	Message parameter, with
+										client coordinates for
+										"WM_MOUSEWHEEL".
+					UINT keys		-	"RECORD_KEY_SHIFT" and
+										"RECORD_KEY_CONTROL" if
+										down.
+
+	Usage :			Called by the editor for each input
+					message while recording.
+
+   ============================================================*/
+{
+
+	if (!m_recording)
+		return;
+
+	CInputEvent ev;
+	ev.time = ::GetTickCount() - m_start;
+	ev.message = message;
+	ev.wParam = wParam;
+	ev.lParam = lParam;
+	ev.keys = keys;
+	ev.model = 0.0;
+	ev.paint = 0.0;
+	m_events.Add(ev);
+
+}
+
+void CDiagramRecorder::Clear()
+/* ============================================================
+	Function :		CDiagramRecorder::Clear
+	Description :	Removes all events, and stops recording.
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Call to reuse the recorder.
+
+   ============================================================*/
+{
+
+	m_events.RemoveAll();
+	m_recording = FALSE;
+	m_start = 0;
+	m_zoom = 1.0;
+	m_scroll = CPoint(0, 0);
+	m_client = CSize(0, 0);
+
+}
+
+BOOL CDiagramRecorder::IsRecording() const
+/* ============================================================
+	Function :		CDiagramRecorder::IsRecording
+	Description :	Checks if events are recorded.
+	Access :		Public
+
+	Return :		BOOL	-	"TRUE" after "Start".
+	Parameters :	none
+
+	Usage :			Loaded traces are not recording.
+
+   ============================================================*/
+{
+
+	return m_recording;
+
+}
+
+BOOL CDiagramRecorder::IsInputMessage(UINT message)
+/* ============================================================
+	Function :		CDiagramRecorder::IsInputMessage
+	Description :	Checks if a message is recorded.
+	Access :		Public
+
+	Return :		BOOL			-	"TRUE" if recorded.
+	Parameters :	UINT message	-	Message to check.
+
+	Usage :			Called by the editor for every message.
+
+   ============================================================*/
+{
+
+	return GetMessageName(message) != NULL;
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramRecorder events
+
+INT_PTR CDiagramRecorder::GetSize() const
+/* ============================================================
+	Function :		CDiagramRecorder::GetSize
+	Description :	Gets the number of events.
+	Access :		Public
+
+	Return :		INT_PTR	-	Number of events.
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	return m_events.GetSize();
+
+}
+
+UINT CDiagramRecorder::GetEventMessage(INT_PTR index) const
+/* ============================================================
+	Function :		CDiagramRecorder::GetEventMessage
+	Description :	Gets the message of an event.
+	Access :		Public
+
+	Return :		UINT			-	The message.
+	Parameters :	INT_PTR index	-	Index of the event.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	return m_events[index].message;
+
+}
+
+WPARAM CDiagramRecorder::GetWParam(INT_PTR index) const
+/* ============================================================
+	Function :		CDiagramRecorder::GetWParam
+	Description :	Gets the "WPARAM" of an event.
+	Access :		Public
+
+	Return :		WPARAM			-	The parameter.
+	Parameters :	INT_PTR index	-	Index of the event.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	return m_events[index].wParam;
+
+}
+
+LPARAM CDiagramRecorder::GetLParam(INT_PTR index) const
+/* ============================================================
+	Function :		CDiagramRecorder::GetLParam
+	Description :	Gets the "LPARAM" of an event.
+	Access :		Public
+
+	Return :		LPARAM			-	The parameter.
+	Parameters :	INT_PTR index	-	Index of the event.
+
+	Usage :			Coordinates are client coordinates, also
+					for "WM_MOUSEWHEEL".
+
+   ============================================================*/
+{
+
+	return m_events[index].lParam;
+
+}
+
+UINT CDiagramRecorder::GetKeys(INT_PTR index) const
+/* ============================================================
+	Function :		CDiagramRecorder::GetKeys
+	Description :	Gets the modifier keys down at an event.
+	Access :		Public
+
+	Return :		UINT			-	"RECORD_KEY_" flags.
+	Parameters :	INT_PTR index	-	Index of the event.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	return m_events[index].keys;
+
+}
+
+double CDiagramRecorder::GetZoom() const
+/* ============================================================
+	Function :		CDiagramRecorder::GetZoom
+	Description :	Gets the zoom when recording started.
+	Access :		Public
+
+	Return :		double	-	The zoom.
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	return m_zoom;
+
+}
+
+CPoint CDiagramRecorder::GetScroll() const
+/* ============================================================
+	Function :		CDiagramRecorder::GetScroll
+	Description :	Gets the scroll position when recording
+					started.
+	Access :		Public
+
+	Return :		CPoint	-	The position.
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	return m_scroll;
+
+}
+
+CSize CDiagramRecorder::GetClientSize() const
+/* ============================================================
+	Function :		CDiagramRecorder::GetClientSize
+	Description :	Gets the client size of the editor when
+					recording started.
+	Access :		Public
+
+	Return :		CSize	-	The size.
+	Parameters :	none
+
+	Usage :			Paint times depend on the size, so compare
+					replays with the same size.
+
+   ============================================================*/
+{
+
+	return m_client;
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramRecorder replay results
+
+void CDiagramRecorder::ClearLatencies()
+/* ============================================================
+	Function :		CDiagramRecorder::ClearLatencies
+	Description :	Clears the times of a replay.
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Called before a replay.
+
+   ============================================================*/
+{
+
+	INT_PTR max = m_events.GetSize();
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		m_events[t].model = 0.0;
+		m_events[t].paint = 0.0;
+	}
+
+}
+
+void CDiagramRecorder::SetLatency(INT_PTR index, double model, double paint)
+/* ============================================================
+	Function :		CDiagramRecorder::SetLatency
+	Description :	Sets the times of an event in a replay.
+	Access :		Public
+
+	Return :		void
+	Parameters :	INT_PTR index	-	Index of the event.
+					double model	-	Microseconds in the
+										handler, not painting.
+					double paint	-	Microseconds painting.
+
+	Usage :			Called by "CDiagramEditor::Replay".
+
+   ============================================================*/
+{
+
+	m_events[index].model = model;
+	m_events[index].paint = paint;
+
+}
+
+void CDiagramRecorder::GetReport(CStringArray& stra) const
+/* ============================================================
+	Function :		CDiagramRecorder::GetReport
+	Description :	Gets the percentiles of the replay times.
+	Access :		Public
+
+	Return :		void
+	Parameters :	CStringArray& stra	-	Gets the report.
+
+	Usage :			Call after a replay. The report is
+					comma-separated, with a header line and a
+					line for each kind of event, followed by
+					one for all events. Times are in
+					microseconds.
+
+   ============================================================*/
+{
+
+	stra.RemoveAll();
+	stra.Add(_T("event,count,model_p50_us,model_p90_us,model_p99_us,paint_p50_us,paint_p90_us,paint_p99_us,total_p50_us,total_p90_us,total_p99_us,total_max_us"));
+
+	for (int t = 0; t < _countof(recordMessages); t++)
+		AddReportLine(stra, recordMessages[t].name, recordMessages[t].message);
+
+	AddReportLine(stra, _T("all"), 0);
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramRecorder timing
+
+LONGLONG CDiagramRecorder::GetCounter()
+/* ============================================================
+	Function :		CDiagramRecorder::GetCounter
+	Description :	Gets the performance counter.
+	Access :		Public
+
+	Return :		LONGLONG	-	The counter.
+	Parameters :	none
+
+	Usage :			Use "GetMicroseconds" on the difference
+					between two counters.
+
+   ============================================================*/
+{
+
+	LARGE_INTEGER counter;
+	::QueryPerformanceCounter(&counter);
+	return counter.QuadPart;
+
+}
+
+double CDiagramRecorder::GetMicroseconds(LONGLONG counter)
+/* ============================================================
+	Function :		CDiagramRecorder::GetMicroseconds
+	Description :	Converts counter ticks to microseconds.
+	Access :		Public
+
+	Return :		double				-	Microseconds.
+	Parameters :	LONGLONG counter	-	Ticks from
+											"GetCounter".
+
+	Usage :
+
+   ============================================================*/
+{
+
+	LARGE_INTEGER frequency;
+	::QueryPerformanceFrequency(&frequency);
+	return static_cast<double>(counter) * 1000000.0 / static_cast<double>(frequency.QuadPart);
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramRecorder I/O
+
+BOOL CDiagramRecorder::Save(const CString& filename) const
+/* ============================================================
+	Function :		CDiagramRecorder::Save
+	Description :	Saves the events as a trace.
+	Access :		Public
+
+	Return :		BOOL					-	"FALSE" if the
+												file could not
+												be written.
+	Parameters :	const CString& filename	-	File to save to.
+
+	Usage :			Call when the recording is done.
+
+   ============================================================*/
+{
+
+	BOOL result = FALSE;
+	TRY
+	{
+		CStdioFile file(filename, CFile::modeCreate | CFile::modeWrite | CFile::typeText);
+
+		CString str;
+		str.Format(_T("trace:%f,%i,%i,%i,%i;\n"), m_zoom, m_scroll.x, m_scroll.y, m_client.cx, m_client.cy);
+		file.WriteString(str);
+
+		INT_PTR max = m_events.GetSize();
+		for (INT_PTR t = 0; t < max; t++)
+		{
+			const CInputEvent& ev = m_events[t];
+			str.Format(_T("event:%u,%s,%Iu,%Id,%u;\n"), ev.time, GetMessageName(ev.message), ev.wParam, ev.lParam, ev.keys);
+			file.WriteString(str);
+		}
+
+		file.Close();
+		result = TRUE;
+	}
+	CATCH_ALL(e)
+	{
+		result = FALSE;
+	}
+	END_CATCH_ALL
+
+	return result;
+
+}
+
+BOOL CDiagramRecorder::Load(const CString& filename)
+/* ============================================================
+	Function :		CDiagramRecorder::Load
+	Description :	Loads a trace.
+	Access :		Public
+
+	Return :		BOOL					-	"FALSE" if the
+												file could not
+												be read.
+	Parameters :	const CString& filename	-	File to load.
+
+	Usage :			Lines that are not events are skipped.
+
+   ============================================================*/
+{
+
+	Clear();
+
+	BOOL result = FALSE;
+	TRY
+	{
+		CStdioFile file(filename, CFile::modeRead | CFile::typeText);
+		CString str;
+		while (file.ReadString(str))
+		{
+			CTokenizer main(str, _T(":"));
+			if (main.GetSize() != 2)
+				continue;
+
+			CString header;
+			CString data;
+			main.GetAt(0, header);
+			main.GetAt(1, data);
+			header.TrimLeft();
+			header.TrimRight();
+			data.TrimLeft();
+			data.TrimRight();
+			if (data.Right(1) == _T(";"))
+				data = data.Left(data.GetLength() - 1);
+
+			CTokenizer tok(data);
+			if (header == _T("trace") && tok.GetSize() == 5)
+			{
+				double zoom;
+				int x;
+				int y;
+				int cx;
+				int cy;
+				tok.GetAt(0, zoom);
+				tok.GetAt(1, x);
+				tok.GetAt(2, y);
+				tok.GetAt(3, cx);
+				tok.GetAt(4, cy);
+				m_zoom = zoom;
+				m_scroll = CPoint(x, y);
+				m_client = CSize(cx, cy);
+			}
+			else if (header == _T("event") && tok.GetSize() == 5)
+			{
+				CString time;
+				CString name;
+				CString wParam;
+				CString lParam;
+				CString keys;
+				tok.GetAt(0, time);
+				tok.GetAt(1, name);
+				tok.GetAt(2, wParam);
+				tok.GetAt(3, lParam);
+				tok.GetAt(4, keys);
+
+				CInputEvent ev;
+				ev.time = _tcstoul(time, NULL, 10);
+				ev.message = GetMessageFromName(name);
+				ev.wParam = static_cast<WPARAM>(_tcstoui64(wParam, NULL, 10));
+				ev.lParam = static_cast<LPARAM>(_tcstoi64(lParam, NULL, 10));
+				ev.keys = _tcstoul(keys, NULL, 10);
+				ev.model = 0.0;
+				ev.paint = 0.0;
+				if (ev.message)
+					m_events.Add(ev);
+			}
+		}
+
+		file.Close();
+		result = TRUE;
+	}
+	CATCH_ALL(e)
+	{
+		Clear();
+		result = FALSE;
+	}
+	END_CATCH_ALL
+
+	return result;
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramRecorder private helpers
+
+void CDiagramRecorder::AddReportLine(CStringArray& stra, LPCTSTR name, UINT message) const
+/* ============================================================
+	Function :		CDiagramRecorder::AddReportLine
+	Description :	Adds the percentiles of one kind of event
+					to a report.
+	Access :		Private
+
+	Return :		void
+	Parameters :	CStringArray& stra	-	Report to add to.
+					LPCTSTR name		-	Name of the line.
+					UINT message		-	Message, 0 for all.
+
+	Usage :			Nothing is added if there are no such
+					events.
+
+   ============================================================*/
+{
+
+	CArray< double, double > model;
+	CArray< double, double > paint;
+	CArray< double, double > total;
+
+	INT_PTR max = m_events.GetSize();
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		const CInputEvent& ev = m_events[t];
+		if (message == 0 || ev.message == message)
+		{
+			model.Add(ev.model);
+			paint.Add(ev.paint);
+			total.Add(ev.model + ev.paint);
+		}
+	}
+
+	INT_PTR count = total.GetSize();
+	if (count == 0)
+		return;
+
+	qsort(model.GetData(), count, sizeof(double), CompareDouble);
+	qsort(paint.GetData(), count, sizeof(double), CompareDouble);
+	qsort(total.GetData(), count, sizeof(double), CompareDouble);
+
+	CString str;
+	str.Format(_T("%s,%Id,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f"),
+		name,
+		count,
+		GetPercentile(model, 50.0),
+		GetPercentile(model, 90.0),
+		GetPercentile(model, 99.0),
+		GetPercentile(paint, 50.0),
+		GetPercentile(paint, 90.0),
+		GetPercentile(paint, 99.0),
+		GetPercentile(total, 50.0),
+		GetPercentile(total, 90.0),
+		GetPercentile(total, 99.0),
+		total[count - 1]);
+	stra.Add(str);
+
+}
+
+LPCTSTR CDiagramRecorder::GetMessageName(UINT message)
+/* ============================================================
+	Function :		CDiagramRecorder::GetMessageName
+	Description :	Gets the name of a message in a trace.
+	Access :		Private
+
+	Return :		LPCTSTR			-	The name, "NULL" if the
+										message is not recorded.
+	Parameters :	UINT message	-	The message.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	for (int t = 0; t < _countof(recordMessages); t++)
+		if (recordMessages[t].message == message)
+			return recordMessages[t].name;
+
+	return NULL;
+
+}
+
+UINT CDiagramRecorder::GetMessageFromName(const CString& name)
+/* ============================================================
+	Function :		CDiagramRecorder::GetMessageFromName
+	Description :	Gets a message from its name in a trace.
+	Access :		Private
+
+	Return :		UINT				-	The message, 0 if
+											unknown.
+	Parameters :	const CString& name	-	The name.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	for (int t = 0; t < _countof(recordMessages); t++)
+		if (name == recordMessages[t].name)
+			return recordMessages[t].message;
+
+	return 0;
+
+}
+
+double CDiagramRecorder::GetPercentile(const CArray< double, double >& sorted, double percentile)
+/* ============================================================
+	Function :		CDiagramRecorder::GetPercentile
+	Description :	Gets a percentile of sorted values.
+	Access :		Private
+
+	Return :		double			-	The value.
+	Parameters :	const CArray< double, double >& sorted	-
+										Values, in ascending
+										order.
+					double percentile	-	0 to 100.
+
+	Usage :			Uses the nearest rank.
+
+   ============================================================*/
+{
+
+	INT_PTR count = sorted.GetSize();
+	if (count == 0)
+		return 0.0;
+
+	INT_PTR rank = static_cast<INT_PTR>(ceil(percentile / 100.0 * count)) - 1;
+	if (rank < 0)
+		rank = 0;
+	if (rank >= count)
+		rank = count - 1;
+
+	return sorted[rank];
+
+}
+
+int CDiagramRecorder::CompareDouble(const void* first, const void* second)
+/* ============================================================
+	Function :		CDiagramRecorder::CompareDouble
+	Description :	Compares two doubles for "qsort".
+	Access :		Private
+
+	Return :		int					-	Sort order.
+	Parameters :	const void* first	-	First value.
+					const void* second	-	Second value.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	double a = *static_cast<const double*>(first);
+	double b = *static_cast<const double*>(second);
+	if (a < b)
+		return -1;
+	if (a > b)
+		return 1;
+	return 0;
+
+}
@@ -0,0 +1,83 @@
+#ifndef _CDIAGRAMRECORDER_H_5D2E8B41_9C7A_4F36_B1E0D84A62C97
+#define _CDIAGRAMRECORDER_H_5D2E8B41_9C7A_4F36_B1E0D84A62C97
+
+///////////////////////////////////////////////////////////
+// File :		DiagramRecorder.h
+// Created :	10/19/26
+//
+
+#include <afxtempl.h>
+
+// Modifier keys down at an event
+#define RECORD_KEY_SHIFT	1
+#define RECORD_KEY_CONTROL	2
+
+class CDiagramRecorder
+{
+public:
+	// Construction/destruction
+	CDiagramRecorder();
+	virtual ~CDiagramRecorder();
+
+	// Recording
+	void		Start(double zoom, CPoint scroll, CSize client);
+	void		Record(UINT message, WPARAM wParam, LPARAM lParam, UINT keys);
+	void		Clear();
+	BOOL		IsRecording() const;
+
+	static BOOL	IsInputMessage(UINT message);
+
+	// Events
+	INT_PTR		GetSize() const;
+	UINT		GetEventMessage(INT_PTR index) const;
+	WPARAM		GetWParam(INT_PTR index) const;
+	LPARAM		GetLParam(INT_PTR index) const;
+	UINT		GetKeys(INT_PTR index) const;
+	double		GetZoom() const;
+	CPoint		GetScroll() const;
+	CSize		GetClientSize() const;
+
+	// Replay results
+	void		ClearLatencies();
+	void		SetLatency(INT_PTR index, double model, double paint);
+	void		GetReport(CStringArray& stra) const;
+
+	// Timing
+	static LONGLONG	GetCounter();
+	static double	GetMicroseconds(LONGLONG counter);
+
+	// I/O
+	BOOL		Save(const CString& filename) const;
+	BOOL		Load(const CString& filename);
+
+private:
+	// An input message sent to the editor
+	struct CInputEvent
+	{
+		DWORD	time;		// Milliseconds since the recording started
+		UINT	message;
+		WPARAM	wParam;
+		LPARAM	lParam;		// Client coordinates, also for the wheel
+		UINT	keys;		// "RECORD_KEY_" flags
+		double	model;		// Replay time spent in the handler, in microseconds
+		double	paint;		// Replay time spent painting, in microseconds
+	};
+
+	CArray< CInputEvent, CInputEvent& >	m_events;
+	BOOL		m_recording;	// TRUE between "Start" and "Clear"
+	DWORD		m_start;		// Tick count at "Start"
+	double		m_zoom;			// Editor state at "Start"
+	CPoint		m_scroll;
+	CSize		m_client;
+
+	// Helpers
+	void		AddReportLine(CStringArray& stra, LPCTSTR name, UINT message) const;
+
+	static LPCTSTR	GetMessageName(UINT message);
+	static UINT		GetMessageFromName(const CString& name);
+	static double	GetPercentile(const CArray< double, double >& sorted, double percentile);
+	static int		CompareDouble(const void* first, const void* second);
+
+};
+
+#endif //_CDIAGRAMRECORDER_H_5D2E8B41_9C7A_4F36_B1E0D84A62C97
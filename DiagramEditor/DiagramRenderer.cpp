@@ -0,0 +1,190 @@
+/* ==========================================================================
+	File :			DiagramRenderer.cpp
+
+	Class :			CDiagramRenderer
+
+	Date :			10/19/26
+
+	Purpose :		"CDiagramRenderer" is the set of drawing operations
+					entities use in "Render" - lines, polylines,
+					polygons, rectangles, ellipses, text, bitmaps and
+					clipping, with the pen, brush and font to use.
+					This file has the helpers shared by the renderers
+					that do not draw to a "CDC".
+
+	Description :	"BreakLines" splits text as "DrawText" would, and
+					"LoadBitmapRGBA" gets the pixels of a bitmap
+					resource.
+
+					"CDiagramGDIRenderer" is in "DiagramGDIRenderer.cpp",
+					so that the other renderers can be built without
+					windows.
+
+	Usage :			Derive renderers from "CDiagramRenderer".
+
+   ========================================================================*/
+
+#include "stdafx.h"
+#include "DiagramRenderer.h"
+
+#ifdef _DEBUG
+#define new DEBUG_NEW
+#undef THIS_FILE
+static char THIS_FILE[] = __FILE__;
+#endif
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramRenderer helpers
+
+void CDiagramRenderer::BreakLines(const CString& text, int width, UINT format, CStringArray& lines)
+/* ============================================================
+	Function :		CDiagramRenderer::BreakLines
+	Description :	Splits text into the lines "DrawText"
+					draws.
+	Access :		Protected
+
+	Return :		void
+	Parameters :	const CString& text		-	Text to split.
+					int width				-	Width of the
+												rectangle.
+					UINT format				-	"DT_"-flags.
+					CStringArray& lines		-	Gets the lines.
+
+	Usage :			For renderers laying out text themselves.
+					"DT_SINGLELINE" gives one line. Otherwise
+					the text is split at line breaks, and with
+					"DT_WORDBREAK" at spaces to fit "width",
+					measured with "GetTextExtent". Long words
+					get a line of their own.
+
+   ============================================================*/
+{
+
+	lines.RemoveAll();
+
+	CString str(text);
+	str.Remove(_T('\r'));
+	if (format & DT_SINGLELINE)
+	{
+		str.Replace(_T('\n'), _T(' '));
+		lines.Add(str);
+		return;
+	}
+
+	int start = 0;
+	while (start <= str.GetLength())
+	{
+		int end = str.Find(_T('\n'), start);
+		if (end == -1)
+			end = str.GetLength();
+
+		CString paragraph = str.Mid(start, end - start);
+		if ((format & DT_WORDBREAK) && GetTextExtent(paragraph).cx > width)
+		{
+			CString line;
+			int pos = 0;
+			while (pos < paragraph.GetLength())
+			{
+				int space = paragraph.Find(_T(' '), pos);
+				if (space == -1)
+					space = paragraph.GetLength();
+
+				CString word = paragraph.Mid(pos, space - pos);
+				CString test = line.GetLength() ? line + _T(" ") + word : word;
+				if (line.GetLength() && GetTextExtent(test).cx > width)
+				{
+					lines.Add(line);
+					line = word;
+				}
+				else
+					line = test;
+
+				pos = space + 1;
+			}
+
+			lines.Add(line);
+		}
+		else
+			lines.Add(paragraph);
+
+		start = end + 1;
+	}
+
+}
+
+BOOL CDiagramRenderer::LoadBitmapRGBA(UINT resid, int& width, int& height, CByteArray& rgba)
+/* ============================================================
+	Function :		CDiagramRenderer::LoadBitmapRGBA
+	Description :	Loads the pixels of a bitmap resource.
+	Access :		Protected
+
+	Return :		BOOL				-	"FALSE" if the
+											resource could not
+											be loaded.
+	Parameters :	UINT resid			-	Resource id.
+					int& width			-	Gets the width.
+					int& height			-	Gets the height.
+					CByteArray& rgba	-	Gets the pixels, top
+											row first, four bytes
+											each.
+
+	Usage :			For renderers drawing bitmaps themselves.
+					Pixels are opaque, as 24-bit bitmaps have
+					no alpha.
+
+   ============================================================*/
+{
+
+	width = 0;
+	height = 0;
+	rgba.RemoveAll();
+
+	HBITMAP hbitmap = (HBITMAP)::LoadImage(AfxGetResourceHandle(),
+		MAKEINTRESOURCE(resid),
+		IMAGE_BITMAP,
+		0, 0,
+		LR_CREATEDIBSECTION
+	);
+
+	if (!hbitmap)
+		return FALSE;
+
+	BITMAP bm;
+	::GetObject(hbitmap, sizeof(bm), &bm);
+
+	BITMAPINFO info;
+	memset(&info, 0, sizeof(info));
+	info.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+	info.bmiHeader.biWidth = bm.bmWidth;
+	info.bmiHeader.biHeight = -bm.bmHeight;
+	info.bmiHeader.biPlanes = 1;
+	info.bmiHeader.biBitCount = 32;
+	info.bmiHeader.biCompression = BI_RGB;
+
+	rgba.SetSize(bm.bmWidth * bm.bmHeight * 4);
+	HDC hdc = ::CreateCompatibleDC(NULL);
+	if (::GetDIBits(hdc, hbitmap, 0, bm.bmHeight, rgba.GetData(), &info, DIB_RGB_COLORS))
+	{
+		// BGRA to RGBA
+		BYTE* data = rgba.GetData();
+		INT_PTR size = rgba.GetSize();
+		for (INT_PTR t = 0; t < size; t += 4)
+		{
+			BYTE blue = data[t];
+			data[t] = data[t + 2];
+			data[t + 2] = blue;
+			data[t + 3] = 255;
+		}
+
+		width = bm.bmWidth;
+		height = bm.bmHeight;
+	}
+	else
+		rgba.RemoveAll();
+
+	::DeleteDC(hdc);
+	::DeleteObject(hbitmap);
+
+	return width > 0;
+
+}
@@ -0,0 +1,52 @@
+#ifndef _CDIAGRAMRENDERER_H_1F7C3B90_5E2A_4D86_B49C03A7E6F15
+#define _CDIAGRAMRENDERER_H_1F7C3B90_5E2A_4D86_B49C03A7E6F15
+
+///////////////////////////////////////////////////////////
+// File :		DiagramRenderer.h
+// Created :	10/19/26
+//
+
+// Drawing operations used by entities, so that they can be
+// drawn to a "CDC" or to a memory buffer.
+class CDiagramRenderer
+{
+public:
+	virtual ~CDiagramRenderer() {}
+
+	// Pens, brushes and fonts
+	virtual void	SetPen(int style, int width, COLORREF color) = 0;
+	virtual void	SetBrush(COLORREF color) = 0;
+	virtual void	SetNullBrush() = 0;
+	virtual void	SetFont(LPCTSTR face, int height, int weight = FW_NORMAL, BOOL italic = FALSE, BOOL underline = FALSE) = 0;
+	virtual void	SetTextColor(COLORREF color) = 0;
+	virtual void	SetBkColor(COLORREF color) = 0;
+	virtual void	SetBkMode(int mode) = 0;
+
+	// Shapes
+	virtual void	Line(CPoint from, CPoint to) = 0;
+	virtual void	Polyline(const CPoint* points, int count) = 0;
+	virtual void	Polygon(const CPoint* points, int count) = 0;
+	virtual void	Rectangle(const CRect& rect) = 0;
+	virtual void	RoundRect(const CRect& rect, CPoint corner) = 0;
+	virtual void	Ellipse(const CRect& rect) = 0;
+
+	// Text and images
+	virtual void	DrawText(const CString& text, const CRect& rect, UINT format) = 0;
+	virtual CSize	GetTextExtent(const CString& text) = 0;
+	virtual void	DrawBitmap(UINT resid, const CRect& rect, CSize source, COLORREF transparent) = 0;
+
+	// Clipping
+	virtual void	SetClipRect(const CRect& rect) = 0;
+	virtual void	ResetClip() = 0;
+
+	// Attributes
+	virtual CDC*	GetDC() const { return NULL; }	// "NULL" if not drawing to a "CDC"
+
+protected:
+	// Helpers for renderers without GDI
+	void			BreakLines(const CString& text, int width, UINT format, CStringArray& lines);
+	static BOOL		LoadBitmapRGBA(UINT resid, int& width, int& height, CByteArray& rgba);
+
+};
+
+#endif //_CDIAGRAMRENDERER_H_1F7C3B90_5E2A_4D86_B49C03A7E6F15
@@ -0,0 +1,743 @@
+/* ==========================================================================
+	File :			DiagramSVGRenderer.cpp
+
+	Class :			CDiagramSVGRenderer
+
+	Date :			10/19/26
+
+	Purpose :		"CDiagramSVGRenderer" writes what entities draw as
+					an SVG file, streamed to disk as it is drawn.
+
+	Description :	Each combination of pen, brush and font is written
+					once, as a CSS class in a "style" element just
+					before it is first used, and shapes refer to the
+					class. Small polygons and polylines, such as the
+					arrowheads and diamonds at the ends of links, are
+					written once as a path in "defs" and placed with
+					"use" after that. Bitmaps are written once as PNG
+					data, with the transparent color made transparent.
+
+					Only these tables are kept, so the memory used
+					depends on the number of different styles and
+					markers in the diagram, not on the number of
+					objects.
+
+					The drawing is moved half a pixel, so that one
+					pixel lines cover the same pixels as in the
+					editor.
+
+	Usage :			Call "Open" with the file and the area of the
+					diagram to write, render the objects, and call
+					"Close".
+
+   ========================================================================*/
+
+#include "stdafx.h"
+#include "DiagramSVGRenderer.h"
+#include "PNGWriter.h"
+
+#ifdef _DEBUG
+#define new DEBUG_NEW
+#undef THIS_FILE
+static char THIS_FILE[] = __FILE__;
+#endif
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramSVGRenderer construction/destruction
+
+CDiagramSVGRenderer::CDiagramSVGRenderer()
+/* ============================================================
+	Function :		CDiagramSVGRenderer::CDiagramSVGRenderer
+	Description :	Constructor
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	m_clips = 0;
+	m_clipped = FALSE;
+
+}
+
+CDiagramSVGRenderer::~CDiagramSVGRenderer()
+/* ============================================================
+	Function :		CDiagramSVGRenderer::~CDiagramSVGRenderer
+	Description :	Destructor
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Closes the file if it is open.
+
+   ============================================================*/
+{
+
+	if (IsOpen())
+		Close();
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramSVGRenderer operations
+
+BOOL CDiagramSVGRenderer::Open(const CString& filename, const CRect& area, COLORREF background)
+/* ============================================================
+	Function :		CDiagramSVGRenderer::Open
+	Description :	Creates the file and writes the start of
+					the document.
+	Access :		Public
+
+	Return :		BOOL					-	"TRUE" if the file
+												was created.
+	Parameters :	const CString& filename	-	File to create.
+					const CRect& area		-	Area of the drawing
+												the document shows.
+					COLORREF background		-	Color behind the
+												drawing.
+
+	Usage :			Render, then call "Close".
+
+   ============================================================*/
+{
+
+	if (!OpenFile(filename))
+		return FALSE;
+
+	m_styles.RemoveAll();
+	m_markers.RemoveAll();
+	m_images.RemoveAll();
+	m_clips = 0;
+	m_clipped = FALSE;
+
+	Write("<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"no\"?>\n");
+	WriteFormat("<svg xmlns=\"http://www.w3.org/2000/svg\" xmlns:xlink=\"http://www.w3.org/1999/xlink\" version=\"1.1\" xml:space=\"preserve\" width=\"%d\" height=\"%d\" viewBox=\"%d %d %d %d\">\n",
+		area.Width(), area.Height(), area.left, area.top, area.Width(), area.Height());
+	WriteFormat("<rect x=\"%d\" y=\"%d\" width=\"%d\" height=\"%d\" fill=\"",
+		area.left, area.top, area.Width(), area.Height());
+	WriteString(GetColor(background));
+	Write("\"/>\n<g transform=\"translate(.5,.5)\">\n");
+
+	return TRUE;
+
+}
+
+BOOL CDiagramSVGRenderer::Close()
+/* ============================================================
+	Function :		CDiagramSVGRenderer::Close
+	Description :	Ends the document and closes the file.
+	Access :		Public
+
+	Return :		BOOL	-	"FALSE" if the file could not
+								be written.
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	if (!IsOpen())
+		return FALSE;
+
+	ResetClip();
+	Write("</g>\n</svg>\n");
+
+	return CloseFile();
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramSVGRenderer attributes
+
+int CDiagramSVGRenderer::GetStyleCount() const
+/* ============================================================
+	Function :		CDiagramSVGRenderer::GetStyleCount
+	Description :	Gets the number of styles written.
+	Access :		Public
+
+	Return :		int		-	Number of CSS classes.
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	return static_cast<int>(m_styles.GetCount());
+
+}
+
+int CDiagramSVGRenderer::GetMarkerCount() const
+/* ============================================================
+	Function :		CDiagramSVGRenderer::GetMarkerCount
+	Description :	Gets the number of reused shapes written.
+	Access :		Public
+
+	Return :		int		-	Number of paths in "defs".
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	return static_cast<int>(m_markers.GetCount());
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramSVGRenderer overrides
+
+void CDiagramSVGRenderer::Line(CPoint from, CPoint to)
+/* ============================================================
+	Function :		CDiagramSVGRenderer::Line
+	Description :	Draws a line with the pen.
+	Access :		Public
+
+	Return :		void
+	Parameters :	CPoint from	-	Start of the line.
+					CPoint to	-	End of the line.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	if (m_penStyle == PS_NULL)
+		return;
+
+	int style = GetStyle(FALSE, TRUE);
+	WriteFormat("<line x1=\"%d\" y1=\"%d\" x2=\"%d\" y2=\"%d\" class=\"s%d\"/>\n",
+		from.x, from.y, to.x, to.y, style);
+
+}
+
+void CDiagramSVGRenderer::Polyline(const CPoint* points, int count)
+/* ============================================================
+	Function :		CDiagramSVGRenderer::Polyline
+	Description :	Draws connected lines with the pen.
+	Access :		Public
+
+	Return :		void
+	Parameters :	const CPoint* points	-	Points to connect.
+					int count				-	Number of points.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	if (m_penStyle != PS_NULL)
+		Shape(points, count, FALSE);
+
+}
+
+void CDiagramSVGRenderer::Polygon(const CPoint* points, int count)
+/* ============================================================
+	Function :		CDiagramSVGRenderer::Polygon
+	Description :	Draws a filled and outlined polygon.
+	Access :		Public
+
+	Return :		void
+	Parameters :	const CPoint* points	-	Corners.
+					int count				-	Number of corners.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	Shape(points, count, TRUE);
+
+}
+
+void CDiagramSVGRenderer::Rectangle(const CRect& rect)
+/* ============================================================
+	Function :		CDiagramSVGRenderer::Rectangle
+	Description :	Draws a filled and outlined rectangle.
+	Access :		Public
+
+	Return :		void
+	Parameters :	const CRect& rect	-	Rectangle to draw.
+
+	Usage :			As in GDI, the right and bottom edges are
+					outside the rectangle.
+
+   ============================================================*/
+{
+
+	CRect r(rect);
+	r.NormalizeRect();
+
+	int style = GetStyle(TRUE, TRUE);
+	WriteFormat("<rect x=\"%d\" y=\"%d\" width=\"%d\" height=\"%d\" class=\"s%d\"/>\n",
+		r.left, r.top, max(r.Width() - 1, 0), max(r.Height() - 1, 0), style);
+
+}
+
+void CDiagramSVGRenderer::RoundRect(const CRect& rect, CPoint corner)
+/* ============================================================
+	Function :		CDiagramSVGRenderer::RoundRect
+	Description :	Draws a filled and outlined rectangle with
+					rounded corners.
+	Access :		Public
+
+	Return :		void
+	Parameters :	const CRect& rect	-	Rectangle to draw.
+					CPoint corner		-	Width and height of
+											the corner ellipses.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	CRect r(rect);
+	r.NormalizeRect();
+
+	int style = GetStyle(TRUE, TRUE);
+	WriteFormat("<rect x=\"%d\" y=\"%d\" width=\"%d\" height=\"%d\" rx=\"%g\" ry=\"%g\" class=\"s%d\"/>\n",
+		r.left, r.top, max(r.Width() - 1, 0), max(r.Height() - 1, 0),
+		static_cast<double>(abs(corner.x)) / 2, static_cast<double>(abs(corner.y)) / 2, style);
+
+}
+
+void CDiagramSVGRenderer::Ellipse(const CRect& rect)
+/* ============================================================
+	Function :		CDiagramSVGRenderer::Ellipse
+	Description :	Draws a filled and outlined ellipse.
+	Access :		Public
+
+	Return :		void
+	Parameters :	const CRect& rect	-	Bounding rectangle.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	CRect r(rect);
+	r.NormalizeRect();
+
+	int style = GetStyle(TRUE, TRUE);
+	WriteFormat("<ellipse cx=\"%g\" cy=\"%g\" rx=\"%g\" ry=\"%g\" class=\"s%d\"/>\n",
+		static_cast<double>(r.left + r.right - 1) / 2, static_cast<double>(r.top + r.bottom - 1) / 2,
+		static_cast<double>(max(r.Width() - 1, 0)) / 2, static_cast<double>(max(r.Height() - 1, 0)) / 2, style);
+
+}
+
+void CDiagramSVGRenderer::DrawBitmap(UINT resid, const CRect& rect, CSize source, COLORREF transparent)
+/* ============================================================
+	Function :		CDiagramSVGRenderer::DrawBitmap
+	Description :	Draws a bitmap, stretched to "rect".
+	Access :		Public
+
+	Return :		void
+	Parameters :	UINT resid				-	Bitmap resource.
+					const CRect& rect		-	Where to draw.
+					CSize source			-	Part of the bitmap
+												to draw, from the
+												top left.
+					COLORREF transparent	-	Color not drawn.
+
+	Usage :			The bitmap is written as PNG data the
+					first time it is drawn with "transparent",
+					and referred to after that.
+
+   ============================================================*/
+{
+
+	if (rect.Width() <= 0 || rect.Height() <= 0 || source.cx <= 0 || source.cy <= 0)
+		return;
+
+	CString key;
+	key.Format(_T("%u/%06X"), resid, transparent);
+
+	int image;
+	void* value;
+	if (m_images.Lookup(key, value))
+		image = static_cast<int>(reinterpret_cast<INT_PTR>(value));
+	else
+	{
+		// Numbered from the count, so failed images take a number too
+		image = static_cast<int>(m_images.GetCount());
+		int width;
+		int height;
+		CByteArray rgba;
+		if (!LoadBitmapRGBA(resid, width, height, rgba))
+			image = -1;
+		m_images.SetAt(key, reinterpret_cast<void*>(static_cast<INT_PTR>(image)));
+		if (image == -1)
+			return;
+
+		BYTE red = GetRValue(transparent);
+		BYTE green = GetGValue(transparent);
+		BYTE blue = GetBValue(transparent);
+		BYTE* data = rgba.GetData();
+		INT_PTR size = rgba.GetSize();
+		for (INT_PTR t = 0; t < size; t += 4)
+			if (data[t] == red && data[t + 1] == green && data[t + 2] == blue)
+				data[t + 3] = 0;
+
+		CMemFile file;
+		CPNGWriter png;
+		BOOL ok = png.Open(&file, width, height);
+		for (int y = 0; y < height && ok; y++)
+			ok = png.WriteRow(data + static_cast<size_t>(y) * width * 4);
+		if (!png.Close())
+			ok = FALSE;
+
+		DWORD length = static_cast<DWORD>(file.GetLength());
+		BYTE* encoded = file.Detach();
+		if (!ok)
+		{
+			image = -1;
+			m_images.SetAt(key, reinterpret_cast<void*>(static_cast<INT_PTR>(image)));
+		}
+		else
+		{
+			WriteFormat("<defs><image id=\"i%d\" width=\"%d\" height=\"%d\" xlink:href=\"data:image/png;base64,", image, width, height);
+			WriteBase64(encoded, length);
+			Write("\"/></defs>\n");
+		}
+		free(encoded);
+	}
+
+	if (image == -1)
+		return;
+
+	// A viewport showing "source" of the image in "rect"
+	WriteFormat("<svg x=\"%g\" y=\"%g\" width=\"%d\" height=\"%d\" viewBox=\"0 0 %d %d\" preserveAspectRatio=\"none\"><use xlink:href=\"#i%d\"/></svg>\n",
+		rect.left - .5, rect.top - .5, rect.Width(), rect.Height(), source.cx, source.cy, image);
+
+}
+
+void CDiagramSVGRenderer::SetClipRect(const CRect& rect)
+/* ============================================================
+	Function :		CDiagramSVGRenderer::SetClipRect
+	Description :	Limits drawing to a rectangle.
+	Access :		Public
+
+	Return :		void
+	Parameters :	const CRect& rect	-	Rectangle to draw in.
+
+	Usage :			Replaces any earlier clipping rectangle.
+
+   ============================================================*/
+{
+
+	ResetClip();
+
+	CRect r(rect);
+	r.NormalizeRect();
+	int clip = m_clips++;
+	WriteFormat("<clipPath id=\"c%d\"><rect x=\"%g\" y=\"%g\" width=\"%d\" height=\"%d\"/></clipPath><g clip-path=\"url(#c%d)\">\n",
+		clip, r.left - .5, r.top - .5, r.Width(), r.Height(), clip);
+	m_clipped = TRUE;
+
+}
+
+void CDiagramSVGRenderer::ResetClip()
+/* ============================================================
+	Function :		CDiagramSVGRenderer::ResetClip
+	Description :	Removes the clipping rectangle.
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	if (m_clipped)
+		Write("</g>\n");
+	m_clipped = FALSE;
+
+}
+
+void CDiagramSVGRenderer::DrawTextLine(const CString& line, const CRect& rect, UINT format)
+/* ============================================================
+	Function :		CDiagramSVGRenderer::DrawTextLine
+	Description :	Draws a line of text.
+	Access :		Protected
+
+	Return :		void
+	Parameters :	const CString& line	-	Text to draw.
+					const CRect& rect	-	Rectangle of the line.
+					UINT format			-	"DT_"-flags.
+
+	Usage :			Centered and right aligned text is
+					anchored at the center or right of "rect",
+					so it stays aligned if the viewer's font is
+					wider or narrower than estimated.
+
+   ============================================================*/
+{
+
+	if (m_bkMode == OPAQUE)
+	{
+		int background = GetStyle(_T("fill:") + GetColor(m_bkColor));
+		WriteFormat("<rect x=\"%g\" y=\"%g\" width=\"%d\" height=\"%d\" class=\"s%d\"/>\n",
+			rect.left - .5, rect.top - .5, rect.Width(), rect.Height(), background);
+	}
+
+	CString face(m_fontFace);
+	face.Remove(_T('\''));
+	CString css;
+	css.Format(_T("font-family:'%s',%s;font-size:%dpx;fill:%s"),
+		face.GetString(), IsFixedPitch() ? _T("monospace") : _T("sans-serif"), m_fontHeight, GetColor(m_textColor).GetString());
+	if (IsBold())
+		css += _T(";font-weight:bold");
+	if (IsItalic())
+		css += _T(";font-style:italic");
+	if (IsUnderline())
+		css += _T(";text-decoration:underline");
+
+	int x = rect.left;
+	if (format & DT_CENTER)
+	{
+		x = rect.left + rect.Width() / 2;
+		css += _T(";text-anchor:middle");
+	}
+	else if (format & DT_RIGHT)
+	{
+		x = rect.right;
+		css += _T(";text-anchor:end");
+	}
+
+	int style = GetStyle(css);
+	WriteFormat("<text x=\"%d\" y=\"%d\" class=\"s%d\">", x, rect.top + GetAscent(), style);
+	WriteString(line);
+	Write("</text>\n");
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramSVGRenderer private helpers
+
+int CDiagramSVGRenderer::GetStyle(BOOL fill, BOOL stroke)
+/* ============================================================
+	Function :		CDiagramSVGRenderer::GetStyle
+	Description :	Gets the class for the current pen and
+					brush.
+	Access :		Private
+
+	Return :		int			-	Class number.
+	Parameters :	BOOL fill	-	"TRUE" if the shape is
+									filled with the brush.
+					BOOL stroke	-	"TRUE" if the shape is
+									outlined with the pen.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	CString css;
+	if (fill && m_fill)
+		css = _T("fill:") + GetColor(m_brushColor);
+	else
+		css = _T("fill:none");
+
+	if (stroke && m_penStyle != PS_NULL)
+	{
+		CString pen;
+		pen.Format(_T(";stroke:%s;stroke-width:%d"), GetColor(m_penColor).GetString(), m_penWidth);
+		css += pen;
+
+		switch (m_penStyle)
+		{
+		case PS_DASH:
+			css += _T(";stroke-dasharray:18,6");
+			break;
+		case PS_DOT:
+			css += _T(";stroke-dasharray:3,3");
+			break;
+		case PS_DASHDOT:
+			css += _T(";stroke-dasharray:9,6,3,6");
+			break;
+		case PS_DASHDOTDOT:
+			css += _T(";stroke-dasharray:9,3,3,3,3,3");
+			break;
+		}
+	}
+
+	return GetStyle(css);
+
+}
+
+int CDiagramSVGRenderer::GetStyle(const CString& declarations)
+/* ============================================================
+	Function :		CDiagramSVGRenderer::GetStyle
+	Description :	Gets the class for CSS declarations,
+					writing it the first time.
+	Access :		Private
+
+	Return :		int							-	Class
+													number.
+	Parameters :	const CString& declarations	-	CSS.
+
+	Usage :			Classes are named "s" and the number.
+
+   ============================================================*/
+{
+
+	void* value;
+	if (m_styles.Lookup(declarations, value))
+		return static_cast<int>(reinterpret_cast<INT_PTR>(value));
+
+	int style = static_cast<int>(m_styles.GetCount());
+	m_styles.SetAt(declarations, reinterpret_cast<void*>(static_cast<INT_PTR>(style)));
+
+	WriteFormat("<style>.s%d{", style);
+	WriteString(declarations);
+	Write("}</style>\n");
+
+	return style;
+
+}
+
+void CDiagramSVGRenderer::Shape(const CPoint* points, int count, BOOL closed)
+/* ============================================================
+	Function :		CDiagramSVGRenderer::Shape
+	Description :	Writes a polygon or polyline.
+	Access :		Private
+
+	Return :		void
+	Parameters :	const CPoint* points	-	Points.
+					int count				-	Number of points.
+					BOOL closed				-	"TRUE" for a
+												filled polygon.
+
+	Usage :			Shapes of at most "SVG_MARKER_POINTS"
+					points within "SVG_MARKER_SIZE" pixels are
+					written once, relative to the first point,
+					and placed with "use".
+
+   ============================================================*/
+{
+
+	if (count < 2)
+		return;
+
+	int style = GetStyle(closed, TRUE);
+
+	CRect bounds(points[0], points[0]);
+	for (int t = 1; t < count; t++)
+	{
+		bounds.left = min(bounds.left, points[t].x);
+		bounds.top = min(bounds.top, points[t].y);
+		bounds.right = max(bounds.right, points[t].x);
+		bounds.bottom = max(bounds.bottom, points[t].y);
+	}
+
+	if (count <= SVG_MARKER_POINTS && bounds.Width() <= SVG_MARKER_SIZE && bounds.Height() <= SVG_MARKER_SIZE)
+	{
+		CString path(_T("M0 0"));
+		for (int t = 1; t < count; t++)
+		{
+			CString point;
+			point.Format(_T("L%d %d"), points[t].x - points[0].x, points[t].y - points[0].y);
+			path += point;
+		}
+		if (closed)
+			path += _T("Z");
+
+		int marker;
+		void* value;
+		if (m_markers.Lookup(path, value))
+			marker = static_cast<int>(reinterpret_cast<INT_PTR>(value));
+		else
+		{
+			marker = static_cast<int>(m_markers.GetCount());
+			m_markers.SetAt(path, reinterpret_cast<void*>(static_cast<INT_PTR>(marker)));
+			WriteFormat("<defs><path id=\"m%d\" d=\"", marker);
+			WriteString(path);
+			Write("\"/></defs>\n");
+		}
+
+		WriteFormat("<use xlink:href=\"#m%d\" x=\"%d\" y=\"%d\" class=\"s%d\"/>\n",
+			marker, points[0].x, points[0].y, style);
+	}
+	else
+	{
+		Write(closed ? "<polygon points=\"" : "<polyline points=\"");
+		for (int t = 0; t < count; t++)
+			WriteFormat(t ? " %d,%d" : "%d,%d", points[t].x, points[t].y);
+		WriteFormat("\" class=\"s%d\"/>\n", style);
+	}
+
+}
+
+void CDiagramSVGRenderer::WriteString(const CString& text)
+/* ============================================================
+	Function :		CDiagramSVGRenderer::WriteString
+	Description :	Writes text as UTF-8, escaped for XML.
+	Access :		Private
+
+	Return :		void
+	Parameters :	const CString& text	-	Text to write.
+
+	Usage :			Control characters are dropped, as XML
+					does not allow them.
+
+   ============================================================*/
+{
+
+	CByteArray bytes;
+	Encode(text, CP_UTF8, bytes);
+
+	INT_PTR size = bytes.GetSize();
+	for (INT_PTR t = 0; t < size; t++)
+	{
+		BYTE c = bytes[t];
+		switch (c)
+		{
+		case '&':
+			Write("&amp;");
+			break;
+		case '<':
+			Write("&lt;");
+			break;
+		case '>':
+			Write("&gt;");
+			break;
+		case '"':
+			Write("&quot;");
+			break;
+		default:
+			if (c >= 32 || c == '\t')
+				Write(&c, 1);
+			break;
+		}
+	}
+
+}
+
+CString CDiagramSVGRenderer::GetColor(COLORREF color)
+/* ============================================================
+	Function :		CDiagramSVGRenderer::GetColor
+	Description :	Formats a color for CSS.
+	Access :		Private
+
+	Return :		CString			-	"#rrggbb"
+	Parameters :	COLORREF color	-	Color to format.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	CString str;
+	str.Format(_T("#%02x%02x%02x"), GetRValue(color), GetGValue(color), GetBValue(color));
+	return str;
+
+}
@@ -0,0 +1,64 @@
+#ifndef _CDIAGRAMSVGRENDERER_H_E2940B6D_3F8A_4C71_A5D9160E7B3C2
+#define _CDIAGRAMSVGRENDERER_H_E2940B6D_3F8A_4C71_A5D9160E7B3C2
+
+///////////////////////////////////////////////////////////
+// File :		DiagramSVGRenderer.h
+// Created :	10/19/26
+//
+
+#include "DiagramVectorRenderer.h"
+
+#define SVG_MARKER_POINTS	8		// Most points of a shape written once and reused
+#define SVG_MARKER_SIZE		32		// Largest side of a shape written once and reused
+
+// Streams SVG to a file
+class CDiagramSVGRenderer : public CDiagramVectorRenderer
+{
+public:
+	// Construction/destruction
+	CDiagramSVGRenderer();
+	virtual ~CDiagramSVGRenderer();
+
+	// Operations
+	BOOL			Open(const CString& filename, const CRect& area, COLORREF background);
+	BOOL			Close();
+
+	// Attributes
+	int				GetStyleCount() const;
+	int				GetMarkerCount() const;
+
+	// Overrides
+	virtual void	Line(CPoint from, CPoint to);
+	virtual void	Polyline(const CPoint* points, int count);
+	virtual void	Polygon(const CPoint* points, int count);
+	virtual void	Rectangle(const CRect& rect);
+	virtual void	RoundRect(const CRect& rect, CPoint corner);
+	virtual void	Ellipse(const CRect& rect);
+
+	virtual void	DrawBitmap(UINT resid, const CRect& rect, CSize source, COLORREF transparent);
+
+	virtual void	SetClipRect(const CRect& rect);
+	virtual void	ResetClip();
+
+protected:
+	virtual void	DrawTextLine(const CString& line, const CRect& rect, UINT format);
+
+private:
+	// Data
+	CMapStringToPtr	m_styles;		// Class number by CSS declarations
+	CMapStringToPtr	m_markers;		// Path number by path data
+	CMapStringToPtr	m_images;		// Image number by resource and transparent color
+	int				m_clips;		// Clip paths written
+	BOOL			m_clipped;		// A clipped group is open
+
+	// Helpers
+	int		GetStyle(BOOL fill, BOOL stroke);
+	int		GetStyle(const CString& declarations);
+	void	Shape(const CPoint* points, int count, BOOL closed);
+	void	WriteString(const CString& text);
+
+	static CString	GetColor(COLORREF color);
+
+};
+
+#endif //_CDIAGRAMSVGRENDERER_H_E2940B6D_3F8A_4C71_A5D9160E7B3C2
@@ -0,0 +1,737 @@
+/* ==========================================================================
+	File :			DiagramThumbnail.cpp
+
+	Class :			CDiagramThumbnail
+
+	Date :			10/19/26
+
+	Purpose :		"CDiagramThumbnail" is a small pre-rendered preview of
+					a diagram, saved at the end of the diagram file so
+					that it can be shown without reading the diagram.
+
+	Description :	"Create" draws clones of the objects into a 24-bit
+					DIB, scaled so that the longest side is at most
+					"THUMBNAIL_SIZE" pixels. The bits are compressed
+					with the "CUndoSpill" coder and saved as a base64
+					line, "thumbnail:width,height,left,top,right,bottom,
+					size,data;", where "left" to "bottom" is the
+					rectangle around the objects in the diagram.
+
+					"WriteTrailer" writes the line last in the file,
+					followed by a fixed size footer line giving the
+					length of the thumbnail line.
+					"ReadTrailer" reads the footer from the end of the
+					file, and then the thumbnail line, so the time to
+					get a preview does not depend on the size of the
+					file. The loaders ignore both lines, as the factories
+					don't know them.
+
+					"Update" only draws the preview again if the
+					container has changed since the last time, so
+					saving an unchanged diagram doesn't draw it.
+
+	Usage :			Call "Update" and "WriteTrailer" when saving, and
+					"ReadTrailer" and "Draw" to show the preview.
+
+   ========================================================================*/
+
+#include "stdafx.h"
+#include "DiagramThumbnail.h"
+#include "DiagramEntity.h"
+#include "Tokenizer.h"
+#include "UndoSpill.h"
+
+#ifdef _DEBUG
+#define new DEBUG_NEW
+#undef THIS_FILE
+static char THIS_FILE[] = __FILE__;
+#endif
+
+// The footer, with the number of characters in the thumbnail line
+#define THUMBNAIL_FOOTER		_T("thumbnail_trailer:%08X;\r\n")
+#define THUMBNAIL_FOOTER_START	_T("thumbnail_trailer:")
+#define THUMBNAIL_FOOTER_LENGTH	29
+
+static const TCHAR base64[] = _T("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/");
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramThumbnail construction/destruction
+
+CDiagramThumbnail::CDiagramThumbnail()
+/* ============================================================
+	Function :		CDiagramThumbnail::CDiagramThumbnail
+	Description :	Constructor
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			The thumbnail is empty until "Create" or
+					"ReadTrailer" is called.
+
+   ============================================================*/
+{
+
+	Clear();
+
+}
+
+CDiagramThumbnail::~CDiagramThumbnail()
+/* ============================================================
+	Function :		CDiagramThumbnail::~CDiagramThumbnail
+	Description :	Destructor
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramThumbnail creation
+
+BOOL CDiagramThumbnail::Create(const CObArray* objs, ENTITYPREDICATE predicate, LPVOID data, int size)
+/* ============================================================
+	Function :		CDiagramThumbnail::Create
+	Description :	Draws the preview of a diagram.
+	Access :		Public
+
+	Return :		BOOL					-	"FALSE" if there
+												is nothing to
+												draw.
+	Parameters :	const CObArray* objs	-	Objects of the
+												diagram.
+					ENTITYPREDICATE predicate	-	Objects to
+													draw, "NULL"
+													for all.
+					LPVOID data				-	Passed to
+												"predicate".
+					int size				-	Longest side of
+												the preview.
+
+	Usage :			The objects are cloned before they are
+					drawn, so their zoom and selection are not
+					changed.
+
+   ============================================================*/
+{
+
+	Clear();
+
+	CRect bounds(0, 0, 0, 0);
+	BOOL found = FALSE;
+	INT_PTR max = objs->GetSize();
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		CDiagramEntity* obj = static_cast<CDiagramEntity*>(objs->GetAt(t));
+		if (predicate && !predicate(obj, data))
+			continue;
+
+		CRect rect = obj->GetRect();
+		rect.NormalizeRect();
+		rect.InflateRect(1, 1);
+		if (found)
+			bounds.UnionRect(bounds, rect);
+		else
+			bounds = rect;
+		found = TRUE;
+	}
+
+	if (!found)
+		return FALSE;
+
+	double zoom = min(static_cast<double>(size) / static_cast<double>(bounds.Width()),
+		static_cast<double>(size) / static_cast<double>(bounds.Height()));
+	CSize pixels(round(bounds.Width() * zoom), round(bounds.Height() * zoom));
+	if (pixels.cx < 1)
+		pixels.cx = 1;
+	if (pixels.cy < 1)
+		pixels.cy = 1;
+
+	BITMAPINFO info;
+	memset(&info, 0, sizeof(info));
+	info.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+	info.bmiHeader.biWidth = pixels.cx;
+	info.bmiHeader.biHeight = pixels.cy;
+	info.bmiHeader.biPlanes = 1;
+	info.bmiHeader.biBitCount = 24;
+	info.bmiHeader.biCompression = BI_RGB;
+
+	CDC dc;
+	if (!dc.CreateCompatibleDC(NULL))
+		return FALSE;
+
+	void* bits = NULL;
+	HBITMAP bitmap = ::CreateDIBSection(dc.m_hDC, &info, DIB_RGB_COLORS, &bits, NULL, 0);
+	if (!bitmap)
+		return FALSE;
+
+	HGDIOBJ oldBitmap = ::SelectObject(dc.m_hDC, bitmap);
+	dc.FillSolidRect(0, 0, pixels.cx, pixels.cy, RGB(255, 255, 255));
+	dc.SetWindowOrg(round(bounds.left * zoom), round(bounds.top * zoom));
+
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		CDiagramEntity* obj = static_cast<CDiagramEntity*>(objs->GetAt(t));
+		if (predicate && !predicate(obj, data))
+			continue;
+
+		CDiagramEntity* clone = obj->Clone();
+		if (clone)
+		{
+			clone->Select(FALSE);
+			clone->DrawObject(&dc, zoom);
+			delete clone;
+		}
+	}
+
+	::GdiFlush();
+
+	m_size = pixels;
+	m_bounds = bounds;
+	m_bits.SetSize(GetStride() * pixels.cy);
+	memcpy(m_bits.GetData(), bits, m_bits.GetSize());
+
+	::SelectObject(dc.m_hDC, oldBitmap);
+	::DeleteObject(bitmap);
+
+	return TRUE;
+
+}
+
+BOOL CDiagramThumbnail::Update(CDiagramEntityContainer* container, ENTITYPREDICATE predicate, LPVOID data, int size)
+/* ============================================================
+	Function :		CDiagramThumbnail::Update
+	Description :	Draws the preview of a container, if it
+					has changed.
+	Access :		Public
+
+	Return :		BOOL					-	"FALSE" if there
+												is nothing to
+												draw.
+	Parameters :	CDiagramEntityContainer* container	-
+												Container to
+												draw.
+					ENTITYPREDICATE predicate	-	Objects to
+													draw, "NULL"
+													for all.
+					LPVOID data				-	Passed to
+												"predicate".
+					int size				-	Longest side of
+												the preview.
+
+	Usage :			Call when saving. The preview is kept until
+					"GetChangeCount" of the container changes,
+					so "predicate" and "size" should be the
+					same for every call.
+
+   ============================================================*/
+{
+
+	if (container == m_container && container->GetChangeCount() == m_changes)
+		return !IsEmpty();
+
+	BOOL result = Create(container->GetData(), predicate, data, size);
+	m_container = container;
+	m_changes = container->GetChangeCount();
+
+	return result;
+
+}
+
+void CDiagramThumbnail::Clear()
+/* ============================================================
+	Function :		CDiagramThumbnail::Clear
+	Description :	Empties the thumbnail.
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Call to remove the preview.
+
+   ============================================================*/
+{
+
+	m_size = CSize(0, 0);
+	m_bounds.SetRectEmpty();
+	m_bits.RemoveAll();
+	m_container = NULL;
+	m_changes = 0;
+
+}
+
+BOOL CDiagramThumbnail::IsEmpty() const
+/* ============================================================
+	Function :		CDiagramThumbnail::IsEmpty
+	Description :	Checks if there is a preview.
+	Access :		Public
+
+	Return :		BOOL	-	"TRUE" if there is none.
+	Parameters :	none
+
+	Usage :			Call to see if the file had a preview.
+
+   ============================================================*/
+{
+
+	return m_bits.GetSize() == 0;
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramThumbnail drawing
+
+void CDiagramThumbnail::Draw(CDC& dc, LPCRECT rect) const
+/* ============================================================
+	Function :		CDiagramThumbnail::Draw
+	Description :	Draws the preview.
+	Access :		Public
+
+	Return :		void
+	Parameters :	CDC& dc			-	"CDC" to draw to.
+					LPCRECT rect	-	Rectangle to draw in.
+
+	Usage :			The preview is centered in "rect", keeping
+					its proportions. The rest of "rect" is
+					filled with white.
+
+   ============================================================*/
+{
+
+	CRect target(rect);
+	dc.FillSolidRect(target, RGB(255, 255, 255));
+	if (IsEmpty())
+		return;
+
+	double zoom = min(static_cast<double>(target.Width()) / static_cast<double>(m_size.cx),
+		static_cast<double>(target.Height()) / static_cast<double>(m_size.cy));
+	int width = round(m_size.cx * zoom);
+	int height = round(m_size.cy * zoom);
+	int left = target.left + (target.Width() - width) / 2;
+	int top = target.top + (target.Height() - height) / 2;
+
+	BITMAPINFO info;
+	memset(&info, 0, sizeof(info));
+	info.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+	info.bmiHeader.biWidth = m_size.cx;
+	info.bmiHeader.biHeight = m_size.cy;
+	info.bmiHeader.biPlanes = 1;
+	info.bmiHeader.biBitCount = 24;
+	info.bmiHeader.biCompression = BI_RGB;
+
+	int mode = dc.SetStretchBltMode(HALFTONE);
+	::SetBrushOrgEx(dc.m_hDC, 0, 0, NULL);
+	::StretchDIBits(dc.m_hDC, left, top, width, height, 0, 0, m_size.cx, m_size.cy, m_bits.GetData(), &info, DIB_RGB_COLORS, SRCCOPY);
+	dc.SetStretchBltMode(mode);
+
+}
+
+CSize CDiagramThumbnail::GetSize() const
+/* ============================================================
+	Function :		CDiagramThumbnail::GetSize
+	Description :	Gets the size of the preview.
+	Access :		Public
+
+	Return :		CSize	-	Size in pixels.
+	Parameters :	none
+
+	Usage :			Call to get the size the preview was
+					drawn in.
+
+   ============================================================*/
+{
+
+	return m_size;
+
+}
+
+CRect CDiagramThumbnail::GetBounds() const
+/* ============================================================
+	Function :		CDiagramThumbnail::GetBounds
+	Description :	Gets the rectangle around the objects.
+	Access :		Public
+
+	Return :		CRect	-	Rectangle in diagram
+								coordinates.
+	Parameters :	none
+
+	Usage :			Call to get the extent of the diagram
+					without reading it.
+
+   ============================================================*/
+{
+
+	return m_bounds;
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramThumbnail serialization
+
+CString CDiagramThumbnail::GetString() const
+/* ============================================================
+	Function :		CDiagramThumbnail::GetString
+	Description :	Gets the preview as a string.
+	Access :		Public
+
+	Return :		CString	-	The string, empty if there
+								is no preview.
+	Parameters :	none
+
+	Usage :			The format is "thumbnail:width,height,
+					left,top,right,bottom,size,data;", where
+					"data" is the compressed bits in base64
+					and "size" their uncompressed size.
+
+   ============================================================*/
+{
+
+	CString str;
+	if (IsEmpty())
+		return str;
+
+	CByteArray compressed;
+	CUndoSpill::Compress(m_bits.GetData(), static_cast<DWORD>(m_bits.GetSize()), compressed);
+
+	str.Format(_T("thumbnail:%i,%i,%i,%i,%i,%i,%i,"),
+		m_size.cx,
+		m_size.cy,
+		m_bounds.left,
+		m_bounds.top,
+		m_bounds.right,
+		m_bounds.bottom,
+		static_cast<int>(m_bits.GetSize()));
+
+	return str + Encode(compressed) + _T(";");
+
+}
+
+BOOL CDiagramThumbnail::FromString(const CString& str)
+/* ============================================================
+	Function :		CDiagramThumbnail::FromString
+	Description :	Sets the preview from a string.
+	Access :		Public
+
+	Return :		BOOL				-	"TRUE" if "str" was
+											a valid preview.
+	Parameters :	const CString& str	-	String from
+											"GetString".
+
+	Usage :			The thumbnail is emptied if "str" is not
+					a valid preview.
+
+   ============================================================*/
+{
+
+	Clear();
+
+	CTokenizer main(str, _T(":"));
+	CString header;
+	CString data;
+	if (main.GetSize() != 2)
+		return FALSE;
+
+	main.GetAt(0, header);
+	main.GetAt(1, data);
+	header.TrimLeft();
+	header.TrimRight();
+	data.TrimLeft();
+	data.TrimRight();
+	if (header != _T("thumbnail"))
+		return FALSE;
+
+	CTokenizer tok(data.Left(data.GetLength() - 1));
+	if (tok.GetSize() != 8)
+		return FALSE;
+
+	int width;
+	int height;
+	int left;
+	int top;
+	int right;
+	int bottom;
+	int size;
+	CString encoded;
+	tok.GetAt(0, width);
+	tok.GetAt(1, height);
+	tok.GetAt(2, left);
+	tok.GetAt(3, top);
+	tok.GetAt(4, right);
+	tok.GetAt(5, bottom);
+	tok.GetAt(6, size);
+	tok.GetAt(7, encoded);
+
+	m_size = CSize(width, height);
+	if (width <= 0 || height <= 0 || width > 4 * THUMBNAIL_SIZE || height > 4 * THUMBNAIL_SIZE || size != GetStride() * height)
+	{
+		Clear();
+		return FALSE;
+	}
+
+	CByteArray compressed;
+	m_bits.SetSize(size);
+	if (!Decode(encoded, compressed) ||
+		!CUndoSpill::Decompress(compressed.GetData(), static_cast<DWORD>(compressed.GetSize()), m_bits.GetData(), size))
+	{
+		Clear();
+		return FALSE;
+	}
+
+	m_bounds.SetRect(left, top, right, bottom);
+	return TRUE;
+
+}
+
+void CDiagramThumbnail::WriteTrailer(CArchive& ar) const
+/* ============================================================
+	Function :		CDiagramThumbnail::WriteTrailer
+	Description :	Writes the preview to the end of a file.
+	Access :		Public
+
+	Return :		void
+	Parameters :	CArchive& ar	-	Archive to write to.
+
+	Usage :			Call last when saving a diagram. Does
+					nothing if the thumbnail is empty.
+
+   ============================================================*/
+{
+
+	if (IsEmpty())
+		return;
+
+	CString line = GetString() + _T("\r\n");
+	CString footer;
+	footer.Format(THUMBNAIL_FOOTER, line.GetLength());
+
+	ar.WriteString(line);
+	ar.WriteString(footer);
+
+}
+
+BOOL CDiagramThumbnail::ReadTrailer(CArchive& ar)
+/* ============================================================
+	Function :		CDiagramThumbnail::ReadTrailer
+	Description :	Reads the preview from the end of the file
+					of an archive.
+	Access :		Public
+
+	Return :		BOOL			-	"TRUE" if the file had
+										a preview.
+	Parameters :	CArchive& ar	-	Archive to read from.
+
+	Usage :			Call before reading the diagram. The file
+					position is restored.
+
+   ============================================================*/
+{
+
+	// Empty the archive buffer before using the file
+	ar.Flush();
+
+	CFile* file = ar.GetFile();
+	ULONGLONG position = file->GetPosition();
+	BOOL result = ReadTrailer(file);
+	file->Seek(position, CFile::begin);
+
+	return result;
+
+}
+
+BOOL CDiagramThumbnail::ReadTrailer(CFile* file)
+/* ============================================================
+	Function :		CDiagramThumbnail::ReadTrailer
+	Description :	Reads the preview from the end of a file.
+	Access :		Public
+
+	Return :		BOOL		-	"TRUE" if the file had a
+									preview.
+	Parameters :	CFile* file	-	File to read from.
+
+	Usage :			Only the footer and the thumbnail line are
+					read. The file position is changed.
+
+   ============================================================*/
+{
+
+	Clear();
+
+	BOOL result = FALSE;
+	TRY
+	{
+		UINT footerSize = THUMBNAIL_FOOTER_LENGTH * sizeof(TCHAR);
+		ULONGLONG length = file->GetLength();
+		if (length >= footerSize)
+		{
+			TCHAR footer[THUMBNAIL_FOOTER_LENGTH + 1];
+			file->Seek(-static_cast<LONGLONG>(footerSize), CFile::end);
+			if (file->Read(footer, footerSize) == footerSize)
+			{
+				footer[THUMBNAIL_FOOTER_LENGTH] = 0;
+				UINT chars = 0;
+				int start = lstrlen(THUMBNAIL_FOOTER_START);
+				if (_tcsncmp(footer, THUMBNAIL_FOOTER_START, start) == 0 &&
+					_stscanf_s(footer + start, _T("%8X"), &chars) == 1 &&
+					static_cast<ULONGLONG>(chars) * sizeof(TCHAR) + footerSize <= length)
+				{
+					UINT lineSize = chars * sizeof(TCHAR);
+					CString line;
+					file->Seek(-static_cast<LONGLONG>(lineSize + footerSize), CFile::end);
+					UINT read = file->Read(line.GetBuffer(chars), lineSize);
+					line.ReleaseBuffer(read / sizeof(TCHAR));
+					line.TrimRight();
+					result = FromString(line);
+				}
+			}
+		}
+	}
+	CATCH_ALL(e)
+	{
+		Clear();
+		result = FALSE;
+	}
+	END_CATCH_ALL
+
+	return result;
+
+}
+
+BOOL CDiagramThumbnail::ReadTrailer(LPCTSTR filename)
+/* ============================================================
+	Function :		CDiagramThumbnail::ReadTrailer
+	Description :	Reads the preview of a diagram file.
+	Access :		Public
+
+	Return :		BOOL				-	"TRUE" if the file
+											had a preview.
+	Parameters :	LPCTSTR filename	-	File to read.
+
+	Usage :			For lists of files, such as recent files,
+					that show previews without opening the
+					diagrams.
+
+   ============================================================*/
+{
+
+	Clear();
+
+	CFile file;
+	if (!file.Open(filename, CFile::modeRead | CFile::shareDenyWrite))
+		return FALSE;
+
+	return ReadTrailer(&file);
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramThumbnail private helpers
+
+int CDiagramThumbnail::GetStride() const
+/* ============================================================
+	Function :		CDiagramThumbnail::GetStride
+	Description :	Gets the size of a row of the bits.
+	Access :		Private
+
+	Return :		int		-	Size in bytes.
+	Parameters :	none
+
+	Usage :			DIB rows are padded to 4 bytes.
+
+   ============================================================*/
+{
+
+	return (m_size.cx * 3 + 3) & ~3;
+
+}
+
+CString CDiagramThumbnail::Encode(const CByteArray& data)
+/* ============================================================
+	Function :		CDiagramThumbnail::Encode
+	Description :	Encodes data as base64.
+	Access :		Private
+
+	Return :		CString				-	The encoded data.
+	Parameters :	const CByteArray& data	-	Data to encode.
+
+	Usage :			The base64 alphabet has no separators used
+					by the diagram file format.
+
+   ============================================================*/
+{
+
+	INT_PTR size = data.GetSize();
+	CString str;
+	LPTSTR out = str.GetBuffer(static_cast<int>((size + 2) / 3 * 4));
+	int length = 0;
+	for (INT_PTR t = 0; t < size; t += 3)
+	{
+		DWORD group = data[t] << 16;
+		if (t + 1 < size)
+			group |= data[t + 1] << 8;
+		if (t + 2 < size)
+			group |= data[t + 2];
+
+		out[length++] = base64[(group >> 18) & 63];
+		out[length++] = base64[(group >> 12) & 63];
+		out[length++] = t + 1 < size ? base64[(group >> 6) & 63] : _TCHAR('=');
+		out[length++] = t + 2 < size ? base64[group & 63] : _TCHAR('=');
+	}
+	str.ReleaseBuffer(length);
+
+	return str;
+
+}
+
+BOOL CDiagramThumbnail::Decode(const CString& str, CByteArray& data)
+/* ============================================================
+	Function :		CDiagramThumbnail::Decode
+	Description :	Decodes base64 data.
+	Access :		Private
+
+	Return :		BOOL				-	"FALSE" if "str" is
+											not valid base64.
+	Parameters :	const CString& str	-	Data to decode.
+					CByteArray& data	-	Gets the data.
+
+	Usage :			Call to decode data from "Encode".
+
+   ============================================================*/
+{
+
+	int length = str.GetLength();
+	if (length % 4)
+		return FALSE;
+
+	data.SetSize(0, length / 4 * 3);
+	for (int t = 0; t < length; t += 4)
+	{
+		DWORD group = 0;
+		int pad = 0;
+		for (int i = 0; i < 4; i++)
+		{
+			TCHAR c = str[t + i];
+			LPCTSTR found = _tcschr(base64, c);
+			group <<= 6;
+			if (c == _TCHAR('=') && t + 4 == length && i >= 2)
+				pad++;
+			else if (found && c && !pad)
+				group |= static_cast<DWORD>(found - base64);
+			else
+				return FALSE;
+		}
+
+		data.Add(static_cast<BYTE>(group >> 16));
+		if (pad < 2)
+			data.Add(static_cast<BYTE>(group >> 8));
+		if (pad < 1)
+			data.Add(static_cast<BYTE>(group));
+	}
+
+	return TRUE;
+
+}
@@ -0,0 +1,56 @@
+#ifndef _CDIAGRAMTHUMBNAIL_H_3F7A2C90_6B1D_4E58_A4C2E9D17B3F6
+#define _CDIAGRAMTHUMBNAIL_H_3F7A2C90_6B1D_4E58_A4C2E9D17B3F6
+
+///////////////////////////////////////////////////////////
+// File :		DiagramThumbnail.h
+// Created :	10/19/26
+//
+
+#include "DiagramEntityContainer.h"
+
+// Longest side of a preview, in pixels
+#define THUMBNAIL_SIZE	128
+
+class CDiagramThumbnail
+{
+public:
+	// Construction/destruction
+	CDiagramThumbnail();
+	virtual ~CDiagramThumbnail();
+
+	// Creation
+	BOOL		Create(const CObArray* objs, ENTITYPREDICATE predicate = NULL, LPVOID data = NULL, int size = THUMBNAIL_SIZE);
+	BOOL		Update(CDiagramEntityContainer* container, ENTITYPREDICATE predicate = NULL, LPVOID data = NULL, int size = THUMBNAIL_SIZE);
+	void		Clear();
+	BOOL		IsEmpty() const;
+
+	// Drawing
+	void		Draw(CDC& dc, LPCRECT rect) const;
+	CSize		GetSize() const;
+	CRect		GetBounds() const;
+
+	// Serialization
+	CString		GetString() const;
+	BOOL		FromString(const CString& str);
+	void		WriteTrailer(CArchive& ar) const;
+	BOOL		ReadTrailer(CArchive& ar);
+	BOOL		ReadTrailer(CFile* file);
+	BOOL		ReadTrailer(LPCTSTR filename);
+
+private:
+	CSize		m_size;		// Size of the preview in pixels
+	CRect		m_bounds;	// Rectangle around the objects, in diagram coordinates
+	CByteArray	m_bits;		// 24-bit bottom-up DIB rows
+
+	const CDiagramEntityContainer*	m_container;	// Container "Update" drew, NULL if none
+	UINT							m_changes;		// Change count of "m_container" when drawn
+
+	// Helpers
+	int			GetStride() const;
+
+	static CString	Encode(const CByteArray& data);
+	static BOOL		Decode(const CString& str, CByteArray& data);
+
+};
+
+#endif //_CDIAGRAMTHUMBNAIL_H_3F7A2C90_6B1D_4E58_A4C2E9D17B3F6
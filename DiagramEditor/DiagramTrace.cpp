@@ -0,0 +1,328 @@
+/* ==========================================================================
+	File :			DiagramTrace.cpp
+
+	Class :			CDiagramTrace
+
+	Date :			10/19/26
+
+	Purpose :		"CDiagramTrace" records timed spans of the slow
+					paths - loading, undo snapshots, drawing, link
+					adjustment, export and paste - and saves them as
+					Chrome trace events, to be opened in
+					"chrome://tracing" or Perfetto.
+
+	Description :	Each thread writes its spans to a ring buffer of
+					its own, so recording takes no lock. The buffer is
+					found through a thread local pointer, and linked
+					into a global list with an interlocked exchange the
+					first time the thread records a span. When the
+					thread exits, a fiber local storage callback marks
+					the buffer as unused, and the next new thread takes
+					it over, so short-lived workers do not use up
+					memory. The buffers stay in the list until "Free",
+					and each span records its thread. Only the
+					"TRACE_BUFFER_SIZE" newest spans of each buffer are
+					kept, and a thread started while "TRACE_MAX_THREADS"
+					others hold buffers is not traced.
+
+					"Save" copies the buffers while they may be written
+					to, and drops the spans that were overwritten during
+					the copy.
+
+					When tracing is disabled, a span costs a test of a
+					global flag. Define "DIAGRAM_NO_TRACE" to compile
+					the spans out.
+
+	Usage :			Put "DIAGRAM_TRACE_SPAN( _T( "name" ) )" first in a
+					scope to time it. The name must be a string
+					literal. Call "Enable" to start tracing, and "Save"
+					to write the spans recorded since.
+
+   ========================================================================*/
+
+#include "stdafx.h"
+#include "DiagramTrace.h"
+
+#ifdef _DEBUG
+#define new DEBUG_NEW
+#undef THIS_FILE
+static char THIS_FILE[] = __FILE__;
+#endif
+
+// The buffer of the current thread, "NULL" before its first span
+static __declspec(thread) void* threadBuffer = NULL;
+
+// Marks a thread that did not get a buffer
+#define TRACE_NO_BUFFER	reinterpret_cast< void* >(1)
+
+volatile LONG				CDiagramTrace::s_enabled = 0;
+LONGLONG					CDiagramTrace::s_origin = 0;
+CDiagramTrace::CBuffer* volatile	CDiagramTrace::s_buffers = NULL;
+volatile LONG				CDiagramTrace::s_threads = 0;
+DWORD						CDiagramTrace::s_slot = FLS_OUT_OF_INDEXES;
+
+static CStringA JsonEscape(LPCTSTR str)
+{
+	CStringA result;
+	CStringA utf8(CW2A(CT2W(str), CP_UTF8));
+	for (int t = 0; t < utf8.GetLength(); t++)
+	{
+		char c = utf8[t];
+		if (c == '"' || c == '\\')
+			result += '\\';
+		if (static_cast<unsigned char>(c) >= 0x20)
+			result += c;
+	}
+
+	return result;
+}
+
+void CDiagramTrace::Enable(BOOL enable)
+/* ============================================================
+	Function :		CDiagramTrace::Enable
+	Description :	Starts or stops tracing.
+	Access :		Public
+
+	Return :		void
+	Parameters :	BOOL enable	-	"TRUE" to start tracing.
+
+	Usage :			Starting tracing discards the spans from
+					before, as far as "Save" is concerned.
+
+   ============================================================*/
+{
+
+	if (enable && !s_enabled)
+	{
+		s_origin = GetCounter();
+		if (s_slot == FLS_OUT_OF_INDEXES)
+			s_slot = ::FlsAlloc(ReleaseBuffer);
+	}
+
+	::InterlockedExchange(&s_enabled, enable ? 1 : 0);
+
+}
+
+void CDiagramTrace::Add(LPCTSTR name, LONGLONG start, LONGLONG end)
+/* ============================================================
+	Function :		CDiagramTrace::Add
+	Description :	Records a span in the buffer of the calling
+					thread.
+	Access :		Public
+
+	Return :		void
+	Parameters :	LPCTSTR name	-	Static name of the span.
+					LONGLONG start	-	Counter at the start.
+					LONGLONG end	-	Counter at the end.
+
+	Usage :			Called from "CDiagramTraceSpan".
+
+   ============================================================*/
+{
+
+	CBuffer* buffer = GetBuffer();
+	if (buffer)
+	{
+		CSpan& span = buffer->spans[buffer->written % TRACE_BUFFER_SIZE];
+		span.name = name;
+		span.start = start;
+		span.end = end;
+		span.thread = ::GetCurrentThreadId();
+
+		// The span must be complete before it is counted
+		::InterlockedIncrement(&buffer->written);
+	}
+
+}
+
+BOOL CDiagramTrace::Save(const CString& filename)
+/* ============================================================
+	Function :		CDiagramTrace::Save
+	Description :	Saves the spans recorded since tracing was
+					enabled as a Chrome trace event file.
+	Access :		Public
+
+	Return :		BOOL					-	"TRUE" if saved.
+	Parameters :	const CString& filename	-	File to save to.
+
+	Usage :			Can be called while tracing is enabled.
+					Times are in microseconds from "Enable".
+
+   ============================================================*/
+{
+
+	LARGE_INTEGER frequency;
+	::QueryPerformanceFrequency(&frequency);
+	double scale = 1000000.0 / static_cast<double>(frequency.QuadPart);
+	DWORD process = ::GetCurrentProcessId();
+
+	CStringA json("{\"traceEvents\":[\n");
+	BOOL first = TRUE;
+	CArray< CSpan, CSpan& > spans;
+	for (CBuffer* buffer = s_buffers; buffer; buffer = buffer->next)
+	{
+		// Copy the spans, then keep those not overwritten in the meantime
+		LONG before = buffer->written;
+		LONG oldest = max(0L, before - TRACE_BUFFER_SIZE);
+		spans.SetSize(before - oldest);
+		for (LONG t = oldest; t < before; t++)
+			spans[t - oldest] = buffer->spans[t % TRACE_BUFFER_SIZE];
+
+		LONG after = buffer->written;
+		LONG valid = max(oldest, after - TRACE_BUFFER_SIZE + 1);
+
+		for (LONG t = valid; t < before; t++)
+		{
+			const CSpan& span = spans[t - oldest];
+			if (span.start < s_origin)
+				continue;
+
+			CStringA line;
+			line.Format("%s{\"name\":\"%s\",\"cat\":\"tulip\",\"ph\":\"X\",\"pid\":%lu,\"tid\":%lu,\"ts\":%.3f,\"dur\":%.3f}",
+				first ? "" : ",\n",
+				static_cast<LPCSTR>(JsonEscape(span.name)),
+				process,
+				span.thread,
+				static_cast<double>(span.start - s_origin) * scale,
+				static_cast<double>(span.end - span.start) * scale);
+			json += line;
+			first = FALSE;
+		}
+	}
+
+	json += "\n],\"displayTimeUnit\":\"ms\"}\n";
+
+	BOOL result = FALSE;
+	TRY
+	{
+		CFile file(filename, CFile::modeCreate | CFile::modeWrite);
+		file.Write(static_cast<LPCSTR>(json), json.GetLength());
+		file.Close();
+		result = TRUE;
+	}
+	CATCH_ALL(e)
+	{
+		e->Delete();
+	}
+	END_CATCH_ALL
+
+	return result;
+
+}
+
+CDiagramTrace::CBuffer* CDiagramTrace::GetBuffer()
+/* ============================================================
+	Function :		CDiagramTrace::GetBuffer
+	Description :	Gets the ring buffer of the calling thread.
+	Access :		Private
+
+	Return :		CBuffer*	-	The buffer, "NULL" if the
+									thread is not traced.
+	Parameters :	none
+
+	Usage :			Takes over the buffer of an exited thread,
+					or creates a buffer, on the first call in a
+					thread.
+
+   ============================================================*/
+{
+
+	if (threadBuffer == TRACE_NO_BUFFER)
+		return NULL;
+
+	if (threadBuffer == NULL)
+	{
+		// Buffers are never removed from the list before
+		// "Free", so it can be walked without a lock
+		CBuffer* buffer = NULL;
+		for (CBuffer* unused = s_buffers; unused && !buffer; unused = unused->next)
+			if (::InterlockedCompareExchange(&unused->used, 1, 0) == 0)
+				buffer = unused;
+
+		if (buffer == NULL)
+		{
+			if (::InterlockedIncrement(&s_threads) > TRACE_MAX_THREADS)
+			{
+				::InterlockedDecrement(&s_threads);
+				threadBuffer = TRACE_NO_BUFFER;
+				return NULL;
+			}
+
+			buffer = new CBuffer;
+			buffer->written = 0;
+			buffer->used = 1;
+
+			// Push onto the list without a lock
+			CBuffer* head;
+			do
+			{
+				head = s_buffers;
+				buffer->next = head;
+			} while (::InterlockedCompareExchangePointer(reinterpret_cast< PVOID volatile* >(&s_buffers), buffer, head) != head);
+		}
+
+		if (s_slot != FLS_OUT_OF_INDEXES)
+			::FlsSetValue(s_slot, buffer);
+		threadBuffer = buffer;
+	}
+
+	return static_cast< CBuffer* >(threadBuffer);
+
+}
+
+void WINAPI CDiagramTrace::ReleaseBuffer(PVOID buffer)
+/* ============================================================
+	Function :		CDiagramTrace::ReleaseBuffer
+	Description :	Marks the buffer of an exiting thread as
+					unused.
+	Access :		Private
+
+	Return :		void
+	Parameters :	PVOID buffer	-	The "CBuffer" of the
+									thread.
+
+	Usage :			Fiber local storage callback, called by
+					Windows when a thread that has recorded
+					spans exits. Its spans stay in the buffer
+					until the next owner overwrites them.
+
+   ============================================================*/
+{
+
+	::InterlockedExchange(&static_cast< CBuffer* >(buffer)->used, 0);
+
+}
+
+void CDiagramTrace::Free()
+/* ============================================================
+	Function :		CDiagramTrace::Free
+	Description :	Frees all buffers.
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Call when the program exits, when no other
+					threads are left. Stops tracing.
+
+   ============================================================*/
+{
+
+	s_enabled = 0;
+	if (s_slot != FLS_OUT_OF_INDEXES)
+	{
+		::FlsFree(s_slot);
+		s_slot = FLS_OUT_OF_INDEXES;
+	}
+
+	while (s_buffers)
+	{
+		CBuffer* buffer = s_buffers;
+		s_buffers = buffer->next;
+		delete buffer;
+	}
+	s_threads = 0;
+
+	threadBuffer = TRACE_NO_BUFFER;
+
+}
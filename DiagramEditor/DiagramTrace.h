@@ -0,0 +1,92 @@
+#ifndef _CDIAGRAMTRACE_H_A3F60C2E_7B14_4E9D_8C51E27D09B46
+#define _CDIAGRAMTRACE_H_A3F60C2E_7B14_4E9D_8C51E27D09B46
+
+///////////////////////////////////////////////////////////
+// File :		DiagramTrace.h
+// Created :	10/19/26
+//
+
+#define TRACE_BUFFER_SIZE	16384	// Spans kept per buffer
+#define TRACE_MAX_THREADS	64		// Threads that can have a buffer at the same time
+
+class CDiagramTrace
+{
+public:
+	// Control
+	static void		Enable(BOOL enable);
+	static void		Free();
+	static BOOL		IsEnabled()
+	{
+		return s_enabled != 0;
+	}
+
+	// Recording
+	static void		Add(LPCTSTR name, LONGLONG start, LONGLONG end);
+	static LONGLONG	GetCounter()
+	{
+		LARGE_INTEGER counter;
+		::QueryPerformanceCounter(&counter);
+		return counter.QuadPart;
+	}
+
+	// Output
+	static BOOL		Save(const CString& filename);
+
+private:
+	// A finished span
+	struct CSpan
+	{
+		LPCTSTR		name;		// Static string, not copied
+		LONGLONG	start;		// Performance counter
+		LONGLONG	end;
+		DWORD		thread;		// Buffers are reused, so each span has its thread
+	};
+
+	// Ring buffer written by a single thread at a time
+	struct CBuffer
+	{
+		CSpan			spans[TRACE_BUFFER_SIZE];
+		volatile LONG	written;	// Spans ever written, the next goes to "written % TRACE_BUFFER_SIZE"
+		volatile LONG	used;		// 1 while a thread owns the buffer
+		CBuffer*		next;
+	};
+
+	static volatile LONG	s_enabled;
+	static LONGLONG			s_origin;	// Counter at "Enable", older spans are not saved
+	static CBuffer* volatile s_buffers;	// All buffers, newest first
+	static volatile LONG	s_threads;	// Number of buffers
+	static DWORD			s_slot;		// Fiber local storage index, to hear of threads exiting
+
+	static CBuffer*	GetBuffer();
+	static void WINAPI ReleaseBuffer(PVOID buffer);
+
+};
+
+// Times the enclosing scope when tracing is enabled
+class CDiagramTraceSpan
+{
+public:
+	CDiagramTraceSpan(LPCTSTR name)
+	{
+		m_name = CDiagramTrace::IsEnabled() ? name : NULL;
+		m_start = m_name ? CDiagramTrace::GetCounter() : 0;
+	}
+	~CDiagramTraceSpan()
+	{
+		if (m_name)
+			CDiagramTrace::Add(m_name, m_start, CDiagramTrace::GetCounter());
+	}
+
+private:
+	LPCTSTR		m_name;
+	LONGLONG	m_start;
+
+};
+
+#ifdef DIAGRAM_NO_TRACE
+#define DIAGRAM_TRACE_SPAN(name)
+#else
+#define DIAGRAM_TRACE_SPAN(name)	CDiagramTraceSpan diagramTraceSpan(name)
+#endif
+
+#endif //_CDIAGRAMTRACE_H_A3F60C2E_7B14_4E9D_8C51E27D09B46
@@ -0,0 +1,756 @@
+/* ==========================================================================
+	File :			DiagramVectorRenderer.cpp
+
+	Class :			CDiagramVectorRenderer
+
+	Date :			10/19/26
+
+	Purpose :		"CDiagramVectorRenderer" is the base class of the
+					renderers writing a vector file - SVG and PDF. It
+					keeps the pen, brush and font set by the entities,
+					lays out text, and buffers the output to the file.
+
+	Description :	Output goes through a fixed buffer of
+					"VECTOR_BUFFER_SIZE" bytes, so the memory used does
+					not grow with the size of the diagram. Derived
+					classes only keep tables of what they have already
+					written, such as styles and images, which grow
+					with the number of different styles rather than
+					the number of objects.
+
+					Text is measured with the widths of Helvetica, or
+					Courier for fixed pitch faces, which both formats
+					can use without embedding a font. Arial has the
+					same widths as Helvetica. Text is laid out with
+					"BreakLines" and each line passed to
+					"DrawTextLine".
+
+	Usage :			Derive, and implement the shape and text
+					functions writing the format with "Write" and
+					"WriteFormat". Call "OpenFile" before writing and
+					"CloseFile" when done.
+
+   ========================================================================*/
+
+#include "stdafx.h"
+#include "DiagramVectorRenderer.h"
+
+#ifdef _DEBUG
+#define new DEBUG_NEW
+#undef THIS_FILE
+static char THIS_FILE[] = __FILE__;
+#endif
+
+// Helvetica widths of the characters 32 - 126, in 1/1000 of the font size
+static const short helveticaWidths[] = {
+	278, 278, 355, 556, 556, 889, 667, 191, 333, 333, 389, 584, 278, 333, 278, 278,
+	556, 556, 556, 556, 556, 556, 556, 556, 556, 556, 278, 278, 584, 584, 584, 556,
+	1015, 667, 667, 722, 722, 667, 611, 778, 722, 278, 500, 667, 556, 833, 722, 778,
+	667, 778, 722, 667, 611, 722, 667, 944, 667, 667, 611, 278, 278, 278, 469, 556,
+	333, 556, 556, 500, 556, 556, 278, 556, 556, 222, 222, 500, 222, 833, 556, 556,
+	556, 556, 333, 500, 278, 556, 500, 722, 500, 500, 500, 334, 260, 334, 584
+};
+
+static const char base64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramVectorRenderer construction/destruction
+
+CDiagramVectorRenderer::CDiagramVectorRenderer()
+/* ============================================================
+	Function :		CDiagramVectorRenderer::CDiagramVectorRenderer
+	Description :	Constructor
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	m_penStyle = PS_SOLID;
+	m_penWidth = 1;
+	m_penColor = RGB(0, 0, 0);
+	m_fill = TRUE;
+	m_brushColor = RGB(255, 255, 255);
+	m_fontFace = _T("Arial");
+	m_fontHeight = 12;
+	m_fontWeight = FW_NORMAL;
+	m_fontItalic = FALSE;
+	m_fontUnderline = FALSE;
+	m_textColor = RGB(0, 0, 0);
+	m_bkColor = RGB(255, 255, 255);
+	m_bkMode = OPAQUE;
+
+	m_open = FALSE;
+	m_error = FALSE;
+	m_buffer = NULL;
+	m_used = 0;
+	m_written = 0;
+
+}
+
+CDiagramVectorRenderer::~CDiagramVectorRenderer()
+/* ============================================================
+	Function :		CDiagramVectorRenderer::~CDiagramVectorRenderer
+	Description :	Destructor
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Derived classes close their file, this
+					only closes it if they did not.
+
+   ============================================================*/
+{
+
+	if (m_open)
+		CloseFile();
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramVectorRenderer overrides
+
+void CDiagramVectorRenderer::SetPen(int style, int width, COLORREF color)
+/* ============================================================
+	Function :		CDiagramVectorRenderer::SetPen
+	Description :	Sets the pen for lines and outlines.
+	Access :		Public
+
+	Return :		void
+	Parameters :	int style		-	"PS_"-style.
+					int width		-	Width in pixels, 0 for
+										the thinnest line.
+					COLORREF color	-	Color of the pen.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	m_penStyle = style;
+	m_penWidth = max(width, 1);
+	m_penColor = color;
+
+}
+
+void CDiagramVectorRenderer::SetBrush(COLORREF color)
+/* ============================================================
+	Function :		CDiagramVectorRenderer::SetBrush
+	Description :	Sets a solid brush for filling shapes.
+	Access :		Public
+
+	Return :		void
+	Parameters :	COLORREF color	-	Color of the brush.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	m_fill = TRUE;
+	m_brushColor = color;
+
+}
+
+void CDiagramVectorRenderer::SetNullBrush()
+/* ============================================================
+	Function :		CDiagramVectorRenderer::SetNullBrush
+	Description :	Stops filling shapes.
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	m_fill = FALSE;
+
+}
+
+void CDiagramVectorRenderer::SetFont(LPCTSTR face, int height, int weight, BOOL italic, BOOL underline)
+/* ============================================================
+	Function :		CDiagramVectorRenderer::SetFont
+	Description :	Sets the font for text.
+	Access :		Public
+
+	Return :		void
+	Parameters :	LPCTSTR face	-	Font face name.
+					int height		-	Height, as for
+										"CreateFont".
+					int weight		-	Weight of the font.
+					BOOL italic		-	"TRUE" for italic.
+					BOOL underline	-	"TRUE" for underlined.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	m_fontFace = face;
+	m_fontHeight = max(abs(height), 1);
+	m_fontWeight = weight;
+	m_fontItalic = italic;
+	m_fontUnderline = underline;
+
+}
+
+void CDiagramVectorRenderer::SetTextColor(COLORREF color)
+/* ============================================================
+	Function :		CDiagramVectorRenderer::SetTextColor
+	Description :	Sets the color of text.
+	Access :		Public
+
+	Return :		void
+	Parameters :	COLORREF color	-	Text color.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	m_textColor = color;
+
+}
+
+void CDiagramVectorRenderer::SetBkColor(COLORREF color)
+/* ============================================================
+	Function :		CDiagramVectorRenderer::SetBkColor
+	Description :	Sets the background color of text.
+	Access :		Public
+
+	Return :		void
+	Parameters :	COLORREF color	-	Background color.
+
+	Usage :			Only used if the background mode is
+					"OPAQUE".
+
+   ============================================================*/
+{
+
+	m_bkColor = color;
+
+}
+
+void CDiagramVectorRenderer::SetBkMode(int mode)
+/* ============================================================
+	Function :		CDiagramVectorRenderer::SetBkMode
+	Description :	Sets if text backgrounds are filled.
+	Access :		Public
+
+	Return :		void
+	Parameters :	int mode	-	"OPAQUE" or "TRANSPARENT".
+
+	Usage :
+
+   ============================================================*/
+{
+
+	m_bkMode = mode;
+
+}
+
+void CDiagramVectorRenderer::DrawText(const CString& text, const CRect& rect, UINT format)
+/* ============================================================
+	Function :		CDiagramVectorRenderer::DrawText
+	Description :	Lays out text in a rectangle.
+	Access :		Public
+
+	Return :		void
+	Parameters :	const CString& text	-	Text to draw.
+					const CRect& rect	-	Rectangle to draw in.
+					UINT format			-	"DT_"-flags.
+
+	Usage :			Supports "DT_SINGLELINE", "DT_WORDBREAK",
+					"DT_CENTER", "DT_RIGHT", "DT_VCENTER" and
+					"DT_BOTTOM". Each line is passed to
+					"DrawTextLine" with the rectangle it covers.
+					Text is not clipped to "rect", as the
+					widths are those of the standard fonts
+					rather than the fonts the viewer uses.
+
+   ============================================================*/
+{
+
+	CStringArray lines;
+	BreakLines(text, rect.Width(), format, lines);
+
+	int height = GetTextExtent(CString()).cy;
+	int y = rect.top;
+	if (format & DT_SINGLELINE)
+	{
+		if (format & DT_VCENTER)
+			y = rect.top + (rect.Height() - height) / 2;
+		else if (format & DT_BOTTOM)
+			y = rect.bottom - height;
+	}
+
+	INT_PTR count = lines.GetSize();
+	for (INT_PTR t = 0; t < count; t++)
+	{
+		int width = GetTextExtent(lines[t]).cx;
+		int x = rect.left;
+		if (format & DT_CENTER)
+			x = rect.left + (rect.Width() - width) / 2;
+		else if (format & DT_RIGHT)
+			x = rect.right - width;
+
+		if (lines[t].GetLength())
+			DrawTextLine(lines[t], CRect(x, y, x + width, y + height), format);
+		y += height;
+	}
+
+}
+
+CSize CDiagramVectorRenderer::GetTextExtent(const CString& text)
+/* ============================================================
+	Function :		CDiagramVectorRenderer::GetTextExtent
+	Description :	Measures a line of text.
+	Access :		Public
+
+	Return :		CSize				-	Width and height.
+	Parameters :	const CString& text	-	Text to measure.
+
+	Usage :			Uses the widths of Helvetica, or Courier
+					for fixed pitch faces. Bold text is taken
+					as five percent wider.
+
+   ============================================================*/
+{
+
+	int units = 0;
+	int length = text.GetLength();
+	if (IsFixedPitch())
+		units = length * 600;
+	else
+	{
+		for (int t = 0; t < length; t++)
+		{
+			TCHAR c = text[t];
+			if (c >= 32 && c <= 126)
+				units += helveticaWidths[c - 32];
+			else
+				units += 556;
+		}
+
+		if (IsBold())
+			units += units / 20;
+	}
+
+	int width = static_cast<int>(static_cast<double>(units) * m_fontHeight / 1000 + .5);
+	int height = static_cast<int>(m_fontHeight * 1.15 + .5);
+	return CSize(width, height);
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramVectorRenderer attributes
+
+BOOL CDiagramVectorRenderer::IsOpen() const
+/* ============================================================
+	Function :		CDiagramVectorRenderer::IsOpen
+	Description :	Checks if a file is being written.
+	Access :		Public
+
+	Return :		BOOL	-	"TRUE" between "OpenFile" and
+								"CloseFile".
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	return m_open;
+
+}
+
+DWORD CDiagramVectorRenderer::GetBytesWritten() const
+/* ============================================================
+	Function :		CDiagramVectorRenderer::GetBytesWritten
+	Description :	Gets the size of the output so far.
+	Access :		Public
+
+	Return :		DWORD	-	Bytes, including those still
+								in the buffer.
+	Parameters :	none
+
+	Usage :			The offset of the next byte written.
+
+   ============================================================*/
+{
+
+	return m_written;
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramVectorRenderer text
+
+BOOL CDiagramVectorRenderer::IsFixedPitch() const
+/* ============================================================
+	Function :		CDiagramVectorRenderer::IsFixedPitch
+	Description :	Checks if the font is fixed pitch.
+	Access :		Protected
+
+	Return :		BOOL	-	"TRUE" for Courier and similar
+								faces.
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	CString face(m_fontFace);
+	face.MakeLower();
+	return face.Find(_T("courier")) != -1 ||
+		face.Find(_T("mono")) != -1 ||
+		face.Find(_T("console")) != -1 ||
+		face == _T("fixedsys") ||
+		face == _T("terminal");
+
+}
+
+BOOL CDiagramVectorRenderer::IsBold() const
+/* ============================================================
+	Function :		CDiagramVectorRenderer::IsBold
+	Description :	Checks if the font is bold.
+	Access :		Protected
+
+	Return :		BOOL	-	"TRUE" for "FW_BOLD" or
+								heavier.
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	return m_fontWeight >= FW_BOLD;
+
+}
+
+BOOL CDiagramVectorRenderer::IsItalic() const
+/* ============================================================
+	Function :		CDiagramVectorRenderer::IsItalic
+	Description :	Checks if the font is italic.
+	Access :		Protected
+
+	Return :		BOOL	-	"TRUE" if italic.
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	return m_fontItalic;
+
+}
+
+BOOL CDiagramVectorRenderer::IsUnderline() const
+/* ============================================================
+	Function :		CDiagramVectorRenderer::IsUnderline
+	Description :	Checks if the font is underlined.
+	Access :		Protected
+
+	Return :		BOOL	-	"TRUE" if underlined.
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	return m_fontUnderline;
+
+}
+
+int CDiagramVectorRenderer::GetAscent() const
+/* ============================================================
+	Function :		CDiagramVectorRenderer::GetAscent
+	Description :	Gets the distance from the top of a line
+					of text to the baseline.
+	Access :		Protected
+
+	Return :		int		-	Distance in pixels.
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	return static_cast<int>(m_fontHeight * .9 + .5);
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramVectorRenderer file
+
+BOOL CDiagramVectorRenderer::OpenFile(const CString& filename)
+/* ============================================================
+	Function :		CDiagramVectorRenderer::OpenFile
+	Description :	Creates the output file.
+	Access :		Protected
+
+	Return :		BOOL					-	"TRUE" if the
+												file was created.
+	Parameters :	const CString& filename	-	File to create.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	if (m_open)
+		return FALSE;
+
+	if (!m_file.Open(filename, CFile::modeCreate | CFile::modeWrite))
+		return FALSE;
+
+	m_buffer = new BYTE[VECTOR_BUFFER_SIZE];
+	m_used = 0;
+	m_written = 0;
+	m_error = FALSE;
+	m_open = TRUE;
+
+	return TRUE;
+
+}
+
+BOOL CDiagramVectorRenderer::CloseFile()
+/* ============================================================
+	Function :		CDiagramVectorRenderer::CloseFile
+	Description :	Writes what is buffered and closes the
+					file.
+	Access :		Protected
+
+	Return :		BOOL	-	"FALSE" if anything could not
+								be written.
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	if (!m_open)
+		return FALSE;
+
+	Flush();
+	TRY
+	{
+		m_file.Close();
+	}
+	CATCH_ALL(e)
+	{
+		e->Delete();
+		m_error = TRUE;
+	}
+	END_CATCH_ALL
+
+	delete[] m_buffer;
+	m_buffer = NULL;
+	m_open = FALSE;
+
+	return !m_error;
+
+}
+
+void CDiagramVectorRenderer::Write(LPCSTR text)
+/* ============================================================
+	Function :		CDiagramVectorRenderer::Write
+	Description :	Writes a string.
+	Access :		Protected
+
+	Return :		void
+	Parameters :	LPCSTR text	-	Bytes to write, up to the
+									terminating zero.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	Write(reinterpret_cast<const BYTE*>(text), static_cast<int>(strlen(text)));
+
+}
+
+void CDiagramVectorRenderer::Write(const BYTE* data, int size)
+/* ============================================================
+	Function :		CDiagramVectorRenderer::Write
+	Description :	Writes bytes.
+	Access :		Protected
+
+	Return :		void
+	Parameters :	const BYTE* data	-	Bytes to write.
+					int size			-	Number of bytes.
+
+	Usage :			Ignored if the file is not open.
+
+   ============================================================*/
+{
+
+	if (!m_open)
+		return;
+
+	m_written += size;
+	while (size)
+	{
+		int count = min(size, VECTOR_BUFFER_SIZE - m_used);
+		memcpy(m_buffer + m_used, data, count);
+		m_used += count;
+		data += count;
+		size -= count;
+		if (m_used == VECTOR_BUFFER_SIZE)
+			Flush();
+	}
+
+}
+
+void CDiagramVectorRenderer::WriteFormat(LPCSTR format, ...)
+/* ============================================================
+	Function :		CDiagramVectorRenderer::WriteFormat
+	Description :	Writes formatted text.
+	Access :		Protected
+
+	Return :		void
+	Parameters :	LPCSTR format	-	"printf"-format.
+					...				-	Values.
+
+	Usage :			The result is truncated to 512 bytes, so
+					strings from the diagram should be written
+					with "Write".
+
+   ============================================================*/
+{
+
+	char buffer[512];
+	va_list args;
+	va_start(args, format);
+	_vsnprintf_s(buffer, sizeof(buffer), _TRUNCATE, format, args);
+	va_end(args);
+
+	Write(buffer);
+
+}
+
+void CDiagramVectorRenderer::WriteBase64(const BYTE* data, int size)
+/* ============================================================
+	Function :		CDiagramVectorRenderer::WriteBase64
+	Description :	Writes bytes encoded as base64.
+	Access :		Protected
+
+	Return :		void
+	Parameters :	const BYTE* data	-	Bytes to encode.
+					int size			-	Number of bytes.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	for (int t = 0; t < size; t += 3)
+	{
+		DWORD value = static_cast<DWORD>(data[t]) << 16;
+		if (t + 1 < size)
+			value |= static_cast<DWORD>(data[t + 1]) << 8;
+		if (t + 2 < size)
+			value |= data[t + 2];
+
+		BYTE out[4];
+		out[0] = base64[(value >> 18) & 63];
+		out[1] = base64[(value >> 12) & 63];
+		out[2] = static_cast<BYTE>(t + 1 < size ? base64[(value >> 6) & 63] : '=');
+		out[3] = static_cast<BYTE>(t + 2 < size ? base64[value & 63] : '=');
+		Write(out, 4);
+	}
+
+}
+
+void CDiagramVectorRenderer::Encode(const CString& text, UINT codepage, CByteArray& bytes)
+/* ============================================================
+	Function :		CDiagramVectorRenderer::Encode
+	Description :	Converts text to a code page.
+	Access :		Protected
+
+	Return :		void
+	Parameters :	const CString& text	-	Text to convert.
+					UINT codepage		-	"CP_UTF8" or a
+											Windows code page.
+					CByteArray& bytes	-	Gets the bytes,
+											without a
+											terminating zero.
+
+	Usage :			Characters missing from "codepage" are
+					replaced by the default character.
+
+   ============================================================*/
+{
+
+	bytes.RemoveAll();
+	if (text.IsEmpty())
+		return;
+
+#ifdef _UNICODE
+	LPCWSTR wide = text;
+	int length = text.GetLength();
+#else
+	int length = ::MultiByteToWideChar(CP_ACP, 0, text, text.GetLength(), NULL, 0);
+	CArray< WCHAR, WCHAR > buffer;
+	buffer.SetSize(length);
+	::MultiByteToWideChar(CP_ACP, 0, text, text.GetLength(), buffer.GetData(), length);
+	LPCWSTR wide = buffer.GetData();
+#endif
+
+	int size = ::WideCharToMultiByte(codepage, 0, wide, length, NULL, 0, NULL, NULL);
+	bytes.SetSize(size);
+	if (size)
+		::WideCharToMultiByte(codepage, 0, wide, length, reinterpret_cast<LPSTR>(bytes.GetData()), size, NULL, NULL);
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CDiagramVectorRenderer private helpers
+
+void CDiagramVectorRenderer::Flush()
+/* ============================================================
+	Function :		CDiagramVectorRenderer::Flush
+	Description :	Writes the buffer to the file.
+	Access :		Private
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Later writes are dropped once writing has
+					failed, and "CloseFile" returns "FALSE".
+
+   ============================================================*/
+{
+
+	if (m_used && !m_error)
+	{
+		TRY
+		{
+			m_file.Write(m_buffer, m_used);
+		}
+		CATCH_ALL(e)
+		{
+			e->Delete();
+			m_error = TRUE;
+		}
+		END_CATCH_ALL
+	}
+
+	m_used = 0;
+
+}
@@ -0,0 +1,85 @@
+#ifndef _CDIAGRAMVECTORRENDERER_H_5C38E0B7_91D4_4A62_B7E02F64C1D95
+#define _CDIAGRAMVECTORRENDERER_H_5C38E0B7_91D4_4A62_B7E02F64C1D95
+
+///////////////////////////////////////////////////////////
+// File :		DiagramVectorRenderer.h
+// Created :	10/19/26
+//
+
+#include "DiagramRenderer.h"
+
+#define VECTOR_BUFFER_SIZE	65536	// Bytes buffered before writing to the file
+
+// Base class for renderers streaming a vector format to a file
+class CDiagramVectorRenderer : public CDiagramRenderer
+{
+public:
+	// Construction/destruction
+	CDiagramVectorRenderer();
+	virtual ~CDiagramVectorRenderer();
+
+	// Overrides
+	virtual void	SetPen(int style, int width, COLORREF color);
+	virtual void	SetBrush(COLORREF color);
+	virtual void	SetNullBrush();
+	virtual void	SetFont(LPCTSTR face, int height, int weight = FW_NORMAL, BOOL italic = FALSE, BOOL underline = FALSE);
+	virtual void	SetTextColor(COLORREF color);
+	virtual void	SetBkColor(COLORREF color);
+	virtual void	SetBkMode(int mode);
+
+	virtual void	DrawText(const CString& text, const CRect& rect, UINT format);
+	virtual CSize	GetTextExtent(const CString& text);
+
+	// Attributes
+	BOOL			IsOpen() const;
+	DWORD			GetBytesWritten() const;
+
+protected:
+	// Drawing state
+	int			m_penStyle;
+	int			m_penWidth;
+	COLORREF	m_penColor;
+	BOOL		m_fill;
+	COLORREF	m_brushColor;
+	CString		m_fontFace;
+	int			m_fontHeight;
+	int			m_fontWeight;
+	BOOL		m_fontItalic;
+	BOOL		m_fontUnderline;
+	COLORREF	m_textColor;
+	COLORREF	m_bkColor;
+	int			m_bkMode;
+
+	// Text
+	virtual void	DrawTextLine(const CString& line, const CRect& rect, UINT format) = 0;
+	BOOL			IsFixedPitch() const;
+	BOOL			IsBold() const;
+	BOOL			IsItalic() const;
+	BOOL			IsUnderline() const;
+	int				GetAscent() const;
+
+	// File
+	BOOL			OpenFile(const CString& filename);
+	BOOL			CloseFile();
+	void			Write(LPCSTR text);
+	void			Write(const BYTE* data, int size);
+	void			WriteFormat(LPCSTR format, ...);
+	void			WriteBase64(const BYTE* data, int size);
+
+	static void		Encode(const CString& text, UINT codepage, CByteArray& bytes);
+
+private:
+	// Data
+	CFile		m_file;
+	BOOL		m_open;
+	BOOL		m_error;
+	BYTE*		m_buffer;
+	int			m_used;			// Bytes in "m_buffer"
+	DWORD		m_written;		// Bytes written, including "m_buffer"
+
+	// Helpers
+	void		Flush();
+
+};
+
+#endif //_CDIAGRAMVECTORRENDERER_H_5C38E0B7_91D4_4A62_B7E02F64C1D95
@@ -0,0 +1,900 @@
+/* ==========================================================================
+	File :			ForceLayout.cpp
+
+	Class :			CForceLayout
+
+	Date :			10/19/26
+
+	Purpose :		"CForceLayout" is a force-directed layout for
+					undirected graphs, such as network diagrams.
+
+	Description :	Nodes push each other away, and edges pull their nodes
+					together, as in Fruchterman and Reingold's method.
+					The nodes are moved along the forces, with a step
+					limit that shrinks every iteration, until no node
+					moves more than half a pixel.
+
+					The push between all pairs of nodes would take
+					quadratic time. Instead, the nodes are put in a
+					quadtree every iteration, and a cell far enough away
+					from a node pushes it as a single mass at its center
+					(the Barnes-Hut approximation). Each iteration takes
+					O(n log n) time.
+
+					The forces on different nodes are independent, so
+					they are calculated by a set of worker threads, each
+					taking a fixed range of nodes. The result does not
+					depend on the number of threads.
+
+					Pinned nodes push and pull the others, but never
+					move. A weak pull towards the center keeps
+					unconnected parts of the graph together.
+
+					The time of each iteration is recorded.
+
+	Usage :			Add nodes and edges, call "Layout", then get the
+					positions with "GetNodePosition".
+
+   ========================================================================*/
+
+#include "stdafx.h"
+#include "ForceLayout.h"
+#include "DiagramTrace.h"
+
+#include <math.h>
+
+#ifdef _DEBUG
+#define new DEBUG_NEW
+#undef THIS_FILE
+static char THIS_FILE[] = __FILE__;
+#endif
+
+#define THETA				0.9		// Cell size to distance ratio for the approximation
+#define MAX_DEPTH			48		// Deepest quadtree level, nodes closer than this share a leaf
+#define COOLING				0.95	// Step limit factor per iteration
+#define MIN_MOVE			0.5		// Largest move of a converged layout
+#define GRAVITY				0.1		// Pull towards the center
+#define MAX_THREADS			8		// Maximum number of worker threads
+#define MIN_THREADED_SIZE	500		// Smallest graph worth several threads
+
+// Sort key for finding nodes in the same place
+struct FORCE_KEY
+{
+	double	x;
+	double	y;
+	int		index;
+};
+
+static int CompareForceKeys(const void* p1, const void* p2)
+{
+	const FORCE_KEY* k1 = static_cast<const FORCE_KEY*>(p1);
+	const FORCE_KEY* k2 = static_cast<const FORCE_KEY*>(p2);
+	if (k1->x < k2->x)
+		return -1;
+	if (k1->x > k2->x)
+		return 1;
+	if (k1->y < k2->y)
+		return -1;
+	if (k1->y > k2->y)
+		return 1;
+	return k1->index - k2->index;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CForceLayout construction/destruction
+
+CForceLayout::CForceLayout()
+/* ============================================================
+	Function :		CForceLayout::CForceLayout
+	Description :	Constructor
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	m_spacing = 32;
+	m_maxIterations = 500;
+	m_threads = 0;
+	m_k = 1;
+	m_centerx = 0;
+	m_centery = 0;
+	m_quit = 0;
+
+}
+
+CForceLayout::~CForceLayout()
+/* ============================================================
+	Function :		CForceLayout::~CForceLayout
+	Description :	Destructor
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CForceLayout input
+
+void CForceLayout::Clear()
+/* ============================================================
+	Function :		CForceLayout::Clear
+	Description :	Removes all nodes and edges.
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Call to reuse the object for another graph.
+
+   ============================================================*/
+{
+
+	m_x.RemoveAll();
+	m_y.RemoveAll();
+	m_width.RemoveAll();
+	m_height.RemoveAll();
+	m_pinned.RemoveAll();
+	m_from.RemoveAll();
+	m_to.RemoveAll();
+	m_times.RemoveAll();
+
+}
+
+int CForceLayout::AddNode(double x, double y, double width, double height, BOOL pinned)
+/* ============================================================
+	Function :		CForceLayout::AddNode
+	Description :	Adds a node to the graph.
+	Access :		Public
+
+	Return :		int				-	Index of the new node.
+	Parameters :	double x		-	Left edge of the node.
+					double y		-	Top edge of the node.
+					double width	-	Width of the node.
+					double height	-	Height of the node.
+					BOOL pinned		-	"TRUE" if the node should
+										stay where it is.
+
+	Usage :			The current position is the starting
+					point, so a layout of an already arranged
+					graph only makes small changes.
+
+   ============================================================*/
+{
+
+	m_x.Add(x + width / 2);
+	m_y.Add(y + height / 2);
+	m_width.Add(width);
+	m_height.Add(height);
+	return static_cast<int>(m_pinned.Add(pinned));
+
+}
+
+int CForceLayout::AddEdge(int node1, int node2)
+/* ============================================================
+	Function :		CForceLayout::AddEdge
+	Description :	Adds an edge to the graph.
+	Access :		Public
+
+	Return :		int			-	Index of the new edge, -1 if
+									a node index is invalid.
+	Parameters :	int node1	-	First node.
+					int node2	-	Second node.
+
+	Usage :			Edges have no direction.
+
+   ============================================================*/
+{
+
+	int nodes = static_cast<int>(m_x.GetSize());
+	if (node1 < 0 || node1 >= nodes || node2 < 0 || node2 >= nodes || node1 == node2)
+		return -1;
+
+	m_from.Add(node1);
+	return static_cast<int>(m_to.Add(node2));
+
+}
+
+void CForceLayout::SetSpacing(double spacing)
+/* ============================================================
+	Function :		CForceLayout::SetSpacing
+	Description :	Sets the wanted space between linked nodes.
+	Access :		Public
+
+	Return :		void
+	Parameters :	double spacing	-	Space between the nodes.
+
+	Usage :			The ideal edge length is the average node
+					size plus "spacing".
+
+   ============================================================*/
+{
+
+	m_spacing = max(spacing, 1.0);
+
+}
+
+void CForceLayout::SetMaxIterations(int iterations)
+/* ============================================================
+	Function :		CForceLayout::SetMaxIterations
+	Description :	Sets the maximum number of iterations.
+	Access :		Public
+
+	Return :		void
+	Parameters :	int iterations	-	Maximum number of
+										iterations.
+
+	Usage :			The layout normally stops earlier, when
+					the nodes no longer move.
+
+   ============================================================*/
+{
+
+	m_maxIterations = max(iterations, 1);
+
+}
+
+void CForceLayout::SetThreadCount(int threads)
+/* ============================================================
+	Function :		CForceLayout::SetThreadCount
+	Description :	Sets the number of threads calculating
+					forces.
+	Access :		Public
+
+	Return :		void
+	Parameters :	int threads	-	Number of threads, 0 to use
+									one per processor.
+
+	Usage :			Small graphs always use a single thread.
+
+   ============================================================*/
+{
+
+	m_threads = max(threads, 0);
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CForceLayout operations
+
+void CForceLayout::Layout()
+/* ============================================================
+	Function :		CForceLayout::Layout
+	Description :	Moves the nodes until the forces are in
+					balance.
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Call after adding all nodes and edges.
+
+   ============================================================*/
+{
+
+	DIAGRAM_TRACE_SPAN(_T("CForceLayout::Layout"));
+
+	m_times.RemoveAll();
+	int count = static_cast<int>(m_x.GetSize());
+	if (count == 0)
+		return;
+
+	// Ideal distance, and the starting step limit
+	double size = 0;
+	double left = m_x[0];
+	double right = m_x[0];
+	double top = m_y[0];
+	double bottom = m_y[0];
+	BOOL pinned = FALSE;
+	m_centerx = 0;
+	m_centery = 0;
+	for (int t = 0; t < count; t++)
+	{
+		size += max(m_width[t], m_height[t]);
+		left = min(left, m_x[t]);
+		right = max(right, m_x[t]);
+		top = min(top, m_y[t]);
+		bottom = max(bottom, m_y[t]);
+		m_centerx += m_x[t];
+		m_centery += m_y[t];
+		if (m_pinned[t])
+			pinned = TRUE;
+	}
+	m_k = size / count + m_spacing;
+	m_centerx /= count;
+	m_centery /= count;
+
+	double temperature = pinned ? 2 * m_k : max(m_k, max(right - left, bottom - top) / 10);
+
+	BuildAdjacency();
+	SeparateCoincident();
+	m_fx.SetSize(count);
+	m_fy.SetSize(count);
+
+	// Workers for all but the first range, which is
+	// calculated on this thread
+	int threads = m_threads;
+	if (threads == 0)
+	{
+		SYSTEM_INFO info;
+		::GetSystemInfo(&info);
+		threads = min(static_cast<int>(info.dwNumberOfProcessors), MAX_THREADS);
+	}
+	if (count < MIN_THREADED_SIZE || threads < 1)
+		threads = 1;
+
+	CWorker* workers = new CWorker[threads];
+	HANDLE* done = new HANDLE[threads];
+	int running = 0;
+	m_quit = 0;
+	for (int t = 0; t < threads; t++)
+	{
+		workers[t].layout = this;
+		workers[t].first = static_cast<int>((static_cast<LONGLONG>(count) * t) / threads);
+		workers[t].last = static_cast<int>((static_cast<LONGLONG>(count) * (t + 1)) / threads);
+		workers[t].start = NULL;
+		workers[t].done = NULL;
+		workers[t].thread = NULL;
+		if (t > 0)
+		{
+			workers[t].start = ::CreateEvent(NULL, FALSE, FALSE, NULL);
+			workers[t].done = ::CreateEvent(NULL, FALSE, FALSE, NULL);
+			workers[t].thread = AfxBeginThread(WorkerProc, &workers[t], THREAD_PRIORITY_NORMAL, 0, CREATE_SUSPENDED);
+			if (workers[t].thread)
+			{
+				workers[t].thread->m_bAutoDelete = FALSE;
+				workers[t].thread->ResumeThread();
+				done[running++] = workers[t].done;
+			}
+		}
+	}
+
+	LARGE_INTEGER frequency;
+	::QueryPerformanceFrequency(&frequency);
+
+	for (int iteration = 0; iteration < m_maxIterations; iteration++)
+	{
+		LARGE_INTEGER start;
+		::QueryPerformanceCounter(&start);
+
+		BuildTree();
+
+		for (int t = 1; t < threads; t++)
+			if (workers[t].thread)
+				::SetEvent(workers[t].start);
+		CalcForces(workers[0].first, workers[0].last);
+		for (int t = 1; t < threads; t++)
+			if (!workers[t].thread)
+				CalcForces(workers[t].first, workers[t].last);
+		if (running)
+			::WaitForMultipleObjects(running, done, TRUE, INFINITE);
+
+		// Move along the forces, at most "temperature"
+		double maxMove = 0;
+		for (int t = 0; t < count; t++)
+		{
+			if (m_pinned[t])
+				continue;
+
+			double length = sqrt(m_fx[t] * m_fx[t] + m_fy[t] * m_fy[t]);
+			if (length > 0)
+			{
+				double move = min(length, temperature);
+				m_x[t] += m_fx[t] / length * move;
+				m_y[t] += m_fy[t] / length * move;
+				maxMove = max(maxMove, move);
+			}
+		}
+		temperature *= COOLING;
+
+		LARGE_INTEGER end;
+		::QueryPerformanceCounter(&end);
+		m_times.Add(static_cast<double>(end.QuadPart - start.QuadPart) * 1000.0 / static_cast<double>(frequency.QuadPart));
+
+		if (maxMove < MIN_MOVE)
+			break;
+	}
+
+	// Stop the workers
+	::InterlockedExchange(&m_quit, 1);
+	for (int t = 1; t < threads; t++)
+	{
+		if (workers[t].thread)
+		{
+			::SetEvent(workers[t].start);
+			::WaitForSingleObject(workers[t].thread->m_hThread, INFINITE);
+			delete workers[t].thread;
+		}
+		if (workers[t].start)
+			::CloseHandle(workers[t].start);
+		if (workers[t].done)
+			::CloseHandle(workers[t].done);
+	}
+
+	delete[] done;
+	delete[] workers;
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CForceLayout results
+
+CPoint CForceLayout::GetNodePosition(int node) const
+/* ============================================================
+	Function :		CForceLayout::GetNodePosition
+	Description :	Gets the position of a node.
+	Access :		Public
+
+	Return :		CPoint		-	Top-left corner of the node.
+	Parameters :	int node	-	Index of the node.
+
+	Usage :			Call after "Layout".
+
+   ============================================================*/
+{
+
+	if (node < 0 || node >= m_x.GetSize())
+		return CPoint(0, 0);
+
+	return CPoint(static_cast<int>(floor(m_x[node] - m_width[node] / 2 + 0.5)), static_cast<int>(floor(m_y[node] - m_height[node] / 2 + 0.5)));
+
+}
+
+int CForceLayout::GetIterationCount() const
+/* ============================================================
+	Function :		CForceLayout::GetIterationCount
+	Description :	Gets the number of iterations the last
+					layout needed.
+	Access :		Public
+
+	Return :		int	-	Number of iterations.
+	Parameters :	none
+
+	Usage :			Call after "Layout".
+
+   ============================================================*/
+{
+
+	return static_cast<int>(m_times.GetSize());
+
+}
+
+double CForceLayout::GetIterationTime(int iteration) const
+/* ============================================================
+	Function :		CForceLayout::GetIterationTime
+	Description :	Gets the time of an iteration.
+	Access :		Public
+
+	Return :		double			-	Time in milliseconds.
+	Parameters :	int iteration	-	Iteration.
+
+	Usage :			Call after "Layout" to profile the layout.
+					The time includes building the quadtree,
+					calculating the forces and moving the nodes.
+
+   ============================================================*/
+{
+
+	if (iteration < 0 || iteration >= m_times.GetSize())
+		return 0;
+
+	return m_times[iteration];
+
+}
+
+double CForceLayout::GetTotalTime() const
+/* ============================================================
+	Function :		CForceLayout::GetTotalTime
+	Description :	Gets the time of all iterations.
+	Access :		Public
+
+	Return :		double	-	Time in milliseconds.
+	Parameters :	none
+
+	Usage :			Call after "Layout".
+
+   ============================================================*/
+{
+
+	double total = 0;
+	INT_PTR max = m_times.GetSize();
+	for (INT_PTR t = 0; t < max; t++)
+		total += m_times[t];
+
+	return total;
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CForceLayout helpers
+
+void CForceLayout::BuildAdjacency()
+/* ============================================================
+	Function :		CForceLayout::BuildAdjacency
+	Description :	Builds the neighbour lists of the nodes.
+	Access :		Private
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Called from "Layout". With a list per
+					node, the pull of the edges can be
+					calculated per node, on the worker
+					threads.
+
+   ============================================================*/
+{
+
+	int nodes = static_cast<int>(m_x.GetSize());
+	int edges = static_cast<int>(m_from.GetSize());
+
+	m_adjacentStart.SetSize(nodes + 1);
+	m_adjacent.SetSize(edges * 2);
+	for (int t = 0; t <= nodes; t++)
+		m_adjacentStart[t] = 0;
+	for (int t = 0; t < edges; t++)
+	{
+		m_adjacentStart[m_from[t] + 1]++;
+		m_adjacentStart[m_to[t] + 1]++;
+	}
+	for (int t = 0; t < nodes; t++)
+		m_adjacentStart[t + 1] += m_adjacentStart[t];
+
+	CArray< int, int > next;
+	next.Copy(m_adjacentStart);
+	for (int t = 0; t < edges; t++)
+	{
+		m_adjacent[next[m_from[t]]++] = m_to[t];
+		m_adjacent[next[m_to[t]]++] = m_from[t];
+	}
+
+}
+
+void CForceLayout::SeparateCoincident()
+/* ============================================================
+	Function :		CForceLayout::SeparateCoincident
+	Description :	Spreads nodes sharing a position.
+	Access :		Private
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Called from "Layout". Nodes in the same
+					place have no direction to push each other
+					in, which typically happens to nodes
+					imported without positions. They are put
+					on a spiral around the first of them.
+
+   ============================================================*/
+{
+
+	int count = static_cast<int>(m_x.GetSize());
+	CArray< FORCE_KEY, FORCE_KEY& > keys;
+	keys.SetSize(count);
+	for (int t = 0; t < count; t++)
+	{
+		keys[t].x = m_x[t];
+		keys[t].y = m_y[t];
+		keys[t].index = t;
+	}
+	qsort(keys.GetData(), count, sizeof(FORCE_KEY), CompareForceKeys);
+
+	int same = 0;
+	for (int t = 1; t < count; t++)
+	{
+		if (keys[t].x == keys[t - 1].x && keys[t].y == keys[t - 1].y)
+		{
+			same++;
+			int node = keys[t].index;
+			if (!m_pinned[node])
+			{
+				double angle = same * 2.39996323;
+				double radius = m_k * sqrt(static_cast<double>(same));
+				m_x[node] += radius * cos(angle);
+				m_y[node] += radius * sin(angle);
+			}
+		}
+		else
+			same = 0;
+	}
+
+}
+
+void CForceLayout::BuildTree()
+/* ============================================================
+	Function :		CForceLayout::BuildTree
+	Description :	Puts the nodes in a quadtree.
+	Access :		Private
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Called at the start of every iteration.
+
+   ============================================================*/
+{
+
+	int count = static_cast<int>(m_x.GetSize());
+	double left = m_x[0];
+	double right = m_x[0];
+	double top = m_y[0];
+	double bottom = m_y[0];
+	for (int t = 1; t < count; t++)
+	{
+		left = min(left, m_x[t]);
+		right = max(right, m_x[t]);
+		top = min(top, m_y[t]);
+		bottom = max(bottom, m_y[t]);
+	}
+
+	m_cells.SetSize(0, count * 2 + 1);
+	m_next.SetSize(count);
+	AddCell((left + right) / 2, (top + bottom) / 2, max(max(right - left, bottom - top) / 2, 1.0) * 1.0001);
+
+	for (int t = 0; t < count; t++)
+		Insert(t);
+
+}
+
+void CForceLayout::Insert(int node)
+/* ============================================================
+	Function :		CForceLayout::Insert
+	Description :	Adds a node to the quadtree.
+	Access :		Private
+
+	Return :		void
+	Parameters :	int node	-	Node to add.
+
+	Usage :			Called from "BuildTree". A leaf holding
+					another node is split until the nodes are
+					in different leaves. At "MAX_DEPTH", the
+					nodes share the leaf instead.
+
+   ============================================================*/
+{
+
+	double x = m_x[node];
+	double y = m_y[node];
+	int cell = 0;
+	int depth = 0;
+
+	m_next[node] = -1;
+	m_cells[cell].mass += 1;
+	m_cells[cell].sumx += x;
+	m_cells[cell].sumy += y;
+
+	for (;;)
+	{
+		CCell& current = m_cells[cell];
+		BOOL leaf = (current.child[0] == -1 && current.child[1] == -1 && current.child[2] == -1 && current.child[3] == -1);
+		if (leaf)
+		{
+			if (current.body == -1)
+			{
+				current.body = node;
+				return;
+			}
+
+			if (depth >= MAX_DEPTH)
+			{
+				m_next[node] = current.body;
+				current.body = node;
+				return;
+			}
+
+			// Split, moving the node already here down a level
+			int other = current.body;
+			double half = current.half / 2;
+			double cx = current.x + (m_x[other] >= current.x ? half : -half);
+			double cy = current.y + (m_y[other] >= current.y ? half : -half);
+			int quadrant = (m_x[other] >= current.x ? 1 : 0) + (m_y[other] >= current.y ? 2 : 0);
+			current.body = -1;
+
+			int child = AddCell(cx, cy, half);
+			m_cells[child].body = other;
+			m_cells[child].mass = 1;
+			m_cells[child].sumx = m_x[other];
+			m_cells[child].sumy = m_y[other];
+			m_cells[cell].child[quadrant] = child;
+		}
+
+		// Go down to the quadrant of the node. "AddCell"
+		// might have moved the cells, so get it again.
+		CCell& parent = m_cells[cell];
+		int quadrant = (x >= parent.x ? 1 : 0) + (y >= parent.y ? 2 : 0);
+		int child = parent.child[quadrant];
+		if (child == -1)
+		{
+			double half = parent.half / 2;
+			child = AddCell(parent.x + (x >= parent.x ? half : -half), parent.y + (y >= parent.y ? half : -half), half);
+			m_cells[cell].child[quadrant] = child;
+		}
+
+		cell = child;
+		depth++;
+		m_cells[cell].mass += 1;
+		m_cells[cell].sumx += x;
+		m_cells[cell].sumy += y;
+
+		// A new cell holds the node directly
+		if (m_cells[cell].body == -1 && m_cells[cell].mass == 1)
+		{
+			m_cells[cell].body = node;
+			return;
+		}
+	}
+
+}
+
+int CForceLayout::AddCell(double x, double y, double half)
+/* ============================================================
+	Function :		CForceLayout::AddCell
+	Description :	Adds an empty quadtree cell.
+	Access :		Private
+
+	Return :		int			-	Index of the new cell.
+	Parameters :	double x	-	Center of the cell.
+					double y	-	Center of the cell.
+					double half	-	Half the side of the cell.
+
+	Usage :			References to cells are invalid after this
+					call, as the array might grow.
+
+   ============================================================*/
+{
+
+	CCell cell;
+	cell.x = x;
+	cell.y = y;
+	cell.half = half;
+	cell.mass = 0;
+	cell.sumx = 0;
+	cell.sumy = 0;
+	cell.child[0] = cell.child[1] = cell.child[2] = cell.child[3] = -1;
+	cell.body = -1;
+
+	return static_cast<int>(m_cells.Add(cell));
+
+}
+
+void CForceLayout::CalcForces(int first, int last)
+/* ============================================================
+	Function :		CForceLayout::CalcForces
+	Description :	Calculates the forces on a range of nodes.
+	Access :		Private
+
+	Return :		void
+	Parameters :	int first	-	First node.
+					int last	-	Node after the last one.
+
+	Usage :			Only writes the forces of the range, so
+					ranges can be calculated at the same time.
+
+   ============================================================*/
+{
+
+	const CCell* cells = m_cells.GetData();
+	const double* xs = m_x.GetData();
+	const double* ys = m_y.GetData();
+	const int* next = m_next.GetData();
+	double k2 = m_k * m_k;
+	double theta2 = THETA * THETA;
+
+	int stack[4 * MAX_DEPTH + 8];
+	for (int node = first; node < last; node++)
+	{
+		double x = xs[node];
+		double y = ys[node];
+		double fx = 0;
+		double fy = 0;
+
+		// Push from the other nodes
+		int top = 0;
+		stack[top++] = 0;
+		while (top)
+		{
+			const CCell& cell = cells[stack[--top]];
+			if (cell.body != -1)
+			{
+				for (int other = cell.body; other != -1; other = next[other])
+				{
+					if (other == node)
+						continue;
+
+					double dx = x - xs[other];
+					double dy = y - ys[other];
+					double d2 = dx * dx + dy * dy;
+					if (d2 < 0.01)
+					{
+						// Same place, push in a fixed direction
+						dx = (node < other) ? -0.1 : 0.1;
+						dy = 0;
+						d2 = 0.01;
+					}
+					fx += dx * k2 / d2;
+					fy += dy * k2 / d2;
+				}
+				continue;
+			}
+
+			double cx = cell.sumx / cell.mass;
+			double cy = cell.sumy / cell.mass;
+			double dx = x - cx;
+			double dy = y - cy;
+			double d2 = dx * dx + dy * dy;
+			double side = cell.half * 2;
+			if (side * side < theta2 * d2)
+			{
+				fx += dx * k2 * cell.mass / d2;
+				fy += dy * k2 * cell.mass / d2;
+			}
+			else
+			{
+				for (int t = 0; t < 4; t++)
+					if (cell.child[t] != -1)
+						stack[top++] = cell.child[t];
+			}
+		}
+
+		// Pull from the edges
+		for (int t = m_adjacentStart[node]; t < m_adjacentStart[node + 1]; t++)
+		{
+			int other = m_adjacent[t];
+			double dx = xs[other] - x;
+			double dy = ys[other] - y;
+			double d = sqrt(dx * dx + dy * dy);
+			fx += dx * d / m_k;
+			fy += dy * d / m_k;
+		}
+
+		// Pull towards the center
+		fx += (m_centerx - x) * GRAVITY;
+		fy += (m_centery - y) * GRAVITY;
+
+		m_fx[node] = fx;
+		m_fy[node] = fy;
+	}
+
+}
+
+UINT AFX_CDECL CForceLayout::WorkerProc(LPVOID param)
+/* ============================================================
+	Function :		CForceLayout::WorkerProc
+	Description :	Thread function for a force calculation
+					worker.
+	Access :		Private
+
+	Return :		UINT			-	Always 0.
+	Parameters :	LPVOID param	-	The "CWorker" to run.
+
+	Usage :			Calculates the forces of its range each
+					time the "start" event is set, and sets
+					"done" when finished. Stops when "m_quit"
+					is set.
+
+   ============================================================*/
+{
+
+	CWorker* worker = static_cast<CWorker*>(param);
+	for (;;)
+	{
+		::WaitForSingleObject(worker->start, INFINITE);
+		if (worker->layout->m_quit)
+			break;
+
+		worker->layout->CalcForces(worker->first, worker->last);
+		::SetEvent(worker->done);
+	}
+
+	return 0;
+
+}
@@ -0,0 +1,99 @@
+#ifndef _CFORCELAYOUT_H_4E8A1C62_9B37_4D05_A2F1C6D83B94
+#define _CFORCELAYOUT_H_4E8A1C62_9B37_4D05_A2F1C6D83B94
+
+///////////////////////////////////////////////////////////
+// File :		ForceLayout.h
+// Created :	10/19/26
+//
+
+#include <afxtempl.h>
+
+class CForceLayout
+{
+public:
+	// Construction/destruction
+	CForceLayout();
+	virtual ~CForceLayout();
+
+	// Input
+	void		Clear();
+	int			AddNode(double x, double y, double width, double height, BOOL pinned = FALSE);
+	int			AddEdge(int node1, int node2);
+	void		SetSpacing(double spacing);
+	void		SetMaxIterations(int iterations);
+	void		SetThreadCount(int threads);
+
+	// Operations
+	void		Layout();
+
+	// Results
+	CPoint		GetNodePosition(int node) const;
+	int			GetIterationCount() const;
+	double		GetIterationTime(int iteration) const;
+	double		GetTotalTime() const;
+
+private:
+	// Quadtree cell
+	struct CCell
+	{
+		double	x;			// Center of the square
+		double	y;
+		double	half;		// Half the side of the square
+		double	mass;		// Number of nodes in the cell
+		double	sumx;		// Sum of the node positions
+		double	sumy;
+		int		child[4];	// Sub-cells, -1 if none
+		int		body;		// First node of a leaf, -1 if none
+	};
+
+	// Force calculation thread
+	struct CWorker
+	{
+		CForceLayout*	layout;
+		int				first;
+		int				last;
+		HANDLE			start;
+		HANDLE			done;
+		CWinThread*		thread;
+	};
+
+	// Input
+	CArray< double, double >	m_x;		// Node centers
+	CArray< double, double >	m_y;
+	CArray< double, double >	m_width;
+	CArray< double, double >	m_height;
+	CArray< BOOL, BOOL >		m_pinned;
+	CArray< int, int >			m_from;
+	CArray< int, int >			m_to;
+	double						m_spacing;
+	int							m_maxIterations;
+	int							m_threads;
+
+	// Working data
+	CArray< int, int >			m_adjacentStart;	// Start of each node in "m_adjacent"
+	CArray< int, int >			m_adjacent;			// Neighbours of each node
+	CArray< CCell, CCell& >		m_cells;
+	CArray< int, int >			m_next;				// Next node in the same leaf
+	CArray< double, double >	m_fx;				// Force on each node
+	CArray< double, double >	m_fy;
+	double						m_k;				// Ideal distance
+	double						m_centerx;			// Gravity center
+	double						m_centery;
+	volatile LONG				m_quit;
+
+	// Instrumentation
+	CArray< double, double >	m_times;			// Milliseconds per iteration
+
+	// Helpers
+	void		BuildAdjacency();
+	void		SeparateCoincident();
+	void		BuildTree();
+	void		Insert(int node);
+	int			AddCell(double x, double y, double half);
+	void		CalcForces(int first, int last);
+
+	static UINT AFX_CDECL WorkerProc(LPVOID param);
+
+};
+
+#endif //_CFORCELAYOUT_H_4E8A1C62_9B37_4D05_A2F1C6D83B94
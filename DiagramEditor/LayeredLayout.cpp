@@ -0,0 +1,1424 @@
+/* ==========================================================================
+	File :			LayeredLayout.cpp
+
+	Class :			CLayeredLayout
+
+	Date :			10/19/26
+
+	Purpose :		"CLayeredLayout" arranges a directed graph in
+					horizontal layers, with edges running from top to
+					bottom, the classic layout for class hierarchies
+					and flowcharts.
+
+	Description :	The layout knows nothing about diagram objects. Nodes
+					are added as sizes and edges as pairs of node
+					indices, and the results are read back as node
+					positions and edge routes. The steps are
+
+					1.	Cycles are broken by reversing the edges a
+						depth-first search finds pointing back to a node
+						still being visited.
+					2.	Nodes are put in layers by longest path, and
+						sources are then pulled down next to their
+						successors.
+					3.	Edges spanning several layers are split with
+						dummy vertices, one per layer crossed.
+					4.	The vertices of each layer are ordered to reduce
+						crossings, using barycenter sweeps down and up
+						the layers. Crossings between two layers are
+						counted with an accumulator tree. A fixed number
+						of trials from shuffled starting orders are
+						shared out over the threads, and the trial with
+						the fewest crossings wins (ties go to the
+						unshuffled trial), so the result depends neither
+						on thread timing nor on the number of
+						processors.
+					5.	Each vertex is pulled towards the median of its
+						neighbours in alternating sweeps. A layer is
+						packed both left-to-right and right-to-left, and
+						the average of the two is used, which keeps the
+						minimum spacing while centering on the wanted
+						positions.
+					6.	Edges leave and enter nodes at ports spread over
+						the node width, sorted by the position of the
+						other end. An edge needing a horizontal jog gets
+						a track in the gap between the layers, and edges
+						with overlapping jogs get different tracks.
+
+					Nodes without edges are placed in rows below the
+					layered graph.
+
+	Usage :			Add nodes and edges, call "Layout", then get the
+					positions with "GetNodePosition" and the routes with
+					"GetEdgeRoute".
+
+   ========================================================================*/
+
+#include "stdafx.h"
+#include "LayeredLayout.h"
+
+#include <math.h>
+
+#ifdef _DEBUG
+#define new DEBUG_NEW
+#undef THIS_FILE
+static char THIS_FILE[] = __FILE__;
+#endif
+
+// Crossing reduction
+#define MAX_SWEEPS			24		// Maximum down and up sweeps per trial
+#define MAX_IDLE_SWEEPS		4		// Sweeps without improvement before a trial stops
+#define LAYOUT_TRIALS		8		// Trials from different starting orders
+#define MAX_THREADS			8		// Maximum number of threads running trials
+#define MIN_TRIAL_SIZE		200		// Smallest graph worth several trials
+
+// Coordinate assignment
+#define PLACEMENT_ROUNDS	8		// Median placement sweeps
+
+// Sort key for a vertex or an edge
+struct LAYOUT_KEY
+{
+	double	key;
+	double	second;
+	int		index;
+};
+
+static int CompareLayoutKeys(const void* p1, const void* p2)
+{
+	const LAYOUT_KEY* k1 = static_cast<const LAYOUT_KEY*>(p1);
+	const LAYOUT_KEY* k2 = static_cast<const LAYOUT_KEY*>(p2);
+	if (k1->key < k2->key)
+		return -1;
+	if (k1->key > k2->key)
+		return 1;
+	if (k1->second < k2->second)
+		return -1;
+	if (k1->second > k2->second)
+		return 1;
+	return k1->index - k2->index;
+}
+
+static void AddRoutePoint(CArray< CPoint, CPoint >& points, CPoint pt)
+{
+	// Skip duplicates, and merge collinear points
+	INT_PTR size = points.GetSize();
+	if (size && points[size - 1] == pt)
+		return;
+
+	if (size >= 2)
+	{
+		CPoint prev = points[size - 1];
+		CPoint prev2 = points[size - 2];
+		if ((prev2.x == prev.x && prev.x == pt.x) || (prev2.y == prev.y && prev.y == pt.y))
+		{
+			points[size - 1] = pt;
+			return;
+		}
+	}
+
+	points.Add(pt);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CLayeredLayout construction/destruction
+
+CLayeredLayout::CLayeredLayout()
+/* ============================================================
+	Function :		CLayeredLayout::CLayeredLayout
+	Description :	Constructor
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	m_horzSpacing = 32;
+	m_vertSpacing = 48;
+	m_threads = 0;
+	Clear();
+
+}
+
+CLayeredLayout::~CLayeredLayout()
+/* ============================================================
+	Function :		CLayeredLayout::~CLayeredLayout
+	Description :	Destructor
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CLayeredLayout input
+
+void CLayeredLayout::Clear()
+/* ============================================================
+	Function :		CLayeredLayout::Clear
+	Description :	Removes all nodes and edges.
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Call to reuse the object for another graph.
+					Spacing and thread count are kept.
+
+   ============================================================*/
+{
+
+	m_width.RemoveAll();
+	m_height.RemoveAll();
+	m_from.RemoveAll();
+	m_to.RemoveAll();
+	m_position.RemoveAll();
+	m_chainStart.RemoveAll();
+	m_vertices = 0;
+	m_layers = 0;
+	m_crossings = 0;
+
+}
+
+int CLayeredLayout::AddNode(int width, int height)
+/* ============================================================
+	Function :		CLayeredLayout::AddNode
+	Description :	Adds a node to the graph.
+	Access :		Public
+
+	Return :		int			-	Index of the new node.
+	Parameters :	int width	-	Width of the node.
+					int height	-	Height of the node.
+
+	Usage :			Call to add the nodes before adding edges.
+
+   ============================================================*/
+{
+
+	m_width.Add(max(width, 0));
+	return static_cast<int>(m_height.Add(max(height, 0)));
+
+}
+
+int CLayeredLayout::AddEdge(int from, int to)
+/* ============================================================
+	Function :		CLayeredLayout::AddEdge
+	Description :	Adds an edge to the graph.
+	Access :		Public
+
+	Return :		int			-	Index of the new edge, -1
+									if a node index is invalid.
+	Parameters :	int from	-	Node to place above.
+					int to		-	Node to place below.
+
+	Usage :			Edges in cycles can not all point down,
+					some of them will be routed upwards.
+					Edges from a node to itself are accepted,
+					but get no route.
+
+   ============================================================*/
+{
+
+	int nodes = static_cast<int>(m_width.GetSize());
+	if (from < 0 || from >= nodes || to < 0 || to >= nodes)
+		return -1;
+
+	m_from.Add(from);
+	return static_cast<int>(m_to.Add(to));
+
+}
+
+void CLayeredLayout::SetSpacing(int horz, int vert)
+/* ============================================================
+	Function :		CLayeredLayout::SetSpacing
+	Description :	Sets the minimum distance between nodes.
+	Access :		Public
+
+	Return :		void
+	Parameters :	int horz	-	Distance between nodes in
+									the same layer.
+					int vert	-	Distance between layers.
+
+	Usage :			The gap between two layers grows if the
+					edges between them need more tracks.
+
+   ============================================================*/
+{
+
+	m_horzSpacing = max(horz, 1);
+	m_vertSpacing = max(vert, 1);
+
+}
+
+void CLayeredLayout::SetThreadCount(int threads)
+/* ============================================================
+	Function :		CLayeredLayout::SetThreadCount
+	Description :	Sets the number of threads running the
+					crossing reduction trials.
+	Access :		Public
+
+	Return :		void
+	Parameters :	int threads	-	Number of threads, 0 to use
+									one per processor.
+
+	Usage :			Only changes the speed. The number of
+					trials is fixed, so the result is the same
+					for any number of threads.
+
+   ============================================================*/
+{
+
+	m_threads = max(threads, 0);
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CLayeredLayout operations
+
+void CLayeredLayout::Layout()
+/* ============================================================
+	Function :		CLayeredLayout::Layout
+	Description :	Calculates node positions and edge routes.
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Call after adding all nodes and edges.
+
+   ============================================================*/
+{
+
+	m_position.SetSize(m_width.GetSize());
+
+	BreakCycles();
+	AssignLayers();
+	InsertDummies();
+	InitialOrder();
+	ReduceCrossings();
+	AssignCoordinates();
+	PlaceUnconnected();
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CLayeredLayout results
+
+CPoint CLayeredLayout::GetNodePosition(int node) const
+/* ============================================================
+	Function :		CLayeredLayout::GetNodePosition
+	Description :	Gets the position of a node.
+	Access :		Public
+
+	Return :		CPoint		-	Top-left corner of the node.
+	Parameters :	int node	-	Index of the node.
+
+	Usage :			Call after "Layout".
+
+   ============================================================*/
+{
+
+	if (node < 0 || node >= m_position.GetSize())
+		return CPoint(0, 0);
+
+	return m_position[node];
+
+}
+
+INT_PTR CLayeredLayout::GetEdgeRoute(int edge, CArray< CPoint, CPoint >& points) const
+/* ============================================================
+	Function :		CLayeredLayout::GetEdgeRoute
+	Description :	Gets the route of an edge.
+	Access :		Public
+
+	Return :		INT_PTR							-	Number of points.
+	Parameters :	int edge						-	Index of the edge.
+					CArray< CPoint, CPoint >& points	-	Route, from the
+															"from" node to the
+															"to" node.
+
+	Usage :			Call after "Layout". The route only has
+					horizontal and vertical parts. It starts on
+					the bottom or top edge of the "from" node and
+					ends on the top or bottom edge of the "to"
+					node. Edges from a node to itself have no
+					route.
+
+   ============================================================*/
+{
+
+	points.RemoveAll();
+	if (edge < 0 || edge + 1 >= m_chainStart.GetSize())
+		return 0;
+
+	int first = m_chainStart[edge];
+	int last = m_chainStart[edge + 1];
+	if (first == last)
+		return 0;
+
+	int top = m_upper[m_chain[first]];
+	int bottom = m_lower[m_chain[last - 1]];
+
+	AddRoutePoint(points, CPoint(static_cast<int>(m_portUpper[m_chain[first]]), static_cast<int>(m_layerTop[m_layer[top]]) + m_height[top]));
+	for (int t = first; t < last; t++)
+	{
+		int proper = m_chain[t];
+		if (m_portUpper[proper] != m_portLower[proper])
+		{
+			int y = static_cast<int>(m_track[proper]);
+			AddRoutePoint(points, CPoint(static_cast<int>(m_portUpper[proper]), y));
+			AddRoutePoint(points, CPoint(static_cast<int>(m_portLower[proper]), y));
+		}
+	}
+	AddRoutePoint(points, CPoint(static_cast<int>(m_portLower[m_chain[last - 1]]), static_cast<int>(m_layerTop[m_layer[bottom]])));
+
+	if (m_reversed[edge])
+	{
+		INT_PTR size = points.GetSize();
+		for (INT_PTR t = 0; t < size / 2; t++)
+		{
+			CPoint pt = points[t];
+			points[t] = points[size - 1 - t];
+			points[size - 1 - t] = pt;
+		}
+	}
+
+	return points.GetSize();
+
+}
+
+int CLayeredLayout::GetLayerCount() const
+/* ============================================================
+	Function :		CLayeredLayout::GetLayerCount
+	Description :	Gets the number of layers.
+	Access :		Public
+
+	Return :		int	-	Number of layers.
+	Parameters :	none
+
+	Usage :			Call after "Layout".
+
+   ============================================================*/
+{
+
+	return m_layers;
+
+}
+
+LONGLONG CLayeredLayout::GetCrossings() const
+/* ============================================================
+	Function :		CLayeredLayout::GetCrossings
+	Description :	Gets the number of edge crossings between
+					layers.
+	Access :		Public
+
+	Return :		LONGLONG	-	Number of crossings.
+	Parameters :	none
+
+	Usage :			Call after "Layout" to judge the result.
+
+   ============================================================*/
+{
+
+	return m_crossings;
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CLayeredLayout stages
+
+void CLayeredLayout::BreakCycles()
+/* ============================================================
+	Function :		CLayeredLayout::BreakCycles
+	Description :	Marks the edges to reverse to get a graph
+					without cycles.
+	Access :		Private
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Called from "Layout".
+
+   ============================================================*/
+{
+
+	int nodes = static_cast<int>(m_width.GetSize());
+	int edges = static_cast<int>(m_from.GetSize());
+
+	m_reversed.SetSize(edges);
+	for (int t = 0; t < edges; t++)
+		m_reversed[t] = FALSE;
+
+	// Outgoing edges of each node
+	CArray< int, int > start;
+	CArray< int, int > out;
+	start.SetSize(nodes + 1);
+	out.SetSize(edges);
+	for (int t = 0; t <= nodes; t++)
+		start[t] = 0;
+	for (int t = 0; t < edges; t++)
+		if (m_from[t] != m_to[t])
+			start[m_from[t] + 1]++;
+	for (int t = 0; t < nodes; t++)
+		start[t + 1] += start[t];
+
+	CArray< int, int > next;
+	next.Copy(start);
+	for (int t = 0; t < edges; t++)
+		if (m_from[t] != m_to[t])
+			out[next[m_from[t]]++] = t;
+
+	// Iterative depth-first search. An edge to a node still
+	// on the stack closes a cycle, and is reversed.
+	CArray< BYTE, BYTE > state;	// 0 - new, 1 - on stack, 2 - done
+	CArray< int, int > stack;
+	state.SetSize(nodes);
+	for (int t = 0; t < nodes; t++)
+	{
+		state[t] = 0;
+		next[t] = start[t];
+	}
+
+	for (int root = 0; root < nodes; root++)
+	{
+		if (state[root])
+			continue;
+
+		state[root] = 1;
+		stack.Add(root);
+		while (stack.GetSize())
+		{
+			int node = stack[stack.GetSize() - 1];
+			if (next[node] < start[node + 1])
+			{
+				int edge = out[next[node]++];
+				int to = m_to[edge];
+				if (state[to] == 1)
+					m_reversed[edge] = TRUE;
+				else if (state[to] == 0)
+				{
+					state[to] = 1;
+					stack.Add(to);
+				}
+			}
+			else
+			{
+				state[node] = 2;
+				stack.SetSize(stack.GetSize() - 1);
+			}
+		}
+	}
+
+}
+
+void CLayeredLayout::AssignLayers()
+/* ============================================================
+	Function :		CLayeredLayout::AssignLayers
+	Description :	Puts each connected node in a layer.
+	Access :		Private
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Called from "Layout". Nodes without edges
+					get layer -1.
+
+   ============================================================*/
+{
+
+	int nodes = static_cast<int>(m_width.GetSize());
+	int edges = static_cast<int>(m_from.GetSize());
+
+	// Edges pointing down, and number of edges above each node
+	CArray< int, int > start;
+	CArray< int, int > below;
+	CArray< int, int > above;
+	CArray< BOOL, BOOL > connected;
+	start.SetSize(nodes + 1);
+	below.SetSize(edges);
+	above.SetSize(nodes);
+	connected.SetSize(nodes);
+	for (int t = 0; t <= nodes; t++)
+		start[t] = 0;
+	for (int t = 0; t < nodes; t++)
+	{
+		above[t] = 0;
+		connected[t] = FALSE;
+	}
+
+	for (int t = 0; t < edges; t++)
+	{
+		if (m_from[t] != m_to[t])
+		{
+			int upper = m_reversed[t] ? m_to[t] : m_from[t];
+			int lower = m_reversed[t] ? m_from[t] : m_to[t];
+			start[upper + 1]++;
+			above[lower]++;
+			connected[upper] = TRUE;
+			connected[lower] = TRUE;
+		}
+	}
+	for (int t = 0; t < nodes; t++)
+		start[t + 1] += start[t];
+
+	CArray< int, int > next;
+	next.Copy(start);
+	for (int t = 0; t < edges; t++)
+		if (m_from[t] != m_to[t])
+			below[next[m_reversed[t] ? m_to[t] : m_from[t]]++] = m_reversed[t] ? m_from[t] : m_to[t];
+
+	// Longest path from the sources, in topological order
+	m_layer.SetSize(nodes);
+	CArray< int, int > queue;
+	CArray< int, int > remaining;
+	remaining.Copy(above);
+	for (int t = 0; t < nodes; t++)
+	{
+		m_layer[t] = connected[t] ? 0 : -1;
+		if (connected[t] && above[t] == 0)
+			queue.Add(t);
+	}
+
+	for (INT_PTR head = 0; head < queue.GetSize(); head++)
+	{
+		int node = queue[head];
+		for (int t = start[node]; t < start[node + 1]; t++)
+		{
+			int lower = below[t];
+			m_layer[lower] = max(m_layer[lower], m_layer[node] + 1);
+			if (--remaining[lower] == 0)
+				queue.Add(lower);
+		}
+	}
+
+	// Pull sources down next to their highest successor,
+	// to avoid long edges from the top layer.
+	for (int node = 0; node < nodes; node++)
+	{
+		if (connected[node] && above[node] == 0)
+		{
+			int layer = INT_MAX;
+			for (int t = start[node]; t < start[node + 1]; t++)
+				layer = min(layer, m_layer[below[t]] - 1);
+			m_layer[node] = layer;
+		}
+	}
+
+	m_layers = 0;
+	for (int t = 0; t < nodes; t++)
+		m_layers = max(m_layers, m_layer[t] + 1);
+
+}
+
+void CLayeredLayout::InsertDummies()
+/* ============================================================
+	Function :		CLayeredLayout::InsertDummies
+	Description :	Splits edges into proper edges between
+					adjacent layers.
+	Access :		Private
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Called from "Layout". A dummy vertex is
+					added for each layer an edge crosses.
+
+   ============================================================*/
+{
+
+	int nodes = static_cast<int>(m_width.GetSize());
+	int edges = static_cast<int>(m_from.GetSize());
+
+	m_vertices = nodes;
+	m_upper.RemoveAll();
+	m_lower.RemoveAll();
+	m_chain.RemoveAll();
+	m_chainStart.SetSize(edges + 1);
+
+	for (int edge = 0; edge < edges; edge++)
+	{
+		m_chainStart[edge] = static_cast<int>(m_chain.GetSize());
+		if (m_from[edge] == m_to[edge])
+			continue;
+
+		int upper = m_reversed[edge] ? m_to[edge] : m_from[edge];
+		int lower = m_reversed[edge] ? m_from[edge] : m_to[edge];
+		int vertex = upper;
+		for (int layer = m_layer[upper] + 1; layer < m_layer[lower]; layer++)
+		{
+			int dummy = m_vertices++;
+			m_layer.Add(layer);
+			m_upper.Add(vertex);
+			m_chain.Add(static_cast<int>(m_lower.Add(dummy)));
+			vertex = dummy;
+		}
+		m_upper.Add(vertex);
+		m_chain.Add(static_cast<int>(m_lower.Add(lower)));
+	}
+	m_chainStart[edges] = static_cast<int>(m_chain.GetSize());
+
+	// Proper edges above and below each vertex
+	int proper = static_cast<int>(m_upper.GetSize());
+	m_downStart.SetSize(m_vertices + 1);
+	m_upStart.SetSize(m_vertices + 1);
+	m_down.SetSize(proper);
+	m_up.SetSize(proper);
+	for (int t = 0; t <= m_vertices; t++)
+	{
+		m_downStart[t] = 0;
+		m_upStart[t] = 0;
+	}
+	for (int t = 0; t < proper; t++)
+	{
+		m_downStart[m_upper[t] + 1]++;
+		m_upStart[m_lower[t] + 1]++;
+	}
+	for (int t = 0; t < m_vertices; t++)
+	{
+		m_downStart[t + 1] += m_downStart[t];
+		m_upStart[t + 1] += m_upStart[t];
+	}
+
+	CArray< int, int > nextDown;
+	CArray< int, int > nextUp;
+	nextDown.Copy(m_downStart);
+	nextUp.Copy(m_upStart);
+	for (int t = 0; t < proper; t++)
+	{
+		m_down[nextDown[m_upper[t]]++] = t;
+		m_up[nextUp[m_lower[t]]++] = t;
+	}
+
+}
+
+void CLayeredLayout::InitialOrder()
+/* ============================================================
+	Function :		CLayeredLayout::InitialOrder
+	Description :	Gives the vertices of each layer a first
+					order.
+	Access :		Private
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Called from "Layout". A depth-first search
+					from the top keeps related vertices next to
+					each other, which is a good start for the
+					crossing reduction.
+
+   ============================================================*/
+{
+
+	m_layerStart.SetSize(m_layers + 1);
+	for (int t = 0; t <= m_layers; t++)
+		m_layerStart[t] = 0;
+	for (int t = 0; t < m_vertices; t++)
+		if (m_layer[t] >= 0)
+			m_layerStart[m_layer[t] + 1]++;
+	for (int t = 0; t < m_layers; t++)
+		m_layerStart[t + 1] += m_layerStart[t];
+
+	CArray< int, int > fill;
+	fill.Copy(m_layerStart);
+	m_order.SetSize(m_layers ? m_layerStart[m_layers] : 0);
+	m_pos.SetSize(m_vertices);
+
+	CArray< BOOL, BOOL > visited;
+	CArray< int, int > stack;
+	visited.SetSize(m_vertices);
+	for (int t = 0; t < m_vertices; t++)
+		visited[t] = (m_layer[t] < 0);
+
+	// Start from the top, then pick up anything left
+	for (int pass = 0; pass < 2; pass++)
+	{
+		for (int root = 0; root < m_vertices; root++)
+		{
+			if (visited[root] || (pass == 0 && m_upStart[root] != m_upStart[root + 1]))
+				continue;
+
+			stack.Add(root);
+			while (stack.GetSize())
+			{
+				int vertex = stack[stack.GetSize() - 1];
+				stack.SetSize(stack.GetSize() - 1);
+				if (visited[vertex])
+					continue;
+
+				visited[vertex] = TRUE;
+				int layer = m_layer[vertex];
+				m_pos[vertex] = fill[layer] - m_layerStart[layer];
+				m_order[fill[layer]++] = vertex;
+
+				for (int t = m_downStart[vertex + 1] - 1; t >= m_downStart[vertex]; t--)
+					if (!visited[m_lower[m_down[t]]])
+						stack.Add(m_lower[m_down[t]]);
+			}
+		}
+	}
+
+}
+
+void CLayeredLayout::ReduceCrossings()
+/* ============================================================
+	Function :		CLayeredLayout::ReduceCrossings
+	Description :	Orders the vertices of each layer to reduce
+					the number of edge crossings.
+	Access :		Private
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Called from "Layout". Runs "LAYOUT_TRIALS"
+					trials, shared out over the threads, and
+					keeps the best.
+
+   ============================================================*/
+{
+
+	int count = (m_vertices < MIN_TRIAL_SIZE) ? 1 : LAYOUT_TRIALS;
+	CTrial* trials = new CTrial[count];
+	for (int t = 0; t < count; t++)
+	{
+		trials[t].seed = static_cast<UINT>(t) * 0x9E3779B9;
+		trials[t].order.Copy(m_order);
+		trials[t].pos.Copy(m_pos);
+		trials[t].crossings = 0;
+	}
+
+	int threads = m_threads;
+	if (threads == 0)
+	{
+		SYSTEM_INFO info;
+		::GetSystemInfo(&info);
+		threads = static_cast<int>(info.dwNumberOfProcessors);
+	}
+	threads = max(min(min(threads, count), MAX_THREADS), 1);
+
+	CTrialQueue queue;
+	queue.layout = this;
+	queue.trials = trials;
+	queue.count = count;
+	queue.next = 0;
+
+	CWinThread** workers = new CWinThread*[threads];
+	for (int t = 1; t < threads; t++)
+	{
+		workers[t] = AfxBeginThread(TrialProc, &queue, THREAD_PRIORITY_NORMAL, 0, CREATE_SUSPENDED);
+		if (workers[t])
+		{
+			workers[t]->m_bAutoDelete = FALSE;
+			workers[t]->ResumeThread();
+		}
+	}
+
+	RunTrials(&queue);
+
+	for (int t = 1; t < threads; t++)
+	{
+		if (workers[t])
+		{
+			::WaitForSingleObject(workers[t]->m_hThread, INFINITE);
+			delete workers[t];
+		}
+	}
+
+	// The winner only depends on the trials, not on which
+	// thread ran them
+	int best = 0;
+	for (int t = 1; t < count; t++)
+		if (trials[t].crossings < trials[best].crossings)
+			best = t;
+
+	m_order.Copy(trials[best].order);
+	m_pos.Copy(trials[best].pos);
+	m_crossings = trials[best].crossings;
+
+	delete[] workers;
+	delete[] trials;
+
+}
+
+void CLayeredLayout::AssignCoordinates()
+/* ============================================================
+	Function :		CLayeredLayout::AssignCoordinates
+	Description :	Calculates the vertex positions and the
+					edge ports and tracks.
+	Access :		Private
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Called from "Layout".
+
+   ============================================================*/
+{
+
+	int nodes = static_cast<int>(m_width.GetSize());
+	int proper = static_cast<int>(m_upper.GetSize());
+	m_x.SetSize(m_vertices);
+
+	// Start packed to the left
+	for (int layer = 0; layer < m_layers; layer++)
+	{
+		double x = 0;
+		for (int t = m_layerStart[layer]; t < m_layerStart[layer + 1]; t++)
+		{
+			if (t > m_layerStart[layer])
+				x += GetSeparation(m_order[t - 1], m_order[t]);
+			m_x[m_order[t]] = x;
+		}
+	}
+
+	// Pull towards the median of the neighbours
+	CArray< double, double > wanted;
+	CArray< double, double > packed;
+	CArray< double, double > neighbours;
+	wanted.SetSize(m_vertices);
+	packed.SetSize(m_vertices);
+	for (int round = 0; round < PLACEMENT_ROUNDS; round++)
+	{
+		BOOL down = (round % 2 == 0);
+		for (int step = 0; step < m_layers; step++)
+		{
+			int layer = down ? step : m_layers - 1 - step;
+			int first = m_layerStart[layer];
+			int last = m_layerStart[layer + 1];
+
+			for (int t = first; t < last; t++)
+			{
+				int vertex = m_order[t];
+				neighbours.RemoveAll();
+				if (down)
+				{
+					for (int e = m_upStart[vertex]; e < m_upStart[vertex + 1]; e++)
+						neighbours.Add(m_x[m_upper[m_up[e]]]);
+				}
+				else
+				{
+					for (int e = m_downStart[vertex]; e < m_downStart[vertex + 1]; e++)
+						neighbours.Add(m_x[m_lower[m_down[e]]]);
+				}
+
+				INT_PTR count = neighbours.GetSize();
+				if (count == 0)
+				{
+					wanted[vertex] = m_x[vertex];
+					continue;
+				}
+
+				for (INT_PTR i = 1; i < count; i++)
+				{
+					double value = neighbours[i];
+					INT_PTR j = i;
+					while (j > 0 && neighbours[j - 1] > value)
+					{
+						neighbours[j] = neighbours[j - 1];
+						j--;
+					}
+					neighbours[j] = value;
+				}
+
+				if (count % 2)
+					wanted[vertex] = neighbours[count / 2];
+				else
+					wanted[vertex] = (neighbours[count / 2 - 1] + neighbours[count / 2]) / 2;
+			}
+
+			// Pack from the left and from the right, and use the
+			// average. Both keep the separation, so the average
+			// does too.
+			for (int t = first; t < last; t++)
+			{
+				int vertex = m_order[t];
+				packed[vertex] = wanted[vertex];
+				if (t > first)
+					packed[vertex] = max(packed[vertex], packed[m_order[t - 1]] + GetSeparation(m_order[t - 1], vertex));
+			}
+			double right = 0;
+			for (int t = last - 1; t >= first; t--)
+			{
+				int vertex = m_order[t];
+				double x = wanted[vertex];
+				if (t < last - 1)
+					x = min(x, right - GetSeparation(vertex, m_order[t + 1]));
+				right = x;
+				m_x[vertex] = (packed[vertex] + x) / 2;
+			}
+		}
+	}
+
+	// Move everything to start at zero
+	double left = 0;
+	BOOL first = TRUE;
+	for (int t = 0; t < m_vertices; t++)
+	{
+		if (m_layer[t] >= 0)
+		{
+			double x = m_x[t] - GetVertexWidth(t) / 2.0;
+			if (first || x < left)
+				left = x;
+			first = FALSE;
+		}
+	}
+
+	for (int t = 0; t < m_vertices; t++)
+		m_x[t] = floor(m_x[t] - left + 0.5);
+
+	// Ports, spread over the node width in the order of the
+	// other end of the edge
+	m_portUpper.SetSize(proper);
+	m_portLower.SetSize(proper);
+	CArray< LAYOUT_KEY, LAYOUT_KEY& > keys;
+	for (int vertex = 0; vertex < m_vertices; vertex++)
+	{
+		if (m_layer[vertex] < 0)
+			continue;
+
+		int width = GetVertexWidth(vertex);
+		int x = static_cast<int>(m_x[vertex]) - width / 2;
+		for (int side = 0; side < 2; side++)
+		{
+			int start = side ? m_upStart[vertex] : m_downStart[vertex];
+			int end = side ? m_upStart[vertex + 1] : m_downStart[vertex + 1];
+			int count = end - start;
+			keys.SetSize(count);
+			for (int t = 0; t < count; t++)
+			{
+				int edge = side ? m_up[start + t] : m_down[start + t];
+				keys[t].key = m_x[side ? m_upper[edge] : m_lower[edge]];
+				keys[t].second = 0;
+				keys[t].index = edge;
+			}
+			if (count > 1)
+				qsort(keys.GetData(), count, sizeof(LAYOUT_KEY), CompareLayoutKeys);
+
+			for (int t = 0; t < count; t++)
+			{
+				double port = (vertex < nodes) ? x + (width * (t + 1)) / (count + 1) : m_x[vertex];
+				if (side)
+					m_portLower[keys[t].index] = port;
+				else
+					m_portUpper[keys[t].index] = port;
+			}
+		}
+	}
+
+	// Tracks for the edges needing a horizontal jog. Jogs
+	// overlapping horizontally get different tracks.
+	int trackSpacing = max(m_vertSpacing / 4, 4);
+	CArray< int, int > tracks;
+	CArray< double, double > trackEnd;
+	m_track.SetSize(proper);
+	tracks.SetSize(m_layers);
+	for (int layer = 0; layer < m_layers; layer++)
+	{
+		keys.RemoveAll();
+		for (int t = m_layerStart[layer]; t < m_layerStart[layer + 1]; t++)
+		{
+			int vertex = m_order[t];
+			for (int e = m_downStart[vertex]; e < m_downStart[vertex + 1]; e++)
+			{
+				int edge = m_down[e];
+				m_track[edge] = 0;
+				if (m_portUpper[edge] != m_portLower[edge])
+				{
+					LAYOUT_KEY key;
+					key.key = min(m_portUpper[edge], m_portLower[edge]);
+					key.second = max(m_portUpper[edge], m_portLower[edge]);
+					key.index = edge;
+					keys.Add(key);
+				}
+			}
+		}
+
+		if (keys.GetSize() > 1)
+			qsort(keys.GetData(), keys.GetSize(), sizeof(LAYOUT_KEY), CompareLayoutKeys);
+
+		trackEnd.RemoveAll();
+		for (INT_PTR t = 0; t < keys.GetSize(); t++)
+		{
+			INT_PTR track = 0;
+			while (track < trackEnd.GetSize() && trackEnd[track] + trackSpacing > keys[t].key)
+				track++;
+			if (track == trackEnd.GetSize())
+				trackEnd.Add(keys[t].second);
+			else
+				trackEnd[track] = keys[t].second;
+			m_track[keys[t].index] = static_cast<double>(track);
+		}
+		tracks[layer] = static_cast<int>(trackEnd.GetSize());
+	}
+
+	// Layers are as high as their highest node, and the gaps
+	// are high enough for the tracks
+	m_layerTop.SetSize(m_layers);
+	m_layerHeight.SetSize(m_layers);
+	for (int layer = 0; layer < m_layers; layer++)
+		m_layerHeight[layer] = 0;
+	for (int t = 0; t < nodes; t++)
+		if (m_layer[t] >= 0)
+			m_layerHeight[m_layer[t]] = max(m_layerHeight[m_layer[t]], static_cast<double>(m_height[t]));
+
+	CArray< double, double > trackTop;
+	trackTop.SetSize(m_layers);
+	double top = 0;
+	for (int layer = 0; layer < m_layers; layer++)
+	{
+		m_layerTop[layer] = top;
+		double gap = max(static_cast<double>(m_vertSpacing), static_cast<double>(trackSpacing * (tracks[layer] + 1)));
+		trackTop[layer] = floor(top + m_layerHeight[layer] + (gap - trackSpacing * (tracks[layer] - 1)) / 2);
+		top += m_layerHeight[layer] + gap;
+	}
+
+	for (int edge = 0; edge < proper; edge++)
+		m_track[edge] = trackTop[m_layer[m_upper[edge]]] + m_track[edge] * trackSpacing;
+
+	for (int t = 0; t < nodes; t++)
+		if (m_layer[t] >= 0)
+			m_position[t] = CPoint(static_cast<int>(m_x[t]) - m_width[t] / 2, static_cast<int>(m_layerTop[m_layer[t]]));
+
+}
+
+void CLayeredLayout::PlaceUnconnected()
+/* ============================================================
+	Function :		CLayeredLayout::PlaceUnconnected
+	Description :	Places nodes without edges.
+	Access :		Private
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Called from "Layout". The nodes are put in
+					rows below the layered graph.
+
+   ============================================================*/
+{
+
+	int nodes = static_cast<int>(m_width.GetSize());
+	int right = 0;
+	int bottom = -m_vertSpacing;
+	for (int t = 0; t < nodes; t++)
+	{
+		if (m_layer[t] >= 0)
+		{
+			right = max(right, static_cast<int>(m_position[t].x) + m_width[t]);
+			bottom = max(bottom, static_cast<int>(m_position[t].y) + m_height[t]);
+		}
+	}
+
+	int rowWidth = max(right, 1000);
+	int x = 0;
+	int y = bottom + m_vertSpacing;
+	int rowHeight = 0;
+	for (int t = 0; t < nodes; t++)
+	{
+		if (m_layer[t] >= 0)
+			continue;
+
+		if (x > 0 && x + m_width[t] > rowWidth)
+		{
+			x = 0;
+			y += rowHeight + m_vertSpacing;
+			rowHeight = 0;
+		}
+
+		m_position[t] = CPoint(x, y);
+		x += m_width[t] + m_horzSpacing;
+		rowHeight = max(rowHeight, m_height[t]);
+	}
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CLayeredLayout helpers
+
+UINT AFX_CDECL CLayeredLayout::TrialProc(LPVOID param)
+/* ============================================================
+	Function :		CLayeredLayout::TrialProc
+	Description :	Thread function for a crossing reduction
+					trial.
+	Access :		Private
+
+	Return :		UINT			-	Always 0.
+	Parameters :	LPVOID param	-	The "CTrialQueue" to take
+										trials from.
+
+	Usage :			Started from "ReduceCrossings".
+
+   ============================================================*/
+{
+
+	CTrialQueue* queue = static_cast<CTrialQueue*>(param);
+	queue->layout->RunTrials(queue);
+	return 0;
+
+}
+
+void CLayeredLayout::RunTrials(CTrialQueue* queue) const
+/* ============================================================
+	Function :		CLayeredLayout::RunTrials
+	Description :	Runs trials from a queue until all of them
+					are taken.
+	Access :		Private
+
+	Return :		void
+	Parameters :	CTrialQueue* queue	-	Trials to run.
+
+	Usage :			Called from "ReduceCrossings" and the
+					trial threads. If a thread could not be
+					started, the others take its share.
+
+   ============================================================*/
+{
+
+	for (;;)
+	{
+		int trial = static_cast<int>(::InterlockedIncrement(&queue->next)) - 1;
+		if (trial >= queue->count)
+			break;
+		RunTrial(&queue->trials[trial]);
+	}
+
+}
+
+void CLayeredLayout::RunTrial(CTrial* trial) const
+/* ============================================================
+	Function :		CLayeredLayout::RunTrial
+	Description :	Runs barycenter sweeps on the order of a
+					trial.
+	Access :		Private
+
+	Return :		void
+	Parameters :	CTrial* trial	-	Trial to run.
+
+	Usage :			Only reads the layout, and only writes to
+					"trial", so several trials can run at the
+					same time. Trials with a seed start from a
+					shuffled order.
+
+   ============================================================*/
+{
+
+	int* order = trial->order.GetData();
+	int* pos = trial->pos.GetData();
+
+	if (trial->seed)
+	{
+		UINT seed = trial->seed;
+		for (int layer = 0; layer < m_layers; layer++)
+		{
+			int first = m_layerStart[layer];
+			for (int t = m_layerStart[layer + 1] - 1; t > first; t--)
+			{
+				seed = seed * 1103515245 + 12345;
+				int other = first + static_cast<int>((seed >> 16) % static_cast<UINT>(t - first + 1));
+				int vertex = order[t];
+				order[t] = order[other];
+				order[other] = vertex;
+			}
+			for (int t = first; t < m_layerStart[layer + 1]; t++)
+				pos[order[t]] = t - first;
+		}
+	}
+
+	CArray< int, int > best;
+	best.SetSize(trial->order.GetSize());
+	memcpy(best.GetData(), order, sizeof(int) * best.GetSize());
+	LONGLONG bestCrossings = CountCrossings(order, pos);
+
+	int idle = 0;
+	for (int sweep = 0; sweep < MAX_SWEEPS && idle < MAX_IDLE_SWEEPS && bestCrossings; sweep++)
+	{
+		for (int layer = 1; layer < m_layers; layer++)
+			SortLayer(layer, TRUE, order, pos);
+		for (int layer = m_layers - 2; layer >= 0; layer--)
+			SortLayer(layer, FALSE, order, pos);
+
+		LONGLONG crossings = CountCrossings(order, pos);
+		if (crossings < bestCrossings)
+		{
+			bestCrossings = crossings;
+			memcpy(best.GetData(), order, sizeof(int) * best.GetSize());
+			idle = 0;
+		}
+		else
+			idle++;
+	}
+
+	memcpy(order, best.GetData(), sizeof(int) * best.GetSize());
+	for (int layer = 0; layer < m_layers; layer++)
+		for (int t = m_layerStart[layer]; t < m_layerStart[layer + 1]; t++)
+			pos[order[t]] = t - m_layerStart[layer];
+
+	trial->crossings = bestCrossings;
+
+}
+
+void CLayeredLayout::SortLayer(int layer, BOOL down, int* order, int* pos) const
+/* ============================================================
+	Function :		CLayeredLayout::SortLayer
+	Description :	Sorts the vertices of a layer by the mean
+					position of their neighbours.
+	Access :		Private
+
+	Return :		void
+	Parameters :	int layer	-	Layer to sort.
+					BOOL down	-	"TRUE" to use the layer above,
+									"FALSE" to use the layer below.
+					int* order	-	Vertex order to update.
+					int* pos	-	Vertex positions to update.
+
+	Usage :			Vertices without neighbours keep their
+					place. The sort is stable.
+
+   ============================================================*/
+{
+
+	int first = m_layerStart[layer];
+	int count = m_layerStart[layer + 1] - first;
+	if (count < 2)
+		return;
+
+	CArray< LAYOUT_KEY, LAYOUT_KEY& > keys;
+	keys.SetSize(count);
+	for (int t = 0; t < count; t++)
+	{
+		int vertex = order[first + t];
+		int start = down ? m_upStart[vertex] : m_downStart[vertex];
+		int end = down ? m_upStart[vertex + 1] : m_downStart[vertex + 1];
+		double sum = 0;
+		for (int e = start; e < end; e++)
+			sum += pos[down ? m_upper[m_up[e]] : m_lower[m_down[e]]];
+
+		keys[t].key = (end > start) ? sum / (end - start) : t;
+		keys[t].second = t;
+		keys[t].index = vertex;
+	}
+
+	qsort(keys.GetData(), count, sizeof(LAYOUT_KEY), CompareLayoutKeys);
+
+	for (int t = 0; t < count; t++)
+	{
+		order[first + t] = keys[t].index;
+		pos[keys[t].index] = t;
+	}
+
+}
+
+LONGLONG CLayeredLayout::CountCrossings(const int* order, const int* pos) const
+/* ============================================================
+	Function :		CLayeredLayout::CountCrossings
+	Description :	Counts the crossings of an order.
+	Access :		Private
+
+	Return :		LONGLONG		-	Number of crossings.
+	Parameters :	const int* order	-	Vertex order.
+					const int* pos		-	Vertex positions.
+
+	Usage :			Edges between two layers are visited in the
+					order of their upper end, and the lower ends
+					are inserted in an accumulator tree. Each
+					lower end already in the tree to the right of
+					the new one is a crossing.
+
+   ============================================================*/
+{
+
+	LONGLONG crossings = 0;
+	CArray< int, int > ends;
+	CArray< int, int > tree;
+
+	for (int layer = 0; layer + 1 < m_layers; layer++)
+	{
+		ends.RemoveAll();
+		for (int t = m_layerStart[layer]; t < m_layerStart[layer + 1]; t++)
+		{
+			int vertex = order[t];
+			INT_PTR first = ends.GetSize();
+			for (int e = m_downStart[vertex]; e < m_downStart[vertex + 1]; e++)
+			{
+				int end = pos[m_lower[m_down[e]]];
+				INT_PTR i = ends.Add(end);
+				while (i > first && ends[i - 1] > end)
+				{
+					ends[i] = ends[i - 1];
+					i--;
+				}
+				ends[i] = end;
+			}
+		}
+
+		int size = m_layerStart[layer + 2] - m_layerStart[layer + 1];
+		int firstIndex = 1;
+		while (firstIndex < size)
+			firstIndex *= 2;
+		tree.SetSize(2 * firstIndex - 1);
+		memset(tree.GetData(), 0, sizeof(int) * tree.GetSize());
+		firstIndex -= 1;
+
+		for (INT_PTR t = 0; t < ends.GetSize(); t++)
+		{
+			int index = ends[t] + firstIndex;
+			tree[index]++;
+			while (index > 0)
+			{
+				if (index % 2)
+					crossings += tree[index + 1];
+				index = (index - 1) / 2;
+				tree[index]++;
+			}
+		}
+	}
+
+	return crossings;
+
+}
+
+double CLayeredLayout::GetSeparation(int left, int right) const
+/* ============================================================
+	Function :		CLayeredLayout::GetSeparation
+	Description :	Gets the minimum distance between the
+					centers of two neighbouring vertices.
+	Access :		Private
+
+	Return :		double		-	Distance.
+	Parameters :	int left	-	Left vertex.
+					int right	-	Right vertex.
+
+	Usage :			Dummy vertices only need half the spacing.
+
+   ============================================================*/
+{
+
+	int nodes = static_cast<int>(m_width.GetSize());
+	double spacing = (left >= nodes || right >= nodes) ? m_horzSpacing / 2.0 : m_horzSpacing;
+	return (GetVertexWidth(left) + GetVertexWidth(right)) / 2.0 + spacing;
+
+}
+
+int CLayeredLayout::GetVertexWidth(int vertex) const
+/* ============================================================
+	Function :		CLayeredLayout::GetVertexWidth
+	Description :	Gets the width of a vertex.
+	Access :		Private
+
+	Return :		int			-	Width, 0 for dummy vertices.
+	Parameters :	int vertex	-	Vertex.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	return vertex < m_width.GetSize() ? m_width[vertex] : 0;
+
+}
@@ -0,0 +1,113 @@
+#ifndef _CLAYEREDLAYOUT_H_7B2D94E0_51A3_4C8F_9D16E0F3A5C28
+#define _CLAYEREDLAYOUT_H_7B2D94E0_51A3_4C8F_9D16E0F3A5C28
+
+///////////////////////////////////////////////////////////
+// File :		LayeredLayout.h
+// Created :	10/19/26
+//
+
+#include <afxtempl.h>
+
+class CLayeredLayout
+{
+public:
+	// Construction/destruction
+	CLayeredLayout();
+	virtual ~CLayeredLayout();
+
+	// Input
+	void		Clear();
+	int			AddNode(int width, int height);
+	int			AddEdge(int from, int to);
+	void		SetSpacing(int horz, int vert);
+	void		SetThreadCount(int threads);
+
+	// Operations
+	void		Layout();
+
+	// Results
+	CPoint		GetNodePosition(int node) const;
+	INT_PTR		GetEdgeRoute(int edge, CArray< CPoint, CPoint >& points) const;
+	int			GetLayerCount() const;
+	LONGLONG	GetCrossings() const;
+
+private:
+	// Crossing reduction trial
+	struct CTrial
+	{
+		UINT					seed;
+		CArray< int, int >		order;
+		CArray< int, int >		pos;
+		LONGLONG				crossings;
+	};
+
+	// Trials shared by the crossing reduction threads
+	struct CTrialQueue
+	{
+		const CLayeredLayout*	layout;
+		CTrial*					trials;
+		int						count;
+		volatile LONG			next;		// Next trial to run
+	};
+
+	// Input
+	CArray< int, int >	m_width;
+	CArray< int, int >	m_height;
+	CArray< int, int >	m_from;
+	CArray< int, int >	m_to;
+	int					m_horzSpacing;
+	int					m_vertSpacing;
+	int					m_threads;
+
+	// Layered graph. Vertices are the nodes, followed by
+	// the dummy vertices of edges spanning several layers.
+	int					m_vertices;
+	CArray< int, int >	m_layer;		// Layer of each vertex, -1 for unconnected nodes
+	CArray< BOOL, BOOL > m_reversed;	// TRUE if the edge points upwards
+	CArray< int, int >	m_chainStart;	// Start of each edge in "m_chain"
+	CArray< int, int >	m_chain;		// Proper edges of each edge, top to bottom
+	CArray< int, int >	m_upper;		// Upper vertex of each proper edge
+	CArray< int, int >	m_lower;		// Lower vertex of each proper edge
+	CArray< int, int >	m_downStart;	// Start of each vertex in "m_down"
+	CArray< int, int >	m_down;			// Proper edges below each vertex
+	CArray< int, int >	m_upStart;		// Start of each vertex in "m_up"
+	CArray< int, int >	m_up;			// Proper edges above each vertex
+
+	// Ordering
+	int					m_layers;
+	CArray< int, int >	m_layerStart;	// Start of each layer in "m_order"
+	CArray< int, int >	m_order;		// Vertices of each layer, left to right
+	CArray< int, int >	m_pos;			// Position of each vertex in its layer
+	LONGLONG			m_crossings;
+
+	// Coordinates
+	CArray< double, double >	m_x;			// Center of each vertex
+	CArray< double, double >	m_layerTop;
+	CArray< double, double >	m_layerHeight;
+	CArray< double, double >	m_portUpper;	// Start x of each proper edge
+	CArray< double, double >	m_portLower;	// End x of each proper edge
+	CArray< double, double >	m_track;		// y of the horizontal part of each proper edge
+	CArray< CPoint, CPoint >	m_position;		// Top-left corner of each node
+
+	// Stages
+	void		BreakCycles();
+	void		AssignLayers();
+	void		InsertDummies();
+	void		InitialOrder();
+	void		ReduceCrossings();
+	void		AssignCoordinates();
+	void		PlaceUnconnected();
+
+	// Helpers
+	void		RunTrial(CTrial* trial) const;
+	void		RunTrials(CTrialQueue* queue) const;
+	void		SortLayer(int layer, BOOL down, int* order, int* pos) const;
+	LONGLONG	CountCrossings(const int* order, const int* pos) const;
+	double		GetSeparation(int left, int right) const;
+	int			GetVertexWidth(int vertex) const;
+
+	static UINT AFX_CDECL TrialProc(LPVOID param);
+
+};
+
+#endif //_CLAYEREDLAYOUT_H_7B2D94E0_51A3_4C8F_9D16E0F3A5C28
@@ -0,0 +1,1350 @@
+/* ==========================================================================
+	File :			LinkRouter.cpp
+
+	Class :			CLinkRouter
+
+	Date :			10/19/26
+
+	Purpose :		"CLinkRouter" finds orthogonal routes for links
+					between rectangular obstacles, going around the
+					obstacles in the way with as few bends as possible,
+					and keeps the routes until something they depend on
+					changes.
+
+	Description :	The router knows nothing about diagram objects.
+					Obstacles are added as rectangles and links as a
+					start and an end point, each with the side of the
+					obstacle it is on.
+
+					A route leaves its start point with a short stub
+					straight out from the side, and enters the end point
+					the same way. Between the stubs, an A* search runs
+					on a sparse grid, made from the lines along the
+					edges of the obstacles near the route (grown by the
+					margin), the lines through the stub points, and a
+					frame around them. Every turn in the grid is a
+					possible bend, and the search minimizes the length
+					plus a penalty for each bend, so routes hug the
+					obstacles and do not wander. The region searched
+					starts as the rectangle between the stubs, and grows
+					to take in the obstacles touching it a few times, so
+					the grid only has as many lines as there are
+					obstacles near the link.
+
+					Routes are cached per link. A route is recalculated
+					by "Update" when the ends of the link change, when
+					an obstacle it is attached to changes, or when an
+					obstacle moves onto, or away from, the route. Moving
+					an object therefore only reroutes the links that are
+					affected by the move.
+
+	Usage :			Add the obstacles with "AddObstacle" and the links
+					with "AddLink" and "SetLinkEnds", then call
+					"Update" and get the routes with "GetRoute". Call
+					"SetObstacle" and "SetLinkEnds" as things move, and
+					"Update" before using the routes again. "Route"
+					finds a single route without caching it.
+
+   ========================================================================*/
+
+#include "stdafx.h"
+#include "LinkRouter.h"
+
+#ifdef _DEBUG
+#define new DEBUG_NEW
+#undef THIS_FILE
+static char THIS_FILE[] = __FILE__;
+#endif
+
+// Routing
+#define DEFAULT_MARGIN			16		// Space kept around obstacles
+#define DEFAULT_BEND_PENALTY	48		// Cost of a bend, as route length
+#define MAX_REGION_PASSES		4		// Times the search region grows to take in obstacles
+#define MAX_OBSTACLES			1024	// Most obstacles considered for a single route
+#define MAX_EXPANSIONS			20000	// States a search may expand before it gives up
+#define GREEDY_WEIGHT			4		// Weight of the estimate when an exact search gives up
+#define MIN_STATE_TABLE			4096	// Initial size of the search state table
+
+// Grid flags
+#define NODE_BLOCKED			1		// Node inside an obstacle
+#define EAST_BLOCKED			2		// Edge to the next node in x crosses an obstacle
+#define SOUTH_BLOCKED			4		// Edge to the next node in y crosses an obstacle
+
+// Directions of travel. The opposite direction is "dir ^ 1".
+#define DIR_EAST				0
+#define DIR_WEST				1
+#define DIR_SOUTH				2
+#define DIR_NORTH				3
+
+static const int s_dx[4] = { 1, -1, 0, 0 };
+static const int s_dy[4] = { 0, 0, 1, -1 };
+
+// Sort key for an obstacle
+struct ROUTE_KEY
+{
+	int		distance;
+	int		index;
+};
+
+static int CompareRouteKeys(const void* p1, const void* p2)
+{
+	const ROUTE_KEY* k1 = static_cast<const ROUTE_KEY*>(p1);
+	const ROUTE_KEY* k2 = static_cast<const ROUTE_KEY*>(p2);
+	if (k1->distance != k2->distance)
+		return k1->distance < k2->distance ? -1 : 1;
+	return k1->index - k2->index;
+}
+
+static int CompareCoordinates(const void* p1, const void* p2)
+{
+	int c1 = *static_cast<const int*>(p1);
+	int c2 = *static_cast<const int*>(p2);
+	return c1 < c2 ? -1 : (c1 > c2 ? 1 : 0);
+}
+
+static void SortCoordinates(CArray< int, int >& coords)
+{
+	// Sort and remove duplicates
+	INT_PTR count = coords.GetSize();
+	qsort(coords.GetData(), count, sizeof(int), CompareCoordinates);
+
+	INT_PTR size = 0;
+	for (INT_PTR t = 0; t < count; t++)
+		if (size == 0 || coords[size - 1] != coords[t])
+			coords[size++] = coords[t];
+	coords.SetSize(size);
+}
+
+static int FindCoordinate(const CArray< int, int >& coords, int value)
+{
+	// Index of the first coordinate not less than "value"
+	int low = 0;
+	int high = static_cast<int>(coords.GetSize());
+	while (low < high)
+	{
+		int mid = (low + high) / 2;
+		if (coords[mid] < value)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	return low;
+}
+
+static int GetDirection(int side)
+{
+	// Direction leaving an obstacle from "side"
+	switch (side)
+	{
+	case ROUTE_LEFT:
+		return DIR_WEST;
+	case ROUTE_RIGHT:
+		return DIR_EAST;
+	case ROUTE_TOP:
+		return DIR_NORTH;
+	case ROUTE_BOTTOM:
+		return DIR_SOUTH;
+	}
+	return -1;
+}
+
+// Fewest bends from a node to the end, ignoring obstacles, by
+// direction of travel, position of the end relative to the node
+// (sign of x and y, as "(sx + 1) * 3 + sy + 1") and direction
+// wanted at the end plus one (0 if any)
+static int	s_bends[4][9][5];
+static BOOL	s_bendsReady = FALSE;
+
+static BOOL CanReach(const int* dirs, int count, int sx, int sy)
+{
+	// The first segment may have zero length, the others may not,
+	// so only they force a movement in their direction
+	BOOL present[4] = { FALSE, FALSE, FALSE, FALSE };
+	BOOL forced[4] = { FALSE, FALSE, FALSE, FALSE };
+	for (int t = 0; t < count; t++)
+	{
+		present[dirs[t]] = TRUE;
+		if (t > 0)
+			forced[dirs[t]] = TRUE;
+	}
+
+	for (int axis = 0; axis < 2; axis++)
+	{
+		int sign = axis ? sy : sx;
+		int positive = axis ? DIR_SOUTH : DIR_EAST;
+		int negative = axis ? DIR_NORTH : DIR_WEST;
+		if (sign > 0 && !present[positive])
+			return FALSE;
+		if (sign < 0 && !present[negative])
+			return FALSE;
+		if (sign == 0 && (forced[positive] || forced[negative]) && !(present[positive] && present[negative]))
+			return FALSE;
+	}
+
+	return TRUE;
+}
+
+static void FindBends(int* dirs, int count, int sx, int sy, int* best)
+{
+	// Try all turn sequences of up to four bends
+	if (CanReach(dirs, count, sx, sy))
+	{
+		int last = dirs[count - 1];
+		for (int arrival = -1; arrival < 4; arrival++)
+		{
+			int bends = count - 1;
+			if (arrival >= 0 && last != arrival)
+				bends++;
+			if (bends < best[arrival + 1])
+				best[arrival + 1] = bends;
+		}
+	}
+
+	if (count < 5)
+	{
+		for (int turn = 0; turn < 2; turn++)
+		{
+			dirs[count] = (dirs[count - 1] < DIR_SOUTH ? DIR_SOUTH : DIR_EAST) + turn;
+			FindBends(dirs, count + 1, sx, sy, best);
+		}
+	}
+}
+
+static void BuildBendTable()
+{
+	if (s_bendsReady)
+		return;
+
+	for (int dir = 0; dir < 4; dir++)
+	{
+		for (int sx = -1; sx <= 1; sx++)
+		{
+			for (int sy = -1; sy <= 1; sy++)
+			{
+				int* best = s_bends[dir][(sx + 1) * 3 + sy + 1];
+				for (int t = 0; t < 5; t++)
+					best[t] = 5;
+
+				int dirs[5];
+				dirs[0] = dir;
+				FindBends(dirs, 1, sx, sy, best);
+			}
+		}
+	}
+
+	s_bendsReady = TRUE;
+}
+
+static int Estimate(int x, int y, int dir, int tx, int ty, int arrival, int bendPenalty)
+{
+	// Lower bound of the cost from (x, y), travelling in "dir",
+	// to (tx, ty)
+	int sx = (tx > x) - (tx < x);
+	int sy = (ty > y) - (ty < y);
+	return abs(tx - x) + abs(ty - y) + s_bends[dir][(sx + 1) * 3 + sy + 1][arrival + 1] * bendPenalty;
+}
+
+static void AddRoutePoint(CArray< CPoint, CPoint >& points, CPoint pt)
+{
+	// Skip duplicates, and merge collinear points
+	INT_PTR size = points.GetSize();
+	if (size && points[size - 1] == pt)
+		return;
+
+	if (size >= 2)
+	{
+		CPoint prev = points[size - 1];
+		CPoint prev2 = points[size - 2];
+		if ((prev2.x == prev.x && prev.x == pt.x) || (prev2.y == prev.y && prev.y == pt.y))
+		{
+			points[size - 1] = pt;
+			return;
+		}
+	}
+
+	points.Add(pt);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CLinkRouter construction/destruction
+
+CLinkRouter::CLinkRouter()
+/* ============================================================
+	Function :		CLinkRouter::CLinkRouter
+	Description :	Constructor
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	m_margin = DEFAULT_MARGIN;
+	m_bendPenalty = DEFAULT_BEND_PENALTY;
+	m_stateCount = 0;
+	m_search = 0;
+
+	BuildBendTable();
+
+}
+
+CLinkRouter::~CLinkRouter()
+/* ============================================================
+	Function :		CLinkRouter::~CLinkRouter
+	Description :	Destructor
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	Clear();
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CLinkRouter input
+
+void CLinkRouter::Clear()
+/* ============================================================
+	Function :		CLinkRouter::Clear
+	Description :	Removes all obstacles and links.
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Call to reuse the object for another
+					diagram.
+
+   ============================================================*/
+{
+
+	INT_PTR count = m_links.GetSize();
+	for (INT_PTR t = 0; t < count; t++)
+		delete m_links[t];
+
+	m_links.RemoveAll();
+	m_obstacles.RemoveAll();
+
+}
+
+void CLinkRouter::SetMargin(int margin)
+/* ============================================================
+	Function :		CLinkRouter::SetMargin
+	Description :	Sets the space kept around obstacles.
+	Access :		Public
+
+	Return :		void
+	Parameters :	int margin	-	Space around obstacles.
+
+	Usage :			Also the length of the stubs at the ends
+					of a route. All routes are recalculated by
+					the next "Update".
+
+   ============================================================*/
+{
+
+	m_margin = max(margin, 1);
+
+	INT_PTR count = m_links.GetSize();
+	for (INT_PTR t = 0; t < count; t++)
+		m_links[t]->dirty = TRUE;
+
+}
+
+void CLinkRouter::SetBendPenalty(int penalty)
+/* ============================================================
+	Function :		CLinkRouter::SetBendPenalty
+	Description :	Sets the cost of a bend.
+	Access :		Public
+
+	Return :		void
+	Parameters :	int penalty	-	Cost of a bend, as route
+									length.
+
+	Usage :			A higher penalty gives longer routes with
+					fewer bends. All routes are recalculated by
+					the next "Update".
+
+   ============================================================*/
+{
+
+	m_bendPenalty = max(penalty, 0);
+
+	INT_PTR count = m_links.GetSize();
+	for (INT_PTR t = 0; t < count; t++)
+		m_links[t]->dirty = TRUE;
+
+}
+
+int CLinkRouter::AddObstacle(const CRect& rect)
+/* ============================================================
+	Function :		CLinkRouter::AddObstacle
+	Description :	Adds an obstacle.
+	Access :		Public
+
+	Return :		int					-	Index of the new
+											obstacle.
+	Parameters :	const CRect& rect	-	Rectangle of the
+											obstacle.
+
+	Usage :			Routes crossing the new obstacle are
+					recalculated by the next "Update".
+
+   ============================================================*/
+{
+
+	INT_PTR index = m_obstacles.GetSize();
+	m_obstacles.SetSize(index + 1);
+	m_obstacles.SetAt(index, 0, 0, 0, 0);
+	SetObstacle(static_cast<int>(index), rect);
+	return static_cast<int>(index);
+
+}
+
+void CLinkRouter::SetObstacle(int obstacle, const CRect& rect)
+/* ============================================================
+	Function :		CLinkRouter::SetObstacle
+	Description :	Moves or resizes an obstacle.
+	Access :		Public
+
+	Return :		void
+	Parameters :	int obstacle		-	Index of the obstacle.
+					const CRect& rect	-	New rectangle, empty
+											to remove the obstacle.
+
+	Usage :			The links attached to the obstacle, and the
+					links with routes near the old or the new
+					rectangle, are recalculated by the next
+					"Update". Nothing happens if the rectangle
+					is unchanged, so this can be called for all
+					obstacles every time something might have
+					moved.
+
+   ============================================================*/
+{
+
+	if (obstacle < 0 || obstacle >= m_obstacles.GetSize())
+		return;
+
+	CRect old(static_cast<int>(m_obstacles.GetAt(obstacle, BOUNDS_LEFT)),
+		static_cast<int>(m_obstacles.GetAt(obstacle, BOUNDS_TOP)),
+		static_cast<int>(m_obstacles.GetAt(obstacle, BOUNDS_RIGHT)),
+		static_cast<int>(m_obstacles.GetAt(obstacle, BOUNDS_BOTTOM)));
+	CRect current(rect);
+	current.NormalizeRect();
+	if (current == old)
+		return;
+
+	m_obstacles.SetAt(obstacle, current.left, current.top, current.right, current.bottom);
+
+	if (!old.IsRectEmpty())
+	{
+		old.InflateRect(m_margin, m_margin);
+		Invalidate(old);
+	}
+	if (!current.IsRectEmpty())
+	{
+		current.InflateRect(m_margin, m_margin);
+		Invalidate(current);
+	}
+
+	INT_PTR count = m_links.GetSize();
+	for (INT_PTR t = 0; t < count; t++)
+	{
+		CLink* link = m_links[t];
+		if (link->from == obstacle || link->to == obstacle)
+			link->dirty = TRUE;
+	}
+
+}
+
+int CLinkRouter::AddLink(int from, int to)
+/* ============================================================
+	Function :		CLinkRouter::AddLink
+	Description :	Adds a link.
+	Access :		Public
+
+	Return :		int			-	Index of the new link.
+	Parameters :	int from	-	Obstacle at the start, -1
+									if none.
+					int to		-	Obstacle at the end, -1 if
+									none.
+
+	Usage :			The link gets a route when the ends are
+					set with "SetLinkEnds". The obstacles are
+					only used to know which links to
+					recalculate when an obstacle changes.
+
+   ============================================================*/
+{
+
+	CLink* link = new CLink;
+	link->from = from;
+	link->to = to;
+	link->startSide = ROUTE_ANY;
+	link->endSide = ROUTE_ANY;
+	link->valid = FALSE;
+	link->dirty = TRUE;
+	link->bounds.SetRectEmpty();
+	return static_cast<int>(m_links.Add(link));
+
+}
+
+void CLinkRouter::SetLinkEnds(int link, CPoint start, int startSide, CPoint end, int endSide)
+/* ============================================================
+	Function :		CLinkRouter::SetLinkEnds
+	Description :	Sets the ends of a link.
+	Access :		Public
+
+	Return :		void
+	Parameters :	int link		-	Index of the link.
+					CPoint start	-	Start point.
+					int startSide	-	Side of the start obstacle
+										the point is on, one of the
+										"ROUTE_"-constants.
+					CPoint end		-	End point.
+					int endSide		-	Side of the end obstacle
+										the point is on.
+
+	Usage :			The route leaves and enters at right
+					angles to the sides, "ROUTE_ANY" allows any
+					direction. Nothing happens if the ends are
+					unchanged.
+
+   ============================================================*/
+{
+
+	if (link < 0 || link >= m_links.GetSize())
+		return;
+
+	CLink* data = m_links[link];
+	if (data->valid && data->start == start && data->startSide == startSide && data->end == end && data->endSide == endSide)
+		return;
+
+	data->start = start;
+	data->startSide = startSide;
+	data->end = end;
+	data->endSide = endSide;
+	data->valid = TRUE;
+	data->dirty = TRUE;
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CLinkRouter operations
+
+int CLinkRouter::Update()
+/* ============================================================
+	Function :		CLinkRouter::Update
+	Description :	Recalculates the routes that are out of
+					date.
+	Access :		Public
+
+	Return :		int		-	Number of routes recalculated.
+	Parameters :	none
+
+	Usage :			Call before getting the routes with
+					"GetRoute".
+
+   ============================================================*/
+{
+
+	int routed = 0;
+	INT_PTR count = m_links.GetSize();
+	for (INT_PTR t = 0; t < count; t++)
+	{
+		CLink* link = m_links[t];
+		if (!link->valid || !link->dirty)
+			continue;
+
+		Route(link->start, link->startSide, link->end, link->endSide, link->points);
+
+		INT_PTR points = link->points.GetSize();
+		link->bounds.SetRect(link->points[0], link->points[0]);
+		for (INT_PTR i = 1; i < points; i++)
+		{
+			CPoint pt = link->points[i];
+			link->bounds.left = min(link->bounds.left, pt.x);
+			link->bounds.top = min(link->bounds.top, pt.y);
+			link->bounds.right = max(link->bounds.right, pt.x);
+			link->bounds.bottom = max(link->bounds.bottom, pt.y);
+		}
+
+		link->dirty = FALSE;
+		routed++;
+	}
+
+	return routed;
+
+}
+
+BOOL CLinkRouter::Route(CPoint start, int startSide, CPoint end, int endSide, CArray< CPoint, CPoint >& points)
+/* ============================================================
+	Function :		CLinkRouter::Route
+	Description :	Finds a route between two points.
+	Access :		Public
+
+	Return :		BOOL				-	"FALSE" if no route
+											around the obstacles
+											was found.
+	Parameters :	CPoint start		-	Start point.
+					int startSide		-	Side the start point
+											is on.
+					CPoint end			-	End point.
+					int endSide			-	Side the end point is
+											on.
+					CArray< CPoint, CPoint >& points	-	Gets the
+											corners of the route,
+											from start to end.
+
+	Usage :			The route is not cached. If no route is
+					found, "points" gets a route with a single
+					bend between the stubs. All segments are
+					horizontal or vertical in both cases, and
+					there are always at least two points.
+
+   ============================================================*/
+{
+
+	points.RemoveAll();
+
+	CPoint from = GetStub(start, startSide);
+	CPoint to = GetStub(end, endSide);
+
+	CRect region;
+	INT_PTR obstacles = CollectObstacles(from, to, region);
+	BuildGrid(from, to, region, obstacles);
+
+	// If the exact search takes too long, a search weighted
+	// towards the end finds a route that might not be the best
+	int fromx = FindCoordinate(m_xs, from.x);
+	int fromy = FindCoordinate(m_ys, from.y);
+	int tox = FindCoordinate(m_xs, to.x);
+	int toy = FindCoordinate(m_ys, to.y);
+	CArray< CPoint, CPoint > path;
+	BOOL result = Search(fromx, fromy, startSide, tox, toy, endSide, 1, path);
+	if (!result)
+		result = Search(fromx, fromy, startSide, tox, toy, endSide, GREEDY_WEIGHT, path);
+
+	AddRoutePoint(points, start);
+	AddRoutePoint(points, from);
+	if (result)
+	{
+		INT_PTR size = path.GetSize();
+		for (INT_PTR t = 0; t < size; t++)
+			AddRoutePoint(points, path[t]);
+	}
+	else
+	{
+		AddRoutePoint(points, CPoint(to.x, from.y));
+	}
+	AddRoutePoint(points, to);
+	AddRoutePoint(points, end);
+
+	if (points.GetSize() < 2)
+		points.Add(end);
+
+	return result;
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CLinkRouter results
+
+INT_PTR CLinkRouter::GetRoute(int link, CArray< CPoint, CPoint >& points) const
+/* ============================================================
+	Function :		CLinkRouter::GetRoute
+	Description :	Gets the cached route of a link.
+	Access :		Public
+
+	Return :		INT_PTR		-	Number of points, 0 if the
+									link has no route.
+	Parameters :	int link	-	Index of the link.
+					CArray< CPoint, CPoint >& points	-	Gets
+									the corners of the route,
+									from start to end.
+
+	Usage :			Call "Update" first.
+
+   ============================================================*/
+{
+
+	points.RemoveAll();
+	if (link >= 0 && link < m_links.GetSize() && m_links[link]->valid)
+		points.Copy(m_links[link]->points);
+
+	return points.GetSize();
+
+}
+
+int CLinkRouter::GetObstacleCount() const
+/* ============================================================
+	Function :		CLinkRouter::GetObstacleCount
+	Description :	Returns the number of obstacles.
+	Access :		Public
+
+	Return :		int	-	Number of obstacles.
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	return static_cast<int>(m_obstacles.GetSize());
+
+}
+
+int CLinkRouter::GetLinkCount() const
+/* ============================================================
+	Function :		CLinkRouter::GetLinkCount
+	Description :	Returns the number of links.
+	Access :		Public
+
+	Return :		int	-	Number of links.
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	return static_cast<int>(m_links.GetSize());
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CLinkRouter helpers
+
+void CLinkRouter::Invalidate(const CRect& rect)
+/* ============================================================
+	Function :		CLinkRouter::Invalidate
+	Description :	Marks the routes touching a rectangle for
+					recalculation.
+	Access :		Private
+
+	Return :		void
+	Parameters :	const CRect& rect	-	Rectangle to test.
+
+	Usage :			Called when an obstacle changes. Routes
+					running along the edge of the rectangle are
+					included, as they might get shorter.
+
+   ============================================================*/
+{
+
+	INT_PTR count = m_links.GetSize();
+	for (INT_PTR t = 0; t < count; t++)
+	{
+		CLink* link = m_links[t];
+		if (!link->valid || link->dirty)
+			continue;
+
+		if (link->bounds.right < rect.left || link->bounds.left > rect.right ||
+			link->bounds.bottom < rect.top || link->bounds.top > rect.bottom)
+			continue;
+
+		INT_PTR points = link->points.GetSize();
+		for (INT_PTR i = 1; i < points; i++)
+		{
+			CPoint p1 = link->points[i - 1];
+			CPoint p2 = link->points[i];
+			if (max(p1.x, p2.x) >= rect.left && min(p1.x, p2.x) <= rect.right &&
+				max(p1.y, p2.y) >= rect.top && min(p1.y, p2.y) <= rect.bottom)
+			{
+				link->dirty = TRUE;
+				break;
+			}
+		}
+	}
+
+}
+
+CPoint CLinkRouter::GetStub(CPoint point, int side) const
+/* ============================================================
+	Function :		CLinkRouter::GetStub
+	Description :	Gets the end of the stub from "point".
+	Access :		Private
+
+	Return :		CPoint			-	End of the stub.
+	Parameters :	CPoint point	-	Start or end of a route.
+					int side		-	Side "point" is on.
+
+	Usage :			The stub runs straight out from the side,
+					to the edge of the margin.
+
+   ============================================================*/
+{
+
+	switch (side)
+	{
+	case ROUTE_LEFT:
+		point.x -= m_margin;
+		break;
+	case ROUTE_RIGHT:
+		point.x += m_margin;
+		break;
+	case ROUTE_TOP:
+		point.y -= m_margin;
+		break;
+	case ROUTE_BOTTOM:
+		point.y += m_margin;
+		break;
+	}
+
+	return point;
+
+}
+
+INT_PTR CLinkRouter::CollectObstacles(CPoint from, CPoint to, CRect& region)
+/* ============================================================
+	Function :		CLinkRouter::CollectObstacles
+	Description :	Finds the obstacles to route around.
+	Access :		Private
+
+	Return :		INT_PTR			-	Number of obstacles.
+	Parameters :	CPoint from		-	End of the start stub.
+					CPoint to		-	End of the end stub.
+					CRect& region	-	Gets the region to search.
+
+	Usage :			The obstacles are put in "m_found". The
+					region starts as the rectangle between the
+					stubs, and grows to take in the obstacles
+					touching it. Obstacles containing a stub
+					end are skipped, as the route has to start
+					there anyway. If there are too many
+					obstacles, the ones closest to the stubs
+					are kept.
+
+   ============================================================*/
+{
+
+	region.SetRect(min(from.x, to.x), min(from.y, to.y), max(from.x, to.x), max(from.y, to.y));
+
+	INT_PTR found = 0;
+	for (int pass = 0; pass < MAX_REGION_PASSES; pass++)
+	{
+		found = m_obstacles.GetIntersecting(region.left - m_margin, region.top - m_margin, region.right + m_margin, region.bottom + m_margin, m_found);
+		if (found > MAX_OBSTACLES)
+			break;
+
+		CRect grown(region);
+		for (INT_PTR t = 0; t < found; t++)
+		{
+			INT_PTR index = m_found[t];
+			if (m_obstacles.GetAt(index, BOUNDS_LEFT) == m_obstacles.GetAt(index, BOUNDS_RIGHT) ||
+				m_obstacles.GetAt(index, BOUNDS_TOP) == m_obstacles.GetAt(index, BOUNDS_BOTTOM))
+				continue;
+
+			grown.left = min(grown.left, static_cast<int>(m_obstacles.GetAt(index, BOUNDS_LEFT)) - m_margin);
+			grown.top = min(grown.top, static_cast<int>(m_obstacles.GetAt(index, BOUNDS_TOP)) - m_margin);
+			grown.right = max(grown.right, static_cast<int>(m_obstacles.GetAt(index, BOUNDS_RIGHT)) + m_margin);
+			grown.bottom = max(grown.bottom, static_cast<int>(m_obstacles.GetAt(index, BOUNDS_BOTTOM)) + m_margin);
+		}
+
+		if (grown == region)
+			break;
+		region = grown;
+	}
+
+	found = m_obstacles.GetIntersecting(region.left - m_margin, region.top - m_margin, region.right + m_margin, region.bottom + m_margin, m_found);
+
+	// Skip empty obstacles, and obstacles containing a stub end
+	INT_PTR count = 0;
+	for (INT_PTR t = 0; t < found; t++)
+	{
+		INT_PTR index = m_found[t];
+		CRect rect(static_cast<int>(m_obstacles.GetAt(index, BOUNDS_LEFT)),
+			static_cast<int>(m_obstacles.GetAt(index, BOUNDS_TOP)),
+			static_cast<int>(m_obstacles.GetAt(index, BOUNDS_RIGHT)),
+			static_cast<int>(m_obstacles.GetAt(index, BOUNDS_BOTTOM)));
+		if (rect.IsRectEmpty())
+			continue;
+
+		rect.InflateRect(m_margin, m_margin);
+		if ((from.x > rect.left && from.x < rect.right && from.y > rect.top && from.y < rect.bottom) ||
+			(to.x > rect.left && to.x < rect.right && to.y > rect.top && to.y < rect.bottom))
+			continue;
+
+		m_found[count++] = m_found[t];
+	}
+	m_found.SetSize(count);
+
+	if (count > MAX_OBSTACLES)
+	{
+		CRect box(min(from.x, to.x), min(from.y, to.y), max(from.x, to.x), max(from.y, to.y));
+		CArray< ROUTE_KEY, ROUTE_KEY& > keys;
+		keys.SetSize(count);
+		for (INT_PTR t = 0; t < count; t++)
+		{
+			INT_PTR index = m_found[t];
+			int x = static_cast<int>((m_obstacles.GetAt(index, BOUNDS_LEFT) + m_obstacles.GetAt(index, BOUNDS_RIGHT)) / 2);
+			int y = static_cast<int>((m_obstacles.GetAt(index, BOUNDS_TOP) + m_obstacles.GetAt(index, BOUNDS_BOTTOM)) / 2);
+			keys[t].distance = max(max(box.left - x, x - box.right), 0) + max(max(box.top - y, y - box.bottom), 0);
+			keys[t].index = static_cast<int>(index);
+		}
+		qsort(keys.GetData(), count, sizeof(ROUTE_KEY), CompareRouteKeys);
+
+		count = MAX_OBSTACLES;
+		for (INT_PTR t = 0; t < count; t++)
+			m_found[t] = keys[t].index;
+		m_found.SetSize(count);
+	}
+
+	return count;
+
+}
+
+void CLinkRouter::BuildGrid(CPoint from, CPoint to, const CRect& region, INT_PTR obstacles)
+/* ============================================================
+	Function :		CLinkRouter::BuildGrid
+	Description :	Builds the grid to search.
+	Access :		Private
+
+	Return :		void
+	Parameters :	CPoint from				-	End of the start stub.
+					CPoint to				-	End of the end stub.
+					const CRect& region		-	Region to search.
+					INT_PTR obstacles		-	Number of obstacles
+												in "m_found".
+
+	Usage :			The grid lines are the edges of the grown
+					obstacles, the lines through the stub ends
+					and halfway between them, and a frame one
+					margin outside the region. Nodes inside an
+					obstacle, and edges crossing one, are
+					blocked. Edges along the sides of an
+					obstacle are open.
+
+   ============================================================*/
+{
+
+	CRect outer(region);
+	outer.InflateRect(m_margin, m_margin);
+
+	m_xs.RemoveAll();
+	m_ys.RemoveAll();
+	m_xs.Add(outer.left);
+	m_xs.Add(outer.right);
+	m_xs.Add(from.x);
+	m_xs.Add(to.x);
+	m_xs.Add((from.x + to.x) / 2);
+	m_ys.Add(outer.top);
+	m_ys.Add(outer.bottom);
+	m_ys.Add(from.y);
+	m_ys.Add(to.y);
+	m_ys.Add((from.y + to.y) / 2);
+
+	for (INT_PTR t = 0; t < obstacles; t++)
+	{
+		INT_PTR index = m_found[t];
+		int left = static_cast<int>(m_obstacles.GetAt(index, BOUNDS_LEFT)) - m_margin;
+		int top = static_cast<int>(m_obstacles.GetAt(index, BOUNDS_TOP)) - m_margin;
+		int right = static_cast<int>(m_obstacles.GetAt(index, BOUNDS_RIGHT)) + m_margin;
+		int bottom = static_cast<int>(m_obstacles.GetAt(index, BOUNDS_BOTTOM)) + m_margin;
+		if (left > outer.left)
+			m_xs.Add(left);
+		if (right < outer.right)
+			m_xs.Add(right);
+		if (top > outer.top)
+			m_ys.Add(top);
+		if (bottom < outer.bottom)
+			m_ys.Add(bottom);
+	}
+
+	SortCoordinates(m_xs);
+	SortCoordinates(m_ys);
+
+	int gx = static_cast<int>(m_xs.GetSize());
+	int gy = static_cast<int>(m_ys.GetSize());
+	m_blocked.SetSize(gx * gy);
+	memset(m_blocked.GetData(), 0, gx * gy);
+	BYTE* blocked = m_blocked.GetData();
+
+	for (INT_PTR t = 0; t < obstacles; t++)
+	{
+		INT_PTR index = m_found[t];
+		int left = static_cast<int>(m_obstacles.GetAt(index, BOUNDS_LEFT)) - m_margin;
+		int top = static_cast<int>(m_obstacles.GetAt(index, BOUNDS_TOP)) - m_margin;
+		int right = static_cast<int>(m_obstacles.GetAt(index, BOUNDS_RIGHT)) + m_margin;
+		int bottom = static_cast<int>(m_obstacles.GetAt(index, BOUNDS_BOTTOM)) + m_margin;
+
+		// Grid lines strictly inside the obstacle
+		int i0 = FindCoordinate(m_xs, left + 1);
+		int i1 = FindCoordinate(m_xs, right) - 1;
+		int j0 = FindCoordinate(m_ys, top + 1);
+		int j1 = FindCoordinate(m_ys, bottom) - 1;
+
+		// Nodes inside, and horizontal edges crossing
+		for (int j = j0; j <= j1; j++)
+		{
+			BYTE* row = blocked + j * gx;
+			for (int i = i0; i <= i1; i++)
+				row[i] |= NODE_BLOCKED;
+			for (int i = max(i0 - 1, 0); i <= min(i1, gx - 2); i++)
+				row[i] |= EAST_BLOCKED;
+		}
+
+		// Vertical edges crossing
+		for (int j = max(j0 - 1, 0); j <= min(j1, gy - 2); j++)
+		{
+			BYTE* row = blocked + j * gx;
+			for (int i = i0; i <= i1; i++)
+				row[i] |= SOUTH_BLOCKED;
+		}
+	}
+
+}
+
+BOOL CLinkRouter::Search(int fromx, int fromy, int startSide, int tox, int toy, int endSide, int weight, CArray< CPoint, CPoint >& path)
+/* ============================================================
+	Function :		CLinkRouter::Search
+	Description :	Runs A* on the grid.
+	Access :		Private
+
+	Return :		BOOL			-	"TRUE" if a path was found.
+	Parameters :	int fromx		-	Grid column of the start.
+					int fromy		-	Grid row of the start.
+					int startSide	-	Side the route starts from.
+					int tox			-	Grid column of the end.
+					int toy			-	Grid row of the end.
+					int endSide		-	Side the route ends at.
+					int weight		-	Weight of the estimate, 1
+										for the best path.
+					CArray< CPoint, CPoint >& path	-	Gets the
+									grid nodes of the path.
+
+	Usage :			A state is a node and the direction it was
+					entered in, so bends can be counted. The
+					path starts in the direction of the start
+					side, and a bend is added if it does not
+					arrive in the direction of the end side.
+					U-turns are not allowed. The search gives
+					up after "MAX_EXPANSIONS" times "weight"
+					states, so a route through a crowded
+					diagram does not stall the editor. A
+					weight above 1 makes the search head for
+					the end, expanding far fewer states, at the
+					price of a route that might be longer than
+					needed.
+
+   ============================================================*/
+{
+
+	path.RemoveAll();
+
+	int gx = static_cast<int>(m_xs.GetSize());
+	int gy = static_cast<int>(m_ys.GetSize());
+	int goal = gx * gy * 4;
+
+	// The search number tells which table entries belong to this
+	// search, so the table need not be cleared
+	if (m_states.GetSize() < MIN_STATE_TABLE)
+	{
+		m_states.SetSize(MIN_STATE_TABLE);
+		memset(m_states.GetData(), 0, MIN_STATE_TABLE * sizeof(CState));
+	}
+	m_search++;
+	if (m_search == 0)
+	{
+		memset(m_states.GetData(), 0, m_states.GetSize() * sizeof(CState));
+		m_search = 1;
+	}
+	m_stateCount = 0;
+
+	const BYTE* blocked = m_blocked.GetData();
+	const int* xs = m_xs.GetData();
+	const int* ys = m_ys.GetData();
+	int tx = xs[tox];
+	int ty = ys[toy];
+
+	int startDir = GetDirection(startSide);
+	int endDir = GetDirection(endSide);
+	int arrival = endDir < 0 ? -1 : (endDir ^ 1);
+
+	m_queue.RemoveAll();
+	for (int dir = 0; dir < 4; dir++)
+	{
+		if (startDir >= 0 && dir != startDir)
+			continue;
+
+		int state = (fromy * gx + fromx) * 4 + dir;
+		CState* data = GetState(state, TRUE);
+		data->cost = 0;
+		int remaining = Estimate(xs[fromx], ys[fromy], dir, tx, ty, arrival, m_bendPenalty) * weight;
+		Push(remaining, remaining, state);
+	}
+
+	BOOL found = FALSE;
+	int expanded = 0;
+	while (m_queue.GetSize() && expanded < MAX_EXPANSIONS * weight)
+	{
+		int estimate = 0;
+		int state = Pop(estimate);
+		if (state == goal)
+		{
+			found = TRUE;
+			break;
+		}
+
+		int node = state / 4;
+		int dir = state % 4;
+		int i = node % gx;
+		int j = node / gx;
+		int g = GetState(state, FALSE)->cost;
+
+		// Skip entries made stale by a cheaper path
+		if (estimate > g + Estimate(xs[i], ys[j], dir, tx, ty, arrival, m_bendPenalty) * weight)
+			continue;
+		expanded++;
+
+		if (i == tox && j == toy)
+		{
+			int total = g;
+			if (arrival >= 0 && dir != arrival)
+				total += m_bendPenalty;
+			CState* data = GetState(goal, TRUE);
+			if (total < data->cost)
+			{
+				data->cost = total;
+				data->parent = state;
+				Push(total, 0, goal);
+			}
+			continue;
+		}
+
+		for (int next = 0; next < 4; next++)
+		{
+			if (next == (dir ^ 1))
+				continue;
+
+			int ni = i + s_dx[next];
+			int nj = j + s_dy[next];
+			if (ni < 0 || ni >= gx || nj < 0 || nj >= gy)
+				continue;
+
+			if ((next == DIR_EAST && (blocked[j * gx + i] & EAST_BLOCKED)) ||
+				(next == DIR_WEST && (blocked[nj * gx + ni] & EAST_BLOCKED)) ||
+				(next == DIR_SOUTH && (blocked[j * gx + i] & SOUTH_BLOCKED)) ||
+				(next == DIR_NORTH && (blocked[nj * gx + ni] & SOUTH_BLOCKED)) ||
+				(blocked[nj * gx + ni] & NODE_BLOCKED))
+				continue;
+
+			int total = g + abs(xs[ni] - xs[i]) + abs(ys[nj] - ys[j]);
+			if (next != dir)
+				total += m_bendPenalty;
+
+			int nextState = (nj * gx + ni) * 4 + next;
+			CState* data = GetState(nextState, TRUE);
+			if (total < data->cost)
+			{
+				data->cost = total;
+				data->parent = state;
+				int remaining = Estimate(xs[ni], ys[nj], next, tx, ty, arrival, m_bendPenalty) * weight;
+				Push(total + remaining, remaining, nextState);
+			}
+		}
+	}
+
+	if (found)
+	{
+		for (int state = GetState(goal, FALSE)->parent; state >= 0; state = GetState(state, FALSE)->parent)
+		{
+			int node = state / 4;
+			path.Add(CPoint(xs[node % gx], ys[node / gx]));
+		}
+
+		INT_PTR size = path.GetSize();
+		for (INT_PTR t = 0; t < size / 2; t++)
+		{
+			CPoint pt = path[t];
+			path[t] = path[size - 1 - t];
+			path[size - 1 - t] = pt;
+		}
+	}
+
+	return found;
+
+}
+
+CLinkRouter::CState* CLinkRouter::GetState(int state, BOOL add)
+/* ============================================================
+	Function :		CLinkRouter::GetState
+	Description :	Finds a state in the state table.
+	Access :		Private
+
+	Return :		CState*		-	The entry, "NULL" if not
+									found and "add" is "FALSE".
+	Parameters :	int state	-	State to find.
+					BOOL add	-	"TRUE" to add the state if
+									it is not found.
+
+	Usage :			A new entry has an infinite cost. The
+					table doubles when it is half full, so the
+					pointer is only valid until the next call.
+					Only the states a search reaches are
+					stored, so the memory used does not depend
+					on the size of the grid.
+
+   ============================================================*/
+{
+
+	if (add && (m_stateCount + 1) * 2 > m_states.GetSize())
+	{
+		// Rehash the entries of this search into a larger table
+		CArray< CState, CState& > old;
+		old.Copy(m_states);
+		INT_PTR size = old.GetSize();
+		m_states.SetSize(size * 2);
+		memset(m_states.GetData(), 0, size * 2 * sizeof(CState));
+		m_stateCount = 0;
+		for (INT_PTR t = 0; t < size; t++)
+		{
+			if (old[t].search == m_search)
+			{
+				CState* data = GetState(old[t].state, TRUE);
+				data->cost = old[t].cost;
+				data->parent = old[t].parent;
+			}
+		}
+	}
+
+	CState* states = m_states.GetData();
+	UINT mask = static_cast<UINT>(m_states.GetSize()) - 1;
+	UINT slot = (static_cast<UINT>(state) * 2654435761U) & mask;
+	while (states[slot].search == m_search)
+	{
+		if (states[slot].state == state)
+			return &states[slot];
+		slot = (slot + 1) & mask;
+	}
+
+	if (!add)
+		return NULL;
+
+	states[slot].state = state;
+	states[slot].cost = INT_MAX;
+	states[slot].parent = -1;
+	states[slot].search = m_search;
+	m_stateCount++;
+	return &states[slot];
+
+}
+
+void CLinkRouter::Push(int cost, int remaining, int state)
+/* ============================================================
+	Function :		CLinkRouter::Push
+	Description :	Adds a state to the search queue.
+	Access :		Private
+
+	Return :		void
+	Parameters :	int cost		-	Estimated total cost.
+					int remaining	-	Estimated cost left.
+					int state		-	State to add.
+
+	Usage :			The queue is a binary heap. Of states with
+					the same total cost, the one closest to the
+					end comes first, so the search goes
+					straight for the end when nothing is in the
+					way. Remaining ties are broken on the
+					state, so the result does not depend on the
+					order states are added.
+
+   ============================================================*/
+{
+
+	CQueueItem item;
+	item.cost = cost;
+	item.remaining = remaining;
+	item.state = state;
+
+	INT_PTR pos = m_queue.Add(item);
+	CQueueItem* queue = m_queue.GetData();
+	while (pos > 0)
+	{
+		INT_PTR up = (pos - 1) / 2;
+		if (!IsBefore(item, queue[up]))
+			break;
+		queue[pos] = queue[up];
+		pos = up;
+	}
+	queue[pos] = item;
+
+}
+
+int CLinkRouter::Pop(int& cost)
+/* ============================================================
+	Function :		CLinkRouter::Pop
+	Description :	Removes the first state from the search
+					queue.
+	Access :		Private
+
+	Return :		int			-	The state.
+	Parameters :	int& cost	-	Gets the estimated total
+									cost of the state.
+
+	Usage :			The queue must not be empty.
+
+   ============================================================*/
+{
+
+	CQueueItem* queue = m_queue.GetData();
+	INT_PTR size = m_queue.GetSize() - 1;
+	int result = queue[0].state;
+	cost = queue[0].cost;
+
+	CQueueItem item = queue[size];
+	INT_PTR pos = 0;
+	for (;;)
+	{
+		INT_PTR down = pos * 2 + 1;
+		if (down >= size)
+			break;
+		if (down + 1 < size && IsBefore(queue[down + 1], queue[down]))
+			down++;
+		if (!IsBefore(queue[down], item))
+			break;
+		queue[pos] = queue[down];
+		pos = down;
+	}
+	queue[pos] = item;
+	m_queue.RemoveAt(size);
+
+	return result;
+
+}
+
+BOOL CLinkRouter::IsBefore(const CQueueItem& item1, const CQueueItem& item2)
+/* ============================================================
+	Function :		CLinkRouter::IsBefore
+	Description :	Compares two queue entries.
+	Access :		Private
+
+	Return :		BOOL						-	"TRUE" if
+													"item1" comes
+													first.
+	Parameters :	const CQueueItem& item1	-	First entry.
+					const CQueueItem& item2	-	Second entry.
+
+	Usage :			Orders on total cost, then on the cost
+					left, then on the state.
+
+   ============================================================*/
+{
+
+	if (item1.cost != item2.cost)
+		return item1.cost < item2.cost;
+	if (item1.remaining != item2.remaining)
+		return item1.remaining < item2.remaining;
+	return item1.state < item2.state;
+
+}
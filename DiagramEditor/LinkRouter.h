@@ -0,0 +1,108 @@
+#ifndef _CLINKROUTER_H_92C4E7B1_3D58_4A06_B8F2D15E6A0C7
+#define _CLINKROUTER_H_92C4E7B1_3D58_4A06_B8F2D15E6A0C7
+
+///////////////////////////////////////////////////////////
+// File :		LinkRouter.h
+// Created :	10/19/26
+//
+
+#include <afxtempl.h>
+#include "BoundsArray.h"
+
+// Sides a route leaves or enters an obstacle from. Same values
+// as the "LINK_" types of the flowchart and UML editors.
+#define ROUTE_ANY		0
+#define ROUTE_LEFT		1
+#define ROUTE_RIGHT		2
+#define ROUTE_TOP		4
+#define ROUTE_BOTTOM	8
+
+class CLinkRouter
+{
+public:
+	// Construction/destruction
+	CLinkRouter();
+	virtual ~CLinkRouter();
+
+	// Input
+	void		Clear();
+	void		SetMargin(int margin);
+	void		SetBendPenalty(int penalty);
+	int			AddObstacle(const CRect& rect);
+	void		SetObstacle(int obstacle, const CRect& rect);
+	int			AddLink(int from, int to);
+	void		SetLinkEnds(int link, CPoint start, int startSide, CPoint end, int endSide);
+
+	// Operations
+	int			Update();
+	BOOL		Route(CPoint start, int startSide, CPoint end, int endSide, CArray< CPoint, CPoint >& points);
+
+	// Results
+	INT_PTR		GetRoute(int link, CArray< CPoint, CPoint >& points) const;
+	int			GetObstacleCount() const;
+	int			GetLinkCount() const;
+
+private:
+	// Cached route of a link
+	struct CLink
+	{
+		int			from;		// Obstacles at the ends, -1 if none
+		int			to;
+		CPoint		start;
+		CPoint		end;
+		int			startSide;
+		int			endSide;
+		BOOL		valid;		// TRUE when the ends are set
+		BOOL		dirty;		// TRUE if the route must be recalculated
+		CRect		bounds;		// Rectangle around the route, inclusive
+		CArray< CPoint, CPoint > points;
+	};
+
+	// Search state, in an open addressing hash table
+	struct CState
+	{
+		int		state;		// Node and direction of travel
+		int		cost;		// Cost to reach the state
+		int		parent;		// Previous state, -1 for start states
+		UINT	search;		// Search the entry belongs to
+	};
+
+	// Search queue entry
+	struct CQueueItem
+	{
+		int		cost;		// Estimated total cost
+		int		remaining;	// Estimated cost left
+		int		state;
+	};
+
+	// Input
+	CBoundsArray				m_obstacles;
+	CArray< CLink*, CLink* >	m_links;
+	int							m_margin;
+	int							m_bendPenalty;
+
+	// Working data for "Route"
+	CDWordArray					m_found;		// Obstacles near the route
+	CArray< int, int >			m_xs;			// Grid coordinates
+	CArray< int, int >			m_ys;
+	CByteArray					m_blocked;		// Blocked nodes and edges
+	CArray< CState, CState& >	m_states;
+	int							m_stateCount;
+	UINT						m_search;
+	CArray< CQueueItem, CQueueItem& > m_queue;
+
+	// Helpers
+	void		Invalidate(const CRect& rect);
+	CPoint		GetStub(CPoint point, int side) const;
+	INT_PTR		CollectObstacles(CPoint from, CPoint to, CRect& region);
+	void		BuildGrid(CPoint from, CPoint to, const CRect& region, INT_PTR obstacles);
+	BOOL		Search(int fromx, int fromy, int startSide, int tox, int toy, int endSide, int weight, CArray< CPoint, CPoint >& path);
+	CState*		GetState(int state, BOOL add);
+	void		Push(int cost, int remaining, int state);
+	int			Pop(int& cost);
+
+	static BOOL	IsBefore(const CQueueItem& item1, const CQueueItem& item2);
+
+};
+
+#endif //_CLINKROUTER_H_92C4E7B1_3D58_4A06_B8F2D15E6A0C7
@@ -0,0 +1,706 @@
+/* ==========================================================================
+	File :			ObjectPool.cpp
+
+	Class :			CObjectPool
+
+	Date :			10/19/26
+
+	Purpose :		"CObjectPool" is a fixed-size allocator for objects
+					that are created and deleted in large numbers, such as
+					UML classes, line segments, attributes, operations and
+					flowchart links.
+
+	Description :	The pool allocates memory in blocks of "blocksize"
+					slots, and keeps released slots in a free list.
+					Allocating and freeing an object is a list push or
+					pop instead of a heap call, and the objects of a
+					document, undo snapshot or clipboard copy end up
+					next to each other in memory.
+
+					Requests larger than the slot size are passed on to
+					the global heap. This happens when a class derived
+					from a pooled class (for example
+					"CUMLEntityClassTemplate") is created, as the derived
+					class inherits the operators.
+
+					Each thread keeps a small cache of free slots for
+					each pool, so most allocations take no lock. The
+					cache is refilled from, or drained back to, the
+					shared free list "POOL_CACHE_SIZE" slots at a time,
+					under a critical section. When a thread exits, a
+					fiber local storage callback drains its caches.
+					Pools beyond the first "POOL_MAX_POOLS" have no
+					caches, and lock on every call.
+
+					Blocks are kept for reuse until "Trim" finds them
+					unused. "TrimAll", called when a diagram container
+					is cleared, trims every pool. If objects are still
+					alive when the pool is destroyed, the blocks are
+					deliberately not released.
+
+					Debug builds, and builds with "DIAGRAM_NO_POOL"
+					defined, allocate every object from the heap and
+					only count them, so that the MFC leak report shows
+					where pooled objects were allocated.
+
+	Usage :			Add "DECLARE_POOLED_ALLOC( CMyClass )" to the class
+					declaration, and
+					"IMPLEMENT_POOLED_ALLOC( CMyClass, 64 )" to the
+					implementation file. The class-wide pool is available
+					as "CMyClass::s_pool" for statistics.
+
+					A pool must not be destroyed while threads other
+					than the destroying one still use it, so pools are
+					normally static.
+
+   ========================================================================*/
+
+#include "stdafx.h"
+#include "ObjectPool.h"
+
+#include <stdlib.h>
+
+// Slot alignment. The heap guarantees this alignment for
+// the blocks themselves.
+#define POOL_ALIGN		( 2 * sizeof( void* ) )
+
+#define POOL_MAX_POOLS	64		// Pools with thread caches
+#define POOL_CACHE_SIZE	32		// Slots moved between a thread cache and the pool at a time
+
+// Free slots of one pool, kept by one thread
+struct POOL_CACHE
+{
+	LPVOID	head;
+	int		count;
+};
+
+// Pools with thread caches, by index. Constant-initialized, so
+// static pools in other files can register themselves.
+static CObjectPool*	pools[POOL_MAX_POOLS];
+static volatile LONG	poolCount = 0;
+static DWORD		poolSlot = FLS_OUT_OF_INDEXES;
+
+// The caches of the current thread, by pool index
+static __declspec(thread) POOL_CACHE threadCaches[POOL_MAX_POOLS];
+static __declspec(thread) BOOL threadRegistered = FALSE;
+
+static int ComparePointers(const void* p1, const void* p2)
+{
+	const BYTE* b1 = *static_cast<const BYTE* const*>(p1);
+	const BYTE* b2 = *static_cast<const BYTE* const*>(p2);
+	return b1 < b2 ? -1 : (b1 > b2 ? 1 : 0);
+}
+
+// Gets the index of the last block in "blocks", sorted by address,
+// starting at or before "p".
+static INT_PTR FindBlock(BYTE* const* blocks, INT_PTR count, const void* p)
+{
+	INT_PTR low = 0;
+	INT_PTR high = count - 1;
+	while (low < high)
+	{
+		INT_PTR middle = (low + high + 1) / 2;
+		if (blocks[middle] <= static_cast<const BYTE*>(p))
+			low = middle;
+		else
+			high = middle - 1;
+	}
+
+	return low;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CObjectPool construction/destruction
+
+CObjectPool::CObjectPool(size_t size, UINT blocksize)
+/* ============================================================
+	Function :		CObjectPool::CObjectPool
+	Description :	Constructor
+	Access :		Public
+
+	Return :		void
+	Parameters :	size_t size		-	Size of the objects
+										allocated from the
+										pool.
+					UINT blocksize	-	Number of objects
+										allocated in each
+										block.
+
+	Usage :			Normally created through
+					"IMPLEMENT_POOLED_ALLOC".
+
+   ============================================================*/
+{
+
+	m_size = (size + POOL_ALIGN - 1) & ~(POOL_ALIGN - 1);
+	m_blocksize = max(blocksize, 1U);
+	m_blocks = NULL;
+	m_free = NULL;
+	m_live = 0;
+	m_blockCount = 0;
+	m_index = -1;
+
+	::InitializeCriticalSection(&m_lock);
+
+#ifndef POOL_USE_HEAP
+	// Indexes are not reused, as exited threads may have
+	// left slots of a destroyed pool in their caches.
+	LONG index = ::InterlockedIncrement(&poolCount) - 1;
+	if (index < POOL_MAX_POOLS)
+	{
+		if (index == 0)
+			poolSlot = ::FlsAlloc(FlushThread);
+		m_index = static_cast<int>(index);
+		pools[m_index] = this;
+	}
+#endif
+
+}
+
+CObjectPool::~CObjectPool()
+/* ============================================================
+	Function :		CObjectPool::~CObjectPool
+	Description :	Destructor
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Releases all blocks, unless objects are
+					still alive.
+
+   ============================================================*/
+{
+
+	if (m_index >= 0)
+	{
+		pools[m_index] = NULL;
+		POOL_CACHE& cache = threadCaches[m_index];
+		if (cache.count)
+			Drain(&cache, cache.count);
+	}
+
+	if (m_live == 0)
+	{
+		while (m_blocks)
+		{
+			CNode* next = m_blocks->next;
+			::operator delete(m_blocks);
+			m_blocks = next;
+		}
+	}
+	else
+		TRACE(_T("CObjectPool: %Id objects still alive, blocks not released\n"), m_live);
+
+	::DeleteCriticalSection(&m_lock);
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CObjectPool operations
+
+void* CObjectPool::Alloc(size_t size)
+/* ============================================================
+	Function :		CObjectPool::Alloc
+	Description :	Allocates memory for one object.
+	Access :		Public
+
+	Return :		void*		-	The memory.
+	Parameters :	size_t size	-	Requested size.
+
+	Usage :			Called from the "new"-operator of a pooled
+					class. Throws a "CMemoryException" if the
+					memory could not be allocated.
+
+   ============================================================*/
+{
+
+	if (size > m_size)
+		return ::operator new(size);
+
+#ifdef POOL_USE_HEAP
+	void* p = ::operator new(size);
+	::EnterCriticalSection(&m_lock);
+	m_live++;
+	::LeaveCriticalSection(&m_lock);
+	return p;
+#else
+	if (m_index >= 0)
+	{
+		POOL_CACHE& cache = threadCaches[m_index];
+		if (cache.count == 0)
+			Refill(&cache);
+
+		CNode* node = static_cast<CNode*>(cache.head);
+		cache.head = node->next;
+		cache.count--;
+		return node;
+	}
+
+	::EnterCriticalSection(&m_lock);
+
+	if (m_free == NULL)
+	{
+		TRY
+		{
+			NewBlock();
+		}
+		CATCH_ALL(e)
+		{
+			::LeaveCriticalSection(&m_lock);
+			THROW_LAST();
+		}
+		END_CATCH_ALL
+	}
+
+	void* p = m_free;
+	m_free = m_free->next;
+	m_live++;
+
+	::LeaveCriticalSection(&m_lock);
+
+	return p;
+#endif
+
+}
+
+#ifdef _DEBUG
+void* CObjectPool::Alloc(size_t size, LPCSTR file, int line)
+/* ============================================================
+	Function :		CObjectPool::Alloc
+	Description :	Allocates memory for one object from the
+					debug heap.
+	Access :		Public
+
+	Return :		void*		-	The memory.
+	Parameters :	size_t size	-	Requested size.
+					LPCSTR file	-	Source file of the "new".
+					int line	-	Line of the "new".
+
+	Usage :			Called from the "DEBUG_NEW"-operator of a
+					pooled class, so that leaked objects are
+					reported where they were created.
+
+   ============================================================*/
+{
+
+	void* p = ::operator new(size, file, line);
+	if (size <= m_size)
+	{
+		::EnterCriticalSection(&m_lock);
+		m_live++;
+		::LeaveCriticalSection(&m_lock);
+	}
+
+	return p;
+
+}
+#endif
+
+void CObjectPool::Free(void* p, size_t size)
+/* ============================================================
+	Function :		CObjectPool::Free
+	Description :	Releases the memory for one object.
+	Access :		Public
+
+	Return :		void
+	Parameters :	void* p		-	Memory to release.
+					size_t size	-	Size of the object.
+
+	Usage :			Called from the "delete"-operator of a
+					pooled class.
+
+   ============================================================*/
+{
+
+	if (p == NULL)
+		return;
+
+	if (size > m_size)
+	{
+		::operator delete(p);
+		return;
+	}
+
+#ifdef POOL_USE_HEAP
+	::operator delete(p);
+	::EnterCriticalSection(&m_lock);
+	m_live--;
+	::LeaveCriticalSection(&m_lock);
+#else
+	CNode* node = static_cast<CNode*>(p);
+	if (m_index >= 0)
+	{
+		POOL_CACHE& cache = threadCaches[m_index];
+		node->next = static_cast<CNode*>(cache.head);
+		cache.head = node;
+		cache.count++;
+		if (cache.count >= 2 * POOL_CACHE_SIZE)
+			Drain(&cache, POOL_CACHE_SIZE);
+		return;
+	}
+
+	::EnterCriticalSection(&m_lock);
+
+	node->next = m_free;
+	m_free = node;
+	m_live--;
+
+	::LeaveCriticalSection(&m_lock);
+#endif
+
+}
+
+void CObjectPool::Trim()
+/* ============================================================
+	Function :		CObjectPool::Trim
+	Description :	Releases the blocks without live objects.
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Call when many objects have been deleted,
+					for example when a document is closed. The
+					cache of the calling thread is emptied
+					first. Slots cached by other threads keep
+					their blocks.
+
+   ============================================================*/
+{
+
+	if (m_index >= 0)
+	{
+		POOL_CACHE& cache = threadCaches[m_index];
+		if (cache.count)
+			Drain(&cache, cache.count);
+	}
+
+	::EnterCriticalSection(&m_lock);
+
+	if (m_live == 0)
+	{
+		while (m_blocks)
+		{
+			CNode* next = m_blocks->next;
+			::operator delete(m_blocks);
+			m_blocks = next;
+		}
+		m_free = NULL;
+		m_blockCount = 0;
+	}
+	else if (m_blockCount > 1)
+	{
+		// Count the free slots of each block
+		CPtrArray blocks;
+		CDWordArray unused;
+		blocks.SetSize(m_blockCount);
+		unused.SetSize(m_blockCount);
+		INT_PTR count = 0;
+		for (CNode* block = m_blocks; block; block = block->next)
+		{
+			blocks[count] = block;
+			unused[count++] = 0;
+		}
+		qsort(blocks.GetData(), count, sizeof(void*), ComparePointers);
+
+		BYTE* const* sorted = reinterpret_cast<BYTE* const*>(blocks.GetData());
+		for (CNode* node = m_free; node; node = node->next)
+			unused[FindBlock(sorted, count, node)]++;
+
+		// Drop the slots of unused blocks from the free list
+		CNode** link = &m_free;
+		while (*link)
+		{
+			if (unused[FindBlock(sorted, count, *link)] == m_blocksize)
+				*link = (*link)->next;
+			else
+				link = &(*link)->next;
+		}
+
+		m_blocks = NULL;
+		m_blockCount = 0;
+		for (INT_PTR t = count - 1; t >= 0; t--)
+		{
+			CNode* block = static_cast<CNode*>(blocks[t]);
+			if (unused[t] == m_blocksize)
+				::operator delete(block);
+			else
+			{
+				block->next = m_blocks;
+				m_blocks = block;
+				m_blockCount++;
+			}
+		}
+	}
+
+	::LeaveCriticalSection(&m_lock);
+
+}
+
+void CObjectPool::TrimAll()
+/* ============================================================
+	Function :		CObjectPool::TrimAll
+	Description :	Releases the unused blocks of all pools.
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Called when a diagram container is
+					cleared.
+
+   ============================================================*/
+{
+
+	LONG count = min(poolCount, static_cast<LONG>(POOL_MAX_POOLS));
+	for (LONG t = 0; t < count; t++)
+		if (pools[t])
+			pools[t]->Trim();
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CObjectPool attributes
+
+size_t CObjectPool::GetAllocSize() const
+/* ============================================================
+	Function :		CObjectPool::GetAllocSize
+	Description :	Gets the slot size of the pool.
+	Access :		Public
+
+	Return :		size_t	-	Slot size in bytes.
+	Parameters :	none
+
+	Usage :			Call to get the size of each slot.
+
+   ============================================================*/
+{
+
+	return m_size;
+
+}
+
+UINT CObjectPool::GetBlockSize() const
+/* ============================================================
+	Function :		CObjectPool::GetBlockSize
+	Description :	Gets the number of slots in each block.
+	Access :		Public
+
+	Return :		UINT	-	Slots per block.
+	Parameters :	none
+
+	Usage :			Call for statistics.
+
+   ============================================================*/
+{
+
+	return m_blocksize;
+
+}
+
+INT_PTR CObjectPool::GetLiveCount() const
+/* ============================================================
+	Function :		CObjectPool::GetLiveCount
+	Description :	Gets the number of objects currently
+					allocated from the pool.
+	Access :		Public
+
+	Return :		INT_PTR	-	Number of live objects.
+	Parameters :	none
+
+	Usage :			Call for statistics. Free slots cached by
+					other running threads are counted as live.
+
+   ============================================================*/
+{
+
+	if (m_index >= 0)
+		return m_live - threadCaches[m_index].count;
+
+	return m_live;
+
+}
+INT_PTR CObjectPool::GetBlockCount() const
+/* ============================================================
+	Function :		CObjectPool::GetBlockCount
+	Description :	Gets the number of blocks allocated by the
+					pool.
+	Access :		Public
+
+	Return :		INT_PTR	-	Number of blocks.
+	Parameters :	none
+
+	Usage :			Call for statistics.
+
+   ============================================================*/
+{
+
+	return m_blockCount;
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CObjectPool private helpers
+
+void CObjectPool::NewBlock()
+/* ============================================================
+	Function :		CObjectPool::NewBlock
+	Description :	Allocates a new block and adds its slots
+					to the free list.
+	Access :		Private
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Internal function. The first "POOL_ALIGN"
+					bytes of each block link the blocks. Call
+					with the lock held.
+
+   ============================================================*/
+{
+
+	BYTE* block = static_cast<BYTE*>(::operator new(POOL_ALIGN + m_size * m_blocksize));
+
+	CNode* header = reinterpret_cast<CNode*>(block);
+	header->next = m_blocks;
+	m_blocks = header;
+	m_blockCount++;
+
+	// Push the slots backwards, so that they are handed out
+	// in address order.
+	BYTE* slot = block + POOL_ALIGN + m_size * (m_blocksize - 1);
+	for (UINT t = 0; t < m_blocksize; t++)
+	{
+		CNode* node = reinterpret_cast<CNode*>(slot);
+		node->next = m_free;
+		m_free = node;
+		slot -= m_size;
+	}
+
+}
+
+void CObjectPool::Refill(LPVOID cache)
+/* ============================================================
+	Function :		CObjectPool::Refill
+	Description :	Moves free slots from the pool to a thread
+					cache.
+	Access :		Private
+
+	Return :		void
+	Parameters :	LPVOID cache	-	The "POOL_CACHE" of the
+									calling thread.
+
+	Usage :			Called from "Alloc" when the cache is
+					empty. Throws a "CMemoryException" if no
+					slot could be allocated.
+
+   ============================================================*/
+{
+
+	POOL_CACHE* target = static_cast<POOL_CACHE*>(cache);
+
+	::EnterCriticalSection(&m_lock);
+
+	int count = 0;
+	while (count < POOL_CACHE_SIZE)
+	{
+		if (m_free == NULL)
+		{
+			TRY
+			{
+				NewBlock();
+			}
+			CATCH_ALL(e)
+			{
+				if (count)
+					break;
+				::LeaveCriticalSection(&m_lock);
+				THROW_LAST();
+			}
+			END_CATCH_ALL
+		}
+
+		CNode* node = m_free;
+		m_free = node->next;
+		node->next = static_cast<CNode*>(target->head);
+		target->head = node;
+		count++;
+	}
+
+	target->count += count;
+	m_live += count;
+
+	::LeaveCriticalSection(&m_lock);
+
+	// Drain the caches when the thread exits
+	if (!threadRegistered && poolSlot != FLS_OUT_OF_INDEXES)
+	{
+		::FlsSetValue(poolSlot, threadCaches);
+		threadRegistered = TRUE;
+	}
+
+}
+
+void CObjectPool::Drain(LPVOID cache, int count)
+/* ============================================================
+	Function :		CObjectPool::Drain
+	Description :	Moves free slots from a thread cache back
+					to the pool.
+	Access :		Private
+
+	Return :		void
+	Parameters :	LPVOID cache	-	The "POOL_CACHE" of the
+									calling thread.
+					int count		-	Number of slots to move.
+
+	Usage :			Called when the cache holds too many slots,
+					and to empty it.
+
+   ============================================================*/
+{
+
+	POOL_CACHE* source = static_cast<POOL_CACHE*>(cache);
+
+	::EnterCriticalSection(&m_lock);
+
+	for (int t = 0; t < count && source->head; t++)
+	{
+		CNode* node = static_cast<CNode*>(source->head);
+		source->head = node->next;
+		source->count--;
+		node->next = m_free;
+		m_free = node;
+		m_live--;
+	}
+
+	::LeaveCriticalSection(&m_lock);
+
+}
+
+void WINAPI CObjectPool::FlushThread(PVOID)
+/* ============================================================
+	Function :		CObjectPool::FlushThread
+	Description :	Moves the cached slots of an exiting thread
+					back to their pools.
+	Access :		Private
+
+	Return :		void
+	Parameters :	PVOID	-	Not used.
+
+	Usage :			Fiber local storage callback, called by
+					Windows when a thread that has allocated
+					from a pool exits.
+
+   ============================================================*/
+{
+
+	LONG count = min(poolCount, static_cast<LONG>(POOL_MAX_POOLS));
+	for (LONG t = 0; t < count; t++)
+	{
+		POOL_CACHE& cache = threadCaches[t];
+		if (cache.count && pools[t])
+			pools[t]->Drain(&cache, cache.count);
+	}
+
+}
@@ -0,0 +1,90 @@
+#ifndef _COBJECTPOOL_H_5E3A1C72_9B4D_4F08_A6E1D27C84B3
+#define _COBJECTPOOL_H_5E3A1C72_9B4D_4F08_A6E1D27C84B3
+
+///////////////////////////////////////////////////////////
+// File :		ObjectPool.h
+// Created :	10/19/26
+//
+
+// Debug builds allocate pooled objects from the heap, so that leaks
+// are reported with file and line. Define "DIAGRAM_NO_POOL" to do
+// the same in release builds, to compare timings.
+#if defined(_DEBUG) || defined(DIAGRAM_NO_POOL)
+#define POOL_USE_HEAP
+#endif
+
+class CObjectPool
+{
+public:
+	// Construction/destruction
+	CObjectPool(size_t size, UINT blocksize = 64);
+	virtual ~CObjectPool();
+
+	// Operations
+	void*	Alloc(size_t size);
+#ifdef _DEBUG
+	void*	Alloc(size_t size, LPCSTR file, int line);
+#endif
+	void	Free(void* p, size_t size);
+	void	Trim();
+
+	static void	TrimAll();
+
+	// Attributes
+	size_t	GetAllocSize() const;
+	UINT	GetBlockSize() const;
+	INT_PTR	GetLiveCount() const;
+	INT_PTR	GetBlockCount() const;
+
+private:
+	struct CNode
+	{
+		CNode* next;
+	};
+
+	// Data
+	size_t	m_size;			// Slot size, aligned
+	UINT	m_blocksize;	// Slots per block
+	CNode*	m_blocks;		// Allocated blocks
+	CNode*	m_free;			// Free slots not in a thread cache
+	INT_PTR	m_live;			// Slots in use or in a thread cache
+	INT_PTR	m_blockCount;	// Number of allocated blocks
+	int		m_index;		// Index of the thread caches, -1 if there are none
+
+	CRITICAL_SECTION	m_lock;
+
+	// Helpers
+	void	NewBlock();
+	void	Refill(LPVOID cache);
+	void	Drain(LPVOID cache, int count);
+
+	static void WINAPI	FlushThread(PVOID);
+
+};
+
+// Debug placement forms, so that DEBUG_NEW still compiles
+// for pooled classes.
+#ifdef _DEBUG
+#define DECLARE_POOLED_ALLOC_DEBUG(class_name) \
+	void* operator new(size_t size, LPCSTR file, int line) { return s_pool.Alloc(size, file, line); } \
+	void operator delete(void* p, LPCSTR, int) { s_pool.Free(p, sizeof(class_name)); }
+#else
+#define DECLARE_POOLED_ALLOC_DEBUG(class_name)
+#endif
+
+// Add to the class declaration to allocate instances from
+// a class-wide "CObjectPool".
+#define DECLARE_POOLED_ALLOC(class_name) \
+public: \
+	void* operator new(size_t size) { return s_pool.Alloc(size); } \
+	void* operator new(size_t, void* p) { return p; } \
+	void operator delete(void* p, size_t size) { s_pool.Free(p, size); } \
+	void operator delete(void*, void*) {} \
+	DECLARE_POOLED_ALLOC_DEBUG(class_name) \
+	static CObjectPool s_pool;
+
+// Add to the class implementation file.
+#define IMPLEMENT_POOLED_ALLOC(class_name, block_size) \
+	CObjectPool class_name::s_pool(sizeof(class_name), block_size);
+
+#endif //_COBJECTPOOL_H_5E3A1C72_9B4D_4F08_A6E1D27C84B3
@@ -0,0 +1,741 @@
+/* ==========================================================================
+	File :			PNGWriter.cpp
+
+	Class :			CPNGWriter
+
+	Date :			10/19/26
+
+	Purpose :		"CPNGWriter" writes 32-bit RGBA PNG files a row at
+					a time, so images can be saved without holding
+					them in memory and without an image library.
+
+	Description :	Each row is filtered with the "None", "Sub" or
+					"Up" filter, whichever gives the smallest sum of
+					absolute values, and compressed as it arrives.
+
+					The compressor writes a single deflate block with
+					the fixed Huffman codes. Matches are found with a
+					hash of the next three bytes, keeping only the
+					last position for each hash, in a 32K window. This
+					compresses the flat colors of diagrams well, and
+					keeps the memory used by the writer at about
+					200K whatever the size of the image.
+
+					Compressed data is written in "IDAT" chunks of
+					64K.
+
+	Usage :			Call "Open" with the file name and size, then
+					"WriteRow" once for each row, top to bottom, with
+					"width" * 4 bytes of red, green, blue and alpha.
+					"Close" finishes the file, and returns "FALSE" if
+					anything failed or rows are missing.
+
+					"Open" can also be given an open "CFile", such as
+					a "CMemFile", which "Close" leaves open.
+
+   ========================================================================*/
+
+#include "stdafx.h"
+#include "PNGWriter.h"
+
+#ifdef _DEBUG
+#define new DEBUG_NEW
+#undef THIS_FILE
+static char THIS_FILE[] = __FILE__;
+#endif
+
+// Deflate length codes 257 - 285
+static const int lengthBase[] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const int lengthExtra[] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+
+// Deflate distance codes 0 - 29
+static const int distanceBase[] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const int distanceExtra[] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+static void PutLong(BYTE* data, DWORD value)
+{
+	data[0] = static_cast<BYTE>(value >> 24);
+	data[1] = static_cast<BYTE>(value >> 16);
+	data[2] = static_cast<BYTE>(value >> 8);
+	data[3] = static_cast<BYTE>(value);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CPNGWriter construction/destruction
+
+CPNGWriter::CPNGWriter()
+/* ============================================================
+	Function :		CPNGWriter::CPNGWriter
+	Description :	Constructor
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	m_target = NULL;
+	m_open = FALSE;
+	m_error = FALSE;
+	m_width = 0;
+	m_height = 0;
+	m_rows = 0;
+
+	m_buffer = NULL;
+	m_head = NULL;
+	m_fill = 0;
+	m_pos = 0;
+	m_base = 0;
+	m_adler = 1;
+	m_bits = 0;
+	m_bitCount = 0;
+
+}
+
+CPNGWriter::~CPNGWriter()
+/* ============================================================
+	Function :		CPNGWriter::~CPNGWriter
+	Description :	Destructor
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Closes the file if it is open.
+
+   ============================================================*/
+{
+
+	if (m_open)
+		Close();
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CPNGWriter operations
+
+BOOL CPNGWriter::Open(const CString& filename, int width, int height)
+/* ============================================================
+	Function :		CPNGWriter::Open
+	Description :	Creates the file and writes the header.
+	Access :		Public
+
+	Return :		BOOL					-	"TRUE" if the file
+												was created.
+	Parameters :	const CString& filename	-	File to create.
+					int width				-	Width in pixels.
+					int height				-	Height in pixels.
+
+	Usage :			Call "WriteRow" "height" times, then
+					"Close".
+
+   ============================================================*/
+{
+
+	if (m_open || width <= 0 || height <= 0)
+		return FALSE;
+
+	if (!m_file.Open(filename, CFile::modeCreate | CFile::modeWrite))
+		return FALSE;
+
+	return Open(&m_file, width, height);
+
+}
+
+BOOL CPNGWriter::Open(CFile* file, int width, int height)
+/* ============================================================
+	Function :		CPNGWriter::Open
+	Description :	Writes the header to an open file.
+	Access :		Public
+
+	Return :		BOOL			-	"TRUE" if the header
+										was written.
+	Parameters :	CFile* file		-	File to write to.
+					int width		-	Width in pixels.
+					int height		-	Height in pixels.
+
+	Usage :			Call "WriteRow" "height" times, then
+					"Close". "file" is not closed.
+
+   ============================================================*/
+{
+
+	if (m_open || width <= 0 || height <= 0 || !file)
+		return FALSE;
+
+	m_target = file;
+	m_open = TRUE;
+	m_error = FALSE;
+	m_width = width;
+	m_height = height;
+	m_rows = 0;
+
+	m_previous.RemoveAll();
+	m_previous.SetSize(width * 4);
+	m_filtered.SetSize(width * 4 + 1);
+
+	m_buffer = new BYTE[PNG_WINDOW_SIZE * 2];
+	m_head = new DWORD[PNG_HASH_SIZE];
+	memset(m_head, 0, PNG_HASH_SIZE * sizeof(DWORD));
+	m_fill = 0;
+	m_pos = 0;
+	m_base = 0;
+	m_adler = 1;
+	m_bits = 0;
+	m_bitCount = 0;
+	m_out.SetSize(0, PNG_CHUNK_SIZE);
+
+	static const BYTE signature[] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+	TRY
+	{
+		m_target->Write(signature, sizeof(signature));
+	}
+	CATCH_ALL(e)
+	{
+		e->Delete();
+		m_error = TRUE;
+	}
+	END_CATCH_ALL
+
+	BYTE header[13];
+	PutLong(header, width);
+	PutLong(header + 4, height);
+	header[8] = 8;		// Bits per channel
+	header[9] = 6;		// RGBA
+	header[10] = 0;		// Deflate
+	header[11] = 0;		// Adaptive filtering
+	header[12] = 0;		// Not interlaced
+	WriteChunk("IHDR", header, sizeof(header));
+
+	// zlib header, then the start of the single fixed Huffman block
+	m_out.Add(0x78);
+	m_out.Add(0x01);
+	PutBits(1, 1);
+	PutBits(1, 2);
+
+	return !m_error;
+
+}
+
+BOOL CPNGWriter::WriteRow(const BYTE* rgba)
+/* ============================================================
+	Function :		CPNGWriter::WriteRow
+	Description :	Filters and compresses the next row.
+	Access :		Public
+
+	Return :		BOOL				-	"FALSE" if the file is
+											not open, all rows are
+											written or writing
+											failed.
+	Parameters :	const BYTE* rgba	-	"width" * 4 bytes.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	if (!m_open || m_rows >= m_height)
+		return FALSE;
+
+	int size = m_width * 4;
+	const BYTE* prior = m_previous.GetData();
+	BYTE* filtered = m_filtered.GetData();
+
+	// Pick the filter with the smallest sum of absolute values
+	DWORD sumNone = 0;
+	DWORD sumSub = 0;
+	DWORD sumUp = 0;
+	for (int t = 0; t < size; t++)
+	{
+		BYTE left = static_cast<BYTE>(t >= 4 ? rgba[t - 4] : 0);
+		sumNone += abs(static_cast<signed char>(rgba[t]));
+		sumSub += abs(static_cast<signed char>(rgba[t] - left));
+		sumUp += abs(static_cast<signed char>(rgba[t] - prior[t]));
+	}
+
+	if (sumSub < sumNone && sumSub <= sumUp)
+	{
+		filtered[0] = 1;
+		for (int t = 0; t < size; t++)
+			filtered[t + 1] = static_cast<BYTE>(rgba[t] - (t >= 4 ? rgba[t - 4] : 0));
+	}
+	else if (sumUp < sumNone)
+	{
+		filtered[0] = 2;
+		for (int t = 0; t < size; t++)
+			filtered[t + 1] = static_cast<BYTE>(rgba[t] - prior[t]);
+	}
+	else
+	{
+		filtered[0] = 0;
+		memcpy(filtered + 1, rgba, size);
+	}
+
+	memcpy(m_previous.GetData(), rgba, size);
+	Deflate(filtered, size + 1);
+	m_rows++;
+
+	return !m_error;
+
+}
+
+BOOL CPNGWriter::Close()
+/* ============================================================
+	Function :		CPNGWriter::Close
+	Description :	Finishes the compressed data and closes
+					the file.
+	Access :		Public
+
+	Return :		BOOL	-	"TRUE" if the file was written
+								with all rows.
+	Parameters :	none
+
+	Usage :			Missing rows are written transparent, so
+					the file can still be opened.
+
+   ============================================================*/
+{
+
+	if (!m_open)
+		return FALSE;
+
+	BOOL complete = (m_rows == m_height);
+	if (!complete)
+	{
+		CByteArray empty;
+		empty.SetSize(m_width * 4);
+		memset(empty.GetData(), 0, m_width * 4);
+		while (m_rows < m_height)
+			WriteRow(empty.GetData());
+	}
+
+	Compress(TRUE);
+	PutLiteral(256);
+	if (m_bitCount)
+		PutBits(0, 8 - m_bitCount);
+
+	BYTE adler[4];
+	PutLong(adler, m_adler);
+	m_out.Add(adler[0]);
+	m_out.Add(adler[1]);
+	m_out.Add(adler[2]);
+	m_out.Add(adler[3]);
+	FlushOutput(TRUE);
+
+	WriteChunk("IEND", NULL, 0);
+
+	if (m_target == &m_file)
+	{
+		TRY
+		{
+			m_file.Close();
+		}
+		CATCH_ALL(e)
+		{
+			e->Delete();
+			m_error = TRUE;
+		}
+		END_CATCH_ALL
+	}
+
+	m_target = NULL;
+	delete[] m_buffer;
+	delete[] m_head;
+	m_buffer = NULL;
+	m_head = NULL;
+	m_previous.RemoveAll();
+	m_filtered.RemoveAll();
+	m_out.RemoveAll();
+	m_open = FALSE;
+
+	return complete && !m_error;
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CPNGWriter attributes
+
+BOOL CPNGWriter::IsOpen() const
+/* ============================================================
+	Function :		CPNGWriter::IsOpen
+	Description :	Checks if a file is being written.
+	Access :		Public
+
+	Return :		BOOL	-	"TRUE" between "Open" and
+								"Close".
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	return m_open;
+
+}
+
+int CPNGWriter::GetRowsWritten() const
+/* ============================================================
+	Function :		CPNGWriter::GetRowsWritten
+	Description :	Gets the number of rows written.
+	Access :		Public
+
+	Return :		int		-	Rows written since "Open".
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	return m_rows;
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CPNGWriter compression
+
+void CPNGWriter::Deflate(const BYTE* data, int size)
+/* ============================================================
+	Function :		CPNGWriter::Deflate
+	Description :	Adds data to the compressed stream.
+	Access :		Private
+
+	Return :		void
+	Parameters :	const BYTE* data	-	Data to add.
+					int size			-	Bytes in "data".
+
+	Usage :			Data is compressed when the buffer is full,
+					keeping the last 32K as the window for
+					later matches.
+
+   ============================================================*/
+{
+
+	// Adler-32 of the uncompressed data
+	DWORD a = m_adler & 0xFFFF;
+	DWORD b = m_adler >> 16;
+	for (int t = 0; t < size; t++)
+	{
+		a = (a + data[t]) % 65521;
+		b = (b + a) % 65521;
+	}
+	m_adler = (b << 16) | a;
+
+	while (size > 0)
+	{
+		if (m_fill == PNG_WINDOW_SIZE * 2)
+		{
+			Compress(FALSE);
+
+			int keep = m_pos - PNG_WINDOW_SIZE;
+			memmove(m_buffer, m_buffer + keep, m_fill - keep);
+			m_base += keep;
+			m_pos -= keep;
+			m_fill -= keep;
+		}
+
+		int copy = min(size, PNG_WINDOW_SIZE * 2 - m_fill);
+		memcpy(m_buffer + m_fill, data, copy);
+		m_fill += copy;
+		data += copy;
+		size -= copy;
+	}
+
+	FlushOutput(FALSE);
+
+}
+
+void CPNGWriter::Compress(BOOL final)
+/* ============================================================
+	Function :		CPNGWriter::Compress
+	Description :	Writes codes for the buffered data.
+	Access :		Private
+
+	Return :		void
+	Parameters :	BOOL final	-	"TRUE" to compress all of
+									the buffer, "FALSE" to stop
+									where the longest match
+									could need more data.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	int limit = final ? m_fill : m_fill - PNG_MAX_MATCH;
+	while (m_pos < limit)
+	{
+		if (m_pos + 3 <= m_fill)
+		{
+			const BYTE* s = m_buffer + m_pos;
+			int hash = ((s[0] << 10) ^ (s[1] << 5) ^ s[2]) & (PNG_HASH_SIZE - 1);
+			DWORD candidate = m_head[hash];
+			m_head[hash] = m_base + m_pos + 1;
+
+			if (candidate > m_base)
+			{
+				int match = static_cast<int>(candidate - 1 - m_base);
+				int distance = m_pos - match;
+				if (distance <= PNG_WINDOW_SIZE)
+				{
+					int longest = min(PNG_MAX_MATCH, m_fill - m_pos);
+					int length = 0;
+					while (length < longest && m_buffer[match + length] == s[length])
+						length++;
+
+					if (length >= 3)
+					{
+						PutMatch(length, distance);
+						for (int t = 1; t < length; t++)
+						{
+							int pos = m_pos + t;
+							if (pos + 3 <= m_fill)
+							{
+								const BYTE* p = m_buffer + pos;
+								m_head[((p[0] << 10) ^ (p[1] << 5) ^ p[2]) & (PNG_HASH_SIZE - 1)] = m_base + pos + 1;
+							}
+						}
+						m_pos += length;
+						continue;
+					}
+				}
+			}
+		}
+
+		PutLiteral(m_buffer[m_pos]);
+		m_pos++;
+	}
+
+}
+
+void CPNGWriter::PutBits(DWORD value, int count)
+/* ============================================================
+	Function :		CPNGWriter::PutBits
+	Description :	Writes bits, least significant first.
+	Access :		Private
+
+	Return :		void
+	Parameters :	DWORD value	-	Bits to write.
+					int count	-	Number of bits.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	m_bits |= value << m_bitCount;
+	m_bitCount += count;
+	while (m_bitCount >= 8)
+	{
+		m_out.Add(static_cast<BYTE>(m_bits));
+		m_bits >>= 8;
+		m_bitCount -= 8;
+	}
+
+}
+
+void CPNGWriter::PutCode(DWORD code, int length)
+/* ============================================================
+	Function :		CPNGWriter::PutCode
+	Description :	Writes a Huffman code, most significant
+					bit first.
+	Access :		Private
+
+	Return :		void
+	Parameters :	DWORD code	-	Code to write.
+					int length	-	Bits in the code.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	DWORD reversed = 0;
+	for (int t = 0; t < length; t++)
+	{
+		reversed = (reversed << 1) | (code & 1);
+		code >>= 1;
+	}
+
+	PutBits(reversed, length);
+
+}
+
+void CPNGWriter::PutLiteral(int symbol)
+/* ============================================================
+	Function :		CPNGWriter::PutLiteral
+	Description :	Writes a literal/length symbol with the
+					fixed Huffman codes.
+	Access :		Private
+
+	Return :		void
+	Parameters :	int symbol	-	Symbol, 0 - 287.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	if (symbol < 144)
+		PutCode(0x30 + symbol, 8);
+	else if (symbol < 256)
+		PutCode(0x190 + symbol - 144, 9);
+	else if (symbol < 280)
+		PutCode(symbol - 256, 7);
+	else
+		PutCode(0xC0 + symbol - 280, 8);
+
+}
+
+void CPNGWriter::PutMatch(int length, int distance)
+/* ============================================================
+	Function :		CPNGWriter::PutMatch
+	Description :	Writes a length and distance pair.
+	Access :		Private
+
+	Return :		void
+	Parameters :	int length		-	Length, 3 - 258.
+					int distance	-	Distance, 1 - 32768.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	int code = 28;
+	while (lengthBase[code] > length)
+		code--;
+	PutLiteral(257 + code);
+	if (lengthExtra[code])
+		PutBits(length - lengthBase[code], lengthExtra[code]);
+
+	code = 29;
+	while (distanceBase[code] > distance)
+		code--;
+	PutCode(code, 5);
+	if (distanceExtra[code])
+		PutBits(distance - distanceBase[code], distanceExtra[code]);
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CPNGWriter output
+
+void CPNGWriter::FlushOutput(BOOL final)
+/* ============================================================
+	Function :		CPNGWriter::FlushOutput
+	Description :	Writes compressed data as "IDAT" chunks.
+	Access :		Private
+
+	Return :		void
+	Parameters :	BOOL final	-	"TRUE" to write all data,
+									"FALSE" to write full
+									chunks only.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	int written = 0;
+	int size = static_cast<int>(m_out.GetSize());
+	while (size - written >= PNG_CHUNK_SIZE || (final && size > written))
+	{
+		int chunk = min(PNG_CHUNK_SIZE, size - written);
+		WriteChunk("IDAT", m_out.GetData() + written, chunk);
+		written += chunk;
+	}
+
+	if (written)
+		m_out.RemoveAt(0, written);
+
+}
+
+void CPNGWriter::WriteChunk(LPCSTR type, const BYTE* data, int size)
+/* ============================================================
+	Function :		CPNGWriter::WriteChunk
+	Description :	Writes a PNG chunk.
+	Access :		Private
+
+	Return :		void
+	Parameters :	LPCSTR type			-	Four letter chunk type.
+					const BYTE* data	-	Chunk data.
+					int size			-	Bytes in "data".
+
+	Usage :			Sets "m_error" if writing fails.
+
+   ============================================================*/
+{
+
+	if (m_error)
+		return;
+
+	BYTE header[8];
+	PutLong(header, size);
+	memcpy(header + 4, type, 4);
+
+	DWORD crc = Crc(0xFFFFFFFF, header + 4, 4);
+	if (size)
+		crc = Crc(crc, data, size);
+	BYTE trailer[4];
+	PutLong(trailer, crc ^ 0xFFFFFFFF);
+
+	TRY
+	{
+		m_target->Write(header, 8);
+		if (size)
+			m_target->Write(data, size);
+		m_target->Write(trailer, 4);
+	}
+	CATCH_ALL(e)
+	{
+		e->Delete();
+		m_error = TRUE;
+	}
+	END_CATCH_ALL
+
+}
+
+DWORD CPNGWriter::Crc(DWORD crc, const BYTE* data, int size)
+/* ============================================================
+	Function :		CPNGWriter::Crc
+	Description :	Updates a CRC-32 with more data.
+	Access :		Private
+
+	Return :		DWORD				-	The new CRC.
+	Parameters :	DWORD crc			-	CRC so far,
+											"0xFFFFFFFF" to
+											start.
+					const BYTE* data	-	Data to add.
+					int size			-	Bytes in "data".
+
+	Usage :			The final CRC is the result XOR
+					"0xFFFFFFFF".
+
+   ============================================================*/
+{
+
+	static DWORD table[256];
+	static BOOL init = FALSE;
+	if (!init)
+	{
+		for (DWORD n = 0; n < 256; n++)
+		{
+			DWORD c = n;
+			for (int k = 0; k < 8; k++)
+				c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+			table[n] = c;
+		}
+		init = TRUE;
+	}
+
+	for (int t = 0; t < size; t++)
+		crc = table[(crc ^ data[t]) & 0xFF] ^ (crc >> 8);
+
+	return crc;
+
+}
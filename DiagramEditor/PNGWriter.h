@@ -0,0 +1,69 @@
+#ifndef _CPNGWRITER_H_4B9E2D17_A60C_4F3B_9D28E5C170A43
+#define _CPNGWRITER_H_4B9E2D17_A60C_4F3B_9D28E5C170A43
+
+///////////////////////////////////////////////////////////
+// File :		PNGWriter.h
+// Created :	10/19/26
+//
+
+#define PNG_WINDOW_SIZE		32768	// Deflate window
+#define PNG_HASH_SIZE		32768	// Match hash table entries
+#define PNG_MAX_MATCH		258		// Longest deflate match
+#define PNG_CHUNK_SIZE		65536	// Compressed bytes per "IDAT" chunk
+
+class CPNGWriter
+{
+public:
+	// Construction/destruction
+	CPNGWriter();
+	virtual ~CPNGWriter();
+
+	// Operations
+	BOOL	Open(const CString& filename, int width, int height);
+	BOOL	Open(CFile* file, int width, int height);
+	BOOL	WriteRow(const BYTE* rgba);
+	BOOL	Close();
+
+	// Attributes
+	BOOL	IsOpen() const;
+	int		GetRowsWritten() const;
+
+private:
+	// Data
+	CFile		m_file;
+	CFile*		m_target;		// "m_file", or a file owned by the caller
+	BOOL		m_open;
+	BOOL		m_error;
+	int			m_width;
+	int			m_height;
+	int			m_rows;
+
+	CByteArray	m_previous;		// Last unfiltered row
+	CByteArray	m_filtered;		// Filter type and filtered row
+
+	// Deflate
+	BYTE*		m_buffer;		// Window and data not yet compressed
+	DWORD*		m_head;			// Absolute position + 1 of the last string with a hash, 0 if none
+	int			m_fill;			// Bytes in "m_buffer"
+	int			m_pos;			// Next byte in "m_buffer" to compress
+	DWORD		m_base;			// Absolute position of "m_buffer[0]"
+	DWORD		m_adler;
+	DWORD		m_bits;
+	int			m_bitCount;
+	CByteArray	m_out;			// Compressed bytes not yet written
+
+	// Helpers
+	void	Deflate(const BYTE* data, int size);
+	void	Compress(BOOL final);
+	void	PutBits(DWORD value, int count);
+	void	PutCode(DWORD code, int length);
+	void	PutLiteral(int symbol);
+	void	PutMatch(int length, int distance);
+	void	FlushOutput(BOOL final);
+	void	WriteChunk(LPCSTR type, const BYTE* data, int size);
+
+	static DWORD	Crc(DWORD crc, const BYTE* data, int size);
+
+};
+
+#endif //_CPNGWRITER_H_4B9E2D17_A60C_4F3B_9D28E5C170A43
@@ -0,0 +1,688 @@
+/* ==========================================================================
+	File :			RasterExport.cpp
+
+	Class :			CRasterExport
+
+	Date :			10/19/26
+
+	Purpose :		"CRasterExport" writes a diagram to a PNG file of
+					any size, without holding the whole image in
+					memory.
+
+	Description :	The image is split into bands of tiles. A band is
+					as wide as the image and one tile high. The tiles
+					of a band are rendered by a set of worker threads,
+					each taking the next tile not yet started, while
+					this thread writes the band before it to the PNG
+					file, one row at a time. Only two bands and one
+					tile for each thread are in memory at once.
+
+					Each tile only draws the objects touching it, found
+					with "CDiagramEntityContainer::RenderRect". The
+					container is prepared once, before the workers
+					start, so the tiles only read the diagram.
+
+					Tiles are drawn with GDI to a DIB section, so
+					entities that only have a GDI "Draw" come out as
+					in the editor. "SetSoftware" draws them with
+					"CDiagramRasterRenderer" instead, which does not
+					need GDI.
+
+					Writing the rows to the PNG file runs on one
+					thread, so on many processors it sets the time.
+
+	Usage :			Create, set the tile size and thread count if
+					needed, and call "Export". The data must not be
+					changed until "Export" returns.
+
+   ========================================================================*/
+
+#include "stdafx.h"
+#include "RasterExport.h"
+#include "DiagramEntityContainer.h"
+#include "DiagramGDIRenderer.h"
+#include "DiagramRasterRenderer.h"
+#include "DiagramTrace.h"
+
+#ifdef _DEBUG
+#define new DEBUG_NEW
+#undef THIS_FILE
+static char THIS_FILE[] = __FILE__;
+#endif
+
+#define MAX_THREADS			16		// Maximum number of worker threads
+#define MIN_TILE_SIZE		16		// Smallest side of a tile
+
+/////////////////////////////////////////////////////////////////////////////
+// CRasterExport construction/destruction
+
+CRasterExport::CRasterExport()
+/* ============================================================
+	Function :		CRasterExport::CRasterExport
+	Description :	Constructor
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	m_tileSize = RASTER_TILE_SIZE;
+	m_threads = 0;
+	m_software = FALSE;
+
+	m_objs = NULL;
+	m_zoom = 1.0;
+	m_background = RGB(255, 255, 255);
+	m_width = 0;
+	m_height = 0;
+	m_columns = 0;
+	m_bands[0] = NULL;
+	m_bands[1] = NULL;
+	m_band = 0;
+	m_nextTile = 0;
+	m_quit = 0;
+
+	m_tiles = 0;
+	m_running = 0;
+	m_time = 0;
+
+}
+
+CRasterExport::~CRasterExport()
+/* ============================================================
+	Function :		CRasterExport::~CRasterExport
+	Description :	Destructor
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CRasterExport settings
+
+void CRasterExport::SetTileSize(int size)
+/* ============================================================
+	Function :		CRasterExport::SetTileSize
+	Description :	Sets the side of a tile.
+	Access :		Public
+
+	Return :		void
+	Parameters :	int size	-	Side in pixels.
+
+	Usage :			Smaller tiles use less memory and share
+					the work better, larger tiles visit fewer
+					objects more than once. The default is
+					"RASTER_TILE_SIZE".
+
+   ============================================================*/
+{
+
+	m_tileSize = max(size, MIN_TILE_SIZE);
+
+}
+
+void CRasterExport::SetThreadCount(int threads)
+/* ============================================================
+	Function :		CRasterExport::SetThreadCount
+	Description :	Sets the number of threads rendering
+					tiles.
+	Access :		Public
+
+	Return :		void
+	Parameters :	int threads	-	Number of threads, 0 to use
+									one per processor.
+
+	Usage :			The PNG file is written by the calling
+					thread in addition to these.
+
+   ============================================================*/
+{
+
+	m_threads = max(threads, 0);
+
+}
+
+void CRasterExport::SetSoftware(BOOL software)
+/* ============================================================
+	Function :		CRasterExport::SetSoftware
+	Description :	Selects the renderer for the tiles.
+	Access :		Public
+
+	Return :		void
+	Parameters :	BOOL software	-	"TRUE" to draw with
+										"CDiagramRasterRenderer",
+										"FALSE" to draw with
+										GDI.
+
+	Usage :			The default is GDI.
+
+   ============================================================*/
+{
+
+	m_software = software;
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CRasterExport operations
+
+BOOL CRasterExport::Export(CDiagramEntityContainer* objs, const CString& filename, CSize size, double zoom, COLORREF background)
+/* ============================================================
+	Function :		CRasterExport::Export
+	Description :	Writes a diagram to a PNG file.
+	Access :		Public
+
+	Return :		BOOL					-	"FALSE" if the
+												file could not be
+												written or the
+												bands could not be
+												allocated.
+	Parameters :	CDiagramEntityContainer* objs	-	Diagram
+												to export.
+					const CString& filename	-	File to write.
+					CSize size				-	Area of the
+												diagram to export,
+												from the top left
+												corner.
+					double zoom				-	Zoom level. The
+												image is "size"
+												times "zoom" pixels.
+					COLORREF background		-	Color behind the
+												objects.
+
+	Usage :			Selection markers are not drawn. The file
+					is deleted if it could not be completed.
+
+   ============================================================*/
+{
+
+	DIAGRAM_TRACE_SPAN(_T("CRasterExport::Export"));
+
+	m_tiles = 0;
+	m_running = 0;
+	m_time = 0;
+
+	int width = static_cast<int>(size.cx * zoom + .5);
+	int height = static_cast<int>(size.cy * zoom + .5);
+	if (width <= 0 || height <= 0)
+		return FALSE;
+
+	LARGE_INTEGER frequency;
+	LARGE_INTEGER start;
+	::QueryPerformanceFrequency(&frequency);
+	::QueryPerformanceCounter(&start);
+
+	// Two bands, one rendered while the other is written
+	size_t bandSize = static_cast<size_t>(width) * m_tileSize * 4;
+	m_bands[0] = NULL;
+	m_bands[1] = NULL;
+	TRY
+	{
+		m_bands[0] = new BYTE[bandSize];
+		m_bands[1] = new BYTE[bandSize];
+	}
+	CATCH(CMemoryException, e)
+	{
+		e->Delete();
+		delete[] m_bands[0];
+		m_bands[0] = NULL;
+		return FALSE;
+	}
+	END_CATCH
+
+	CPNGWriter png;
+	if (!png.Open(filename, width, height))
+	{
+		delete[] m_bands[0];
+		delete[] m_bands[1];
+		m_bands[0] = NULL;
+		m_bands[1] = NULL;
+		return FALSE;
+	}
+
+	m_objs = objs;
+	m_zoom = zoom;
+	m_background = background;
+	m_width = width;
+	m_height = height;
+	m_columns = (width + m_tileSize - 1) / m_tileSize;
+	int bands = (height + m_tileSize - 1) / m_tileSize;
+	m_tiles = m_columns * bands;
+
+	objs->PrepareRender(zoom);
+
+	// Workers, and a tile for this thread if none could be started
+	int threads = m_threads;
+	if (threads == 0)
+	{
+		SYSTEM_INFO info;
+		::GetSystemInfo(&info);
+		threads = min(static_cast<int>(info.dwNumberOfProcessors), MAX_THREADS);
+	}
+	threads = max(1, min(threads, m_tiles));
+
+	CWorker* workers = new CWorker[threads + 1];
+	HANDLE* done = new HANDLE[threads];
+	m_quit = 0;
+	for (int t = 0; t <= threads; t++)
+	{
+		workers[t].exporter = this;
+		workers[t].start = NULL;
+		workers[t].done = NULL;
+		workers[t].thread = NULL;
+		workers[t].raster = NULL;
+		workers[t].dc = NULL;
+		workers[t].bitmap = NULL;
+		workers[t].old = NULL;
+		workers[t].bits = NULL;
+		if (t < threads)
+		{
+			workers[t].start = ::CreateEvent(NULL, FALSE, FALSE, NULL);
+			workers[t].done = ::CreateEvent(NULL, FALSE, FALSE, NULL);
+			workers[t].thread = AfxBeginThread(WorkerProc, &workers[t], THREAD_PRIORITY_NORMAL, 0, CREATE_SUSPENDED);
+			if (workers[t].thread)
+			{
+				workers[t].thread->m_bAutoDelete = FALSE;
+				workers[t].thread->ResumeThread();
+				done[m_running++] = workers[t].done;
+			}
+		}
+	}
+	CWorker* local = &workers[threads];
+
+	// The first band
+	m_band = 0;
+	m_nextTile = 0;
+	for (int t = 0; t < threads; t++)
+		if (workers[t].thread)
+			::SetEvent(workers[t].start);
+	if (!m_running)
+		RenderTiles(local);
+	BOOL pending = (m_running > 0);
+
+	BOOL result = TRUE;
+	for (int band = 0; band < bands && result; band++)
+	{
+		if (pending)
+			::WaitForMultipleObjects(m_running, done, TRUE, INFINITE);
+		pending = FALSE;
+
+		// The next band is rendered while this one is written
+		if (band + 1 < bands)
+		{
+			m_band = band + 1;
+			m_nextTile = 0;
+			for (int t = 0; t < threads; t++)
+				if (workers[t].thread)
+					::SetEvent(workers[t].start);
+			pending = (m_running > 0);
+		}
+
+		const BYTE* rows = m_bands[band % 2];
+		int count = min(m_tileSize, height - band * m_tileSize);
+		for (int y = 0; y < count && result; y++)
+			result = png.WriteRow(rows + static_cast<size_t>(y) * width * 4);
+
+		if (!m_running && band + 1 < bands)
+			RenderTiles(local);
+	}
+
+	if (pending)
+		::WaitForMultipleObjects(m_running, done, TRUE, INFINITE);
+
+	// Stop the workers
+	::InterlockedExchange(&m_quit, 1);
+	for (int t = 0; t < threads; t++)
+	{
+		if (workers[t].thread)
+		{
+			::SetEvent(workers[t].start);
+			::WaitForSingleObject(workers[t].thread->m_hThread, INFINITE);
+			delete workers[t].thread;
+		}
+		if (workers[t].start)
+			::CloseHandle(workers[t].start);
+		if (workers[t].done)
+			::CloseHandle(workers[t].done);
+	}
+	DeleteTile(local);
+
+	delete[] done;
+	delete[] workers;
+	delete[] m_bands[0];
+	delete[] m_bands[1];
+	m_bands[0] = NULL;
+	m_bands[1] = NULL;
+	m_objs = NULL;
+
+	if (!png.Close())
+		result = FALSE;
+	if (!result)
+		::DeleteFile(filename);
+
+	LARGE_INTEGER end;
+	::QueryPerformanceCounter(&end);
+	m_time = static_cast<double>(end.QuadPart - start.QuadPart) * 1000.0 / static_cast<double>(frequency.QuadPart);
+
+	return result;
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CRasterExport results
+
+int CRasterExport::GetTileCount() const
+/* ============================================================
+	Function :		CRasterExport::GetTileCount
+	Description :	Gets the number of tiles of the last
+					export.
+	Access :		Public
+
+	Return :		int	-	Number of tiles.
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	return m_tiles;
+
+}
+
+int CRasterExport::GetThreadCount() const
+/* ============================================================
+	Function :		CRasterExport::GetThreadCount
+	Description :	Gets the number of worker threads of the
+					last export.
+	Access :		Public
+
+	Return :		int	-	Number of threads, 0 if the tiles
+							were rendered by the calling thread.
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	return m_running;
+
+}
+
+double CRasterExport::GetTotalTime() const
+/* ============================================================
+	Function :		CRasterExport::GetTotalTime
+	Description :	Gets the time of the last export.
+	Access :		Public
+
+	Return :		double	-	Time in milliseconds.
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	return m_time;
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CRasterExport implementation
+
+void CRasterExport::RenderTiles(CWorker* worker)
+/* ============================================================
+	Function :		CRasterExport::RenderTiles
+	Description :	Renders tiles of the current band until
+					all are taken.
+	Access :		Private
+
+	Return :		void
+	Parameters :	CWorker* worker	-	Worker with the tile to
+										draw to.
+
+	Usage :			Called by each worker for every band.
+
+   ============================================================*/
+{
+
+	LONG column;
+	while ((column = ::InterlockedIncrement(&m_nextTile) - 1) < m_columns)
+		RenderTile(worker, static_cast<int>(column));
+
+}
+
+void CRasterExport::RenderTile(CWorker* worker, int column)
+/* ============================================================
+	Function :		CRasterExport::RenderTile
+	Description :	Renders a tile of the current band, and
+					copies it to the band.
+	Access :		Private
+
+	Return :		void
+	Parameters :	CWorker* worker	-	Worker with the tile to
+										draw to.
+					int column		-	Tile in the band.
+
+	Usage :			Tiles at the right and bottom edges only
+					use part of the tile.
+
+   ============================================================*/
+{
+
+	int left = column * m_tileSize;
+	int top = m_band * m_tileSize;
+	int width = min(m_tileSize, m_width - left);
+	int height = min(m_tileSize, m_height - top);
+	CRect rect(left, top, left + width, top + height);
+	BYTE* band = m_bands[m_band % 2];
+
+	if (!worker->raster && !worker->dc && !CreateTile(worker))
+	{
+		// Out of resources, the tile is left empty
+		for (int y = 0; y < height; y++)
+		{
+			BYTE* out = band + (static_cast<size_t>(y) * m_width + left) * 4;
+			for (int x = 0; x < width; x++, out += 4)
+			{
+				out[0] = GetRValue(m_background);
+				out[1] = GetGValue(m_background);
+				out[2] = GetBValue(m_background);
+				out[3] = 255;
+			}
+		}
+		return;
+	}
+
+	// Worker threads have no idle time to free
+	// temporary GDI objects, so it is done per tile
+	AfxLockTempMaps();
+
+	if (worker->raster)
+	{
+		CDiagramRasterRenderer* renderer = worker->raster;
+		renderer->Clear(m_background);
+		renderer->Reset();
+		renderer->SetOrigin(rect.TopLeft());
+		m_objs->RenderRect(renderer, rect, m_zoom);
+
+		for (int y = 0; y < height; y++)
+			memcpy(band + (static_cast<size_t>(y) * m_width + left) * 4, renderer->GetRow(y), width * 4);
+	}
+	else
+	{
+		for (int y = 0; y < height; y++)
+		{
+			BYTE* bits = worker->bits + static_cast<size_t>(y) * m_tileSize * 4;
+			for (int x = 0; x < width; x++, bits += 4)
+			{
+				bits[0] = GetBValue(m_background);
+				bits[1] = GetGValue(m_background);
+				bits[2] = GetRValue(m_background);
+				bits[3] = 0;
+			}
+		}
+
+		CDC dc;
+		dc.Attach(worker->dc);
+		dc.SetViewportOrg(-left, -top);
+		{
+			CDiagramGDIRenderer renderer(&dc);
+			m_objs->RenderRect(&renderer, rect, m_zoom);
+		}
+		dc.Detach();
+		::GdiFlush();
+
+		// BGR to RGBA
+		for (int y = 0; y < height; y++)
+		{
+			const BYTE* bits = worker->bits + static_cast<size_t>(y) * m_tileSize * 4;
+			BYTE* out = band + (static_cast<size_t>(y) * m_width + left) * 4;
+			for (int x = 0; x < width; x++, bits += 4, out += 4)
+			{
+				out[0] = bits[2];
+				out[1] = bits[1];
+				out[2] = bits[0];
+				out[3] = 255;
+			}
+		}
+	}
+
+	AfxUnlockTempMaps();
+
+}
+
+BOOL CRasterExport::CreateTile(CWorker* worker)
+/* ============================================================
+	Function :		CRasterExport::CreateTile
+	Description :	Creates the tile a worker draws to.
+	Access :		Private
+
+	Return :		BOOL			-	"FALSE" if it could not
+										be created.
+	Parameters :	CWorker* worker	-	Worker to create the
+										tile for.
+
+	Usage :			Called by the worker thread itself on its
+					first tile, so the GDI objects belong to
+					the thread using them.
+
+   ============================================================*/
+{
+
+	if (m_software)
+	{
+		CDiagramRasterRenderer* raster = new CDiagramRasterRenderer;
+		if (!raster->Create(m_tileSize, m_tileSize, m_background))
+		{
+			delete raster;
+			return FALSE;
+		}
+
+		worker->raster = raster;
+		return TRUE;
+	}
+
+	BITMAPINFO info;
+	ZeroMemory(&info, sizeof(info));
+	info.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+	info.bmiHeader.biWidth = m_tileSize;
+	info.bmiHeader.biHeight = -m_tileSize;
+	info.bmiHeader.biPlanes = 1;
+	info.bmiHeader.biBitCount = 32;
+	info.bmiHeader.biCompression = BI_RGB;
+
+	worker->dc = ::CreateCompatibleDC(NULL);
+	if (!worker->dc)
+		return FALSE;
+
+	void* bits = NULL;
+	worker->bitmap = ::CreateDIBSection(worker->dc, &info, DIB_RGB_COLORS, &bits, NULL, 0);
+	if (!worker->bitmap)
+	{
+		::DeleteDC(worker->dc);
+		worker->dc = NULL;
+		return FALSE;
+	}
+
+	worker->bits = static_cast<BYTE*>(bits);
+	worker->old = ::SelectObject(worker->dc, worker->bitmap);
+	return TRUE;
+
+}
+
+void CRasterExport::DeleteTile(CWorker* worker)
+/* ============================================================
+	Function :		CRasterExport::DeleteTile
+	Description :	Deletes the tile of a worker.
+	Access :		Private
+
+	Return :		void
+	Parameters :	CWorker* worker	-	Worker to delete the
+										tile of.
+
+	Usage :			Called by the thread that created it.
+
+   ============================================================*/
+{
+
+	delete worker->raster;
+	worker->raster = NULL;
+
+	if (worker->dc)
+	{
+		::SelectObject(worker->dc, worker->old);
+		::DeleteObject(worker->bitmap);
+		::DeleteDC(worker->dc);
+		worker->dc = NULL;
+		worker->bitmap = NULL;
+		worker->old = NULL;
+		worker->bits = NULL;
+	}
+
+}
+
+UINT AFX_CDECL CRasterExport::WorkerProc(LPVOID param)
+/* ============================================================
+	Function :		CRasterExport::WorkerProc
+	Description :	Thread function for a tile rendering
+					worker.
+	Access :		Private
+
+	Return :		UINT			-	Always 0.
+	Parameters :	LPVOID param	-	The "CWorker" to run.
+
+	Usage :			Renders tiles of the current band each
+					time the "start" event is set, and sets
+					"done" when there are none left. Stops
+					when "m_quit" is set.
+
+   ============================================================*/
+{
+
+	CWorker* worker = static_cast<CWorker*>(param);
+	for (;;)
+	{
+		::WaitForSingleObject(worker->start, INFINITE);
+		if (worker->exporter->m_quit)
+			break;
+
+		worker->exporter->RenderTiles(worker);
+		::SetEvent(worker->done);
+	}
+
+	worker->exporter->DeleteTile(worker);
+	return 0;
+
+}
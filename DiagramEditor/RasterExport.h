@@ -0,0 +1,84 @@
+#ifndef _CRASTEREXPORT_H_6A2F8E41_C7D3_4B95_8E17F2A04D6C3
+#define _CRASTEREXPORT_H_6A2F8E41_C7D3_4B95_8E17F2A04D6C3
+
+///////////////////////////////////////////////////////////
+// File :		RasterExport.h
+// Created :	10/19/26
+//
+
+#include "PNGWriter.h"
+
+class CDiagramEntityContainer;
+class CDiagramRasterRenderer;
+
+#define RASTER_TILE_SIZE	256		// Default side of a tile, in pixels
+
+class CRasterExport
+{
+public:
+	// Construction/destruction
+	CRasterExport();
+	virtual ~CRasterExport();
+
+	// Settings
+	void		SetTileSize(int size);
+	void		SetThreadCount(int threads);
+	void		SetSoftware(BOOL software);
+
+	// Operations
+	BOOL		Export(CDiagramEntityContainer* objs, const CString& filename, CSize size, double zoom, COLORREF background);
+
+	// Results
+	int			GetTileCount() const;
+	int			GetThreadCount() const;
+	double		GetTotalTime() const;
+
+private:
+	// Tile rendering thread
+	struct CWorker
+	{
+		CRasterExport*			exporter;
+		HANDLE					start;
+		HANDLE					done;
+		CWinThread*				thread;
+
+		CDiagramRasterRenderer*	raster;		// Software tile
+		HDC						dc;			// GDI tile, "bitmap" selected
+		HBITMAP					bitmap;
+		HGDIOBJ					old;
+		BYTE*					bits;		// Pixels of "bitmap", top-down BGRA
+	};
+
+	// Settings
+	int							m_tileSize;
+	int							m_threads;
+	BOOL						m_software;
+
+	// Current export
+	CDiagramEntityContainer*	m_objs;
+	double						m_zoom;
+	COLORREF					m_background;
+	int							m_width;
+	int							m_height;
+	int							m_columns;		// Tiles in a band
+	BYTE*						m_bands[2];		// A band being rendered, and one being written
+	int							m_band;			// Band being rendered
+	volatile LONG				m_nextTile;		// Next tile of "m_band" to render
+	volatile LONG				m_quit;
+
+	// Results
+	int							m_tiles;
+	int							m_running;
+	double						m_time;
+
+	// Helpers
+	void		RenderTiles(CWorker* worker);
+	void		RenderTile(CWorker* worker, int column);
+	BOOL		CreateTile(CWorker* worker);
+	void		DeleteTile(CWorker* worker);
+
+	static UINT AFX_CDECL WorkerProc(LPVOID param);
+
+};
+
+#endif //_CRASTEREXPORT_H_6A2F8E41_C7D3_4B95_8E17F2A04D6C3
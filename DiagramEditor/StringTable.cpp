@@ -0,0 +1,241 @@
+/* ==========================================================================
+	File :			StringTable.cpp
+
+	Class :			CStringTable
+
+	Date :			10/19/26
+
+	Purpose :		"CStringTable" is a per-document interning table for
+					the strings repeated across many entities, such as
+					type names, font names, package names and
+					stereotypes.
+
+	Description :	"CString" is reference counted, and copying one
+					"CString" to another shares the character buffer.
+					Strings read from a file are all separate buffers,
+					however, so every class in a model carries its own
+					copy of, for example, "uml_class" and "Arial".
+
+					"Intern" returns the table copy of a string, adding
+					it first if needed. Assigning the result to an entity
+					member makes all entities share one buffer per
+					distinct value. The values themselves are never
+					changed, so saving and loading work exactly as
+					before.
+					Only values that repeat are interned. Entries are
+					not removed until "RemoveAll", so interning a value
+					unique to one object, such as its name, would only
+					add an entry that outlives the object.
+
+					As equal interned strings share a buffer, "IsEqual"
+					can compare the buffer pointers first. Strings of
+					different length are rejected without looking at the
+					characters. Only strings of the same length in
+					different buffers need a full compare.
+
+	Usage :			The "CDiagramEntityContainer" owns a table and interns
+					the strings of objects as they are added. Use
+					"IsEqual" instead of "operator==" when comparing names
+					or packages in loops.
+
+   ========================================================================*/
+
+#include "stdafx.h"
+#include "StringTable.h"
+#include "DiagramMemoryUsage.h"
+
+/////////////////////////////////////////////////////////////////////////////
+// CStringTable construction/destruction
+
+CStringTable::CStringTable()
+/* ============================================================
+	Function :		CStringTable::CStringTable
+	Description :	Constructor
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+}
+
+CStringTable::~CStringTable()
+/* ============================================================
+	Function :		CStringTable::~CStringTable
+	Description :	Destructor
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	RemoveAll();
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CStringTable operations
+
+CString CStringTable::Intern(const CString& str)
+/* ============================================================
+	Function :		CStringTable::Intern
+	Description :	Gets the shared copy of "str".
+	Access :		Public
+
+	Return :		CString				-	A string equal to
+											"str", sharing the
+											buffer of all other
+											interned copies.
+	Parameters :	const CString& str	-	String to intern.
+
+	Usage :			Call to get the interned copy of a string.
+
+   ============================================================*/
+{
+
+	CString result;
+	if (str.IsEmpty())
+		return result;
+
+	if (!m_strings.Lookup(str, result))
+	{
+		m_strings.SetAt(str, str);
+		result = str;
+	}
+
+	return result;
+
+}
+
+void CStringTable::InternString(CString& str)
+/* ============================================================
+	Function :		CStringTable::InternString
+	Description :	Replaces "str" with its interned copy.
+	Access :		Public
+
+	Return :		void
+	Parameters :	CString& str	-	String to intern.
+
+	Usage :			Call to intern a member variable in place.
+
+   ============================================================*/
+{
+
+	if (!str.IsEmpty())
+		str = Intern(str);
+
+}
+
+void CStringTable::RemoveAll()
+/* ============================================================
+	Function :		CStringTable::RemoveAll
+	Description :	Empties the table.
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Call when the document is cleared. Strings
+					already interned keep their value, they will
+					just not be shared with strings interned
+					later.
+
+   ============================================================*/
+{
+
+	m_strings.RemoveAll();
+
+}
+
+BOOL CStringTable::IsEqual(const CString& str1, const CString& str2)
+/* ============================================================
+	Function :		CStringTable::IsEqual
+	Description :	Compares two strings.
+	Access :		Public
+
+	Return :		BOOL				-	"TRUE" if the strings
+											are equal.
+	Parameters :	const CString& str1	-	First string
+					const CString& str2	-	Second string
+
+	Usage :			Call to compare interned strings. The
+					result is the same as "operator==", but
+					shared buffers and different lengths are
+					decided without a character compare.
+
+   ============================================================*/
+{
+
+	if (str1.GetString() == str2.GetString())
+		return TRUE;
+
+	if (str1.GetLength() != str2.GetLength())
+		return FALSE;
+
+	return str1 == str2;
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CStringTable attributes
+
+INT_PTR CStringTable::GetCount() const
+/* ============================================================
+	Function :		CStringTable::GetCount
+	Description :	Gets the number of distinct strings in the
+					table.
+	Access :		Public
+
+	Return :		INT_PTR	-	Number of strings.
+	Parameters :	none
+
+	Usage :			Call for statistics.
+
+   ============================================================*/
+{
+
+	return m_strings.GetCount();
+
+}
+
+void CStringTable::GetMemoryUsage(CDiagramMemoryUsage& usage) const
+/* ============================================================
+	Function :		CStringTable::GetMemoryUsage
+	Description :	Adds the memory held by the table to
+					"usage".
+	Access :		Public
+
+	Return :		void
+	Parameters :	CDiagramMemoryUsage& usage	-	Breakdown
+													to add to.
+
+	Usage :			Call after the objects sharing the strings
+					have been added, so that only strings no
+					object uses any longer are counted here.
+
+   ============================================================*/
+{
+
+	INT_PTR count = m_strings.GetCount();
+	usage.Add(_T("Strings"), _T("String table"), count,
+		count * (sizeof(void*) + sizeof(UINT) + 2 * sizeof(CString)) +
+		m_strings.GetHashTableSize() * sizeof(void*));
+
+	CString key;
+	CString value;
+	POSITION pos = m_strings.GetStartPosition();
+	while (pos)
+	{
+		m_strings.GetNextAssoc(pos, key, value);
+		usage.AddString(key);
+		usage.AddString(value);
+	}
+
+}
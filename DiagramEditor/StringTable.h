@@ -0,0 +1,35 @@
+#ifndef _CSTRINGTABLE_H_A84F2D61_0C7E_4B95_9E3DB51F7260
+#define _CSTRINGTABLE_H_A84F2D61_0C7E_4B95_9E3DB51F7260
+
+///////////////////////////////////////////////////////////
+// File :		StringTable.h
+// Created :	10/19/26
+//
+
+class CDiagramMemoryUsage;
+
+class CStringTable
+{
+public:
+	// Construction/destruction
+	CStringTable();
+	virtual ~CStringTable();
+
+	// Operations
+	CString	Intern(const CString& str);
+	void	InternString(CString& str);
+	void	RemoveAll();
+
+	static BOOL IsEqual(const CString& str1, const CString& str2);
+
+	// Attributes
+	INT_PTR	GetCount() const;
+	void	GetMemoryUsage(CDiagramMemoryUsage& usage) const;
+
+private:
+	// Data
+	CMapStringToString	m_strings;
+
+};
+
+#endif //_CSTRINGTABLE_H_A84F2D61_0C7E_4B95_9E3DB51F7260
@@ -16,6 +16,9 @@
 
 	Changes :		30/5 2004	Made CUndoItem dtor virtual. Allocating
 								members from the stack instead of the heap.
+					19/10 2026	Added the spill block, for levels kept in
+								the container spill file.
+					19/10 2026	Added the selection of spilled levels.
 
    ========================================================================*/
 
@@ -36,6 +39,9 @@ CUndoItem::CUndoItem()
 
    ============================================================*/
 {
+
+	spill = -1;
+
 }
 
 CUndoItem::~CUndoItem()
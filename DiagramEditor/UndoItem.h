@@ -18,6 +18,8 @@ public:
 	CObArray	arr;	// Object array
 	COLORREF	col;	// Background color
 	CPoint		pt;		// Virtual editor size
+	int			spill;	// Block in the spill file, -1 if "arr" is in memory
+	CByteArray	selected;	// Selection of the spilled objects
 
 };
 
@@ -0,0 +1,845 @@
+/* ==========================================================================
+	File :			UndoSpill.cpp
+
+	Class :			CUndoSpill
+
+	Date :			10/19/26
+
+	Purpose :		"CUndoSpill" keeps strings in a compressed temporary
+					file, so that old undo levels do not have to be kept
+					in memory.
+
+	Description :	"Write" converts a string to UTF-8 and queues it for
+					a writer thread, which compresses it and appends it
+					to the file. Until it is written, the string stays
+					in memory and "Read" takes it from there. After
+					that, "Read" reads it back from the file and
+					decompresses it.
+
+					"Write" can also take objects with a function
+					saving them as a string. The objects are saved,
+					deleted and written by the writer thread, so that
+					the caller does not wait for them to be saved.
+
+					The compression is a simple LZ77 variant. A flag
+					byte tells if each of the following eight items is a
+					literal byte, or a match of 3 to 258 bytes up to 64K
+					back, stored as a 16-bit offset and a length byte.
+					Matches are found through a hash chain of the 3-byte
+					prefixes. Entity strings are repetitive, and usually
+					shrink to a quarter of their size or less.
+
+					The file is created in the temp directory when the
+					first string is written, and deleted when it is
+					closed. Space of freed strings is not reused, but
+					the file is truncated when no strings are left.
+
+	Usage :			Call "Write" to spill a string, and keep the
+					returned block number. "Read" gets the string back,
+					and "Free" releases the block.
+
+   ========================================================================*/
+
+#include "stdafx.h"
+#include "UndoSpill.h"
+
+#ifdef _DEBUG
+#define new DEBUG_NEW
+#undef THIS_FILE
+static char THIS_FILE[] = __FILE__;
+#endif
+
+#define LZ_MIN_MATCH	3			// Shortest match
+#define LZ_MAX_MATCH	258			// Longest match, fits a length byte
+#define LZ_WINDOW		65536		// Longest match distance, fits an offset word
+#define LZ_HASH_BITS	15			// Size of the hash table
+#define LZ_MAX_CHAIN	32			// Matches tried per position
+
+static DWORD LzHash(const BYTE* data)
+{
+	return ((data[0] << 10) ^ (data[1] << 5) ^ data[2]) & ((1 << LZ_HASH_BITS) - 1);
+}
+
+static void ToUtf8(const CString& str, CByteArray& result)
+{
+#ifdef _UNICODE
+	int size = ::WideCharToMultiByte(CP_UTF8, 0, str, str.GetLength(), NULL, 0, NULL, NULL);
+	result.SetSize(size);
+	if (size)
+		::WideCharToMultiByte(CP_UTF8, 0, str, str.GetLength(), reinterpret_cast<LPSTR>(result.GetData()), size, NULL, NULL);
+#else
+	result.SetSize(str.GetLength());
+	if (str.GetLength())
+		memcpy(result.GetData(), static_cast<LPCTSTR>(str), str.GetLength());
+#endif
+}
+
+static void FromUtf8(const CByteArray& data, CString& result)
+{
+	int length = static_cast<int>(data.GetSize());
+#ifdef _UNICODE
+	int size = ::MultiByteToWideChar(CP_UTF8, 0, reinterpret_cast<LPCSTR>(data.GetData()), length, NULL, 0);
+	LPWSTR buffer = result.GetBuffer(size);
+	if (size)
+		::MultiByteToWideChar(CP_UTF8, 0, reinterpret_cast<LPCSTR>(data.GetData()), length, buffer, size);
+	result.ReleaseBuffer(size);
+#else
+	LPSTR buffer = result.GetBuffer(length);
+	if (length)
+		memcpy(buffer, data.GetData(), length);
+	result.ReleaseBuffer(length);
+#endif
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CUndoSpill construction/destruction
+
+CUndoSpill::CUndoSpill()
+/* ============================================================
+	Function :		CUndoSpill::CUndoSpill
+	Description :	Constructor
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			The file and the writer thread are created
+					when the first string is written.
+
+   ============================================================*/
+{
+
+	::InitializeCriticalSection(&m_lock);
+	m_file = INVALID_HANDLE_VALUE;
+	m_work = NULL;
+	m_thread = NULL;
+	m_quit = 0;
+	m_current = -1;
+	m_used = 0;
+	m_end = 0;
+
+}
+
+CUndoSpill::~CUndoSpill()
+/* ============================================================
+	Function :		CUndoSpill::~CUndoSpill
+	Description :	Destructor
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Stops the writer thread, and closes and
+					deletes the file.
+
+   ============================================================*/
+{
+
+	if (m_thread)
+	{
+		::InterlockedExchange(&m_quit, 1);
+		::SetEvent(m_work);
+		::WaitForSingleObject(m_thread->m_hThread, INFINITE);
+		delete m_thread;
+	}
+
+	if (m_work)
+		::CloseHandle(m_work);
+	if (m_file != INVALID_HANDLE_VALUE)
+		::CloseHandle(m_file);
+
+	INT_PTR max = m_blocks.GetSize();
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		delete m_blocks[t].pending;
+		DeleteObjects(m_blocks[t].objects);
+	}
+
+	::DeleteCriticalSection(&m_lock);
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CUndoSpill operations
+
+int CUndoSpill::Write(const CString& data)
+/* ============================================================
+	Function :		CUndoSpill::Write
+	Description :	Spills a string to the file.
+	Access :		Public
+
+	Return :		int					-	Block of the string,
+											-1 if the file could
+											not be created.
+	Parameters :	const CString& data	-	String to spill.
+
+	Usage :			The string is compressed and written in the
+					background. It can be read back at once.
+
+   ============================================================*/
+{
+
+	if (!Open())
+		return -1;
+
+	CByteArray* pending = new CByteArray;
+	ToUtf8(data, *pending);
+
+	::EnterCriticalSection(&m_lock);
+	int block = AddBlock();
+	CBlock& item = m_blocks[block];
+	item.rawSize = static_cast<DWORD>(pending->GetSize());
+	item.pending = pending;
+	m_queue.Add(block);
+	::LeaveCriticalSection(&m_lock);
+
+	if (m_thread)
+		::SetEvent(m_work);
+	else
+		WriteBlocks();
+
+	return block;
+
+}
+
+int CUndoSpill::Write(CObArray& objects, SPILLPROC proc)
+/* ============================================================
+	Function :		CUndoSpill::Write
+	Description :	Spills objects to the file.
+	Access :		Public
+
+	Return :		int					-	Block of the objects,
+											-1 if the file could
+											not be created.
+	Parameters :	CObArray& objects	-	Objects to spill.
+					SPILLPROC proc		-	Saves the objects as
+											a string.
+
+	Usage :			The spill takes over the objects, and
+					"objects" is emptied, unless the file
+					could not be created. "proc" is called by
+					the writer thread, and must only read the
+					objects. "Read" gets the saved string.
+
+   ============================================================*/
+{
+
+	if (!Open())
+		return -1;
+
+	CObArray* pending = new CObArray;
+	pending->Append(objects);
+	objects.RemoveAll();
+
+	::EnterCriticalSection(&m_lock);
+	int block = AddBlock();
+	CBlock& item = m_blocks[block];
+	item.objects = pending;
+	item.proc = proc;
+	m_queue.Add(block);
+	::LeaveCriticalSection(&m_lock);
+
+	if (m_thread)
+		::SetEvent(m_work);
+	else
+		WriteBlocks();
+
+	return block;
+
+}
+
+BOOL CUndoSpill::Read(int block, CString& data)
+/* ============================================================
+	Function :		CUndoSpill::Read
+	Description :	Reads a spilled string.
+	Access :		Public
+
+	Return :		BOOL			-	"FALSE" if the block is
+										not in use, or the file
+										could not be read.
+	Parameters :	int block		-	Block to read.
+					CString& data	-	Gets the string.
+
+	Usage :			The block stays in use until "Free" is
+					called.
+
+   ============================================================*/
+{
+
+	BOOL result = FALSE;
+	CByteArray raw;
+
+	::EnterCriticalSection(&m_lock);
+	if (block < 0 || block >= m_blocks.GetSize() || !m_blocks[block].used)
+	{
+		::LeaveCriticalSection(&m_lock);
+		return FALSE;
+	}
+
+	CBlock item = m_blocks[block];
+	if (item.objects)
+	{
+		// Not saved yet. The writer thread only deletes the
+		// objects with the lock held.
+		item.proc(*item.objects, data);
+		::LeaveCriticalSection(&m_lock);
+		return TRUE;
+	}
+
+	if (item.pending || item.rawSize == 0)
+	{
+		if (item.pending)
+			raw.Copy(*item.pending);
+		result = TRUE;
+	}
+	::LeaveCriticalSection(&m_lock);
+
+	if (!result)
+	{
+		// Written data is never changed, so it can be read
+		// while the writer thread appends to the file
+		CByteArray compressed;
+		compressed.SetSize(item.size);
+		OVERLAPPED overlapped;
+		memset(&overlapped, 0, sizeof(overlapped));
+		overlapped.Offset = static_cast<DWORD>(item.offset);
+		overlapped.OffsetHigh = static_cast<DWORD>(item.offset >> 32);
+		DWORD read = 0;
+		if (::ReadFile(m_file, compressed.GetData(), item.size, &read, &overlapped) && read == item.size)
+		{
+			raw.SetSize(item.rawSize);
+			result = Decompress(compressed.GetData(), item.size, raw.GetData(), item.rawSize);
+		}
+	}
+
+	if (result)
+		FromUtf8(raw, data);
+
+	return result;
+
+}
+
+void CUndoSpill::Free(int block)
+/* ============================================================
+	Function :		CUndoSpill::Free
+	Description :	Releases a block.
+	Access :		Public
+
+	Return :		void
+	Parameters :	int block	-	Block to release.
+
+	Usage :			Call when the string is no longer needed.
+					The file is truncated when the last block
+					is released.
+
+   ============================================================*/
+{
+
+	::EnterCriticalSection(&m_lock);
+	if (block >= 0 && block < m_blocks.GetSize() && m_blocks[block].used)
+	{
+		m_blocks[block].used = FALSE;
+		m_used--;
+
+		// A block being written is released by the writer
+		if (block != m_current)
+		{
+			INT_PTR max = m_queue.GetSize();
+			for (INT_PTR t = 0; t < max; t++)
+			{
+				if (m_queue[t] == block)
+				{
+					m_queue.RemoveAt(t);
+					break;
+				}
+			}
+			ReleaseBlock(block);
+		}
+
+		if (m_used == 0 && m_current == -1 && m_file != INVALID_HANDLE_VALUE)
+		{
+			LARGE_INTEGER start;
+			start.QuadPart = 0;
+			::SetFilePointerEx(m_file, start, NULL, FILE_BEGIN);
+			::SetEndOfFile(m_file);
+			m_end = 0;
+		}
+	}
+	::LeaveCriticalSection(&m_lock);
+
+}
+
+void CUndoSpill::Clear()
+/* ============================================================
+	Function :		CUndoSpill::Clear
+	Description :	Releases all blocks.
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Call to empty the file.
+
+   ============================================================*/
+{
+
+	int max = static_cast<int>(m_blocks.GetSize());
+	for (int t = 0; t < max; t++)
+		Free(t);
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CUndoSpill statistics
+
+int CUndoSpill::GetBlockCount() const
+/* ============================================================
+	Function :		CUndoSpill::GetBlockCount
+	Description :	Gets the number of blocks in use.
+	Access :		Public
+
+	Return :		int		-	Number of blocks.
+	Parameters :	none
+
+	Usage :			Call to get the number of spilled strings.
+
+   ============================================================*/
+{
+
+	return m_used;
+
+}
+
+ULONGLONG CUndoSpill::GetFileSize() const
+/* ============================================================
+	Function :		CUndoSpill::GetFileSize
+	Description :	Gets the size of the file.
+	Access :		Public
+
+	Return :		ULONGLONG	-	Size in bytes.
+	Parameters :	none
+
+	Usage :			Includes the space of freed blocks, until
+					the file is truncated.
+
+   ============================================================*/
+{
+
+	return m_end;
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CUndoSpill compression
+
+void CUndoSpill::Compress(const BYTE* data, DWORD size, CByteArray& result)
+/* ============================================================
+	Function :		CUndoSpill::Compress
+	Description :	Compresses a buffer.
+	Access :		Public
+
+	Return :		void
+	Parameters :	const BYTE* data	-	Data to compress.
+					DWORD size			-	Size of "data".
+					CByteArray& result	-	Gets the compressed
+											data.
+
+	Usage :			The size of the data must be kept, to be
+					given to "Decompress".
+
+   ============================================================*/
+{
+
+	result.SetSize(0, size / 4 + 16);
+
+	CArray< int, int > head;
+	head.SetSize(1 << LZ_HASH_BITS);
+	for (int t = 0; t < (1 << LZ_HASH_BITS); t++)
+		head[t] = -1;
+	CArray< int, int > prev;
+	prev.SetSize(LZ_WINDOW);
+
+	INT_PTR flags = 0;
+	int bit = 8;
+	DWORD pos = 0;
+	while (pos < size)
+	{
+		if (bit == 8)
+		{
+			flags = result.Add(0);
+			bit = 0;
+		}
+
+		// Longest match among the earlier positions with the
+		// same hash
+		DWORD bestLength = 0;
+		DWORD bestOffset = 0;
+		if (pos + LZ_MIN_MATCH <= size)
+		{
+			DWORD limit = min(static_cast<DWORD>(LZ_MAX_MATCH), size - pos);
+			int candidate = head[LzHash(data + pos)];
+			for (int chain = 0; chain < LZ_MAX_CHAIN && candidate >= 0 && pos - candidate <= LZ_WINDOW; chain++)
+			{
+				if (data[candidate + bestLength] == data[pos + bestLength])
+				{
+					DWORD length = 0;
+					while (length < limit && data[candidate + length] == data[pos + length])
+						length++;
+					if (length > bestLength)
+					{
+						bestLength = length;
+						bestOffset = pos - candidate;
+						if (length == limit)
+							break;
+					}
+				}
+				candidate = prev[candidate & (LZ_WINDOW - 1)];
+			}
+		}
+
+		DWORD advance = 1;
+		if (bestLength >= LZ_MIN_MATCH)
+		{
+			result[flags] |= static_cast<BYTE>(1 << bit);
+			result.Add(static_cast<BYTE>((bestOffset - 1) & 0xFF));
+			result.Add(static_cast<BYTE>((bestOffset - 1) >> 8));
+			result.Add(static_cast<BYTE>(bestLength - LZ_MIN_MATCH));
+			advance = bestLength;
+		}
+		else
+			result.Add(data[pos]);
+		bit++;
+
+		for (DWORD t = 0; t < advance; t++, pos++)
+		{
+			if (pos + LZ_MIN_MATCH <= size)
+			{
+				DWORD hash = LzHash(data + pos);
+				prev[pos & (LZ_WINDOW - 1)] = head[hash];
+				head[hash] = static_cast<int>(pos);
+			}
+		}
+	}
+
+}
+
+BOOL CUndoSpill::Decompress(const BYTE* data, DWORD size, BYTE* result, DWORD resultSize)
+/* ============================================================
+	Function :		CUndoSpill::Decompress
+	Description :	Decompresses a buffer.
+	Access :		Public
+
+	Return :		BOOL				-	"FALSE" if the data
+											is corrupt.
+	Parameters :	const BYTE* data	-	Data from "Compress".
+					DWORD size			-	Size of "data".
+					BYTE* result		-	Gets the original
+											data.
+					DWORD resultSize	-	Size of the original
+											data.
+
+	Usage :			"result" must hold "resultSize" bytes.
+
+   ============================================================*/
+{
+
+	DWORD in = 0;
+	DWORD out = 0;
+	while (out < resultSize)
+	{
+		if (in >= size)
+			return FALSE;
+
+		BYTE flags = data[in++];
+		for (int bit = 0; bit < 8 && out < resultSize; bit++)
+		{
+			if (flags & (1 << bit))
+			{
+				if (in + 3 > size)
+					return FALSE;
+				DWORD offset = (data[in] | (data[in + 1] << 8)) + 1;
+				DWORD length = data[in + 2] + LZ_MIN_MATCH;
+				in += 3;
+				if (offset > out || length > resultSize - out)
+					return FALSE;
+				for (DWORD t = 0; t < length; t++, out++)
+					result[out] = result[out - offset];
+			}
+			else
+			{
+				if (in >= size)
+					return FALSE;
+				result[out++] = data[in++];
+			}
+		}
+	}
+
+	return TRUE;
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CUndoSpill private helpers
+
+BOOL CUndoSpill::Open()
+/* ============================================================
+	Function :		CUndoSpill::Open
+	Description :	Creates the file and the writer thread.
+	Access :		Private
+
+	Return :		BOOL	-	"FALSE" if the file could not
+								be created.
+	Parameters :	none
+
+	Usage :			Internal function. Does nothing if the file
+					is already open. If the thread can't be
+					started, the strings are written at once.
+
+   ============================================================*/
+{
+
+	if (m_file != INVALID_HANDLE_VALUE)
+		return TRUE;
+
+	TCHAR path[MAX_PATH];
+	TCHAR name[MAX_PATH];
+	if (!::GetTempPath(MAX_PATH, path) || !::GetTempFileName(path, _T("tlp"), 0, name))
+		return FALSE;
+
+	m_file = ::CreateFile(name, GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, NULL);
+	if (m_file == INVALID_HANDLE_VALUE)
+	{
+		::DeleteFile(name);
+		return FALSE;
+	}
+
+	m_work = ::CreateEvent(NULL, FALSE, FALSE, NULL);
+	if (m_work)
+	{
+		m_thread = AfxBeginThread(WriterProc, this, THREAD_PRIORITY_BELOW_NORMAL, 0, CREATE_SUSPENDED);
+		if (m_thread)
+		{
+			m_thread->m_bAutoDelete = FALSE;
+			m_thread->ResumeThread();
+		}
+	}
+
+	return TRUE;
+
+}
+
+void CUndoSpill::WriteBlocks()
+/* ============================================================
+	Function :		CUndoSpill::WriteBlocks
+	Description :	Compresses and writes the queued blocks.
+	Access :		Private
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Internal function, run by the writer
+					thread. A block that can't be written keeps
+					its string in memory.
+
+   ============================================================*/
+{
+
+	for (;;)
+	{
+		::EnterCriticalSection(&m_lock);
+		if (m_queue.GetSize() == 0 || m_quit)
+		{
+			::LeaveCriticalSection(&m_lock);
+			return;
+		}
+
+		int block = m_queue[0];
+		m_queue.RemoveAt(0);
+		m_current = block;
+		CByteArray* pending = m_blocks[block].pending;
+		CObArray* objects = m_blocks[block].objects;
+		SPILLPROC proc = m_blocks[block].proc;
+		::LeaveCriticalSection(&m_lock);
+
+		if (objects)
+		{
+			// "Read" may save the objects at the same time,
+			// which only reads them as well
+			CString data;
+			proc(*objects, data);
+			pending = new CByteArray;
+			ToUtf8(data, *pending);
+
+			::EnterCriticalSection(&m_lock);
+			CBlock& item = m_blocks[block];
+			item.pending = pending;
+			item.rawSize = static_cast<DWORD>(pending->GetSize());
+			item.objects = NULL;
+			BOOL used = item.used;
+			if (!used)
+			{
+				ReleaseBlock(block);
+				m_current = -1;
+			}
+			::LeaveCriticalSection(&m_lock);
+
+			DeleteObjects(objects);
+			if (!used)
+				continue;
+		}
+
+		CByteArray compressed;
+		Compress(pending->GetData(), static_cast<DWORD>(pending->GetSize()), compressed);
+		DWORD size = static_cast<DWORD>(compressed.GetSize());
+
+		// Only this thread appends, and the file is not
+		// truncated while a block is being written
+		::EnterCriticalSection(&m_lock);
+		ULONGLONG offset = m_end;
+		m_end += size;
+		::LeaveCriticalSection(&m_lock);
+
+		OVERLAPPED overlapped;
+		memset(&overlapped, 0, sizeof(overlapped));
+		overlapped.Offset = static_cast<DWORD>(offset);
+		overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+		DWORD written = 0;
+		BOOL result = ::WriteFile(m_file, compressed.GetData(), size, &written, &overlapped) && written == size;
+
+		::EnterCriticalSection(&m_lock);
+		CBlock& item = m_blocks[block];
+		if (!item.used)
+		{
+			ReleaseBlock(block);
+		}
+		else if (result)
+		{
+			item.offset = offset;
+			item.size = size;
+			delete item.pending;
+			item.pending = NULL;
+		}
+		m_current = -1;
+		::LeaveCriticalSection(&m_lock);
+	}
+
+}
+
+int CUndoSpill::AddBlock()
+/* ============================================================
+	Function :		CUndoSpill::AddBlock
+	Description :	Gets an unused block.
+	Access :		Private
+
+	Return :		int		-	The block.
+	Parameters :	none
+
+	Usage :			Internal function. Must be called with the
+					lock held.
+
+   ============================================================*/
+{
+
+	int block;
+	if (m_free.GetSize())
+	{
+		block = m_free[m_free.GetUpperBound()];
+		m_free.RemoveAt(m_free.GetUpperBound());
+	}
+	else
+	{
+		CBlock item = CBlock();
+		block = static_cast<int>(m_blocks.Add(item));
+	}
+
+	CBlock& item = m_blocks[block];
+	item.used = TRUE;
+	item.offset = 0;
+	item.size = 0;
+	item.rawSize = 0;
+	item.pending = NULL;
+	item.objects = NULL;
+	item.proc = NULL;
+	m_used++;
+
+	return block;
+
+}
+
+void CUndoSpill::ReleaseBlock(int block)
+/* ============================================================
+	Function :		CUndoSpill::ReleaseBlock
+	Description :	Makes an unused block available again.
+	Access :		Private
+
+	Return :		void
+	Parameters :	int block	-	Block to release.
+
+	Usage :			Internal function. Must be called with the
+					lock held.
+
+   ============================================================*/
+{
+
+	delete m_blocks[block].pending;
+	m_blocks[block].pending = NULL;
+	DeleteObjects(m_blocks[block].objects);
+	m_blocks[block].objects = NULL;
+	m_free.Add(block);
+
+}
+
+void CUndoSpill::DeleteObjects(CObArray* objects)
+/* ============================================================
+	Function :		CUndoSpill::DeleteObjects
+	Description :	Deletes objects given to "Write".
+	Access :		Private
+
+	Return :		void
+	Parameters :	CObArray* objects	-	Objects to delete,
+											can be "NULL".
+
+	Usage :			Internal function. Deletes the array as
+					well.
+
+   ============================================================*/
+{
+
+	if (objects)
+	{
+		INT_PTR max = objects->GetSize();
+		for (INT_PTR t = 0; t < max; t++)
+			delete objects->GetAt(t);
+		delete objects;
+	}
+
+}
+
+UINT AFX_CDECL CUndoSpill::WriterProc(LPVOID param)
+/* ============================================================
+	Function :		CUndoSpill::WriterProc
+	Description :	Thread function for the writer.
+	Access :		Private
+
+	Return :		UINT			-	Always 0.
+	Parameters :	LPVOID param	-	The "CUndoSpill".
+
+	Usage :			Writes the queued blocks each time "m_work"
+					is set. Stops when "m_quit" is set.
+
+   ============================================================*/
+{
+
+	CUndoSpill* spill = static_cast<CUndoSpill*>(param);
+	for (;;)
+	{
+		::WaitForSingleObject(spill->m_work, INFINITE);
+		if (spill->m_quit)
+			break;
+
+		spill->WriteBlocks();
+	}
+
+	return 0;
+
+}
@@ -0,0 +1,76 @@
+#ifndef _CUNDOSPILL_H_5B1E9F27_C4A3_4D86_9E0A7F31B2D48
+#define _CUNDOSPILL_H_5B1E9F27_C4A3_4D86_9E0A7F31B2D48
+
+///////////////////////////////////////////////////////////
+// File :		UndoSpill.h
+// Created :	10/19/26
+//
+
+#include <afxtempl.h>
+
+// Saves objects handed to "CUndoSpill::Write" as a string. Called
+// by the writer thread.
+typedef void (*SPILLPROC)(const CObArray& objects, CString& data);
+
+class CUndoSpill
+{
+public:
+	// Construction/destruction
+	CUndoSpill();
+	virtual ~CUndoSpill();
+
+	// Operations
+	int			Write(const CString& data);
+	int			Write(CObArray& objects, SPILLPROC proc);
+	BOOL		Read(int block, CString& data);
+	void		Free(int block);
+	void		Clear();
+
+	// Statistics
+	int			GetBlockCount() const;
+	ULONGLONG	GetFileSize() const;
+
+	// Compression
+	static void	Compress(const BYTE* data, DWORD size, CByteArray& result);
+	static BOOL	Decompress(const BYTE* data, DWORD size, BYTE* result, DWORD resultSize);
+
+private:
+	// A spilled string
+	struct CBlock
+	{
+		BOOL		used;		// FALSE if the block is free
+		ULONGLONG	offset;		// Position in the file
+		DWORD		size;		// Compressed size
+		DWORD		rawSize;	// Size of the UTF-8 string
+		CByteArray*	pending;	// The string until it is written, NULL after
+		CObArray*	objects;	// The objects until they are saved, NULL after
+		SPILLPROC	proc;		// Saves "objects"
+	};
+
+	CArray< CBlock, CBlock& >	m_blocks;
+	CArray< int, int >			m_free;			// Unused entries in "m_blocks"
+	CArray< int, int >			m_queue;		// Blocks waiting to be written
+	int							m_current;		// Block being written, -1 if none
+	int							m_used;			// Number of used blocks
+	ULONGLONG					m_end;			// End of the written data
+
+	// Writer thread
+	CRITICAL_SECTION			m_lock;
+	HANDLE						m_file;
+	HANDLE						m_work;
+	CWinThread*					m_thread;
+	volatile LONG				m_quit;
+
+	// Helpers
+	BOOL		Open();
+	void		WriteBlocks();
+	int			AddBlock();
+	void		ReleaseBlock(int block);
+
+	static void	DeleteObjects(CObArray* objects);
+
+	static UINT AFX_CDECL WriterProc(LPVOID param);
+
+};
+
+#endif //_CUNDOSPILL_H_5B1E9F27_C4A3_4D86_9E0A7F31B2D48
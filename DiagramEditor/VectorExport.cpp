@@ -0,0 +1,335 @@
+/* ==========================================================================
+	File :			VectorExport.cpp
+
+	Class :			CVectorExport
+
+	Date :			10/19/26
+
+	Purpose :		"CVectorExport" writes a diagram to an SVG or PDF
+					file, drawn with the same "Render" functions as
+					the PNG export.
+
+	Description :	Both formats are streamed to the file as the
+					objects are drawn, through
+					"CDiagramSVGRenderer" and "CDiagramPDFRenderer",
+					so the memory used does not depend on the number
+					of objects in the diagram.
+
+					The SVG file is a single picture of the diagram.
+					The PDF file is split into pages, left to right
+					and then top to bottom. The container is prepared
+					once, and each page only draws the objects
+					touching it, found with
+					"CDiagramEntityContainer::RenderRect", so objects
+					off the page are not visited or written.
+
+					Entities that only have a GDI "Draw" are drawn by
+					the base class "Render" in both formats.
+
+	Usage :			Create, set the page size and scale for PDF if
+					needed, and call "ExportSVG" or "ExportPDF".
+
+   ========================================================================*/
+
+#include "stdafx.h"
+#include "VectorExport.h"
+#include "DiagramEntityContainer.h"
+#include "DiagramSVGRenderer.h"
+#include "DiagramPDFRenderer.h"
+#include "DiagramTrace.h"
+
+#ifdef _DEBUG
+#define new DEBUG_NEW
+#undef THIS_FILE
+static char THIS_FILE[] = __FILE__;
+#endif
+
+/////////////////////////////////////////////////////////////////////////////
+// CVectorExport construction/destruction
+
+CVectorExport::CVectorExport()
+/* ============================================================
+	Function :		CVectorExport::CVectorExport
+	Description :	Constructor
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	m_pageSize = CSize(VECTOR_PAGE_WIDTH, VECTOR_PAGE_HEIGHT);
+	m_scale = VECTOR_SCALE;
+
+	m_pages = 0;
+	m_size = 0;
+	m_time = 0;
+
+}
+
+CVectorExport::~CVectorExport()
+/* ============================================================
+	Function :		CVectorExport::~CVectorExport
+	Description :	Destructor
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CVectorExport settings
+
+void CVectorExport::SetPageSize(CSize size)
+/* ============================================================
+	Function :		CVectorExport::SetPageSize
+	Description :	Sets the size of PDF pages.
+	Access :		Public
+
+	Return :		void
+	Parameters :	CSize size	-	Size in points.
+
+	Usage :			The default is A4 portrait. Pages smaller
+					than the margins are made larger.
+
+   ============================================================*/
+{
+
+	m_pageSize.cx = max(size.cx, 4 * PDF_MARGIN);
+	m_pageSize.cy = max(size.cy, 4 * PDF_MARGIN);
+
+}
+
+void CVectorExport::SetScale(double scale)
+/* ============================================================
+	Function :		CVectorExport::SetScale
+	Description :	Sets the size of a pixel on PDF pages.
+	Access :		Public
+
+	Return :		void
+	Parameters :	double scale	-	Points per pixel.
+
+	Usage :			The default, "VECTOR_SCALE", prints the
+					diagram at the size it has on screen.
+
+   ============================================================*/
+{
+
+	if (scale > 0)
+		m_scale = scale;
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CVectorExport operations
+
+BOOL CVectorExport::ExportSVG(CDiagramEntityContainer* objs, const CString& filename, CSize size, double zoom, COLORREF background)
+/* ============================================================
+	Function :		CVectorExport::ExportSVG
+	Description :	Writes a diagram to an SVG file.
+	Access :		Public
+
+	Return :		BOOL					-	"FALSE" if the
+												file could not be
+												written.
+	Parameters :	CDiagramEntityContainer* objs	-	Diagram
+												to export.
+					const CString& filename	-	File to write.
+					CSize size				-	Area of the
+												diagram to export,
+												from the top left
+												corner.
+					double zoom				-	Zoom level. The
+												picture is "size"
+												times "zoom" pixels.
+					COLORREF background		-	Color behind the
+												objects.
+
+	Usage :			Selection markers are not drawn. The file
+					is deleted if it could not be completed.
+
+   ============================================================*/
+{
+
+	DIAGRAM_TRACE_SPAN(_T("CVectorExport::ExportSVG"));
+
+	m_pages = 0;
+	m_size = 0;
+	m_time = 0;
+
+	CRect area(0, 0, static_cast<int>(size.cx * zoom + .5), static_cast<int>(size.cy * zoom + .5));
+	if (area.IsRectEmpty())
+		return FALSE;
+
+	LARGE_INTEGER frequency;
+	LARGE_INTEGER start;
+	::QueryPerformanceFrequency(&frequency);
+	::QueryPerformanceCounter(&start);
+
+	CDiagramSVGRenderer svg;
+	if (!svg.Open(filename, area, background))
+		return FALSE;
+
+	objs->RenderObjects(&svg, zoom);
+
+	m_size = svg.GetBytesWritten();
+	m_pages = 1;
+	BOOL result = svg.Close();
+	if (!result)
+		::DeleteFile(filename);
+
+	LARGE_INTEGER end;
+	::QueryPerformanceCounter(&end);
+	m_time = static_cast<double>(end.QuadPart - start.QuadPart) * 1000.0 / static_cast<double>(frequency.QuadPart);
+
+	return result;
+
+}
+
+BOOL CVectorExport::ExportPDF(CDiagramEntityContainer* objs, const CString& filename, CSize size, double zoom)
+/* ============================================================
+	Function :		CVectorExport::ExportPDF
+	Description :	Writes a diagram to a PDF file.
+	Access :		Public
+
+	Return :		BOOL					-	"FALSE" if the
+												file could not be
+												written.
+	Parameters :	CDiagramEntityContainer* objs	-	Diagram
+												to export.
+					const CString& filename	-	File to write.
+					CSize size				-	Area of the
+												diagram to export,
+												from the top left
+												corner.
+					double zoom				-	Zoom level.
+
+	Usage :			The diagram is split into as many pages as
+					needed at the scale set with "SetScale".
+					Selection markers are not drawn. The file
+					is deleted if it could not be completed.
+
+   ============================================================*/
+{
+
+	DIAGRAM_TRACE_SPAN(_T("CVectorExport::ExportPDF"));
+
+	m_pages = 0;
+	m_size = 0;
+	m_time = 0;
+
+	int width = static_cast<int>(size.cx * zoom + .5);
+	int height = static_cast<int>(size.cy * zoom + .5);
+	if (width <= 0 || height <= 0)
+		return FALSE;
+
+	LARGE_INTEGER frequency;
+	LARGE_INTEGER start;
+	::QueryPerformanceFrequency(&frequency);
+	::QueryPerformanceCounter(&start);
+
+	CDiagramPDFRenderer pdf;
+	if (!pdf.Open(filename))
+		return FALSE;
+
+	// The part of the diagram a page shows, in pixels
+	int pageWidth = max(static_cast<int>((m_pageSize.cx - 2 * PDF_MARGIN) / m_scale), 1);
+	int pageHeight = max(static_cast<int>((m_pageSize.cy - 2 * PDF_MARGIN) / m_scale), 1);
+	int columns = (width + pageWidth - 1) / pageWidth;
+	int rows = (height + pageHeight - 1) / pageHeight;
+
+	objs->PrepareRender(zoom);
+	for (int row = 0; row < rows; row++)
+	{
+		for (int column = 0; column < columns; column++)
+		{
+			CRect area(column * pageWidth, row * pageHeight, (column + 1) * pageWidth, (row + 1) * pageHeight);
+			area.right = min(area.right, width);
+			area.bottom = min(area.bottom, height);
+
+			pdf.BeginPage(m_pageSize, area, m_scale);
+			objs->RenderRect(&pdf, area, zoom);
+			pdf.EndPage();
+		}
+	}
+
+	m_pages = pdf.GetPageCount();
+	BOOL result = pdf.Close();
+	m_size = pdf.GetBytesWritten();
+	if (!result)
+		::DeleteFile(filename);
+
+	LARGE_INTEGER end;
+	::QueryPerformanceCounter(&end);
+	m_time = static_cast<double>(end.QuadPart - start.QuadPart) * 1000.0 / static_cast<double>(frequency.QuadPart);
+
+	return result;
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CVectorExport results
+
+int CVectorExport::GetPageCount() const
+/* ============================================================
+	Function :		CVectorExport::GetPageCount
+	Description :	Gets the number of pages of the last
+					export.
+	Access :		Public
+
+	Return :		int		-	Pages, 1 for SVG.
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	return m_pages;
+
+}
+
+DWORD CVectorExport::GetFileSize() const
+/* ============================================================
+	Function :		CVectorExport::GetFileSize
+	Description :	Gets the size of the file of the last
+					export.
+	Access :		Public
+
+	Return :		DWORD	-	Size in bytes.
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	return m_size;
+
+}
+
+double CVectorExport::GetTotalTime() const
+/* ============================================================
+	Function :		CVectorExport::GetTotalTime
+	Description :	Gets the time the last export took.
+	Access :		Public
+
+	Return :		double	-	Time in milliseconds.
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	return m_time;
+
+}
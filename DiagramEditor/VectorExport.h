@@ -0,0 +1,47 @@
+#ifndef _CVECTOREXPORT_H_9A1D64F2_B83E_4C07_8E5A3F92D17B6
+#define _CVECTOREXPORT_H_9A1D64F2_B83E_4C07_8E5A3F92D17B6
+
+///////////////////////////////////////////////////////////
+// File :		VectorExport.h
+// Created :	10/19/26
+//
+
+class CDiagramEntityContainer;
+
+#define VECTOR_PAGE_WIDTH	595		// A4, in points
+#define VECTOR_PAGE_HEIGHT	842
+#define VECTOR_SCALE		.75		// Points per pixel, 96 pixels to the inch
+
+class CVectorExport
+{
+public:
+	// Construction/destruction
+	CVectorExport();
+	virtual ~CVectorExport();
+
+	// Settings
+	void		SetPageSize(CSize size);
+	void		SetScale(double scale);
+
+	// Operations
+	BOOL		ExportSVG(CDiagramEntityContainer* objs, const CString& filename, CSize size, double zoom, COLORREF background);
+	BOOL		ExportPDF(CDiagramEntityContainer* objs, const CString& filename, CSize size, double zoom);
+
+	// Results
+	int			GetPageCount() const;
+	DWORD		GetFileSize() const;
+	double		GetTotalTime() const;
+
+private:
+	// Settings
+	CSize		m_pageSize;
+	double		m_scale;
+
+	// Results
+	int			m_pages;
+	DWORD		m_size;
+	double		m_time;
+
+};
+
+#endif //_CVECTOREXPORT_H_9A1D64F2_B83E_4C07_8E5A3F92D17B6
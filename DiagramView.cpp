@@ -77,6 +77,9 @@ BEGIN_MESSAGE_MAP(CDiagramView, CView)
 	ON_UPDATE_COMMAND_UI(ID_SNAP, OnUpdateSnap)
 	ON_COMMAND(ID_SHOW_GRID, OnShowGrid)
 	ON_UPDATE_COMMAND_UI(ID_SHOW_GRID, OnUpdateShowGrid)
+	ON_COMMAND(ID_PERFORMANCE, OnPerformance)
+	ON_UPDATE_COMMAND_UI(ID_PERFORMANCE, OnUpdatePerformance)
+	ON_COMMAND(ID_MEMORY_USAGE, OnMemoryUsage)
 END_MESSAGE_MAP()
 
 
@@ -348,6 +351,23 @@ void CDiagramView::OnUpdateShowGrid(CCmdUI* pCmdUI)
 	pCmdUI->SetCheck(m_editor->IsGridVisible());
 }
 
+void CDiagramView::OnPerformance()
+{
+	m_editor->ShowPerformance(!m_editor->IsPerformanceVisible());
+}
+
+void CDiagramView::OnUpdatePerformance(CCmdUI* pCmdUI)
+{
+	pCmdUI->SetCheck(m_editor->IsPerformanceVisible());
+}
+
+void CDiagramView::OnMemoryUsage()
+{
+	CDiagramMemoryUsage usage;
+	m_editor->GetDiagramEntityContainer()->GetMemoryUsage(usage);
+	AfxMessageBox(usage.GetSummary(), MB_ICONINFORMATION);
+}
+
 void CDiagramView::OnUpdateMargins(CCmdUI* pCmdUI)
 {
 	pCmdUI->SetCheck(m_editor->IsMarginVisible());
@@ -371,6 +391,9 @@ void CDiagramView::OnSettings()
 
 	if (dlg.DoModal() == IDOK)
 	{
+		// Apply all the settings with a single redraw
+		m_editor->BeginTransaction();
+
 		// Check if we need to snapshot for undo
 		if (m_editor->GetBackgroundColor() != dlg.m_color)
 		{
@@ -381,7 +404,8 @@ void CDiagramView::OnSettings()
 		m_editor->SetGridSize(CSize(dlg.m_gridWidth, dlg.m_gridHeight));
 		m_editor->SetVirtualSize(CSize(dlg.m_width, dlg.m_height));
 		m_editor->SetMargins(dlg.m_marginLeft, dlg.m_marginTop, dlg.m_marginRight, dlg.m_marginBottom);
-		m_editor->RedrawWindow();
+		m_editor->RequestRedraw();
+		m_editor->CommitTransaction();
 	}
 }
 
@@ -451,11 +475,11 @@ void CDiagramView::OnBottom()
 
 void CDiagramView::OnUpdateUp(CCmdUI* pCmdUI)
 {
-	pCmdUI->Enable(m_editor->GetSelectCount() == 1);
+	pCmdUI->Enable(m_editor->GetSelectCount() > 0);
 }
 void CDiagramView::OnUpdateDown(CCmdUI* pCmdUI)
 {
-	pCmdUI->Enable(m_editor->GetSelectCount() == 1);
+	pCmdUI->Enable(m_editor->GetSelectCount() > 0);
 }
 void CDiagramView::OnUpdateFront(CCmdUI* pCmdUI)
 {
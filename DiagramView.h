@@ -61,6 +61,9 @@ protected:
 	afx_msg void OnUpdateSnap(CCmdUI* pCmdUI);
 	afx_msg void OnShowGrid();
 	afx_msg void OnUpdateShowGrid(CCmdUI* pCmdUI);
+	afx_msg void OnPerformance();
+	afx_msg void OnUpdatePerformance(CCmdUI* pCmdUI);
+	afx_msg void OnMemoryUsage();
 	afx_msg void OnMargins();
 	afx_msg void OnUpdateMargins(CCmdUI* pCmdUI);
 	afx_msg void OnRestraints();
@@ -12,6 +12,8 @@
 
 class CDiagramButton : public CDiagramEntity
 {
+	DECLARE_ENTITY_SIZE(CDiagramButton)
+
 	// Construction
 public:
 	CDiagramButton();
@@ -12,6 +12,8 @@
 
 class CDiagramCheckbox : public CDiagramEntity
 {
+	DECLARE_ENTITY_SIZE(CDiagramCheckbox)
+
 	// Construction
 public:
 	CDiagramCheckbox();
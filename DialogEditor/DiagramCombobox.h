@@ -15,6 +15,8 @@
 
 class CDiagramCombobox : public CDiagramEntity
 {
+	DECLARE_ENTITY_SIZE(CDiagramCombobox)
+
 	// Construction
 public:
 	CDiagramCombobox();
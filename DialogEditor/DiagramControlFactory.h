@@ -1,7 +1,7 @@
 #ifndef _DIAGRAMCONTROLFACTORY_H_
 #define _DIAGRAMCONTROLFACTORY_H_
 
-#include "DiagramEditor\DiagramEntity.h"
+#include "../DiagramEditor/DiagramEntity.h"
 
 class CDiagramControlFactory {
 
@@ -15,6 +15,8 @@
 
 class CDiagramEdit : public CDiagramEntity
 {
+	DECLARE_ENTITY_SIZE(CDiagramEdit)
+
 	// Construction
 public:
 	CDiagramEdit();
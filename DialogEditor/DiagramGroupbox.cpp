@@ -21,7 +21,7 @@
    ========================================================================*/
 
 #include "stdafx.h"
-#include "DiagramEditor\DiagramEntity.h"
+#include "../DiagramEditor/DiagramEntity.h"
 #include "DiagramGroupbox.h"
 #include "StdGrfx.h"
 
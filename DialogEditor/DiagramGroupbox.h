@@ -12,6 +12,8 @@
 
 class CDiagramGroupbox : public CDiagramEntity
 {
+	DECLARE_ENTITY_SIZE(CDiagramGroupbox)
+
 	// Construction
 public:
 	CDiagramGroupbox();
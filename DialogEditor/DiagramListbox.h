@@ -15,6 +15,8 @@
 
 class CDiagramListbox : public CDiagramEntity
 {
+	DECLARE_ENTITY_SIZE(CDiagramListbox)
+
 	// Construction
 public:
 	CDiagramListbox();
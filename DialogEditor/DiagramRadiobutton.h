@@ -12,6 +12,8 @@
 
 class CDiagramRadiobutton : public CDiagramEntity
 {
+	DECLARE_ENTITY_SIZE(CDiagramRadiobutton)
+
 	// Construction
 public:
 	CDiagramRadiobutton();
@@ -21,7 +21,7 @@
    ========================================================================*/
 
 #include "stdafx.h"
-#include "DiagramEditor\DiagramEntity.h"
+#include "../DiagramEditor/DiagramEntity.h"
 #include "DiagramStatic.h"
 #include "StdGrfx.h"
 
@@ -12,6 +12,8 @@
 
 class CDiagramStatic : public CDiagramEntity
 {
+	DECLARE_ENTITY_SIZE(CDiagramStatic)
+
 	// Construction
 public:
 	CDiagramStatic();
@@ -4,6 +4,7 @@
 #include "stdafx.h"
 #include "StdGrfx.h"
 #include "DialogEditor.h"
+#include "../DiagramEditor/DiagramTrace.h"
 
 #ifdef _DEBUG
 #define new DEBUG_NEW
@@ -59,14 +60,36 @@ void CDialogEditor::ExportEMF(const CString& filename, const bool noDialog)
 
 	Usage :			Call to export the diagram to an EMF file
 					for - for example - inclusion into a
-					word-processing document.
+					word-processing document. If a ".png",
+					".svg" or ".pdf" file is chosen, the
+					diagram is exported to that format
+					instead, see "ExportPNG", "ExportSVG" and
+					"ExportPDF".
 
    ============================================================*/
 {
 
-	CFileDialog dlg(FALSE, _T("emf"), filename, OFN_HIDEREADONLY | OFN_OVERWRITEPROMPT, _T("Enhanced MetaFile (*.emf)|*.emf|All Files (*.*)|*.*||"));
+	CFileDialog dlg(FALSE, _T("emf"), filename, OFN_HIDEREADONLY | OFN_OVERWRITEPROMPT, _T("Enhanced MetaFile (*.emf)|*.emf|PNG Image (*.png)|*.png|SVG Image (*.svg)|*.svg|PDF Document (*.pdf)|*.pdf|All Files (*.*)|*.*||"));
 	if (noDialog || dlg.DoModal() == IDOK)
 	{
+		CString extension = dlg.GetPathName().Right(4);
+		if (extension.CompareNoCase(_T(".png")) == 0)
+		{
+			ExportPNG(dlg.GetPathName());
+			return;
+		}
+		if (extension.CompareNoCase(_T(".svg")) == 0)
+		{
+			ExportSVG(dlg.GetPathName());
+			return;
+		}
+		if (extension.CompareNoCase(_T(".pdf")) == 0)
+		{
+			ExportPDF(dlg.GetPathName());
+			return;
+		}
+
+		DIAGRAM_TRACE_SPAN(_T("CDialogEditor::ExportEMF"));
 
 		CClientDC	dc(this);
 		CMetaFileDC	metaDC;
@@ -17,7 +17,7 @@
 
    ========================================================================*/
 #include "stdafx.h"
-#include "stdgrfx.h"
+#include "StdGrfx.h"
 
 #ifdef _DEBUG
 #define new DEBUG_NEW
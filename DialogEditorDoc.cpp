@@ -5,6 +5,7 @@
 #include "Tulip.h"
 
 #include "DialogEditorDoc.h"
+#include "DiagramEditor/DiagramTrace.h"
 
 // --- DiagramEditor ---
 #include "DialogEditor/DiagramControlFactory.h"
@@ -31,6 +32,7 @@ END_MESSAGE_MAP()
 
 CDialogEditorDoc::CDialogEditorDoc()
 {
+	m_objs.SetEntityFactory(CDiagramControlFactory::CreateFromString);
 }
 
 CDialogEditorDoc::~CDialogEditorDoc()
@@ -56,6 +58,8 @@ BOOL CDialogEditorDoc::OnNewDocument()
 
 void CDialogEditorDoc::Serialize(CArchive& ar)
 {
+	DIAGRAM_TRACE_SPAN(_T("CDialogEditorDoc::Serialize"));
+
 	// --- DiagramEditor ---
 	// Saving and loading to/from a text file
 	if (ar.IsStoring())
@@ -124,6 +128,8 @@ BOOL CDialogEditorDoc::SaveModified()
 
 void CDialogEditorDoc::ExportHTML(CString filename)
 {
+	DIAGRAM_TRACE_SPAN(_T("CDialogEditorDoc::ExportHTML"));
+
 	// Exporting to HTML
 	CStringArray stra;
 
@@ -59,6 +59,12 @@
 					   in UNC parsing. (jkaspzyk)
 					2. Added UNICODE macro to SetSystemErrorMessage
 					   declaration. (nuhi)
+   ========================================================================
+	Date :			2026-10-19
+
+	Purpose			1. "EnumAllFilesWithFilter" also returns the files
+					   of "sourceDirectory" itself, not only those of
+					   the subdirectories.
    ========================================================================*/
 
 #include "stdafx.h"
@@ -1100,6 +1106,8 @@ BOOL CDiskObject::EnumAllFilesWithFilter(const CString& filter, const CString& s
 	BOOL result = EnumAllDirectories(sourceDirectory, dirs);
 	if (result)
 	{
+		// "dirs" only holds the subdirectories
+		dirs.InsertAt(0, sourceDirectory);
 		INT_PTR max1 = dirs.GetSize();
 		for (INT_PTR t = 0; t < max1; t++)
 		{
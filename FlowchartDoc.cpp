@@ -5,6 +5,7 @@
 
 #include "Tulip.h"
 #include "FlowchartDoc.h"
+#include "DiagramEditor/DiagramTrace.h"
 #include "FlowchartEditor/FlowchartControlFactory.h"
 
 #ifdef _DEBUG
@@ -29,6 +30,8 @@ END_MESSAGE_MAP()
 CFlowchartDoc::CFlowchartDoc()
 {
 
+	m_objs.SetEntityFactory(CFlowchartControlFactory::CreateFromString);
+
 }
 
 CFlowchartDoc::~CFlowchartDoc()
@@ -51,6 +54,8 @@ BOOL CFlowchartDoc::OnNewDocument()
 void CFlowchartDoc::Serialize(CArchive& ar)
 {
 
+	DIAGRAM_TRACE_SPAN(_T("CFlowchartDoc::Serialize"));
+
 	if (ar.IsStoring())
 	{
 		ar.WriteString(m_objs.GetString() + _T("\r\n"));
@@ -67,10 +72,19 @@ void CFlowchartDoc::Serialize(CArchive& ar)
 				ar.WriteString(link->GetString() + _T("\r\n"));
 		}
 
+		// The preview is written last, where it can be read without the diagram
+		m_thumbnail.Update(&m_objs);
+		m_thumbnail.WriteTrailer(ar);
+
 		m_objs.SetModified(FALSE);
 	}
 	else
 	{
+#ifdef SHARED_HANDLERS
+		// Thumbnail handlers only need the preview
+		if (m_bGetThumbnailMode && m_thumbnail.ReadTrailer(ar))
+			return;
+#endif // SHARED_HANDLERS
 
 		m_objs.Clear();
 		CString str;
@@ -99,6 +113,20 @@ void CFlowchartDoc::Serialize(CArchive& ar)
 
 }
 
+#ifdef SHARED_HANDLERS
+
+// Support for thumbnails
+void CFlowchartDoc::OnDrawThumbnail(CDC& dc, LPRECT lprcBounds)
+{
+	// Older files have no preview, draw the diagram instead
+	if (m_thumbnail.IsEmpty())
+		m_thumbnail.Create(m_objs.GetData());
+
+	m_thumbnail.Draw(dc, lprcBounds);
+}
+
+#endif // SHARED_HANDLERS
+
 /////////////////////////////////////////////////////////////////////////////
 // CFlowchartDoc diagnostics
 
@@ -5,6 +5,7 @@
 #pragma once
 
 #include "FlowchartEditor/FlowchartEntityContainer.h"
+#include "DiagramEditor/DiagramThumbnail.h"
 
 class CFlowchartDoc : public CDocument
 {
@@ -29,6 +30,10 @@ public:
 protected:
 	virtual BOOL SaveModified();
 	//}}AFX_VIRTUAL
+#ifdef SHARED_HANDLERS
+public:
+	virtual void OnDrawThumbnail(CDC& dc, LPRECT lprcBounds);
+#endif // SHARED_HANDLERS
 
 // Implementation
 public:
@@ -50,5 +55,6 @@ protected:
 
 private:
 	CFlowchartEntityContainer	m_objs;
+	CDiagramThumbnail			m_thumbnail;
 
 };
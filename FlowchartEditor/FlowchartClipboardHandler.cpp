@@ -28,6 +28,7 @@
 #include "../DiagramEditor/DiagramEntityContainer.h"
 #include "FlowchartEntityContainer.h"
 #include "FlowchartLink.h"
+#include "../DiagramEditor/DiagramMemoryUsage.h"
 
 CFlowchartClipboardHandler::CFlowchartClipboardHandler()
 /* ============================================================
@@ -108,26 +109,26 @@ void CFlowchartClipboardHandler::Paste(CDiagramEntityContainer* container)
 		return;
 	}
 
+	// Map the copied ids to the pasted ones
+	CMap< ULONGLONG, ULONGLONG, ULONGLONG, ULONGLONG > ids;
+	for (INT_PTR i = 0; i < maxObjs; i++)
+	{
+		CDiagramEntity* obj = static_cast<CDiagramEntity*>(paste->GetAt(i));
+		CDiagramEntity* newObj = static_cast<CDiagramEntity*>(lastPaste->GetAt(i));
+		ids.SetAt(obj->GetID(), newObj->GetID());
+	}
+
+	ULONGLONG id;
 	for (INT_PTR t = 0; t < maxLinks; t++)
 	{
 		// Get the link
 		CFlowchartLink* link = static_cast<CFlowchartLink*>(m_pasteLinks[t])->Clone();
 
-		// Make sure we have the correct names
-		for (INT_PTR i = 0; i < maxObjs; i++)
-		{
-			CDiagramEntity* obj = static_cast<CDiagramEntity*>(paste->GetAt(i));
-			CDiagramEntity* newObj = static_cast<CDiagramEntity*>(lastPaste->GetAt(i));
-			if (link->from == obj->GetName())
-			{
-				link->from = newObj->GetName();
-			}
-
-			if (link->to == obj->GetName())
-			{
-				link->to = newObj->GetName();
-			}
-		}
+		// Make sure we have the correct ids
+		if (ids.Lookup(link->from, id))
+			link->from = id;
+		if (ids.Lookup(link->to, id))
+			link->to = id;
 
 		// Add the link
 		flow->AddLink(link);
@@ -164,23 +165,24 @@ void CFlowchartClipboardHandler::CopyAllSelected(CDiagramEntityContainer* contai
 	CObArray* paste = GetData();
 	max = paste->GetSize();
 
+	CMap< ULONGLONG, ULONGLONG, ULONGLONG, ULONGLONG > ids;
 	for (INT_PTR t = 0; t < max; t++)
 	{
 		CDiagramEntity* obj = static_cast<CDiagramEntity*>(paste->GetAt(t));
-		CString newID = CLinkFactory::GetID();
-
-		INT_PTR maxlinks = m_pasteLinks.GetSize();
-		for (INT_PTR i = 0; i < maxlinks; i++)
-		{
-			CFlowchartLink* link = static_cast<CFlowchartLink*>(m_pasteLinks[i]);
-			if (link->from == obj->GetName())
-				link->from = newID;
-			if (link->to == obj->GetName())
-				link->to = newID;
-		}
-
-		obj->SetName(newID);
+		ULONGLONG oldID = obj->GetID();
+		obj->SetName(CLinkFactory::GetID());
+		ids.SetAt(oldID, obj->GetID());
+	}
 
+	ULONGLONG id;
+	INT_PTR maxlinks = m_pasteLinks.GetSize();
+	for (INT_PTR i = 0; i < maxlinks; i++)
+	{
+		CFlowchartLink* link = static_cast<CFlowchartLink*>(m_pasteLinks[i]);
+		if (ids.Lookup(link->from, id))
+			link->from = id;
+		if (ids.Lookup(link->to, id))
+			link->to = id;
 	}
 
 }
@@ -209,3 +211,28 @@ void CFlowchartClipboardHandler::ClearPaste()
 
 }
 
+void CFlowchartClipboardHandler::GetMemoryUsage(CDiagramMemoryUsage& usage) const
+/* ============================================================
+	Function :		CFlowchartClipboardHandler::GetMemoryUsage
+	Description :	Adds the memory held by the clipboard to
+					"usage".
+
+	Return :		void
+	Parameters :	CDiagramMemoryUsage& usage	-	Breakdown
+													to add to.
+
+	Usage :			Overridden to add the paste link array.
+
+   ============================================================*/
+{
+
+	CDiagramClipboardHandler::GetMemoryUsage(usage);
+
+	usage.Add(_T("Links"), _T("Link array"), 1, m_pasteLinks.GetSize() * sizeof(CObject*));
+
+	INT_PTR max = m_pasteLinks.GetSize();
+	for (INT_PTR t = 0; t < max; t++)
+		static_cast<CFlowchartLink*>(m_pasteLinks.GetAt(t))->GetMemoryUsage(usage);
+
+}
+
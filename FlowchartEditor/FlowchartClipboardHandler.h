@@ -15,6 +15,7 @@ public:
 	virtual void	Paste(CDiagramEntityContainer* container);
 	virtual void	CopyAllSelected(CDiagramEntityContainer* container);
 	virtual void	ClearPaste();
+	virtual void	GetMemoryUsage(CDiagramMemoryUsage& usage) const;
 
 private:
 	// Private data
@@ -22,6 +22,7 @@
    ========================================================================*/
 #include "stdafx.h"
 #include "FlowchartControlFactory.h"
+#include "../DiagramEditor/DiagramTrace.h"
 
 #include "FlowchartEntityTerminator.h"
 #include "FlowchartEntityBox.h"
@@ -60,6 +61,8 @@ CDiagramEntity* CFlowchartControlFactory::CreateFromString(const CString& str)
 
    ============================================================*/
 {
+	DIAGRAM_TRACE_SPAN(_T("CFlowchartControlFactory::CreateFromString"));
+
 	CDiagramEntity* obj;
 
 	obj = CFlowchartEntityTerminator::CreateFromString(str);
@@ -68,6 +68,8 @@
 #include "FlowchartEntityContainer.h"
 #include "FlowchartLinkPropertiesDialog.h"
 #include "FlowchartLinkableLineSegment.h"
+#include "../DiagramEditor/DiagramTrace.h"
+#include "../DiagramEditor/DiagramGDIRenderer.h"
 
 #include <math.h>
 
@@ -128,28 +130,30 @@ void CFlowchartEditor::DrawObjects(CDC* dc, double zoom) const
 					double zoom	-	Zoom level (use this value
 									instead of GetZoom())
 
-	Usage :			Overridden to draw links.
+	Usage :			Overridden to draw links. The links are
+					routed around the objects, with the arrow
+					head following the last segment.
 
    ============================================================*/
 {
 
+	DIAGRAM_TRACE_SPAN(_T("CFlowchartEditor::DrawObjects"));
+
 	CFlowchartEntityContainer* objs = dynamic_cast<CFlowchartEntityContainer *>(GetDiagramEntityContainer());
 	if (objs)
 	{
-		CFont font;
-		font.CreateFont(-round(12.0 * zoom), 0, 0, 0, FW_NORMAL, 0, 0, 0, 0, 0, 0, 0, 0, _T("Courier New"));
+		objs->RouteLinks();
 
 		INT_PTR count = GetObjectCount();
 
 		INT_PTR max = objs->GetLinks();
-		int seg = round((double)GetMarkerSize().cx * zoom / 2);
-		POINT pts[3]{};
+		INT_PTR resolved = 0;
 
 		for (INT_PTR i = 0; i < count; i++)
 		{
 
 			CDiagramEntity* main = static_cast<CDiagramEntity*>(objs->GetAt(i));
-			CFlowchartEntity* obj = dynamic_cast<CFlowchartEntity*>(objs->GetAt(i));
+			CFlowchartEntity* obj = CFlowchartEntity::Cast(main);
 			if (obj)
 			{
 				for (int t = 0; t < max; t++)
@@ -160,136 +164,18 @@ void CFlowchartEditor::DrawObjects(CDC* dc, double zoom) const
 						// Get the to/from objects
 						CFlowchartEntity* to = GetNamedObject(link->to);
 						CFlowchartEntity* from = GetNamedObject(link->from);
+						resolved++;
 
 						// See if this link needs to be deleted
 						if (!to || !from)
 						{
 							objs->DeleteLink(link);
 						}
-						else if (link->from == obj->GetName())
+						else if (link->from == obj->GetID())
 						{
 							// Otherwise, if this is the link we are looking for
-							dc->SelectStockObject(BLACK_PEN);
-							dc->SelectStockObject(BLACK_BRUSH);
-
-							BOOL drawArrow = TRUE;
-							CPoint start;
-							CPoint end;
-							start = obj->GetLinkPosition(link->fromtype);
-							end = to->GetLinkPosition(link->totype);
-
-							start.x = round((double)start.x * zoom);
-							start.y = round((double)start.y * zoom);
-							end.x = round((double)end.x * zoom);
-							end.y = round((double)end.y * zoom);
-
-							switch (link->fromtype)
-							{
-							case LINK_RIGHT:
-								pts[1].x = end.x - seg * 2;
-								pts[1].y = end.y - seg;
-								pts[2].x = end.x - seg * 2;
-								pts[2].y = end.y + seg;
-								break;
-
-							case LINK_LEFT:
-								pts[1].x = end.x + seg * 2;
-								pts[1].y = end.y - seg;
-								pts[2].x = end.x + seg * 2;
-								pts[2].y = end.y + seg;
-								break;
-
-							case LINK_TOP:
-								pts[1].x = end.x - seg;
-								pts[1].y = end.y + seg * 2;
-								pts[2].x = end.x + seg;
-								pts[2].y = end.y + seg * 2;
-								break;
-
-							case LINK_BOTTOM:
-								pts[1].x = end.x - seg;
-								pts[1].y = end.y - seg * 2;
-								pts[2].x = end.x + seg;
-								pts[2].y = end.y - seg * 2;
-
-								break;
-
-							default:
-							{
-								switch (link->totype)
-								{
-								case LINK_RIGHT:
-									pts[1].x = end.x + seg * 2;
-									pts[1].y = end.y - seg;
-									pts[2].x = end.x + seg * 2;
-									pts[2].y = end.y + seg;
-									break;
-
-								case LINK_LEFT:
-									pts[1].x = end.x - seg * 2;
-									pts[1].y = end.y - seg;
-									pts[2].x = end.x - seg * 2;
-									pts[2].y = end.y + seg;
-									break;
-
-								case LINK_TOP:
-									pts[1].x = end.x - seg;
-									pts[1].y = end.y - seg * 2;
-									pts[2].x = end.x + seg;
-									pts[2].y = end.y - seg * 2;
-									break;
-
-								case LINK_BOTTOM:
-									pts[1].x = end.x - seg;
-									pts[1].y = end.y + seg * 2;
-									pts[2].x = end.x + seg;
-									pts[2].y = end.y + seg * 2;
-									break;
-
-								default:
-									drawArrow = FALSE;
-									break;
-								}
-							}
-							break;
-							}
-
-							dc->MoveTo(start);
-							dc->LineTo(end);
-
-							pts[0].x = end.x;
-							pts[0].y = end.y;
-
-							if (drawArrow)
-								dc->Polygon(pts, 3);
-
-							CString str = link->title;
-							if (str.GetLength())
-							{
-								dc->SelectObject(&font);
-								int mode = dc->SetBkMode(TRANSPARENT);
-
-								CRect rect(start, end);
-								rect.NormalizeRect();
-								int cy = round(14.0 * zoom);
-								int cut = round((double)GetMarkerSize().cx * zoom / 2);
-								CRect r(rect.right - cut, rect.top, rect.right - (rect.Width() + cut), rect.bottom);
-								if (rect.top == rect.bottom)
-								{
-									CRect r(rect.left, rect.top - (cy + cut), rect.right, rect.bottom);
-									r.NormalizeRect();
-									dc->DrawText(str, r, DT_NOPREFIX | DT_SINGLELINE | DT_VCENTER | DT_CENTER);
-								}
-								else
-								{
-									CRect r(rect.right - cut, rect.top, rect.right - (cy * str.GetLength() + cut), rect.bottom);
-									r.NormalizeRect();
-									dc->DrawText(str, r, DT_NOPREFIX | DT_SINGLELINE | DT_VCENTER | DT_RIGHT);
-								}
-
-								dc->SetBkMode(mode);
-								dc->SelectStockObject(DEFAULT_GUI_FONT);
-							}
+							CDiagramGDIRenderer renderer(dc);
+							objs->RenderLink(&renderer, link, obj, to, zoom, GetMarkerSize());
 						}
 					}
 				}
@@ -297,6 +183,9 @@ void CFlowchartEditor::DrawObjects(CDC* dc, double zoom) const
 
 			main->DrawObject(dc, zoom);
 		}
+
+		CountDrawn(count, count);
+		CountLinks(resolved);
 	}
 
 }
@@ -312,14 +201,36 @@ void CFlowchartEditor::ExportEMF(const CString& filename)
 
 	Usage :			Call to export the diagram to an EMF file
 					for - for example - inclusion into a
-					word-processing document.
+					word-processing document. If a ".png",
+					".svg" or ".pdf" file is chosen, the
+					diagram is exported to that format
+					instead, see "ExportPNG", "ExportSVG" and
+					"ExportPDF".
 
    ============================================================*/
 {
 
-	CFileDialog dlg(FALSE, _T("emf"), filename, OFN_HIDEREADONLY | OFN_OVERWRITEPROMPT, _T("Enhanced MetaFile (*.emf)|*.emf|All Files (*.*)|*.*||"));
+	CFileDialog dlg(FALSE, _T("emf"), filename, OFN_HIDEREADONLY | OFN_OVERWRITEPROMPT, _T("Enhanced MetaFile (*.emf)|*.emf|PNG Image (*.png)|*.png|SVG Image (*.svg)|*.svg|PDF Document (*.pdf)|*.pdf|All Files (*.*)|*.*||"));
 	if (dlg.DoModal() == IDOK)
 	{
+		CString extension = dlg.GetPathName().Right(4);
+		if (extension.CompareNoCase(_T(".png")) == 0)
+		{
+			ExportPNG(dlg.GetPathName());
+			return;
+		}
+		if (extension.CompareNoCase(_T(".svg")) == 0)
+		{
+			ExportSVG(dlg.GetPathName());
+			return;
+		}
+		if (extension.CompareNoCase(_T(".pdf")) == 0)
+		{
+			ExportPDF(dlg.GetPathName());
+			return;
+		}
+
+		DIAGRAM_TRACE_SPAN(_T("CFlowchartEditor::ExportEMF"));
 
 		CClientDC	dc(this);
 		CMetaFileDC	metaDC;
@@ -481,7 +392,7 @@ void CFlowchartEditor::OnKeyDown(UINT nChar, UINT nRepCnt, UINT nFlags)
 /////////////////////////////////////////////////////////////////////////////
 // CFlowchartEditor private helpers
 
-void CFlowchartEditor::ModifyLinkedPositions()
+int CFlowchartEditor::ModifyLinkedPositions()
 /* ============================================================
 	Function :		CFlowchartEditor::ModifyLinkedPositions
 	Description :	Will modify the position of all unselected
@@ -490,180 +401,175 @@ void CFlowchartEditor::ModifyLinkedPositions()
 					offset. Movement direction is dependent on
 					the link type.
 
-	Return :		void
+	Return :		int		-	Number of objects moved.
 	Parameters :	none
 
 	Usage :			Should be called after all operations that
-					might move an object.
+					might move an object. All the selected
+					objects are adjusted for in a single pass.
 
    ============================================================*/
 {
 
+	CObArray moved;
 	INT_PTR max = GetObjectCount();
-	CFlowchartEntity* obj;
 	for (int t = 0; t < max; t++)
 	{
-		obj = dynamic_cast<CFlowchartEntity*>(GetObject(t));
+		CFlowchartEntity* obj = CFlowchartEntity::Cast(GetObject(t));
 		if (obj && obj->IsSelected())
-			AdjustLinkedObjects(obj);
+			moved.Add(obj);
 	}
 
-	max = GetObjectCount();
-	for (int t = 0; t < max; t++)
-	{
-		obj = dynamic_cast<CFlowchartEntity*>(GetObject(t));
-		if (obj)
-			obj->SetMoved(FALSE);
-	}
+	return AdjustLinkedObjects(moved);
 
 }
 
-void CFlowchartEditor::AdjustLinkedObjects(CFlowchartEntity* parent, CFlowchartEntity* filter)
+int CFlowchartEditor::AdjustLinkedObjects(const CObArray& moved)
 /* ============================================================
 	Function :		CFlowchartEditor::AdjustLinkedObjects
-	Description :	The function adjusts all objects attached
-					to parent, except filter (filter is assumed
-					to be last iteration's parent).
-
-	Return :		void
-	Parameters :	CFlowchartEntity* parent	-	The object to
-													find attached
-													links to.
-					CFlowchartEntity* filter	-	Object attached
-													to parent that
-													is not to be
-													moved.
-
-	Usage :			The function is called to recursively adjust
-					the positions of objects attached to an
-					object being moved.
+	Description :	The function adjusts all objects attached,
+					directly or through other objects, to the
+					objects in "moved".
+
+	Return :		int						-	Number of objects
+												moved.
+	Parameters :	const CObArray& moved	-	The objects to
+												find attached
+												links to.
+
+	Usage :			The objects are adjusted from a worklist,
+					breadth first, so long chains of links do
+					not use up the stack. The names and links
+					are indexed once, and every object is moved
+					at most once, so cycles of links always
+					end. The objects in "moved" are never
+					moved.
 
    ============================================================*/
 {
 
-	parent->SetMoved(TRUE);
-	BOOL moved = FALSE;
+	DIAGRAM_TRACE_SPAN(_T("CFlowchartEditor::AdjustLinkedObjects"));
 
-	CString name1 = parent->GetName();
-	CString name2;
+	CFlowchartEntityContainer* objs = dynamic_cast<CFlowchartEntityContainer *>(GetDiagramEntityContainer());
+	if (objs == NULL)
+		return 0;
 
-	double sizediff = 0.0;
+	void* value;
 
-	CFlowchartEntityContainer* objs = dynamic_cast<CFlowchartEntityContainer *>(GetDiagramEntityContainer());
-	if (objs)
+	// Index the link ends by the objects they are attached to.
+	// Entry "2 * n" is the "from" end of link "n", "2 * n + 1"
+	// the "to" end, and "next" chains the entries attached to
+	// the same object.
+
+	INT_PTR count = objs->GetLinks();
+	CMapPtrToPtr attached;
+	CArray< INT_PTR, INT_PTR > next;
+	next.SetSize(count * 2);
+	for (INT_PTR entry = count * 2 - 1; entry >= 0; entry--)
 	{
-		INT_PTR max = objs->GetLinks();
-		for (INT_PTR t = 0; t < max; t++)
+		CFlowchartLink* link = objs->GetLinkAt(entry / 2);
+		next[entry] = -1;
+		if (link)
 		{
-			CFlowchartLink* link = objs->GetLinkAt(t);
-			if (link)
-			{
-				int fromtype = link->fromtype;
-				int totype = link->totype;
+			CDiagramEntity* obj = objs->GetObjectByID((entry % 2) ? link->to : link->from);
+			if (attached.Lookup(obj, value))
+				next[entry] = reinterpret_cast<INT_PTR>(value);
+			attached.SetAt(obj, reinterpret_cast<void*>(entry));
+		}
+	}
 
-				name2 = _T("");
-				if (link->from == parent->GetName())
-					name2 = link->to;
-				else if (link->to == parent->GetName())
-				{
-					fromtype = link->totype;
-					totype = link->fromtype;
-					name2 = link->from;
-				}
+	// Objects already moved. They are marked when queued, so
+	// that no object is moved twice.
+	CMapPtrToPtr visited;
+	CObArray queue;
+	INT_PTR size = moved.GetSize();
+	for (INT_PTR t = 0; t < size; t++)
+	{
+		visited.SetAt(moved[t], NULL);
+		queue.Add(moved[t]);
+	}
 
-				if (name2.GetLength())
-				{
-					CFlowchartEntity* obj = GetNamedObject(name2);
-					if (obj && obj != filter && !obj->GetMoved())
-					{
-						CPoint source;
-						CPoint target;
+	for (INT_PTR head = 0; head < queue.GetSize(); head++)
+	{
+		CFlowchartEntity* parent = static_cast<CFlowchartEntity*>(queue[head]);
+		if (!attached.Lookup(parent, value))
+			continue;
+
+		for (INT_PTR entry = reinterpret_cast<INT_PTR>(value); entry != -1; entry = next[entry])
+		{
+			CFlowchartLink* link = objs->GetLinkAt(entry / 2);
+			int fromtype = link->fromtype;
+			int totype = link->totype;
+			ULONGLONG id = link->to;
+			if (entry % 2)
+			{
+				fromtype = link->totype;
+				totype = link->fromtype;
+				id = link->from;
+			}
 
-						source = parent->GetLinkPosition(fromtype);
-						target = obj->GetLinkPosition(totype);
+			CFlowchartEntity* obj = CFlowchartEntity::Cast(objs->GetObjectByID(id));
 
-						moved = FALSE;
-						switch (fromtype)
-						{
-						case LINK_LEFT:
-							sizediff = source.y - target.y;
-							obj->MoveRect(0, source.y - target.y);
-							break;
-						case LINK_RIGHT:
-							sizediff = source.y - target.y;
-							obj->MoveRect(0, source.y - target.y);
-							break;
-						case LINK_TOP:
-							sizediff = source.x - target.x;
-							obj->MoveRect(source.x - target.x, 0);
-							break;
-						case LINK_BOTTOM:
-							sizediff = source.x - target.x;
-							obj->MoveRect(source.x - target.x, 0);
-							break;
-						default:
-							switch (totype)
-							{
-							case LINK_LEFT:
-								sizediff = source.y - target.y;
-								obj->MoveRect(0, source.y - target.y);
-								break;
-							case LINK_RIGHT:
-								sizediff = source.y - target.y;
-								obj->MoveRect(0, source.y - target.y);
-								break;
-							case LINK_TOP:
-								sizediff = source.x - target.x;
-								obj->MoveRect(source.x - target.x, 0);
-								break;
-							case LINK_BOTTOM:
-								sizediff = source.x - target.x;
-								obj->MoveRect(source.x - target.x, 0);
-								break;
-							}
-							break;
-						}
+			if (obj && !visited.Lookup(obj, value))
+			{
+				CPoint source = parent->GetLinkPosition(fromtype);
+				CPoint target = obj->GetLinkPosition(totype);
 
-						if (sizediff)
-							AdjustLinkedObjects(obj, parent);
+				// The side of the parent decides the direction,
+				// unless the link is free there
+				int type = fromtype;
+				if (type != LINK_LEFT && type != LINK_RIGHT && type != LINK_TOP && type != LINK_BOTTOM)
+					type = totype;
 
-					}
+				double sizediff = 0.0;
+				switch (type)
+				{
+				case LINK_LEFT:
+				case LINK_RIGHT:
+					sizediff = source.y - target.y;
+					obj->MoveRect(0, sizediff);
+					break;
+				case LINK_TOP:
+				case LINK_BOTTOM:
+					sizediff = source.x - target.x;
+					obj->MoveRect(sizediff, 0);
+					break;
+				}
+
+				if (sizediff)
+				{
+					visited.SetAt(obj, NULL);
+					queue.Add(obj);
 				}
 			}
 		}
 	}
 
+	return static_cast<int>(queue.GetSize() - size);
+
 }
 
-CFlowchartEntity* CFlowchartEditor::GetNamedObject(const CString& name) const
+CFlowchartEntity* CFlowchartEditor::GetNamedObject(ULONGLONG id) const
 /* ============================================================
 	Function :		CFlowchartEditor::GetNamedObject
-	Description :	Returns the object with the name attribute
-					name.
+	Description :	Returns the object with the id "id".
 
 	Return :		CFlowchartEntity*	-	The object, or NULL
 											if not found.
-	Parameters :	const CString& name	-	The name of the
+	Parameters :	ULONGLONG id		-	The id of the
 											object to find.
 
-	Usage :			Call to get the object with the name name,
+	Usage :			Call to get the object with the id "id",
 					if it exists.
 
    ============================================================*/
 {
 
 	CDiagramEntity* result = NULL;
+	if (GetDiagramEntityContainer())
+		result = GetDiagramEntityContainer()->GetObjectByID(id);
 
-	INT_PTR count = GetObjectCount();
-	CDiagramEntity* obj;
-	for (int t = 0; t < count; t++)
-	{
-		obj = GetObject(t);
-		if (obj && obj->GetName() == name)
-			result = obj;
-	}
-
-	return dynamic_cast<CFlowchartEntity*>(result);
+	return CFlowchartEntity::Cast(result);
 
 }
 
@@ -698,15 +604,9 @@ void CFlowchartEditor::OnLink()
 			if (objs->CreateLink(primary, secondary, _T("")))
 			{
 				// Move other objects already linked to the secondary
-				AdjustLinkedObjects(primary);
-
-				INT_PTR max = GetObjectCount();
-				for (int t = 0; t < max; t++)
-				{
-					CFlowchartEntity* obj = dynamic_cast<CFlowchartEntity*>(GetObject(t));
-					if (obj)
-						obj->SetMoved(FALSE);
-				}
+				CObArray moved;
+				moved.Add(primary);
+				AdjustLinkedObjects(moved);
 
 				RedrawWindow();
 			}
@@ -775,7 +675,7 @@ void CFlowchartEditor::OnLinkDirection()
 			{
 				GetDiagramEntityContainer()->Snapshot();
 
-				CString saved = link->from;
+				ULONGLONG saved = link->from;
 				link->from = link->to;
 				link->to = saved;
 
@@ -880,3 +780,36 @@ BOOL CFlowchartEditor::IsLinked()
 	return result;
 
 }
+
+void CFlowchartEditor::AutoLayout()
+/* ============================================================
+	Function :		CFlowchartEditor::AutoLayout
+	Description :	Arranges the flowchart in layers.
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Call to tidy up the flowchart. Can be
+					undone. The virtual size is grown if the
+					result does not fit.
+
+   ============================================================*/
+{
+
+	CFlowchartEntityContainer* objs = dynamic_cast<CFlowchartEntityContainer *>(GetDiagramEntityContainer());
+	if (objs && objs->GetSize())
+	{
+		objs->Snapshot();
+		objs->AutoLayout();
+
+		const CBoundsArray* bounds = objs->GetBounds();
+		CSize size = GetVirtualSize();
+		CSize needed(round(bounds->GetMax(BOUNDS_RIGHT, 0)) + 1, round(bounds->GetMax(BOUNDS_BOTTOM, 0)) + 1);
+		if (needed.cx > size.cx || needed.cy > size.cy)
+			SetVirtualSize(CSize(max(size.cx, needed.cx), max(size.cy, needed.cy)));
+
+		SetModified(TRUE);
+		RedrawWindow();
+	}
+
+}
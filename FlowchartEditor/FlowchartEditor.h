@@ -15,6 +15,7 @@ public:
 	// Operations
 	BOOL CanLink();
 	BOOL IsLinked();
+	void AutoLayout();
 	void ExportEMF(const CString& filename);
 
 protected:
@@ -36,10 +37,10 @@ public:
 
 private:
 	// Private helpers
-	void	ModifyLinkedPositions();
-	void	AdjustLinkedObjects(CFlowchartEntity* parent, CFlowchartEntity* filter = NULL);
+	int		ModifyLinkedPositions();
+	int		AdjustLinkedObjects(const CObArray& moved);
 
-	CFlowchartEntity*	GetNamedObject(const CString& name) const;
+	CFlowchartEntity*	GetNamedObject(ULONGLONG id) const;
 
 };
 
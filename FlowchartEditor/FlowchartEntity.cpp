@@ -67,6 +67,7 @@ CFlowchartEntity::CFlowchartEntity()
 	// Setting fixed size
 	SetConstraints(CSize(128, 64), CSize(128, 64));
 	SetType(_T("flowchart_entity"));
+	AddKind(KIND_FLOWCHART_ENTITY);
 
 	SetPropertyDialog(&m_dlg, CPropertyDialog::IDD);
 
@@ -205,6 +206,30 @@ CDiagramEntity* CFlowchartEntity::CreateFromString(const CString& str)
 
 }
 
+CFlowchartEntity* CFlowchartEntity::Cast(CDiagramEntity* obj)
+/* ============================================================
+	Function :		CFlowchartEntity::Cast
+	Description :	Casts "obj" to a "CFlowchartEntity" pointer,
+					using the kind tag instead of RTTI.
+	Access :		Public
+
+	Return :		CFlowchartEntity*	-	"obj", or "NULL" if "obj" is
+						not a flowchart entity.
+	Parameters :	CDiagramEntity* obj	-	Object to cast.
+
+	Usage :			Use instead of "dynamic_cast" in loops over
+					the container data.
+
+   ============================================================*/
+{
+
+	if (obj && obj->IsKind(KIND_FLOWCHART_ENTITY))
+		return static_cast<CFlowchartEntity*>(obj);
+
+	return NULL;
+
+}
+
 void CFlowchartEntity::DrawSelectionMarkers(CDC* dc, CRect rect) const
 /* ============================================================
 	Function :		CFlowchartEntity::DrawSelectionMarkers
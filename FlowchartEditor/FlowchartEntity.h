@@ -5,8 +5,11 @@
 #include "../NetworkEditor/PropertyDialog.h"
 #include "FlowchartLink.h"
 
+#define KIND_FLOWCHART_ENTITY	0x00010000
+
 class CFlowchartEntity : public CDiagramEntity
 {
+	DECLARE_ENTITY_SIZE(CFlowchartEntity)
 
 public:
 	// Construction/initialization/destruction
@@ -14,6 +17,7 @@ public:
 	virtual	~CFlowchartEntity();
 	virtual CDiagramEntity* Clone();
 	static	CDiagramEntity* CreateFromString(const CString& str);
+	static	CFlowchartEntity* Cast(CDiagramEntity* obj);
 
 	// Overrides
 	virtual int		GetHitCode(CPoint point) const;
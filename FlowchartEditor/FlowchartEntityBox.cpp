@@ -21,6 +21,7 @@
 
 #include "stdafx.h"
 #include "FlowchartEntityBox.h"
+#include "../DiagramEditor/DiagramRenderer.h"
 
 #ifdef _DEBUG
 #define new DEBUG_NEW
@@ -64,20 +65,19 @@ CFlowchartEntityBox::~CFlowchartEntityBox()
 {
 }
 
-void CFlowchartEntityBox::Draw(CDC* dc, CRect rect)
+void CFlowchartEntityBox::Render(CDiagramRenderer* renderer, CRect rect)
 /* ============================================================
-	Function :		CFlowchartEntityBox::Draw
+	Function :		CFlowchartEntityBox::Render
 	Description :	Draws the object.
 
 	Return :		void
-	Parameters :	CDC* dc		-	The CDC to draw to.
-					CRect rect	-	The real rectangle of the
-									object.
+	Parameters :	CDiagramRenderer* renderer	-	The renderer to
+													draw with.
+					CRect rect					-	The real rectangle
+													of the object.
 
-	Usage :			The function should clean up all selected
-					objects. Note that the CDC is a memory CDC,
-					so creating a memory CDC in this function
-					will probably not speed up the function.
+	Usage :			Called from "Draw", or to draw to a memory
+					buffer.
 
    ============================================================*/
 {
@@ -85,20 +85,14 @@ void CFlowchartEntityBox::Draw(CDC* dc, CRect rect)
 	int cut = round((double)GetMarkerSize().cx * GetZoom());
 	CRect r(rect.left + cut, rect.top + cut / 2, rect.right - cut, rect.bottom - cut / 2);
 
-	dc->SelectStockObject(BLACK_PEN);
-	dc->SelectStockObject(WHITE_BRUSH);
-	int mode = dc->SetBkMode(TRANSPARENT);
+	renderer->SetPen(PS_SOLID, 0, RGB(0, 0, 0));
+	renderer->SetBrush(RGB(255, 255, 255));
 
-	dc->Rectangle(rect);
+	renderer->Rectangle(rect);
 
-	CFont font;
-	font.CreateFont(-round(12.0 * GetZoom()), 0, 0, 0, FW_NORMAL, 0, 0, 0, 0, 0, 0, 0, 0, _T("Courier New"));
-	dc->SelectObject(&font);
-
-	dc->DrawText(GetTitle(), r, DT_NOPREFIX | DT_WORDBREAK | DT_CENTER);
-
-	dc->SelectStockObject(DEFAULT_GUI_FONT);
-	dc->SetBkMode(mode);
+	renderer->SetFont(_T("Courier New"), -round(12.0 * GetZoom()));
+	renderer->SetBkMode(TRANSPARENT);
+	renderer->DrawText(GetTitle(), r, DT_NOPREFIX | DT_WORDBREAK | DT_CENTER);
 
 }
 
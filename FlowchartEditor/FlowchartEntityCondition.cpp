@@ -23,6 +23,7 @@
    ========================================================================*/
 #include "stdafx.h"
 #include "FlowchartEntityCondition.h"
+#include "../DiagramEditor/DiagramRenderer.h"
 
 #ifdef _DEBUG
 #define new DEBUG_NEW
@@ -67,26 +68,24 @@ CFlowchartEntityCondition::~CFlowchartEntityCondition()
 {
 }
 
-void CFlowchartEntityCondition::Draw(CDC* dc, CRect rect)
+void CFlowchartEntityCondition::Render(CDiagramRenderer* renderer, CRect rect)
 /* ============================================================
-	Function :		CFlowchartEntityCondition::Draw
+	Function :		CFlowchartEntityCondition::Render
 	Description :	Draws the object.
 
 	Return :		void
-	Parameters :	CDC* dc		-	The CDC to draw to.
-					CRect rect	-	The real rectangle of the
-									object.
+	Parameters :	CDiagramRenderer* renderer	-	The renderer to
+													draw with.
+					CRect rect					-	The real rectangle
+													of the object.
 
-	Usage :			The function should clean up all selected
-					objects. Note that the CDC is a memory CDC,
-					so creating a memory CDC in this function
-					will probably not speed up the function.
+	Usage :
 
    ============================================================*/
 {
 
-	dc->SelectStockObject(BLACK_PEN);
-	dc->SelectStockObject(WHITE_BRUSH);
+	renderer->SetPen(PS_SOLID, 0, RGB(0, 0, 0));
+	renderer->SetBrush(RGB(255, 255, 255));
 
 	// The polygon
 	CPoint pt[4];
@@ -103,22 +102,17 @@ void CFlowchartEntityCondition::Draw(CDC* dc, CRect rect)
 	pt[3].x = rect.left + ((rect.right - rect.left) / 2);
 	pt[3].y = rect.bottom;
 
-	dc->Polygon(pt, 4);
+	renderer->Polygon(pt, 4);
 
 	// The text
 	int qwidth = rect.Width() / 4;
 	int qheight = rect.Height() / 4;
 	CRect r(rect.left + qwidth, rect.top + qheight, rect.right - qwidth, rect.bottom - qheight);
 
-	CFont font;
-	font.CreateFont(-round(12.0 * GetZoom()), 0, 0, 0, FW_NORMAL, 0, 0, 0, 0, 0, 0, 0, 0, _T("Courier New"));
-	dc->SelectObject(&font);
-	int mode = dc->SetBkMode(TRANSPARENT);
-
-	dc->DrawText(GetTitle(), r, DT_NOPREFIX | DT_WORDBREAK | DT_CENTER);
-	dc->SelectStockObject(DEFAULT_GUI_FONT);
+	renderer->SetFont(_T("Courier New"), -round(12.0 * GetZoom()));
+	renderer->SetBkMode(TRANSPARENT);
 
-	dc->SetBkMode(mode);
+	renderer->DrawText(GetTitle(), r, DT_NOPREFIX | DT_WORDBREAK | DT_CENTER);
 }
 
 CDiagramEntity* CFlowchartEntityCondition::Clone()
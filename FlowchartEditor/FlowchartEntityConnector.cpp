@@ -25,6 +25,7 @@
 
 #include "stdafx.h"
 #include "FlowchartEntityConnector.h"
+#include "../DiagramEditor/DiagramRenderer.h"
 
 #ifdef _DEBUG
 #define new DEBUG_NEW
@@ -69,40 +70,33 @@ CFlowchartEntityConnector::~CFlowchartEntityConnector()
 {
 }
 
-void CFlowchartEntityConnector::Draw(CDC* dc, CRect rect)
+void CFlowchartEntityConnector::Render(CDiagramRenderer* renderer, CRect rect)
 /* ============================================================
-	Function :		CFlowchartEntityConnector::Draw
+	Function :		CFlowchartEntityConnector::Render
 	Description :	Draws the object.
 
 	Return :		void
-	Parameters :	CDC* dc		-	The CDC to draw to.
-					CRect rect	-	The real rectangle of the
-									object.
+	Parameters :	CDiagramRenderer* renderer	-	The renderer to
+													draw with.
+					CRect rect					-	The real rectangle
+													of the object.
 
-	Usage :			The function should clean up all selected
-					objects. Note that the CDC is a memory CDC,
-					so creating a memory CDC in this function
-					will probably not speed up the function.
+	Usage :
 
    ============================================================*/
 {
 
-	dc->SelectStockObject(BLACK_PEN);
-	dc->SelectStockObject(WHITE_BRUSH);
+	renderer->SetPen(PS_SOLID, 0, RGB(0, 0, 0));
+	renderer->SetBrush(RGB(255, 255, 255));
 
 	// The circle
-	dc->Ellipse(rect);
+	renderer->Ellipse(rect);
 
 	// The text
-	CFont font;
-	font.CreateFont(-round(12.0 * GetZoom()), 0, 0, 0, FW_NORMAL, 0, 0, 0, 0, 0, 0, 0, 0, _T("Courier New"));
-	dc->SelectObject(&font);
-	int mode = dc->SetBkMode(TRANSPARENT);
-
-	dc->DrawText(GetTitle(), rect, DT_NOPREFIX | DT_SINGLELINE | DT_VCENTER | DT_CENTER);
-	dc->SelectStockObject(DEFAULT_GUI_FONT);
+	renderer->SetFont(_T("Courier New"), -round(12.0 * GetZoom()));
+	renderer->SetBkMode(TRANSPARENT);
 
-	dc->SetBkMode(mode);
+	renderer->DrawText(GetTitle(), rect, DT_NOPREFIX | DT_SINGLELINE | DT_VCENTER | DT_CENTER);
 }
 
 CDiagramEntity* CFlowchartEntityConnector::Clone()
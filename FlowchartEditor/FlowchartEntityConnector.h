@@ -5,6 +5,7 @@
 
 class CFlowchartEntityConnector : public CFlowchartEntity
 {
+	DECLARE_ENTITY_SIZE(CFlowchartEntityConnector)
 
 public:
 // Construction/initialization/destruction
@@ -14,7 +15,7 @@ public:
 	static	CDiagramEntity* CreateFromString( const CString& str );
 
 // Overrides
-	virtual void Draw( CDC* dc, CRect rect );
+	virtual void Render(CDiagramRenderer* renderer, CRect rect);
 	virtual BOOL BodyInRect( CRect rect ) const;
 	virtual int	 GetHitCode( CPoint point ) const;
 
@@ -19,6 +19,9 @@
    ========================================================================*/
 #include "stdafx.h"
 #include "FlowchartEntityContainer.h"
+#include "../DiagramEditor/DiagramTrace.h"
+#include "../DiagramEditor/DiagramRenderer.h"
+#include "../DiagramEditor/LayeredLayout.h"
 #include <math.h>
 
 CFlowchartEntityContainer::CFlowchartEntityContainer()
@@ -79,8 +82,8 @@ BOOL CFlowchartEntityContainer::CreateLink(CFlowchartEntity* from, CFlowchartEnt
 
 		CFlowchartLink* link = new CFlowchartLink;
 
-		link->from = from->GetName();
-		link->to = to->GetName();
+		link->from = from->GetID();
+		link->to = to->GetID();
 		link->fromtype = fromtype;
 		link->totype = totype;
 		link->title = title;
@@ -115,8 +118,8 @@ BOOL CFlowchartEntityContainer::HasLinks(CFlowchartEntity* obj1, CFlowchartEntit
 {
 
 	BOOL result = FALSE;
-	CString n1 = obj1->GetName();
-	CString n2 = obj2->GetName();
+	ULONGLONG n1 = obj1->GetID();
+	ULONGLONG n2 = obj2->GetID();
 
 	int	fromtype = 0;
 	int	totype = 0;
@@ -509,6 +512,575 @@ BOOL CFlowchartEntityContainer::FindClosestLink(CFlowchartEntity* obj1, CFlowcha
 
 }
 
+void CFlowchartEntityContainer::AutoLayout()
+/* ============================================================
+	Function :		CFlowchartEntityContainer::AutoLayout
+	Description :	Arranges the objects in layers, following
+					the direction of the links.
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Call to tidy up a flowchart. Links are
+					routed when they are drawn, so only the
+					link points are updated to the closest
+					pair after the objects have been moved.
+
+   ============================================================*/
+{
+
+	INT_PTR count = GetSize();
+	if (count == 0)
+		return;
+
+	CLayeredLayout layout;
+	CMapPtrToPtr indices;
+	CObArray nodes;
+	double left = 0;
+	double top = 0;
+	for (INT_PTR t = 0; t < count; t++)
+	{
+		CFlowchartEntity* obj = CFlowchartEntity::Cast(GetAt(t));
+		if (obj)
+		{
+			CRect rect = obj->GetRect();
+			rect.NormalizeRect();
+			if (nodes.GetSize() == 0 || rect.left < left)
+				left = rect.left;
+			if (nodes.GetSize() == 0 || rect.top < top)
+				top = rect.top;
+
+			indices.SetAt(obj, reinterpret_cast<void*>(nodes.Add(obj)));
+			layout.AddNode(rect.Width(), rect.Height());
+		}
+	}
+
+	INT_PTR max = m_links.GetSize();
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		CFlowchartLink* link = static_cast<CFlowchartLink*>(m_links.GetAt(t));
+		void* from = NULL;
+		void* to = NULL;
+		if (indices.Lookup(GetObjectByID(link->from), from) && indices.Lookup(GetObjectByID(link->to), to))
+			layout.AddEdge(static_cast<int>(reinterpret_cast<INT_PTR>(from)), static_cast<int>(reinterpret_cast<INT_PTR>(to)));
+	}
+
+	layout.Layout();
+
+	INT_PTR size = nodes.GetSize();
+	for (INT_PTR t = 0; t < size; t++)
+	{
+		CFlowchartEntity* obj = static_cast<CFlowchartEntity*>(nodes[t]);
+		CPoint pos = layout.GetNodePosition(static_cast<int>(t));
+		obj->MoveRect(left + pos.x - min(obj->GetLeft(), obj->GetRight()), top + pos.y - min(obj->GetTop(), obj->GetBottom()));
+	}
+
+	// Pick new link points for the new positions
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		CFlowchartLink* link = static_cast<CFlowchartLink*>(m_links.GetAt(t));
+		void* from = NULL;
+		void* to = NULL;
+		if (indices.Lookup(GetObjectByID(link->from), from) && indices.Lookup(GetObjectByID(link->to), to))
+		{
+			int fromtype = 0;
+			int totype = 0;
+			if (FindClosestLink(static_cast<CFlowchartEntity*>(nodes[reinterpret_cast<INT_PTR>(from)]), static_cast<CFlowchartEntity*>(nodes[reinterpret_cast<INT_PTR>(to)]), fromtype, totype))
+			{
+				link->fromtype = fromtype;
+				link->totype = totype;
+			}
+		}
+	}
+
+}
+
+void CFlowchartEntityContainer::RouteLinks()
+/* ============================================================
+	Function :		CFlowchartEntityContainer::RouteLinks
+	Description :	Brings the link routes up to date.
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Call before drawing the links. The routes
+					go around the objects, and are cached in
+					the router. Only the links attached to an
+					object that moved, and the links running
+					through or next to the old or new position
+					of the object, are routed again, so this
+					is cheap while dragging. The router is
+					rebuilt when objects or links are added,
+					removed or replaced.
+
+   ============================================================*/
+{
+
+	CObArray* objs = GetData();
+	INT_PTR count = objs->GetSize();
+	INT_PTR max = m_links.GetSize();
+	void* ptr = NULL;
+
+	BOOL rebuild = (count != m_routedObjs.GetSize() || max != m_routedLinks.GetSize() ||
+		(count && memcmp(objs->GetData(), m_routedObjs.GetData(), count * sizeof(CObject*)) != 0) ||
+		(max && memcmp(m_links.GetData(), m_routedLinks.GetData(), max * sizeof(CObject*)) != 0));
+
+	// An object can be replaced by a new one at the same address
+	for (INT_PTR t = 0; t < max && !rebuild; t++)
+	{
+		CFlowchartLink* link = static_cast<CFlowchartLink*>(m_links.GetAt(t));
+		if ((link->from != LINK_ID_NONE && !GetRoutedIndex(link->from, ptr)) ||
+			(link->to != LINK_ID_NONE && !GetRoutedIndex(link->to, ptr)))
+			rebuild = TRUE;
+	}
+
+	if (rebuild)
+	{
+		m_router.Clear();
+		m_routedObjs.Copy(*objs);
+		m_routedLinks.Copy(m_links);
+		m_routedObjects.RemoveAll();
+		m_routedIndex.RemoveAll();
+		m_routedIDs.SetSize(count);
+		m_obstacles.SetSize(count);
+
+		// Boxes are obstacles, linkable lines are not
+		for (INT_PTR t = 0; t < count; t++)
+		{
+			m_obstacles[t] = -1;
+			m_routedIDs[t] = LINK_ID_NONE;
+			CFlowchartEntity* obj = CFlowchartEntity::Cast(static_cast<CDiagramEntity*>(objs->GetAt(t)));
+			if (obj)
+			{
+				m_routedObjects.SetAt(obj, reinterpret_cast<void*>(t));
+				m_routedIDs[t] = obj->GetID();
+				if (obj->GetType() != _T("flowchart_arrow"))
+					m_obstacles[t] = m_router.AddObstacle(obj->GetRect());
+			}
+		}
+
+		for (INT_PTR t = 0; t < max; t++)
+		{
+			CFlowchartLink* link = static_cast<CFlowchartLink*>(m_links.GetAt(t));
+			int from = -1;
+			int to = -1;
+			if (GetRoutedIndex(link->from, ptr))
+				from = m_obstacles[reinterpret_cast<INT_PTR>(ptr)];
+			if (GetRoutedIndex(link->to, ptr))
+				to = m_obstacles[reinterpret_cast<INT_PTR>(ptr)];
+			m_routedIndex.SetAt(link, reinterpret_cast<void*>(static_cast<INT_PTR>(m_router.AddLink(from, to))));
+		}
+	}
+
+	// Unchanged obstacles and link ends are skipped by the router
+	for (INT_PTR t = 0; t < count; t++)
+	{
+		if (m_obstacles[t] >= 0)
+			m_router.SetObstacle(m_obstacles[t], static_cast<CDiagramEntity*>(objs->GetAt(t))->GetRect());
+	}
+
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		CFlowchartLink* link = static_cast<CFlowchartLink*>(m_links.GetAt(t));
+		void* from = NULL;
+		void* to = NULL;
+		if (GetRoutedIndex(link->from, from) && GetRoutedIndex(link->to, to))
+		{
+			CFlowchartEntity* fromObj = static_cast<CFlowchartEntity*>(objs->GetAt(reinterpret_cast<INT_PTR>(from)));
+			CFlowchartEntity* toObj = static_cast<CFlowchartEntity*>(objs->GetAt(reinterpret_cast<INT_PTR>(to)));
+			m_router.SetLinkEnds(static_cast<int>(t),
+				fromObj->GetLinkPosition(link->fromtype), link->fromtype & LINK_ALL,
+				toObj->GetLinkPosition(link->totype), link->totype & LINK_ALL);
+		}
+	}
+
+	m_router.Update();
+
+}
+
+BOOL CFlowchartEntityContainer::GetRoutedIndex(ULONGLONG id, void*& index) const
+/* ============================================================
+	Function :		CFlowchartEntityContainer::GetRoutedIndex
+	Description :	Gets the index of a routed object.
+
+	Return :		BOOL			-	"FALSE" if there is no
+										object with the id, or
+										it was not routed.
+	Parameters :	ULONGLONG id	-	Id of the object.
+					void*& index	-	Gets the index of the
+										object in the data.
+
+	Usage :			Internal function, used by "RouteLinks"
+					and "PrepareRender". An object replaced
+					by a new one at the same address is not
+					found, as the id is checked as well.
+
+   ============================================================*/
+{
+
+	CDiagramEntity* obj = GetObjectByID(id);
+	return obj && m_routedObjects.Lookup(obj, index) && m_routedIDs[reinterpret_cast<INT_PTR>(index)] == id;
+
+}
+
+INT_PTR CFlowchartEntityContainer::GetLinkRoute(CFlowchartLink* link, CArray< CPoint, CPoint >& points)
+/* ============================================================
+	Function :		CFlowchartEntityContainer::GetLinkRoute
+	Description :	Gets the route of a link.
+
+	Return :		INT_PTR					-	Number of points,
+												0 if the link has
+												no route.
+	Parameters :	CFlowchartLink* link	-	Link to get the
+												route for.
+					CArray< CPoint, CPoint >& points	-	Gets
+												the corners of the
+												route, from the
+												"from" object to
+												the "to" object.
+
+	Usage :			Call "RouteLinks" first. Links added since
+					have no route.
+
+   ============================================================*/
+{
+
+	void* index = NULL;
+	if (m_routedIndex.Lookup(link, index))
+		return m_router.GetRoute(static_cast<int>(reinterpret_cast<INT_PTR>(index)), points);
+
+	points.RemoveAll();
+	return 0;
+
+}
+
+void CFlowchartEntityContainer::RenderLink(CDiagramRenderer* renderer, CFlowchartLink* link, CFlowchartEntity* obj, CFlowchartEntity* to, double zoom, CSize markerSize)
+/* ============================================================
+	Function :		CFlowchartEntityContainer::RenderLink
+	Description :	Draws a link with its arrow head and title.
+
+	Return :		void
+	Parameters :	CDiagramRenderer* renderer	-	Renderer to
+													draw with.
+					CFlowchartLink* link		-	Link to draw.
+					CFlowchartEntity* obj		-	Object the
+													link starts at.
+					CFlowchartEntity* to		-	Object the
+													link ends at.
+					double zoom					-	Zoom level.
+					CSize markerSize			-	Marker size of
+													the editor, sets
+													the arrow size.
+
+	Usage :			Call "RouteLinks" first. The link follows
+					its route, with the arrow head following
+					the last segment and the title at the
+					longest segment.
+
+   ============================================================*/
+{
+
+	CArray< CPoint, CPoint > route;
+	int seg = round((double)markerSize.cx * zoom / 2);
+	CPoint pts[3];
+
+	renderer->SetPen(PS_SOLID, 0, RGB(0, 0, 0));
+	renderer->SetBrush(RGB(0, 0, 0));
+
+	BOOL drawArrow = TRUE;
+	CPoint start;
+	CPoint end;
+	start = obj->GetLinkPosition(link->fromtype);
+	end = to->GetLinkPosition(link->totype);
+
+	if (GetLinkRoute(link, route) < 2)
+	{
+		route.RemoveAll();
+		route.Add(start);
+		route.Add(end);
+	}
+
+	INT_PTR points = route.GetSize();
+	for (INT_PTR n = 0; n < points; n++)
+	{
+		route[n].x = round((double)route[n].x * zoom);
+		route[n].y = round((double)route[n].y * zoom);
+	}
+
+	// The arrow head follows the last segment
+	start = route[points - 2];
+	end = route[points - 1];
+	int arrow = link->fromtype;
+	if (start.y == end.y && start.x != end.x)
+		arrow = start.x < end.x ? LINK_RIGHT : LINK_LEFT;
+	else if (start.x == end.x && start.y != end.y)
+		arrow = start.y < end.y ? LINK_BOTTOM : LINK_TOP;
+
+	switch (arrow)
+	{
+	case LINK_RIGHT:
+		pts[1].x = end.x - seg * 2;
+		pts[1].y = end.y - seg;
+		pts[2].x = end.x - seg * 2;
+		pts[2].y = end.y + seg;
+		break;
+
+	case LINK_LEFT:
+		pts[1].x = end.x + seg * 2;
+		pts[1].y = end.y - seg;
+		pts[2].x = end.x + seg * 2;
+		pts[2].y = end.y + seg;
+		break;
+
+	case LINK_TOP:
+		pts[1].x = end.x - seg;
+		pts[1].y = end.y + seg * 2;
+		pts[2].x = end.x + seg;
+		pts[2].y = end.y + seg * 2;
+		break;
+
+	case LINK_BOTTOM:
+		pts[1].x = end.x - seg;
+		pts[1].y = end.y - seg * 2;
+		pts[2].x = end.x + seg;
+		pts[2].y = end.y - seg * 2;
+
+		break;
+
+	default:
+	{
+		switch (link->totype)
+		{
+		case LINK_RIGHT:
+			pts[1].x = end.x + seg * 2;
+			pts[1].y = end.y - seg;
+			pts[2].x = end.x + seg * 2;
+			pts[2].y = end.y + seg;
+			break;
+
+		case LINK_LEFT:
+			pts[1].x = end.x - seg * 2;
+			pts[1].y = end.y - seg;
+			pts[2].x = end.x - seg * 2;
+			pts[2].y = end.y + seg;
+			break;
+
+		case LINK_TOP:
+			pts[1].x = end.x - seg;
+			pts[1].y = end.y - seg * 2;
+			pts[2].x = end.x + seg;
+			pts[2].y = end.y - seg * 2;
+			break;
+
+		case LINK_BOTTOM:
+			pts[1].x = end.x - seg;
+			pts[1].y = end.y + seg * 2;
+			pts[2].x = end.x + seg;
+			pts[2].y = end.y + seg * 2;
+			break;
+
+		default:
+			drawArrow = FALSE;
+			break;
+		}
+	}
+	break;
+	}
+
+	renderer->Polyline(route.GetData(), static_cast<int>(points));
+
+	pts[0].x = end.x;
+	pts[0].y = end.y;
+
+	if (drawArrow)
+		renderer->Polygon(pts, 3);
+
+	CString str = link->title;
+	if (str.GetLength())
+	{
+		// The title goes at the longest segment
+		for (INT_PTR n = 1; n < points; n++)
+		{
+			if (abs(route[n].x - route[n - 1].x) + abs(route[n].y - route[n - 1].y) > abs(end.x - start.x) + abs(end.y - start.y))
+			{
+				start = route[n - 1];
+				end = route[n];
+			}
+		}
+
+		renderer->SetFont(_T("Courier New"), -round(12.0 * zoom));
+		renderer->SetBkMode(TRANSPARENT);
+
+		CRect rect(start, end);
+		rect.NormalizeRect();
+		int cy = round(14.0 * zoom);
+		int cut = round((double)markerSize.cx * zoom / 2);
+		CRect r(rect.right - cut, rect.top, rect.right - (rect.Width() + cut), rect.bottom);
+		if (rect.top == rect.bottom)
+		{
+			CRect r(rect.left, rect.top - (cy + cut), rect.right, rect.bottom);
+			r.NormalizeRect();
+			renderer->DrawText(str, r, DT_NOPREFIX | DT_SINGLELINE | DT_VCENTER | DT_CENTER);
+		}
+		else
+		{
+			CRect r(rect.right - cut, rect.top, rect.right - (cy * str.GetLength() + cut), rect.bottom);
+			r.NormalizeRect();
+			renderer->DrawText(str, r, DT_NOPREFIX | DT_SINGLELINE | DT_VCENTER | DT_RIGHT);
+		}
+
+	}
+
+
+}
+
+void CFlowchartEntityContainer::PrepareRender(double zoom)
+/* ============================================================
+	Function :		CFlowchartEntityContainer::PrepareRender
+	Description :	Routes the links and finds the area each
+					of them covers.
+
+	Return :		void
+	Parameters :	double zoom	-	Zoom level.
+
+	Usage :			Called before "RenderRect". The links are
+					sorted by the object they start at, as they
+					are drawn just before it. Links with a
+					missing end are skipped.
+
+   ============================================================*/
+{
+
+	CDiagramEntityContainer::PrepareRender(zoom);
+	RouteLinks();
+
+	CObArray* objs = GetData();
+	INT_PTR count = objs->GetSize();
+	INT_PTR max = m_links.GetSize();
+
+	// Count the links starting at each object
+	CDWordArray first;
+	CDWordArray from;
+	CDWordArray to;
+	first.SetSize(count + 1);
+	from.SetSize(max);
+	to.SetSize(max);
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		CFlowchartLink* link = static_cast<CFlowchartLink*>(m_links.GetAt(t));
+		void* start = NULL;
+		void* end = NULL;
+		if (GetRoutedIndex(link->from, start) && GetRoutedIndex(link->to, end))
+		{
+			from[t] = static_cast<DWORD>(reinterpret_cast<INT_PTR>(start));
+			to[t] = static_cast<DWORD>(reinterpret_cast<INT_PTR>(end));
+			first[from[t] + 1]++;
+		}
+		else
+			from[t] = static_cast<DWORD>(-1);
+	}
+
+	for (INT_PTR t = 0; t < count; t++)
+		first[t + 1] += first[t];
+
+	INT_PTR total = first[count];
+	m_renderLinks.SetSize(total);
+	m_renderFrom.SetSize(total);
+	m_renderTo.SetSize(total);
+	m_renderBounds.SetSize(total);
+
+	CArray< CPoint, CPoint > route;
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		if (from[t] == static_cast<DWORD>(-1))
+			continue;
+
+		CFlowchartLink* link = static_cast<CFlowchartLink*>(m_links.GetAt(t));
+		INT_PTR pos = first[from[t]]++;
+		m_renderLinks[pos] = link;
+		m_renderFrom[pos] = from[t];
+		m_renderTo[pos] = to[t];
+
+		if (GetLinkRoute(link, route) < 2)
+		{
+			route.RemoveAll();
+			route.Add(static_cast<CFlowchartEntity*>(objs->GetAt(from[t]))->GetLinkPosition(link->fromtype));
+			route.Add(static_cast<CFlowchartEntity*>(objs->GetAt(to[t]))->GetLinkPosition(link->totype));
+		}
+
+		CRect rect(route[0], route[0]);
+		INT_PTR points = route.GetSize();
+		for (INT_PTR n = 1; n < points; n++)
+		{
+			rect.left = min(rect.left, route[n].x);
+			rect.top = min(rect.top, route[n].y);
+			rect.right = max(rect.right, route[n].x);
+			rect.bottom = max(rect.bottom, route[n].y);
+		}
+
+		// The arrow head, and the title beside the longest segment
+		int margin = 8;
+		if (link->title.GetLength())
+			margin += 14 * (link->title.GetLength() + 1);
+
+		m_renderBounds.SetAt(pos, rect.left - margin, rect.top - margin, rect.right + margin, rect.bottom + margin);
+	}
+
+}
+
+void CFlowchartEntityContainer::RenderRect(CDiagramRenderer* renderer, const CRect& rect, double zoom)
+/* ============================================================
+	Function :		CFlowchartEntityContainer::RenderRect
+	Description :	Renders the objects and the links touching
+					a rectangle.
+
+	Return :		void
+	Parameters :	CDiagramRenderer* renderer	-	Renderer to
+													draw with.
+					const CRect& rect			-	Rectangle to
+													draw, zoomed.
+					double zoom					-	Zoom level.
+
+	Usage :			Call "PrepareRender" first. The links of
+					each object are drawn just before the
+					object, as in the editor, even if the
+					object itself is outside the rectangle.
+
+   ============================================================*/
+{
+
+	double left = rect.left / zoom - RENDER_MARGIN;
+	double top = rect.top / zoom - RENDER_MARGIN;
+	double right = rect.right / zoom + RENDER_MARGIN;
+	double bottom = rect.bottom / zoom + RENDER_MARGIN;
+
+	CDWordArray objects;
+	CDWordArray links;
+	INT_PTR count = GetBounds()->GetIntersecting(left, top, right, bottom, objects);
+	INT_PTR max = m_renderBounds.GetIntersecting(left, top, right, bottom, links);
+
+	// Both lists are in drawing order
+	CObArray* objs = GetData();
+	INT_PTR obj = 0;
+	INT_PTR link = 0;
+	while (obj < count || link < max)
+	{
+		if (link < max && (obj == count || m_renderFrom[links[link]] <= objects[obj]))
+		{
+			INT_PTR t = links[link++];
+
+			// Arrows sized for the default editor markers
+			RenderLink(renderer, static_cast<CFlowchartLink*>(m_renderLinks[t]),
+				static_cast<CFlowchartEntity*>(objs->GetAt(m_renderFrom[t])),
+				static_cast<CFlowchartEntity*>(objs->GetAt(m_renderTo[t])),
+				zoom, CSize(8, 8));
+		}
+		else
+			GetAt(objects[obj++])->RenderObject(renderer, zoom);
+	}
+
+}
+
 CFlowchartLink* CFlowchartEntityContainer::GetLinkAt(INT_PTR index)
 /* ============================================================
 	Function :		CFlowchartEntityContainer::GetLinkAt
@@ -553,7 +1125,7 @@ INT_PTR CFlowchartEntityContainer::GetLinks()
 
 }
 
-void CFlowchartEntityContainer::RemoveAt(int index)
+void CFlowchartEntityContainer::RemoveAt(INT_PTR index)
 /* ============================================================
 	Function :		CFlowchartEntityContainer::RemoveAt
 	Description :	Removes the object at index. Will also
@@ -570,14 +1142,14 @@ void CFlowchartEntityContainer::RemoveAt(int index)
 	CDiagramEntity* obj = GetAt(index);
 	if (obj)
 	{
-		CString name = obj->GetName();
+		ULONGLONG id = obj->GetID();
 		CDiagramEntityContainer::RemoveAt(index);
 
 		INT_PTR max = m_links.GetUpperBound();
 		for (INT_PTR t = max; t >= 0; t--)
 		{
 			CFlowchartLink* link = static_cast<CFlowchartLink*>(m_links.GetAt(t));
-			if (link->to == name || link->from == name)
+			if (link->to == id || link->from == id)
 			{
 				delete link;
 				m_links.RemoveAt(t);
@@ -587,6 +1159,59 @@ void CFlowchartEntityContainer::RemoveAt(int index)
 
 }
 
+INT_PTR CFlowchartEntityContainer::RemoveIf(ENTITYPREDICATE predicate, LPVOID data)
+/* ============================================================
+	Function :		CFlowchartEntityContainer::RemoveIf
+	Description :	Removes all objects matching predicate.
+					Will also remove all links refering to
+					the removed objects.
+
+	Return :		INT_PTR						-	The number of
+													removed objects.
+	Parameters :	ENTITYPREDICATE predicate	-	Function
+													returning TRUE
+													for objects to
+													remove.
+					LPVOID data					-	Passed to
+													predicate.
+
+	Usage :			Overridden to remove links as well. Both
+					the object and the link arrays are
+					compacted in a single pass.
+
+   ============================================================*/
+{
+
+	CMapPtrToPtr marked;
+	INT_PTR max = GetSize();
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		CDiagramEntity* obj = GetAt(t);
+		if (predicate(obj, data))
+			marked.SetAt(obj, obj);
+	}
+
+	// The links are resolved while the marked objects still exist
+	if (marked.GetCount())
+	{
+		void* value;
+		max = m_links.GetSize();
+		INT_PTR current = 0;
+		for (INT_PTR t = 0; t < max; t++)
+		{
+			CFlowchartLink* link = static_cast<CFlowchartLink*>(m_links.GetAt(t));
+			if (marked.Lookup(GetObjectByID(link->to), value) || marked.Lookup(GetObjectByID(link->from), value))
+				delete link;
+			else
+				m_links.SetAt(current++, link);
+		}
+		m_links.SetSize(current);
+	}
+
+	return RemoveMarked(marked);
+
+}
+
 void CFlowchartEntityContainer::AddLink(CFlowchartLink* link)
 /* ============================================================
 	Function :		CFlowchartEntityContainer::AddLink
@@ -633,7 +1258,7 @@ CFlowchartLink* CFlowchartEntityContainer::FindLink(CDiagramEntity* obj1, CDiagr
 		for (INT_PTR t = max; t >= 0; t--)
 		{
 			CFlowchartLink* link = static_cast<CFlowchartLink*>(m_links.GetAt(t));
-			if ((link->from == obj1->GetName() && link->to == obj2->GetName()) || (link->from == obj2->GetName() && link->to == obj1->GetName()))
+			if ((link->from == obj1->GetID() && link->to == obj2->GetID()) || (link->from == obj2->GetID() && link->to == obj1->GetID()))
 				result = link;
 		}
 	}
@@ -681,6 +1306,8 @@ void CFlowchartEntityContainer::Undo()
 
    ============================================================*/
 {
+	DIAGRAM_TRACE_SPAN(_T("CFlowchartEntityContainer::Undo"));
+
 	if (m_undoLinks.GetSize())
 	{
 		// Push the current state to the redo links stack
@@ -720,10 +1347,18 @@ void CFlowchartEntityContainer::Snapshot()
 	Parameters :	none
 
 	Usage :			Overridden to save the link state as well.
+					Inside a transaction, only the first call
+					is recorded.
 
    ============================================================*/
 {
-	CDiagramEntityContainer::Snapshot();
+	DIAGRAM_TRACE_SPAN(_T("CFlowchartEntityContainer::Snapshot"));
+
+	if (!BeginSnapshot())
+		return;
+
+	ClearRedo();
+	Push(GetUndo());
 	PushLinks(&m_undoLinks);
 }
 
@@ -771,6 +1406,8 @@ void CFlowchartEntityContainer::Redo()
 
    ============================================================*/
 {
+	DIAGRAM_TRACE_SPAN(_T("CFlowchartEntityContainer::Redo"));
+
 	if (m_redoLinks.GetSize())
 	{
 		// Push the current state to the undo links stack
@@ -870,6 +1507,54 @@ void CFlowchartEntityContainer::ClearRedo()
 	m_redoLinks.RemoveAll();
 }
 
+void CFlowchartEntityContainer::GetMemoryUsage(CDiagramMemoryUsage& usage) const
+/* ============================================================
+	Function :		CFlowchartEntityContainer::GetMemoryUsage
+	Description :	Adds the memory held by the container to
+					"usage".
+
+	Return :		void
+	Parameters :	CDiagramMemoryUsage& usage	-	Breakdown
+													to add to.
+
+	Usage :			Overridden to add the links, and the links
+					of the undo and redo states.
+
+   ============================================================*/
+{
+	CDiagramEntityContainer::GetMemoryUsage(usage);
+
+	INT_PTR max = m_links.GetSize();
+	usage.Add(_T("Links"), _T("Link array"), 1, max * sizeof(CObject*));
+	for (INT_PTR t = 0; t < max; t++)
+		static_cast<CFlowchartLink*>(m_links.GetAt(t))->GetMemoryUsage(usage);
+
+	CString scope = usage.GetScope();
+	const CObArray* stacks[2] = { &m_undoLinks, &m_redoLinks };
+	LPCTSTR scopes[2] = { _T("Undo"), _T("Redo") };
+	for (int s = 0; s < 2; s++)
+	{
+		usage.SetScope(scopes[s]);
+		INT_PTR levels = stacks[s]->GetSize();
+		for (INT_PTR t = 0; t < levels; t++)
+		{
+			CObArray* links = static_cast<CObArray*>(stacks[s]->GetAt(t));
+			INT_PTR count = links->GetSize();
+			usage.Add(_T("Links"), _T("Link array"), 1, sizeof(CObArray) + sizeof(CObject*) + count * sizeof(CObject*));
+			for (INT_PTR i = 0; i < count; i++)
+				static_cast<CFlowchartLink*>(links->GetAt(i))->GetMemoryUsage(usage);
+		}
+	}
+
+	usage.SetScope(scope);
+
+	// Routing caches, the router itself is not counted
+	usage.Add(_T("Link routing"), _T("Caches"), 1,
+		(m_routedObjs.GetSize() + m_routedLinks.GetSize()) * sizeof(CObject*) +
+		m_obstacles.GetSize() * sizeof(int) + m_routedIDs.GetSize() * sizeof(ULONGLONG) +
+		(m_routedObjects.GetCount() + m_routedIndex.GetCount()) * sizeof(void*) * 4);
+}
+
 void CFlowchartEntityContainer::ClearLinks()
 /* ============================================================
 	Function :		CFlowchartEntityContainer::ClearLinks
@@ -942,7 +1627,7 @@ CFlowchartEntity* CFlowchartEntityContainer::GetPrimaryLink()
 
 		for (INT_PTR t = 0; t < max; t++)
 		{
-			CFlowchartEntity* obj = dynamic_cast<CFlowchartEntity*>(GetAt(t));
+			CFlowchartEntity* obj = CFlowchartEntity::Cast(GetAt(t));
 			if (obj && obj->IsSelected())
 			{
 				if (primary == NULL)
@@ -957,7 +1642,7 @@ CFlowchartEntity* CFlowchartEntityContainer::GetPrimaryLink()
 			CFlowchartLink* link = FindLink(primary, secondary);
 			if (link)
 			{
-				if (primary->GetName() == link->from)
+				if (primary->GetID() == link->from)
 					result = primary;
 				else
 					result = secondary;
@@ -995,7 +1680,7 @@ CFlowchartEntity* CFlowchartEntityContainer::GetSecondaryLink()
 
 		for (INT_PTR t = 0; t < max; t++)
 		{
-			CFlowchartEntity* obj = dynamic_cast<CFlowchartEntity*>(GetAt(t));
+			CFlowchartEntity* obj = CFlowchartEntity::Cast(GetAt(t));
 			if (obj && obj->IsSelected())
 			{
 				if (primary == NULL)
@@ -1010,7 +1695,7 @@ CFlowchartEntity* CFlowchartEntityContainer::GetSecondaryLink()
 			CFlowchartLink* link = FindLink(primary, secondary);
 			if (link)
 			{
-				if (primary->GetName() == link->from)
+				if (primary->GetID() == link->from)
 					result = secondary;
 				else
 					result = primary;
@@ -1046,7 +1731,7 @@ CFlowchartEntity* CFlowchartEntityContainer::GetPrimarySelected()
 
 		for (INT_PTR t = 0; t < max; t++)
 		{
-			CFlowchartEntity* obj = dynamic_cast<CFlowchartEntity*>(GetAt(t));
+			CFlowchartEntity* obj = CFlowchartEntity::Cast(GetAt(t));
 			if (obj && obj->IsSelected())
 			{
 				if (result == NULL)
@@ -1083,7 +1768,7 @@ CFlowchartEntity* CFlowchartEntityContainer::GetSecondarySelected()
 
 		for (INT_PTR t = 0; t < max; t++)
 		{
-			CFlowchartEntity* obj = dynamic_cast<CFlowchartEntity*>(GetAt(t));
+			CFlowchartEntity* obj = CFlowchartEntity::Cast(GetAt(t));
 			if (obj && obj->IsSelected())
 				result = obj;
 		}
@@ -1112,7 +1797,7 @@ int	CFlowchartEntityContainer::GetSelectCount()
 
 	for (INT_PTR t = 0; t < max; t++)
 	{
-		CFlowchartEntity* obj = dynamic_cast<CFlowchartEntity*>(GetAt(t));
+		CFlowchartEntity* obj = CFlowchartEntity::Cast(GetAt(t));
 
 		if (obj && obj->IsSelected())
 			count++;
@@ -4,6 +4,7 @@
 #include "../DiagramEditor/DiagramEntityContainer.h"
 #include "../DiagramEditor/DiagramEntity.h"
 #include "../DiagramEditor/Tokenizer.h"
+#include "../DiagramEditor/LinkRouter.h"
 #include "FlowchartEntity.h"
 #include "FlowchartLink.h"
 
@@ -31,13 +32,26 @@ public:
 	CFlowchartEntity* GetPrimaryLink();
 	CFlowchartEntity* GetSecondaryLink();
 
+	// Layout
+	void			AutoLayout();
+
+	// Routing
+	void			RouteLinks();
+	INT_PTR			GetLinkRoute(CFlowchartLink* link, CArray< CPoint, CPoint >& points);
+
+	// Rendering
+	void			RenderLink(CDiagramRenderer* renderer, CFlowchartLink* link, CFlowchartEntity* obj, CFlowchartEntity* to, double zoom, CSize markerSize);
+	virtual void	PrepareRender(double zoom);
+	virtual void	RenderRect(CDiagramRenderer* renderer, const CRect& rect, double zoom);
+
 	// Selection
 	int					GetSelectCount();
 	CFlowchartEntity*	GetPrimarySelected();
 	CFlowchartEntity*	GetSecondarySelected();
 
 	// Overrides
-	virtual void	RemoveAt(int index);
+	virtual void	RemoveAt(INT_PTR index);
+	virtual INT_PTR	RemoveIf(ENTITYPREDICATE predicate, LPVOID data = NULL);
 
 	virtual void	Undo();
 	virtual void	Snapshot();
@@ -47,6 +61,8 @@ public:
 	void			PushLinks(CObArray* stack);
 	virtual void	ClearRedo();
 
+	virtual void	GetMemoryUsage(CDiagramMemoryUsage& usage) const;
+
 	CObArray*		GetLinkArray() { return &m_links; }
 
 private:
@@ -55,8 +71,24 @@ private:
 	CObArray		m_redoLinks;
 	CObArray		m_undoLinks;
 
+	// Link routing
+	CLinkRouter			m_router;
+	CObArray			m_routedObjs;		// Objects "m_router" was built from
+	CObArray			m_routedLinks;		// Links "m_router" was built from
+	CArray< int, int >	m_obstacles;		// Obstacle of each object, -1 if none
+	CMapPtrToPtr		m_routedObjects;	// Object index by object
+	CArray< ULONGLONG, ULONGLONG >	m_routedIDs;	// Object ids "m_router" was built from
+	CMapPtrToPtr		m_routedIndex;		// Router link index by link
+
+	// Rendering, set by "PrepareRender"
+	CObArray			m_renderLinks;		// Links with both ends, by the object they start at
+	CDWordArray			m_renderFrom;		// Object index of the start of each link
+	CDWordArray			m_renderTo;			// Object index of the end of each link
+	CBoundsArray		m_renderBounds;		// Route of each link, with its arrow head and title
+
 	// Private helpers
 	void ClearLinks();
+	BOOL GetRoutedIndex(ULONGLONG id, void*& index) const;
 	BOOL FindClosestLink(CFlowchartEntity* obj1, CFlowchartEntity* obj2, int& fromtype, int& totype);
 	double	Dist(CPoint point1, CPoint point2);
 
@@ -24,6 +24,7 @@
 
 #include "stdafx.h"
 #include "FlowchartEntityIO.h"
+#include "../DiagramEditor/DiagramRenderer.h"
 
 #ifdef _DEBUG
 #define new DEBUG_NEW
@@ -68,26 +69,24 @@ CFlowchartEntityIO::~CFlowchartEntityIO()
 {
 }
 
-void CFlowchartEntityIO::Draw(CDC* dc, CRect rect)
+void CFlowchartEntityIO::Render(CDiagramRenderer* renderer, CRect rect)
 /* ============================================================
-	Function :		CFlowchartEntityIO::Draw
+	Function :		CFlowchartEntityIO::Render
 	Description :	Draws the object.
 
 	Return :		void
-	Parameters :	CDC* dc		-	The CDC to draw to.
-					CRect rect	-	The real rectangle of the
-									object.
+	Parameters :	CDiagramRenderer* renderer	-	The renderer to
+													draw with.
+					CRect rect					-	The real rectangle
+													of the object.
 
-	Usage :			The function should clean up all selected
-					objects. Note that the CDC is a memory CDC,
-					so creating a memory CDC in this function
-					will probably not speed up the function.
+	Usage :
 
    ============================================================*/
 {
 
-	dc->SelectStockObject(BLACK_PEN);
-	dc->SelectStockObject(WHITE_BRUSH);
+	renderer->SetPen(PS_SOLID, 0, RGB(0, 0, 0));
+	renderer->SetBrush(RGB(255, 255, 255));
 
 	CPoint pt[4];
 	int cut = round((double)GetMarkerSize().cx * GetZoom());
@@ -104,16 +103,12 @@ void CFlowchartEntityIO::Draw(CDC* dc, CRect rect)
 	pt[3].x = rect.left;
 	pt[3].y = rect.bottom;
 
-	dc->Polygon(pt, 4);
+	renderer->Polygon(pt, 4);
 
 	CRect r(rect.left + cut, rect.top + cut / 2, rect.right - cut, rect.bottom - cut / 2);
-	CFont font;
-	font.CreateFont(-round(12.0 * GetZoom()), 0, 0, 0, FW_NORMAL, 0, 0, 0, 0, 0, 0, 0, 0, _T("Courier New"));
-	dc->SelectObject(&font);
-	int mode = dc->SetBkMode(TRANSPARENT);
-	dc->DrawText(GetTitle(), r, DT_NOPREFIX | DT_WORDBREAK | DT_CENTER);
-	dc->SelectStockObject(DEFAULT_GUI_FONT);
-	dc->SetBkMode(mode);
+	renderer->SetFont(_T("Courier New"), -round(12.0 * GetZoom()));
+	renderer->SetBkMode(TRANSPARENT);
+	renderer->DrawText(GetTitle(), r, DT_NOPREFIX | DT_WORDBREAK | DT_CENTER);
 
 }
 
@@ -6,6 +6,7 @@
 
 class CFlowchartLabel : public CDiagramEntity
 {
+	DECLARE_ENTITY_SIZE(CFlowchartLabel)
 
 public:
 	// Construction/initialization/destruction
@@ -15,7 +16,7 @@ public:
 	static	CDiagramEntity* CreateFromString(const CString& str);
 
 	// Overrides
-	virtual void Draw(CDC* dc, CRect rect);
+	virtual void Render(CDiagramRenderer* renderer, CRect rect);
 
 private:
 	// Private data
@@ -12,12 +12,17 @@
 					link, as well as functions to save, load and clone it.
 
 	Usage :			Instances of this class are managed by the flowchart
-					container class. Link data is public.
+					container class. Link data is public. The objects
+					are kept as numeric ids, see "CLinkFactory", and
+					only converted to names when saved and read.
 
    ========================================================================*/
 #include "stdafx.h"
 #include "FlowchartLink.h"
 #include "../DiagramEditor/Tokenizer.h"
+#include "../DiagramEditor/DiagramMemoryUsage.h"
+
+IMPLEMENT_POOLED_ALLOC(CFlowchartLink, 256)
 
 CFlowchartLink::CFlowchartLink()
 /* ============================================================
@@ -34,6 +39,8 @@ CFlowchartLink::CFlowchartLink()
 
 	fromtype = 0;
 	totype = 0;
+	from = LINK_ID_NONE;
+	to = LINK_ID_NONE;
 
 }
 
@@ -76,6 +83,28 @@ CFlowchartLink* CFlowchartLink::Clone() const
 
 }
 
+void CFlowchartLink::GetMemoryUsage(CDiagramMemoryUsage& usage) const
+/* ============================================================
+	Function :		CFlowchartLink::GetMemoryUsage
+	Description :	Adds the memory held by the link to
+					"usage".
+
+	Return :		void
+	Parameters :	CDiagramMemoryUsage& usage	-	Breakdown
+													to add to.
+
+	Usage :			Called by the container and the clipboard.
+					The slot of the link in its array is counted
+					by the caller.
+
+   ============================================================*/
+{
+
+	usage.Add(_T("Links"), _T("Flowchart links"), 1, sizeof(CFlowchartLink));
+	usage.AddString(title);
+
+}
+
 CString CFlowchartLink::GetString() const
 /* ============================================================
 	Function :		CFlowchartLink::GetString
@@ -101,8 +130,8 @@ CString CFlowchartLink::GetString() const
 		fromtype,
 		totype,
 		writetitle.GetString(),
-		from.GetString(),
-		to.GetString()
+		CLinkFactory::ToString(from).GetString(),
+		CLinkFactory::ToString(to).GetString()
 	);
 	return str;
 
@@ -163,8 +192,8 @@ BOOL CFlowchartLink::FromString(const CString& str)
 				fromtype = readtype;
 				totype = readantitype;
 				title = readtitle;
-				from = readfrom;
-				to = readto;
+				from = CLinkFactory::ToID(readfrom);
+				to = CLinkFactory::ToID(readto);
 
 				result = TRUE;
 			}
@@ -1,6 +1,11 @@
 #ifndef _FLOWCHARTLINK_H_
 #define _FLOWCHARTLINK_H_
 
+#include "../DiagramEditor/ObjectPool.h"
+#include "../UMLEditor/LinkFactory.h"
+
+class CDiagramMemoryUsage;
+
 // Link types
 #define LINK_LEFT	1
 #define LINK_RIGHT	2
@@ -14,6 +19,8 @@
 
 class CFlowchartLink : public CObject
 {
+	DECLARE_POOLED_ALLOC(CFlowchartLink)
+
 
 public:
 	// Creation/destruction
@@ -26,13 +33,14 @@ public:
 	virtual CString GetString() const;
 	virtual CFlowchartLink* Clone() const;
 	virtual BOOL FromString(const CString& str);
+	void GetMemoryUsage(CDiagramMemoryUsage& usage) const;
 
 	// Data
 	int		fromtype;	// Type of the from-part of the link
 	int		totype;	// Type of the to-part.
 	CString title;		// Title of the link, if any.
-	CString	from;		// Name of the attached from-object.
-	CString	to;			// Name of the attached to-object, if any.
+	ULONGLONG	from;	// Id of the attached from-object.
+	ULONGLONG	to;		// Id of the attached to-object, "LINK_ID_NONE" if none.
 
 };
 
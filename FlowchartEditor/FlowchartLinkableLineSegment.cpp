@@ -19,6 +19,7 @@
    ========================================================================*/
 #include "stdafx.h"
 #include "FlowchartLinkableLineSegment.h"
+#include "../DiagramEditor/DiagramRenderer.h"
 #include "../DiagramEditor/DiagramLine.h"
 
    //////////////////////////////////////////
@@ -81,39 +82,34 @@ CDiagramEntity* CFlowchartLinkableLineSegment::Clone()
 
 }
 
-void CFlowchartLinkableLineSegment::Draw(CDC* dc, CRect rect)
+void CFlowchartLinkableLineSegment::Render(CDiagramRenderer* renderer, CRect rect)
 /* ============================================================
-	Function :		CFlowchartLinkableLineSegment::Draw
+	Function :		CFlowchartLinkableLineSegment::Render
 	Description :	Draws the object.
 
 	Return :		void
-	Parameters :	CDC* dc		-	The CDC to draw to.
-					CRect rect	-	The real rectangle of the
-									object.
+	Parameters :	CDiagramRenderer* renderer	-	The renderer to
+													draw with.
+					CRect rect					-	The real rectangle
+													of the object.
 
-	Usage :			The function should clean up all selected
-					objects. Note that the CDC is a memory CDC,
-					so creating a memory CDC in this function
-					will probably not speed up the function.
+	Usage :
 
    ============================================================*/
 {
 
-	dc->SelectStockObject(BLACK_PEN);
-	dc->SelectStockObject(BLACK_BRUSH);
+	renderer->SetPen(PS_SOLID, 0, RGB(0, 0, 0));
+	renderer->SetBrush(RGB(0, 0, 0));
 
 	// Draw line
-	dc->MoveTo(rect.TopLeft());
-	dc->LineTo(rect.BottomRight());
+	renderer->Line(rect.TopLeft(), rect.BottomRight());
 
 	// Draw title
 	CString str = GetTitle();
 	if (str.GetLength())
 	{
-		CFont font;
-		font.CreateFont(-round(12.0 * GetZoom()), 0, 0, 0, FW_NORMAL, 0, 0, 0, 0, 0, 0, 0, 0, _T("Courier New"));
-		dc->SelectObject(&font);
-		int mode = dc->SetBkMode(TRANSPARENT);
+		renderer->SetFont(_T("Courier New"), -round(12.0 * GetZoom()));
+		renderer->SetBkMode(TRANSPARENT);
 
 		CRect rectTemp(rect);
 		rectTemp.NormalizeRect();
@@ -124,18 +120,15 @@ void CFlowchartLinkableLineSegment::Draw(CDC* dc, CRect rect)
 		{
 			CRect r(rect.left, rect.top - (cy + cut), rect.right, rect.bottom);
 			r.NormalizeRect();
-			dc->DrawText(str, r, DT_NOPREFIX | DT_SINGLELINE | DT_VCENTER | DT_CENTER);
+			renderer->DrawText(str, r, DT_NOPREFIX | DT_SINGLELINE | DT_VCENTER | DT_CENTER);
 		}
 		else
 		{
 			CRect r(rect.right - cut, rect.top, rect.right - (cy * str.GetLength() + cut), rect.bottom);
 			r.NormalizeRect();
-			dc->DrawText(str, r, DT_NOPREFIX | DT_SINGLELINE | DT_VCENTER | DT_RIGHT);
+			renderer->DrawText(str, r, DT_NOPREFIX | DT_SINGLELINE | DT_VCENTER | DT_RIGHT);
 		}
 
-		dc->SelectStockObject(DEFAULT_GUI_FONT);
-		dc->SetBkMode(mode);
-
 	}
 
 }
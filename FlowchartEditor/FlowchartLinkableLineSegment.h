@@ -6,6 +6,7 @@
 
 class CFlowchartLinkableLineSegment : public CFlowchartEntity
 {
+	DECLARE_ENTITY_SIZE(CFlowchartLinkableLineSegment)
 
 public:
 
@@ -17,7 +18,7 @@ public:
 	static	CDiagramEntity* CreateFromString(const CString& str);
 
 	// Overrides
-	virtual void		Draw(CDC* dc, CRect rect);
+	virtual void		Render(CDiagramRenderer* renderer, CRect rect);
 	virtual int			GetHitCode(CPoint point) const;
 	virtual HCURSOR		GetCursor(int hit) const;
 	virtual void		SetRect(CRect rect);
@@ -64,6 +64,8 @@ BEGIN_MESSAGE_MAP(CFlowchartView, CDiagramView)
 	ON_UPDATE_COMMAND_UI(ID_FLOWCHART_FLIP_LINK, OnUpdateFlipLink)
 	ON_COMMAND(ID_PROPERTY, OnProperty)
 	ON_UPDATE_COMMAND_UI(ID_PROPERTY, OnUpdateProperty)
+	ON_COMMAND(ID_AUTO_LAYOUT, OnAutoLayout)
+	ON_UPDATE_COMMAND_UI(ID_AUTO_LAYOUT, OnUpdateExport)
 	//}}AFX_MSG_MAP
 	// Standard printing commands
 	ON_COMMAND(ID_FILE_PRINT, CView::OnFilePrint)
@@ -477,6 +479,11 @@ void CFlowchartView::OnFlipLink()
 	m_editor.OnLinkDirection();
 }
 
+void CFlowchartView::OnAutoLayout()
+{
+	m_editor.AutoLayout();
+}
+
 /////////////////////////////////////////////////////////////////////////////
 // CFlowchartView command enablers
 
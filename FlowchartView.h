@@ -84,6 +84,7 @@ protected:
 	afx_msg virtual void OnUpdateProperty(CCmdUI* pCmdUI);
 	afx_msg void OnExport();
 	afx_msg void OnUpdateExport(CCmdUI* pCmdUI);
+	afx_msg void OnAutoLayout();
 	//}}AFX_MSG
 	DECLARE_MESSAGE_MAP()
 
@@ -20,6 +20,7 @@
 #endif
 
 #include "NetDoc.h"
+#include "DiagramEditor/DiagramTrace.h"
 
 #include "NetworkEditor/NetworkLink.h"
 #include "NetworkEditor/NetworkControlFactory.h"
@@ -42,6 +43,7 @@ END_MESSAGE_MAP()
 
 CNetDoc::CNetDoc()
 {
+	m_objs.SetEntityFactory(CNetworkControlFactory::CreateFromString);
 }
 
 CNetDoc::~CNetDoc()
@@ -66,6 +68,8 @@ BOOL CNetDoc::OnNewDocument()
 
 void CNetDoc::Serialize(CArchive& ar)
 {
+	DIAGRAM_TRACE_SPAN(_T("CNetDoc::Serialize"));
+
 	if (ar.IsStoring())
 	{
 		ar.WriteString(m_objs.GetString() + _T("\r\n"));
@@ -82,10 +86,19 @@ void CNetDoc::Serialize(CArchive& ar)
 				ar.WriteString(link->GetString() + _T("\r\n"));
 		}
 
+		// The preview is written last, where it can be read without the diagram
+		m_thumbnail.Update(&m_objs);
+		m_thumbnail.WriteTrailer(ar);
+
 		m_objs.SetModified(FALSE);
 	}
 	else
 	{
+#ifdef SHARED_HANDLERS
+		// Thumbnail handlers only need the preview
+		if (m_bGetThumbnailMode && m_thumbnail.ReadTrailer(ar))
+			return;
+#endif // SHARED_HANDLERS
 
 		m_objs.Clear();
 		CString str;
@@ -118,22 +131,11 @@ void CNetDoc::Serialize(CArchive& ar)
 // Support for thumbnails
 void CNetDoc::OnDrawThumbnail(CDC& dc, LPRECT lprcBounds)
 {
-	// Modify this code to draw the document's data
-	dc.FillSolidRect(lprcBounds, RGB(255, 255, 255));
-
-	CString strText = _T("TODO: implement thumbnail drawing here");
-	LOGFONT lf;
-
-	CFont* pDefaultGUIFont = CFont::FromHandle((HFONT)GetStockObject(DEFAULT_GUI_FONT));
-	pDefaultGUIFont->GetLogFont(&lf);
-	lf.lfHeight = 36;
-
-	CFont fontDraw;
-	fontDraw.CreateFontIndirect(&lf);
+	// Older files have no preview, draw the diagram instead
+	if (m_thumbnail.IsEmpty())
+		m_thumbnail.Create(m_objs.GetData());
 
-	CFont* pOldFont = dc.SelectObject(&fontDraw);
-	dc.DrawText(strText, lprcBounds, DT_CENTER | DT_WORDBREAK);
-	dc.SelectObject(pOldFont);
+	m_thumbnail.Draw(dc, lprcBounds);
 }
 
 // Support for Search Handlers
@@ -16,6 +16,7 @@
 #pragma once
 
 #include "NetworkEditor/NetworkEntityContainer.h"
+#include "DiagramEditor/DiagramThumbnail.h"
 
 class CNetDoc : public CDocument
 {
@@ -61,4 +62,5 @@ protected:
 #endif // SHARED_HANDLERS
 private:
 	CNetworkEntityContainer	m_objs;
+	CDiagramThumbnail		m_thumbnail;
 };
@@ -44,6 +44,8 @@ BEGIN_MESSAGE_MAP(CNetView, CDiagramView)
 	ON_UPDATE_COMMAND_UI(ID_EXPORT, OnUpdateExport)
 	ON_COMMAND(ID_EXPORT_EMF, OnExport)
 	ON_UPDATE_COMMAND_UI(ID_EXPORT_EMF, OnUpdateExport)
+	ON_COMMAND(ID_AUTO_LAYOUT, OnAutoLayout)
+	ON_UPDATE_COMMAND_UI(ID_AUTO_LAYOUT, OnUpdateExport)
 	ON_COMMAND(ID_BUTTON_LINK, OnButtonLink)
 	ON_UPDATE_COMMAND_UI(ID_BUTTON_LINK, OnUpdateLink)
 	// Custom to the document type
@@ -402,6 +404,11 @@ void CNetView::OnUpdateExport(CCmdUI* pCmdUI)
 	pCmdUI->Enable(m_editor.GetObjectCount() > 0);
 }
 
+void CNetView::OnAutoLayout()
+{
+	m_editor.AutoLayout();
+}
+
 // CNetView update handlers
 
 void CNetView::OnUpdateLink(CCmdUI* pCmdUI)
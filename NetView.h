@@ -78,6 +78,7 @@ protected:
 	afx_msg void OnUpdateLink(CCmdUI* pCmdUI);
 	afx_msg void OnExport();
 	afx_msg void OnUpdateExport(CCmdUI* pCmdUI);
+	afx_msg void OnAutoLayout();
 	DECLARE_MESSAGE_MAP()
 
 private:
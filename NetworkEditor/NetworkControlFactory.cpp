@@ -1,6 +1,7 @@
 #include "stdafx.h"
 #include "NetworkControlFactory.h"
 #include "NetworkSymbol.h"
+#include "../DiagramEditor/DiagramTrace.h"
 
 CDiagramEntity* CNetworkControlFactory::CreateFromString(const CString& str)
 /* ============================================================
@@ -21,6 +22,8 @@ CDiagramEntity* CNetworkControlFactory::CreateFromString(const CString& str)
 
    ============================================================*/
 {
+	DIAGRAM_TRACE_SPAN(_T("CNetworkControlFactory::CreateFromString"));
+
 	CDiagramEntity* obj;
 
 	obj = CNetworkSymbol::CreateFromString(str);
@@ -18,6 +18,7 @@
 #include "stdafx.h"
 #include "NetworkEditor.h"
 #include "NetworkEntityContainer.h"
+#include "../DiagramEditor/DiagramTrace.h"
 #include "../resource.h"
 
 #ifdef _DEBUG
@@ -72,6 +73,8 @@ void CNetworkEditor::DrawObjects(CDC* dc, double zoom) const
 
    ============================================================*/
 {
+	DIAGRAM_TRACE_SPAN(_T("CNetworkEditor::DrawObjects"));
+
 	// Draw links
 	dc->SelectStockObject(BLACK_PEN);
 
@@ -105,6 +108,8 @@ void CNetworkEditor::DrawObjects(CDC* dc, double zoom) const
 				max = objs->GetLinks();
 			}
 		}
+
+		CountLinks(max);
 	}
 
 	// Draw objects
@@ -212,35 +217,27 @@ void CNetworkEditor::OnUnlink()
 	}
 }
 
-CNetworkSymbol* CNetworkEditor::GetNamedObject(const CString& name) const
+CNetworkSymbol* CNetworkEditor::GetNamedObject(ULONGLONG id) const
 /* ============================================================
 	Function :		CNetworkEditor::GetNamedObject
-	Description :	Returns the object with the name attribute
-					name.
+	Description :	Returns the object with the id "id".
 
 	Return :		CNetworkSymbol*	-	The object, or NULL
-											if not found.
-	Parameters :	const CString& name	-	The name of the
-											object to find.
+										if not found.
+	Parameters :	ULONGLONG id	-	The id of the object
+										to find.
 
-	Usage :			Call to get the object with the name name,
+	Usage :			Call to get the object with the id "id",
 					if it exists.
 
    ============================================================*/
 {
 
 	CDiagramEntity* result = NULL;
+	if (GetDiagramEntityContainer())
+		result = GetDiagramEntityContainer()->GetObjectByID(id);
 
-	INT_PTR count = GetObjectCount();
-	CDiagramEntity* obj;
-	for (int t = 0; t < count; t++)
-	{
-		obj = GetObject(t);
-		if (obj && obj->GetName() == name)
-			result = obj;
-	}
-
-	return dynamic_cast<CNetworkSymbol*>(result);
+	return CNetworkSymbol::Cast(result);
 
 }
 
@@ -255,14 +252,36 @@ void CNetworkEditor::ExportEMF(const CString& filename)
 
 	Usage :			Call to export the diagram to an EMF file
 					for - for example - inclusion into a
-					word-processing document.
+					word-processing document. If a ".png",
+					".svg" or ".pdf" file is chosen, the
+					diagram is exported to that format
+					instead, see "ExportPNG", "ExportSVG" and
+					"ExportPDF".
 
    ============================================================*/
 {
 
-	CFileDialog dlg(FALSE, _T("emf"), filename, OFN_HIDEREADONLY | OFN_OVERWRITEPROMPT, _T("Enhanced MetaFile (*.emf)|*.emf|All Files (*.*)|*.*||"));
+	CFileDialog dlg(FALSE, _T("emf"), filename, OFN_HIDEREADONLY | OFN_OVERWRITEPROMPT, _T("Enhanced MetaFile (*.emf)|*.emf|PNG Image (*.png)|*.png|SVG Image (*.svg)|*.svg|PDF Document (*.pdf)|*.pdf|All Files (*.*)|*.*||"));
 	if (dlg.DoModal() == IDOK)
 	{
+		CString extension = dlg.GetPathName().Right(4);
+		if (extension.CompareNoCase(_T(".png")) == 0)
+		{
+			ExportPNG(dlg.GetPathName());
+			return;
+		}
+		if (extension.CompareNoCase(_T(".svg")) == 0)
+		{
+			ExportSVG(dlg.GetPathName());
+			return;
+		}
+		if (extension.CompareNoCase(_T(".pdf")) == 0)
+		{
+			ExportPDF(dlg.GetPathName());
+			return;
+		}
+
+		DIAGRAM_TRACE_SPAN(_T("CNetworkEditor::ExportEMF"));
 
 		CClientDC	dc(this);
 		CMetaFileDC	metaDC;
@@ -309,3 +328,37 @@ void CNetworkEditor::ExportEMF(const CString& filename)
 	}
 
 }
+
+void CNetworkEditor::AutoLayout()
+/* ============================================================
+	Function :		CNetworkEditor::AutoLayout
+	Description :	Arranges the symbols along the links.
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Call to tidy up the diagram. Can be
+					undone. The virtual size is grown if the
+					result does not fit.
+
+   ============================================================*/
+{
+
+	CNetworkEntityContainer* objs = dynamic_cast<CNetworkEntityContainer*>(GetDiagramEntityContainer());
+	if (objs && objs->GetSize())
+	{
+		CWaitCursor wait;
+		objs->Snapshot();
+		objs->AutoLayout();
+
+		const CBoundsArray* bounds = objs->GetBounds();
+		CSize size = GetVirtualSize();
+		CSize needed(round(bounds->GetMax(BOUNDS_RIGHT, 0)) + 1, round(bounds->GetMax(BOUNDS_BOTTOM, 0)) + 1);
+		if (needed.cx > size.cx || needed.cy > size.cy)
+			SetVirtualSize(CSize(max(size.cx, needed.cx), max(size.cy, needed.cy)));
+
+		SetModified(TRUE);
+		RedrawWindow();
+	}
+
+}
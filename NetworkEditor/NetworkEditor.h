@@ -12,6 +12,7 @@ public:
 
 	BOOL CanLink();
 	BOOL IsLinked();
+	void AutoLayout();
 	void ExportEMF(const CString& filename);
 
 	afx_msg void OnLink();
@@ -23,7 +24,7 @@ protected:
 	virtual void DrawObjects(CDC* dc, double zoom) const;
 
 private:
-	CNetworkSymbol*	GetNamedObject(const CString& name) const;
+	CNetworkSymbol*	GetNamedObject(ULONGLONG id) const;
 
 
 };
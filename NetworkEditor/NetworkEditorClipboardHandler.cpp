@@ -107,26 +107,26 @@ void CNetworkEditorClipboardHandler::Paste(CDiagramEntityContainer* container)
 		return;
 	}
 
+	// Map the copied ids to the pasted ones
+	CMap< ULONGLONG, ULONGLONG, ULONGLONG, ULONGLONG > ids;
+	for (INT_PTR i = 0; i < maxObjs; i++)
+	{
+		CDiagramEntity* obj = static_cast<CDiagramEntity*>(paste->GetAt(i));
+		CDiagramEntity* newObj = static_cast<CDiagramEntity*>(lastPaste->GetAt(i));
+		ids.SetAt(obj->GetID(), newObj->GetID());
+	}
+
+	ULONGLONG id;
 	for (INT_PTR t = 0; t < maxLinks; t++)
 	{
 		// Get the link
 		CNetworkLink* link = static_cast<CNetworkLink*>(m_pasteLinks[t])->Clone();
 
-		// Make sure we have the correct names
-		for (INT_PTR i = 0; i < maxObjs; i++)
-		{
-			CDiagramEntity* obj = static_cast<CDiagramEntity*>(paste->GetAt(i));
-			CDiagramEntity* newObj = static_cast<CDiagramEntity*>(lastPaste->GetAt(i));
-			if (link->from == obj->GetName())
-			{
-				link->from = newObj->GetName();
-			}
-
-			if (link->to == obj->GetName())
-			{
-				link->to = newObj->GetName();
-			}
-		}
+		// Make sure we have the correct ids
+		if (ids.Lookup(link->from, id))
+			link->from = id;
+		if (ids.Lookup(link->to, id))
+			link->to = id;
 
 		// Add the link
 		flow->AddLink(link);
@@ -164,22 +164,24 @@ void CNetworkEditorClipboardHandler::CopyAllSelected(CDiagramEntityContainer* co
 	max = paste->GetSize();
 
 	// Fix the links
+	CMap< ULONGLONG, ULONGLONG, ULONGLONG, ULONGLONG > ids;
 	for (INT_PTR t = 0; t < max; t++)
 	{
 		CDiagramEntity* obj = static_cast<CDiagramEntity*>(paste->GetAt(t));
-		CString newID = CLinkFactory::GetID();
-
-		INT_PTR maxlinks = m_pasteLinks.GetSize();
-		for (INT_PTR i = 0; i < maxlinks; i++)
-		{
-			CNetworkLink* link = static_cast<CNetworkLink*>(m_pasteLinks[i]);
-			if (link->from == obj->GetName())
-				link->from = newID;
-			if (link->to == obj->GetName())
-				link->to = newID;
-		}
-
-		obj->SetName(newID);
+		ULONGLONG oldID = obj->GetID();
+		obj->SetName(CLinkFactory::GetID());
+		ids.SetAt(oldID, obj->GetID());
+	}
+
+	ULONGLONG id;
+	INT_PTR maxlinks = m_pasteLinks.GetSize();
+	for (INT_PTR i = 0; i < maxlinks; i++)
+	{
+		CNetworkLink* link = static_cast<CNetworkLink*>(m_pasteLinks[i]);
+		if (ids.Lookup(link->from, id))
+			link->from = id;
+		if (ids.Lookup(link->to, id))
+			link->to = id;
 	}
 }
 
@@ -18,6 +18,9 @@
    ========================================================================*/
 #include "stdafx.h"
 #include "NetworkEntityContainer.h"
+#include "../DiagramEditor/DiagramTrace.h"
+#include "../DiagramEditor/DiagramRenderer.h"
+#include "../DiagramEditor/ForceLayout.h"
 
 #ifdef _DEBUG
 #define new DEBUG_NEW
@@ -25,6 +28,8 @@
 static char THIS_FILE[] = __FILE__;
 #endif
 
+#define AUTOLAYOUT_SPACING	32	// Gap between a symbol and a pinned symbol it is moved away from
+
 CNetworkEntityContainer::CNetworkEntityContainer()
 /* ============================================================
 	Function :		CNetworkEntityContainer::CNetworkEntityContainer
@@ -56,7 +61,7 @@ CNetworkEntityContainer::~CNetworkEntityContainer()
 	ClearRedo();
 }
 
-void CNetworkEntityContainer::RemoveAt(int index)
+void CNetworkEntityContainer::RemoveAt(INT_PTR index)
 /* ============================================================
 	Function :		CNetworkEntityContainer::RemoveAt
 	Description :	Removes the object at index. Will also
@@ -73,14 +78,14 @@ void CNetworkEntityContainer::RemoveAt(int index)
 	CDiagramEntity* obj = GetAt(index);
 	if (obj)
 	{
-		CString name = obj->GetName();
+		ULONGLONG id = obj->GetID();
 		CDiagramEntityContainer::RemoveAt(index);
 
 		INT_PTR max = m_links.GetUpperBound();
 		for (INT_PTR t = max; t >= 0; t--)
 		{
 			CNetworkLink* link = static_cast<CNetworkLink*>(m_links.GetAt(t));
-			if (link->to == name || link->from == name)
+			if (link->to == id || link->from == id)
 			{
 				delete link;
 				m_links.RemoveAt(t);
@@ -90,6 +95,59 @@ void CNetworkEntityContainer::RemoveAt(int index)
 
 }
 
+INT_PTR CNetworkEntityContainer::RemoveIf(ENTITYPREDICATE predicate, LPVOID data)
+/* ============================================================
+	Function :		CNetworkEntityContainer::RemoveIf
+	Description :	Removes all objects matching predicate.
+					Will also remove all links refering to
+					the removed objects.
+
+	Return :		INT_PTR						-	The number of
+													removed objects.
+	Parameters :	ENTITYPREDICATE predicate	-	Function
+													returning TRUE
+													for objects to
+													remove.
+					LPVOID data					-	Passed to
+													predicate.
+
+	Usage :			Overridden to remove links as well. Both
+					the object and the link arrays are
+					compacted in a single pass.
+
+   ============================================================*/
+{
+
+	CMapPtrToPtr marked;
+	INT_PTR max = GetSize();
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		CDiagramEntity* obj = GetAt(t);
+		if (predicate(obj, data))
+			marked.SetAt(obj, obj);
+	}
+
+	// The links are resolved while the marked objects still exist
+	if (marked.GetCount())
+	{
+		void* value;
+		max = m_links.GetSize();
+		INT_PTR current = 0;
+		for (INT_PTR t = 0; t < max; t++)
+		{
+			CNetworkLink* link = static_cast<CNetworkLink*>(m_links.GetAt(t));
+			if (marked.Lookup(GetObjectByID(link->to), value) || marked.Lookup(GetObjectByID(link->from), value))
+				delete link;
+			else
+				m_links.SetAt(current++, link);
+		}
+		m_links.SetSize(current);
+	}
+
+	return RemoveMarked(marked);
+
+}
+
 /////////////////////////////////////////////////////////////////////////////
 // Undo operations
 
@@ -105,6 +163,8 @@ void CNetworkEntityContainer::Undo()
 
    ============================================================*/
 {
+	DIAGRAM_TRACE_SPAN(_T("CNetworkEntityContainer::Undo"));
+
 	if (m_undoLinks.GetSize())
 	{
 		// Push the current state to the redo links stack
@@ -144,10 +204,18 @@ void CNetworkEntityContainer::Snapshot()
 	Parameters :	none
 
 	Usage :			Overridden to save the link state as well.
+					Inside a transaction, only the first call
+					is recorded.
 
    ============================================================*/
 {
-	CDiagramEntityContainer::Snapshot();
+	DIAGRAM_TRACE_SPAN(_T("CNetworkEntityContainer::Snapshot"));
+
+	if (!BeginSnapshot())
+		return;
+
+	ClearRedo();
+	Push(GetUndo());
 	PushLinks(&m_undoLinks);
 }
 
@@ -195,6 +263,8 @@ void CNetworkEntityContainer::Redo()
 
    ============================================================*/
 {
+	DIAGRAM_TRACE_SPAN(_T("CNetworkEntityContainer::Redo"));
+
 	if (m_redoLinks.GetSize())
 	{
 		// Push the current state to the undo links stack
@@ -294,6 +364,129 @@ void CNetworkEntityContainer::ClearRedo()
 	m_redoLinks.RemoveAll();
 }
 
+void CNetworkEntityContainer::GetMemoryUsage(CDiagramMemoryUsage& usage) const
+/* ============================================================
+	Function :		CNetworkEntityContainer::GetMemoryUsage
+	Description :	Adds the memory held by the container to
+					"usage".
+
+	Return :		void
+	Parameters :	CDiagramMemoryUsage& usage	-	Breakdown
+													to add to.
+
+	Usage :			Overridden to add the links, and the links
+					of the undo and redo states.
+
+   ============================================================*/
+{
+	CDiagramEntityContainer::GetMemoryUsage(usage);
+
+	INT_PTR max = m_links.GetSize();
+	usage.Add(_T("Links"), _T("Link array"), 1, max * sizeof(CObject*));
+	for (INT_PTR t = 0; t < max; t++)
+		static_cast<CNetworkLink*>(m_links.GetAt(t))->GetMemoryUsage(usage);
+
+	CString scope = usage.GetScope();
+	const CObArray* stacks[2] = { &m_undoLinks, &m_redoLinks };
+	LPCTSTR scopes[2] = { _T("Undo"), _T("Redo") };
+	for (int s = 0; s < 2; s++)
+	{
+		usage.SetScope(scopes[s]);
+		INT_PTR levels = stacks[s]->GetSize();
+		for (INT_PTR t = 0; t < levels; t++)
+		{
+			CObArray* links = static_cast<CObArray*>(stacks[s]->GetAt(t));
+			INT_PTR count = links->GetSize();
+			usage.Add(_T("Links"), _T("Link array"), 1, sizeof(CObArray) + sizeof(CObject*) + count * sizeof(CObject*));
+			for (INT_PTR i = 0; i < count; i++)
+				static_cast<CNetworkLink*>(links->GetAt(i))->GetMemoryUsage(usage);
+		}
+	}
+
+	usage.SetScope(scope);
+}
+
+void CNetworkEntityContainer::PrepareRender(double zoom)
+/* ============================================================
+	Function :		CNetworkEntityContainer::PrepareRender
+	Description :	Finds the ends of the links.
+
+	Return :		void
+	Parameters :	double zoom	-	Zoom level.
+
+	Usage :			Called before "RenderRect". Links with a
+					missing end are skipped.
+
+   ============================================================*/
+{
+
+	CDiagramEntityContainer::PrepareRender(zoom);
+
+	m_renderStart.RemoveAll();
+	m_renderEnd.RemoveAll();
+
+	INT_PTR max = m_links.GetSize();
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		CNetworkLink* link = static_cast<CNetworkLink*>(m_links.GetAt(t));
+		CNetworkSymbol* from = CNetworkSymbol::Cast(GetObjectByID(link->from));
+		CNetworkSymbol* to = CNetworkSymbol::Cast(GetObjectByID(link->to));
+		if (from && to)
+		{
+			m_renderStart.Add(from->GetLinkPosition());
+			m_renderEnd.Add(to->GetLinkPosition());
+		}
+	}
+
+	INT_PTR links = m_renderStart.GetSize();
+	m_renderBounds.SetSize(links);
+	for (INT_PTR t = 0; t < links; t++)
+		m_renderBounds.SetAt(t, m_renderStart[t].x, m_renderStart[t].y, m_renderEnd[t].x, m_renderEnd[t].y);
+
+}
+
+void CNetworkEntityContainer::RenderRect(CDiagramRenderer* renderer, const CRect& rect, double zoom)
+/* ============================================================
+	Function :		CNetworkEntityContainer::RenderRect
+	Description :	Renders the links and the objects touching
+					a rectangle.
+
+	Return :		void
+	Parameters :	CDiagramRenderer* renderer	-	Renderer to
+													draw with.
+					const CRect& rect			-	Rectangle to
+													draw, zoomed.
+					double zoom					-	Zoom level.
+
+	Usage :			Call "PrepareRender" first. Links are drawn
+					below all objects, as in the editor.
+
+   ============================================================*/
+{
+
+	CDWordArray links;
+	INT_PTR max = m_renderBounds.GetIntersecting(
+		rect.left / zoom, rect.top / zoom,
+		rect.right / zoom, rect.bottom / zoom,
+		links);
+
+	renderer->SetPen(PS_SOLID, 0, RGB(0, 0, 0));
+
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		CPoint start = m_renderStart[links[t]];
+		CPoint end = m_renderEnd[links[t]];
+		start.x = round((double)start.x * zoom);
+		start.y = round((double)start.y * zoom);
+		end.x = round((double)end.x * zoom);
+		end.y = round((double)end.y * zoom);
+		renderer->Line(start, end);
+	}
+
+	CDiagramEntityContainer::RenderRect(renderer, rect, zoom);
+
+}
+
 /////////////////////////////////////////////////////////////////////////////
 // Link operations
 
@@ -357,7 +550,7 @@ CNetworkSymbol* CNetworkEntityContainer::GetSecondaryLink()
 
 		for (INT_PTR t = 0; t < max; t++)
 		{
-			CNetworkSymbol* obj = dynamic_cast<CNetworkSymbol*>(GetAt(t));
+			CNetworkSymbol* obj = CNetworkSymbol::Cast(GetAt(t));
 			if (obj && obj->IsSelected())
 			{
 				if (primary == NULL)
@@ -372,7 +565,7 @@ CNetworkSymbol* CNetworkEntityContainer::GetSecondaryLink()
 			CNetworkLink* link = FindLink(primary, secondary);
 			if (link)
 			{
-				if (primary->GetName() == link->from)
+				if (primary->GetID() == link->from)
 					result = secondary;
 				else
 					result = primary;
@@ -505,7 +698,7 @@ CNetworkLink* CNetworkEntityContainer::FindLink(CDiagramEntity* obj1, CDiagramEn
 		for (INT_PTR t = max; t >= 0; t--)
 		{
 			CNetworkLink* link = static_cast<CNetworkLink*>(m_links.GetAt(t));
-			if ((link->from == obj1->GetName() && link->to == obj2->GetName()) || (link->from == obj2->GetName() && link->to == obj1->GetName()))
+			if ((link->from == obj1->GetID() && link->to == obj2->GetID()) || (link->from == obj2->GetID() && link->to == obj1->GetID()))
 				result = link;
 		}
 	}
@@ -561,7 +754,7 @@ CNetworkSymbol* CNetworkEntityContainer::GetPrimaryLink()
 
 		for (INT_PTR t = 0; t < max; t++)
 		{
-			CNetworkSymbol* obj = dynamic_cast<CNetworkSymbol*>(GetAt(t));
+			CNetworkSymbol* obj = CNetworkSymbol::Cast(GetAt(t));
 			if (obj && obj->IsSelected())
 			{
 				if (primary == NULL)
@@ -576,7 +769,7 @@ CNetworkSymbol* CNetworkEntityContainer::GetPrimaryLink()
 			CNetworkLink* link = FindLink(primary, secondary);
 			if (link)
 			{
-				if (primary->GetName() == link->from)
+				if (primary->GetID() == link->from)
 					result = primary;
 				else
 					result = secondary;
@@ -612,7 +805,7 @@ CNetworkSymbol* CNetworkEntityContainer::GetPrimarySelected()
 
 		for (INT_PTR t = 0; t < max; t++)
 		{
-			CNetworkSymbol* obj = dynamic_cast<CNetworkSymbol*>(GetAt(t));
+			CNetworkSymbol* obj = CNetworkSymbol::Cast(GetAt(t));
 			if (obj && obj->IsSelected())
 			{
 				if (result == NULL)
@@ -649,7 +842,7 @@ CNetworkSymbol* CNetworkEntityContainer::GetSecondarySelected()
 
 		for (INT_PTR t = 0; t < max; t++)
 		{
-			CNetworkSymbol* obj = dynamic_cast<CNetworkSymbol*>(GetAt(t));
+			CNetworkSymbol* obj = CNetworkSymbol::Cast(GetAt(t));
 			if (obj && obj->IsSelected())
 				result = obj;
 		}
@@ -678,7 +871,7 @@ int	CNetworkEntityContainer::GetSelectCount()
 
 	for (INT_PTR t = 0; t < max; t++)
 	{
-		CNetworkSymbol* obj = dynamic_cast<CNetworkSymbol*>(GetAt(t));
+		CNetworkSymbol* obj = CNetworkSymbol::Cast(GetAt(t));
 
 		if (obj && obj->IsSelected())
 			count++;
@@ -727,8 +920,8 @@ BOOL CNetworkEntityContainer::CreateLink(CNetworkSymbol* from, CNetworkSymbol* t
 
 		CNetworkLink* link = new CNetworkLink;
 
-		link->from = from->GetName();
-		link->to = to->GetName();
+		link->from = from->GetID();
+		link->to = to->GetID();
 
 		m_links.Add(link);
 		result = TRUE;
@@ -765,3 +958,107 @@ void CNetworkEntityContainer::DeleteLink(CNetworkLink* inlink)
 
 }
 
+void CNetworkEntityContainer::AutoLayout()
+/* ============================================================
+	Function :		CNetworkEntityContainer::AutoLayout
+	Description :	Arranges the symbols with a force-directed
+					layout over the links.
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Call to tidy up a network diagram. Symbols
+					the user has moved since the last auto
+					layout are pinned, so calling this again
+					only arranges the rest around them. Pinned
+					symbols are never moved.
+
+   ============================================================*/
+{
+
+	CForceLayout layout;
+	CMapPtrToPtr indices;
+	CObArray nodes;
+	INT_PTR count = GetSize();
+	for (INT_PTR t = 0; t < count; t++)
+	{
+		CNetworkSymbol* obj = CNetworkSymbol::Cast(GetAt(t));
+		if (obj)
+		{
+			indices.SetAt(obj, reinterpret_cast<void*>(nodes.Add(obj)));
+			layout.AddNode(obj->GetLeft(), obj->GetTop(), obj->GetRight() - obj->GetLeft(), obj->GetBottom() - obj->GetTop(), obj->IsPlacedByHand());
+		}
+	}
+
+	INT_PTR size = nodes.GetSize();
+	if (size == 0)
+		return;
+
+	INT_PTR max = m_links.GetSize();
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		CNetworkLink* link = static_cast<CNetworkLink*>(m_links.GetAt(t));
+		void* from = NULL;
+		void* to = NULL;
+		if (indices.Lookup(GetObjectByID(link->from), from) && indices.Lookup(GetObjectByID(link->to), to))
+			layout.AddEdge(static_cast<int>(reinterpret_cast<INT_PTR>(from)), static_cast<int>(reinterpret_cast<INT_PTR>(to)));
+	}
+
+	layout.Layout();
+
+	// Keep the free symbols on the page. The pinned symbols are
+	// already where the user put them
+	CPoint offset(0, 0);
+	CArray< CRect, CRect& > pinned;
+	for (INT_PTR t = 0; t < size; t++)
+	{
+		CNetworkSymbol* obj = static_cast<CNetworkSymbol*>(nodes[t]);
+		if (obj->IsPlacedByHand())
+		{
+			CRect rect(round(obj->GetLeft()), round(obj->GetTop()), round(obj->GetRight()), round(obj->GetBottom()));
+			rect.NormalizeRect();
+			pinned.Add(rect);
+		}
+		else
+		{
+			CPoint pos = layout.GetNodePosition(static_cast<int>(t));
+			offset.x = min(offset.x, pos.x);
+			offset.y = min(offset.y, pos.y);
+		}
+	}
+
+	INT_PTR pinnedCount = pinned.GetSize();
+	for (INT_PTR t = 0; t < size; t++)
+	{
+		CNetworkSymbol* obj = static_cast<CNetworkSymbol*>(nodes[t]);
+		if (obj->IsPlacedByHand())
+			continue;
+
+		CPoint pos = layout.GetNodePosition(static_cast<int>(t));
+		pos.Offset(-offset.x, -offset.y);
+
+		// Moving onto the page can put the symbol on top of a
+		// pinned one, move it down below it. Every move passes
+		// a pinned symbol, so this ends.
+		CRect rect(pos, CSize(round(fabs(obj->GetRight() - obj->GetLeft())), round(fabs(obj->GetBottom() - obj->GetTop()))));
+		BOOL moved = TRUE;
+		while (moved)
+		{
+			moved = FALSE;
+			for (INT_PTR p = 0; p < pinnedCount; p++)
+			{
+				CRect overlap;
+				if (overlap.IntersectRect(rect, pinned[p]))
+				{
+					rect.OffsetRect(0, pinned[p].bottom + AUTOLAYOUT_SPACING - rect.top);
+					moved = TRUE;
+				}
+			}
+		}
+
+		pos = rect.TopLeft();
+		obj->MoveRect(pos.x - obj->GetLeft(), pos.y - obj->GetTop());
+		obj->SetLayoutPosition(pos);
+	}
+
+}
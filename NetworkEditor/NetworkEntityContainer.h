@@ -31,8 +31,12 @@ public:
 	BOOL CanLink();
 	BOOL IsLinked();
 
+	// Layout
+	void AutoLayout();
+
 	// Overrides
-	virtual void	RemoveAt(int index);
+	virtual void	RemoveAt(INT_PTR index);
+	virtual INT_PTR	RemoveIf(ENTITYPREDICATE predicate, LPVOID data = NULL);
 	virtual void	Undo();
 	virtual void	Snapshot();
 	virtual void	ClearUndo();
@@ -41,11 +45,20 @@ public:
 	void			PushLinks(CObArray* stack);
 	virtual void	ClearRedo();
 
+	virtual void	GetMemoryUsage(CDiagramMemoryUsage& usage) const;
+	virtual void	PrepareRender(double zoom);
+	virtual void	RenderRect(CDiagramRenderer* renderer, const CRect& rect, double zoom);
+
 private:
 	CObArray	m_links;
 	CObArray	m_redoLinks;
 	CObArray	m_undoLinks;
 
+	// Rendering, set by "PrepareRender"
+	CArray< CPoint, CPoint >	m_renderStart;	// Ends of the links with both symbols
+	CArray< CPoint, CPoint >	m_renderEnd;
+	CBoundsArray				m_renderBounds;
+
 	// Private helpers
 	void ClearLinks();
 
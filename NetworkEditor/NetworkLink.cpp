@@ -11,12 +11,15 @@
 					loading and saving modellen on those of CDiagramEntity.
 
 	Usage :			Instances of this class are managed by
-					CNetworkEntityContainer.
+					CNetworkEntityContainer. The objects are kept as
+					numeric ids, see CLinkFactory, and only converted
+					to names when saved and read.
 
    ========================================================================*/
 #include "stdafx.h"
 #include "NetworkLink.h"
 #include "../DiagramEditor/Tokenizer.h"
+#include "../DiagramEditor/DiagramMemoryUsage.h"
 
 #ifdef _DEBUG
 #define new DEBUG_NEW
@@ -37,6 +40,10 @@ CNetworkLink::CNetworkLink()
 
    ============================================================*/
 {
+
+	from = LINK_ID_NONE;
+	to = LINK_ID_NONE;
+
 }
 
 CNetworkLink::~CNetworkLink()
@@ -75,6 +82,26 @@ CNetworkLink* CNetworkLink::Clone() const
 
 }
 
+void CNetworkLink::GetMemoryUsage(CDiagramMemoryUsage& usage) const
+/* ============================================================
+	Function :		CNetworkLink::GetMemoryUsage
+	Description :	Adds the memory held by the link to
+					"usage".
+
+	Return :		void
+	Parameters :	CDiagramMemoryUsage& usage	-	Breakdown
+													to add to.
+
+	Usage :			Called by the container. The slot of the
+					link in its array is counted by the caller.
+
+   ============================================================*/
+{
+
+	usage.Add(_T("Links"), _T("Network links"), 1, sizeof(CNetworkLink));
+
+}
+
 CString CNetworkLink::GetString() const
 /* ============================================================
 	Function :		CNetworkLink::GetString
@@ -90,7 +117,7 @@ CString CNetworkLink::GetString() const
 {
 
 	CString str;
-	str.Format(_T("network_link:%s,%s;"), from.GetString(), to.GetString());
+	str.Format(_T("network_link:%s,%s;"), CLinkFactory::ToString(from).GetString(), CLinkFactory::ToString(to).GetString());
 	return str;
 
 }
@@ -136,8 +163,8 @@ BOOL CNetworkLink::FromString(const CString& str)
 				tok.GetAt(0, readfrom);
 				tok.GetAt(1, readto);
 
-				from = readfrom;
-				to = readto;
+				from = CLinkFactory::ToID(readfrom);
+				to = CLinkFactory::ToID(readto);
 
 				result = TRUE;
 			}
@@ -1,6 +1,10 @@
 #ifndef _NETWORKLINK_H_
 #define _NETWORKLINK_H_
 
+#include "../UMLEditor/LinkFactory.h"
+
+class CDiagramMemoryUsage;
+
 class CNetworkLink : public CObject
 {
 public:
@@ -11,10 +15,11 @@ public:
 	virtual CString GetString() const;
 	virtual CNetworkLink* Clone() const;
 	virtual BOOL FromString(const CString& str);
+	void GetMemoryUsage(CDiagramMemoryUsage& usage) const;
 
 	// Data
-	CString	from;		// Name of the attached from-object.
-	CString	to;			// Name of the attached to-object, if any.
+	ULONGLONG	from;	// Id of the attached from-object.
+	ULONGLONG	to;		// Id of the attached to-object, "LINK_ID_NONE" if none.
 };
 
 #endif //_NETWORKLINK_H_
\ No newline at end of file
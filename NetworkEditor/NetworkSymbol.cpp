@@ -17,6 +17,7 @@
    ========================================================================*/
 #include "stdafx.h"
 #include "NetworkSymbol.h"
+#include "../DiagramEditor/DiagramRenderer.h"
 #include "../UMLEditor/LinkFactory.h"
 #include "../DiagramEditor/Tokenizer.h"
 
@@ -43,8 +44,10 @@ CNetworkSymbol::CNetworkSymbol(UINT resid)
 	m_symbol = resid;
 	SetConstraints(CSize(32, 44), CSize(-1, -1));
 	SetType(_T("network_symbol"));
+	AddKind(KIND_NETWORK_SYMBOL);
 	SetTitle(_T("title"));
 	SetName(CLinkFactory::GetID());
+	m_layoutValid = FALSE;
 
 	SetMarkerSize(CSize(6, 6));
 	SetPropertyDialog(&m_dlg, CPropertyDialog::IDD);
@@ -122,6 +125,8 @@ void CNetworkSymbol::Copy(CDiagramEntity* obj)
 
 	CDiagramEntity::Copy(obj);
 	m_symbol = static_cast<CNetworkSymbol*>(obj)->m_symbol;
+	m_layoutPosition = static_cast<CNetworkSymbol*>(obj)->m_layoutPosition;
+	m_layoutValid = static_cast<CNetworkSymbol*>(obj)->m_layoutValid;
 
 }
 
@@ -158,62 +163,70 @@ CDiagramEntity* CNetworkSymbol::CreateFromString(const CString& str)
 
 }
 
-void CNetworkSymbol::Draw(CDC* dc, CRect rect)
+CNetworkSymbol* CNetworkSymbol::Cast(CDiagramEntity* obj)
 /* ============================================================
-	Function :		CNetworkSymbol::Draw
+	Function :		CNetworkSymbol::Cast
+	Description :	Casts "obj" to a "CNetworkSymbol" pointer,
+					using the kind tag instead of RTTI.
+	Access :		Public
+
+	Return :		CNetworkSymbol*	-	"obj", or "NULL" if "obj" is
+						not a network symbol.
+	Parameters :	CDiagramEntity* obj	-	Object to cast.
+
+	Usage :			Use instead of "dynamic_cast" in loops over
+					the container data.
+
+   ============================================================*/
+{
+
+	if (obj && obj->IsKind(KIND_NETWORK_SYMBOL))
+		return static_cast<CNetworkSymbol*>(obj);
+
+	return NULL;
+
+}
+
+void CNetworkSymbol::Render(CDiagramRenderer* renderer, CRect rect)
+/* ============================================================
+	Function :		CNetworkSymbol::Render
 	Description :	Draws the object.
 
 	Return :		void
-	Parameters :	CDC* dc		-	The CDC to draw to.
-					CRect rect	-	The real rectangle of the
-									object.
+	Parameters :	CDiagramRenderer* renderer	-	The renderer to
+													draw with.
+					CRect rect					-	The real rectangle
+													of the object.
 
-	Usage :			The function should clean up all selected
-					objects. Note that the CDC is a memory CDC,
-					so creating a memory CDC in this function
-					will probably not speed up the function.
+	Usage :			The symbol bitmap is drawn above the title.
 
    ============================================================*/
 {
 	ASSERT(m_symbol);
 
-	dc->SelectStockObject(BLACK_PEN);
-	dc->SelectStockObject(WHITE_BRUSH);
-
-	CDC memDC;
-	memDC.CreateCompatibleDC(dc);
-	HBITMAP hbitmap = (HBITMAP)::LoadImage(AfxGetResourceHandle(),
-		MAKEINTRESOURCE(m_symbol == 0 ? 1 : m_symbol),
-		IMAGE_BITMAP,
-		0, 0,
-		LR_CREATEDIBSECTION
-	);
-
-	CBitmap* bitmap = CBitmap::FromHandle(hbitmap);
-	CBitmap* oldbitmap = memDC.SelectObject(bitmap);
+	renderer->SetPen(PS_SOLID, 0, RGB(0, 0, 0));
+	renderer->SetBrush(RGB(255, 255, 255));
 
-	dc->TransparentBlt(rect.left, rect.top, rect.Width(), rect.Height() - round(12 * GetZoom()), &memDC, 0, 0, 32, 32, RGB(230, 230, 230));
-	memDC.SelectObject(oldbitmap);
-	bitmap->DeleteObject();
+	CRect image(rect);
+	image.bottom -= round(12 * GetZoom());
+	renderer->DrawBitmap(m_symbol == 0 ? 1 : m_symbol, image, CSize(32, 32), RGB(230, 230, 230));
 
 	CRect r(rect);
 	r.top = r.bottom - round(12.0 * GetZoom());
-	CFont font;
-	font.CreateFont(-round(10.0 * GetZoom()), 0, 0, 0, FW_NORMAL, 0, 0, 0, 0, 0, 0, 0, 0, _T("Arial"));
-	dc->SelectObject(&font);
+	renderer->SetFont(_T("Arial"), -round(10.0 * GetZoom()));
 
-	COLORREF oldback = dc->GetBkColor();
-	COLORREF oldtext = dc->GetTextColor();
 	if (IsSelected())
 	{
-		dc->SetTextColor(RGB(255, 255, 255));
-		dc->SetBkColor(RGB(128, 128, 128));
+		renderer->SetTextColor(RGB(255, 255, 255));
+		renderer->SetBkColor(RGB(128, 128, 128));
+	}
+	else
+	{
+		renderer->SetTextColor(RGB(0, 0, 0));
+		renderer->SetBkColor(RGB(255, 255, 255));
 	}
 
-	dc->DrawText(GetTitle(), r, DT_NOPREFIX | DT_WORDBREAK | DT_CENTER);
-	dc->SelectStockObject(DEFAULT_GUI_FONT);
-	dc->SetTextColor(oldtext);
-	dc->SetBkColor(oldback);
+	renderer->DrawText(GetTitle(), r, DT_NOPREFIX | DT_WORDBREAK | DT_CENTER);
 
 }
 
@@ -373,3 +386,45 @@ void CNetworkSymbol::SetSymbol(UINT resid)
 	m_symbol = resid;
 
 }
+
+void CNetworkSymbol::SetLayoutPosition(CPoint position)
+/* ============================================================
+	Function :		CNetworkSymbol::SetLayoutPosition
+	Description :	Remembers where the last auto layout put
+					this object.
+
+	Return :		void
+	Parameters :	CPoint position	-	Top-left corner set by
+										the layout.
+
+	Usage :			Called by the auto layout. An object later
+					moved away from this position is taken to
+					be placed by hand.
+
+   ============================================================*/
+{
+
+	m_layoutPosition = position;
+	m_layoutValid = TRUE;
+
+}
+
+BOOL CNetworkSymbol::IsPlacedByHand() const
+/* ============================================================
+	Function :		CNetworkSymbol::IsPlacedByHand
+	Description :	Checks if the object was moved by the user
+					after the last auto layout.
+
+	Return :		BOOL	-	"TRUE" if moved by hand.
+	Parameters :	none
+
+	Usage :			Objects placed by hand are pinned by the
+					next auto layout. Objects never laid out
+					are free to move.
+
+   ============================================================*/
+{
+
+	return m_layoutValid && (m_layoutPosition.x != round(GetLeft()) || m_layoutPosition.y != round(GetTop()));
+
+}
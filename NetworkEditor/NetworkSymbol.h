@@ -4,19 +4,24 @@
 #include "../DiagramEditor/DiagramEntity.h"
 #include "PropertyDialog.h"
 
+#define KIND_NETWORK_SYMBOL	0x01000000
+
 class CNetworkSymbol : public CDiagramEntity
 {
+	DECLARE_ENTITY_SIZE(CNetworkSymbol)
+
 public:
 	CNetworkSymbol(UINT resid);
 	~CNetworkSymbol();
 
 	virtual CDiagramEntity* Clone();
 	static	CDiagramEntity* CreateFromString(const CString& str);
+	static	CNetworkSymbol* Cast(CDiagramEntity* obj);
 
 	// Overrides
 	virtual int		GetHitCode(CPoint point) const;
 	virtual CPoint	GetLinkPosition();
-	virtual void	Draw(CDC* dc, CRect rect);
+	virtual void	Render(CDiagramRenderer* renderer, CRect rect);
 	virtual void	Copy(CDiagramEntity* obj);
 	virtual void	DrawSelectionMarkers(CDC* dc, CRect rect) const;
 	virtual BOOL	FromString(const CString& str);
@@ -27,8 +32,14 @@ public:
 
 	virtual BOOL	AutoGenerateName() const;
 
+	// Layout
+	void			SetLayoutPosition(CPoint position);
+	BOOL			IsPlacedByHand() const;
+
 private:
 	UINT	m_symbol;
+	CPoint	m_layoutPosition;	// Position set by the last auto layout
+	BOOL	m_layoutValid;		// TRUE if "m_layoutPosition" is set
 
 	CPropertyDialog	m_dlg;
 
@@ -0,0 +1,1122 @@
+// EngineBenchmark.cpp : implementation of the CEngineBenchmark class
+//
+// Times the code shared by the editors that runs without windows or
+// documents, on generated input of each size:
+//
+//	layout		"layered" and "layered_1" lay out a graph of "size"
+//				nodes with the trials on all processors and on one
+//				thread, "force" runs the force directed layout.
+//	router		"route_all" routes a link between neighbouring boxes
+//				in a grid of "size" boxes, "route_move" moves one box
+//				and routes again, which only reroutes the links near
+//				it.
+//	header		"lex" and "parse" read a generated header of "size"
+//				classes.
+//	undo		"compress" and "decompress" run the undo compression
+//				on the same header.
+//	bounds		"bounds_rebuild" sets every rectangle, as when the
+//				array is rebuilt, "bounds_update" sets one for each
+//				of BENCHMARK_MOVES moves, "bounds_hit" finds the
+//				rectangles under BENCHMARK_HITS points.
+//	pool		"pool_alloc" and "heap_alloc" allocate and free
+//				"size" objects from an object pool and from the heap.
+//
+// "RunModels" times the diagram models on the diagrams of "CBenchmark",
+// in the suites "uml", "flowchart", "network" and "dialog":
+//
+//	"save" and "load" serialize the diagram to memory as its document
+//	does, "snapshot" and "clear_undo" fill and empty the undo stack,
+//	"hit_test_scan", "hit_test_bounds" and "move_hit_test" hit-test
+//	random points, "export" exports to a string array, "render" draws
+//	with the software renderer, "export_png_1", "export_png",
+//	"export_svg" and "export_pdf" export to files, "link_adjust" drags
+//	UML classes and "auto_layout" lays the diagram out.
+//
+// The lines are "suite,operation,size,iterations,total_ms,mean_us", as
+// from "CBenchmark". "Tulip.exe /benchmark" adds those of "Run" to its
+// results, and times the models itself, through the documents; the
+// portable "EngineBenchmark" writes both on their own.
+
+#include "stdafx.h"
+#include "EngineBenchmark.h"
+
+#include "../DiagramEditor/LayeredLayout.h"
+#include "../DiagramEditor/ForceLayout.h"
+#include "../DiagramEditor/LinkRouter.h"
+#include "../DiagramEditor/BoundsArray.h"
+#include "../DiagramEditor/ObjectPool.h"
+#include "../DiagramEditor/UndoSpill.h"
+#include "../UMLEditor/HeaderParser.h"
+#include "../DiagramEditor/RasterExport.h"
+#include "../DiagramEditor/VectorExport.h"
+#include "../DiagramEditor/DiagramRasterRenderer.h"
+#include "../UMLEditor/UMLEntityContainer.h"
+#include "../UMLEditor/UMLEntityPackage.h"
+#include "../UMLEditor/Attribute.h"
+#include "../UMLEditor/Operation.h"
+#include "../FlowchartEditor/FlowchartEntityContainer.h"
+#include "../FlowchartEditor/FlowchartControlFactory.h"
+#include "../FlowchartEditor/FlowchartEntityBox.h"
+#include "../FlowchartEditor/FlowchartEntityCondition.h"
+#include "../FlowchartEditor/FlowchartEntityTerminator.h"
+#include "../NetworkEditor/NetworkEntityContainer.h"
+#include "../NetworkEditor/NetworkControlFactory.h"
+#include "../DialogEditor/DiagramControlFactory.h"
+#include "../DialogEditor/DiagramButton.h"
+#include "../DialogEditor/DiagramCheckbox.h"
+#include "../DialogEditor/DiagramCombobox.h"
+#include "../DialogEditor/DiagramEdit.h"
+#include "../DialogEditor/DiagramListbox.h"
+#include "../DialogEditor/DiagramStatic.h"
+#include "../resource.h"
+
+#ifdef _DEBUG
+#define new DEBUG_NEW
+#endif
+
+#define BENCHMARK_REPEAT		5		// Runs of the short operations
+#define BENCHMARK_HITS			1000	// Hit-tested points
+#define BENCHMARK_MOVES			1000	// Rectangles moved in the bounds array
+#define BENCHMARK_ROUTE_MOVES	10		// Boxes moved between routings
+
+// Generated graphs
+#define GRAPH_EXTRA_EDGES		3		// Every third node gets a second parent
+#define GRAPH_WIDTH				120
+#define GRAPH_HEIGHT			60
+#define GRAPH_COLUMNS			20
+#define GRAPH_SPACING			40
+
+// Generated headers
+#define HEADER_MEMBERS			8		// Attributes and operations of each class
+#define HEADER_TEMPLATES		10		// Every tenth class is a template
+
+// Pooled objects
+#define POOL_OBJECT_SIZE		96		// About a "CAttribute"
+
+// Diagram models
+#define BENCHMARK_SNAPSHOTS		16		// Undo snapshots, twice the levels kept in memory
+#define BENCHMARK_ADJUSTS		100		// Classes moved for link adjustment
+#define BENCHMARK_RENDER_SIZE	4096	// Largest side of the rendered canvas
+
+// Generated UML diagrams
+#define UML_MEMBERS				8		// Attributes and operations of each class
+#define UML_CLASSES_PER_PACKAGE	100		// One package for each of these classes
+#define UML_COLUMNS				20		// Classes in each row, linked in a chain
+#define UML_SPACING				48		// Space between classes
+
+// Generated flowcharts
+#define FLOWCHART_CONDITION		5		// Every fifth step is a condition
+#define FLOWCHART_WIDTH			120
+#define FLOWCHART_HEIGHT		60
+#define FLOWCHART_SPACING		40
+
+// Generated network and dialog diagrams
+#define GRID_COLUMNS			20
+#define NETWORK_CELL			96
+#define DIALOG_WIDTH			100
+#define DIALOG_HEIGHT			24
+#define DIALOG_SPACING			8
+
+/////////////////////////////////////////////////////////////////////////////
+// CEngineBenchmark construction/destruction
+
+CEngineBenchmark::CEngineBenchmark()
+{
+	m_repeat = BENCHMARK_REPEAT;
+	m_seed = 1;
+	::QueryPerformanceFrequency(&m_frequency);
+	m_start.QuadPart = 0;
+	m_results = NULL;
+}
+
+CEngineBenchmark::~CEngineBenchmark()
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CEngineBenchmark operations
+
+// Runs all suites at each size, and adds the result lines to
+// "results".
+void CEngineBenchmark::Run(const CDWordArray& sizes, CStringArray& results)
+{
+	m_results = &results;
+
+	INT_PTR max = sizes.GetSize();
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		int size = static_cast<int>(sizes[t]);
+		m_seed = 1;
+		RunLayout(size);
+		RunRouter(size);
+		RunHeader(size);
+		RunCompression(size);
+		RunBounds(size);
+		RunPool(size);
+	}
+
+	m_results = NULL;
+}
+
+// Runs the diagram model suites at each size, and adds the result
+// lines to "results".
+void CEngineBenchmark::RunModels(const CDWordArray& sizes, CStringArray& results)
+{
+	m_results = &results;
+
+	INT_PTR max = sizes.GetSize();
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		int size = static_cast<int>(sizes[t]);
+		m_seed = 1;
+		RunUML(size);
+		RunFlowchart(size);
+		RunNetwork(size);
+		RunDialog(size);
+	}
+
+	m_results = NULL;
+}
+
+// Sets how many times the short operations are run.
+void CEngineBenchmark::SetRepeat(int repeat)
+{
+	m_repeat = max(1, repeat);
+}
+
+// Gets how many times the short operations are run.
+int CEngineBenchmark::GetRepeat() const
+{
+	return m_repeat;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CEngineBenchmark generators
+
+// Appends "count" classes, numbered from "first", to "text" as a c++
+// header. Each class has "members" attributes and operations, with
+// comments, default parameters and inline bodies, and derives from
+// the class before it. Every tenth class is a template.
+void CEngineBenchmark::GenerateHeader(CString& text, int first, int count, int members)
+{
+	for (int t = first; t < first + count; t++)
+	{
+		CString block;
+		block.Format(_T("/* ============================================================\n")
+			_T("\tClass :\t\tCClass%i\n")
+			_T("\tPurpose :\tGenerated for the header benchmark.\n")
+			_T("   ============================================================*/\n"), t + 1);
+		text += block;
+
+		if (t % HEADER_TEMPLATES == 0)
+			text += _T("template<class T, int size = 4>\n");
+
+		if (t == first)
+			block.Format(_T("class CClass%i\n{\npublic:\n"), t + 1);
+		else
+			block.Format(_T("class CClass%i : public CClass%i\n{\npublic:\n"), t + 1, t);
+		text += block;
+
+		block.Format(_T("\tCClass%i();\n\tvirtual ~CClass%i();\n\n\t// Accessors\n"), t + 1, t + 1);
+		text += block;
+
+		for (int i = 0; i < members; i++)
+		{
+			block.Format(_T("\tint\t\tGetValue%i() const { return m_value%i; }\t// Inline\n")
+				_T("\tvoid\tSetValue%i(int value = %i, const CString& name = _T(\"value\"));\n"),
+				i + 1, i + 1, i + 1, i);
+			text += block;
+		}
+
+		text += _T("\nprivate:\n");
+		for (int i = 0; i < members; i++)
+		{
+			block.Format(_T("\tint\t\tm_value%i;\n"), i + 1);
+			text += block;
+		}
+		text += _T("\tCString\tm_names[4];\n\n};\n\n");
+	}
+}
+
+// Creates "classes" classes with "members" attributes and operations
+// each. The classes are spread over the top level and "packages"
+// packages, in rows where each class is linked to the one before it.
+void CEngineBenchmark::GenerateUML(CUMLEntityContainer& objs, int classes, int members, int packages)
+{
+	objs.Clear();
+	objs.SetPackage(_T(""));
+
+	// Top level classes are placed below the packages
+	int top = 0;
+	CStringArray names;
+	names.Add(_T(""));
+	for (int t = 0; t < packages; t++)
+	{
+		CUMLEntityPackage* package = new CUMLEntityPackage;
+		CString title;
+		title.Format(_T("Package%i"), t + 1);
+		package->SetTitle(title);
+		objs.Add(package);
+
+		CSize size = package->GetDefaultSize();
+		int left = t * (size.cx + UML_SPACING);
+		package->SetRect(left, 0, left + size.cx, size.cy);
+		names.Add(package->GetName());
+		top = size.cy + UML_SPACING;
+	}
+
+	INT_PTR count = names.GetSize();
+	CArray< int, int > placed;
+	CObArray last;
+	placed.SetSize(count);
+	last.SetSize(count);
+	for (int t = 0; t < classes; t++)
+	{
+		int package = t % count;
+		int index = placed[package]++;
+
+		CUMLEntityClass* obj = new CUMLEntityClass;
+		CString title;
+		title.Format(_T("CClass%i"), t + 1);
+		obj->SetTitle(title);
+		obj->SetPackage(names[package]);
+		for (int i = 0; i < members; i++)
+		{
+			CAttribute* attribute = new CAttribute;
+			attribute->access = ACCESS_TYPE_PRIVATE;
+			attribute->name.Format(_T("m_value%i"), i + 1);
+			attribute->type = _T("int");
+			obj->AddAttribute(attribute);
+
+			COperation* operation = new COperation;
+			operation->access = ACCESS_TYPE_PUBLIC;
+			operation->name.Format(_T("GetValue%i"), i + 1);
+			operation->type = _T("int");
+			obj->AddOperation(operation);
+		}
+
+		objs.Add(obj);
+		obj->CalcRestraints();
+
+		CSize size = obj->GetMinimumSize();
+		size.cx = max(size.cx, obj->GetDefaultSize().cx);
+		int left = (index % UML_COLUMNS) * (size.cx + UML_SPACING);
+		int y = (package ? 0 : top) + (index / UML_COLUMNS) * (size.cy + UML_SPACING);
+		obj->SetRect(left, y, left + size.cx, y + size.cy);
+
+		CUMLEntityClass* prev = static_cast<CUMLEntityClass*>(last[package]);
+		if (prev && index % UML_COLUMNS)
+		{
+			CRect from = prev->GetRect();
+			int middle = from.top + from.Height() / 2;
+
+			CUMLLineSegment* line = new CUMLLineSegment;
+			line->SetPackage(names[package]);
+			line->SetStyle(STYLE_ARROWHEAD);
+			line->SetLink(LINK_START, prev->GetID());
+			line->SetLinkType(LINK_START, LINK_RIGHT);
+			line->SetLink(LINK_END, obj->GetID());
+			line->SetLinkType(LINK_END, LINK_LEFT);
+			objs.Add(line);
+			line->SetRect(from.right, middle, left, middle);
+		}
+
+		last[package] = obj;
+	}
+
+	objs.ClearUndo();
+	objs.SetModified(FALSE);
+}
+
+// Creates a flowchart of "steps" steps in a column. Every fifth step
+// is a condition, with its "No" branch going through a box beside it.
+void CEngineBenchmark::GenerateFlowchart(CFlowchartEntityContainer& objs, int steps)
+{
+	objs.Clear();
+
+	CFlowchartEntity* prev = NULL;
+	BOOL condition = FALSE;
+	for (int t = 0; t < steps; t++)
+	{
+		CFlowchartEntity* obj;
+		if (t == 0)
+			obj = new CFlowchartEntityTerminator;
+		else if (t % FLOWCHART_CONDITION == 0)
+			obj = new CFlowchartEntityCondition;
+		else
+			obj = new CFlowchartEntityBox;
+
+		CString title;
+		title.Format(_T("Step %i"), t + 1);
+		obj->SetTitle(title);
+
+		int top = t * (FLOWCHART_HEIGHT + FLOWCHART_SPACING);
+		obj->SetRect(0, top, FLOWCHART_WIDTH, top + FLOWCHART_HEIGHT);
+		objs.Add(obj);
+
+		if (prev)
+		{
+			if (condition)
+			{
+				CFlowchartEntityBox* branch = new CFlowchartEntityBox;
+				CRect rect = prev->GetRect();
+				rect.OffsetRect(FLOWCHART_WIDTH + FLOWCHART_SPACING, 0);
+				branch->SetTitle(title + _T(" (no)"));
+				branch->SetRect(rect);
+				objs.Add(branch);
+
+				objs.CreateLink(prev, obj, _T("Yes"));
+				objs.CreateLink(prev, branch, _T("No"));
+				objs.CreateLink(branch, obj, _T(""));
+			}
+			else
+				objs.CreateLink(prev, obj, _T(""));
+		}
+
+		condition = (t && t % FLOWCHART_CONDITION == 0);
+		prev = obj;
+	}
+
+	objs.ClearUndo();
+	objs.SetModified(FALSE);
+}
+
+// Creates a network of "symbols" symbols in a grid, each linked to
+// the symbol to its left and every fourth to the symbol above.
+void CEngineBenchmark::GenerateNetwork(CNetworkEntityContainer& objs, int symbols)
+{
+	static const UINT resources[] = {
+		IDB_NET_BITMAP_SYMBOL_CLIENT,
+		IDB_NET_BITMAP_SYMBOL_SERVER,
+		IDB_NET_BITMAP_SYMBOL_HUB,
+		IDB_NET_BITMAP_SYMBOL_PRINTER
+	};
+
+	objs.Clear();
+
+	CObArray placed;
+	for (int t = 0; t < symbols; t++)
+	{
+		CNetworkSymbol* obj = new CNetworkSymbol(resources[t % _countof(resources)]);
+		CString title;
+		title.Format(_T("Node %i"), t + 1);
+		obj->SetTitle(title);
+
+		int left = (t % GRID_COLUMNS) * NETWORK_CELL;
+		int top = (t / GRID_COLUMNS) * NETWORK_CELL;
+		CSize size = obj->GetMinimumSize();
+		obj->SetRect(left, top, left + size.cx, top + size.cy);
+		objs.Add(obj);
+
+		if (t % GRID_COLUMNS)
+			objs.CreateLink(static_cast<CNetworkSymbol*>(placed[t - 1]), obj);
+		if (t >= GRID_COLUMNS && t % 4 == 0)
+			objs.CreateLink(static_cast<CNetworkSymbol*>(placed[t - GRID_COLUMNS]), obj);
+
+		placed.Add(obj);
+	}
+
+	objs.ClearUndo();
+	objs.SetModified(FALSE);
+}
+
+// Creates a dialog with "controls" controls of mixed types in a grid.
+void CEngineBenchmark::GenerateDialog(CDiagramEntityContainer& objs, int controls)
+{
+	objs.Clear();
+
+	for (int t = 0; t < controls; t++)
+	{
+		CDiagramEntity* obj;
+		switch (t % 6)
+		{
+		case 0:
+			obj = new CDiagramStatic;
+			break;
+		case 1:
+			obj = new CDiagramEdit;
+			break;
+		case 2:
+			obj = new CDiagramButton;
+			break;
+		case 3:
+			obj = new CDiagramCheckbox;
+			break;
+		case 4:
+			obj = new CDiagramCombobox;
+			break;
+		default:
+			obj = new CDiagramListbox;
+			break;
+		}
+
+		CString title;
+		title.Format(_T("Control %i"), t + 1);
+		obj->SetTitle(title);
+
+		int left = (t % GRID_COLUMNS) * (DIALOG_WIDTH + DIALOG_SPACING);
+		int top = (t / GRID_COLUMNS) * (DIALOG_HEIGHT + DIALOG_SPACING);
+		obj->SetRect(left, top, left + DIALOG_WIDTH, top + DIALOG_HEIGHT);
+		objs.Add(obj);
+	}
+
+	objs.ClearUndo();
+	objs.SetModified(FALSE);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CEngineBenchmark suites
+
+// Lays out a graph where each node hangs from a random earlier node,
+// and every third node from a second one, so that there are crossings
+// to reduce.
+void CEngineBenchmark::RunLayout(int size)
+{
+	LPCTSTR suite = _T("layout");
+	CArray< int, int > from;
+	CArray< int, int > to;
+	for (int t = 1; t < size; t++)
+	{
+		from.Add(Random(t));
+		to.Add(t);
+		if (t % GRAPH_EXTRA_EDGES == 0)
+		{
+			from.Add(Random(t));
+			to.Add(t);
+		}
+	}
+
+	INT_PTR edges = from.GetSize();
+	CLayeredLayout layered;
+	for (int t = 0; t < size; t++)
+		layered.AddNode(GRAPH_WIDTH, GRAPH_HEIGHT);
+	for (INT_PTR t = 0; t < edges; t++)
+		layered.AddEdge(from[t], to[t]);
+
+	StartTimer();
+	layered.Layout();
+	StopTimer(suite, _T("layered"), size, 1);
+
+	layered.SetThreadCount(1);
+	StartTimer();
+	layered.Layout();
+	StopTimer(suite, _T("layered_1"), size, 1);
+
+	// The force layout starts from a grid
+	CForceLayout force;
+	for (int t = 0; t < size; t++)
+	{
+		int x = (t % GRAPH_COLUMNS) * (GRAPH_WIDTH + GRAPH_SPACING);
+		int y = (t / GRAPH_COLUMNS) * (GRAPH_HEIGHT + GRAPH_SPACING);
+		force.AddNode(x, y, GRAPH_WIDTH, GRAPH_HEIGHT);
+	}
+	for (INT_PTR t = 0; t < edges; t++)
+		force.AddEdge(from[t], to[t]);
+
+	StartTimer();
+	force.Layout();
+	StopTimer(suite, _T("force"), size, force.GetIterationCount());
+}
+
+// Routes links between neighbouring boxes in a grid, then moves boxes
+// and routes again.
+void CEngineBenchmark::RunRouter(int size)
+{
+	LPCTSTR suite = _T("router");
+	CLinkRouter router;
+	CArray< CRect, CRect& > boxes;
+	for (int t = 0; t < size; t++)
+	{
+		int x = (t % GRAPH_COLUMNS) * (GRAPH_WIDTH + GRAPH_SPACING);
+		int y = (t / GRAPH_COLUMNS) * (GRAPH_HEIGHT + GRAPH_SPACING);
+		CRect rect(x, y, x + GRAPH_WIDTH, y + GRAPH_HEIGHT);
+		boxes.Add(rect);
+		router.AddObstacle(rect);
+	}
+
+	// Each box links to the one on its right, and to a random box
+	// in the row below, so some links have to go around boxes.
+	for (int t = 0; t < size; t++)
+	{
+		if ((t + 1) % GRAPH_COLUMNS != 0 && t + 1 < size)
+		{
+			int link = router.AddLink(t, t + 1);
+			router.SetLinkEnds(link, CPoint(boxes[t].right, boxes[t].CenterPoint().y), ROUTE_RIGHT,
+				CPoint(boxes[t + 1].left, boxes[t + 1].CenterPoint().y), ROUTE_LEFT);
+		}
+
+		int below = (t / GRAPH_COLUMNS + 1) * GRAPH_COLUMNS + Random(GRAPH_COLUMNS);
+		if (below < size)
+		{
+			int link = router.AddLink(t, below);
+			router.SetLinkEnds(link, CPoint(boxes[t].CenterPoint().x, boxes[t].bottom), ROUTE_BOTTOM,
+				CPoint(boxes[below].CenterPoint().x, boxes[below].top), ROUTE_TOP);
+		}
+	}
+
+	StartTimer();
+	int routed = router.Update();
+	StopTimer(suite, _T("route_all"), size, max(1, routed));
+
+	StartTimer();
+	for (int t = 0; t < BENCHMARK_ROUTE_MOVES; t++)
+	{
+		int box = Random(size);
+		CRect rect(boxes[box]);
+		rect.OffsetRect(GRAPH_SPACING / 4, GRAPH_SPACING / 4);
+		router.SetObstacle(box, rect);
+		router.Update();
+		router.SetObstacle(box, boxes[box]);
+		router.Update();
+	}
+	StopTimer(suite, _T("route_move"), size, BENCHMARK_ROUTE_MOVES * 2);
+}
+
+// Reads a generated header with the lexer and with the parser.
+void CEngineBenchmark::RunHeader(int size)
+{
+	LPCTSTR suite = _T("header");
+	CString text;
+	GenerateHeader(text, 0, size, HEADER_MEMBERS);
+
+	CHeaderLexer lexer;
+	StartTimer();
+	for (int t = 0; t < m_repeat; t++)
+		lexer.Tokenize(text, text.GetLength());
+	StopTimer(suite, _T("lex"), size, m_repeat);
+	lexer.Clear();
+
+	CHeaderParser parser;
+	StartTimer();
+	for (int t = 0; t < m_repeat; t++)
+		parser.Parse(text, text.GetLength());
+	StopTimer(suite, _T("parse"), size, m_repeat);
+}
+
+// Compresses a generated header as undo levels are compressed before
+// they are spilled to disk, and decompresses it again.
+void CEngineBenchmark::RunCompression(int size)
+{
+	LPCTSTR suite = _T("undo");
+	CString text;
+	GenerateHeader(text, 0, size, HEADER_MEMBERS);
+
+	// The header is ASCII, so the characters are the UTF-8 bytes
+	CByteArray raw;
+	raw.SetSize(text.GetLength());
+	for (int t = 0; t < text.GetLength(); t++)
+		raw[t] = static_cast<BYTE>(text[t]);
+	DWORD rawSize = static_cast<DWORD>(raw.GetSize());
+
+	CByteArray compressed;
+	StartTimer();
+	for (int t = 0; t < m_repeat; t++)
+		CUndoSpill::Compress(raw.GetData(), rawSize, compressed);
+	StopTimer(suite, _T("compress"), size, m_repeat);
+
+	CByteArray result;
+	result.SetSize(rawSize);
+	StartTimer();
+	for (int t = 0; t < m_repeat; t++)
+		CUndoSpill::Decompress(compressed.GetData(), static_cast<DWORD>(compressed.GetSize()), result.GetData(), rawSize);
+	StopTimer(suite, _T("decompress"), size, m_repeat);
+}
+
+// Compares setting every rectangle of the bounds array with setting
+// only the ones that moved, and hit-tests it.
+void CEngineBenchmark::RunBounds(int size)
+{
+	LPCTSTR suite = _T("bounds");
+	CArray< CRect, CRect& > boxes;
+	for (int t = 0; t < size; t++)
+	{
+		int x = (t % GRAPH_COLUMNS) * (GRAPH_WIDTH + GRAPH_SPACING);
+		int y = (t / GRAPH_COLUMNS) * (GRAPH_HEIGHT + GRAPH_SPACING);
+		CRect rect(x, y, x + GRAPH_WIDTH, y + GRAPH_HEIGHT);
+		boxes.Add(rect);
+	}
+
+	CBoundsArray bounds;
+	StartTimer();
+	for (int t = 0; t < m_repeat; t++)
+	{
+		bounds.SetSize(size);
+		for (int i = 0; i < size; i++)
+			bounds.SetAt(i, boxes[i].left, boxes[i].top, boxes[i].right, boxes[i].bottom);
+	}
+	StopTimer(suite, _T("bounds_rebuild"), size, m_repeat);
+
+	StartTimer();
+	for (int t = 0; t < BENCHMARK_MOVES; t++)
+	{
+		int i = Random(size);
+		CRect& rect = boxes[i];
+		rect.OffsetRect(1, 1);
+		bounds.SetAt(i, rect.left, rect.top, rect.right, rect.bottom);
+	}
+	StopTimer(suite, _T("bounds_update"), size, BENCHMARK_MOVES);
+
+	CDWordArray found;
+	int right = static_cast<int>(bounds.GetMax(BOUNDS_RIGHT, 0));
+	int bottom = static_cast<int>(bounds.GetMax(BOUNDS_BOTTOM, 0));
+	StartTimer();
+	for (int t = 0; t < BENCHMARK_HITS; t++)
+		bounds.GetContaining(Random(right + 1), Random(bottom + 1), found);
+	StopTimer(suite, _T("bounds_hit"), size, BENCHMARK_HITS);
+}
+
+// Allocates and frees "size" objects from a pool and from the heap.
+void CEngineBenchmark::RunPool(int size)
+{
+	LPCTSTR suite = _T("pool");
+	CPtrArray objects;
+	objects.SetSize(size);
+
+	CObjectPool pool(POOL_OBJECT_SIZE);
+	StartTimer();
+	for (int t = 0; t < m_repeat; t++)
+	{
+		for (int i = 0; i < size; i++)
+			objects[i] = pool.Alloc(POOL_OBJECT_SIZE);
+		for (int i = 0; i < size; i++)
+			pool.Free(objects[i], POOL_OBJECT_SIZE);
+	}
+	StopTimer(suite, _T("pool_alloc"), size, m_repeat);
+
+	StartTimer();
+	for (int t = 0; t < m_repeat; t++)
+	{
+		for (int i = 0; i < size; i++)
+			objects[i] = new BYTE[POOL_OBJECT_SIZE];
+		for (int i = 0; i < size; i++)
+			delete[] static_cast<BYTE*>(objects[i]);
+	}
+	StopTimer(suite, _T("heap_alloc"), size, m_repeat);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CEngineBenchmark diagram model suites
+
+// UML diagrams, with link adjustment and layered layout.
+void CEngineBenchmark::RunUML(int size)
+{
+	LPCTSTR suite = _T("uml");
+	CUMLEntityContainer objs;
+	CUMLEntityContainer copy;
+	GenerateUML(objs, size, UML_MEMBERS, size / UML_CLASSES_PER_PACKAGE);
+
+	TimeSerialize(suite, &objs, &copy, SaveUML, LoadUML, size);
+	TimeSnapshot(suite, &objs, size);
+	TimeHitTest(suite, &objs, size);
+	TimeExport(suite, &objs, EXPORT_HTML, size);
+	TimeRender(suite, &objs, size);
+
+	// Drag classes at the top level vertically, so their lines get bends
+	CObArray moved;
+	INT_PTR max = objs.GetSize();
+	for (INT_PTR t = 0; t < max && moved.GetSize() < BENCHMARK_ADJUSTS; t++)
+	{
+		CUMLEntityClass* obj = dynamic_cast<CUMLEntityClass*>(objs.GetObjectAt(t));
+		if (obj && obj->GetPackage().IsEmpty())
+			moved.Add(obj);
+	}
+
+	int adjusts = static_cast<int>(moved.GetSize());
+	StartTimer();
+	for (int t = 0; t < adjusts; t++)
+	{
+		CUMLEntity* obj = static_cast<CUMLEntity*>(moved[t]);
+		obj->MoveRect(0, UML_SPACING / 2);
+		objs.AdjustLinkedObjects(obj);
+	}
+	StopTimer(suite, _T("link_adjust"), size, adjusts);
+
+	StartTimer();
+	objs.AutoLayout();
+	StopTimer(suite, _T("auto_layout"), size, 1);
+}
+
+// Flowcharts, with layered layout.
+void CEngineBenchmark::RunFlowchart(int size)
+{
+	LPCTSTR suite = _T("flowchart");
+	CFlowchartEntityContainer objs;
+	CFlowchartEntityContainer copy;
+	GenerateFlowchart(objs, size);
+
+	TimeSerialize(suite, &objs, &copy, SaveFlowchart, LoadFlowchart, size);
+	TimeSnapshot(suite, &objs, size);
+	TimeHitTest(suite, &objs, size);
+	TimeExport(suite, &objs, 0, size);
+	TimeRender(suite, &objs, size);
+
+	StartTimer();
+	objs.AutoLayout();
+	StopTimer(suite, _T("auto_layout"), size, 1);
+}
+
+// Network diagrams, with force directed layout.
+void CEngineBenchmark::RunNetwork(int size)
+{
+	LPCTSTR suite = _T("network");
+	CNetworkEntityContainer objs;
+	CNetworkEntityContainer copy;
+	GenerateNetwork(objs, size);
+
+	TimeSerialize(suite, &objs, &copy, SaveNetwork, LoadNetwork, size);
+	TimeSnapshot(suite, &objs, size);
+	TimeHitTest(suite, &objs, size);
+	TimeExport(suite, &objs, 0, size);
+	TimeRender(suite, &objs, size);
+
+	StartTimer();
+	objs.AutoLayout();
+	StopTimer(suite, _T("auto_layout"), size, 1);
+}
+
+// Dialog templates.
+void CEngineBenchmark::RunDialog(int size)
+{
+	LPCTSTR suite = _T("dialog");
+	CDiagramEntityContainer objs;
+	CDiagramEntityContainer copy;
+	GenerateDialog(objs, size);
+
+	TimeSerialize(suite, &objs, &copy, SaveDialog, LoadDialog, size);
+	TimeSnapshot(suite, &objs, size);
+	TimeHitTest(suite, &objs, size);
+	TimeExport(suite, &objs, 0, size);
+	TimeRender(suite, &objs, size);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CEngineBenchmark common operations
+
+// Saves "objs" to memory with "save", then loads the result into
+// "copy" with "load".
+void CEngineBenchmark::TimeSerialize(LPCTSTR suite, CDiagramEntityContainer* objs, CDiagramEntityContainer* copy, BENCHMARKSERIALIZE save, BENCHMARKSERIALIZE load, int size)
+{
+	CMemFile file;
+
+	StartTimer();
+	for (int t = 0; t < m_repeat; t++)
+	{
+		file.SetLength(0);
+		CArchive ar(&file, CArchive::store);
+		save(objs, ar);
+		ar.Close();
+	}
+	StopTimer(suite, _T("save"), size, m_repeat);
+
+	StartTimer();
+	for (int t = 0; t < m_repeat; t++)
+	{
+		file.SeekToBegin();
+		CArchive ar(&file, CArchive::load);
+		load(copy, ar);
+		ar.Close();
+	}
+	StopTimer(suite, _T("load"), size, m_repeat);
+}
+
+// Takes undo snapshots, more than are kept in memory.
+void CEngineBenchmark::TimeSnapshot(LPCTSTR suite, CDiagramEntityContainer* objs, int size)
+{
+	StartTimer();
+	for (int t = 0; t < BENCHMARK_SNAPSHOTS; t++)
+		objs->Snapshot();
+	StopTimer(suite, _T("snapshot"), size, BENCHMARK_SNAPSHOTS);
+
+	StartTimer();
+	objs->ClearUndo();
+	StopTimer(suite, _T("clear_undo"), size, 1);
+}
+
+// Hit-tests random points, first by testing every object as the
+// editor does on a click, then through the bounds array.
+void CEngineBenchmark::TimeHitTest(LPCTSTR suite, CDiagramEntityContainer* objs, int size)
+{
+	const CBoundsArray* bounds = objs->GetBounds();
+	int right = static_cast<int>(bounds->GetMax(BOUNDS_RIGHT, 0)) + 1;
+	int bottom = static_cast<int>(bounds->GetMax(BOUNDS_BOTTOM, 0)) + 1;
+
+	CArray< CPoint, CPoint > points;
+	points.SetSize(BENCHMARK_HITS);
+	for (int t = 0; t < BENCHMARK_HITS; t++)
+		points[t] = CPoint(Random(right), Random(bottom));
+
+	StartTimer();
+	for (int t = 0; t < BENCHMARK_HITS; t++)
+	{
+		int count = 0;
+		CDiagramEntity* obj;
+		while ((obj = objs->GetAt(count++)))
+		{
+			if (obj->GetHitCode(points[t]) == DEHT_BODY)
+				break;
+		}
+	}
+	StopTimer(suite, _T("hit_test_scan"), size, BENCHMARK_HITS);
+
+	CDWordArray indices;
+	StartTimer();
+	for (int t = 0; t < BENCHMARK_HITS; t++)
+	{
+		bounds = objs->GetBounds();
+		INT_PTR max = bounds->GetContaining(points[t].x, points[t].y, indices);
+		for (INT_PTR i = 0; i < max; i++)
+		{
+			CDiagramEntity* obj = objs->GetAt(indices[i]);
+			if (obj && obj->GetHitCode(points[t]) == DEHT_BODY)
+				break;
+		}
+	}
+	StopTimer(suite, _T("hit_test_bounds"), size, BENCHMARK_HITS);
+
+	// Nudges, each followed by a hit-test, as when dragging. Each
+	// object is moved and moved back.
+	INT_PTR count = objs->GetSize();
+	StartTimer();
+	for (int t = 0; t < BENCHMARK_HITS && count; t++)
+	{
+		CDiagramEntity* obj = objs->GetAt((t / 2) % count);
+		obj->MoveRect(t % 2 ? -1 : 1, 0);
+		objs->SetModified(TRUE);
+
+		bounds = objs->GetBounds();
+		INT_PTR max = bounds->GetContaining(points[t].x, points[t].y, indices);
+		for (INT_PTR i = 0; i < max; i++)
+		{
+			CDiagramEntity* hit = objs->GetAt(indices[i]);
+			if (hit && hit->GetHitCode(points[t]) == DEHT_BODY)
+				break;
+		}
+	}
+	StopTimer(suite, _T("move_hit_test"), size, BENCHMARK_HITS);
+}
+
+// Exports the diagram to a string array.
+void CEngineBenchmark::TimeExport(LPCTSTR suite, CDiagramEntityContainer* objs, UINT format, int size)
+{
+	StartTimer();
+	for (int t = 0; t < m_repeat; t++)
+	{
+		CStringArray stra;
+		objs->Export(stra, format);
+	}
+	StopTimer(suite, _T("export"), size, m_repeat);
+}
+
+// Draws the diagram with the software renderer, scaled down so the
+// canvas is at most "BENCHMARK_RENDER_SIZE" on its longest side. Then
+// exports it at full size in tiles, on one thread and on one thread
+// per processor, and to SVG and PDF. The tiles are drawn with the
+// software renderer too, so the times are the same everywhere.
+void CEngineBenchmark::TimeRender(LPCTSTR suite, CDiagramEntityContainer* objs, int size)
+{
+	const CBoundsArray* bounds = objs->GetBounds();
+	double right = bounds->GetMax(BOUNDS_RIGHT, 0) + 1.0;
+	double bottom = bounds->GetMax(BOUNDS_BOTTOM, 0) + 1.0;
+	double zoom = min(1.0, BENCHMARK_RENDER_SIZE / max(right, bottom));
+
+	CDiagramRasterRenderer renderer;
+	if (!renderer.Create(static_cast<int>(right * zoom) + 1, static_cast<int>(bottom * zoom) + 1, objs->GetColor()))
+		return;
+
+	StartTimer();
+	for (int t = 0; t < m_repeat; t++)
+	{
+		renderer.Clear(objs->GetColor());
+		renderer.Reset();
+		objs->RenderObjects(&renderer, zoom);
+	}
+	StopTimer(suite, _T("render"), size, m_repeat);
+
+	TCHAR path[MAX_PATH];
+	TCHAR filename[MAX_PATH];
+	if (!::GetTempPath(MAX_PATH, path) || !::GetTempFileName(path, _T("tlp"), 0, filename))
+		return;
+
+	CSize full(static_cast<int>(right), static_cast<int>(bottom));
+	CRasterExport tiled;
+	tiled.SetSoftware(TRUE);
+	tiled.SetThreadCount(1);
+	StartTimer();
+	tiled.Export(objs, filename, full, 1.0, RGB(255, 255, 255));
+	StopTimer(suite, _T("export_png_1"), size, 1);
+
+	tiled.SetThreadCount(0);
+	StartTimer();
+	tiled.Export(objs, filename, full, 1.0, RGB(255, 255, 255));
+	StopTimer(suite, _T("export_png"), size, 1);
+
+	CVectorExport vector;
+	StartTimer();
+	vector.ExportSVG(objs, filename, full, 1.0, RGB(255, 255, 255));
+	StopTimer(suite, _T("export_svg"), size, 1);
+
+	StartTimer();
+	vector.ExportPDF(objs, filename, full, 1.0);
+	StopTimer(suite, _T("export_pdf"), size, 1);
+
+	::DeleteFile(filename);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CEngineBenchmark serialization
+
+// Saves a UML diagram, as "CUmlDoc::Serialize".
+void CEngineBenchmark::SaveUML(CDiagramEntityContainer* objs, CArchive& ar)
+{
+	static_cast<CUMLEntityContainer*>(objs)->Save(ar);
+}
+
+// Loads a UML diagram, as "CUmlDoc::Serialize".
+void CEngineBenchmark::LoadUML(CDiagramEntityContainer* objs, CArchive& ar)
+{
+	static_cast<CUMLEntityContainer*>(objs)->Load(ar);
+}
+
+// Saves a flowchart, as "CFlowchartDoc::Serialize".
+void CEngineBenchmark::SaveFlowchart(CDiagramEntityContainer* objs, CArchive& ar)
+{
+	CFlowchartEntityContainer* flowchart = static_cast<CFlowchartEntityContainer*>(objs);
+	SaveDialog(objs, ar);
+
+	INT_PTR max = flowchart->GetLinks();
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		CFlowchartLink* link = flowchart->GetLinkAt(t);
+		if (link)
+			ar.WriteString(link->GetString() + _T("\r\n"));
+	}
+}
+
+// Loads a flowchart, as "CFlowchartDoc::Serialize".
+void CEngineBenchmark::LoadFlowchart(CDiagramEntityContainer* objs, CArchive& ar)
+{
+	CFlowchartEntityContainer* flowchart = static_cast<CFlowchartEntityContainer*>(objs);
+	flowchart->Clear();
+	CString str;
+	while (ar.ReadString(str))
+	{
+		if (!flowchart->FromString(str))
+		{
+			CDiagramEntity* obj = CFlowchartControlFactory::CreateFromString(str);
+			if (obj)
+				flowchart->Add(obj);
+			else
+			{
+				CFlowchartLink* link = new CFlowchartLink;
+				if (link->FromString(str))
+					flowchart->AddLink(link);
+				else
+					delete link;
+			}
+		}
+	}
+
+	flowchart->SetModified(TRUE);
+}
+
+// Saves a network diagram, as "CNetDoc::Serialize".
+void CEngineBenchmark::SaveNetwork(CDiagramEntityContainer* objs, CArchive& ar)
+{
+	CNetworkEntityContainer* network = static_cast<CNetworkEntityContainer*>(objs);
+	SaveDialog(objs, ar);
+
+	INT_PTR max = network->GetLinks();
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		CNetworkLink* link = network->GetLinkAt(t);
+		if (link)
+			ar.WriteString(link->GetString() + _T("\r\n"));
+	}
+}
+
+// Loads a network diagram, as "CNetDoc::Serialize".
+void CEngineBenchmark::LoadNetwork(CDiagramEntityContainer* objs, CArchive& ar)
+{
+	CNetworkEntityContainer* network = static_cast<CNetworkEntityContainer*>(objs);
+	network->Clear();
+	CString str;
+	while (ar.ReadString(str))
+	{
+		if (!network->FromString(str))
+		{
+			CDiagramEntity* obj = CNetworkControlFactory::CreateFromString(str);
+			if (obj)
+				network->Add(obj);
+			else
+			{
+				CNetworkLink* link = new CNetworkLink;
+				if (link->FromString(str))
+					network->AddLink(link);
+				else
+					delete link;
+			}
+		}
+	}
+
+	network->SetModified(TRUE);
+}
+
+// Saves a dialog template, as "CDialogEditorDoc::Serialize". The
+// objects of the other diagrams are saved the same way.
+void CEngineBenchmark::SaveDialog(CDiagramEntityContainer* objs, CArchive& ar)
+{
+	ar.WriteString(objs->GetString() + _T("\r\n"));
+	int count = 0;
+	CDiagramEntity* obj;
+	while ((obj = objs->GetAt(count++)))
+		ar.WriteString(obj->GetString() + _T("\r\n"));
+}
+
+// Loads a dialog template, as "CDialogEditorDoc::Serialize".
+void CEngineBenchmark::LoadDialog(CDiagramEntityContainer* objs, CArchive& ar)
+{
+	objs->Clear();
+	CString str;
+	while (ar.ReadString(str))
+	{
+		if (!objs->FromString(str))
+		{
+			CDiagramEntity* obj = CDiagramControlFactory::CreateFromString(str);
+			if (obj)
+				objs->Add(obj);
+		}
+	}
+
+	objs->SetModified(TRUE);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CEngineBenchmark timing
+
+// Starts timing an operation.
+void CEngineBenchmark::StartTimer()
+{
+	::QueryPerformanceCounter(&m_start);
+}
+
+// Stops timing an operation, and adds a result line.
+void CEngineBenchmark::StopTimer(LPCTSTR suite, LPCTSTR operation, int size, int iterations)
+{
+	LARGE_INTEGER stop;
+	::QueryPerformanceCounter(&stop);
+
+	double total = static_cast<double>(stop.QuadPart - m_start.QuadPart) * 1000.0 / static_cast<double>(m_frequency.QuadPart);
+	double mean = iterations ? total * 1000.0 / iterations : 0.0;
+
+	CString line;
+	line.Format(_T("%s,%s,%i,%i,%.3f,%.3f"), suite, operation, size, iterations, total, mean);
+	m_results->Add(line);
+}
+
+// Gets a number from 0 to "range" - 1. The sequence is the same
+// for every run, so results can be compared.
+int CEngineBenchmark::Random(int range)
+{
+	m_seed = m_seed * 1103515245 + 12345;
+	return range > 0 ? static_cast<int>((m_seed >> 16) % static_cast<UINT>(range)) : 0;
+}
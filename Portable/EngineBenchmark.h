@@ -0,0 +1,81 @@
+// EngineBenchmark.h : interface of the CEngineBenchmark class
+//
+
+#pragma once
+
+class CDiagramEntityContainer;
+class CUMLEntityContainer;
+class CFlowchartEntityContainer;
+class CNetworkEntityContainer;
+
+// Saves or loads a diagram as its document does
+typedef void (*BENCHMARKSERIALIZE)(CDiagramEntityContainer* objs, CArchive& ar);
+
+// Times the parts of the editors that do not need windows or
+// documents: layout, link routing, header parsing, undo compression,
+// the bounds array and the object pool. Built into "Tulip.exe
+// /benchmark", and on its own as the portable "EngineBenchmark",
+// which also times the diagram models with "RunModels".
+class CEngineBenchmark
+{
+public:
+	CEngineBenchmark();
+	virtual ~CEngineBenchmark();
+
+	// Operations
+	void Run(const CDWordArray& sizes, CStringArray& results);
+	void RunModels(const CDWordArray& sizes, CStringArray& results);
+	void SetRepeat(int repeat);
+	int GetRepeat() const;
+
+	// Generators
+	static void GenerateHeader(CString& text, int first, int count, int members);
+	static void GenerateUML(CUMLEntityContainer& objs, int classes, int members, int packages);
+	static void GenerateFlowchart(CFlowchartEntityContainer& objs, int steps);
+	static void GenerateNetwork(CNetworkEntityContainer& objs, int symbols);
+	static void GenerateDialog(CDiagramEntityContainer& objs, int controls);
+
+private:
+	// Suites
+	void RunLayout(int size);
+	void RunRouter(int size);
+	void RunHeader(int size);
+	void RunCompression(int size);
+	void RunBounds(int size);
+	void RunPool(int size);
+
+	// Diagram model suites
+	void RunUML(int size);
+	void RunFlowchart(int size);
+	void RunNetwork(int size);
+	void RunDialog(int size);
+
+	// Operations common to all diagrams
+	void TimeSerialize(LPCTSTR suite, CDiagramEntityContainer* objs, CDiagramEntityContainer* copy, BENCHMARKSERIALIZE save, BENCHMARKSERIALIZE load, int size);
+	void TimeSnapshot(LPCTSTR suite, CDiagramEntityContainer* objs, int size);
+	void TimeHitTest(LPCTSTR suite, CDiagramEntityContainer* objs, int size);
+	void TimeExport(LPCTSTR suite, CDiagramEntityContainer* objs, UINT format, int size);
+	void TimeRender(LPCTSTR suite, CDiagramEntityContainer* objs, int size);
+
+	// Serialization, as in the documents
+	static void SaveUML(CDiagramEntityContainer* objs, CArchive& ar);
+	static void LoadUML(CDiagramEntityContainer* objs, CArchive& ar);
+	static void SaveFlowchart(CDiagramEntityContainer* objs, CArchive& ar);
+	static void LoadFlowchart(CDiagramEntityContainer* objs, CArchive& ar);
+	static void SaveNetwork(CDiagramEntityContainer* objs, CArchive& ar);
+	static void LoadNetwork(CDiagramEntityContainer* objs, CArchive& ar);
+	static void SaveDialog(CDiagramEntityContainer* objs, CArchive& ar);
+	static void LoadDialog(CDiagramEntityContainer* objs, CArchive& ar);
+
+	// Timing
+	void StartTimer();
+	void StopTimer(LPCTSTR suite, LPCTSTR operation, int size, int iterations);
+	int Random(int range);
+
+	int				m_repeat;		// Times to repeat the short operations
+	LARGE_INTEGER	m_frequency;	// Performance counter frequency
+	LARGE_INTEGER	m_start;		// Performance counter at "StartTimer"
+	UINT			m_seed;			// Random number state, the same for every run
+	CStringArray*	m_results;		// Result lines, during "Run"
+
+};
@@ -0,0 +1,55 @@
+// EngineMain.cpp : entry point of the portable "EngineBenchmark"
+//
+// Run "EngineBenchmark results.csv [size...]" to write the engine and
+// diagram model timings of "CEngineBenchmark", or "EngineBenchmark -
+// [size...]" to print them. The sizes default to those of "Tulip.exe
+// /benchmark".
+
+#include "stdafx.h"
+#include "EngineBenchmark.h"
+
+// Default sizes, as in "Benchmark.cpp"
+static const int defaultSizes[] = { 100, 1000, 5000 };
+
+int main(int argc, char* argv[])
+{
+	if (argc < 2)
+	{
+		fprintf(stderr, "Usage: EngineBenchmark results.csv|- [size...]\n");
+		return 2;
+	}
+
+	CDWordArray sizes;
+	for (int t = 2; t < argc; t++)
+	{
+		if (atoi(argv[t]) > 0)
+			sizes.Add(atoi(argv[t]));
+	}
+	if (sizes.GetSize() == 0)
+	{
+		for (size_t t = 0; t < _countof(defaultSizes); t++)
+			sizes.Add(defaultSizes[t]);
+	}
+
+	CStringArray results;
+	results.Add(_T("suite,operation,size,iterations,total_ms,mean_us"));
+	CEngineBenchmark benchmark;
+	benchmark.Run(sizes, results);
+	benchmark.RunModels(sizes, results);
+
+	FILE* file = strcmp(argv[1], "-") == 0 ? stdout : fopen(argv[1], "w");
+	if (!file)
+	{
+		fprintf(stderr, "EngineBenchmark: cannot write %s\n", argv[1]);
+		return 1;
+	}
+
+	INT_PTR max = results.GetSize();
+	for (INT_PTR t = 0; t < max; t++)
+		fprintf(file, "%s\n", static_cast<LPCTSTR>(results[t]));
+
+	if (file != stdout)
+		fclose(file);
+
+	return 0;
+}
@@ -0,0 +1,1073 @@
+// EngineTests.cpp : tests of the engine code, run by ctest
+//
+// "EngineTests header" checks "CHeaderParser" on small headers:
+// comments, templates, default parameters, nested braces and
+// recovery from errors. It also checks the members the template
+// class import relies on, as they were read before the parser
+// replaced "CUMLEntityClassTemplate::ImportH".
+//
+// "EngineTests corpus folder" parses every header under "folder",
+// which should give no errors, and the generated benchmark corpus.
+//
+// "EngineTests layout" checks that the layered layout gives the same
+// result for any number of threads.
+//
+// "EngineTests autolayout" checks that the auto layout of the network
+// editor leaves symbols placed by hand where they are, and moves the
+// other symbols off them.
+//
+// "EngineTests bounds" checks that the SSE2 queries of "CBoundsArray"
+// find the same rectangles as a plain loop.
+//
+// "EngineTests pool" checks that "CObjectPool" releases unused
+// blocks, and that the slots cached by a thread go back to the pool
+// when the thread exits.
+//
+// "EngineTests nudge" checks that a run of coalesced nudges records a
+// single undo step, copying the data once, that aborting one nudge
+// of the run only reverts that nudge, and that a nudge after undo and
+// redo starts a new step.
+//
+// "EngineTests spill" checks that objects handed to "CUndoSpill" are
+// saved, read back and deleted, whether the writer thread has got to
+// them yet or not. It also checks that undoing through spilled levels
+// gives back exactly the coordinates they were saved with.
+//
+// "EngineTests trace" checks that the trace buffers of exited threads
+// are reused, so that more threads than "TRACE_MAX_THREADS" are
+// traced over a run.
+//
+// "EngineTests render file" draws a scene with every operation of
+// "CDiagramRasterRenderer" and compares the PNG with the reference
+// image "file". "EngineTests render file update" writes "file"
+// instead, after a deliberate change to the output. The scene is also
+// drawn in tiles with "SetOrigin", which must give the same pixels.
+//
+// Each failed check is printed as "file(line): check", and the exit
+// code is the number of failures.
+
+#include "stdafx.h"
+#include "EngineBenchmark.h"
+
+#include "../DiagramEditor/BoundsArray.h"
+#include "../DiagramEditor/DiagramRasterRenderer.h"
+#include "../DiagramEditor/DiagramTrace.h"
+#include "../DiagramEditor/LayeredLayout.h"
+#include "../DiagramEditor/ObjectPool.h"
+#include "../DiagramEditor/PNGWriter.h"
+#include "../DiagramEditor/UndoSpill.h"
+#include "../NetworkEditor/NetworkEntityContainer.h"
+#include "../UMLEditor/HeaderParser.h"
+
+static int failures = 0;
+
+#define CHECK(expr)	Check((expr) ? TRUE : FALSE, #expr, __FILE__, __LINE__)
+
+static void Check(BOOL ok, LPCTSTR expr, LPCTSTR file, int line)
+{
+	if (!ok)
+	{
+		fprintf(stderr, "%s(%d): %s\n", file, line, expr);
+		failures++;
+	}
+}
+
+// Gets the member "name" of "cls", "NULL" if there is none.
+static const CHeaderMember* GetMember(const CHeaderClass* cls, LPCTSTR name)
+{
+	INT_PTR max = cls->members.GetSize();
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		const CHeaderMember* member = static_cast<const CHeaderMember*>(cls->members.GetAt(t));
+		if (member->name == name)
+			return member;
+	}
+
+	return NULL;
+}
+
+static const CHeaderParameter* GetParameter(const CHeaderMember* member, INT_PTR index)
+{
+	return static_cast<const CHeaderParameter*>(member->parameters.GetAt(index));
+}
+
+static BOOL Parse(CHeaderParser& parser, LPCTSTR text)
+{
+	return parser.Parse(text, lstrlen(text));
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Header parser
+
+// Brackets, semicolons and quotes in comments are not code.
+static void TestComments()
+{
+	CHeaderParser parser;
+	CHECK(Parse(parser,
+		"/* class CNotAClass { int m_x; }; */\n"
+		"// class CNotEither {\n"
+		"class CCommented // { not a body\n"
+		"{\n"
+		"public:\n"
+		"\t/* } ; \" */ int m_value; // }; \"\n"
+		"\tvoid Run(/* int hidden */ int shown); /** { */\n"
+		"\t// void Skipped();\n"
+		"};\n"));
+
+	CHECK(parser.GetClassCount() == 1);
+	const CHeaderClass* cls = parser.GetClass(0);
+	CHECK(cls->name == "CCommented");
+	CHECK(cls->members.GetSize() == 2);
+	CHECK(GetMember(cls, "m_value") != NULL);
+	CHECK(GetMember(cls, "Skipped") == NULL);
+
+	const CHeaderMember* run = GetMember(cls, "Run");
+	CHECK(run && run->parameters.GetSize() == 1);
+	CHECK(run && GetParameter(run, 0)->name == "shown");
+}
+
+// Template parameters are kept as written, and template member
+// functions and base classes with template arguments are read.
+static void TestTemplates()
+{
+	CHeaderParser parser;
+	CHECK(Parse(parser,
+		"template<class T, int size = (4 > 2)>\n"
+		"class CBuffer : public CArray<T, const T&>, protected CBase<std::map<int, T>>\n"
+		"{\n"
+		"public:\n"
+		"\ttemplate<class U> void Convert(const U& from);\n"
+		"\tstd::map<CString, CArray<int, int>> m_index;\n"
+		"};\n"
+		"template<> class CBuffer<int, 0> { };\n"));
+
+	CHECK(parser.GetClassCount() == 2);
+	const CHeaderClass* cls = parser.GetClass(0);
+	CHECK(cls->name == "CBuffer");
+	CHECK(cls->templateParameters == "class T, int size=(4> 2)");
+	CHECK(cls->baseClasses.GetSize() == 2);
+	CHECK(cls->baseClasses.GetSize() == 2 && cls->baseClasses[0] == "CArray<T,const T&>");
+	CHECK(cls->baseAccess.GetSize() == 2 && cls->baseAccess[1] == "protected");
+
+	const CHeaderMember* convert = GetMember(cls, "Convert");
+	CHECK(convert && convert->operation);
+	CHECK(convert && convert->parameters.GetSize() == 1 && GetParameter(convert, 0)->type == "const U&");
+
+	const CHeaderMember* index = GetMember(cls, "m_index");
+	CHECK(index && !index->operation && index->type == "std::map<CString, CArray<int, int>>");
+}
+
+// Default values keep their commas, parentheses and strings.
+static void TestDefaultParameters()
+{
+	CHeaderParser parser;
+	CHECK(Parse(parser,
+		"class CDefaults\n"
+		"{\n"
+		"public:\n"
+		"\tvoid Set(int value = 4, const CString& name = _T(\"a, b)\"), CPoint pt = CPoint(1, 2), int* p = NULL);\n"
+		"\tvoid Fill(CArray<int, int>* array = NULL, TCHAR c = _TCHAR(','), CSize size = CSize(1, (2)));\n"
+		"\tint m_count = 10;\n"
+		"};\n"));
+
+	const CHeaderClass* cls = parser.GetClass(0);
+	CHECK(cls != NULL);
+	if (!cls)
+		return;
+
+	const CHeaderMember* set = GetMember(cls, "Set");
+	CHECK(set && set->parameters.GetSize() == 4);
+	if (set && set->parameters.GetSize() == 4)
+	{
+		CHECK(GetParameter(set, 0)->type == "int" && GetParameter(set, 0)->defaultvalue == "4");
+		CHECK(GetParameter(set, 1)->type == "const CString&" && GetParameter(set, 1)->defaultvalue == "_T(\"a, b)\")");
+		CHECK(GetParameter(set, 2)->name == "pt" && GetParameter(set, 2)->defaultvalue == "CPoint(1, 2)");
+		CHECK(GetParameter(set, 3)->type == "int*" && GetParameter(set, 3)->defaultvalue == "NULL");
+	}
+
+	const CHeaderMember* fill = GetMember(cls, "Fill");
+	CHECK(fill && fill->parameters.GetSize() == 3);
+	CHECK(fill && fill->parameters.GetSize() == 3 && GetParameter(fill, 0)->type == "CArray<int, int>*");
+	CHECK(fill && fill->parameters.GetSize() == 3 && GetParameter(fill, 1)->defaultvalue == "_TCHAR(',')");
+	CHECK(fill && fill->parameters.GetSize() == 3 && GetParameter(fill, 2)->defaultvalue == "CSize(1, (2))");
+
+	const CHeaderMember* count = GetMember(cls, "m_count");
+	CHECK(count && count->defaultvalue == "10");
+}
+
+// Inline bodies, nested types and initializers are skipped as a
+// whole, with anything declared with a nested type, and the members
+// after them are still read.
+static void TestNestedBraces()
+{
+	CHeaderParser parser;
+	CHECK(Parse(parser,
+		"class COuter\n"
+		"{\n"
+		"public:\n"
+		"\tCOuter() : m_list{ 1, 2 } { if (m_x) { for (;;) { break; } } }\n"
+		"\tint Get() const { return m_x > 0 ? m_x : -1; }\n"
+		"\tstruct CInner { int m_hidden; void Hidden() { } } m_inner;\n"
+		"\tenum { ONE, TWO = 2 };\n"
+		"\tint m_x{ 3 };\n"
+		"\tstd::vector<int> m_list;\n"
+		"};\n"
+		"struct CAfter { int m_y; };\n"));
+
+	CHECK(parser.GetClassCount() == 2);
+	const CHeaderClass* cls = parser.GetClass(0);
+	CHECK(GetMember(cls, "COuter") != NULL);
+	CHECK(GetMember(cls, "Get") && GetMember(cls, "Get")->isConst);
+	CHECK(GetMember(cls, "m_hidden") == NULL);
+	CHECK(GetMember(cls, "Hidden") == NULL);
+	CHECK(GetMember(cls, "m_x") != NULL);
+	CHECK(GetMember(cls, "m_list") != NULL);
+
+	const CHeaderClass* after = parser.GetClass(1);
+	CHECK(after && after->isStruct && after->name == "CAfter");
+}
+
+// A member that cannot be read is skipped and reported, and the rest
+// of the file is still read.
+static void TestErrorRecovery()
+{
+	CHeaderParser parser;
+	CHECK(!Parse(parser,
+		"class CBroken\n"
+		"{\n"
+		"public:\n"
+		"\tint m_before;\n"
+		"\tvoid Broken(int a;\n"
+		"\tint m_after;\n"
+		"};\n"
+		"class CNext { int m_next; };\n"));
+
+	CHECK(parser.GetErrorCount() >= 1);
+	CHECK(parser.GetErrorCount() >= 1 && parser.GetError(0).line == 5);
+	CHECK(parser.GetClassCount() == 2);
+	CHECK(GetMember(parser.GetClass(0), "m_before") != NULL);
+	CHECK(GetMember(parser.GetClass(0), "Broken") == NULL);
+	CHECK(GetMember(parser.GetClass(0), "m_after") != NULL);
+	CHECK(parser.GetClassCount() == 2 && GetMember(parser.GetClass(1), "m_next") != NULL);
+
+	// A class that is not closed keeps what was read
+	CHECK(!Parse(parser, "class COpen\n{\n\tint m_x;\n\tvoid Run();\n"));
+	CHECK(parser.GetErrorCount() == 1 && parser.GetError(0).code == HEADER_ERROR_BRACKET);
+	CHECK(parser.GetClassCount() == 1 && parser.GetClass(0)->members.GetSize() == 2);
+
+	// A comment that is not closed
+	CHECK(!Parse(parser, "class CComment { int m_x; };\n/* not closed\n"));
+	CHECK(parser.GetErrorCount() == 1 && parser.GetError(0).code == HEADER_ERROR_COMMENT);
+	CHECK(parser.GetErrorCount() == 1 && parser.GetError(0).line == 2);
+	CHECK(parser.GetClassCount() == 1);
+}
+
+// The members "CUMLEntityClassTemplate" and "CUMLEntityClass" import,
+// for the kind of header the removed "CUMLEntityClassTemplate::ImportH"
+// read: the title, the parameter type, access, static, virtual, const
+// and pure virtual members, parameters and array sizes.
+static void TestTemplateImport()
+{
+	CHeaderParser parser;
+	CHECK(Parse(parser,
+		"#pragma once\n"
+		"template <class T>\n"
+		"class CStack : public CObject\n"
+		"{\n"
+		"public:\n"
+		"\tCStack();\n"
+		"\tvirtual ~CStack();\n"
+		"\tvoid Push(const T& item, int count = 1);\n"
+		"\tT Pop();\n"
+		"\tint GetSize() const;\n"
+		"\tvirtual void Draw(CDC* dc) = 0;\n"
+		"\tstatic CStack* Create(T* items);\n"
+		"protected:\n"
+		"\tT m_items[16];\n"
+		"\tstatic int m_count;\n"
+		"private:\n"
+		"\tCMap<int, int, T, T&> m_map;\n"
+		"};\n"));
+
+	CHECK(parser.GetClassCount() == 1);
+	const CHeaderClass* cls = parser.FindClass("Stack");
+	CHECK(cls != NULL);
+	if (!cls)
+		return;
+
+	CHECK(cls->name == "CStack");
+	CHECK(cls->templateParameters == "class T");
+	CHECK(cls->baseClasses.GetSize() == 1 && cls->baseClasses[0] == "CObject");
+
+	const CHeaderMember* constructor = GetMember(cls, "CStack");
+	CHECK(constructor && constructor->operation && constructor->type.IsEmpty() && constructor->access == HEADER_ACCESS_PUBLIC);
+	CHECK(GetMember(cls, "~CStack") && GetMember(cls, "~CStack")->isVirtual);
+
+	const CHeaderMember* push = GetMember(cls, "Push");
+	CHECK(push && push->type.IsEmpty() && push->parameters.GetSize() == 2);
+	CHECK(push && push->parameters.GetSize() == 2 && GetParameter(push, 0)->type == "const T&" && GetParameter(push, 0)->name == "item");
+	CHECK(push && push->parameters.GetSize() == 2 && GetParameter(push, 1)->defaultvalue == "1");
+
+	CHECK(GetMember(cls, "Pop") && GetMember(cls, "Pop")->type == "T");
+	CHECK(GetMember(cls, "GetSize") && GetMember(cls, "GetSize")->isConst);
+
+	const CHeaderMember* draw = GetMember(cls, "Draw");
+	CHECK(draw && draw->isAbstract && draw->isVirtual);
+
+	const CHeaderMember* create = GetMember(cls, "Create");
+	CHECK(create && create->isStatic && create->type == "CStack*");
+
+	const CHeaderMember* items = GetMember(cls, "m_items");
+	CHECK(items && items->type == "T" && items->multiplicity == "16" && items->access == HEADER_ACCESS_PROTECTED);
+	CHECK(GetMember(cls, "m_count") && GetMember(cls, "m_count")->isStatic);
+
+	const CHeaderMember* map = GetMember(cls, "m_map");
+	CHECK(map && map->type == "CMap<int, int, T, T&>" && map->access == HEADER_ACCESS_PRIVATE);
+}
+
+// The class named as the file is picked, with or without a "C" and in
+// any case, else the first class.
+static void TestFindClass()
+{
+	CHeaderParser parser;
+	CHECK(parser.FindClass("Anything") == NULL);
+
+	CHECK(Parse(parser, "struct CHelper { };\nclass CWidget { };\nclass Gadget { };\n"));
+	CHECK(parser.FindClass("Widget") == parser.GetClass(1));
+	CHECK(parser.FindClass("cwidget") == parser.GetClass(1));
+	CHECK(parser.FindClass("Gadget") == parser.GetClass(2));
+	CHECK(parser.FindClass("Other") == parser.GetClass(0));
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Corpus
+
+// Parses every header under "folder", and the benchmark corpus.
+static void TestCorpus(const char* folder)
+{
+	int files = 0;
+	for (const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator(folder))
+	{
+		std::string path = entry.path().string();
+		if (!entry.is_regular_file() || entry.path().extension() != ".h" || path.find("_gate_build") != std::string::npos)
+			continue;
+
+		std::ifstream file(path.c_str(), std::ios::binary);
+		std::string text((std::istreambuf_iterator< char >(file)), std::istreambuf_iterator< char >());
+
+		CHeaderParser parser;
+		if (!parser.Parse(text.c_str(), static_cast<int>(text.size())))
+		{
+			const CHeaderError& error = parser.GetError(0);
+			fprintf(stderr, "%s(%d,%d): error %d\n", path.c_str(), error.line, error.column, error.code);
+			failures++;
+		}
+		files++;
+	}
+	CHECK(files > 0);
+
+	CString corpus;
+	CEngineBenchmark::GenerateHeader(corpus, 0, 200, 8);
+	CHeaderParser parser;
+	CHECK(parser.Parse(corpus, corpus.GetLength()));
+	CHECK(parser.GetClassCount() == 200);
+	CHECK(parser.GetClassCount() == 200 && parser.GetClass(0)->templateParameters == "class T, int size=4");
+	CHECK(parser.GetClassCount() == 200 && parser.GetClass(199)->members.GetSize() == 2 + 8 * 3 + 1);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Layout
+
+// Lays out the same graph with one to eight threads, which should
+// give the same crossings, positions and routes every time.
+static void TestLayeredThreads()
+{
+	const int size = 1000;
+	UINT seed = 1;
+	CLayeredLayout layouts[3];
+	const int threads[3] = { 1, 3, 8 };
+	for (int t = 0; t < 3; t++)
+	{
+		seed = 1;
+		for (int node = 0; node < size; node++)
+			layouts[t].AddNode(40 + node % 7 * 10, 30);
+		for (int node = 1; node < size; node++)
+		{
+			seed = seed * 1103515245 + 12345;
+			layouts[t].AddEdge(static_cast<int>((seed >> 16) % static_cast<UINT>(node)), node);
+			if (node % 3 == 0)
+				layouts[t].AddEdge(static_cast<int>((seed >> 8) % static_cast<UINT>(node)), node);
+		}
+		layouts[t].SetThreadCount(threads[t]);
+		layouts[t].Layout();
+	}
+
+	for (int t = 1; t < 3; t++)
+	{
+		CHECK(layouts[t].GetCrossings() == layouts[0].GetCrossings());
+		CHECK(layouts[t].GetLayerCount() == layouts[0].GetLayerCount());
+
+		int moved = 0;
+		for (int node = 0; node < size; node++)
+			if (layouts[t].GetNodePosition(node) != layouts[0].GetNodePosition(node))
+				moved++;
+		CHECK(moved == 0);
+
+		int rerouted = 0;
+		CArray< CPoint, CPoint > route;
+		CArray< CPoint, CPoint > expected;
+		int edges = size - 1 + (size - 1) / 3;
+		for (int edge = 0; edge < edges; edge++)
+		{
+			layouts[0].GetEdgeRoute(edge, expected);
+			layouts[t].GetEdgeRoute(edge, route);
+			if (route.GetSize() != expected.GetSize() || memcmp(route.GetData(), expected.GetData(), sizeof(CPoint) * route.GetSize()))
+				rerouted++;
+		}
+		CHECK(rerouted == 0);
+	}
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Auto layout
+
+#define AUTOLAYOUT_TEST_SIZE	40
+#define AUTOLAYOUT_TEST_PINNED	7
+
+// Lays out a network, moves one symbol by hand to the corner of the
+// page and lays it out twice more. The others end up around it, partly
+// off the page, so they are moved back. The pinned symbol should stay
+// put, with no other symbol on it.
+static void TestAutoLayoutPinned()
+{
+	CNetworkEntityContainer objs;
+	CEngineBenchmark::GenerateNetwork(objs, AUTOLAYOUT_TEST_SIZE);
+	objs.AutoLayout();
+
+	CDiagramEntity* pinned = objs.GetAt(AUTOLAYOUT_TEST_PINNED);
+	pinned->MoveRect(-pinned->GetLeft(), -pinned->GetTop());
+	CHECK(static_cast<CNetworkSymbol*>(pinned)->IsPlacedByHand());
+	CRect rect(round(pinned->GetLeft()), round(pinned->GetTop()), round(pinned->GetRight()), round(pinned->GetBottom()));
+
+	for (int run = 0; run < 2; run++)
+	{
+		objs.AutoLayout();
+		CRect moved(round(pinned->GetLeft()), round(pinned->GetTop()), round(pinned->GetRight()), round(pinned->GetBottom()));
+		CHECK(moved == rect);
+
+		int covering = 0;
+		for (INT_PTR t = 0; t < objs.GetSize(); t++)
+		{
+			CDiagramEntity* obj = objs.GetAt(t);
+			CRect other(round(obj->GetLeft()), round(obj->GetTop()), round(obj->GetRight()), round(obj->GetBottom()));
+			CRect overlap;
+			if (obj != pinned && overlap.IntersectRect(other, rect))
+				covering++;
+		}
+		CHECK(covering == 0);
+	}
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Bounds
+
+#define BOUNDS_TEST_QUERIES	200
+
+// Gets a coordinate on a small grid, so that many rectangles share
+// edges with the queries.
+static double BoundsCoordinate(UINT& seed)
+{
+	seed = seed * 1103515245 + 12345;
+	return static_cast<double>((seed >> 16) % 64);
+}
+
+// Fills arrays of odd and even sizes with rectangles, some of them
+// not normalized, and checks the queries against a plain loop over
+// the same edges.
+static void TestBoundsQueries()
+{
+	const INT_PTR sizes[5] = { 0, 1, 2, 7, 257 };
+	UINT seed = 1;
+	for (int s = 0; s < 5; s++)
+	{
+		CBoundsArray bounds;
+		bounds.SetSize(sizes[s]);
+		for (INT_PTR t = 0; t < sizes[s]; t++)
+		{
+			double left = BoundsCoordinate(seed);
+			double top = BoundsCoordinate(seed);
+			double right = BoundsCoordinate(seed);
+			double bottom = BoundsCoordinate(seed);
+			bounds.SetAt(t, left, top, right, bottom);
+		}
+
+		int mismatches = 0;
+		CDWordArray indices;
+		CDWordArray expected;
+		for (int query = 0; query < BOUNDS_TEST_QUERIES; query++)
+		{
+			double left = BoundsCoordinate(seed);
+			double top = BoundsCoordinate(seed);
+			double right = BoundsCoordinate(seed);
+			double bottom = BoundsCoordinate(seed);
+
+			expected.RemoveAll();
+			for (INT_PTR t = 0; t < sizes[s]; t++)
+			{
+				double l = bounds.GetAt(t, BOUNDS_LEFT);
+				double tp = bounds.GetAt(t, BOUNDS_TOP);
+				double r = bounds.GetAt(t, BOUNDS_RIGHT);
+				double b = bounds.GetAt(t, BOUNDS_BOTTOM);
+				if (min(l, r) <= max(left, right) && max(l, r) >= min(left, right) &&
+					min(tp, b) <= max(top, bottom) && max(tp, b) >= min(top, bottom))
+					expected.Add(static_cast<DWORD>(t));
+			}
+			bounds.GetIntersecting(left, top, right, bottom, indices);
+			if (indices.GetSize() != expected.GetSize() || memcmp(indices.GetData(), expected.GetData(), sizeof(DWORD) * indices.GetSize()))
+				mismatches++;
+
+			expected.RemoveAll();
+			for (INT_PTR t = 0; t < sizes[s]; t++)
+			{
+				double l = bounds.GetAt(t, BOUNDS_LEFT);
+				double tp = bounds.GetAt(t, BOUNDS_TOP);
+				double r = bounds.GetAt(t, BOUNDS_RIGHT);
+				double b = bounds.GetAt(t, BOUNDS_BOTTOM);
+				if (min(l, r) <= left && max(l, r) >= left && min(tp, b) <= top && max(tp, b) >= top)
+					expected.Add(static_cast<DWORD>(t));
+			}
+			bounds.GetContaining(left, top, indices);
+			if (indices.GetSize() != expected.GetSize() || memcmp(indices.GetData(), expected.GetData(), sizeof(DWORD) * indices.GetSize()))
+				mismatches++;
+		}
+		CHECK(mismatches == 0);
+	}
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Pool
+
+#define POOL_TEST_SIZE		48
+#define POOL_TEST_BLOCK		16
+#define POOL_TEST_OBJECTS	(POOL_TEST_BLOCK * 4)
+
+static UINT AFX_CDECL PoolThreadProc(LPVOID param)
+{
+	CObjectPool* pool = static_cast<CObjectPool*>(param);
+	void* objects[POOL_TEST_OBJECTS];
+	for (int t = 0; t < POOL_TEST_OBJECTS; t++)
+		objects[t] = pool->Alloc(POOL_TEST_SIZE);
+	for (int t = 0; t < POOL_TEST_OBJECTS; t++)
+		pool->Free(objects[t], POOL_TEST_SIZE);
+	return 0;
+}
+
+// Frees the objects of some blocks, and of a whole pool, and checks
+// that "Trim" releases exactly the unused blocks.
+static void TestPoolTrim()
+{
+	CObjectPool pool(POOL_TEST_SIZE, POOL_TEST_BLOCK);
+	void* objects[POOL_TEST_OBJECTS];
+	for (int t = 0; t < POOL_TEST_OBJECTS; t++)
+		objects[t] = pool.Alloc(POOL_TEST_SIZE);
+	CHECK(pool.GetLiveCount() == POOL_TEST_OBJECTS);
+	CHECK(pool.GetBlockCount() == 4);
+
+	// Slots are handed out a block at a time, so the first half of
+	// the objects fill two blocks
+	for (int t = 0; t < POOL_TEST_OBJECTS / 2; t++)
+		pool.Free(objects[t], POOL_TEST_SIZE);
+	CHECK(pool.GetLiveCount() == POOL_TEST_OBJECTS / 2);
+	pool.Trim();
+	CHECK(pool.GetBlockCount() == 2);
+	CHECK(pool.GetLiveCount() == POOL_TEST_OBJECTS / 2);
+
+	// The freed slots are gone, the live ones still work
+	for (int t = POOL_TEST_OBJECTS / 2; t < POOL_TEST_OBJECTS; t++)
+		memset(objects[t], t, POOL_TEST_SIZE);
+	for (int t = POOL_TEST_OBJECTS / 2; t < POOL_TEST_OBJECTS; t++)
+		CHECK(static_cast<BYTE*>(objects[t])[POOL_TEST_SIZE - 1] == static_cast<BYTE>(t));
+
+	for (int t = POOL_TEST_OBJECTS / 2; t < POOL_TEST_OBJECTS; t++)
+		pool.Free(objects[t], POOL_TEST_SIZE);
+	CHECK(pool.GetLiveCount() == 0);
+	pool.Trim();
+	CHECK(pool.GetBlockCount() == 0);
+
+	// A worker leaves its cached slots behind when it exits
+	CWinThread* thread = AfxBeginThread(PoolThreadProc, &pool, THREAD_PRIORITY_NORMAL, 0, CREATE_SUSPENDED);
+	thread->m_bAutoDelete = FALSE;
+	thread->ResumeThread();
+	::WaitForSingleObject(thread->m_hThread, INFINITE);
+	delete thread;
+	CHECK(pool.GetLiveCount() == 0);
+	pool.Trim();
+	CHECK(pool.GetBlockCount() == 0);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Transactions
+
+#define NUDGE_TEST_OBJECTS	50
+#define NUDGE_TEST_NUDGES	40
+
+static int nudgeClones = 0;
+
+class CNudgeObject : public CDiagramEntity
+{
+public:
+	virtual CDiagramEntity* Clone()
+	{
+		nudgeClones++;
+		CNudgeObject* obj = new CNudgeObject;
+		obj->Copy(this);
+		return obj;
+	}
+};
+
+// Moves the selected objects one step right, as a keyboard nudge does.
+static BOOL Nudge(CDiagramEntityContainer& objs, BOOL abort)
+{
+	objs.BeginTransaction(TRANSACTION_NUDGE);
+	objs.Snapshot();
+	for (INT_PTR t = 0; t < objs.GetSize(); t++)
+		if (objs.GetAt(t)->IsSelected())
+			objs.GetAt(t)->MoveRect(1, 0);
+	if (abort)
+		return objs.AbortTransaction();
+	objs.CommitTransaction();
+	return TRUE;
+}
+
+// Nudges half the objects many times, then aborts one more nudge and
+// undoes the run.
+static void TestNudgeCoalescing()
+{
+	CDiagramEntityContainer objs;
+	objs.SetCoalesceTime(INFINITE);
+	for (int t = 0; t < NUDGE_TEST_OBJECTS; t++)
+	{
+		CNudgeObject* obj = new CNudgeObject;
+		obj->SetRect(t * 10, 0, t * 10 + 8, 8);
+		obj->Select(t % 2 == 0);
+		objs.Add(obj);
+	}
+
+	nudgeClones = 0;
+	for (int t = 0; t < NUDGE_TEST_NUDGES; t++)
+		Nudge(objs, FALSE);
+	CHECK(objs.GetUndoLevels() == 1);
+	CHECK(objs.GetUndoObjectCount() == NUDGE_TEST_OBJECTS);
+	CHECK(nudgeClones == NUDGE_TEST_OBJECTS);
+	CHECK(objs.GetAt(0)->GetLeft() == NUDGE_TEST_NUDGES);
+
+	CHECK(Nudge(objs, TRUE));
+	CHECK(objs.GetUndoLevels() == 1);
+	CHECK(nudgeClones == NUDGE_TEST_OBJECTS);
+	CHECK(objs.GetAt(0)->GetLeft() == NUDGE_TEST_NUDGES);
+	CHECK(objs.GetAt(1)->GetLeft() == 10);
+
+	objs.Undo();
+	CHECK(objs.GetUndoLevels() == 0);
+	CHECK(objs.GetAt(0)->GetLeft() == 0);
+
+	// The stack is the same size after undo and redo, but the next
+	// nudge starts a new step
+	Nudge(objs, FALSE);
+	objs.Undo();
+	objs.Redo();
+	CHECK(objs.GetUndoLevels() == 1);
+	Nudge(objs, FALSE);
+	CHECK(objs.GetUndoLevels() == 2);
+	objs.Undo();
+	CHECK(objs.GetAt(0)->GetLeft() == 1);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Spill
+
+#define SPILL_TEST_LEVELS	32
+#define SPILL_TEST_OBJECTS	200
+
+static volatile LONG spillDeleted = 0;
+
+class CSpillObject : public CObject
+{
+public:
+	CSpillObject(int value) : m_value(value) {}
+	virtual ~CSpillObject() { ::InterlockedIncrement(&spillDeleted); }
+
+	int m_value;
+};
+
+static void SaveSpillObjects(const CObArray& objects, CString& data)
+{
+	INT_PTR count = objects.GetSize();
+	for (INT_PTR t = 0; t < count; t++)
+	{
+		CString line;
+		line.Format(_T("object:%i;\r\n"), static_cast<const CSpillObject*>(objects.GetAt(t))->m_value);
+		data += line;
+	}
+}
+
+// Spills levels of objects and reads them back at once, while the
+// writer thread is still saving and writing them. Every level must
+// come back as saved, and every object must be deleted once.
+static void TestSpillObjects()
+{
+	spillDeleted = 0;
+	{
+		CUndoSpill spill;
+		int blocks[SPILL_TEST_LEVELS];
+		for (int level = 0; level < SPILL_TEST_LEVELS; level++)
+		{
+			CObArray objects;
+			for (int t = 0; t < SPILL_TEST_OBJECTS; t++)
+				objects.Add(new CSpillObject(level * SPILL_TEST_OBJECTS + t));
+			blocks[level] = spill.Write(objects, SaveSpillObjects);
+			CHECK(blocks[level] != -1);
+			CHECK(objects.GetSize() == 0);
+		}
+
+		// Freed before or while they are written
+		for (int level = 0; level < SPILL_TEST_LEVELS; level += 4)
+			spill.Free(blocks[level]);
+
+		for (int level = 0; level < SPILL_TEST_LEVELS; level++)
+		{
+			if (level % 4 == 0)
+				continue;
+
+			CString expected;
+			CObArray objects;
+			for (int t = 0; t < SPILL_TEST_OBJECTS; t++)
+				objects.Add(new CSpillObject(level * SPILL_TEST_OBJECTS + t));
+			SaveSpillObjects(objects, expected);
+			for (int t = 0; t < SPILL_TEST_OBJECTS; t++)
+				delete objects[t];
+
+			CString data;
+			CHECK(spill.Read(blocks[level], data));
+			CHECK(data == expected);
+		}
+		CHECK(spill.GetBlockCount() == SPILL_TEST_LEVELS - SPILL_TEST_LEVELS / 4);
+	}
+
+	CHECK(spillDeleted == SPILL_TEST_LEVELS * SPILL_TEST_OBJECTS * 2 - (SPILL_TEST_LEVELS / 4) * SPILL_TEST_OBJECTS);
+}
+
+#define SPILL_TEST_STEPS	6
+
+// Moves objects at fractional coordinates in steps, with all but the
+// newest undo level spilled, and undoes every step.
+static void TestSpillGeometry()
+{
+	CDiagramEntityContainer objs;
+	objs.SetEntityFactory(CDiagramEntity::CreateFromString);
+	objs.SetUndoMemoryLevels(1);
+	for (int t = 0; t < SPILL_TEST_OBJECTS; t++)
+	{
+		CDiagramEntity* obj = new CDiagramEntity;
+		obj->SetRect(t / 3.0 + 0.1, t / 7.0, t / 3.0 + 10.1, t / 7.0 + 1e-9);
+		objs.Add(obj);
+	}
+
+	double lefts[SPILL_TEST_STEPS];
+	double bottoms[SPILL_TEST_STEPS];
+	for (int step = 0; step < SPILL_TEST_STEPS; step++)
+	{
+		lefts[step] = objs.GetAt(SPILL_TEST_OBJECTS - 1)->GetLeft();
+		bottoms[step] = objs.GetAt(SPILL_TEST_OBJECTS - 1)->GetBottom();
+		objs.Snapshot();
+		for (int t = 0; t < SPILL_TEST_OBJECTS; t++)
+			objs.GetAt(t)->MoveRect(1.0 / 3.0, 0.1);
+	}
+	CHECK(objs.GetUndoObjectCount() == SPILL_TEST_OBJECTS);
+
+	for (int step = SPILL_TEST_STEPS - 1; step >= 0; step--)
+	{
+		objs.Undo();
+		CHECK(objs.GetAt(SPILL_TEST_OBJECTS - 1)->GetLeft() == lefts[step]);
+		CHECK(objs.GetAt(SPILL_TEST_OBJECTS - 1)->GetBottom() == bottoms[step]);
+	}
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Trace
+
+#define TRACE_TEST_THREADS	(TRACE_MAX_THREADS * 3)
+
+static UINT AFX_CDECL TraceThreadProc(LPVOID)
+{
+	DIAGRAM_TRACE_SPAN(_T("TraceThread"));
+	return 0;
+}
+
+// Runs more threads than there can be buffers, one after the other,
+// and checks that every span is saved.
+static void TestTraceThreads()
+{
+	CDiagramTrace::Enable(TRUE);
+	for (int t = 0; t < TRACE_TEST_THREADS; t++)
+	{
+		CWinThread* thread = AfxBeginThread(TraceThreadProc, NULL, THREAD_PRIORITY_NORMAL, 0, CREATE_SUSPENDED);
+		thread->m_bAutoDelete = FALSE;
+		thread->ResumeThread();
+		::WaitForSingleObject(thread->m_hThread, INFINITE);
+		delete thread;
+	}
+
+	TCHAR path[MAX_PATH];
+	TCHAR filename[MAX_PATH];
+	::GetTempPath(MAX_PATH, path);
+	::GetTempFileName(path, _T("trc"), 0, filename);
+	CHECK(CDiagramTrace::Save(filename));
+	CDiagramTrace::Free();
+
+	std::ifstream file(filename, std::ios::binary);
+	std::string json((std::istreambuf_iterator< char >(file)), std::istreambuf_iterator< char >());
+	file.close();
+	::DeleteFile(filename);
+
+	int spans = 0;
+	for (size_t found = json.find("\"TraceThread\""); found != std::string::npos; found = json.find("\"TraceThread\"", found + 1))
+		spans++;
+	CHECK(spans == TRACE_TEST_THREADS);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Render
+
+#define RENDER_TEST_WIDTH	320
+#define RENDER_TEST_HEIGHT	200
+#define RENDER_TEST_TILE	64
+#define RENDER_TEST_BITMAP	1
+
+// Shapes and text as the UML entities draw them: a class box, a note,
+// an interface, a package tab and the line markers, with every pen
+// style, font style and background mode, clipping and a bitmap.
+static void DrawRenderScene(CDiagramRasterRenderer& renderer)
+{
+	// Class box, with a bold title, an underlined static attribute and
+	// an italic abstract operation
+	renderer.SetPen(PS_SOLID, 1, RGB(0, 0, 0));
+	renderer.SetBrush(RGB(255, 255, 255));
+	renderer.Rectangle(CRect(10, 10, 130, 100));
+	renderer.Line(CPoint(10, 30), CPoint(130, 30));
+	renderer.Line(CPoint(10, 60), CPoint(130, 60));
+	renderer.SetBkMode(TRANSPARENT);
+	renderer.SetTextColor(RGB(0, 0, 0));
+	renderer.SetFont(_T("Arial"), -12, FW_BOLD);
+	renderer.DrawText(_T("CShape"), CRect(10, 12, 130, 28), DT_SINGLELINE | DT_CENTER | DT_VCENTER);
+	renderer.SetFont(_T("Arial"), -10, FW_NORMAL, FALSE, TRUE);
+	renderer.DrawText(_T("+count : int"), CRect(14, 32, 130, 44), DT_SINGLELINE);
+	renderer.SetFont(_T("Arial"), -10);
+	renderer.DrawText(_T("-m_x : int"), CRect(14, 44, 130, 56), DT_SINGLELINE);
+	renderer.SetFont(_T("Arial"), -10, FW_NORMAL, TRUE);
+	renderer.DrawText(_T("+Draw() : void"), CRect(14, 62, 130, 74), DT_SINGLELINE);
+	renderer.SetFont(_T("Arial"), -10, FW_BOLD, TRUE);
+	renderer.DrawText(_T("+Area() : double"), CRect(14, 76, 130, 88), DT_SINGLELINE);
+
+	// Note, with the corner folded and wrapped, opaque text
+	CPoint note[5] = { CPoint(150, 10), CPoint(220, 10), CPoint(230, 20), CPoint(230, 80), CPoint(150, 80) };
+	renderer.SetBrush(RGB(255, 255, 192));
+	renderer.Polygon(note, 5);
+	renderer.Line(CPoint(220, 10), CPoint(220, 20));
+	renderer.Line(CPoint(220, 20), CPoint(230, 20));
+	renderer.SetBkMode(OPAQUE);
+	renderer.SetBkColor(RGB(255, 255, 192));
+	renderer.SetFont(_T("Arial"), -10);
+	renderer.DrawText(_T("Shapes are drawn by the view"), CRect(154, 24, 226, 76), DT_WORDBREAK | DT_NOPREFIX);
+
+	// Interface, with the title above the circle
+	renderer.SetBrush(RGB(192, 224, 255));
+	renderer.Ellipse(CRect(260, 30, 290, 60));
+	renderer.SetBkMode(TRANSPARENT);
+	renderer.SetFont(_T("Arial"), -12, FW_BOLD);
+	renderer.DrawText(_T("IDraw"), CRect(240, 12, 310, 28), DT_SINGLELINE | DT_CENTER);
+
+	// Package, a tab and a box, with the text clipped to the box
+	renderer.SetBrush(RGB(224, 224, 224));
+	renderer.Rectangle(CRect(10, 120, 50, 130));
+	renderer.Rectangle(CRect(10, 129, 110, 190));
+	renderer.SetClipRect(CRect(10, 129, 110, 190));
+	renderer.SetFont(_T("Arial"), -20, FW_BOLD);
+	renderer.DrawText(_T("Geometry"), CRect(14, 150, 200, 172), DT_SINGLELINE);
+	renderer.ResetClip();
+
+	// Lines: dashed with a direction arrow, dotted with an inheritance
+	// arrow, wide with a diamond, and a null pen that draws nothing
+	renderer.SetPen(PS_DASH, 1, RGB(0, 0, 160));
+	renderer.Line(CPoint(130, 140), CPoint(250, 140));
+	renderer.SetPen(PS_SOLID, 1, RGB(0, 0, 160));
+	CPoint arrow[3] = { CPoint(242, 135), CPoint(250, 140), CPoint(242, 145) };
+	renderer.Polyline(arrow, 3);
+
+	renderer.SetPen(PS_DOT, 1, RGB(0, 0, 0));
+	renderer.Line(CPoint(130, 160), CPoint(240, 160));
+	renderer.SetPen(PS_SOLID, 1, RGB(0, 0, 0));
+	renderer.SetBrush(RGB(255, 255, 255));
+	CPoint triangle[3] = { CPoint(240, 152), CPoint(254, 160), CPoint(240, 168) };
+	renderer.Polygon(triangle, 3);
+
+	renderer.SetPen(PS_SOLID, 3, RGB(160, 0, 0));
+	renderer.Line(CPoint(130, 180), CPoint(236, 180));
+	renderer.SetPen(PS_SOLID, 1, RGB(0, 0, 0));
+	renderer.SetBrush(RGB(0, 0, 0));
+	CPoint diamond[4] = { CPoint(236, 180), CPoint(245, 175), CPoint(254, 180), CPoint(245, 185) };
+	renderer.Polygon(diamond, 4);
+
+	renderer.SetPen(PS_NULL, 1, RGB(255, 0, 0));
+	renderer.Line(CPoint(130, 190), CPoint(250, 190));
+
+	// Rounded rectangle without a fill, and a bitmap with a
+	// transparent color
+	renderer.SetPen(PS_SOLID, 1, RGB(0, 128, 0));
+	renderer.SetNullBrush();
+	renderer.RoundRect(CRect(264, 100, 310, 190), CPoint(16, 16));
+	renderer.DrawBitmap(RENDER_TEST_BITMAP, CRect(271, 130, 303, 162), CSize(8, 8), RGB(255, 0, 255));
+}
+
+// Sets the bitmap of the scene, an 8x8 checker board with a
+// transparent center.
+static void SetRenderBitmap(CDiagramRasterRenderer& renderer)
+{
+	BYTE rgba[8 * 8 * 4];
+	for (int y = 0; y < 8; y++)
+	{
+		for (int x = 0; x < 8; x++)
+		{
+			BYTE* pixel = rgba + (y * 8 + x) * 4;
+			BOOL center = (x >= 3 && x < 5 && y >= 3 && y < 5);
+			BOOL dark = ((x + y) % 2 == 0);
+			pixel[0] = static_cast<BYTE>(center ? 255 : (dark ? 0 : 255));
+			pixel[1] = static_cast<BYTE>(center ? 0 : (dark ? 96 : 224));
+			pixel[2] = static_cast<BYTE>(center ? 255 : (dark ? 0 : 160));
+			pixel[3] = 255;
+		}
+	}
+	renderer.SetBitmap(RENDER_TEST_BITMAP, 8, 8, rgba);
+}
+
+// Draws the scene, and compares the PNG with the reference image
+// "filename", or writes it if "update" is set. A PNG that differs is
+// saved to the temporary folder, to look at.
+static void TestRenderReference(const char* filename, BOOL update)
+{
+	CDiagramRasterRenderer renderer;
+	CHECK(renderer.Create(RENDER_TEST_WIDTH, RENDER_TEST_HEIGHT, RGB(255, 255, 255)));
+	SetRenderBitmap(renderer);
+	DrawRenderScene(renderer);
+
+	CMemFile memory;
+	CPNGWriter writer;
+	CHECK(writer.Open(&memory, RENDER_TEST_WIDTH, RENDER_TEST_HEIGHT));
+	for (int y = 0; y < RENDER_TEST_HEIGHT; y++)
+		writer.WriteRow(renderer.GetRow(y));
+	CHECK(writer.Close());
+
+	size_t size = static_cast<size_t>(memory.GetLength());
+	BYTE* data = memory.Detach();
+	std::string png(reinterpret_cast<const char*>(data), size);
+	free(data);
+
+	if (update)
+	{
+		std::ofstream file(filename, std::ios::binary);
+		file.write(png.data(), png.size());
+		CHECK(file.good());
+		return;
+	}
+
+	std::ifstream file(filename, std::ios::binary);
+	std::string reference((std::istreambuf_iterator< char >(file)), std::istreambuf_iterator< char >());
+	CHECK(!reference.empty());
+	CHECK(png == reference);
+	if (png != reference)
+	{
+		TCHAR path[MAX_PATH];
+		::GetTempPath(MAX_PATH, path);
+		CString actual(path);
+		actual += _T("render.png");
+		std::ofstream out(actual.GetString(), std::ios::binary);
+		out.write(png.data(), png.size());
+		fprintf(stderr, "The image drawn is in %s\n", actual.GetString());
+	}
+
+	// The same scene in tiles, moving the canvas over the drawing
+	CDiagramRasterRenderer tile;
+	CHECK(tile.Create(RENDER_TEST_TILE, RENDER_TEST_TILE, RGB(255, 255, 255)));
+	SetRenderBitmap(tile);
+	int differ = 0;
+	for (int top = 0; top < RENDER_TEST_HEIGHT; top += RENDER_TEST_TILE)
+	{
+		for (int left = 0; left < RENDER_TEST_WIDTH; left += RENDER_TEST_TILE)
+		{
+			tile.Clear(RGB(255, 255, 255));
+			tile.SetOrigin(CPoint(left, top));
+			DrawRenderScene(tile);
+
+			int bottom = min(top + RENDER_TEST_TILE, RENDER_TEST_HEIGHT);
+			int right = min(left + RENDER_TEST_TILE, RENDER_TEST_WIDTH);
+			for (int y = top; y < bottom; y++)
+			{
+				for (int x = left; x < right; x++)
+				{
+					if (tile.GetPixel(x - left, y - top) != renderer.GetPixel(x, y))
+						differ++;
+				}
+			}
+		}
+	}
+	CHECK(differ == 0);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Entry point
+
+int main(int argc, char* argv[])
+{
+	CString group(argc > 1 ? argv[1] : "");
+	if (group == "header")
+	{
+		TestComments();
+		TestTemplates();
+		TestDefaultParameters();
+		TestNestedBraces();
+		TestErrorRecovery();
+		TestTemplateImport();
+		TestFindClass();
+	}
+	else if (group == "corpus" && argc > 2)
+		TestCorpus(argv[2]);
+	else if (group == "layout")
+		TestLayeredThreads();
+	else if (group == "autolayout")
+		TestAutoLayoutPinned();
+	else if (group == "bounds")
+		TestBoundsQueries();
+	else if (group == "pool")
+		TestPoolTrim();
+	else if (group == "nudge")
+		TestNudgeCoalescing();
+	else if (group == "spill")
+	{
+		TestSpillObjects();
+		TestSpillGeometry();
+	}
+	else if (group == "trace")
+		TestTraceThreads();
+	else if (group == "render" && argc > 2)
+		TestRenderReference(argv[2], argc > 3 && CString(argv[3]) == "update");
+	else
+	{
+		fprintf(stderr, "Usage: EngineTests header|corpus folder|layout|autolayout|bounds|pool|nudge|spill|trace|render file [update]\n");
+		return 2;
+	}
+
+	if (failures)
+		fprintf(stderr, "%d failed\n", failures);
+
+	return failures;
+}
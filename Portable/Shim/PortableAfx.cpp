@@ -0,0 +1,1350 @@
+/* ==========================================================================
+	File :			PortableAfx.cpp
+
+	Class :			CString, CRect, CFile, CMemFile, CWinThread
+
+	Date :			10/19/26
+
+	Purpose :		The part of MFC and Win32 the engine sources use,
+					written on the C++ standard library. See
+					"PortableAfx.h".
+
+	Description :	Handles are pointers to a "CShimHandle", tagged with
+					the kind of object. Events and threads are waited
+					for on a single condition variable, which is enough
+					for the handful of workers the engine starts.
+
+	Usage :			Only built by the portable targets in
+					"CMakeLists.txt".
+
+   ========================================================================*/
+
+#include "PortableAfx.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/////////////////////////////////////////////////////////////////////////////
+// Exceptions
+
+BOOL CException::GetErrorMessage(LPTSTR error, UINT max, UINT*) const
+{
+	if (error && max)
+		error[0] = 0;
+	return FALSE;
+}
+
+BOOL CMemoryException::GetErrorMessage(LPTSTR error, UINT max, UINT*) const
+{
+	if (error && max)
+		lstrcpyn(error, "Out of memory.", static_cast<int>(max));
+	return TRUE;
+}
+
+BOOL CFileException::GetErrorMessage(LPTSTR error, UINT max, UINT*) const
+{
+	if (error && max)
+		lstrcpyn(error, strerror(m_cause), static_cast<int>(max));
+	return TRUE;
+}
+
+void AfxThrowMemoryException()
+{
+	throw new CMemoryException;
+}
+
+void AfxThrowFileException(int cause)
+{
+	throw new CFileException(cause);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CString
+
+CString CString::Mid(int first) const
+{
+	return Mid(first, GetLength() - first);
+}
+
+CString CString::Mid(int first, int count) const
+{
+	first = max(0, min(first, GetLength()));
+	count = max(0, min(count, GetLength() - first));
+	return CString(m_str.c_str() + first, count);
+}
+
+CString CString::Left(int count) const
+{
+	return Mid(0, count);
+}
+
+CString CString::Right(int count) const
+{
+	count = max(0, min(count, GetLength()));
+	return Mid(GetLength() - count, count);
+}
+
+CString CString::SpanIncluding(LPCTSTR set) const
+{
+	return Left(static_cast<int>(strspn(m_str.c_str(), set)));
+}
+
+CString CString::SpanExcluding(LPCTSTR set) const
+{
+	return Left(static_cast<int>(strcspn(m_str.c_str(), set)));
+}
+
+CString CString::Tokenize(LPCTSTR tokens, int& start) const
+{
+	if (start < 0 || start >= GetLength())
+	{
+		start = -1;
+		return CString();
+	}
+
+	size_t first = m_str.find_first_not_of(tokens, start);
+	if (first == std::string::npos)
+	{
+		start = -1;
+		return CString();
+	}
+
+	size_t last = m_str.find_first_of(tokens, first);
+	if (last == std::string::npos)
+		last = m_str.size();
+	start = static_cast<int>(last) + 1;
+	return CString(m_str.c_str() + first, static_cast<int>(last - first));
+}
+
+int CString::Find(TCHAR c, int start) const
+{
+	size_t pos = m_str.find(c, max(0, start));
+	return pos == std::string::npos ? -1 : static_cast<int>(pos);
+}
+
+int CString::Find(LPCTSTR str, int start) const
+{
+	size_t pos = m_str.find(str, max(0, start));
+	return pos == std::string::npos ? -1 : static_cast<int>(pos);
+}
+
+int CString::ReverseFind(TCHAR c) const
+{
+	size_t pos = m_str.rfind(c);
+	return pos == std::string::npos ? -1 : static_cast<int>(pos);
+}
+
+int CString::FindOneOf(LPCTSTR set) const
+{
+	size_t pos = m_str.find_first_of(set);
+	return pos == std::string::npos ? -1 : static_cast<int>(pos);
+}
+
+int CString::Replace(TCHAR oldChar, TCHAR newChar)
+{
+	int count = 0;
+	for (size_t t = 0; t < m_str.size(); t++)
+	{
+		if (m_str[t] == oldChar)
+		{
+			m_str[t] = newChar;
+			count++;
+		}
+	}
+	return count;
+}
+
+int CString::Replace(LPCTSTR oldStr, LPCTSTR newStr)
+{
+	size_t oldLength = strlen(oldStr);
+	if (oldLength == 0)
+		return 0;
+
+	size_t newLength = newStr ? strlen(newStr) : 0;
+	int count = 0;
+	size_t pos = 0;
+	while ((pos = m_str.find(oldStr, pos)) != std::string::npos)
+	{
+		m_str.replace(pos, oldLength, newStr ? newStr : "");
+		pos += newLength;
+		count++;
+	}
+	return count;
+}
+
+int CString::Remove(TCHAR c)
+{
+	size_t before = m_str.size();
+	m_str.erase(std::remove(m_str.begin(), m_str.end(), c), m_str.end());
+	return static_cast<int>(before - m_str.size());
+}
+
+int CString::Insert(int index, TCHAR c)
+{
+	index = max(0, min(index, GetLength()));
+	m_str.insert(m_str.begin() + index, c);
+	return GetLength();
+}
+
+int CString::Insert(int index, LPCTSTR str)
+{
+	index = max(0, min(index, GetLength()));
+	m_str.insert(index, str);
+	return GetLength();
+}
+
+int CString::Delete(int index, int count)
+{
+	if (index >= 0 && index < GetLength() && count > 0)
+		m_str.erase(index, count);
+	return GetLength();
+}
+
+CString& CString::MakeUpper()
+{
+	for (size_t t = 0; t < m_str.size(); t++)
+		m_str[t] = static_cast<TCHAR>(_totupper(m_str[t]));
+	return *this;
+}
+
+CString& CString::MakeLower()
+{
+	for (size_t t = 0; t < m_str.size(); t++)
+		m_str[t] = static_cast<TCHAR>(_totlower(m_str[t]));
+	return *this;
+}
+
+CString& CString::MakeReverse()
+{
+	std::reverse(m_str.begin(), m_str.end());
+	return *this;
+}
+
+CString& CString::Trim()
+{
+	return TrimRight().TrimLeft();
+}
+
+CString& CString::Trim(TCHAR c)
+{
+	return TrimRight(c).TrimLeft(c);
+}
+
+CString& CString::Trim(LPCTSTR set)
+{
+	return TrimRight(set).TrimLeft(set);
+}
+
+CString& CString::TrimLeft()
+{
+	size_t count = 0;
+	while (count < m_str.size() && _istspace(m_str[count]))
+		count++;
+	m_str.erase(0, count);
+	return *this;
+}
+
+CString& CString::TrimLeft(TCHAR c)
+{
+	size_t count = 0;
+	while (count < m_str.size() && m_str[count] == c)
+		count++;
+	m_str.erase(0, count);
+	return *this;
+}
+
+CString& CString::TrimLeft(LPCTSTR set)
+{
+	size_t count = 0;
+	while (count < m_str.size() && strchr(set, m_str[count]))
+		count++;
+	m_str.erase(0, count);
+	return *this;
+}
+
+CString& CString::TrimRight()
+{
+	while (!m_str.empty() && _istspace(m_str[m_str.size() - 1]))
+		m_str.erase(m_str.size() - 1);
+	return *this;
+}
+
+CString& CString::TrimRight(TCHAR c)
+{
+	while (!m_str.empty() && m_str[m_str.size() - 1] == c)
+		m_str.erase(m_str.size() - 1);
+	return *this;
+}
+
+CString& CString::TrimRight(LPCTSTR set)
+{
+	while (!m_str.empty() && strchr(set, m_str[m_str.size() - 1]))
+		m_str.erase(m_str.size() - 1);
+	return *this;
+}
+
+// Translates the Visual C++ size prefixes "%I64" and "%I" to C99
+static std::string TranslateFormat(LPCTSTR format)
+{
+	std::string result;
+	for (LPCTSTR c = format; *c; c++)
+	{
+		result += *c;
+		if (*c != '%')
+			continue;
+
+		c++;
+		while (*c && strchr("-+ #0123456789.*", *c))
+			result += *c++;
+
+		if (c[0] == 'I' && c[1] == '6' && c[2] == '4')
+		{
+			result += "ll";
+			c += 3;
+		}
+		else if (c[0] == 'I' && c[1] == '3' && c[2] == '2')
+			c += 3;
+		else if (c[0] == 'I')
+		{
+			result += "z";
+			c++;
+		}
+
+		if (!*c)
+			break;
+		result += *c;
+	}
+	return result;
+}
+
+void CString::FormatV(LPCTSTR format, va_list args)
+{
+	std::string translated = TranslateFormat(format);
+
+	va_list copy;
+	va_copy(copy, args);
+	int length = vsnprintf(NULL, 0, translated.c_str(), copy);
+	va_end(copy);
+
+	if (length < 0)
+	{
+		m_str.clear();
+		return;
+	}
+
+	std::vector< char > buffer(length + 1);
+	vsnprintf(&buffer[0], buffer.size(), translated.c_str(), args);
+	m_str.assign(&buffer[0], length);
+}
+
+void CString::Format(LPCTSTR format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	FormatV(format, args);
+	va_end(args);
+}
+
+void CString::AppendFormat(LPCTSTR format, ...)
+{
+	CString str;
+	va_list args;
+	va_start(args, format);
+	str.FormatV(format, args);
+	va_end(args);
+	*this += str;
+}
+
+BOOL CString::LoadString(UINT)
+{
+	// There are no string resources
+	m_str.clear();
+	return FALSE;
+}
+
+LPTSTR CString::GetBuffer(int minLength)
+{
+	if (minLength > GetLength())
+		m_str.resize(minLength);
+	return &m_str[0];
+}
+
+LPTSTR CString::GetBufferSetLength(int length)
+{
+	m_str.resize(length);
+	return &m_str[0];
+}
+
+void CString::ReleaseBuffer(int length)
+{
+	if (length < 0)
+		length = static_cast<int>(strlen(m_str.c_str()));
+	m_str.resize(length);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CRect
+
+void CRect::NormalizeRect()
+{
+	if (left > right)
+		std::swap(left, right);
+	if (top > bottom)
+		std::swap(top, bottom);
+}
+
+BOOL CRect::IntersectRect(LPCRECT rect1, LPCRECT rect2)
+{
+	CRect result(max(rect1->left, rect2->left), max(rect1->top, rect2->top), min(rect1->right, rect2->right), min(rect1->bottom, rect2->bottom));
+	if (result.IsRectEmpty())
+		result.SetRectEmpty();
+	*this = result;
+	return !IsRectEmpty();
+}
+
+BOOL CRect::UnionRect(LPCRECT rect1, LPCRECT rect2)
+{
+	CRect r1(rect1);
+	CRect r2(rect2);
+	if (r1.IsRectEmpty())
+		*this = r2;
+	else if (r2.IsRectEmpty())
+		*this = r1;
+	else
+		SetRect(min(r1.left, r2.left), min(r1.top, r2.top), max(r1.right, r2.right), max(r1.bottom, r2.bottom));
+	return !IsRectEmpty();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CFile
+
+CFile::CFile()
+{
+	m_file = NULL;
+}
+
+CFile::CFile(LPCTSTR filename, UINT flags)
+{
+	m_file = NULL;
+	CFileException* error = new CFileException;
+	if (!Open(filename, flags, error))
+		throw error;
+	error->Delete();
+}
+
+CFile::~CFile()
+{
+	if (m_file)
+		fclose(m_file);
+}
+
+BOOL CFile::Open(LPCTSTR filename, UINT flags, CFileException* error)
+{
+	const char* mode = "rb";
+	if (flags & modeCreate)
+		mode = (flags & modeNoTruncate) ? "ab+" : ((flags & modeReadWrite) ? "wb+" : "wb");
+	else if (flags & (modeWrite | modeReadWrite))
+		mode = "rb+";
+
+	m_file = fopen(filename, mode);
+	if (!m_file)
+	{
+		if (error)
+			error->m_cause = errno;
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+void CFile::Close()
+{
+	if (m_file)
+	{
+		FILE* file = m_file;
+		m_file = NULL;
+		if (fclose(file) != 0)
+			AfxThrowFileException(errno);
+	}
+}
+
+UINT CFile::Read(void* buffer, UINT count)
+{
+	ASSERT(m_file);
+	return static_cast<UINT>(fread(buffer, 1, count, m_file));
+}
+
+void CFile::Write(const void* buffer, UINT count)
+{
+	ASSERT(m_file);
+	if (count && fwrite(buffer, 1, count, m_file) != count)
+		AfxThrowFileException(errno);
+}
+
+ULONGLONG CFile::Seek(LONGLONG offset, UINT from)
+{
+	ASSERT(m_file);
+	if (fseeko(m_file, offset, from == begin ? SEEK_SET : (from == current ? SEEK_CUR : SEEK_END)) != 0)
+		AfxThrowFileException(errno);
+	return GetPosition();
+}
+
+ULONGLONG CFile::GetLength() const
+{
+	ASSERT(m_file);
+	struct stat info;
+	fflush(m_file);
+	if (fstat(fileno(m_file), &info) != 0)
+		return 0;
+	return static_cast<ULONGLONG>(info.st_size);
+}
+
+ULONGLONG CFile::GetPosition() const
+{
+	ASSERT(m_file);
+	return static_cast<ULONGLONG>(ftello(m_file));
+}
+
+void CFile::SetLength(ULONGLONG length)
+{
+	ASSERT(m_file);
+	fflush(m_file);
+	if (ftruncate(fileno(m_file), static_cast<off_t>(length)) != 0)
+		AfxThrowFileException(errno);
+}
+
+void CFile::Flush()
+{
+	if (m_file)
+		fflush(m_file);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CStdioFile
+
+BOOL CStdioFile::ReadString(CString& str)
+{
+	ASSERT(m_file);
+	str.Empty();
+	std::string line;
+	int c;
+	BOOL read = FALSE;
+	while ((c = fgetc(m_file)) != EOF)
+	{
+		read = TRUE;
+		if (c == '\n')
+			break;
+		line += static_cast<char>(c);
+	}
+
+	if (!line.empty() && line[line.size() - 1] == '\r')
+		line.erase(line.size() - 1);
+	str = line.c_str();
+	return read;
+}
+
+void CStdioFile::WriteString(LPCTSTR str)
+{
+	ASSERT(m_file);
+	fputs(str, m_file);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CMemFile
+
+CMemFile::CMemFile(UINT growBy)
+{
+	m_data.reserve(growBy);
+	m_position = 0;
+}
+
+CMemFile::~CMemFile()
+{
+}
+
+void CMemFile::Close()
+{
+	m_data.clear();
+	m_position = 0;
+}
+
+UINT CMemFile::Read(void* buffer, UINT count)
+{
+	size_t available = m_position < m_data.size() ? m_data.size() - m_position : 0;
+	UINT read = static_cast<UINT>(min(static_cast<size_t>(count), available));
+	if (read)
+		memcpy(buffer, &m_data[m_position], read);
+	m_position += read;
+	return read;
+}
+
+void CMemFile::Write(const void* buffer, UINT count)
+{
+	if (!count)
+		return;
+	if (m_position + count > m_data.size())
+		m_data.resize(m_position + count);
+	memcpy(&m_data[m_position], buffer, count);
+	m_position += count;
+}
+
+ULONGLONG CMemFile::Seek(LONGLONG offset, UINT from)
+{
+	LONGLONG base = from == begin ? 0 : (from == current ? static_cast<LONGLONG>(m_position) : static_cast<LONGLONG>(m_data.size()));
+	if (base + offset < 0)
+		AfxThrowFileException(EINVAL);
+	m_position = static_cast<size_t>(base + offset);
+	return m_position;
+}
+
+ULONGLONG CMemFile::GetLength() const
+{
+	return m_data.size();
+}
+
+ULONGLONG CMemFile::GetPosition() const
+{
+	return m_position;
+}
+
+void CMemFile::SetLength(ULONGLONG length)
+{
+	m_data.resize(static_cast<size_t>(length));
+	m_position = min(m_position, m_data.size());
+}
+
+BYTE* CMemFile::Detach()
+{
+	BYTE* result = static_cast<BYTE*>(malloc(max(m_data.size(), static_cast<size_t>(1))));
+	if (!m_data.empty())
+		memcpy(result, &m_data[0], m_data.size());
+	Close();
+	return result;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CArchive
+
+BOOL CArchive::ReadString(CString& str)
+{
+	str.Empty();
+	std::string line;
+	char c;
+	UINT read = 0;
+	while (m_file->Read(&c, 1) == 1)
+	{
+		read++;
+		if (c == '\n')
+			break;
+		line += c;
+	}
+
+	if (!read)
+		return FALSE;
+
+	if (!line.empty() && line[line.size() - 1] == '\r')
+		line.erase(line.size() - 1);
+	str = line.c_str();
+	return TRUE;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// GDI
+
+HINSTANCE AfxGetResourceHandle()
+{
+	return NULL;
+}
+
+HANDLE LoadImage(HINSTANCE, LPCTSTR, UINT, int, int, UINT)
+{
+	return NULL;
+}
+
+int GetObject(HANDLE, int, LPVOID)
+{
+	return 0;
+}
+
+HDC CreateCompatibleDC(HDC)
+{
+	return NULL;
+}
+
+int GetDIBits(HDC, HBITMAP, UINT, UINT, LPVOID, BITMAPINFO*, UINT)
+{
+	return 0;
+}
+
+BOOL DeleteDC(HDC)
+{
+	return TRUE;
+}
+
+BOOL DeleteObject(HGDIOBJ)
+{
+	return TRUE;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Handles
+
+enum HandleKind
+{
+	HANDLE_EVENT,
+	HANDLE_THREAD,
+	HANDLE_FILE
+};
+
+struct CShimHandle
+{
+	HandleKind	kind;
+	BOOL		signaled;
+	BOOL		manualReset;	// Events only
+	std::thread	thread;			// Threads only
+	int			fd;				// Files only
+	std::string	path;			// Files deleted on close
+};
+
+// Guards "signaled" of all handles
+static std::mutex				s_waitLock;
+static std::condition_variable	s_waitChanged;
+
+static CShimHandle* GetShimHandle(HANDLE handle)
+{
+	ASSERT(handle != NULL && handle != INVALID_HANDLE_VALUE);
+	return static_cast<CShimHandle*>(handle);
+}
+
+HANDLE CreateEvent(void*, BOOL manualReset, BOOL initialState, LPCTSTR)
+{
+	CShimHandle* handle = new CShimHandle;
+	handle->kind = HANDLE_EVENT;
+	handle->signaled = initialState;
+	handle->manualReset = manualReset;
+	handle->fd = -1;
+	return handle;
+}
+
+BOOL SetEvent(HANDLE event)
+{
+	std::lock_guard< std::mutex > lock(s_waitLock);
+	GetShimHandle(event)->signaled = TRUE;
+	s_waitChanged.notify_all();
+	return TRUE;
+}
+
+BOOL ResetEvent(HANDLE event)
+{
+	std::lock_guard< std::mutex > lock(s_waitLock);
+	GetShimHandle(event)->signaled = FALSE;
+	return TRUE;
+}
+
+// Consumes the signal of an auto-reset event, "s_waitLock" is held
+static void Acquire(CShimHandle* handle)
+{
+	if (handle->kind == HANDLE_EVENT && !handle->manualReset)
+		handle->signaled = FALSE;
+}
+
+DWORD WaitForMultipleObjects(DWORD count, const HANDLE* handles, BOOL waitAll, DWORD milliseconds)
+{
+	std::unique_lock< std::mutex > lock(s_waitLock);
+
+	std::function< int() > ready = [&]() -> int
+	{
+		DWORD signaled = 0;
+		for (DWORD t = 0; t < count; t++)
+		{
+			if (GetShimHandle(handles[t])->signaled)
+			{
+				if (!waitAll)
+					return static_cast<int>(t);
+				signaled++;
+			}
+		}
+		return signaled == count ? 0 : -1;
+	};
+
+	int index;
+	if (milliseconds == INFINITE)
+	{
+		while ((index = ready()) < 0)
+			s_waitChanged.wait(lock);
+	}
+	else
+	{
+		std::chrono::steady_clock::time_point until = std::chrono::steady_clock::now() + std::chrono::milliseconds(milliseconds);
+		while ((index = ready()) < 0)
+		{
+			if (s_waitChanged.wait_until(lock, until) == std::cv_status::timeout && (index = ready()) < 0)
+				return WAIT_TIMEOUT;
+		}
+	}
+
+	if (waitAll)
+	{
+		for (DWORD t = 0; t < count; t++)
+			Acquire(GetShimHandle(handles[t]));
+	}
+	else
+		Acquire(GetShimHandle(handles[index]));
+
+	return WAIT_OBJECT_0 + index;
+}
+
+DWORD WaitForSingleObject(HANDLE handle, DWORD milliseconds)
+{
+	return WaitForMultipleObjects(1, &handle, TRUE, milliseconds);
+}
+
+BOOL CloseHandle(HANDLE handle)
+{
+	if (handle == NULL || handle == INVALID_HANDLE_VALUE)
+		return FALSE;
+
+	CShimHandle* shim = GetShimHandle(handle);
+	if (shim->kind == HANDLE_THREAD && shim->thread.joinable())
+	{
+		if (shim->thread.get_id() == std::this_thread::get_id())
+			shim->thread.detach();
+		else
+			shim->thread.join();
+	}
+	if (shim->kind == HANDLE_FILE)
+	{
+		close(shim->fd);
+		if (!shim->path.empty())
+			unlink(shim->path.c_str());
+	}
+
+	delete shim;
+	return TRUE;
+}
+
+void Sleep(DWORD milliseconds)
+{
+	std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+}
+
+DWORD GetCurrentThreadId()
+{
+	return static_cast<DWORD>(std::hash< std::thread::id >()(std::this_thread::get_id()));
+}
+
+DWORD GetCurrentProcessId()
+{
+	return static_cast<DWORD>(getpid());
+}
+
+DWORD GetTickCount()
+{
+	return static_cast<DWORD>(std::chrono::duration_cast< std::chrono::milliseconds >(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Fiber local storage
+
+static std::mutex				s_flsLock;
+static PFLS_CALLBACK_FUNCTION	s_flsCallbacks[FLS_MAXIMUM];
+static BOOL						s_flsUsed[FLS_MAXIMUM];
+static thread_local PVOID		t_flsValues[FLS_MAXIMUM];
+
+DWORD FlsAlloc(PFLS_CALLBACK_FUNCTION callback)
+{
+	std::lock_guard< std::mutex > lock(s_flsLock);
+	for (DWORD t = 0; t < FLS_MAXIMUM; t++)
+	{
+		if (!s_flsUsed[t])
+		{
+			s_flsUsed[t] = TRUE;
+			s_flsCallbacks[t] = callback;
+			t_flsValues[t] = NULL;
+			return t;
+		}
+	}
+
+	return FLS_OUT_OF_INDEXES;
+}
+
+BOOL FlsFree(DWORD index)
+{
+	if (index >= FLS_MAXIMUM)
+		return FALSE;
+
+	PFLS_CALLBACK_FUNCTION callback;
+	{
+		std::lock_guard< std::mutex > lock(s_flsLock);
+		callback = s_flsCallbacks[index];
+		s_flsUsed[index] = FALSE;
+		s_flsCallbacks[index] = NULL;
+	}
+
+	PVOID value = t_flsValues[index];
+	t_flsValues[index] = NULL;
+	if (callback && value)
+		callback(value);
+
+	return TRUE;
+}
+
+PVOID FlsGetValue(DWORD index)
+{
+	return index < FLS_MAXIMUM ? t_flsValues[index] : NULL;
+}
+
+BOOL FlsSetValue(DWORD index, PVOID value)
+{
+	if (index >= FLS_MAXIMUM)
+		return FALSE;
+
+	t_flsValues[index] = value;
+	return TRUE;
+}
+
+// Calls the callbacks of the slots the exiting thread has set.
+static void FlsThreadExit()
+{
+	for (DWORD t = 0; t < FLS_MAXIMUM; t++)
+	{
+		PVOID value = t_flsValues[t];
+		if (!value)
+			continue;
+
+		t_flsValues[t] = NULL;
+		PFLS_CALLBACK_FUNCTION callback;
+		{
+			std::lock_guard< std::mutex > lock(s_flsLock);
+			callback = s_flsUsed[t] ? s_flsCallbacks[t] : NULL;
+		}
+		if (callback)
+			callback(value);
+	}
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CWinThread
+
+CWinThread::CWinThread(AFX_THREADPROC proc, LPVOID param)
+{
+	CShimHandle* handle = new CShimHandle;
+	handle->kind = HANDLE_THREAD;
+	handle->signaled = FALSE;
+	handle->manualReset = TRUE;
+	handle->fd = -1;
+
+	m_hThread = handle;
+	m_bAutoDelete = TRUE;
+	m_proc = proc;
+	m_param = param;
+}
+
+CWinThread::~CWinThread()
+{
+	CloseHandle(m_hThread);
+}
+
+DWORD CWinThread::ResumeThread()
+{
+	// Threads are always started suspended, so this runs once. The
+	// thread takes "s_waitLock" before it can delete itself, so it
+	// cannot go before it is stored.
+	CShimHandle* handle = GetShimHandle(m_hThread);
+	std::lock_guard< std::mutex > lock(s_waitLock);
+	ASSERT(!handle->thread.joinable());
+	handle->thread = std::thread([this, handle]()
+	{
+		m_proc(m_param);
+		FlsThreadExit();
+
+		BOOL autoDelete;
+		{
+			std::lock_guard< std::mutex > lock(s_waitLock);
+			autoDelete = m_bAutoDelete;
+			handle->signaled = TRUE;
+			s_waitChanged.notify_all();
+		}
+
+		if (autoDelete)
+			delete this;
+	});
+
+	return 1;
+}
+
+CWinThread* AfxBeginThread(AFX_THREADPROC proc, LPVOID param, int, UINT, DWORD flags, void*)
+{
+	CWinThread* thread = new CWinThread(proc, param);
+	if (!(flags & CREATE_SUSPENDED))
+		thread->ResumeThread();
+	return thread;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Critical sections
+
+void InitializeCriticalSection(CRITICAL_SECTION* section)
+{
+	section->mutex = new std::recursive_mutex;
+}
+
+void DeleteCriticalSection(CRITICAL_SECTION* section)
+{
+	delete section->mutex;
+	section->mutex = NULL;
+}
+
+void EnterCriticalSection(CRITICAL_SECTION* section)
+{
+	section->mutex->lock();
+}
+
+void LeaveCriticalSection(CRITICAL_SECTION* section)
+{
+	section->mutex->unlock();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Timing and system information
+
+BOOL QueryPerformanceCounter(LARGE_INTEGER* counter)
+{
+	counter->QuadPart = std::chrono::duration_cast< std::chrono::nanoseconds >(std::chrono::steady_clock::now().time_since_epoch()).count();
+	return TRUE;
+}
+
+BOOL QueryPerformanceFrequency(LARGE_INTEGER* frequency)
+{
+	frequency->QuadPart = 1000000000;
+	return TRUE;
+}
+
+void GetSystemInfo(SYSTEM_INFO* info)
+{
+	info->dwPageSize = static_cast<DWORD>(sysconf(_SC_PAGESIZE));
+	info->dwNumberOfProcessors = max(1u, std::thread::hardware_concurrency());
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Win32 files
+
+DWORD GetTempPath(DWORD length, LPTSTR buffer)
+{
+	LPCTSTR path = getenv("TMPDIR");
+	if (!path || !*path)
+		path = "/tmp";
+
+	std::string result(path);
+	if (result[result.size() - 1] != '/')
+		result += '/';
+	if (result.size() >= length)
+		return static_cast<DWORD>(result.size() + 1);
+
+	strcpy(buffer, result.c_str());
+	return static_cast<DWORD>(result.size());
+}
+
+UINT GetTempFileName(LPCTSTR path, LPCTSTR prefix, UINT, LPTSTR name)
+{
+	std::string pattern(path);
+	if (!pattern.empty() && pattern[pattern.size() - 1] != '/')
+		pattern += '/';
+	pattern += prefix;
+	pattern += "XXXXXX";
+	if (pattern.size() >= MAX_PATH)
+		return 0;
+
+	strcpy(name, pattern.c_str());
+	int fd = mkstemp(name);
+	if (fd < 0)
+		return 0;
+
+	close(fd);
+	return 1;
+}
+
+HANDLE CreateFile(LPCTSTR name, DWORD access, DWORD, void*, DWORD creation, DWORD flags, HANDLE)
+{
+	int mode = (access & GENERIC_WRITE) ? ((access & GENERIC_READ) ? O_RDWR : O_WRONLY) : O_RDONLY;
+	if (creation == CREATE_ALWAYS)
+		mode |= O_CREAT | O_TRUNC;
+
+	int fd = open(name, mode, 0600);
+	if (fd < 0)
+		return INVALID_HANDLE_VALUE;
+
+	CShimHandle* handle = new CShimHandle;
+	handle->kind = HANDLE_FILE;
+	handle->signaled = FALSE;
+	handle->manualReset = TRUE;
+	handle->fd = fd;
+
+	// The name can go now, the file lives until it is closed
+	if (flags & FILE_FLAG_DELETE_ON_CLOSE)
+		unlink(name);
+
+	return handle;
+}
+
+BOOL ReadFile(HANDLE file, LPVOID buffer, DWORD count, DWORD* read, OVERLAPPED* overlapped)
+{
+	CShimHandle* handle = GetShimHandle(file);
+	ssize_t result;
+	if (overlapped)
+		result = pread(handle->fd, buffer, count, static_cast<off_t>((static_cast<ULONGLONG>(overlapped->OffsetHigh) << 32) | overlapped->Offset));
+	else
+		result = ::read(handle->fd, buffer, count);
+
+	if (read)
+		*read = result < 0 ? 0 : static_cast<DWORD>(result);
+	return result >= 0;
+}
+
+BOOL WriteFile(HANDLE file, LPCVOID buffer, DWORD count, DWORD* written, OVERLAPPED* overlapped)
+{
+	CShimHandle* handle = GetShimHandle(file);
+	ssize_t result;
+	if (overlapped)
+		result = pwrite(handle->fd, buffer, count, static_cast<off_t>((static_cast<ULONGLONG>(overlapped->OffsetHigh) << 32) | overlapped->Offset));
+	else
+		result = ::write(handle->fd, buffer, count);
+
+	if (written)
+		*written = result < 0 ? 0 : static_cast<DWORD>(result);
+	return result >= 0;
+}
+
+BOOL SetFilePointerEx(HANDLE file, LARGE_INTEGER distance, LARGE_INTEGER* position, DWORD method)
+{
+	CShimHandle* handle = GetShimHandle(file);
+	off_t result = lseek(handle->fd, static_cast<off_t>(distance.QuadPart), method == FILE_BEGIN ? SEEK_SET : (method == FILE_CURRENT ? SEEK_CUR : SEEK_END));
+	if (result < 0)
+		return FALSE;
+	if (position)
+		position->QuadPart = result;
+	return TRUE;
+}
+
+BOOL SetEndOfFile(HANDLE file)
+{
+	CShimHandle* handle = GetShimHandle(file);
+	off_t position = lseek(handle->fd, 0, SEEK_CUR);
+	return position >= 0 && ftruncate(handle->fd, position) == 0;
+}
+
+BOOL DeleteFile(LPCTSTR name)
+{
+	return unlink(name) == 0;
+}
+
+// Paths with backslashes, as the Windows code builds them
+static std::string GetNativePath(LPCTSTR name)
+{
+	std::string path(name);
+	std::replace(path.begin(), path.end(), '\\', '/');
+	return path;
+}
+
+// Matches "*" and "?" wildcards, ignoring case as Windows does
+static BOOL MatchWildcard(const char* pattern, const char* name)
+{
+	if (*pattern == '*')
+		return MatchWildcard(pattern + 1, name) || (*name && MatchWildcard(pattern, name + 1));
+	if (!*pattern)
+		return !*name;
+	if (!*name)
+		return FALSE;
+	if (*pattern != '?' && tolower(static_cast<unsigned char>(*pattern)) != tolower(static_cast<unsigned char>(*name)))
+		return FALSE;
+	return MatchWildcard(pattern + 1, name + 1);
+}
+
+// The entries a "FindFirstFile" found, handed out one at a time
+struct CShimFind
+{
+	std::vector< WIN32_FIND_DATA >	entries;
+	size_t							next;
+};
+
+static BOOL NextFind(CShimFind* find, WIN32_FIND_DATA* data)
+{
+	if (find->next >= find->entries.size())
+	{
+		errno = ENOENT;
+		return FALSE;
+	}
+
+	*data = find->entries[find->next++];
+	return TRUE;
+}
+
+HANDLE FindFirstFile(LPCTSTR pattern, WIN32_FIND_DATA* data)
+{
+	std::filesystem::path path(GetNativePath(pattern));
+	std::filesystem::path directory = path.parent_path();
+	std::string filter = path.filename().string();
+	if (directory.empty())
+		directory = ".";
+
+	std::error_code error;
+	std::filesystem::directory_iterator it(directory, error);
+	if (error)
+	{
+		errno = error.value();
+		return INVALID_HANDLE_VALUE;
+	}
+
+	CShimFind* find = new CShimFind;
+	find->next = 0;
+	const char* dots[2] = { ".", ".." };
+	for (int t = 0; t < 2; t++)
+	{
+		if (MatchWildcard(filter.c_str(), dots[t]))
+		{
+			WIN32_FIND_DATA entry;
+			entry.dwFileAttributes = FILE_ATTRIBUTE_DIRECTORY;
+			strcpy(entry.cFileName, dots[t]);
+			find->entries.push_back(entry);
+		}
+	}
+
+	for (; it != std::filesystem::directory_iterator(); it.increment(error))
+	{
+		std::string name = it->path().filename().string();
+		if (name.size() < MAX_PATH && MatchWildcard(filter.c_str(), name.c_str()))
+		{
+			WIN32_FIND_DATA entry;
+			entry.dwFileAttributes = it->is_directory(error) ? FILE_ATTRIBUTE_DIRECTORY : FILE_ATTRIBUTE_NORMAL;
+			strcpy(entry.cFileName, name.c_str());
+			find->entries.push_back(entry);
+		}
+	}
+
+	if (!NextFind(find, data))
+	{
+		delete find;
+		return INVALID_HANDLE_VALUE;
+	}
+
+	return find;
+}
+
+BOOL FindNextFile(HANDLE find, WIN32_FIND_DATA* data)
+{
+	return NextFind(static_cast<CShimFind*>(find), data);
+}
+
+BOOL FindClose(HANDLE find)
+{
+	delete static_cast<CShimFind*>(find);
+	return TRUE;
+}
+
+BOOL CopyFile(LPCTSTR source, LPCTSTR dest, BOOL failIfExists)
+{
+	std::error_code error;
+	std::filesystem::copy_file(GetNativePath(source), GetNativePath(dest),
+		failIfExists ? std::filesystem::copy_options::none : std::filesystem::copy_options::overwrite_existing, error);
+	if (error)
+		errno = error.value();
+	return !error;
+}
+
+BOOL CreateDirectory(LPCTSTR name, void*)
+{
+	return mkdir(GetNativePath(name).c_str(), 0755) == 0;
+}
+
+BOOL RemoveDirectory(LPCTSTR name)
+{
+	return rmdir(GetNativePath(name).c_str()) == 0;
+}
+
+DWORD GetCurrentDirectory(DWORD length, LPTSTR buffer)
+{
+	std::error_code error;
+	std::string path = std::filesystem::current_path(error).string();
+	if (error)
+	{
+		errno = error.value();
+		return 0;
+	}
+
+	if (path.size() >= length)
+		return static_cast<DWORD>(path.size() + 1);
+
+	strcpy(buffer, path.c_str());
+	return static_cast<DWORD>(path.size());
+}
+
+BOOL SetCurrentDirectory(LPCTSTR name)
+{
+	return chdir(GetNativePath(name).c_str()) == 0;
+}
+
+DWORD GetLastError()
+{
+	return static_cast<DWORD>(errno);
+}
+
+// Copies "length" characters of "str", if they fit "size"
+static errno_t CopyPathPart(LPTSTR buffer, size_t size, LPCTSTR str, size_t length)
+{
+	if (!buffer)
+		return 0;
+	if (length >= size)
+	{
+		if (size)
+			*buffer = '\0';
+		return ERANGE;
+	}
+
+	memcpy(buffer, str, length);
+	buffer[length] = '\0';
+	return 0;
+}
+
+errno_t _tsplitpath_s(LPCTSTR path, LPTSTR drive, size_t driveSize, LPTSTR dir, size_t dirSize, LPTSTR fname, size_t fnameSize, LPTSTR ext, size_t extSize)
+{
+	size_t length = strlen(path);
+	size_t start = (length >= 2 && path[1] == ':') ? 2 : 0;
+	size_t name = start;
+	for (size_t t = start; t < length; t++)
+		if (path[t] == '\\' || path[t] == '/')
+			name = t + 1;
+
+	size_t dot = length;
+	for (size_t t = name; t < length; t++)
+		if (path[t] == '.')
+			dot = t;
+
+	errno_t result = CopyPathPart(drive, driveSize, path, start);
+	if (!result)
+		result = CopyPathPart(dir, dirSize, path + start, name - start);
+	if (!result)
+		result = CopyPathPart(fname, fnameSize, path + name, dot - name);
+	if (!result)
+		result = CopyPathPart(ext, extSize, path + dot, length - dot);
+	return result;
+}
+
+DWORD FormatMessage(DWORD flags, LPCVOID, DWORD id, DWORD, LPTSTR buffer, DWORD size, void*)
+{
+	LPCTSTR message = strerror(static_cast<int>(id));
+	if (flags & FORMAT_MESSAGE_ALLOCATE_BUFFER)
+	{
+		*reinterpret_cast<LPTSTR*>(buffer) = strdup(message);
+		return static_cast<DWORD>(strlen(message));
+	}
+
+	lstrcpyn(buffer, message, static_cast<int>(size));
+	return static_cast<DWORD>(strlen(buffer));
+}
+
+HLOCAL LocalFree(HLOCAL memory)
+{
+	free(memory);
+	return NULL;
+}
@@ -0,0 +1,1060 @@
+#ifndef _PORTABLEAFX_H_6A3D0E81_92C4_4F57_B1E8C05D7A3F2
+#define _PORTABLEAFX_H_6A3D0E81_92C4_4F57_B1E8C05D7A3F2
+
+///////////////////////////////////////////////////////////
+// File :		PortableAfx.h
+// Created :	10/19/26
+//
+// The part of MFC and Win32 the engine sources use - strings,
+// collections, points and rectangles, exceptions, files,
+// threads, events and critical sections - written on the C++
+// standard library, so the engine can be built and timed
+// without Windows. It is not a general replacement for MFC:
+// only what the engine sources call is here, with the same
+// behaviour where they depend on it. Strings are narrow, as
+// in a non-Unicode MFC build.
+//
+
+// The standard headers come before the "min" and "max" macros
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <assert.h>
+#include <ctype.h>
+#include <limits.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/////////////////////////////////////////////////////////////////////////////
+// Types
+
+typedef int					BOOL;
+typedef unsigned char		BYTE;
+typedef unsigned short		WORD;
+typedef unsigned int		DWORD;
+typedef unsigned int		UINT;
+typedef int					LONG;
+typedef long long			LONGLONG;
+typedef unsigned long long	ULONGLONG;
+typedef intptr_t			INT_PTR;
+typedef uintptr_t			UINT_PTR;
+typedef uintptr_t			DWORD_PTR;
+typedef void*				LPVOID;
+typedef const void*			LPCVOID;
+typedef char				TCHAR;
+typedef char				_TCHAR;
+typedef unsigned char		_TUCHAR;
+typedef char*				LPSTR;
+typedef const char*			LPCSTR;
+typedef char*				LPTSTR;
+typedef const char*			LPCTSTR;
+typedef wchar_t*			LPWSTR;
+typedef const wchar_t*		LPCWSTR;
+typedef DWORD				COLORREF;
+typedef void*				HANDLE;
+typedef void*				HLOCAL;
+typedef int					errno_t;
+typedef void*				HINSTANCE;
+typedef void*				HBITMAP;
+typedef void*				HDC;
+typedef void*				HGDIOBJ;
+typedef void*				POSITION;
+
+#define TRUE				1
+#define FALSE				0
+#ifndef NULL
+#define NULL				0
+#endif
+
+#define _T(x)				x
+#define AFX_CDECL
+#define WINAPI
+#define MAX_PATH			260
+#define INFINITE			0xFFFFFFFF
+#define INVALID_HANDLE_VALUE	(reinterpret_cast<HANDLE>(static_cast<INT_PTR>(-1)))
+
+#define min(a, b)			(((a) < (b)) ? (a) : (b))
+#define max(a, b)			(((a) > (b)) ? (a) : (b))
+#define _countof(a)			(sizeof(a) / sizeof((a)[0]))
+
+#define RGB(r, g, b)		(static_cast<COLORREF>(static_cast<BYTE>(r) | (static_cast<WORD>(static_cast<BYTE>(g)) << 8) | (static_cast<DWORD>(static_cast<BYTE>(b)) << 16)))
+#define GetRValue(rgb)		(static_cast<BYTE>(rgb))
+#define GetGValue(rgb)		(static_cast<BYTE>(static_cast<WORD>(rgb) >> 8))
+#define GetBValue(rgb)		(static_cast<BYTE>((rgb) >> 16))
+
+#define LOWORD(l)			(static_cast<WORD>(static_cast<DWORD_PTR>(l) & 0xffff))
+#define HIWORD(l)			(static_cast<WORD>((static_cast<DWORD_PTR>(l) >> 16) & 0xffff))
+
+typedef union _LARGE_INTEGER
+{
+	struct
+	{
+		DWORD	LowPart;
+		LONG	HighPart;
+	};
+	LONGLONG	QuadPart;
+} LARGE_INTEGER;
+
+/////////////////////////////////////////////////////////////////////////////
+// Diagnostics
+
+#define DEBUG_NEW			new
+#define ASSERT(f)			assert(f)
+#define VERIFY(f)			((void)(f))
+#define ASSERT_VALID(p)		((void)0)
+
+inline void AfxTrace(LPCTSTR, ...) {}
+#define TRACE				AfxTrace
+
+/////////////////////////////////////////////////////////////////////////////
+// Character functions
+
+#define _tcslen				strlen
+#define _tcsclen				strlen
+#define _tcscmp				strcmp
+#define _tcsicmp			strcasecmp
+#define _tcsncmp			strncmp
+#define _tcsnicmp			strncasecmp
+#define _tcschr				strchr
+#define _tcsrchr			strrchr
+#define _tcsstr				strstr
+#define _tcscpy				strcpy
+#define _tcscpy_s(d, s)		lstrcpyn((d), (s), static_cast<int>(sizeof(d)))
+#define _tcsncpy			strncpy
+#define _ttoi				atoi
+#define _ttol				atol
+#define _tstof				atof
+#define _tcstol				strtol
+#define _tcstoul			strtoul
+#define _tcstod				strtod
+#define _stprintf			sprintf
+#define _istspace(c)		isspace(static_cast<unsigned char>(c))
+#define _istalpha(c)		isalpha(static_cast<unsigned char>(c))
+#define _istdigit(c)		isdigit(static_cast<unsigned char>(c))
+#define _istalnum(c)		isalnum(static_cast<unsigned char>(c))
+#define _istascii(c)		(static_cast<unsigned int>(c) < 0x80)
+#define _istxdigit(c)		isxdigit(static_cast<unsigned char>(c))
+#define _istupper(c)		isupper(static_cast<unsigned char>(c))
+#define _istlower(c)		islower(static_cast<unsigned char>(c))
+#define _totupper(c)		toupper(static_cast<unsigned char>(c))
+#define _totlower(c)		tolower(static_cast<unsigned char>(c))
+#define lstrlen(s)			static_cast<int>(strlen(s))
+#define lstrcmp				strcmp
+#define lstrcmpi			strcasecmp
+#define lstrcpy				strcpy
+#define lstrcpyn(d, s, n)	(strncpy((d), (s), (n) - 1), (d)[(n) - 1] = 0, (d))
+
+/////////////////////////////////////////////////////////////////////////////
+// CObject
+
+class CObject
+{
+public:
+	virtual ~CObject() {}
+
+protected:
+	CObject() {}
+
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// Exceptions
+
+class CException : public CObject
+{
+public:
+	CException() {}
+
+	void			Delete() { delete this; }
+	virtual BOOL	GetErrorMessage(LPTSTR error, UINT max, UINT* help = NULL) const;
+
+};
+
+class CMemoryException : public CException
+{
+public:
+	virtual BOOL	GetErrorMessage(LPTSTR error, UINT max, UINT* help = NULL) const;
+
+};
+
+class CFileException : public CException
+{
+public:
+	CFileException(int error = 0) : m_cause(error) {}
+	virtual BOOL	GetErrorMessage(LPTSTR error, UINT max, UINT* help = NULL) const;
+
+	int		m_cause;	// "errno"
+
+};
+
+void AfxThrowMemoryException();
+void AfxThrowFileException(int cause);
+
+#define TRY					try {
+#define CATCH(type, e)		} catch (type* e) {
+#define AND_CATCH(type, e)	} catch (type* e) {
+#define END_CATCH			}
+#define CATCH_ALL(e)		} catch (CException* e) {
+#define AND_CATCH_ALL(e)	} catch (CException* e) {
+#define END_CATCH_ALL		}
+#define THROW(e)			throw e
+#define THROW_LAST()		throw
+
+/////////////////////////////////////////////////////////////////////////////
+// CString
+
+class CString
+{
+public:
+	// Construction
+	CString() {}
+	CString(const CString& str) : m_str(str.m_str) {}
+	CString(LPCTSTR str) : m_str(str ? str : "") {}
+	CString(LPCTSTR str, int length) : m_str(str, length) {}
+	CString(TCHAR c, int repeat = 1) : m_str(repeat, c) {}
+
+	CString& operator=(const CString& str) { m_str = str.m_str; return *this; }
+	CString& operator=(LPCTSTR str) { m_str = str ? str : ""; return *this; }
+	CString& operator=(TCHAR c) { m_str.assign(1, c); return *this; }
+
+	// Attributes
+	int			GetLength() const { return static_cast<int>(m_str.size()); }
+	BOOL		IsEmpty() const { return m_str.empty(); }
+	void		Empty() { m_str.clear(); }
+	TCHAR		GetAt(int index) const { ASSERT(index >= 0 && index < GetLength()); return m_str[index]; }
+	void		SetAt(int index, TCHAR c) { ASSERT(index >= 0 && index < GetLength()); m_str[index] = c; }
+	TCHAR		operator[](int index) const { return GetAt(index); }
+	TCHAR		operator[](INT_PTR index) const { return GetAt(static_cast<int>(index)); }
+	operator	LPCTSTR() const { return m_str.c_str(); }
+	LPCTSTR		GetString() const { return m_str.c_str(); }
+
+	// Concatenation
+	CString&	operator+=(const CString& str) { m_str += str.m_str; return *this; }
+	CString&	operator+=(LPCTSTR str) { m_str += str; return *this; }
+	CString&	operator+=(TCHAR c) { m_str += c; return *this; }
+	void		Append(LPCTSTR str) { m_str += str; }
+	void		Append(LPCTSTR str, int length) { m_str.append(str, length); }
+	void		AppendChar(TCHAR c) { m_str += c; }
+
+	friend CString operator+(const CString& s1, const CString& s2) { CString result(s1); result += s2; return result; }
+	friend CString operator+(const CString& s1, LPCTSTR s2) { CString result(s1); result += s2; return result; }
+	friend CString operator+(LPCTSTR s1, const CString& s2) { CString result(s1); result += s2; return result; }
+	friend CString operator+(const CString& s1, TCHAR c) { CString result(s1); result += c; return result; }
+	friend CString operator+(TCHAR c, const CString& s2) { CString result(c); result += s2; return result; }
+
+	// Comparison
+	int			Compare(LPCTSTR str) const { return strcmp(m_str.c_str(), str); }
+	int			CompareNoCase(LPCTSTR str) const { return strcasecmp(m_str.c_str(), str); }
+
+	friend bool operator==(const CString& s1, const CString& s2) { return s1.m_str == s2.m_str; }
+	friend bool operator==(const CString& s1, LPCTSTR s2) { return strcmp(s1.m_str.c_str(), s2) == 0; }
+	friend bool operator==(LPCTSTR s1, const CString& s2) { return strcmp(s1, s2.m_str.c_str()) == 0; }
+	friend bool operator!=(const CString& s1, const CString& s2) { return s1.m_str != s2.m_str; }
+	friend bool operator!=(const CString& s1, LPCTSTR s2) { return strcmp(s1.m_str.c_str(), s2) != 0; }
+	friend bool operator!=(LPCTSTR s1, const CString& s2) { return strcmp(s1, s2.m_str.c_str()) != 0; }
+	friend bool operator<(const CString& s1, const CString& s2) { return s1.m_str < s2.m_str; }
+	friend bool operator>(const CString& s1, const CString& s2) { return s1.m_str > s2.m_str; }
+
+	// Extraction
+	CString		Mid(int first) const;
+	CString		Mid(int first, int count) const;
+	CString		Left(int count) const;
+	CString		Right(int count) const;
+	CString		SpanIncluding(LPCTSTR set) const;
+	CString		SpanExcluding(LPCTSTR set) const;
+	CString		Tokenize(LPCTSTR tokens, int& start) const;
+
+	// Searching
+	int			Find(TCHAR c, int start = 0) const;
+	int			Find(LPCTSTR str, int start = 0) const;
+	int			ReverseFind(TCHAR c) const;
+	int			FindOneOf(LPCTSTR set) const;
+
+	// Modification
+	int			Replace(TCHAR oldChar, TCHAR newChar);
+	int			Replace(LPCTSTR oldStr, LPCTSTR newStr);
+	int			Remove(TCHAR c);
+	int			Insert(int index, TCHAR c);
+	int			Insert(int index, LPCTSTR str);
+	int			Delete(int index, int count = 1);
+	CString&	MakeUpper();
+	CString&	MakeLower();
+	CString&	MakeReverse();
+	CString&	Trim();
+	CString&	Trim(TCHAR c);
+	CString&	Trim(LPCTSTR set);
+	CString&	TrimLeft();
+	CString&	TrimLeft(TCHAR c);
+	CString&	TrimLeft(LPCTSTR set);
+	CString&	TrimRight();
+	CString&	TrimRight(TCHAR c);
+	CString&	TrimRight(LPCTSTR set);
+
+	// Formatting
+	void		Format(LPCTSTR format, ...);
+	void		AppendFormat(LPCTSTR format, ...);
+	void		FormatV(LPCTSTR format, va_list args);
+	BOOL		LoadString(UINT id);
+
+	// Buffer access
+	LPTSTR		GetBuffer(int minLength = 0);
+	LPTSTR		GetBufferSetLength(int length);
+	void		ReleaseBuffer(int length = -1);
+	void		Preallocate(int length) { m_str.reserve(length); }
+	int			GetAllocLength() const { return static_cast<int>(m_str.capacity()); }
+	void		ReleaseBufferSetLength(int length) { ReleaseBuffer(length); }
+
+	// For the hash maps
+	const std::string& GetStdString() const { return m_str; }
+
+private:
+	std::string	m_str;
+
+};
+
+// The string header, for memory accounting
+namespace ATL
+{
+	struct CStringData
+	{
+		void*	pStringMgr;
+		int		nDataLength;
+		int		nAllocLength;
+		long	nRefs;
+	};
+}
+
+// Strings are narrow, so the ATL conversions do nothing
+typedef CString		CStringA;
+#define CP_ACP		0
+#define CP_UTF8		65001
+#define CT2W(s)		(s)
+#define CW2A(s, cp)	(s)
+#define CA2T(s)		(s)
+
+/////////////////////////////////////////////////////////////////////////////
+// Points, sizes and rectangles
+
+typedef struct tagPOINT
+{
+	LONG	x;
+	LONG	y;
+} POINT;
+
+typedef struct tagSIZE
+{
+	LONG	cx;
+	LONG	cy;
+} SIZE;
+
+typedef struct tagRECT
+{
+	LONG	left;
+	LONG	top;
+	LONG	right;
+	LONG	bottom;
+} RECT, *LPRECT;
+
+typedef const RECT* LPCRECT;
+
+class CSize : public tagSIZE
+{
+public:
+	CSize() { cx = 0; cy = 0; }
+	CSize(int x, int y) { cx = x; cy = y; }
+	CSize(SIZE size) { cx = size.cx; cy = size.cy; }
+	CSize(POINT pt) { cx = pt.x; cy = pt.y; }
+
+	bool	operator==(SIZE size) const { return cx == size.cx && cy == size.cy; }
+	bool	operator!=(SIZE size) const { return !(*this == size); }
+	void	operator+=(SIZE size) { cx += size.cx; cy += size.cy; }
+	void	operator-=(SIZE size) { cx -= size.cx; cy -= size.cy; }
+	CSize	operator+(SIZE size) const { return CSize(cx + size.cx, cy + size.cy); }
+	CSize	operator-(SIZE size) const { return CSize(cx - size.cx, cy - size.cy); }
+	CSize	operator-() const { return CSize(-cx, -cy); }
+
+};
+
+class CPoint : public tagPOINT
+{
+public:
+	CPoint() { x = 0; y = 0; }
+	CPoint(int px, int py) { x = px; y = py; }
+	CPoint(POINT pt) { x = pt.x; y = pt.y; }
+	CPoint(SIZE size) { x = size.cx; y = size.cy; }
+
+	void	Offset(int dx, int dy) { x += dx; y += dy; }
+	void	Offset(POINT pt) { x += pt.x; y += pt.y; }
+	void	SetPoint(int px, int py) { x = px; y = py; }
+
+	bool	operator==(POINT pt) const { return x == pt.x && y == pt.y; }
+	bool	operator!=(POINT pt) const { return !(*this == pt); }
+	void	operator+=(POINT pt) { x += pt.x; y += pt.y; }
+	void	operator-=(POINT pt) { x -= pt.x; y -= pt.y; }
+	void	operator+=(SIZE size) { x += size.cx; y += size.cy; }
+	void	operator-=(SIZE size) { x -= size.cx; y -= size.cy; }
+	CPoint	operator+(POINT pt) const { return CPoint(x + pt.x, y + pt.y); }
+	CSize	operator-(POINT pt) const { return CSize(x - pt.x, y - pt.y); }
+	CPoint	operator+(SIZE size) const { return CPoint(x + size.cx, y + size.cy); }
+	CPoint	operator-(SIZE size) const { return CPoint(x - size.cx, y - size.cy); }
+	CPoint	operator-() const { return CPoint(-x, -y); }
+
+};
+
+class CRect : public tagRECT
+{
+public:
+	CRect() { left = 0; top = 0; right = 0; bottom = 0; }
+	CRect(int l, int t, int r, int b) { left = l; top = t; right = r; bottom = b; }
+	CRect(const RECT& rect) { left = rect.left; top = rect.top; right = rect.right; bottom = rect.bottom; }
+	CRect(LPCRECT rect) { left = rect->left; top = rect->top; right = rect->right; bottom = rect->bottom; }
+	CRect(POINT pt, SIZE size) { left = pt.x; top = pt.y; right = pt.x + size.cx; bottom = pt.y + size.cy; }
+	CRect(POINT topLeft, POINT bottomRight) { left = topLeft.x; top = topLeft.y; right = bottomRight.x; bottom = bottomRight.y; }
+
+	// Attributes
+	int			Width() const { return right - left; }
+	int			Height() const { return bottom - top; }
+	CSize		Size() const { return CSize(Width(), Height()); }
+	CPoint&		TopLeft() { return *reinterpret_cast<CPoint*>(this); }
+	CPoint&		BottomRight() { return *(reinterpret_cast<CPoint*>(this) + 1); }
+	const CPoint& TopLeft() const { return *reinterpret_cast<const CPoint*>(this); }
+	const CPoint& BottomRight() const { return *(reinterpret_cast<const CPoint*>(this) + 1); }
+	CPoint		CenterPoint() const { return CPoint((left + right) / 2, (top + bottom) / 2); }
+	BOOL		IsRectEmpty() const { return left >= right || top >= bottom; }
+	BOOL		IsRectNull() const { return left == 0 && top == 0 && right == 0 && bottom == 0; }
+	BOOL		PtInRect(POINT pt) const { return pt.x >= left && pt.x < right && pt.y >= top && pt.y < bottom; }
+	BOOL		EqualRect(LPCRECT rect) const { return left == rect->left && top == rect->top && right == rect->right && bottom == rect->bottom; }
+
+	operator	LPRECT() { return this; }
+	operator	LPCRECT() const { return this; }
+
+	// Operations
+	void		SetRect(int l, int t, int r, int b) { left = l; top = t; right = r; bottom = b; }
+	void		SetRect(POINT topLeft, POINT bottomRight) { SetRect(topLeft.x, topLeft.y, bottomRight.x, bottomRight.y); }
+	void		SetRectEmpty() { SetRect(0, 0, 0, 0); }
+	void		CopyRect(LPCRECT rect) { *this = CRect(rect); }
+	void		InflateRect(int x, int y) { left -= x; top -= y; right += x; bottom += y; }
+	void		InflateRect(SIZE size) { InflateRect(size.cx, size.cy); }
+	void		InflateRect(int l, int t, int r, int b) { left -= l; top -= t; right += r; bottom += b; }
+	void		DeflateRect(int x, int y) { InflateRect(-x, -y); }
+	void		DeflateRect(SIZE size) { InflateRect(-size.cx, -size.cy); }
+	void		DeflateRect(int l, int t, int r, int b) { InflateRect(-l, -t, -r, -b); }
+	void		OffsetRect(int x, int y) { left += x; top += y; right += x; bottom += y; }
+	void		OffsetRect(POINT pt) { OffsetRect(pt.x, pt.y); }
+	void		OffsetRect(SIZE size) { OffsetRect(size.cx, size.cy); }
+	void		MoveToXY(int x, int y) { OffsetRect(x - left, y - top); }
+	void		NormalizeRect();
+	BOOL		IntersectRect(LPCRECT rect1, LPCRECT rect2);
+	BOOL		UnionRect(LPCRECT rect1, LPCRECT rect2);
+
+	bool		operator==(const RECT& rect) const { return EqualRect(&rect) != FALSE; }
+	bool		operator!=(const RECT& rect) const { return !EqualRect(&rect); }
+	void		operator&=(const RECT& rect) { IntersectRect(this, &rect); }
+	void		operator|=(const RECT& rect) { UnionRect(this, &rect); }
+	void		operator+=(POINT pt) { OffsetRect(pt); }
+	void		operator-=(POINT pt) { OffsetRect(-pt.x, -pt.y); }
+	CRect		operator+(POINT pt) const { CRect rect(*this); rect.OffsetRect(pt); return rect; }
+	CRect		operator-(POINT pt) const { CRect rect(*this); rect.OffsetRect(-pt.x, -pt.y); return rect; }
+
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// Arrays
+
+template< class TYPE, class ARG_TYPE = const TYPE& >
+class CArray : public CObject
+{
+public:
+	CArray() {}
+	virtual ~CArray() {}
+
+	// Attributes
+	INT_PTR		GetSize() const { return static_cast<INT_PTR>(m_data.size()); }
+	INT_PTR		GetCount() const { return GetSize(); }
+	INT_PTR		GetUpperBound() const { return GetSize() - 1; }
+	BOOL		IsEmpty() const { return m_data.empty(); }
+	void		SetSize(INT_PTR size, INT_PTR growBy = -1);
+
+	// Operations
+	void		FreeExtra() { m_data.shrink_to_fit(); }
+	void		RemoveAll() { m_data.clear(); }
+
+	// Element access
+	TYPE&		GetAt(INT_PTR index) { ASSERT(index >= 0 && index < GetSize()); return m_data[index]; }
+	const TYPE&	GetAt(INT_PTR index) const { ASSERT(index >= 0 && index < GetSize()); return m_data[index]; }
+	void		SetAt(INT_PTR index, ARG_TYPE element) { ASSERT(index >= 0 && index < GetSize()); m_data[index] = element; }
+	TYPE&		ElementAt(INT_PTR index) { return GetAt(index); }
+	const TYPE&	ElementAt(INT_PTR index) const { return GetAt(index); }
+	TYPE*		GetData() { return m_data.empty() ? NULL : &m_data[0]; }
+	const TYPE*	GetData() const { return m_data.empty() ? NULL : &m_data[0]; }
+	TYPE&		operator[](INT_PTR index) { return GetAt(index); }
+	const TYPE&	operator[](INT_PTR index) const { return GetAt(index); }
+
+	// Growing
+	void		SetAtGrow(INT_PTR index, ARG_TYPE element);
+	INT_PTR		Add(ARG_TYPE element) { m_data.push_back(element); return GetSize() - 1; }
+	INT_PTR		Append(const CArray& src);
+	void		Copy(const CArray& src) { if (this != &src) m_data = src.m_data; }
+
+	// Inserting and removing
+	void		InsertAt(INT_PTR index, ARG_TYPE element, INT_PTR count = 1);
+	void		InsertAt(INT_PTR index, CArray* array);
+	void		RemoveAt(INT_PTR index, INT_PTR count = 1);
+
+private:
+	std::vector< TYPE >	m_data;
+
+};
+
+template< class TYPE, class ARG_TYPE >
+void CArray< TYPE, ARG_TYPE >::SetSize(INT_PTR size, INT_PTR growBy)
+{
+	ASSERT(size >= 0);
+	if (growBy > 0 && static_cast<size_t>(size) > m_data.capacity())
+		m_data.reserve(size + growBy);
+	m_data.resize(size, TYPE());
+}
+
+template< class TYPE, class ARG_TYPE >
+void CArray< TYPE, ARG_TYPE >::SetAtGrow(INT_PTR index, ARG_TYPE element)
+{
+	ASSERT(index >= 0);
+	if (index >= GetSize())
+		m_data.resize(index + 1, TYPE());
+	m_data[index] = element;
+}
+
+template< class TYPE, class ARG_TYPE >
+INT_PTR CArray< TYPE, ARG_TYPE >::Append(const CArray& src)
+{
+	INT_PTR old = GetSize();
+	if (this == &src)
+	{
+		std::vector< TYPE > copy(src.m_data);
+		m_data.insert(m_data.end(), copy.begin(), copy.end());
+	}
+	else
+		m_data.insert(m_data.end(), src.m_data.begin(), src.m_data.end());
+	return old;
+}
+
+template< class TYPE, class ARG_TYPE >
+void CArray< TYPE, ARG_TYPE >::InsertAt(INT_PTR index, ARG_TYPE element, INT_PTR count)
+{
+	ASSERT(index >= 0 && count > 0);
+	TYPE value(element);
+	if (index > GetSize())
+		m_data.resize(index, TYPE());
+	m_data.insert(m_data.begin() + index, count, value);
+}
+
+template< class TYPE, class ARG_TYPE >
+void CArray< TYPE, ARG_TYPE >::InsertAt(INT_PTR index, CArray* array)
+{
+	ASSERT(index >= 0 && array != NULL);
+	std::vector< TYPE > copy(array->m_data);
+	if (index > GetSize())
+		m_data.resize(index, TYPE());
+	m_data.insert(m_data.begin() + index, copy.begin(), copy.end());
+}
+
+template< class TYPE, class ARG_TYPE >
+void CArray< TYPE, ARG_TYPE >::RemoveAt(INT_PTR index, INT_PTR count)
+{
+	ASSERT(index >= 0 && count >= 0 && index + count <= GetSize());
+	m_data.erase(m_data.begin() + index, m_data.begin() + index + count);
+}
+
+class CObArray : public CArray< CObject*, CObject* > {};
+class CPtrArray : public CArray< void*, void* > {};
+class CByteArray : public CArray< BYTE, BYTE > {};
+class CWordArray : public CArray< WORD, WORD > {};
+class CDWordArray : public CArray< DWORD, DWORD > {};
+class CUIntArray : public CArray< UINT, UINT > {};
+class CStringArray : public CArray< CString, const CString& > {};
+
+/////////////////////////////////////////////////////////////////////////////
+// Maps
+
+template< class KEY >
+struct CShimHash
+{
+	size_t operator()(const KEY& key) const { return std::hash< KEY >()(key); }
+};
+
+template<>
+struct CShimHash< CString >
+{
+	size_t operator()(const CString& key) const { return std::hash< std::string >()(key.GetStdString()); }
+};
+
+// Entries are kept in an array, so "POSITION" is an index. Removing
+// an entry moves the last entry into its place, so removing while
+// iterating is not supported, as with MFC.
+template< class KEY, class ARG_KEY, class VALUE, class ARG_VALUE >
+class CMap : public CObject
+{
+public:
+	CMap() {}
+	virtual ~CMap() {}
+
+	// Attributes
+	INT_PTR		GetCount() const { return static_cast<INT_PTR>(m_entries.size()); }
+	INT_PTR		GetSize() const { return GetCount(); }
+	BOOL		IsEmpty() const { return m_entries.empty(); }
+	BOOL		Lookup(ARG_KEY key, VALUE& value) const;
+
+	// Operations
+	VALUE&		operator[](ARG_KEY key);
+	void		SetAt(ARG_KEY key, ARG_VALUE value) { (*this)[key] = value; }
+	BOOL		RemoveKey(ARG_KEY key);
+	void		RemoveAll() { m_entries.clear(); m_index.clear(); }
+	void		InitHashTable(UINT size, BOOL = TRUE) { m_index.reserve(size); }
+	UINT		GetHashTableSize() const { return static_cast<UINT>(m_index.bucket_count()); }
+
+	// Iteration
+	POSITION	GetStartPosition() const { return m_entries.empty() ? NULL : reinterpret_cast<POSITION>(static_cast<UINT_PTR>(1)); }
+	void		GetNextAssoc(POSITION& pos, KEY& key, VALUE& value) const;
+
+private:
+	std::vector< std::pair< KEY, VALUE > >				m_entries;
+	std::unordered_map< KEY, size_t, CShimHash< KEY > >	m_index;
+
+};
+
+template< class KEY, class ARG_KEY, class VALUE, class ARG_VALUE >
+BOOL CMap< KEY, ARG_KEY, VALUE, ARG_VALUE >::Lookup(ARG_KEY key, VALUE& value) const
+{
+	typename std::unordered_map< KEY, size_t, CShimHash< KEY > >::const_iterator it = m_index.find(KEY(key));
+	if (it == m_index.end())
+		return FALSE;
+	value = m_entries[it->second].second;
+	return TRUE;
+}
+
+template< class KEY, class ARG_KEY, class VALUE, class ARG_VALUE >
+VALUE& CMap< KEY, ARG_KEY, VALUE, ARG_VALUE >::operator[](ARG_KEY key)
+{
+	KEY k(key);
+	typename std::unordered_map< KEY, size_t, CShimHash< KEY > >::iterator it = m_index.find(k);
+	if (it != m_index.end())
+		return m_entries[it->second].second;
+	m_index[k] = m_entries.size();
+	m_entries.push_back(std::pair< KEY, VALUE >(k, VALUE()));
+	return m_entries.back().second;
+}
+
+template< class KEY, class ARG_KEY, class VALUE, class ARG_VALUE >
+BOOL CMap< KEY, ARG_KEY, VALUE, ARG_VALUE >::RemoveKey(ARG_KEY key)
+{
+	typename std::unordered_map< KEY, size_t, CShimHash< KEY > >::iterator it = m_index.find(KEY(key));
+	if (it == m_index.end())
+		return FALSE;
+	size_t index = it->second;
+	m_index.erase(it);
+	if (index != m_entries.size() - 1)
+	{
+		m_entries[index] = m_entries.back();
+		m_index[m_entries[index].first] = index;
+	}
+	m_entries.pop_back();
+	return TRUE;
+}
+
+template< class KEY, class ARG_KEY, class VALUE, class ARG_VALUE >
+void CMap< KEY, ARG_KEY, VALUE, ARG_VALUE >::GetNextAssoc(POSITION& pos, KEY& key, VALUE& value) const
+{
+	size_t index = reinterpret_cast<UINT_PTR>(pos) - 1;
+	ASSERT(index < m_entries.size());
+	key = m_entries[index].first;
+	value = m_entries[index].second;
+	pos = index + 1 < m_entries.size() ? reinterpret_cast<POSITION>(static_cast<UINT_PTR>(index + 2)) : NULL;
+}
+
+class CMapStringToPtr : public CMap< CString, LPCTSTR, void*, void* > {};
+class CMapStringToOb : public CMap< CString, LPCTSTR, CObject*, CObject* > {};
+class CMapStringToString : public CMap< CString, LPCTSTR, CString, LPCTSTR > {};
+class CMapPtrToPtr : public CMap< void*, void*, void*, void* > {};
+class CMapPtrToWord : public CMap< void*, void*, WORD, WORD > {};
+class CMapWordToPtr : public CMap< WORD, WORD, void*, void* > {};
+
+/////////////////////////////////////////////////////////////////////////////
+// Files
+
+class CFile : public CObject
+{
+public:
+	enum OpenFlags
+	{
+		modeRead = 0x0000,
+		modeWrite = 0x0001,
+		modeReadWrite = 0x0002,
+		shareDenyNone = 0x0040,
+		shareDenyWrite = 0x0020,
+		shareExclusive = 0x0010,
+		typeBinary = 0x8000,
+		modeCreate = 0x1000,
+		modeNoTruncate = 0x2000
+	};
+
+	enum SeekPosition
+	{
+		begin = 0,
+		current = 1,
+		end = 2
+	};
+
+	CFile();
+	CFile(LPCTSTR filename, UINT flags);
+	virtual ~CFile();
+
+	virtual BOOL		Open(LPCTSTR filename, UINT flags, CFileException* error = NULL);
+	virtual void		Close();
+	virtual UINT		Read(void* buffer, UINT count);
+	virtual void		Write(const void* buffer, UINT count);
+	virtual ULONGLONG	Seek(LONGLONG offset, UINT from);
+	virtual ULONGLONG	GetLength() const;
+	virtual ULONGLONG	GetPosition() const;
+	virtual void		SetLength(ULONGLONG length);
+	virtual void		Flush();
+
+	ULONGLONG			SeekToEnd() { return Seek(0, end); }
+	void				SeekToBegin() { Seek(0, begin); }
+
+protected:
+	FILE*	m_file;
+
+};
+
+// Reads and writes lines, with "\n" endings
+class CStdioFile : public CFile
+{
+public:
+	BOOL				ReadString(CString& str);
+	void				WriteString(LPCTSTR str);
+
+};
+
+class CMemFile : public CFile
+{
+public:
+	CMemFile(UINT growBy = 1024);
+	virtual ~CMemFile();
+
+	virtual BOOL		Open(LPCTSTR, UINT, CFileException* = NULL) { return FALSE; }
+	virtual void		Close();
+	virtual UINT		Read(void* buffer, UINT count);
+	virtual void		Write(const void* buffer, UINT count);
+	virtual ULONGLONG	Seek(LONGLONG offset, UINT from);
+	virtual ULONGLONG	GetLength() const;
+	virtual ULONGLONG	GetPosition() const;
+	virtual void		SetLength(ULONGLONG length);
+	virtual void		Flush() {}
+
+	BYTE*				Detach();
+
+private:
+	std::vector< BYTE >	m_data;
+	size_t				m_position;
+
+};
+
+// Reads and writes lines of text, unbuffered, so the file can be used
+// between calls. "ReadString" drops the line ending.
+class CArchive
+{
+public:
+	enum Mode
+	{
+		store = 0,
+		load = 1
+	};
+
+	CArchive(CFile* file, UINT mode) : m_file(file), m_mode(mode) {}
+
+	BOOL		IsStoring() const { return m_mode == store; }
+	BOOL		IsLoading() const { return m_mode == load; }
+	CFile*		GetFile() const { return m_file; }
+	void		Flush() {}
+	void		Close() {}
+
+	void		Write(const void* buffer, UINT count) { m_file->Write(buffer, count); }
+	UINT		Read(void* buffer, UINT count) { return m_file->Read(buffer, count); }
+	void		WriteString(LPCTSTR str) { Write(str, static_cast<UINT>(_tcslen(str))); }
+	BOOL		ReadString(CString& str);
+
+private:
+	CFile*		m_file;
+	UINT		m_mode;
+
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// GDI - the constants the renderers use. There are no device contexts,
+// and no resources, so "LoadImage" always fails.
+
+class CDC;
+
+#define PS_SOLID			0
+#define PS_DASH				1
+#define PS_DOT				2
+#define PS_DASHDOT			3
+#define PS_DASHDOTDOT		4
+#define PS_NULL				5
+
+#define FW_NORMAL			400
+#define FW_BOLD				700
+
+#define TRANSPARENT			1
+#define OPAQUE				2
+
+#define DT_TOP				0x00000000
+#define DT_LEFT				0x00000000
+#define DT_CENTER			0x00000001
+#define DT_RIGHT			0x00000002
+#define DT_VCENTER			0x00000004
+#define DT_BOTTOM			0x00000008
+#define DT_WORDBREAK		0x00000010
+#define DT_SINGLELINE		0x00000020
+#define DT_NOCLIP			0x00000100
+#define DT_CALCRECT			0x00000400
+#define DT_NOPREFIX			0x00000800
+
+#define IMAGE_BITMAP		0
+#define LR_CREATEDIBSECTION	0x00002000
+#define BI_RGB				0
+#define DIB_RGB_COLORS		0
+#define MAKEINTRESOURCE(i)	(reinterpret_cast<LPTSTR>(static_cast<UINT_PTR>(static_cast<WORD>(i))))
+
+typedef struct tagBITMAP
+{
+	LONG	bmType;
+	LONG	bmWidth;
+	LONG	bmHeight;
+	LONG	bmWidthBytes;
+	WORD	bmPlanes;
+	WORD	bmBitsPixel;
+	LPVOID	bmBits;
+} BITMAP;
+
+typedef struct tagBITMAPINFOHEADER
+{
+	DWORD	biSize;
+	LONG	biWidth;
+	LONG	biHeight;
+	WORD	biPlanes;
+	WORD	biBitCount;
+	DWORD	biCompression;
+	DWORD	biSizeImage;
+	LONG	biXPelsPerMeter;
+	LONG	biYPelsPerMeter;
+	DWORD	biClrUsed;
+	DWORD	biClrImportant;
+} BITMAPINFOHEADER;
+
+typedef struct tagBITMAPINFO
+{
+	BITMAPINFOHEADER	bmiHeader;
+	DWORD				bmiColors[1];
+} BITMAPINFO;
+
+HINSTANCE	AfxGetResourceHandle();
+HANDLE		LoadImage(HINSTANCE instance, LPCTSTR name, UINT type, int cx, int cy, UINT flags);
+int			GetObject(HANDLE object, int size, LPVOID buffer);
+HDC			CreateCompatibleDC(HDC dc);
+int			GetDIBits(HDC dc, HBITMAP bitmap, UINT start, UINT lines, LPVOID bits, BITMAPINFO* info, UINT usage);
+BOOL		DeleteDC(HDC dc);
+BOOL		DeleteObject(HGDIOBJ object);
+
+/////////////////////////////////////////////////////////////////////////////
+// Threads, events and critical sections
+
+#define THREAD_PRIORITY_NORMAL			0
+#define THREAD_PRIORITY_BELOW_NORMAL	-1
+#define THREAD_PRIORITY_ABOVE_NORMAL	1
+#define CREATE_SUSPENDED				0x00000004
+#define WAIT_OBJECT_0					0
+#define WAIT_TIMEOUT					258
+#define WAIT_FAILED						0xFFFFFFFF
+
+typedef UINT (AFX_CDECL *AFX_THREADPROC)(LPVOID);
+
+class CWinThread : public CObject
+{
+public:
+	CWinThread(AFX_THREADPROC proc, LPVOID param);
+	virtual ~CWinThread();
+
+	DWORD	ResumeThread();
+
+	HANDLE	m_hThread;
+	BOOL	m_bAutoDelete;
+
+private:
+	AFX_THREADPROC	m_proc;
+	LPVOID			m_param;
+
+};
+
+CWinThread*	AfxBeginThread(AFX_THREADPROC proc, LPVOID param, int priority = THREAD_PRIORITY_NORMAL, UINT stackSize = 0, DWORD flags = 0, void* security = NULL);
+
+HANDLE		CreateEvent(void* security, BOOL manualReset, BOOL initialState, LPCTSTR name);
+BOOL		SetEvent(HANDLE event);
+BOOL		ResetEvent(HANDLE event);
+DWORD		WaitForSingleObject(HANDLE handle, DWORD milliseconds);
+DWORD		WaitForMultipleObjects(DWORD count, const HANDLE* handles, BOOL waitAll, DWORD milliseconds);
+BOOL		CloseHandle(HANDLE handle);
+void		Sleep(DWORD milliseconds);
+DWORD		GetCurrentThreadId();
+DWORD		GetCurrentProcessId();
+DWORD		GetTickCount();
+
+typedef struct _CRITICAL_SECTION
+{
+	std::recursive_mutex*	mutex;
+} CRITICAL_SECTION;
+
+void		InitializeCriticalSection(CRITICAL_SECTION* section);
+void		DeleteCriticalSection(CRITICAL_SECTION* section);
+void		EnterCriticalSection(CRITICAL_SECTION* section);
+void		LeaveCriticalSection(CRITICAL_SECTION* section);
+
+typedef void*	PVOID;
+
+inline LONG InterlockedIncrement(volatile LONG* value) { return __atomic_add_fetch(value, 1, __ATOMIC_SEQ_CST); }
+inline LONG InterlockedDecrement(volatile LONG* value) { return __atomic_sub_fetch(value, 1, __ATOMIC_SEQ_CST); }
+inline LONG InterlockedExchange(volatile LONG* target, LONG value) { return __atomic_exchange_n(target, value, __ATOMIC_SEQ_CST); }
+inline LONG InterlockedExchangeAdd(volatile LONG* target, LONG value) { return __atomic_fetch_add(target, value, __ATOMIC_SEQ_CST); }
+inline LONG InterlockedCompareExchange(volatile LONG* target, LONG value, LONG comparand) { __atomic_compare_exchange_n(target, &comparand, value, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST); return comparand; }
+inline PVOID InterlockedCompareExchangePointer(PVOID volatile* target, PVOID value, PVOID comparand) { __atomic_compare_exchange_n(target, &comparand, value, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST); return comparand; }
+inline LONGLONG InterlockedIncrement64(volatile LONGLONG* value) { return __atomic_add_fetch(value, 1, __ATOMIC_SEQ_CST); }
+inline LONGLONG InterlockedCompareExchange64(volatile LONGLONG* target, LONGLONG value, LONGLONG comparand) { __atomic_compare_exchange_n(target, &comparand, value, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST); return comparand; }
+inline PVOID InterlockedExchangePointer(PVOID volatile* target, PVOID value) { return __atomic_exchange_n(target, value, __ATOMIC_SEQ_CST); }
+
+// Fiber local storage, for its callback when a thread exits. The
+// callbacks run when a "CWinThread" returns, before its handle is
+// signaled, and "FlsFree" only calls the callback for its own thread.
+#define FLS_OUT_OF_INDEXES	0xFFFFFFFF
+#define FLS_MAXIMUM			16
+
+typedef void (WINAPI *PFLS_CALLBACK_FUNCTION)(PVOID);
+
+DWORD		FlsAlloc(PFLS_CALLBACK_FUNCTION callback);
+BOOL		FlsFree(DWORD index);
+PVOID		FlsGetValue(DWORD index);
+BOOL		FlsSetValue(DWORD index, PVOID value);
+
+// "__declspec( thread )" is the only declaration specifier used
+#define __declspec(x)		__declspec_##x
+#define __declspec_thread	thread_local
+
+/////////////////////////////////////////////////////////////////////////////
+// Timing and system information
+
+BOOL		QueryPerformanceCounter(LARGE_INTEGER* counter);
+BOOL		QueryPerformanceFrequency(LARGE_INTEGER* frequency);
+
+typedef struct _SYSTEM_INFO
+{
+	DWORD	dwPageSize;
+	DWORD	dwNumberOfProcessors;
+} SYSTEM_INFO;
+
+void		GetSystemInfo(SYSTEM_INFO* info);
+
+/////////////////////////////////////////////////////////////////////////////
+// Win32 files
+
+#define GENERIC_READ				0x80000000
+#define GENERIC_WRITE				0x40000000
+#define CREATE_ALWAYS				2
+#define OPEN_EXISTING				3
+#define FILE_SHARE_READ				0x00000001
+#define FILE_SHARE_WRITE			0x00000002
+#define FILE_ATTRIBUTE_NORMAL		0x00000080
+#define FILE_ATTRIBUTE_TEMPORARY	0x00000100
+#define FILE_FLAG_DELETE_ON_CLOSE	0x04000000
+#define FILE_BEGIN					0
+#define FILE_CURRENT				1
+#define FILE_END					2
+
+typedef struct _OVERLAPPED
+{
+	UINT_PTR	Internal;
+	UINT_PTR	InternalHigh;
+	DWORD		Offset;
+	DWORD		OffsetHigh;
+	HANDLE		hEvent;
+} OVERLAPPED;
+
+DWORD		GetTempPath(DWORD length, LPTSTR buffer);
+UINT		GetTempFileName(LPCTSTR path, LPCTSTR prefix, UINT unique, LPTSTR name);
+HANDLE		CreateFile(LPCTSTR name, DWORD access, DWORD share, void* security, DWORD creation, DWORD flags, HANDLE templateFile);
+BOOL		ReadFile(HANDLE file, LPVOID buffer, DWORD count, DWORD* read, OVERLAPPED* overlapped);
+BOOL		WriteFile(HANDLE file, LPCVOID buffer, DWORD count, DWORD* written, OVERLAPPED* overlapped);
+BOOL		SetFilePointerEx(HANDLE file, LARGE_INTEGER distance, LARGE_INTEGER* position, DWORD method);
+BOOL		SetEndOfFile(HANDLE file);
+BOOL		DeleteFile(LPCTSTR name);
+
+// Directories and finding files. Paths may use backslashes, they are
+// read as slashes. "GetLastError" is "errno".
+#define FILE_ATTRIBUTE_DIRECTORY	0x00000010
+
+typedef struct _WIN32_FIND_DATA
+{
+	DWORD		dwFileAttributes;
+	TCHAR		cFileName[MAX_PATH];
+} WIN32_FIND_DATA;
+
+HANDLE		FindFirstFile(LPCTSTR pattern, WIN32_FIND_DATA* data);
+BOOL		FindNextFile(HANDLE find, WIN32_FIND_DATA* data);
+BOOL		FindClose(HANDLE find);
+BOOL		CopyFile(LPCTSTR source, LPCTSTR dest, BOOL failIfExists);
+BOOL		CreateDirectory(LPCTSTR name, void* security);
+BOOL		RemoveDirectory(LPCTSTR name);
+DWORD		GetCurrentDirectory(DWORD length, LPTSTR buffer);
+BOOL		SetCurrentDirectory(LPCTSTR name);
+DWORD		GetLastError();
+
+#define _MAX_DRIVE					3
+#define _MAX_DIR					256
+#define _MAX_FNAME					256
+#define _MAX_EXT					256
+
+// Splits at the last slash or backslash and the last dot after it
+errno_t		_tsplitpath_s(LPCTSTR path, LPTSTR drive, size_t driveSize, LPTSTR dir, size_t dirSize, LPTSTR fname, size_t fnameSize, LPTSTR ext, size_t extSize);
+
+template< size_t drive, size_t dir, size_t fname, size_t ext >
+errno_t		_tsplitpath_s(LPCTSTR path, TCHAR (&driveBuffer)[drive], TCHAR (&dirBuffer)[dir], TCHAR (&fnameBuffer)[fname], TCHAR (&extBuffer)[ext])
+{
+	return _tsplitpath_s(path, driveBuffer, drive, dirBuffer, dir, fnameBuffer, fname, extBuffer, ext);
+}
+
+#define FORMAT_MESSAGE_ALLOCATE_BUFFER	0x00000100
+#define FORMAT_MESSAGE_FROM_SYSTEM		0x00001000
+#define LANG_NEUTRAL				0x00
+#define SUBLANG_DEFAULT				0x01
+#define MAKELANGID(p, s)			((static_cast<WORD>(s) << 10) | static_cast<WORD>(p))
+
+// Only system messages, into a buffer freed with "LocalFree"
+DWORD		FormatMessage(DWORD flags, LPCVOID source, DWORD id, DWORD language, LPTSTR buffer, DWORD size, void* arguments);
+HLOCAL		LocalFree(HLOCAL memory);
+
+#endif //_PORTABLEAFX_H_6A3D0E81_92C4_4F57_B1E8C05D7A3F2
@@ -0,0 +1,829 @@
+/* ==========================================================================
+	File :			PortableWnd.cpp
+
+	Class :			CDC, CRgn, CFont, CShimListItems
+
+	Date :			10/19/26
+
+	Purpose :		The windows, device contexts and GDI objects the
+					editors refer to, written on the C++ standard
+					library. See "PortableWnd.h".
+
+	Description :	Nothing is shown. Device contexts keep their state
+					and measure text, regions hit-test, and the system
+					colors and stock objects are those of Windows.
+
+	Usage :			Only built by the portable targets in
+					"CMakeLists.txt".
+
+   ========================================================================*/
+
+// Before the "min" and "max" macros
+#include <map>
+#include <random>
+
+#include "stdafx.h"
+#include "atlenc.h"
+
+/////////////////////////////////////////////////////////////////////////////
+// Message boxes and string resources
+
+int AfxMessageBox(LPCTSTR text, UINT type, UINT)
+{
+	fprintf(stderr, "%s\n", text);
+	switch (type & 0x0F)
+	{
+		case MB_OKCANCEL:
+			return IDCANCEL;
+		case MB_YESNOCANCEL:
+			return IDCANCEL;
+		case MB_YESNO:
+			return IDNO;
+	}
+
+	return IDOK;
+}
+
+int AfxMessageBox(UINT id, UINT type, UINT help)
+{
+	CString text;
+	text.Format(_T("String resource %u"), id);
+	return AfxMessageBox(text, type, help);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Colors, cursors and system metrics
+
+DWORD GetSysColor(int index)
+{
+	switch (index)
+	{
+		case COLOR_SCROLLBAR:
+			return RGB(200, 200, 200);
+		case COLOR_WINDOW:
+			return RGB(255, 255, 255);
+		case COLOR_3DFACE:
+			return RGB(240, 240, 240);
+		case COLOR_3DSHADOW:
+			return RGB(160, 160, 160);
+		case COLOR_GRAYTEXT:
+			return RGB(109, 109, 109);
+		case COLOR_3DHIGHLIGHT:
+			return RGB(255, 255, 255);
+		case COLOR_3DDKSHADOW:
+			return RGB(105, 105, 105);
+		case COLOR_3DLIGHT:
+			return RGB(227, 227, 227);
+	}
+
+	return RGB(0, 0, 0);
+}
+
+HCURSOR LoadCursor(HINSTANCE, LPCTSTR name)
+{
+	return const_cast<LPTSTR>(name);
+}
+
+HCURSOR SetCursor(HCURSOR cursor)
+{
+	return cursor;
+}
+
+LONG GetDialogBaseUnits()
+{
+	// 8 point MS Sans Serif at 96 dpi
+	return MAKELONG(6, 13);
+}
+
+UINT RegisterWindowMessage(LPCTSTR name)
+{
+	static std::mutex lock;
+	static std::map< std::string, UINT > messages;
+
+	std::lock_guard< std::mutex > guard(lock);
+	std::map< std::string, UINT >::iterator it = messages.find(name);
+	if (it != messages.end())
+		return it->second;
+
+	UINT message = 0xC000 + static_cast<UINT>(messages.size());
+	messages[name] = message;
+	return message;
+}
+
+BOOL ReleaseCapture()
+{
+	return TRUE;
+}
+
+DWORD GetModuleFileName(HINSTANCE, LPTSTR filename, DWORD size)
+{
+	std::error_code error;
+	std::string path = std::filesystem::read_symlink("/proc/self/exe", error).string();
+	if (error || path.size() >= size)
+		return 0;
+
+	strcpy(filename, path.c_str());
+	return static_cast<DWORD>(path.size());
+}
+
+int MultiByteToWideChar(UINT, DWORD, LPCSTR str, int length, LPWSTR wide, int wideLength)
+{
+	if (length < 0)
+		length = static_cast<int>(strlen(str)) + 1;
+	if (!wideLength)
+		return length;
+	if (wideLength < length)
+		return 0;
+
+	for (int t = 0; t < length; t++)
+		wide[t] = static_cast<unsigned char>(str[t]);
+	return length;
+}
+
+int WideCharToMultiByte(UINT, DWORD, LPCWSTR wide, int length, LPSTR str, int strLength, LPCSTR defaultChar, BOOL* usedDefault)
+{
+	if (length < 0)
+		length = static_cast<int>(wcslen(wide)) + 1;
+	if (usedDefault)
+		*usedDefault = FALSE;
+	if (!strLength)
+		return length;
+	if (strLength < length)
+		return 0;
+
+	for (int t = 0; t < length; t++)
+	{
+		if (static_cast<unsigned int>(wide[t]) > 0xFF)
+		{
+			str[t] = defaultChar ? *defaultChar : '?';
+			if (usedDefault)
+				*usedDefault = TRUE;
+		}
+		else
+			str[t] = static_cast<char>(wide[t]);
+	}
+
+	return length;
+}
+
+HMODULE GetModuleHandle(LPCTSTR)
+{
+	return NULL;
+}
+
+HRSRC FindResource(HMODULE, LPCTSTR, LPCTSTR)
+{
+	return NULL;
+}
+
+HGLOBAL LoadResource(HMODULE, HRSRC)
+{
+	return NULL;
+}
+
+DWORD SizeofResource(HMODULE, HRSRC)
+{
+	return 0;
+}
+
+LPVOID LockResource(HGLOBAL data)
+{
+	return data;
+}
+
+HRESULT CoCreateGuid(GUID* guid)
+{
+	static std::mutex lock;
+	static std::random_device device;
+	static std::mt19937_64 random(device());
+
+	std::lock_guard< std::mutex > guard(lock);
+	ULONGLONG high = random();
+	ULONGLONG low = random();
+	guid->Data1 = static_cast<DWORD>(high >> 32);
+	guid->Data2 = static_cast<WORD>(high >> 16);
+	guid->Data3 = static_cast<WORD>((high & 0x0FFF) | 0x4000);
+	for (int t = 0; t < 8; t++)
+		guid->Data4[t] = static_cast<BYTE>(low >> (t * 8));
+	guid->Data4[0] = static_cast<BYTE>((guid->Data4[0] & 0x3F) | 0x80);
+	return S_OK;
+}
+
+CString CTime::Format(LPCTSTR format) const
+{
+	struct tm local;
+	localtime_r(&m_time, &local);
+
+	TCHAR buffer[256];
+	if (!strftime(buffer, sizeof(buffer), format, &local))
+		buffer[0] = _TCHAR('\0');
+	return CString(buffer);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// GDI objects
+
+// The stock objects, created on first use
+static CGdiObject* GetStock(int object)
+{
+	static std::once_flag once;
+	static CGdiObject* stock[DEFAULT_GUI_FONT + 1];
+
+	std::call_once(once, []()
+	{
+		memset(stock, 0, sizeof(stock));
+		COLORREF brushes[5] = { RGB(255, 255, 255), RGB(192, 192, 192), RGB(128, 128, 128), RGB(64, 64, 64), RGB(0, 0, 0) };
+		for (int t = WHITE_BRUSH; t <= BLACK_BRUSH; t++)
+			stock[t] = new CBrush(brushes[t]);
+
+		CBrush* hollow = new CBrush;
+		hollow->CreateSolidBrush(RGB(0, 0, 0));
+		hollow->m_null = TRUE;
+		stock[NULL_BRUSH] = hollow;
+
+		stock[WHITE_PEN] = new CPen(PS_SOLID, 0, RGB(255, 255, 255));
+		stock[BLACK_PEN] = new CPen(PS_SOLID, 0, RGB(0, 0, 0));
+		stock[NULL_PEN] = new CPen(PS_NULL, 0, RGB(0, 0, 0));
+
+		CFont* ansi = new CFont;
+		ansi->CreateFont(-12, 0, 0, 0, FW_NORMAL, 0, 0, 0, ANSI_CHARSET, OUT_DEFAULT_PRECIS, CLIP_DEFAULT_PRECIS, DEFAULT_QUALITY, VARIABLE_PITCH | FF_SWISS, _T("MS Sans Serif"));
+		stock[ANSI_VAR_FONT] = ansi;
+
+		CFont* gui = new CFont;
+		gui->CreateFont(-11, 0, 0, 0, FW_NORMAL, 0, 0, 0, DEFAULT_CHARSET, OUT_DEFAULT_PRECIS, CLIP_DEFAULT_PRECIS, DEFAULT_QUALITY, DEFAULT_PITCH | FF_DONTCARE, _T("MS Shell Dlg"));
+		stock[DEFAULT_GUI_FONT] = gui;
+	});
+
+	if (object < 0 || object > DEFAULT_GUI_FONT)
+		return NULL;
+	return stock[object];
+}
+
+HGDIOBJ GetStockObject(int object)
+{
+	CGdiObject* stock = GetStock(object);
+	return stock ? stock->m_hObject : NULL;
+}
+
+HGDIOBJ SelectObject(HDC, HGDIOBJ object)
+{
+	// Memory device contexts are never created, see "CreateDIBSection"
+	return object;
+}
+
+BOOL CBrush::CreateStockObject(int object)
+{
+	CBrush* stock = dynamic_cast<CBrush*>(GetStock(object));
+	if (!stock)
+		return FALSE;
+
+	m_color = stock->m_color;
+	m_null = stock->m_null;
+	m_hObject = this;
+	return TRUE;
+}
+
+BOOL CFont::CreateFont(int height, int width, int escapement, int orientation, int weight, BYTE italic, BYTE underline, BYTE strikeOut,
+	BYTE charSet, BYTE outPrecision, BYTE clipPrecision, BYTE quality, BYTE pitchAndFamily, LPCTSTR faceName)
+{
+	LOGFONT lf;
+	memset(&lf, 0, sizeof(lf));
+	lf.lfHeight = height;
+	lf.lfWidth = width;
+	lf.lfEscapement = escapement;
+	lf.lfOrientation = orientation;
+	lf.lfWeight = weight;
+	lf.lfItalic = italic;
+	lf.lfUnderline = underline;
+	lf.lfStrikeOut = strikeOut;
+	lf.lfCharSet = charSet;
+	lf.lfOutPrecision = outPrecision;
+	lf.lfClipPrecision = clipPrecision;
+	lf.lfQuality = quality;
+	lf.lfPitchAndFamily = pitchAndFamily;
+	if (faceName)
+		lstrcpyn(lf.lfFaceName, faceName, LF_FACESIZE);
+	return CreateFontIndirect(&lf);
+}
+
+BOOL CFont::CreatePointFont(int pointSize, LPCTSTR faceName, CDC* dc)
+{
+	LOGFONT lf;
+	memset(&lf, 0, sizeof(lf));
+	lf.lfHeight = pointSize;
+	lf.lfWeight = FW_NORMAL;
+	if (faceName)
+		lstrcpyn(lf.lfFaceName, faceName, LF_FACESIZE);
+	return CreatePointFontIndirect(&lf, dc);
+}
+
+BOOL CFont::CreatePointFontIndirect(const LOGFONT* lf, CDC*)
+{
+	// Tenths of a point to pixels, at 96 dpi
+	LOGFONT font = *lf;
+	font.lfHeight = -abs(lf->lfHeight * 96 / 720);
+	return CreateFontIndirect(&font);
+}
+
+CBitmap* CBitmap::FromHandle(HBITMAP)
+{
+	// Bitmaps are never created, see "CreateDIBSection"
+	return NULL;
+}
+
+BOOL CRgn::CreateRectRgn(int left, int top, int right, int bottom)
+{
+	POINT points[4] = { { left, top }, { right, top }, { right, bottom }, { left, bottom } };
+	return CreatePolygonRgn(points, 4, ALTERNATE);
+}
+
+BOOL CRgn::CreateEllipticRgn(int left, int top, int right, int bottom)
+{
+	POINT bounds[2] = { { left, top }, { right, bottom } };
+	m_points.assign(bounds, bounds + 2);
+	m_ellipse = TRUE;
+	m_mode = ALTERNATE;
+	m_hObject = this;
+	return TRUE;
+}
+
+BOOL CRgn::CreatePolygonRgn(const POINT* points, int count, int mode)
+{
+	m_points.assign(points, points + count);
+	m_ellipse = FALSE;
+	m_mode = mode;
+	m_hObject = this;
+	return count > 2;
+}
+
+BOOL CRgn::PtInRegion(int x, int y) const
+{
+	if (m_ellipse)
+	{
+		double rx = (m_points[1].x - m_points[0].x) / 2.0;
+		double ry = (m_points[1].y - m_points[0].y) / 2.0;
+		if (rx <= 0 || ry <= 0)
+			return FALSE;
+
+		double dx = (x + .5 - m_points[0].x - rx) / rx;
+		double dy = (y + .5 - m_points[0].y - ry) / ry;
+		return dx * dx + dy * dy <= 1;
+	}
+
+	// Crossings of a ray to the right of the pixel center, counted
+	// with their direction for the winding rule
+	double px = x + .5;
+	double py = y + .5;
+	int winding = 0;
+	int crossings = 0;
+	size_t count = m_points.size();
+	for (size_t t = 0; t < count; t++)
+	{
+		const POINT& a = m_points[t];
+		const POINT& b = m_points[(t + 1) % count];
+		if ((a.y <= py) != (b.y <= py))
+		{
+			double cross = a.x + (py - a.y) * (b.x - a.x) / static_cast<double>(b.y - a.y);
+			if (cross > px)
+			{
+				crossings++;
+				winding += b.y > a.y ? 1 : -1;
+			}
+		}
+	}
+
+	return m_mode == WINDING ? winding != 0 : (crossings & 1) != 0;
+}
+
+BOOL CRgn::RectInRegion(LPCRECT rect) const
+{
+	CRect r(rect);
+	r.NormalizeRect();
+	if (r.IsRectEmpty() || m_points.empty())
+		return FALSE;
+
+	if (m_ellipse)
+	{
+		// The point of the rectangle closest to the center
+		int cx = (m_points[0].x + m_points[1].x) / 2;
+		int cy = (m_points[0].y + m_points[1].y) / 2;
+		return PtInRegion(min(max(cx, static_cast<int>(r.left)), static_cast<int>(r.right) - 1),
+			min(max(cy, static_cast<int>(r.top)), static_cast<int>(r.bottom) - 1));
+	}
+
+	// A corner of either inside the other, or crossing edges
+	if (PtInRegion(r.left, r.top) || PtInRegion(r.right - 1, r.top) || PtInRegion(r.left, r.bottom - 1) || PtInRegion(r.right - 1, r.bottom - 1))
+		return TRUE;
+
+	size_t count = m_points.size();
+	for (size_t t = 0; t < count; t++)
+	{
+		const POINT& a = m_points[t];
+		if (r.PtInRect(a))
+			return TRUE;
+
+		const POINT& b = m_points[(t + 1) % count];
+		POINT corners[5] = { { r.left, r.top }, { r.right, r.top }, { r.right, r.bottom }, { r.left, r.bottom }, { r.left, r.top } };
+		for (int c = 0; c < 4; c++)
+		{
+			const POINT& p = corners[c];
+			const POINT& q = corners[c + 1];
+			double d1 = static_cast<double>(b.x - a.x) * (p.y - a.y) - static_cast<double>(b.y - a.y) * (p.x - a.x);
+			double d2 = static_cast<double>(b.x - a.x) * (q.y - a.y) - static_cast<double>(b.y - a.y) * (q.x - a.x);
+			double d3 = static_cast<double>(q.x - p.x) * (a.y - p.y) - static_cast<double>(q.y - p.y) * (a.x - p.x);
+			double d4 = static_cast<double>(q.x - p.x) * (b.y - p.y) - static_cast<double>(q.y - p.y) * (b.x - p.x);
+			if (((d1 < 0) != (d2 < 0)) && ((d3 < 0) != (d4 < 0)))
+				return TRUE;
+		}
+	}
+
+	return FALSE;
+}
+
+BOOL LineDDA(int x1, int y1, int x2, int y2, LINEDDAPROC proc, LPARAM data)
+{
+	// Every point of the line but the last, as GDI draws it
+	int dx = abs(x2 - x1);
+	int dy = abs(y2 - y1);
+	int sx = x1 < x2 ? 1 : -1;
+	int sy = y1 < y2 ? 1 : -1;
+	int steps = max(dx, dy);
+	int error = 0;
+	int x = x1;
+	int y = y1;
+	for (int t = 0; t < steps; t++)
+	{
+		proc(x, y, data);
+		if (dx >= dy)
+		{
+			x += sx;
+			error += dy;
+			if (2 * error >= dx)
+			{
+				y += sy;
+				error -= dx;
+			}
+		}
+		else
+		{
+			y += sy;
+			error += dx;
+			if (2 * error >= dy)
+			{
+				x += sx;
+				error -= dy;
+			}
+		}
+	}
+
+	return TRUE;
+}
+
+HBITMAP CreateDIBSection(HDC, const BITMAPINFO*, UINT, void** bits, HANDLE, DWORD)
+{
+	// "CreateCompatibleDC" fails, so this is not reached
+	if (bits)
+		*bits = NULL;
+	return NULL;
+}
+
+int StretchDIBits(HDC, int, int, int, int, int, int, int, int, const void*, const BITMAPINFO*, UINT, DWORD)
+{
+	return 0;
+}
+
+BOOL SetBrushOrgEx(HDC, int, int, POINT* old)
+{
+	if (old)
+		old->x = old->y = 0;
+	return TRUE;
+}
+
+BOOL GdiFlush()
+{
+	return TRUE;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CDC
+
+CDC::CDC()
+	: m_hDC(NULL),
+	m_pen(static_cast<CPen*>(GetStock(BLACK_PEN))),
+	m_brush(static_cast<CBrush*>(GetStock(WHITE_BRUSH))),
+	m_font(static_cast<CFont*>(GetStock(DEFAULT_GUI_FONT))),
+	m_bitmap(NULL),
+	m_textColor(RGB(0, 0, 0)),
+	m_bkColor(RGB(255, 255, 255)),
+	m_bkMode(OPAQUE)
+{
+}
+
+CPen* CDC::SelectObject(CPen* pen)
+{
+	CPen* old = m_pen;
+	if (pen)
+		m_pen = pen;
+	return old;
+}
+
+CBrush* CDC::SelectObject(CBrush* brush)
+{
+	CBrush* old = m_brush;
+	if (brush)
+		m_brush = brush;
+	return old;
+}
+
+CFont* CDC::SelectObject(CFont* font)
+{
+	CFont* old = m_font;
+	if (font)
+		m_font = font;
+	return old;
+}
+
+CBitmap* CDC::SelectObject(CBitmap* bitmap)
+{
+	CBitmap* old = m_bitmap;
+	m_bitmap = bitmap;
+	return old;
+}
+
+CGdiObject* CDC::SelectStockObject(int object)
+{
+	CGdiObject* stock = GetStock(object);
+	if (CPen* pen = dynamic_cast<CPen*>(stock))
+		return SelectObject(pen);
+	if (CBrush* brush = dynamic_cast<CBrush*>(stock))
+		return SelectObject(brush);
+	if (CFont* font = dynamic_cast<CFont*>(stock))
+		return SelectObject(font);
+	return NULL;
+}
+
+int CDC::SaveDC()
+{
+	CState state;
+	state.pen = m_pen;
+	state.brush = m_brush;
+	state.font = m_font;
+	state.textColor = m_textColor;
+	state.bkColor = m_bkColor;
+	state.bkMode = m_bkMode;
+	m_saved.push_back(state);
+	return static_cast<int>(m_saved.size());
+}
+
+BOOL CDC::RestoreDC(int saved)
+{
+	// A negative level counts back from the last saved state
+	if (saved < 0)
+		saved = static_cast<int>(m_saved.size()) + saved + 1;
+	if (saved < 1 || saved > static_cast<int>(m_saved.size()))
+		return FALSE;
+
+	const CState& state = m_saved[saved - 1];
+	m_pen = state.pen;
+	m_brush = state.brush;
+	m_font = state.font;
+	m_textColor = state.textColor;
+	m_bkColor = state.bkColor;
+	m_bkMode = state.bkMode;
+	m_saved.resize(saved - 1);
+	return TRUE;
+}
+
+int CDC::DrawText(const CString& text, LPRECT rect, UINT format)
+{
+	// Lines, wrapped at the rectangle width if asked to
+	CSize cell = GetTextExtent(CString(_T("x")));
+	int width = max(static_cast<int>(rect->right - rect->left), 0);
+	int lines = 0;
+	int widest = 0;
+	int start = 0;
+	int length = text.GetLength();
+	while (start <= length)
+	{
+		int end = text.Find(_TCHAR('\n'), start);
+		if (end == -1 || (format & DT_SINGLELINE))
+			end = length;
+
+		int chars = end - start;
+		if ((format & DT_WORDBREAK) && cell.cx && width)
+		{
+			int perLine = max(width / static_cast<int>(cell.cx), 1);
+			lines += max((chars + perLine - 1) / perLine, 1);
+			widest = max(widest, min(chars, perLine) * static_cast<int>(cell.cx));
+		}
+		else
+		{
+			lines++;
+			widest = max(widest, chars * static_cast<int>(cell.cx));
+		}
+
+		start = end + 1;
+	}
+
+	int height = lines * cell.cy;
+	if (format & DT_CALCRECT)
+	{
+		rect->right = rect->left + widest;
+		rect->bottom = rect->top + height;
+	}
+
+	return height;
+}
+
+CSize CDC::GetTextExtent(const CString& text) const
+{
+	// A cell of 6 by 11 font pixels, as "CDiagramRasterRenderer"
+	int height = m_font ? abs(static_cast<int>(m_font->m_logFont.lfHeight)) : 0;
+	if (!height)
+		height = 13;
+
+	return CSize(text.GetLength() * height * 6 / 11, height);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Windows
+
+CDC* CWnd::GetDC()
+{
+	// Measuring only, so one context does for all windows
+	static thread_local CDC dc;
+	return &dc;
+}
+
+CWnd* CWnd::GetDesktopWindow()
+{
+	static CWnd desktop;
+	return &desktop;
+}
+
+CWnd* AfxGetMainWnd()
+{
+	return NULL;
+}
+
+BOOL IsWindow(HWND wnd)
+{
+	return wnd != NULL;
+}
+
+BOOL IsWindowVisible(HWND)
+{
+	return FALSE;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CShimListItems
+
+int CShimListItems::AddString(LPCTSTR str)
+{
+	m_items.push_back(std::make_pair(CString(str), static_cast<DWORD_PTR>(0)));
+	return GetCount() - 1;
+}
+
+int CShimListItems::InsertString(int index, LPCTSTR str)
+{
+	if (index < 0 || index > GetCount())
+		index = GetCount();
+	m_items.insert(m_items.begin() + index, std::make_pair(CString(str), static_cast<DWORD_PTR>(0)));
+	if (m_selected >= index)
+		m_selected++;
+	return index;
+}
+
+int CShimListItems::DeleteString(UINT index)
+{
+	if (index >= m_items.size())
+		return LB_ERR;
+
+	m_items.erase(m_items.begin() + index);
+	if (m_selected == static_cast<int>(index))
+		m_selected = -1;
+	else if (m_selected > static_cast<int>(index))
+		m_selected--;
+	return GetCount();
+}
+
+int CShimListItems::FindString(int start, LPCTSTR str) const
+{
+	// Prefix match, without case, starting after "start"
+	size_t length = _tcslen(str);
+	int count = GetCount();
+	for (int t = 1; t <= count; t++)
+	{
+		int index = (start + t + count) % count;
+		if (_tcsnicmp(m_items[index].first, str, length) == 0)
+			return index;
+	}
+
+	return LB_ERR;
+}
+
+int CShimListItems::FindStringExact(int start, LPCTSTR str) const
+{
+	int count = GetCount();
+	for (int t = 1; t <= count; t++)
+	{
+		int index = (start + t + count) % count;
+		if (m_items[index].first.CompareNoCase(str) == 0)
+			return index;
+	}
+
+	return LB_ERR;
+}
+
+int CShimListItems::GetText(int index, CString& str) const
+{
+	if (index < 0 || index >= GetCount())
+		return LB_ERR;
+
+	str = m_items[index].first;
+	return str.GetLength();
+}
+
+int CShimListItems::GetTextLen(int index) const
+{
+	if (index < 0 || index >= GetCount())
+		return LB_ERR;
+	return m_items[index].first.GetLength();
+}
+
+DWORD_PTR CShimListItems::GetItemData(int index) const
+{
+	if (index < 0 || index >= GetCount())
+		return static_cast<DWORD_PTR>(LB_ERR);
+	return m_items[index].second;
+}
+
+int CShimListItems::SetItemData(int index, DWORD_PTR data)
+{
+	if (index < 0 || index >= GetCount())
+		return LB_ERR;
+
+	m_items[index].second = data;
+	return 0;
+}
+
+int CShimListItems::SetCurSel(int select)
+{
+	if (select < -1 || select >= GetCount())
+		return LB_ERR;
+
+	m_selected = select;
+	return select;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Base64
+
+int Base64EncodeGetRequiredLength(int length, DWORD flags)
+{
+	int result = (length + 2) / 3 * 4;
+	if (!(flags & ATL_BASE64_FLAG_NOCRLF))
+		result += (result / 76 + 1) * 2;
+	return result;
+}
+
+BOOL Base64Encode(const BYTE* data, int length, LPSTR dest, int* destLength, DWORD flags)
+{
+	static const char digits[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+	if (!dest || !destLength || *destLength < Base64EncodeGetRequiredLength(length, flags))
+		return FALSE;
+
+	int written = 0;
+	int line = 0;
+	for (int t = 0; t < length; t += 3)
+	{
+		int left = min(length - t, 3);
+		DWORD value = static_cast<DWORD>(data[t]) << 16;
+		if (left > 1)
+			value |= static_cast<DWORD>(data[t + 1]) << 8;
+		if (left > 2)
+			value |= data[t + 2];
+
+		for (int c = 0; c < 4; c++)
+		{
+			if (c <= left)
+				dest[written++] = digits[(value >> (18 - c * 6)) & 0x3F];
+			else if (!(flags & ATL_BASE64_FLAG_NOPAD))
+				dest[written++] = '=';
+		}
+
+		// Lines of 76 characters
+		line += 4;
+		if (!(flags & ATL_BASE64_FLAG_NOCRLF) && line >= 76 && t + 3 < length)
+		{
+			dest[written++] = '\r';
+			dest[written++] = '\n';
+			line = 0;
+		}
+	}
+
+	*destLength = written;
+	return TRUE;
+}
@@ -0,0 +1,778 @@
+#ifndef _PORTABLEWND_H_4B1F7C2E_0D93_4A6C_9E57D2A8C41B3
+#define _PORTABLEWND_H_4B1F7C2E_0D93_4A6C_9E57D2A8C41B3
+
+///////////////////////////////////////////////////////////
+// File :		PortableWnd.h
+// Created :	10/19/26
+//
+// The windows, dialogs, controls and device contexts the
+// entity, container and property dialog classes of the
+// editors refer to, so that the diagram models can be built
+// and timed without Windows. No window is ever created:
+// "Create" fails, "DoModal" returns "IDCANCEL", and message
+// maps are empty, so the dialog code compiles but never runs.
+// Device contexts keep their selected objects and colors,
+// and measure text as "CDiagramRasterRenderer" does, but
+// draw nothing. Regions and "LineDDA" work as in GDI, as the
+// entities hit-test with them.
+//
+
+#include "PortableAfx.h"
+
+/////////////////////////////////////////////////////////////////////////////
+// Types
+
+typedef void*		HWND;
+typedef void*		HCURSOR;
+typedef void*		HICON;
+typedef void*		HFONT;
+typedef void*		HPEN;
+typedef void*		HBRUSH;
+typedef void*		HRGN;
+typedef void*		HMENU;
+typedef INT_PTR		LRESULT;
+typedef UINT_PTR	WPARAM;
+typedef INT_PTR		LPARAM;
+typedef wchar_t		WCHAR;
+typedef int*		LPINT;
+typedef POINT*		LPPOINT;
+typedef void*		HMODULE;
+typedef void*		HRSRC;
+typedef void*		HGLOBAL;
+typedef BYTE		byte;
+
+#define VOID				void
+#define CALLBACK
+#define afx_msg
+
+#define MAKELONG(a, b)		(static_cast<LONG>(static_cast<WORD>(a) | (static_cast<DWORD>(static_cast<WORD>(b)) << 16)))
+#define ZeroMemory(d, n)	memset((d), 0, (n))
+#define _MAX_PATH			MAX_PATH
+#define _TRUNCATE			(static_cast<size_t>(-1))
+#define _hypot				hypot
+#define _stscanf_s			sscanf
+#define _vsnprintf_s(buffer, size, count, format, args)	vsnprintf((buffer), (size), (format), (args))
+
+/////////////////////////////////////////////////////////////////////////////
+// Message boxes and string resources
+
+#define MB_OK				0x00000000
+#define MB_OKCANCEL			0x00000001
+#define MB_YESNOCANCEL		0x00000003
+#define MB_YESNO			0x00000004
+#define MB_ICONSTOP			0x00000010
+#define MB_ICONQUESTION		0x00000020
+#define MB_ICONEXCLAMATION	0x00000030
+#define MB_ICONINFORMATION	0x00000040
+
+#define IDOK				1
+#define IDCANCEL			2
+#define IDYES				6
+#define IDNO				7
+
+// Messages are written to "stderr". Questions are answered "No",
+// or "Cancel", so nothing is changed.
+int AfxMessageBox(LPCTSTR text, UINT type = MB_OK, UINT help = 0);
+int AfxMessageBox(UINT id, UINT type = MB_OK, UINT help = -1);
+
+/////////////////////////////////////////////////////////////////////////////
+// Colors, cursors and system metrics
+
+#define COLOR_SCROLLBAR		0
+#define COLOR_WINDOW		5
+#define COLOR_WINDOWTEXT	8
+#define COLOR_3DFACE		15
+#define COLOR_BTNFACE		15
+#define COLOR_3DSHADOW		16
+#define COLOR_BTNSHADOW		16
+#define COLOR_GRAYTEXT		17
+#define COLOR_BTNTEXT		18
+#define COLOR_3DHIGHLIGHT	20
+#define COLOR_3DHILIGHT		20
+#define COLOR_BTNHIGHLIGHT	20
+#define COLOR_3DDKSHADOW	21
+#define COLOR_3DLIGHT		22
+
+#define CLR_INVALID			0xFFFFFFFF
+
+#define IDC_ARROW			MAKEINTRESOURCE(32512)
+#define IDC_CROSS			MAKEINTRESOURCE(32515)
+#define IDC_SIZENWSE		MAKEINTRESOURCE(32642)
+#define IDC_SIZENESW		MAKEINTRESOURCE(32643)
+#define IDC_SIZEWE			MAKEINTRESOURCE(32644)
+#define IDC_SIZENS			MAKEINTRESOURCE(32645)
+#define IDC_SIZEALL			MAKEINTRESOURCE(32646)
+
+DWORD		GetSysColor(int index);
+HCURSOR		LoadCursor(HINSTANCE instance, LPCTSTR name);
+HCURSOR		SetCursor(HCURSOR cursor);
+LONG		GetDialogBaseUnits();
+UINT		RegisterWindowMessage(LPCTSTR name);
+BOOL		ReleaseCapture();
+DWORD		GetModuleFileName(HINSTANCE module, LPTSTR filename, DWORD size);
+
+// Wide strings hold one character for each byte of the narrow ones,
+// as in a single byte code page
+int			MultiByteToWideChar(UINT codePage, DWORD flags, LPCSTR str, int length, LPWSTR wide, int wideLength);
+int			WideCharToMultiByte(UINT codePage, DWORD flags, LPCWSTR wide, int length, LPSTR str, int strLength, LPCSTR defaultChar, BOOL* usedDefault);
+
+// There are no resources, so "FindResource" always fails
+HMODULE		GetModuleHandle(LPCTSTR name);
+HRSRC		FindResource(HMODULE module, LPCTSTR name, LPCTSTR type);
+HGLOBAL		LoadResource(HMODULE module, HRSRC resource);
+DWORD		SizeofResource(HMODULE module, HRSRC resource);
+LPVOID		LockResource(HGLOBAL data);
+
+// Globally unique ids, generated from the C++ random device
+typedef LONG		HRESULT;
+#define S_OK		(static_cast<HRESULT>(0))
+#define E_FAIL		(static_cast<HRESULT>(0x80004005L))
+
+typedef struct _GUID
+{
+	DWORD	Data1;
+	WORD	Data2;
+	WORD	Data3;
+	BYTE	Data4[8];
+} GUID;
+
+HRESULT		CoCreateGuid(GUID* guid);
+
+// Local time, to the second
+class CTime
+{
+public:
+	CTime() : m_time(0) {}
+	CTime(time_t time) : m_time(time) {}
+
+	static CTime	GetCurrentTime() { return CTime(::time(NULL)); }
+	time_t			GetTime() const { return m_time; }
+	CString			Format(LPCTSTR format) const;
+
+private:
+	time_t			m_time;
+
+};
+
+inline void	AfxLockTempMaps() {}
+inline BOOL	AfxUnlockTempMaps(BOOL = TRUE) { return TRUE; }
+
+/////////////////////////////////////////////////////////////////////////////
+// GDI objects. A handle is the address of its object, so "FromHandle"
+// only casts.
+
+#define WHITE_BRUSH			0
+#define LTGRAY_BRUSH		1
+#define GRAY_BRUSH			2
+#define DKGRAY_BRUSH		3
+#define BLACK_BRUSH			4
+#define NULL_BRUSH			5
+#define HOLLOW_BRUSH		NULL_BRUSH
+#define WHITE_PEN			6
+#define BLACK_PEN			7
+#define NULL_PEN			8
+#define ANSI_VAR_FONT		12
+#define DEFAULT_GUI_FONT	17
+
+#define ANSI_CHARSET		0
+#define DEFAULT_CHARSET		1
+#define OUT_DEFAULT_PRECIS	0
+#define OUT_TT_ONLY_PRECIS	7
+#define CLIP_DEFAULT_PRECIS	0
+#define DEFAULT_QUALITY		0
+#define DEFAULT_PITCH		0
+#define FIXED_PITCH			1
+#define VARIABLE_PITCH		2
+#define FF_DONTCARE			0x00
+#define FF_ROMAN			0x10
+#define FF_SWISS			0x20
+#define FF_MODERN			0x30
+#define FF_DECORATIVE		0x50
+
+#define LF_FACESIZE			32
+
+#define ALTERNATE			1
+#define WINDING				2
+
+#define SRCCOPY				0x00CC0020
+#define HALFTONE			4
+#define COLORONCOLOR		3
+
+typedef struct tagLOGFONT
+{
+	LONG	lfHeight;
+	LONG	lfWidth;
+	LONG	lfEscapement;
+	LONG	lfOrientation;
+	LONG	lfWeight;
+	BYTE	lfItalic;
+	BYTE	lfUnderline;
+	BYTE	lfStrikeOut;
+	BYTE	lfCharSet;
+	BYTE	lfOutPrecision;
+	BYTE	lfClipPrecision;
+	BYTE	lfQuality;
+	BYTE	lfPitchAndFamily;
+	TCHAR	lfFaceName[LF_FACESIZE];
+} LOGFONT, *LPLOGFONT;
+
+class CDC;
+
+class CGdiObject : public CObject
+{
+public:
+	CGdiObject() : m_hObject(NULL) {}
+	virtual ~CGdiObject() {}
+
+	HGDIOBJ		GetSafeHandle() const { return m_hObject; }
+	operator	HGDIOBJ() const { return m_hObject; }
+	BOOL		DeleteObject() { BOOL result = m_hObject != NULL; m_hObject = NULL; return result; }
+
+	HGDIOBJ		m_hObject;
+
+};
+
+HGDIOBJ		GetStockObject(int object);
+HGDIOBJ		SelectObject(HDC dc, HGDIOBJ object);
+
+class CPen : public CGdiObject
+{
+public:
+	CPen() : m_style(PS_SOLID), m_width(0), m_color(0) {}
+	CPen(int style, int width, COLORREF color) { CreatePen(style, width, color); }
+
+	BOOL		CreatePen(int style, int width, COLORREF color) { m_style = style; m_width = width; m_color = color; m_hObject = this; return TRUE; }
+	static CPen* FromHandle(HPEN pen) { return static_cast<CPen*>(static_cast<CGdiObject*>(pen)); }
+
+	int			m_style;
+	int			m_width;
+	COLORREF	m_color;
+
+};
+
+class CBrush : public CGdiObject
+{
+public:
+	CBrush() : m_color(0), m_null(FALSE) {}
+	CBrush(COLORREF color) { CreateSolidBrush(color); }
+
+	BOOL		CreateSolidBrush(COLORREF color) { m_color = color; m_null = FALSE; m_hObject = this; return TRUE; }
+	BOOL		CreateSysColorBrush(int index) { return CreateSolidBrush(::GetSysColor(index)); }
+	BOOL		CreateStockObject(int object);
+	static CBrush* FromHandle(HBRUSH brush) { return static_cast<CBrush*>(static_cast<CGdiObject*>(brush)); }
+
+	COLORREF	m_color;
+	BOOL		m_null;		// TRUE for "NULL_BRUSH"
+
+};
+
+class CFont : public CGdiObject
+{
+public:
+	CFont() { memset(&m_logFont, 0, sizeof(m_logFont)); }
+
+	BOOL		CreateFontIndirect(const LOGFONT* lf) { m_logFont = *lf; m_hObject = this; return TRUE; }
+	BOOL		CreateFont(int height, int width, int escapement, int orientation, int weight, BYTE italic, BYTE underline, BYTE strikeOut,
+					BYTE charSet, BYTE outPrecision, BYTE clipPrecision, BYTE quality, BYTE pitchAndFamily, LPCTSTR faceName);
+	BOOL		CreatePointFont(int pointSize, LPCTSTR faceName, CDC* dc = NULL);
+	BOOL		CreatePointFontIndirect(const LOGFONT* lf, CDC* dc = NULL);
+	int			GetLogFont(LOGFONT* lf) const { *lf = m_logFont; return sizeof(LOGFONT); }
+	static CFont* FromHandle(HFONT font) { return static_cast<CFont*>(static_cast<CGdiObject*>(font)); }
+
+	LOGFONT		m_logFont;
+
+};
+
+class CBitmap : public CGdiObject
+{
+public:
+	static CBitmap* FromHandle(HBITMAP bitmap);
+
+};
+
+class CRgn : public CGdiObject
+{
+public:
+	CRgn() : m_ellipse(FALSE), m_mode(ALTERNATE) {}
+
+	BOOL		CreateRectRgn(int left, int top, int right, int bottom);
+	BOOL		CreateEllipticRgn(int left, int top, int right, int bottom);
+	BOOL		CreatePolygonRgn(const POINT* points, int count, int mode);
+	BOOL		PtInRegion(int x, int y) const;
+	BOOL		PtInRegion(POINT point) const { return PtInRegion(point.x, point.y); }
+	BOOL		RectInRegion(LPCRECT rect) const;
+
+private:
+	std::vector< POINT >	m_points;	// Polygon, or the bounds of an ellipse
+	BOOL					m_ellipse;	// TRUE for an elliptic region
+	int						m_mode;		// Polygon fill mode
+
+};
+
+typedef void (CALLBACK *LINEDDAPROC)(int x, int y, LPARAM data);
+
+BOOL		LineDDA(int x1, int y1, int x2, int y2, LINEDDAPROC proc, LPARAM data);
+
+HBITMAP		CreateDIBSection(HDC dc, const BITMAPINFO* info, UINT usage, void** bits, HANDLE section, DWORD offset);
+int			StretchDIBits(HDC dc, int x, int y, int width, int height, int srcX, int srcY, int srcWidth, int srcHeight,
+				const void* bits, const BITMAPINFO* info, UINT usage, DWORD rop);
+BOOL		SetBrushOrgEx(HDC dc, int x, int y, POINT* old);
+BOOL		GdiFlush();
+
+/////////////////////////////////////////////////////////////////////////////
+// Device contexts
+
+class CDC : public CObject
+{
+public:
+	CDC();
+	virtual ~CDC() {}
+
+	// Creation
+	BOOL		CreateCompatibleDC(CDC* dc) { (void) dc; return FALSE; }
+	BOOL		DeleteDC() { return TRUE; }
+	BOOL		Attach(HDC dc) { m_hDC = dc; return TRUE; }
+	HDC			Detach() { HDC dc = m_hDC; m_hDC = NULL; return dc; }
+	HDC			GetSafeHdc() const { return m_hDC; }
+
+	// Selection
+	CPen*		SelectObject(CPen* pen);
+	CBrush*		SelectObject(CBrush* brush);
+	CFont*		SelectObject(CFont* font);
+	CBitmap*	SelectObject(CBitmap* bitmap);
+	CGdiObject*	SelectStockObject(int object);
+	CFont*		GetCurrentFont() const { return m_font; }
+
+	// State
+	int			SaveDC();
+	BOOL		RestoreDC(int saved);
+	COLORREF	SetTextColor(COLORREF color) { COLORREF old = m_textColor; m_textColor = color; return old; }
+	COLORREF	GetTextColor() const { return m_textColor; }
+	COLORREF	SetBkColor(COLORREF color) { COLORREF old = m_bkColor; m_bkColor = color; return old; }
+	COLORREF	GetBkColor() const { return m_bkColor; }
+	int			SetBkMode(int mode) { int old = m_bkMode; m_bkMode = mode; return old; }
+	int			GetBkMode() const { return m_bkMode; }
+	int			SetStretchBltMode(int mode) { return mode; }
+	CPoint		SetViewportOrg(int x, int y) { CPoint old = m_viewportOrg; m_viewportOrg = CPoint(x, y); return old; }
+	CPoint		SetViewportOrg(POINT point) { return SetViewportOrg(point.x, point.y); }
+	CPoint		SetWindowOrg(int x, int y) { CPoint old = m_windowOrg; m_windowOrg = CPoint(x, y); return old; }
+	CPoint		SetWindowOrg(POINT point) { return SetWindowOrg(point.x, point.y); }
+	int			IntersectClipRect(int, int, int, int) { return 1; }
+	int			IntersectClipRect(LPCRECT) { return 1; }
+	int			GetDeviceCaps(int) const { return 96; }
+
+	// Drawing, which does nothing
+	CPoint		MoveTo(int x, int y) { CPoint old = m_position; m_position = CPoint(x, y); return old; }
+	CPoint		MoveTo(POINT point) { return MoveTo(point.x, point.y); }
+	BOOL		LineTo(int x, int y) { m_position = CPoint(x, y); return TRUE; }
+	BOOL		LineTo(POINT point) { return LineTo(point.x, point.y); }
+	BOOL		Rectangle(int, int, int, int) { return TRUE; }
+	BOOL		Rectangle(LPCRECT) { return TRUE; }
+	BOOL		RoundRect(int, int, int, int, int, int) { return TRUE; }
+	BOOL		RoundRect(LPCRECT, POINT) { return TRUE; }
+	BOOL		Ellipse(int, int, int, int) { return TRUE; }
+	BOOL		Ellipse(LPCRECT) { return TRUE; }
+	BOOL		Polygon(const POINT*, int) { return TRUE; }
+	BOOL		Polyline(const POINT*, int) { return TRUE; }
+	void		FillSolidRect(int, int, int, int, COLORREF) {}
+	void		FillSolidRect(LPCRECT, COLORREF) {}
+	void		FillRect(LPCRECT, CBrush*) {}
+	BOOL		TextOut(int, int, const CString&) { return TRUE; }
+	BOOL		TransparentBlt(int, int, int, int, CDC*, int, int, int, int, UINT) { return TRUE; }
+	BOOL		BitBlt(int, int, int, int, CDC*, int, int, DWORD) { return TRUE; }
+	BOOL		StretchBlt(int, int, int, int, CDC*, int, int, int, int, DWORD) { return TRUE; }
+	int			DrawText(const CString& text, LPRECT rect, UINT format);
+
+	// Measuring
+	CSize		GetTextExtent(const CString& text) const;
+	CSize		GetTextExtent(LPCTSTR text, int length) const { return GetTextExtent(CString(text, length)); }
+
+	HDC			m_hDC;
+
+private:
+	// A saved state
+	struct CState
+	{
+		CPen*		pen;
+		CBrush*		brush;
+		CFont*		font;
+		COLORREF	textColor;
+		COLORREF	bkColor;
+		int			bkMode;
+	};
+
+	CPen*		m_pen;
+	CBrush*		m_brush;
+	CFont*		m_font;
+	CBitmap*	m_bitmap;
+	COLORREF	m_textColor;
+	COLORREF	m_bkColor;
+	int			m_bkMode;
+	CPoint		m_position;
+	CPoint		m_viewportOrg;
+	CPoint		m_windowOrg;
+	std::vector< CState >	m_saved;
+
+};
+
+class CWnd;
+
+class CClientDC : public CDC
+{
+public:
+	CClientDC(CWnd* wnd) { (void) wnd; }
+
+};
+
+class CPaintDC : public CDC
+{
+public:
+	CPaintDC(CWnd* wnd) { (void) wnd; }
+
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// Windows
+
+#define SW_HIDE				0
+#define SW_SHOWNORMAL		1
+#define SW_SHOW				5
+
+#define WM_USER				0x0400
+#define WM_SETREDRAW		0x000B
+
+#define RDW_INVALIDATE		0x0001
+#define RDW_UPDATENOW		0x0100
+#define RDW_ERASE			0x0004
+
+class CDataExchange;
+
+class CWnd : public CObject
+{
+public:
+	CWnd() : m_hWnd(NULL) {}
+	virtual ~CWnd() {}
+
+	// Creation, which always fails
+	virtual BOOL	DestroyWindow() { m_hWnd = NULL; return TRUE; }
+	HWND			GetSafeHwnd() const { return m_hWnd; }
+	operator		HWND() const { return m_hWnd; }
+
+	// State
+	BOOL			ShowWindow(int) { return FALSE; }
+	BOOL			IsWindowVisible() const { return FALSE; }
+	BOOL			IsWindowEnabled() const { return FALSE; }
+	BOOL			EnableWindow(BOOL = TRUE) { return FALSE; }
+	CWnd*			SetFocus() { return NULL; }
+	CWnd*			GetParent() const { return NULL; }
+	CWnd*			GetDlgItem(int) const { return NULL; }
+	int				GetDlgCtrlID() const { return 0; }
+	void			SetWindowText(LPCTSTR text) { m_text = text; }
+	void			GetWindowText(CString& text) const { text = m_text; }
+	int				GetWindowTextLength() const { return m_text.GetLength(); }
+	void			SetFont(CFont* font, BOOL = TRUE) { m_font = font; }
+	CFont*			GetFont() const { return m_font; }
+	void			GetClientRect(LPRECT rect) const { ::memset(rect, 0, sizeof(RECT)); }
+	void			GetWindowRect(LPRECT rect) const { ::memset(rect, 0, sizeof(RECT)); }
+	void			ScreenToClient(LPPOINT) const {}
+	void			ClientToScreen(LPPOINT) const {}
+	void			ScreenToClient(LPRECT) const {}
+	void			ClientToScreen(LPRECT) const {}
+	BOOL			MoveWindow(int, int, int, int, BOOL = TRUE) { return FALSE; }
+	BOOL			MoveWindow(LPCRECT, BOOL = TRUE) { return FALSE; }
+
+	// Drawing
+	void			Invalidate(BOOL = TRUE) {}
+	void			InvalidateRect(LPCRECT, BOOL = TRUE) {}
+	void			UpdateWindow() {}
+	BOOL			RedrawWindow(LPCRECT = NULL, void* = NULL, UINT = 0) { return FALSE; }
+	CDC*			GetDC();
+	int				ReleaseDC(CDC*) { return 1; }
+	CWnd*			SetCapture() { return NULL; }
+
+	// Messages
+	LRESULT			SendMessage(UINT, WPARAM = 0, LPARAM = 0) { return 0; }
+	BOOL			PostMessage(UINT, WPARAM = 0, LPARAM = 0) { return FALSE; }
+	BOOL			UpdateData(BOOL = TRUE) { return TRUE; }
+
+	static CWnd*	GetDesktopWindow();
+
+	HWND			m_hWnd;
+
+protected:
+	virtual void	DoDataExchange(CDataExchange*) {}
+	virtual void	PreSubclassWindow() {}
+	virtual LRESULT	WindowProc(UINT, WPARAM, LPARAM) { return 0; }
+	virtual LRESULT	DefWindowProc(UINT, WPARAM, LPARAM) { return 0; }
+	virtual BOOL	PreTranslateMessage(void*) { return FALSE; }
+
+	afx_msg void	OnPaint() {}
+	afx_msg void	OnLButtonDown(UINT, CPoint) {}
+	afx_msg void	OnLButtonUp(UINT, CPoint) {}
+	afx_msg void	OnLButtonDblClk(UINT, CPoint) {}
+	afx_msg void	OnMouseMove(UINT, CPoint) {}
+	afx_msg void	OnKeyDown(UINT, UINT, UINT) {}
+	afx_msg void	OnSize(UINT, int, int) {}
+	afx_msg void	OnClose() {}
+
+private:
+	CString			m_text;
+	CFont*			m_font = NULL;
+
+};
+
+CWnd*		AfxGetMainWnd();
+BOOL		IsWindow(HWND wnd);
+BOOL		IsWindowVisible(HWND wnd);
+
+#define VK_BACK				0x08
+#define VK_RETURN			0x0D
+#define VK_ESCAPE			0x1B
+#define VK_LEFT				0x25
+#define VK_UP				0x26
+#define VK_RIGHT			0x27
+#define VK_DOWN				0x28
+#define VK_INSERT			0x2D
+#define VK_DELETE			0x2E
+
+#define MK_LBUTTON			0x0001
+#define MK_SHIFT			0x0004
+#define MK_CONTROL			0x0008
+
+/////////////////////////////////////////////////////////////////////////////
+// Message maps, which are empty
+
+#define DECLARE_MESSAGE_MAP()
+#define BEGIN_MESSAGE_MAP(theClass, baseClass)
+#define END_MESSAGE_MAP()
+#define ON_BN_CLICKED(id, handler)
+#define ON_BN_DOUBLECLICKED(id, handler)
+#define ON_EN_CHANGE(id, handler)
+#define ON_EN_KILLFOCUS(id, handler)
+#define ON_LBN_DBLCLK(id, handler)
+#define ON_LBN_SELCHANGE(id, handler)
+#define ON_CBN_SELCHANGE(id, handler)
+#define ON_CONTROL_REFLECT(code, handler)
+#define ON_REGISTERED_MESSAGE(message, handler)
+#define ON_MESSAGE(message, handler)
+#define ON_WM_PAINT()
+#define ON_WM_LBUTTONDOWN()
+#define ON_WM_LBUTTONUP()
+#define ON_WM_LBUTTONDBLCLK()
+#define ON_WM_MOUSEMOVE()
+#define ON_WM_KEYDOWN()
+#define ON_WM_SIZE()
+#define ON_WM_CLOSE()
+
+/////////////////////////////////////////////////////////////////////////////
+// Dialogs and controls
+
+class CDataExchange
+{
+public:
+	CDataExchange(CWnd* dlg, BOOL save) : m_bSaveAndValidate(save), m_pDlgWnd(dlg) {}
+
+	void			Fail() {}
+
+	BOOL			m_bSaveAndValidate;
+	CWnd*			m_pDlgWnd;
+
+};
+
+inline void DDX_Text(CDataExchange*, int, CString&) {}
+inline void DDX_Text(CDataExchange*, int, int&) {}
+inline void DDX_Text(CDataExchange*, int, UINT&) {}
+inline void DDX_Text(CDataExchange*, int, double&) {}
+inline void DDX_Check(CDataExchange*, int, int&) {}
+inline void DDX_Radio(CDataExchange*, int, int&) {}
+inline void DDX_CBIndex(CDataExchange*, int, int&) {}
+inline void DDX_CBString(CDataExchange*, int, CString&) {}
+inline void DDX_LBIndex(CDataExchange*, int, int&) {}
+inline void DDX_Control(CDataExchange*, int, CWnd&) {}
+inline void DDV_MaxChars(CDataExchange*, const CString&, int) {}
+inline void DDV_MinMaxInt(CDataExchange*, int, int, int) {}
+
+class CDialog : public CWnd
+{
+public:
+	CDialog() {}
+	CDialog(UINT, CWnd* = NULL) {}
+	CDialog(LPCTSTR, CWnd* = NULL) {}
+
+	virtual BOOL	Create(UINT, CWnd* = NULL) { return FALSE; }
+	virtual BOOL	Create(LPCTSTR, CWnd* = NULL) { return FALSE; }
+	virtual INT_PTR	DoModal() { return IDCANCEL; }
+	void			EndDialog(int) {}
+	void			NextDlgCtrl() const {}
+	void			GotoDlgCtrl(CWnd*) {}
+
+protected:
+	virtual BOOL	OnInitDialog() { return TRUE; }
+	virtual void	OnOK() {}
+	virtual void	OnCancel() {}
+
+};
+
+#define BST_UNCHECKED		0
+#define BST_CHECKED			1
+
+#define LB_ERR				(-1)
+#define LB_ERRSPACE			(-2)
+#define CB_ERR				(-1)
+
+#define WS_CHILD			0x40000000
+#define WS_VISIBLE			0x10000000
+
+class CStatic : public CWnd {};
+
+class CEdit : public CWnd
+{
+public:
+	void			SetSel(int, int, BOOL = FALSE) {}
+	void			SetReadOnly(BOOL = TRUE) {}
+	void			ReplaceSel(LPCTSTR, BOOL = FALSE) {}
+	void			LimitText(int = 0) {}
+
+};
+
+class CButton : public CWnd
+{
+public:
+	CButton() : m_check(BST_UNCHECKED) {}
+
+	int				GetCheck() const { return m_check; }
+	void			SetCheck(int check) { m_check = check; }
+
+private:
+	int				m_check;
+
+};
+
+// The strings and item data of a list or combo box. They are kept,
+// so the code filling a box works, even though nothing shows them.
+class CShimListItems
+{
+public:
+	CShimListItems() : m_selected(-1) {}
+
+	int				GetCount() const { return static_cast<int>(m_items.size()); }
+	int				AddString(LPCTSTR str);
+	int				InsertString(int index, LPCTSTR str);
+	int				DeleteString(UINT index);
+	void			ResetContent() { m_items.clear(); m_selected = -1; }
+	int				FindString(int start, LPCTSTR str) const;
+	int				FindStringExact(int start, LPCTSTR str) const;
+	int				GetText(int index, CString& str) const;
+	int				GetTextLen(int index) const;
+	DWORD_PTR		GetItemData(int index) const;
+	int				SetItemData(int index, DWORD_PTR data);
+	int				GetCurSel() const { return m_selected; }
+	int				SetCurSel(int select);
+
+private:
+	std::vector< std::pair< CString, DWORD_PTR > >	m_items;
+	int				m_selected;
+
+};
+
+class CListBox : public CWnd
+{
+public:
+	int				GetCount() const { return m_items.GetCount(); }
+	virtual int		AddString(LPCTSTR str) { return m_items.AddString(str); }
+	virtual int		InsertString(int index, LPCTSTR str) { return m_items.InsertString(index, str); }
+	virtual int		DeleteString(UINT index) { return m_items.DeleteString(index); }
+	virtual void	ResetContent() { m_items.ResetContent(); }
+	int				FindString(int start, LPCTSTR str) const { return m_items.FindString(start, str); }
+	int				FindStringExact(int start, LPCTSTR str) const { return m_items.FindStringExact(start, str); }
+	int				GetText(int index, CString& str) const { return m_items.GetText(index, str); }
+	int				GetTextLen(int index) const { return m_items.GetTextLen(index); }
+	DWORD_PTR		GetItemData(int index) const { return m_items.GetItemData(index); }
+	int				SetItemData(int index, DWORD_PTR data) { return m_items.SetItemData(index, data); }
+	int				GetCurSel() const { return m_items.GetCurSel(); }
+	int				SetCurSel(int select) { return m_items.SetCurSel(select); }
+	BOOL			SetTabStops(int) { return TRUE; }
+	BOOL			SetTabStops(int, LPINT) { return TRUE; }
+	int				GetHorizontalExtent() const { return m_extent; }
+	void			SetHorizontalExtent(int extent) { m_extent = extent; }
+	int				GetTopIndex() const { return 0; }
+	int				SetTopIndex(int) { return 0; }
+
+private:
+	CShimListItems	m_items;
+	int				m_extent = 0;
+
+};
+
+class CComboBox : public CWnd
+{
+public:
+	int				GetCount() const { return m_items.GetCount(); }
+	int				AddString(LPCTSTR str) { return m_items.AddString(str); }
+	int				InsertString(int index, LPCTSTR str) { return m_items.InsertString(index, str); }
+	int				DeleteString(UINT index) { return m_items.DeleteString(index); }
+	void			ResetContent() { m_items.ResetContent(); }
+	int				FindString(int start, LPCTSTR str) const { return m_items.FindString(start, str); }
+	int				FindStringExact(int start, LPCTSTR str) const { return m_items.FindStringExact(start, str); }
+	int				GetLBText(int index, CString& str) const { return m_items.GetText(index, str); }
+	int				GetLBTextLen(int index) const { return m_items.GetTextLen(index); }
+	DWORD_PTR		GetItemData(int index) const { return m_items.GetItemData(index); }
+	int				SetItemData(int index, DWORD_PTR data) { return m_items.SetItemData(index, data); }
+	int				GetCurSel() const { return m_items.GetCurSel(); }
+	int				SetCurSel(int select) { return m_items.SetCurSel(select); }
+
+private:
+	CShimListItems	m_items;
+
+};
+
+// Common dialogs, which are always cancelled
+#define CF_SCREENFONTS		0x00000001
+#define CF_EFFECTS			0x00000100
+#define CF_INITTOLOGFONTSTRUCT	0x00000040
+#define CC_FULLOPEN			0x00000002
+#define CC_RGBINIT			0x00000001
+#define OFN_HIDEREADONLY	0x00000004
+#define OFN_OVERWRITEPROMPT	0x00000002
+#define OFN_FILEMUSTEXIST	0x00001000
+#define OFN_PATHMUSTEXIST	0x00000800
+
+class CFontDialog : public CDialog
+{
+public:
+	CFontDialog(LPLOGFONT lf = NULL, DWORD = CF_EFFECTS | CF_SCREENFONTS, CDC* = NULL, CWnd* = NULL) { memset(&m_lf, 0, sizeof(m_lf)); if (lf) m_lf = *lf; }
+
+	CString			GetFaceName() const { return m_lf.lfFaceName; }
+	BOOL			IsBold() const { return m_lf.lfWeight >= FW_BOLD; }
+	BOOL			IsItalic() const { return m_lf.lfItalic; }
+	BOOL			IsUnderline() const { return m_lf.lfUnderline; }
+	void			GetCurrentFont(LPLOGFONT lf) { *lf = m_lf; }
+	int				GetSize() const { return 0; }
+
+	LOGFONT			m_lf;
+
+};
+
+class CColorDialog : public CDialog
+{
+public:
+	CColorDialog(COLORREF color = 0, DWORD = 0, CWnd* = NULL) : m_color(color) {}
+
+	COLORREF		GetColor() const { return m_color; }
+
+private:
+	COLORREF		m_color;
+
+};
+
+class CFileDialog : public CDialog
+{
+public:
+	CFileDialog(BOOL, LPCTSTR = NULL, LPCTSTR = NULL, DWORD = 0, LPCTSTR = NULL, CWnd* = NULL) {}
+
+	CString			GetPathName() const { return CString(); }
+	CString			GetFileName() const { return CString(); }
+
+};
+
+#endif //_PORTABLEWND_H_4B1F7C2E_0D93_4A6C_9E57D2A8C41B3
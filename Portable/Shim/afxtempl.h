@@ -0,0 +1,7 @@
+// afxtempl.h : the collection templates come with the rest of
+// the stand-in for MFC.
+//
+
+#pragma once
+
+#include "PortableAfx.h"
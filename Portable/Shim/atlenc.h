@@ -0,0 +1,14 @@
+// atlenc.h : the base64 encoder of ATL, used for the images of the
+// HTML export.
+//
+
+#pragma once
+
+#include "PortableAfx.h"
+
+#define ATL_BASE64_FLAG_NONE	0
+#define ATL_BASE64_FLAG_NOPAD	1
+#define ATL_BASE64_FLAG_NOCRLF	2
+
+int		Base64EncodeGetRequiredLength(int length, DWORD flags = ATL_BASE64_FLAG_NONE);
+BOOL	Base64Encode(const BYTE* data, int length, LPSTR dest, int* destLength, DWORD flags = ATL_BASE64_FLAG_NONE);
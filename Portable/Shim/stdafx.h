@@ -0,0 +1,8 @@
+// stdafx.h : stands in for the application's precompiled header
+// when the engine sources are built without MFC.
+//
+
+#pragma once
+
+#include "PortableAfx.h"
+#include "PortableWnd.h"
@@ -0,0 +1,7 @@
+#ifndef _TCHAR_H_2E9C4D71_8A05_4B3F_A6D1E07F93C24
+#define _TCHAR_H_2E9C4D71_8A05_4B3F_A6D1E07F93C24
+
+// The _T and _tcs names are in "PortableAfx.h"
+#include "PortableAfx.h"
+
+#endif //_TCHAR_H_2E9C4D71_8A05_4B3F_A6D1E07F93C24
@@ -239,6 +239,13 @@
 #define ID_EXPORT_CPP                   32821
 #define ID_DUPLICATE                    32823
 #define ID_UML_OPEN_PACKAGE             32824
+#define ID_AUTO_LAYOUT                  32826
+#define ID_ROUTE_LINKS                  32827
+#define ID_TRACE                        32828
+#define ID_TRACE_SAVE                   32829
+#define ID_PERFORMANCE                  32830
+#define ID_MEMORY_USAGE                 32831
+#define ID_IMPORT_FOLDER                32832
 #define IDM_NETWORKEDITOR_LINK          33442
 #define IDM_NETWORKEDITOR_UNLINK        33445
 #define IDS_UML_CLASS                   33447
@@ -266,6 +273,11 @@
 #define IDS_UML_SETTER_MUST_HAVE_A_NAME 33471
 #define IDS_UML_GETSET_DEFINED          33472
 #define IDS_UML_MUST_SELECT_AN_ATTRIBUTE 33473
+#define IDS_UML_SELECT_IMPORT_FOLDER    33474
+#define IDS_UML_IMPORT_FINISHED         33475
+#define IDS_UML_IMPORT_MORE_ERRORS      33476
+#define IDS_UML_UNKNOWN_DECLARATION     33477
+#define IDS_UML_NO_CLASSES_FOUND        33478
 #define ID_NET_BUTTON_ADD_SERVER        34771
 #define ID_NET_BUTTON_ADD_CLIENT        34772
 #define ID_NET_BUTTON_ADD_PRINTER       34773
@@ -336,7 +348,7 @@
 #ifdef APSTUDIO_INVOKED
 #ifndef APSTUDIO_READONLY_SYMBOLS
 #define _APS_NEXT_RESOURCE_VALUE        312
-#define _APS_NEXT_COMMAND_VALUE         32826
+#define _APS_NEXT_COMMAND_VALUE         32833
 #define _APS_NEXT_CONTROL_VALUE         1000
 #define _APS_NEXT_SYMED_VALUE           311
 #endif
@@ -27,6 +27,10 @@
 #include "NetView.h"
 #include "UmlDoc.h"
 #include "UmlView.h"
+#include "Benchmark.h"
+#include "DiagramEditor/DiagramEditor.h"
+#include "DiagramEditor/DiagramTrace.h"
+#include "TextFile/TextFile.h"
 
 #ifdef _DEBUG
 #define new DEBUG_NEW
@@ -45,6 +49,9 @@ BEGIN_MESSAGE_MAP(CTulipApp, CWinAppEx)
 	ON_COMMAND(ID_FILE_NEW_NET, &CTulipApp::OnFileNewNet)
 	ON_COMMAND(ID_FILE_NEW_UML, &CTulipApp::OnFileNewUml)
 	ON_COMMAND(ID_FILE_OPEN, &CTulipApp::OnFileOpen)
+	ON_COMMAND(ID_TRACE, &CTulipApp::OnTrace)
+	ON_UPDATE_COMMAND_UI(ID_TRACE, &CTulipApp::OnUpdateTrace)
+	ON_COMMAND(ID_TRACE_SAVE, &CTulipApp::OnTraceSave)
 	// Standard print setup command
 	ON_COMMAND(ID_FILE_PRINT_SETUP, &CWinAppEx::OnFilePrintSetup)
 END_MESSAGE_MAP()
@@ -98,6 +105,24 @@ BOOL CTulipApp::InitInstance()
 		return FALSE;
 	}
 
+	// Time the diagram models without showing any windows
+	CBenchmarkCommandLineInfo benchmarkInfo;
+	ParseCommandLine(benchmarkInfo);
+	if (benchmarkInfo.m_benchmark)
+	{
+		CBenchmark benchmark;
+		benchmark.Run(benchmarkInfo.m_output.IsEmpty() ? CString(_T("benchmark.csv")) : benchmarkInfo.m_output, benchmarkInfo.m_sizes);
+		return FALSE;
+	}
+
+	// Trace from the start if "TULIP_TRACE" names a file to save the trace to on exit
+	TCHAR trace[MAX_PATH];
+	if (::GetEnvironmentVariable(_T("TULIP_TRACE"), trace, MAX_PATH) && trace[0])
+	{
+		m_spanFile = trace;
+		CDiagramTrace::Enable(TRUE);
+	}
+
 	EnableTaskbarInteraction(TRUE);
 
 	// AfxInitRichEdit2() is required to use RichEdit control
@@ -159,6 +184,40 @@ BOOL CTulipApp::InitInstance()
 		return FALSE;
 	AddDocTemplate(m_umlDocTemplate);
 
+	// Render a saved diagram to a PNG without showing any windows
+	if (benchmarkInfo.m_render)
+	{
+		CDocTemplate* docTemplate = NULL;
+		POSITION pos = GetFirstDocTemplatePosition();
+		while (pos && !docTemplate)
+		{
+			CDocTemplate* candidate = GetNextDocTemplate(pos);
+			CDocument* open = NULL;
+			if (candidate->MatchDocType(benchmarkInfo.m_input, open) == CDocTemplate::yesAttemptNative)
+				docTemplate = candidate;
+		}
+
+		CDocument* doc = docTemplate ? docTemplate->CreateNewDocument() : NULL;
+		if (doc && doc->OnOpenDocument(benchmarkInfo.m_input))
+		{
+			CDiagramEntityContainer* objs = NULL;
+			if (doc->IsKindOf(RUNTIME_CLASS(CDialogEditorDoc)))
+				objs = static_cast<CDialogEditorDoc*>(doc)->GetData();
+			else if (doc->IsKindOf(RUNTIME_CLASS(CFlowchartDoc)))
+				objs = static_cast<CFlowchartDoc*>(doc)->GetData();
+			else if (doc->IsKindOf(RUNTIME_CLASS(CNetDoc)))
+				objs = static_cast<CNetDoc*>(doc)->GetData();
+			else if (doc->IsKindOf(RUNTIME_CLASS(CUmlDoc)))
+				objs = static_cast<CUmlDoc*>(doc)->GetData();
+
+			if (objs)
+				CBenchmark::SavePNG(objs, benchmarkInfo.m_output.IsEmpty() ? CString(_T("diagram.png")) : benchmarkInfo.m_output);
+		}
+
+		delete doc;
+		return FALSE;
+	}
+
 	// create main MDI Frame window
 	CMainFrame* pMainFrame = new CMainFrame;
 	if (!pMainFrame || !pMainFrame->LoadFrame(IDR_MAINFRAME))
@@ -185,16 +244,70 @@ BOOL CTulipApp::InitInstance()
 	pMainFrame->ShowWindow(m_nCmdShow);
 	pMainFrame->UpdateWindow();
 
+	// Record the input to the opened diagram until the application exits
+	if (benchmarkInfo.m_record && !benchmarkInfo.m_trace.IsEmpty())
+	{
+		CDiagramEditor* editor = GetActiveEditor();
+		if (editor)
+		{
+			m_traceFile = benchmarkInfo.m_trace;
+			editor->SetRecorder(&m_recorder);
+		}
+	}
+
+	// Replay a trace against the opened diagram, write the latencies and exit
+	if (benchmarkInfo.m_replay)
+	{
+		CDiagramEditor* editor = GetActiveEditor();
+		if (editor && m_recorder.Load(benchmarkInfo.m_trace) && editor->Replay(&m_recorder))
+		{
+			CStringArray report;
+			m_recorder.GetReport(report);
+
+			CTextFile file(_T(""), _T("\r\n"));
+			CString output(benchmarkInfo.m_output.IsEmpty() ? CString(_T("replay.csv")) : benchmarkInfo.m_output);
+			file.WriteTextFile(output, report);
+		}
+
+		return FALSE;
+	}
+
 	return TRUE;
 }
 
 int CTulipApp::ExitInstance()
 {
+	if (!m_traceFile.IsEmpty())
+		m_recorder.Save(m_traceFile);
+
+	if (!m_spanFile.IsEmpty())
+		CDiagramTrace::Save(m_spanFile);
+	CDiagramTrace::Free();
+
 	AfxOleTerm(FALSE);
 
 	return CWinAppEx::ExitInstance();
 }
 
+// Finds the diagram editor of the active view.
+CDiagramEditor* CTulipApp::GetActiveEditor() const
+{
+	CMDIFrameWnd* frame = DYNAMIC_DOWNCAST(CMDIFrameWnd, m_pMainWnd);
+	CMDIChildWnd* child = frame ? frame->MDIGetActive() : NULL;
+	CView* view = child ? child->GetActiveView() : NULL;
+	if (view)
+	{
+		for (CWnd* wnd = view->GetWindow(GW_CHILD); wnd; wnd = wnd->GetNextWindow())
+		{
+			CDiagramEditor* editor = DYNAMIC_DOWNCAST(CDiagramEditor, wnd);
+			if (editor)
+				return editor;
+		}
+	}
+
+	return NULL;
+}
+
 // CTulipApp message handlers
 
 
@@ -283,6 +396,27 @@ void CTulipApp::OnFileOpen()
 	}
 }
 
+void CTulipApp::OnTrace()
+{
+	CDiagramTrace::Enable(!CDiagramTrace::IsEnabled());
+}
+
+void CTulipApp::OnUpdateTrace(CCmdUI* pCmdUI)
+{
+	pCmdUI->SetCheck(CDiagramTrace::IsEnabled());
+}
+
+void CTulipApp::OnTraceSave()
+{
+	CFileDialog dlgFile(FALSE, _T("json"), _T("trace.json"),
+		OFN_HIDEREADONLY | OFN_OVERWRITEPROMPT,
+		_T("Chrome Trace (*.json)|*.json|All Files (*.*)|*.*||"),
+		AfxGetMainWnd());
+
+	if (dlgFile.DoModal() == IDOK && !CDiagramTrace::Save(dlgFile.GetPathName()))
+		AfxMessageBox(_T("The trace could not be saved."));
+}
+
 // CTulipApp customization load/save methods
 
 void CTulipApp::PreLoadState()
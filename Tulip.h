@@ -22,6 +22,9 @@
 #include "FlowchartEditor/FlowchartClipboardHandler.h"
 #include "NetworkEditor/NetworkEditorClipboardHandler.h"
 #include "UMLEditor/UMLClipboardHandler.h"
+#include "DiagramEditor/DiagramRecorder.h"
+
+class CDiagramEditor;
 
 
 // CTulipApp:
@@ -37,6 +40,10 @@ public:
 	CNetworkEditorClipboardHandler	m_netClip;
 	CFlowchartClipboardHandler	m_flowchartClip;
 
+	CDiagramRecorder				m_recorder;		// Input events from "/record", or the trace from "/replay"
+	CString							m_traceFile;	// Trace to save the recording to on exit
+	CString							m_spanFile;		// File from "TULIP_TRACE" to save the spans to on exit
+
 	// Overrides
 public:
 	virtual BOOL InitInstance();
@@ -55,8 +62,13 @@ public:
 	afx_msg void OnFileNewNet();
 	afx_msg void OnFileNewUml();
 	afx_msg void OnFileOpen();
+	afx_msg void OnTrace();
+	afx_msg void OnUpdateTrace(CCmdUI* pCmdUI);
+	afx_msg void OnTraceSave();
 	DECLARE_MESSAGE_MAP()
 protected:
+	CDiagramEditor* GetActiveEditor() const;
+
 	CMultiDocTemplate* m_dialogDocTemplate;
 	CMultiDocTemplate* m_flowchartDocTemplate;
 	CMultiDocTemplate* m_netDocTemplate;
@@ -29,6 +29,8 @@
 static char THIS_FILE[] = __FILE__;
 #endif
 
+IMPLEMENT_POOLED_ALLOC(CAttribute, 256)
+
 // Construction/destruction
 CAttribute::CAttribute()
 /* ============================================================
@@ -227,7 +229,7 @@ CString CAttribute::GetString(int format) const
 	CString result;
 	if (format == STRING_FORMAT_SAVE)
 	{
-		CString type(type);
+		CString type(this->type);
 		CString multi(multiplicity);
 		CString defval(defaultvalue);
 		CString propertylist(properties.GetString(STRING_FORMAT_SAVE));
@@ -260,7 +262,7 @@ CString CAttribute::GetString(int format) const
 		result += name;
 		if (multiplicity.GetLength())
 		{
-			CString multiplicity(multiplicity);
+			CString multiplicity(this->multiplicity);
 			int found = multiplicity.Find(_T("."));
 			while (found != -1)
 			{
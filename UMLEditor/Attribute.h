@@ -8,9 +8,12 @@
 
 #include "StringHelpers.h"
 #include "PropertyContainer.h"
+#include "../DiagramEditor/ObjectPool.h"
 
 class CAttribute : public CObject
 {
+	DECLARE_POOLED_ALLOC(CAttribute)
+
 public:
 	// Construction/destruction
 	CAttribute();
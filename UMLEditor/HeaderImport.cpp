@@ -0,0 +1,475 @@
+/* ==========================================================================
+	File :			HeaderImport.cpp
+
+	Class :			CHeaderImport
+
+	Date :			10/19/26
+
+	Purpose :		"CHeaderImport" reads all the c++ header files of
+					a folder and its subfolders.
+
+	Description :	The files are found with "CDiskObject", and each
+					is read and parsed by its own "CHeaderParser".
+					Files are independent of each other, so they are
+					parsed on several threads. Each thread takes the
+					next file not yet taken, until there are none
+					left, and the calling thread parses files too.
+
+					A file that cannot be read gets an error message,
+					and the other files are still parsed. Nothing is
+					added to a diagram here - the caller makes UML
+					objects of the classes afterwards, on the UI
+					thread.
+
+	Usage :			Call "Parse" with a folder, and read the results
+					with "GetFile".
+
+   ========================================================================*/
+
+#include "stdafx.h"
+#include "HeaderImport.h"
+#include "../DiagramEditor/DiagramTrace.h"
+#include "../DiskObject/DiskObject.h"
+#include "../TextFile/TextFile.h"
+
+#ifdef _DEBUG
+#define new DEBUG_NEW
+#undef THIS_FILE
+static char THIS_FILE[] = __FILE__;
+#endif
+
+#define MAX_THREADS			16		// Maximum number of worker threads
+
+/////////////////////////////////////////////////////////////////////////////
+// CHeaderImport construction/destruction
+
+CHeaderImport::CHeaderImport()
+/* ============================================================
+	Function :		CHeaderImport::CHeaderImport
+	Description :	Constructor
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	m_threads = 0;
+	m_nextFile = 0;
+	m_running = 0;
+	m_time = 0;
+
+}
+
+CHeaderImport::~CHeaderImport()
+/* ============================================================
+	Function :		CHeaderImport::~CHeaderImport
+	Description :	Destructor
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	Clear();
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CHeaderImport settings
+
+void CHeaderImport::SetThreadCount(int threads)
+/* ============================================================
+	Function :		CHeaderImport::SetThreadCount
+	Description :	Sets the number of threads parsing files.
+	Access :		Public
+
+	Return :		void
+	Parameters :	int threads	-	Number of threads, 0 to use
+									one per processor.
+
+	Usage :			The calling thread is counted, so 1 parses
+					all files on the calling thread.
+
+   ============================================================*/
+{
+
+	m_threads = max(threads, 0);
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CHeaderImport operations
+
+BOOL CHeaderImport::Parse(const CString& folder)
+/* ============================================================
+	Function :		CHeaderImport::Parse
+	Description :	Reads the header files of a folder and its
+					subfolders.
+	Access :		Public
+
+	Return :		BOOL					-	"FALSE" if the
+												folder could not
+												be searched.
+	Parameters :	const CString& folder	-	Folder to read.
+
+	Usage :			Files with the extensions "h", "hh", "hpp"
+					and "hxx" are read. Errors in single files
+					do not make the call fail - they are set in
+					the "CHeaderFile" of the file.
+
+   ============================================================*/
+{
+
+	DIAGRAM_TRACE_SPAN(_T("CHeaderImport::Parse"));
+
+	Clear();
+
+	m_folder = folder;
+	if (m_folder.GetLength() && (m_folder[m_folder.GetLength() - 1] == _TCHAR('\\') || m_folder[m_folder.GetLength() - 1] == _TCHAR('/')))
+		m_folder = m_folder.Left(m_folder.GetLength() - 1);
+
+	CDiskObject disk;
+	CStringArray filenames;
+	if (!disk.EnumAllFilesWithFilter(_T("*.h*"), m_folder, filenames))
+	{
+		m_error = disk.GetErrorMessage();
+		return FALSE;
+	}
+
+	INT_PTR max = filenames.GetSize();
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		CString filename = filenames[t];
+		if (IsHeader(filename))
+		{
+			CHeaderFile* file = new CHeaderFile;
+			file->filename = filename;
+
+			// The part of the path between the folder and the file name
+			CString relative = filename.Mid(m_folder.GetLength() + 1);
+			int found = relative.ReverseFind(_TCHAR('\\'));
+			if (found != -1)
+				file->folder = relative.Left(found);
+
+			m_files.Add(file);
+		}
+	}
+
+	LARGE_INTEGER frequency;
+	LARGE_INTEGER start;
+	::QueryPerformanceFrequency(&frequency);
+	::QueryPerformanceCounter(&start);
+
+	int threads = m_threads;
+	if (threads == 0)
+	{
+		SYSTEM_INFO info;
+		::GetSystemInfo(&info);
+		threads = min(static_cast<int>(info.dwNumberOfProcessors), MAX_THREADS);
+	}
+	threads = max(1, min(threads, static_cast<int>(m_files.GetSize())));
+
+	m_nextFile = 0;
+	CWinThread** workers = new CWinThread*[threads];
+	workers[0] = NULL;
+	for (int t = 1; t < threads; t++)
+	{
+		workers[t] = AfxBeginThread(WorkerProc, this, THREAD_PRIORITY_NORMAL, 0, CREATE_SUSPENDED);
+		if (workers[t])
+		{
+			workers[t]->m_bAutoDelete = FALSE;
+			workers[t]->ResumeThread();
+			m_running++;
+		}
+	}
+
+	ParseFiles();
+
+	for (int t = 1; t < threads; t++)
+	{
+		if (workers[t])
+		{
+			::WaitForSingleObject(workers[t]->m_hThread, INFINITE);
+			delete workers[t];
+		}
+	}
+
+	delete[] workers;
+
+	LARGE_INTEGER end;
+	::QueryPerformanceCounter(&end);
+	m_time = static_cast<double>(end.QuadPart - start.QuadPart) * 1000.0 / static_cast<double>(frequency.QuadPart);
+
+	return TRUE;
+
+}
+
+void CHeaderImport::Clear()
+/* ============================================================
+	Function :		CHeaderImport::Clear
+	Description :	Deletes the files of the last import.
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	INT_PTR max = m_files.GetSize();
+	for (INT_PTR t = 0; t < max; t++)
+		delete m_files.GetAt(t);
+
+	m_files.RemoveAll();
+	m_folder = _T("");
+	m_error = _T("");
+	m_running = 0;
+	m_time = 0;
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CHeaderImport results
+
+CString CHeaderImport::GetFolder() const
+/* ============================================================
+	Function :		CHeaderImport::GetFolder
+	Description :	Gets the folder of the last import.
+	Access :		Public
+
+	Return :		CString	-	The folder, without a trailing
+								backslash.
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	return m_folder;
+
+}
+
+INT_PTR CHeaderImport::GetFileCount() const
+/* ============================================================
+	Function :		CHeaderImport::GetFileCount
+	Description :	Gets the number of header files found.
+	Access :		Public
+
+	Return :		INT_PTR	-	Number of files.
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	return m_files.GetSize();
+
+}
+
+CHeaderFile* CHeaderImport::GetFile(INT_PTR index) const
+/* ============================================================
+	Function :		CHeaderImport::GetFile
+	Description :	Gets a header file found.
+	Access :		Public
+
+	Return :		CHeaderFile*	-	The file, or "NULL".
+	Parameters :	INT_PTR index	-	Index of the file.
+
+	Usage :			The import owns the file.
+
+   ============================================================*/
+{
+
+	if (index < 0 || index >= m_files.GetSize())
+		return NULL;
+
+	return static_cast<CHeaderFile*>(m_files.GetAt(index));
+
+}
+
+INT_PTR CHeaderImport::GetClassCount() const
+/* ============================================================
+	Function :		CHeaderImport::GetClassCount
+	Description :	Gets the number of classes in all files.
+	Access :		Public
+
+	Return :		INT_PTR	-	Number of classes.
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	INT_PTR result = 0;
+	INT_PTR max = m_files.GetSize();
+	for (INT_PTR t = 0; t < max; t++)
+		result += GetFile(t)->parser.GetClassCount();
+
+	return result;
+
+}
+
+int CHeaderImport::GetThreadCount() const
+/* ============================================================
+	Function :		CHeaderImport::GetThreadCount
+	Description :	Gets the number of worker threads of the
+					last import.
+	Access :		Public
+
+	Return :		int	-	Number of threads, 0 if the files
+							were parsed by the calling thread.
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	return m_running;
+
+}
+
+double CHeaderImport::GetTotalTime() const
+/* ============================================================
+	Function :		CHeaderImport::GetTotalTime
+	Description :	Gets the time it took to read and parse
+					the files of the last import.
+	Access :		Public
+
+	Return :		double	-	Time in milliseconds.
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	return m_time;
+
+}
+
+CString CHeaderImport::GetErrorMessage() const
+/* ============================================================
+	Function :		CHeaderImport::GetErrorMessage
+	Description :	Gets the error of the last import.
+	Access :		Public
+
+	Return :		CString	-	The error, empty if none.
+	Parameters :	none
+
+	Usage :			Set when "Parse" returns "FALSE".
+
+   ============================================================*/
+{
+
+	return m_error;
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CHeaderImport helpers
+
+void CHeaderImport::ParseFiles()
+/* ============================================================
+	Function :		CHeaderImport::ParseFiles
+	Description :	Reads and parses files until there are
+					none left.
+	Access :		Private
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Run by all threads at the same time. Each
+					file is taken by one thread only.
+
+   ============================================================*/
+{
+
+	DIAGRAM_TRACE_SPAN(_T("CHeaderImport::ParseFiles"));
+
+	LONG index;
+	while ((index = ::InterlockedIncrement(&m_nextFile) - 1) < static_cast<LONG>(m_files.GetSize()))
+	{
+		CHeaderFile* file = GetFile(index);
+		TRY
+		{
+			CTextFile text(_T(""), _T("\n"));
+			CString filename(file->filename);
+			CString contents;
+			if (text.ReadTextFile(filename, contents))
+				file->parser.Parse(contents, contents.GetLength());
+			else
+				file->error = text.GetErrorMessage();
+		}
+		CATCH_ALL(e)
+		{
+			TCHAR message[256];
+			e->GetErrorMessage(message, 256);
+			file->error = message;
+			e->Delete();
+		}
+		END_CATCH_ALL
+	}
+
+}
+
+BOOL CHeaderImport::IsHeader(const CString& filename)
+/* ============================================================
+	Function :		CHeaderImport::IsHeader
+	Description :	Checks the extension of a file.
+	Access :		Private
+
+	Return :		BOOL					-	"TRUE" for a
+												header file.
+	Parameters :	const CString& filename	-	File to check.
+
+	Usage :			The search filter "*.h*" also finds files
+					such as "*.html", so the extension is
+					checked again.
+
+   ============================================================*/
+{
+
+	int found = filename.ReverseFind(_TCHAR('.'));
+	if (found == -1)
+		return FALSE;
+
+	CString extension = filename.Mid(found + 1);
+	extension.MakeLower();
+
+	return extension == _T("h") || extension == _T("hh") || extension == _T("hpp") || extension == _T("hxx");
+
+}
+
+UINT AFX_CDECL CHeaderImport::WorkerProc(LPVOID param)
+/* ============================================================
+	Function :		CHeaderImport::WorkerProc
+	Description :	Thread function for a parsing worker.
+	Access :		Private
+
+	Return :		UINT			-	Always 0.
+	Parameters :	LPVOID param	-	The "CHeaderImport".
+
+	Usage :			Started from "Parse".
+
+   ============================================================*/
+{
+
+	CHeaderImport* import = static_cast<CHeaderImport*>(param);
+	import->ParseFiles();
+	return 0;
+
+}
@@ -0,0 +1,67 @@
+#ifndef _CHEADERIMPORT_H_E2A64C9D_1B37_4F80_B5C2D8E97A016
+#define _CHEADERIMPORT_H_E2A64C9D_1B37_4F80_B5C2D8E97A016
+
+///////////////////////////////////////////////////////////
+// File :		HeaderImport.h
+// Created :	10/19/26
+//
+
+#include "HeaderParser.h"
+
+// A header file read by "CHeaderImport"
+class CHeaderFile : public CObject
+{
+public:
+	CString			filename;	// Fully qualified
+	CString			folder;		// Relative to the imported folder, empty for the folder itself
+	CString			error;		// Set if the file could not be read
+	CHeaderParser	parser;		// Classes and errors of the file
+
+};
+
+class CHeaderImport
+{
+public:
+	// Construction/destruction
+	CHeaderImport();
+	virtual ~CHeaderImport();
+
+	// Settings
+	void			SetThreadCount(int threads);
+
+	// Operations
+	BOOL			Parse(const CString& folder);
+	void			Clear();
+
+	// Results
+	CString			GetFolder() const;
+	INT_PTR			GetFileCount() const;
+	CHeaderFile*	GetFile(INT_PTR index) const;
+	INT_PTR			GetClassCount() const;
+	int				GetThreadCount() const;
+	double			GetTotalTime() const;
+	CString			GetErrorMessage() const;
+
+private:
+	// Settings
+	int				m_threads;
+
+	// Current import
+	CString			m_folder;
+	CObArray		m_files;
+	volatile LONG	m_nextFile;		// Next file to parse
+
+	// Results
+	int				m_running;
+	double			m_time;
+	CString			m_error;
+
+	// Helpers
+	void			ParseFiles();
+	static BOOL		IsHeader(const CString& filename);
+
+	static UINT AFX_CDECL WorkerProc(LPVOID param);
+
+};
+
+#endif //_CHEADERIMPORT_H_E2A64C9D_1B37_4F80_B5C2D8E97A016
@@ -0,0 +1,584 @@
+/* ==========================================================================
+	File :			HeaderLexer.cpp
+
+	Class :			CHeaderLexer
+
+	Date :			10/19/26
+
+	Purpose :		"CHeaderLexer" splits the text of a c++ header
+					file into tokens for "CHeaderParser".
+
+	Description :	The text is read once, from start to end.
+					Whitespace, comments and preprocessor lines are
+					skipped, and every other token is stored with
+					its offset, length, line and column. The text
+					itself is not copied, so it must be kept until
+					the tokens are no longer needed.
+
+					Only the punctuators the parser looks at as a
+					whole - "::", "->" and "..." - are longer than
+					one character. In particular, ">>" is two
+					tokens, which closes two template argument
+					lists.
+
+					A comment that is not closed stops the lexer.
+					The tokens before it are kept, and the position
+					of the comment is set as the error.
+
+	Usage :			Call "Tokenize", and read the tokens with
+					"GetAt" and "GetText". The class uses no UI
+					and no other objects of the editor, and a
+					lexer can be used from any thread.
+
+   ========================================================================*/
+
+#include "stdafx.h"
+#include "HeaderLexer.h"
+
+#ifdef _DEBUG
+#define new DEBUG_NEW
+#undef THIS_FILE
+static char THIS_FILE[] = __FILE__;
+#endif
+
+static inline BOOL IsIdentifierStart(TCHAR c)
+{
+	return (c >= _TCHAR('a') && c <= _TCHAR('z')) || (c >= _TCHAR('A') && c <= _TCHAR('Z')) ||
+		c == _TCHAR('_') || c == _TCHAR('$') || static_cast<_TUCHAR>(c) >= 0x80;
+}
+
+static inline BOOL IsIdentifierChar(TCHAR c)
+{
+	return IsIdentifierStart(c) || (c >= _TCHAR('0') && c <= _TCHAR('9'));
+}
+
+static inline BOOL IsDigit(TCHAR c)
+{
+	return c >= _TCHAR('0') && c <= _TCHAR('9');
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CHeaderLexer construction/destruction
+
+CHeaderLexer::CHeaderLexer()
+/* ============================================================
+	Function :		CHeaderLexer::CHeaderLexer
+	Description :	Constructor
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	m_text = NULL;
+	m_length = 0;
+	m_errorLine = 0;
+	m_errorColumn = 0;
+
+	m_end.type = HEADER_TOKEN_END;
+	m_end.start = 0;
+	m_end.length = 0;
+	m_end.line = 1;
+	m_end.column = 1;
+
+}
+
+CHeaderLexer::~CHeaderLexer()
+/* ============================================================
+	Function :		CHeaderLexer::~CHeaderLexer
+	Description :	Destructor
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CHeaderLexer operations
+
+BOOL CHeaderLexer::Tokenize(LPCTSTR text, int length)
+/* ============================================================
+	Function :		CHeaderLexer::Tokenize
+	Description :	Splits "text" into tokens.
+	Access :		Public
+
+	Return :		BOOL			-	"FALSE" if a comment is
+										not closed.
+	Parameters :	LPCTSTR text	-	Text to split. Must be
+										kept until the tokens
+										are no longer used.
+					int length		-	Length of "text".
+
+	Usage :			Replaces the tokens of an earlier call. A
+					directive is a "#" first on a line, and
+					runs to the end of the line, or further if
+					the line ends with a backslash. Literals
+					not closed end at the end of the line.
+
+   ============================================================*/
+{
+
+	Clear();
+	m_text = text;
+	m_length = length;
+	m_tokens.SetSize(0, length / 6 + 16);
+
+	BOOL result = TRUE;
+	int line = 1;
+	int lineStart = 0;
+	BOOL lineBegin = TRUE;	// Only whitespace so far on the line
+	int pos = 0;
+	while (pos < length && result)
+	{
+		TCHAR c = text[pos];
+		TCHAR next = (pos + 1 < length) ? text[pos + 1] : _TCHAR('\0');
+
+		// Whitespace
+		if (c == _TCHAR('\n'))
+		{
+			pos++;
+			line++;
+			lineStart = pos;
+			lineBegin = TRUE;
+			continue;
+		}
+
+		if (c == _TCHAR(' ') || c == _TCHAR('\t') || c == _TCHAR('\r') || c == _TCHAR('\f') || c == _TCHAR('\v'))
+		{
+			pos++;
+			continue;
+		}
+
+		// Comments
+		if (c == _TCHAR('/') && next == _TCHAR('/'))
+		{
+			while (pos < length && text[pos] != _TCHAR('\n'))
+				pos++;
+			continue;
+		}
+
+		if (c == _TCHAR('/') && next == _TCHAR('*'))
+		{
+			int startLine = line;
+			int startColumn = pos - lineStart + 1;
+			pos += 2;
+			while (pos < length && !(text[pos] == _TCHAR('*') && pos + 1 < length && text[pos + 1] == _TCHAR('/')))
+			{
+				if (text[pos] == _TCHAR('\n'))
+				{
+					line++;
+					lineStart = pos + 1;
+				}
+				pos++;
+			}
+
+			if (pos < length)
+				pos += 2;
+			else
+			{
+				m_errorLine = startLine;
+				m_errorColumn = startColumn;
+				result = FALSE;
+			}
+			continue;
+		}
+
+		// Preprocessor directives
+		if (c == _TCHAR('#') && lineBegin)
+		{
+			while (pos < length && text[pos] != _TCHAR('\n'))
+			{
+				if (text[pos] == _TCHAR('\\'))
+				{
+					// A line continuation
+					int end = pos + 1;
+					if (end < length && text[end] == _TCHAR('\r'))
+						end++;
+					if (end < length && text[end] == _TCHAR('\n'))
+					{
+						pos = end + 1;
+						line++;
+						lineStart = pos;
+						continue;
+					}
+				}
+				else if (text[pos] == _TCHAR('/') && pos + 1 < length && text[pos + 1] == _TCHAR('/'))
+				{
+					while (pos < length && text[pos] != _TCHAR('\n'))
+						pos++;
+					continue;
+				}
+				else if (text[pos] == _TCHAR('/') && pos + 1 < length && text[pos + 1] == _TCHAR('*'))
+				{
+					// A comment in a directive may run over several lines
+					int startLine = line;
+					int startColumn = pos - lineStart + 1;
+					pos += 2;
+					while (pos < length && !(text[pos] == _TCHAR('*') && pos + 1 < length && text[pos + 1] == _TCHAR('/')))
+					{
+						if (text[pos] == _TCHAR('\n'))
+						{
+							line++;
+							lineStart = pos + 1;
+						}
+						pos++;
+					}
+
+					if (pos < length)
+						pos += 2;
+					else
+					{
+						m_errorLine = startLine;
+						m_errorColumn = startColumn;
+						result = FALSE;
+					}
+					continue;
+				}
+
+				pos++;
+			}
+			continue;
+		}
+
+		lineBegin = FALSE;
+
+		CHeaderToken token;
+		token.start = pos;
+		token.line = line;
+		token.column = pos - lineStart + 1;
+
+		if (IsIdentifierStart(c))
+		{
+			token.type = HEADER_TOKEN_IDENTIFIER;
+			while (pos < length && IsIdentifierChar(text[pos]))
+				pos++;
+
+			// Prefixed literals, such as L"text" and R"(text)"
+			if (pos < length && (text[pos] == _TCHAR('"') || text[pos] == _TCHAR('\'')) && pos - token.start <= 3)
+			{
+				BOOL raw = (text[pos - 1] == _TCHAR('R') && text[pos] == _TCHAR('"'));
+				token.type = HEADER_TOKEN_LITERAL;
+				if (raw)
+				{
+					// The delimiter runs to the opening parenthesis
+					int delimiter = pos + 1;
+					int open = delimiter;
+					while (open < length && text[open] != _TCHAR('(') && text[open] != _TCHAR('\n') && open - delimiter <= 16)
+						open++;
+
+					if (open < length && text[open] == _TCHAR('('))
+					{
+						int size = open - delimiter;
+						pos = open + 1;
+						BOOL found = FALSE;
+						while (pos < length && !found)
+						{
+							if (text[pos] == _TCHAR(')') && pos + size + 1 < length && text[pos + size + 1] == _TCHAR('"') &&
+								_tcsncmp(text + pos + 1, text + delimiter, size) == 0)
+							{
+								pos += size + 2;
+								found = TRUE;
+							}
+							else
+							{
+								if (text[pos] == _TCHAR('\n'))
+								{
+									line++;
+									lineStart = pos + 1;
+								}
+								pos++;
+							}
+						}
+					}
+					else
+						raw = FALSE;
+				}
+
+				if (!raw)
+				{
+					TCHAR quote = text[pos++];
+					while (pos < length && text[pos] != quote && text[pos] != _TCHAR('\n'))
+					{
+						if (text[pos] == _TCHAR('\\') && pos + 1 < length && text[pos + 1] != _TCHAR('\n'))
+							pos++;
+						pos++;
+					}
+					if (pos < length && text[pos] == quote)
+						pos++;
+				}
+			}
+		}
+		else if (IsDigit(c) || (c == _TCHAR('.') && IsDigit(next)))
+		{
+			token.type = HEADER_TOKEN_NUMBER;
+			pos++;
+			while (pos < length)
+			{
+				TCHAR d = text[pos];
+				if (IsIdentifierChar(d) || d == _TCHAR('.') || d == _TCHAR('\''))
+					pos++;
+				else if ((d == _TCHAR('+') || d == _TCHAR('-')) &&
+					(text[pos - 1] == _TCHAR('e') || text[pos - 1] == _TCHAR('E') || text[pos - 1] == _TCHAR('p') || text[pos - 1] == _TCHAR('P')))
+					pos++;
+				else
+					break;
+			}
+		}
+		else if (c == _TCHAR('"') || c == _TCHAR('\''))
+		{
+			token.type = HEADER_TOKEN_LITERAL;
+			pos++;
+			while (pos < length && text[pos] != c && text[pos] != _TCHAR('\n'))
+			{
+				if (text[pos] == _TCHAR('\\') && pos + 1 < length && text[pos + 1] != _TCHAR('\n'))
+					pos++;
+				pos++;
+			}
+			if (pos < length && text[pos] == c)
+				pos++;
+		}
+		else
+		{
+			token.type = HEADER_TOKEN_PUNCTUATOR;
+			if (c == _TCHAR(':') && next == _TCHAR(':'))
+				pos += 2;
+			else if (c == _TCHAR('-') && next == _TCHAR('>'))
+				pos += 2;
+			else if (c == _TCHAR('.') && next == _TCHAR('.') && pos + 2 < length && text[pos + 2] == _TCHAR('.'))
+				pos += 3;
+			else
+				pos++;
+		}
+
+		token.length = pos - token.start;
+		m_tokens.Add(token);
+	}
+
+	m_end.start = min(pos, length);
+	m_end.line = line;
+	m_end.column = m_end.start - lineStart + 1;
+
+	return result;
+
+}
+
+void CHeaderLexer::Clear()
+/* ============================================================
+	Function :		CHeaderLexer::Clear
+	Description :	Removes the tokens.
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Call to free the tokens once they are
+					parsed. The text is no longer referenced.
+
+   ============================================================*/
+{
+
+	m_tokens.RemoveAll();
+	m_text = NULL;
+	m_length = 0;
+	m_errorLine = 0;
+	m_errorColumn = 0;
+
+	m_end.start = 0;
+	m_end.line = 1;
+	m_end.column = 1;
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CHeaderLexer tokens
+
+int CHeaderLexer::GetSize() const
+/* ============================================================
+	Function :		CHeaderLexer::GetSize
+	Description :	Gets the number of tokens.
+	Access :		Public
+
+	Return :		int	-	Number of tokens, not counting the
+							end token.
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	return static_cast<int>(m_tokens.GetSize());
+
+}
+
+const CHeaderToken& CHeaderLexer::GetAt(int index) const
+/* ============================================================
+	Function :		CHeaderLexer::GetAt
+	Description :	Gets a token.
+	Access :		Public
+
+	Return :		const CHeaderToken&	-	The token.
+	Parameters :	int index			-	Index of the
+											token.
+
+	Usage :			Indices past the last token give a token
+					of the type "HEADER_TOKEN_END", at the end
+					of the text, so the parser can look ahead
+					without checking the size.
+
+   ============================================================*/
+{
+
+	if (index >= 0 && index < m_tokens.GetSize())
+		return m_tokens.GetData()[index];
+
+	return m_end;
+
+}
+
+CString CHeaderLexer::GetText(int index) const
+/* ============================================================
+	Function :		CHeaderLexer::GetText
+	Description :	Gets the text of a token.
+	Access :		Public
+
+	Return :		CString		-	The text, empty for the end
+									token.
+	Parameters :	int index	-	Index of the token.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	const CHeaderToken& token = GetAt(index);
+	if (token.type == HEADER_TOKEN_END)
+		return CString();
+
+	return CString(m_text + token.start, token.length);
+
+}
+
+void CHeaderLexer::AppendText(int index, CString& text) const
+/* ============================================================
+	Function :		CHeaderLexer::AppendText
+	Description :	Adds the text of a token to a string.
+	Access :		Public
+
+	Return :		void
+	Parameters :	int index		-	Index of the token.
+					CString& text	-	String to add to.
+
+	Usage :			Used to join tokens without a temporary
+					string for each.
+
+   ============================================================*/
+{
+
+	const CHeaderToken& token = GetAt(index);
+	if (token.type != HEADER_TOKEN_END)
+		text.Append(m_text + token.start, token.length);
+
+}
+
+BOOL CHeaderLexer::IsText(int index, LPCTSTR text) const
+/* ============================================================
+	Function :		CHeaderLexer::IsText
+	Description :	Checks the text of a token.
+	Access :		Public
+
+	Return :		BOOL			-	"TRUE" if the token is
+										"text".
+	Parameters :	int index		-	Index of the token.
+					LPCTSTR text	-	Text to compare with.
+
+	Usage :			Compares in place, without making a
+					string of the token.
+
+   ============================================================*/
+{
+
+	const CHeaderToken& token = GetAt(index);
+	if (token.type == HEADER_TOKEN_END)
+		return FALSE;
+
+	LPCTSTR source = m_text + token.start;
+	int t = 0;
+	for (; t < token.length; t++)
+		if (text[t] != source[t])
+			return FALSE;
+
+	return text[t] == _TCHAR('\0');
+
+}
+
+BOOL CHeaderLexer::IsPunctuator(int index, TCHAR c) const
+/* ============================================================
+	Function :		CHeaderLexer::IsPunctuator
+	Description :	Checks if a token is a one-character
+					punctuator.
+	Access :		Public
+
+	Return :		BOOL		-	"TRUE" if the token is "c".
+	Parameters :	int index	-	Index of the token.
+					TCHAR c		-	Character to compare with.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	const CHeaderToken& token = GetAt(index);
+	return token.type == HEADER_TOKEN_PUNCTUATOR && token.length == 1 && m_text[token.start] == c;
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CHeaderLexer errors
+
+int CHeaderLexer::GetErrorLine() const
+/* ============================================================
+	Function :		CHeaderLexer::GetErrorLine
+	Description :	Gets the line of the comment that is not
+					closed.
+	Access :		Public
+
+	Return :		int	-	Line, 0 if "Tokenize" succeeded.
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	return m_errorLine;
+
+}
+
+int CHeaderLexer::GetErrorColumn() const
+/* ============================================================
+	Function :		CHeaderLexer::GetErrorColumn
+	Description :	Gets the column of the comment that is not
+					closed.
+	Access :		Public
+
+	Return :		int	-	Column, 0 if "Tokenize" succeeded.
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	return m_errorColumn;
+
+}
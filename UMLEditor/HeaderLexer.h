@@ -0,0 +1,62 @@
+#ifndef _CHEADERLEXER_H_3C8E51A7_6F2D_4B90_A4D1E72B5C093
+#define _CHEADERLEXER_H_3C8E51A7_6F2D_4B90_A4D1E72B5C093
+
+///////////////////////////////////////////////////////////
+// File :		HeaderLexer.h
+// Created :	10/19/26
+//
+
+#include <afxtempl.h>
+
+// Token types
+#define HEADER_TOKEN_END			0	// After the last token
+#define HEADER_TOKEN_IDENTIFIER		1	// Identifiers and keywords
+#define HEADER_TOKEN_NUMBER			2
+#define HEADER_TOKEN_LITERAL		3	// String and character literals
+#define HEADER_TOKEN_PUNCTUATOR		4
+
+struct CHeaderToken
+{
+	int		type;
+	int		start;		// Offset in the text
+	int		length;
+	int		line;		// Counted from 1
+	int		column;		// Counted from 1
+};
+
+class CHeaderLexer
+{
+public:
+	// Construction/destruction
+	CHeaderLexer();
+	virtual ~CHeaderLexer();
+
+	// Operations
+	BOOL	Tokenize(LPCTSTR text, int length);
+	void	Clear();
+
+	// Tokens
+	int		GetSize() const;
+	const CHeaderToken& GetAt(int index) const;
+	CString	GetText(int index) const;
+	void	AppendText(int index, CString& text) const;
+	BOOL	IsText(int index, LPCTSTR text) const;
+	BOOL	IsPunctuator(int index, TCHAR c) const;
+
+	// Errors
+	int		GetErrorLine() const;
+	int		GetErrorColumn() const;
+
+private:
+	// Data
+	LPCTSTR		m_text;
+	int			m_length;
+	CArray< CHeaderToken, CHeaderToken& > m_tokens;
+	CHeaderToken m_end;		// Returned for indices past the last token
+
+	int			m_errorLine;
+	int			m_errorColumn;
+
+};
+
+#endif //_CHEADERLEXER_H_3C8E51A7_6F2D_4B90_A4D1E72B5C093
@@ -0,0 +1,1635 @@
+/* ==========================================================================
+	File :			HeaderParser.cpp
+
+	Class :			CHeaderParser
+
+	Date :			10/19/26
+
+	Purpose :		"CHeaderParser" reads the class and struct
+					definitions of a c++ header file.
+
+	Description :	The text is split into tokens by "CHeaderLexer",
+					and the tokens are read once, from the first to
+					the last, by a recursive descent parser. Only
+					what the UML editor can show is kept - classes,
+					their base classes, attributes and member
+					functions. Everything else, such as free
+					functions, enums, typedefs and nested classes,
+					is skipped by counting brackets, without
+					looking closer.
+
+					The parser does not stop at errors. A member it
+					cannot read is skipped and reported, and a class
+					that is not closed keeps the members read so
+					far. Macros without a semicolon, such as
+					"DECLARE_MESSAGE_MAP()", are recognized as a
+					name and a parenthesis ending a statement on
+					their own line, and are ignored.
+
+	Usage :			Call "Parse", and read the classes with
+					"GetClass". The class uses no UI and no other
+					objects of the editor, and a parser can be used
+					from any thread.
+
+   ========================================================================*/
+
+#include "stdafx.h"
+#include "HeaderParser.h"
+
+#ifdef _DEBUG
+#define new DEBUG_NEW
+#undef THIS_FILE
+static char THIS_FILE[] = __FILE__;
+#endif
+
+// Words before a declaration that the parser does not keep
+static LPCTSTR s_specifiers[] = {
+	_T("inline"), _T("explicit"), _T("afx_msg"), _T("mutable"), _T("extern"),
+	_T("constexpr"), _T("consteval"), _T("constinit"), _T("register"), _T("thread_local"),
+	_T("__inline"), _T("__forceinline"), _T("__cdecl"), _T("__stdcall"), _T("__fastcall"),
+	_T("__thiscall"), _T("__vectorcall"), _T("WINAPI"), _T("CALLBACK"), _T("APIENTRY"),
+	_T("PASCAL"), _T("AFX_CDECL"), _T("STDMETHODCALLTYPE"), NULL
+};
+
+// Type keywords that can end a parameter type, so are not names
+static LPCTSTR s_typeKeywords[] = {
+	_T("int"), _T("char"), _T("short"), _T("long"), _T("float"), _T("double"),
+	_T("bool"), _T("void"), _T("signed"), _T("unsigned"), _T("wchar_t"), _T("char8_t"),
+	_T("char16_t"), _T("char32_t"), _T("__int8"), _T("__int16"), _T("__int32"), _T("__int64"),
+	_T("auto"), _T("const"), _T("volatile"), NULL
+};
+
+// Words that may follow the parameter list of a member function on the next line
+static LPCTSTR s_qualifiers[] = {
+	_T("const"), _T("volatile"), _T("override"), _T("final"), _T("noexcept"),
+	_T("throw"), _T("try"), _T("PURE"), NULL
+};
+
+static BOOL IsInList(const CHeaderLexer& lexer, int index, LPCTSTR* list)
+{
+	if (lexer.GetAt(index).type != HEADER_TOKEN_IDENTIFIER)
+		return FALSE;
+
+	for (int t = 0; list[t]; t++)
+		if (lexer.IsText(index, list[t]))
+			return TRUE;
+
+	return FALSE;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CHeaderMember and CHeaderClass
+
+CHeaderMember::CHeaderMember()
+/* ============================================================
+	Function :		CHeaderMember::CHeaderMember
+	Description :	Constructor
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	operation = FALSE;
+	access = HEADER_ACCESS_PRIVATE;
+	isStatic = FALSE;
+	isVirtual = FALSE;
+	isConst = FALSE;
+	isAbstract = FALSE;
+	line = 0;
+
+}
+
+CHeaderMember::~CHeaderMember()
+/* ============================================================
+	Function :		CHeaderMember::~CHeaderMember
+	Description :	Destructor
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Deletes the parameters.
+
+   ============================================================*/
+{
+
+	INT_PTR max = parameters.GetSize();
+	for (INT_PTR t = 0; t < max; t++)
+		delete parameters.GetAt(t);
+
+	parameters.RemoveAll();
+
+}
+
+CHeaderClass::CHeaderClass()
+/* ============================================================
+	Function :		CHeaderClass::CHeaderClass
+	Description :	Constructor
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	isStruct = FALSE;
+	line = 0;
+
+}
+
+CHeaderClass::~CHeaderClass()
+/* ============================================================
+	Function :		CHeaderClass::~CHeaderClass
+	Description :	Destructor
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Deletes the members.
+
+   ============================================================*/
+{
+
+	INT_PTR max = members.GetSize();
+	for (INT_PTR t = 0; t < max; t++)
+		delete members.GetAt(t);
+
+	members.RemoveAll();
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CHeaderParser construction/destruction
+
+CHeaderParser::CHeaderParser()
+/* ============================================================
+	Function :		CHeaderParser::CHeaderParser
+	Description :	Constructor
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	m_pos = 0;
+	m_tokens = 0;
+
+}
+
+CHeaderParser::~CHeaderParser()
+/* ============================================================
+	Function :		CHeaderParser::~CHeaderParser
+	Description :	Destructor
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	Clear();
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CHeaderParser operations
+
+BOOL CHeaderParser::Parse(LPCTSTR text, int length)
+/* ============================================================
+	Function :		CHeaderParser::Parse
+	Description :	Reads the classes of a header file.
+	Access :		Public
+
+	Return :		BOOL			-	"FALSE" if errors were
+										found.
+	Parameters :	LPCTSTR text	-	Text of the file.
+					int length		-	Length of "text".
+
+	Usage :			Replaces the classes of an earlier call.
+					The classes read are kept even if there are
+					errors. "text" is not referenced after the
+					call.
+
+   ============================================================*/
+{
+
+	Clear();
+
+	BOOL tokenized = m_lexer.Tokenize(text, length);
+	m_tokens = m_lexer.GetSize();
+	m_pos = 0;
+
+	ParseDeclarations(FALSE);
+
+	if (!tokenized)
+		AddError(HEADER_ERROR_COMMENT, m_lexer.GetErrorLine(), m_lexer.GetErrorColumn());
+
+	m_lexer.Clear();
+
+	return m_errors.GetSize() == 0;
+
+}
+
+void CHeaderParser::Clear()
+/* ============================================================
+	Function :		CHeaderParser::Clear
+	Description :	Deletes the classes and errors.
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	INT_PTR max = m_classes.GetSize();
+	for (INT_PTR t = 0; t < max; t++)
+		delete m_classes.GetAt(t);
+
+	m_classes.RemoveAll();
+	m_errors.RemoveAll();
+	m_lexer.Clear();
+	m_pos = 0;
+	m_tokens = 0;
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CHeaderParser results
+
+INT_PTR CHeaderParser::GetClassCount() const
+/* ============================================================
+	Function :		CHeaderParser::GetClassCount
+	Description :	Gets the number of classes read.
+	Access :		Public
+
+	Return :		INT_PTR	-	Number of classes.
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	return m_classes.GetSize();
+
+}
+
+CHeaderClass* CHeaderParser::GetClass(INT_PTR index) const
+/* ============================================================
+	Function :		CHeaderParser::GetClass
+	Description :	Gets a class read.
+	Access :		Public
+
+	Return :		CHeaderClass*	-	The class, or "NULL".
+	Parameters :	INT_PTR index	-	Index of the class.
+
+	Usage :			Classes are in the order of the file. The
+					parser owns the class.
+
+   ============================================================*/
+{
+
+	if (index < 0 || index >= m_classes.GetSize())
+		return NULL;
+
+	return static_cast<CHeaderClass*>(m_classes.GetAt(index));
+
+}
+
+CHeaderClass* CHeaderParser::FindClass(LPCTSTR title) const
+/* ============================================================
+	Function :		CHeaderParser::FindClass
+	Description :	Gets the class a header file is named after.
+	Access :		Public
+
+	Return :		CHeaderClass*	-	The class, or "NULL" if
+										no class was read.
+	Parameters :	LPCTSTR title	-	File name, without the
+										folder and extension.
+
+	Usage :			The class named as the file, with or without
+					a leading "C" and in any case, or the first
+					class if there is no such class.
+
+   ============================================================*/
+{
+
+	CString prefixed(_T("C"));
+	prefixed += title;
+
+	INT_PTR max = m_classes.GetSize();
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		CHeaderClass* cls = static_cast<CHeaderClass*>(m_classes.GetAt(t));
+		if (cls->name.CompareNoCase(title) == 0 || cls->name.CompareNoCase(prefixed) == 0)
+			return cls;
+	}
+
+	return GetClass(0);
+
+}
+
+INT_PTR CHeaderParser::GetErrorCount() const
+/* ============================================================
+	Function :		CHeaderParser::GetErrorCount
+	Description :	Gets the number of errors found.
+	Access :		Public
+
+	Return :		INT_PTR	-	Number of errors.
+	Parameters :	none
+
+	Usage :
+
+   ============================================================*/
+{
+
+	return m_errors.GetSize();
+
+}
+
+const CHeaderError& CHeaderParser::GetError(INT_PTR index) const
+/* ============================================================
+	Function :		CHeaderParser::GetError
+	Description :	Gets an error found.
+	Access :		Public
+
+	Return :		const CHeaderError&	-	The error.
+	Parameters :	INT_PTR index		-	Index of the
+											error.
+
+	Usage :			"index" must be less than "GetErrorCount".
+
+   ============================================================*/
+{
+
+	return m_errors.GetData()[index];
+
+}
+
+int CHeaderParser::GetTokenCount() const
+/* ============================================================
+	Function :		CHeaderParser::GetTokenCount
+	Description :	Gets the number of tokens of the last
+					parse.
+	Access :		Public
+
+	Return :		int	-	Number of tokens.
+	Parameters :	none
+
+	Usage :			For statistics.
+
+   ============================================================*/
+{
+
+	return m_tokens;
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CHeaderParser declarations
+
+void CHeaderParser::ParseDeclarations(BOOL nested)
+/* ============================================================
+	Function :		CHeaderParser::ParseDeclarations
+	Description :	Reads declarations at namespace level.
+	Access :		Private
+
+	Return :		void
+	Parameters :	BOOL nested	-	"TRUE" inside a namespace
+									or "extern" block.
+
+	Usage :			Stops at the end of the tokens, or before
+					the closing brace of a nested block.
+
+   ============================================================*/
+{
+
+	while (m_lexer.GetAt(m_pos).type != HEADER_TOKEN_END)
+	{
+		if (m_lexer.IsPunctuator(m_pos, _TCHAR('}')))
+		{
+			if (nested)
+				return;
+
+			AddError(HEADER_ERROR_BRACKET, m_pos);
+			m_pos++;
+			continue;
+		}
+
+		if (m_lexer.IsPunctuator(m_pos, _TCHAR(';')))
+		{
+			m_pos++;
+			continue;
+		}
+
+		// Blocks
+		int open = -1;
+		if (m_lexer.IsText(m_pos, _T("namespace")))
+		{
+			int t = m_pos + 1;
+			while (m_lexer.GetAt(t).type == HEADER_TOKEN_IDENTIFIER || m_lexer.IsText(t, _T("::")))
+				t++;
+			if (m_lexer.IsPunctuator(t, _TCHAR('{')))
+				open = t;
+		}
+		else if (m_lexer.IsText(m_pos, _T("extern")) && m_lexer.GetAt(m_pos + 1).type == HEADER_TOKEN_LITERAL && m_lexer.IsPunctuator(m_pos + 2, _TCHAR('{')))
+			open = m_pos + 2;
+
+		if (open != -1)
+		{
+			m_pos = open + 1;
+			ParseDeclarations(TRUE);
+			if (m_lexer.IsPunctuator(m_pos, _TCHAR('}')))
+				m_pos++;
+			else
+				AddError(HEADER_ERROR_BRACKET, open);
+			continue;
+		}
+
+		// Classes
+		CString templateParameters;
+		if (m_lexer.IsText(m_pos, _T("template")) && m_lexer.IsPunctuator(m_pos + 1, _TCHAR('<')))
+		{
+			m_pos = SkipTemplateParameters(m_pos + 1, templateParameters);
+			if (!m_lexer.IsText(m_pos, _T("class")) && !m_lexer.IsText(m_pos, _T("struct")))
+			{
+				m_pos = SkipDeclaration(m_pos);
+				continue;
+			}
+		}
+
+		if (m_lexer.IsText(m_pos, _T("class")) || m_lexer.IsText(m_pos, _T("struct")))
+			ParseClass(templateParameters);
+		else
+			m_pos = SkipDeclaration(m_pos);
+	}
+
+}
+
+void CHeaderParser::ParseClass(const CString& templateParameters)
+/* ============================================================
+	Function :		CHeaderParser::ParseClass
+	Description :	Reads a class or struct.
+	Access :		Private
+
+	Return :		void
+	Parameters :	const CString& templateParameters	-	Text
+								of the "template< >" before the
+								class, empty if none.
+
+	Usage :			"m_pos" is at "class" or "struct". A
+					forward declaration, or a class used as a
+					type, is skipped. Otherwise the class is
+					added and "m_pos" is moved after its
+					closing brace.
+
+   ============================================================*/
+{
+
+	int head = m_pos;
+	BOOL isStruct = m_lexer.IsText(head, _T("struct"));
+
+	// The name is the last identifier before the base classes or the body,
+	// after export macros, "__declspec( )" and attributes.
+	int name = -1;
+	int t = head + 1;
+	BOOL done = FALSE;
+	while (!done)
+	{
+		if (m_lexer.GetAt(t).type == HEADER_TOKEN_IDENTIFIER)
+		{
+			if (m_lexer.IsPunctuator(t + 1, _TCHAR('(')))
+			{
+				int close = MatchBracket(t + 1);
+				if (close == -1)
+					done = TRUE;
+				else
+					t = close + 1;
+			}
+			else
+			{
+				if (!m_lexer.IsText(t, _T("final")))
+					name = t;
+				t++;
+			}
+		}
+		else if (m_lexer.IsText(t, _T("::")))
+			t++;
+		else if (m_lexer.IsPunctuator(t, _TCHAR('<')) && name != -1)
+		{
+			// A specialization
+			CString arguments;
+			t = SkipTemplateParameters(t, arguments);
+		}
+		else if (m_lexer.IsPunctuator(t, _TCHAR('[')) && m_lexer.IsPunctuator(t + 1, _TCHAR('[')))
+		{
+			int close = MatchBracket(t);
+			if (close == -1)
+				done = TRUE;
+			else
+				t = close + 1;
+		}
+		else
+			done = TRUE;
+	}
+
+	if (name == -1 || !(m_lexer.IsPunctuator(t, _TCHAR(':')) || m_lexer.IsPunctuator(t, _TCHAR('{'))))
+	{
+		m_pos = SkipDeclaration(head + 1);
+		return;
+	}
+
+	CHeaderClass* cls = new CHeaderClass;
+	cls->name = m_lexer.GetText(name);
+	cls->templateParameters = templateParameters;
+	cls->isStruct = isStruct;
+	cls->line = m_lexer.GetAt(head).line;
+
+	m_pos = t;
+	if (m_lexer.IsPunctuator(m_pos, _TCHAR(':')))
+	{
+		m_pos++;
+		ParseBaseClasses(cls);
+	}
+
+	if (!m_lexer.IsPunctuator(m_pos, _TCHAR('{')))
+	{
+		AddError(HEADER_ERROR_DECLARATION, head);
+		delete cls;
+		m_pos = SkipDeclaration(m_pos);
+		return;
+	}
+
+	int open = m_pos;
+	m_pos++;
+	m_classes.Add(cls);
+	ParseClassBody(cls, open);
+
+	// Declarators after the closing brace, such as "} theObject;"
+	if (m_lexer.IsPunctuator(m_pos, _TCHAR(';')))
+		m_pos++;
+	else if (m_lexer.GetAt(m_pos).type == HEADER_TOKEN_IDENTIFIER && m_pos > 0 && m_lexer.GetAt(m_pos).line == m_lexer.GetAt(m_pos - 1).line)
+		m_pos = SkipDeclaration(m_pos);
+
+}
+
+void CHeaderParser::ParseBaseClasses(CHeaderClass* cls)
+/* ============================================================
+	Function :		CHeaderParser::ParseBaseClasses
+	Description :	Reads the base classes of a class.
+	Access :		Private
+
+	Return :		void
+	Parameters :	CHeaderClass* cls	-	Class to add the base
+											classes to.
+
+	Usage :			"m_pos" is after the colon, and is moved to
+					the opening brace of the class.
+
+   ============================================================*/
+{
+
+	BOOL more = TRUE;
+	while (more)
+	{
+		CString access = cls->isStruct ? _T("public") : _T("private");
+		while (m_lexer.IsText(m_pos, _T("virtual")) || IsAccess(m_pos))
+		{
+			if (IsAccess(m_pos))
+				access = m_lexer.GetText(m_pos);
+			m_pos++;
+		}
+
+		int first = m_pos;
+		int depth = 0;
+		BOOL done = FALSE;
+		while (!done)
+		{
+			const CHeaderToken& token = m_lexer.GetAt(m_pos);
+			if (token.type == HEADER_TOKEN_END)
+				done = TRUE;
+			else if (depth == 0 && (m_lexer.IsPunctuator(m_pos, _TCHAR(',')) || m_lexer.IsPunctuator(m_pos, _TCHAR('{')) || m_lexer.IsPunctuator(m_pos, _TCHAR(';'))))
+				done = TRUE;
+			else
+			{
+				if (m_lexer.IsPunctuator(m_pos, _TCHAR('<')) || m_lexer.IsPunctuator(m_pos, _TCHAR('(')))
+					depth++;
+				else if ((m_lexer.IsPunctuator(m_pos, _TCHAR('>')) || m_lexer.IsPunctuator(m_pos, _TCHAR(')'))) && depth > 0)
+					depth--;
+				m_pos++;
+			}
+		}
+
+		if (m_pos > first)
+		{
+			// "CArray<T, const T&>" is kept as "CArray<T,const T&>"
+			CString base = JoinTokens(first, m_pos);
+			base.Replace(_T(", "), _T(","));
+			cls->baseClasses.Add(base);
+			cls->baseAccess.Add(access);
+		}
+
+		more = m_lexer.IsPunctuator(m_pos, _TCHAR(','));
+		if (more)
+			m_pos++;
+	}
+
+}
+
+void CHeaderParser::ParseClassBody(CHeaderClass* cls, int open)
+/* ============================================================
+	Function :		CHeaderParser::ParseClassBody
+	Description :	Reads the members of a class.
+	Access :		Private
+
+	Return :		void
+	Parameters :	CHeaderClass* cls	-	Class to add the
+											members to.
+					int open			-	Opening brace of the
+											class.
+
+	Usage :			"m_pos" is after the opening brace, and is
+					moved after the closing brace.
+
+   ============================================================*/
+{
+
+	int access = cls->isStruct ? HEADER_ACCESS_PUBLIC : HEADER_ACCESS_PRIVATE;
+	while (TRUE)
+	{
+		if (m_lexer.GetAt(m_pos).type == HEADER_TOKEN_END)
+		{
+			AddError(HEADER_ERROR_BRACKET, open);
+			return;
+		}
+
+		if (m_lexer.IsPunctuator(m_pos, _TCHAR('}')))
+		{
+			m_pos++;
+			return;
+		}
+
+		if (m_lexer.IsPunctuator(m_pos, _TCHAR(';')))
+		{
+			m_pos++;
+			continue;
+		}
+
+		// Access specifiers, also "public slots:", and other labels
+		if (IsAccess(m_pos))
+		{
+			int t = m_pos + 1;
+			while (m_lexer.GetAt(t).type == HEADER_TOKEN_IDENTIFIER)
+				t++;
+			if (m_lexer.IsPunctuator(t, _TCHAR(':')))
+			{
+				if (m_lexer.IsText(m_pos, _T("public")))
+					access = HEADER_ACCESS_PUBLIC;
+				else if (m_lexer.IsText(m_pos, _T("protected")))
+					access = HEADER_ACCESS_PROTECTED;
+				else
+					access = HEADER_ACCESS_PRIVATE;
+				m_pos = t + 1;
+				continue;
+			}
+		}
+
+		if (m_lexer.GetAt(m_pos).type == HEADER_TOKEN_IDENTIFIER && m_lexer.IsPunctuator(m_pos + 1, _TCHAR(':')))
+		{
+			m_pos += 2;
+			continue;
+		}
+
+		// Nested types include their braces in the statement
+		int start = m_pos;
+		if (m_lexer.IsText(start, _T("template")) && m_lexer.IsPunctuator(start + 1, _TCHAR('<')))
+		{
+			CString parameters;
+			start = SkipTemplateParameters(start + 1, parameters);
+		}
+
+		BOOL braces = m_lexer.IsText(start, _T("class")) || m_lexer.IsText(start, _T("struct")) ||
+			m_lexer.IsText(start, _T("union")) || m_lexer.IsText(start, _T("enum")) ||
+			m_lexer.IsText(start, _T("typedef"));
+
+		int end = FindStatementEnd(m_pos, braces);
+		if (m_lexer.IsPunctuator(end, _TCHAR('{')))
+		{
+			// An inline function body, or a brace initializer
+			ParseMember(cls, m_pos, end, access);
+			int close = MatchBracket(end);
+			m_pos = (close == -1) ? m_lexer.GetSize() : close + 1;
+			if (m_lexer.IsPunctuator(m_pos, _TCHAR(';')))
+				m_pos++;
+		}
+		else if (m_lexer.IsPunctuator(end, _TCHAR(';')))
+		{
+			ParseMember(cls, m_pos, end, access);
+			m_pos = end + 1;
+		}
+		else
+		{
+			// A macro without a semicolon, or a member missing one
+			m_pos = (end > m_pos) ? end : m_pos + 1;
+		}
+	}
+
+}
+
+void CHeaderParser::ParseMember(CHeaderClass* cls, int first, int last, int access)
+/* ============================================================
+	Function :		CHeaderParser::ParseMember
+	Description :	Reads a member declaration.
+	Access :		Private
+
+	Return :		void
+	Parameters :	CHeaderClass* cls	-	Class to add the
+											member to.
+					int first			-	First token.
+					int last			-	Token after the
+											declaration, the
+											semicolon or the
+											function body.
+					int access			-	Access of the member.
+
+	Usage :			Friends, typedefs, nested types and macros
+					are ignored.
+
+   ============================================================*/
+{
+
+	int t = first;
+	if (m_lexer.IsText(t, _T("template")) && m_lexer.IsPunctuator(t + 1, _TCHAR('<')))
+	{
+		CString parameters;
+		t = SkipTemplateParameters(t + 1, parameters);
+	}
+
+	if (t >= last ||
+		m_lexer.IsText(t, _T("friend")) || m_lexer.IsText(t, _T("typedef")) || m_lexer.IsText(t, _T("using")) ||
+		m_lexer.IsText(t, _T("enum")) || m_lexer.IsText(t, _T("static_assert")) || m_lexer.IsText(t, _T("class")) ||
+		m_lexer.IsText(t, _T("struct")) || m_lexer.IsText(t, _T("union")))
+		return;
+
+	BOOL isStatic = FALSE;
+	BOOL isVirtual = FALSE;
+	BOOL done = FALSE;
+	while (t < last && !done)
+	{
+		if (m_lexer.IsText(t, _T("static")))
+		{
+			isStatic = TRUE;
+			t++;
+		}
+		else if (m_lexer.IsText(t, _T("virtual")))
+		{
+			isVirtual = TRUE;
+			t++;
+		}
+		else if (IsSpecifier(t))
+			t++;
+		else if ((m_lexer.IsText(t, _T("__declspec")) || m_lexer.IsText(t, _T("alignas"))) && m_lexer.IsPunctuator(t + 1, _TCHAR('(')))
+		{
+			int close = MatchBracket(t + 1);
+			t = (close == -1 || close >= last) ? last : close + 1;
+		}
+		else if (m_lexer.IsPunctuator(t, _TCHAR('[')) && m_lexer.IsPunctuator(t + 1, _TCHAR('[')))
+		{
+			int close = MatchBracket(t);
+			t = (close == -1 || close >= last) ? last : close + 1;
+		}
+		else
+			done = TRUE;
+	}
+
+	if (t >= last)
+		return;
+
+	// A member function has a parenthesis before any initializer
+	int paren = -1;
+	int angle = 0;
+	done = FALSE;
+	for (int i = t; i < last && !done; i++)
+	{
+		if (m_lexer.IsText(i, _T("operator")))
+		{
+			// The operator itself may be a parenthesis or a bracket
+			if (m_lexer.IsPunctuator(i + 1, _TCHAR('(')) && m_lexer.IsPunctuator(i + 2, _TCHAR(')')))
+				i += 2;
+			else
+				while (i + 1 < last && !m_lexer.IsPunctuator(i + 1, _TCHAR('(')))
+					i++;
+		}
+		else if (m_lexer.IsPunctuator(i, _TCHAR('<')) && i > t && m_lexer.GetAt(i - 1).type == HEADER_TOKEN_IDENTIFIER)
+			angle++;
+		else if (m_lexer.IsPunctuator(i, _TCHAR('>')) && angle > 0)
+			angle--;
+		else if (angle == 0)
+		{
+			if (m_lexer.IsPunctuator(i, _TCHAR('(')))
+			{
+				paren = i;
+				done = TRUE;
+			}
+			else if (m_lexer.IsPunctuator(i, _TCHAR('=')) || m_lexer.IsPunctuator(i, _TCHAR('[')) ||
+				m_lexer.IsPunctuator(i, _TCHAR('{')) || m_lexer.IsPunctuator(i, _TCHAR(':')))
+				done = TRUE;
+		}
+	}
+
+	// A pointer to a function is an attribute, with the name inside the parenthesis
+	if (paren != -1 && paren > t &&
+		(m_lexer.IsPunctuator(paren + 1, _TCHAR('*')) || m_lexer.IsPunctuator(paren + 1, _TCHAR('&'))) &&
+		!m_lexer.IsText(paren - 1, _T("operator")))
+	{
+		int close = MatchBracket(paren);
+		int name = (close == -1 || close >= last) ? -1 : FindName(paren + 1, close);
+		if (name == -1)
+		{
+			AddError(HEADER_ERROR_DECLARATION, first);
+			return;
+		}
+
+		CHeaderMember* member = new CHeaderMember;
+		member->access = access;
+		member->isStatic = isStatic;
+		member->line = m_lexer.GetAt(first).line;
+		member->name = m_lexer.GetText(name);
+		member->type = JoinTokens(t, paren) + _T("(*)") + JoinTokens(close + 1, last);
+		cls->members.Add(member);
+		return;
+	}
+
+	if (paren == -1)
+	{
+		ParseAttributes(cls, t, last, access, isStatic);
+		return;
+	}
+
+	CHeaderMember* member = new CHeaderMember;
+	member->operation = TRUE;
+	member->access = access;
+	member->isStatic = isStatic;
+	member->isVirtual = isVirtual;
+	member->line = m_lexer.GetAt(first).line;
+	ParseOperation(member, t, paren, last);
+
+	if (member->name.IsEmpty())
+	{
+		AddError(HEADER_ERROR_DECLARATION, first);
+		delete member;
+	}
+	else if (member->type.IsEmpty() && member->name != cls->name &&
+		member->name[0] != _TCHAR('~') && member->name.Left(8) != _T("operator"))
+	{
+		// A macro, such as "DECLARE_DYNCREATE(CMyClass);"
+		delete member;
+	}
+	else
+	{
+		if (member->type == _T("void"))
+			member->type.Empty();
+		cls->members.Add(member);
+	}
+
+}
+
+void CHeaderParser::ParseOperation(CHeaderMember* member, int first, int open, int last)
+/* ============================================================
+	Function :		CHeaderParser::ParseOperation
+	Description :	Reads a member function declaration.
+	Access :		Private
+
+	Return :		void
+	Parameters :	CHeaderMember* member	-	Member to fill.
+					int first				-	First token after
+												the specifiers.
+					int open				-	Parenthesis of the
+												parameter list.
+					int last				-	Token after the
+												declaration.
+
+	Usage :			"member->name" is left empty if the
+					declaration cannot be read. "void" is
+					kept as the type, so the caller can tell
+					it from a missing type.
+
+   ============================================================*/
+{
+
+	int close = MatchBracket(open);
+	if (close == -1 || close >= last)
+		return;
+
+	// The name, with operators and destructors
+	int name = open - 1;
+	for (int i = first; i < open; i++)
+	{
+		if (m_lexer.IsText(i, _T("operator")))
+		{
+			name = i;
+			break;
+		}
+	}
+
+	if (name == open - 1)
+	{
+		if (name < first || m_lexer.GetAt(name).type != HEADER_TOKEN_IDENTIFIER)
+			return;
+		if (name > first && m_lexer.IsPunctuator(name - 1, _TCHAR('~')))
+			name--;
+	}
+
+	// "CMyClass::" before the name is not part of the type
+	int typeEnd = name;
+	while (typeEnd - 2 >= first && m_lexer.IsText(typeEnd - 1, _T("::")) && m_lexer.GetAt(typeEnd - 2).type == HEADER_TOKEN_IDENTIFIER)
+		typeEnd -= 2;
+
+	member->name = JoinTokens(name, open);
+	member->type = JoinTokens(first, typeEnd);
+
+	// Parameters, split at commas outside brackets
+	int start = open + 1;
+	int depth = 0;
+	int angle = 0;
+	BOOL defaultValue = FALSE;
+	for (int i = open + 1; i <= close; i++)
+	{
+		if (i == close || (depth == 0 && angle == 0 && m_lexer.IsPunctuator(i, _TCHAR(','))))
+		{
+			if (i > start && !(start == open + 1 && i == close && i - start == 1 && m_lexer.IsText(start, _T("void"))))
+				ParseParameter(member, start, i);
+			start = i + 1;
+			defaultValue = FALSE;
+		}
+		else if (m_lexer.IsPunctuator(i, _TCHAR('(')) || m_lexer.IsPunctuator(i, _TCHAR('[')) || m_lexer.IsPunctuator(i, _TCHAR('{')))
+			depth++;
+		else if (m_lexer.IsPunctuator(i, _TCHAR(')')) || m_lexer.IsPunctuator(i, _TCHAR(']')) || m_lexer.IsPunctuator(i, _TCHAR('}')))
+			depth--;
+		else if (m_lexer.IsPunctuator(i, _TCHAR('=')) && depth == 0 && angle == 0)
+			defaultValue = TRUE;
+		else if (!defaultValue && m_lexer.IsPunctuator(i, _TCHAR('<')) && m_lexer.GetAt(i - 1).type == HEADER_TOKEN_IDENTIFIER)
+			angle++;
+		else if (!defaultValue && m_lexer.IsPunctuator(i, _TCHAR('>')) && angle > 0)
+			angle--;
+	}
+
+	// Qualifiers after the parameters
+	BOOL done = FALSE;
+	for (int i = close + 1; i < last && !done; i++)
+	{
+		if (m_lexer.IsText(i, _T("const")))
+			member->isConst = TRUE;
+		else if (m_lexer.IsText(i, _T("override")) || m_lexer.IsText(i, _T("final")))
+			member->isVirtual = TRUE;
+		else if (m_lexer.IsText(i, _T("PURE")))
+			member->isAbstract = TRUE;
+		else if (m_lexer.IsPunctuator(i, _TCHAR('=')))
+		{
+			member->isAbstract = m_lexer.IsText(i + 1, _T("0"));
+			done = TRUE;
+		}
+		else if (m_lexer.IsPunctuator(i, _TCHAR(':')))
+			done = TRUE;	// Initializers of a constructor
+		else if ((m_lexer.IsText(i, _T("noexcept")) || m_lexer.IsText(i, _T("throw"))) && m_lexer.IsPunctuator(i + 1, _TCHAR('(')))
+		{
+			int end = MatchBracket(i + 1);
+			if (end == -1 || end >= last)
+				done = TRUE;
+			else
+				i = end;
+		}
+		else if (m_lexer.IsText(i, _T("->")))
+		{
+			// A trailing return type
+			int end = i + 1;
+			while (end < last && !m_lexer.IsPunctuator(end, _TCHAR('=')) && !m_lexer.IsText(end, _T("override")) &&
+				!m_lexer.IsText(end, _T("final")) && !m_lexer.IsPunctuator(end, _TCHAR(':')))
+				end++;
+			member->type = JoinTokens(i + 1, end);
+			i = end - 1;
+		}
+	}
+
+	if (member->isAbstract)
+		member->isVirtual = TRUE;
+
+}
+
+void CHeaderParser::ParseAttributes(CHeaderClass* cls, int first, int last, int access, BOOL isStatic)
+/* ============================================================
+	Function :		CHeaderParser::ParseAttributes
+	Description :	Reads an attribute declaration.
+	Access :		Private
+
+	Return :		void
+	Parameters :	CHeaderClass* cls	-	Class to add the
+											attributes to.
+					int first			-	First token after
+											the specifiers.
+					int last			-	Token after the
+											declaration.
+					int access			-	Access of the
+											attributes.
+					BOOL isStatic		-	"TRUE" if "static".
+
+	Usage :			Several names may share a type, as in
+					"int m_x, *m_y;". Each becomes an
+					attribute.
+
+   ============================================================*/
+{
+
+	CString baseType;
+	int start = first;
+	int depth = 0;
+	int angle = 0;
+	BOOL initializer = FALSE;
+	for (int i = first; i <= last; i++)
+	{
+		if (i == last || (depth == 0 && angle == 0 && m_lexer.IsPunctuator(i, _TCHAR(','))))
+		{
+			int name = FindName(start, i);
+			if (name == -1 || (start == first && name == first))
+			{
+				// A single word is a macro
+				if (i - first > 1)
+					AddError(HEADER_ERROR_DECLARATION, first);
+				return;
+			}
+
+			CHeaderMember* member = new CHeaderMember;
+			member->access = access;
+			member->isStatic = isStatic;
+			member->line = m_lexer.GetAt(first).line;
+			member->name = m_lexer.GetText(name);
+
+			if (start == first)
+			{
+				// "*" and "&" belong to the first name only
+				member->type = JoinTokens(first, name);
+				int end = name;
+				while (end > first && (m_lexer.IsPunctuator(end - 1, _TCHAR('*')) || m_lexer.IsPunctuator(end - 1, _TCHAR('&'))))
+					end--;
+				baseType = JoinTokens(first, end);
+			}
+			else
+			{
+				member->type = baseType;
+				CString pointers = JoinTokens(start, name);
+				if (pointers.GetLength())
+					member->type += pointers;
+			}
+
+			int t = name + 1;
+			if (m_lexer.IsPunctuator(t, _TCHAR('[')))
+			{
+				int close = MatchBracket(t);
+				if (close != -1 && close < i)
+				{
+					member->multiplicity = JoinTokens(t + 1, close);
+					t = close + 1;
+					while (m_lexer.IsPunctuator(t, _TCHAR('[')))
+					{
+						// Further dimensions stay with the type
+						close = MatchBracket(t);
+						if (close == -1 || close >= i)
+							break;
+						member->type += JoinTokens(t, close + 1);
+						t = close + 1;
+					}
+				}
+			}
+
+			if (m_lexer.IsPunctuator(t, _TCHAR('=')))
+				member->defaultvalue = JoinTokens(t + 1, i);
+			else if (m_lexer.IsPunctuator(t, _TCHAR('{')))
+			{
+				int close = MatchBracket(t);
+				if (close != -1 && close < i)
+					member->defaultvalue = JoinTokens(t + 1, close);
+			}
+
+			cls->members.Add(member);
+			start = i + 1;
+			initializer = FALSE;
+		}
+		else if (m_lexer.IsPunctuator(i, _TCHAR('(')) || m_lexer.IsPunctuator(i, _TCHAR('[')) || m_lexer.IsPunctuator(i, _TCHAR('{')))
+			depth++;
+		else if (m_lexer.IsPunctuator(i, _TCHAR(')')) || m_lexer.IsPunctuator(i, _TCHAR(']')) || m_lexer.IsPunctuator(i, _TCHAR('}')))
+			depth--;
+		else if (m_lexer.IsPunctuator(i, _TCHAR('=')) && depth == 0 && angle == 0)
+			initializer = TRUE;
+		else if (!initializer && m_lexer.IsPunctuator(i, _TCHAR('<')) && i > first && m_lexer.GetAt(i - 1).type == HEADER_TOKEN_IDENTIFIER)
+			angle++;
+		else if (!initializer && m_lexer.IsPunctuator(i, _TCHAR('>')) && angle > 0)
+			angle--;
+	}
+
+}
+
+void CHeaderParser::ParseParameter(CHeaderMember* member, int first, int last)
+/* ============================================================
+	Function :		CHeaderParser::ParseParameter
+	Description :	Reads a parameter of a member function.
+	Access :		Private
+
+	Return :		void
+	Parameters :	CHeaderMember* member	-	Member to add
+												the parameter to.
+					int first				-	First token.
+					int last				-	Token after the
+												parameter.
+
+	Usage :			The name is the last word before the
+					default value, unless it is a type keyword,
+					or all the words before it are qualifiers.
+
+   ============================================================*/
+{
+
+	CHeaderParameter* parameter = new CHeaderParameter;
+
+	// The default value
+	int end = last;
+	int depth = 0;
+	int angle = 0;
+	for (int i = first; i < last; i++)
+	{
+		if (m_lexer.IsPunctuator(i, _TCHAR('(')) || m_lexer.IsPunctuator(i, _TCHAR('[')))
+			depth++;
+		else if (m_lexer.IsPunctuator(i, _TCHAR(')')) || m_lexer.IsPunctuator(i, _TCHAR(']')))
+			depth--;
+		else if (m_lexer.IsPunctuator(i, _TCHAR('<')) && i > first && m_lexer.GetAt(i - 1).type == HEADER_TOKEN_IDENTIFIER)
+			angle++;
+		else if (m_lexer.IsPunctuator(i, _TCHAR('>')) && angle > 0)
+			angle--;
+		else if (depth == 0 && angle == 0 && m_lexer.IsPunctuator(i, _TCHAR('=')))
+		{
+			parameter->defaultvalue = JoinTokens(i + 1, last);
+			end = i;
+			break;
+		}
+	}
+
+	// Array brackets after the name stay with the type
+	int arrayStart = end;
+	int t = end - 1;
+	while (t > first && m_lexer.IsPunctuator(t, _TCHAR(']')))
+	{
+		int bracket = t - 1;
+		while (bracket >= first && !m_lexer.IsPunctuator(bracket, _TCHAR('[')))
+			bracket--;
+		if (bracket < first)
+			break;
+		arrayStart = bracket;
+		t = bracket - 1;
+	}
+
+	int name = -1;
+	if (t > first && m_lexer.GetAt(t).type == HEADER_TOKEN_IDENTIFIER && !IsInList(m_lexer, t, s_typeKeywords) && !m_lexer.IsText(t - 1, _T("::")))
+	{
+		// In "const CString" the last word is the type
+		for (int i = first; i < t && name == -1; i++)
+			if (!(m_lexer.IsText(i, _T("const")) || m_lexer.IsText(i, _T("volatile")) || m_lexer.IsText(i, _T("struct")) ||
+				m_lexer.IsText(i, _T("class")) || m_lexer.IsText(i, _T("enum")) || m_lexer.IsText(i, _T("typename"))))
+				name = t;
+	}
+
+	if (name != -1)
+	{
+		parameter->name = m_lexer.GetText(name);
+		parameter->type = JoinTokens(first, name) + JoinTokens(arrayStart, end);
+	}
+	else
+		parameter->type = JoinTokens(first, end);
+
+	member->parameters.Add(parameter);
+
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CHeaderParser helpers
+
+int CHeaderParser::FindStatementEnd(int first, BOOL braces) const
+/* ============================================================
+	Function :		CHeaderParser::FindStatementEnd
+	Description :	Finds the end of a statement in a class.
+	Access :		Private
+
+	Return :		int			-	The semicolon, the opening
+									brace of a body, the closing
+									brace of the class, or where
+									a statement without a
+									semicolon ends.
+	Parameters :	int first	-	First token of the
+									statement.
+					BOOL braces	-	"TRUE" if braces are part of
+									the statement, as for nested
+									types.
+
+	Usage :			A statement without a semicolon is a
+					macro, "NAME( )", followed by a word on a
+					later line, or an access specifier. A
+					semicolon inside parentheses still ends the
+					statement, so a parenthesis that is not
+					closed only loses its own member.
+
+   ============================================================*/
+{
+
+	BOOL macro = m_lexer.GetAt(first).type == HEADER_TOKEN_IDENTIFIER && m_lexer.IsPunctuator(first + 1, _TCHAR('('));
+	int macroEnd = -1;
+	int depth = 0;
+	int t = first;
+	while (TRUE)
+	{
+		const CHeaderToken& token = m_lexer.GetAt(t);
+		if (token.type == HEADER_TOKEN_END)
+			return t;
+
+		if (t == macroEnd + 1 && macroEnd != -1 && token.line != m_lexer.GetAt(macroEnd).line &&
+			(token.type == HEADER_TOKEN_IDENTIFIER || m_lexer.IsPunctuator(t, _TCHAR('~'))) &&
+			!IsInList(m_lexer, t, s_qualifiers))
+			return t;
+
+		if (depth == 0 && t > first && IsAccess(t))
+		{
+			int label = t + 1;
+			while (m_lexer.GetAt(label).type == HEADER_TOKEN_IDENTIFIER)
+				label++;
+			if (m_lexer.IsPunctuator(label, _TCHAR(':')))
+				return t;
+		}
+
+		if (m_lexer.IsPunctuator(t, _TCHAR('(')) || m_lexer.IsPunctuator(t, _TCHAR('[')))
+			depth++;
+		else if (m_lexer.IsPunctuator(t, _TCHAR(')')) || m_lexer.IsPunctuator(t, _TCHAR(']')))
+		{
+			if (depth > 0)
+				depth--;
+			if (depth == 0 && macro && macroEnd == -1)
+				macroEnd = t;
+		}
+		else if (m_lexer.IsPunctuator(t, _TCHAR('{')))
+		{
+			if (depth == 0 && !braces)
+				return t;
+
+			int close = MatchBracket(t);
+			if (close == -1)
+				return m_lexer.GetSize();
+			t = close;
+		}
+		else if (m_lexer.IsPunctuator(t, _TCHAR('}')))
+			return t;
+		else if (m_lexer.IsPunctuator(t, _TCHAR(';')))
+			return t;
+
+		t++;
+	}
+
+}
+
+int CHeaderParser::SkipDeclaration(int first) const
+/* ============================================================
+	Function :		CHeaderParser::SkipDeclaration
+	Description :	Skips a declaration at namespace level.
+	Access :		Private
+
+	Return :		int			-	Token after the declaration.
+	Parameters :	int first	-	First token of the
+									declaration.
+
+	Usage :			A declaration ends with a semicolon, or
+					with a body not followed by declarators.
+					It also ends before a closing brace, and
+					before a class, namespace or template
+					following a macro without a semicolon.
+
+   ============================================================*/
+{
+
+	int depth = 0;
+	int t = first;
+	while (TRUE)
+	{
+		const CHeaderToken& token = m_lexer.GetAt(t);
+		if (token.type == HEADER_TOKEN_END)
+			return t;
+
+		if (depth == 0 && t > first &&
+			(m_lexer.IsText(t, _T("class")) || m_lexer.IsText(t, _T("struct")) || m_lexer.IsText(t, _T("namespace")) || m_lexer.IsText(t, _T("template"))) &&
+			!m_lexer.IsText(t - 1, _T("enum")) && !m_lexer.IsText(t - 1, _T("friend")) && !m_lexer.IsPunctuator(t - 1, _TCHAR('<')) &&
+			!m_lexer.IsPunctuator(t - 1, _TCHAR(',')) && !m_lexer.IsText(t - 1, _T("typedef")) && !m_lexer.IsText(t - 1, _T("extern")))
+			return t;
+
+		if (m_lexer.IsPunctuator(t, _TCHAR('(')) || m_lexer.IsPunctuator(t, _TCHAR('[')))
+			depth++;
+		else if (m_lexer.IsPunctuator(t, _TCHAR(')')) || m_lexer.IsPunctuator(t, _TCHAR(']')))
+		{
+			if (depth > 0)
+				depth--;
+		}
+		else if (m_lexer.IsPunctuator(t, _TCHAR('{')))
+		{
+			int close = MatchBracket(t);
+			if (close == -1)
+				return m_lexer.GetSize();
+
+			t = close + 1;
+			if (depth > 0)
+				continue;
+
+			// "} name;" continues the declaration, a function body ends it
+			if (m_lexer.IsPunctuator(t, _TCHAR(';')))
+				return t + 1;
+			if (!(m_lexer.IsPunctuator(t, _TCHAR(',')) || m_lexer.IsPunctuator(t, _TCHAR('=')) ||
+				(m_lexer.GetAt(t).type == HEADER_TOKEN_IDENTIFIER && m_lexer.GetAt(t).line == m_lexer.GetAt(close).line)))
+				return t;
+			continue;
+		}
+		else if (m_lexer.IsPunctuator(t, _TCHAR('}')))
+			return t;
+		else if (m_lexer.IsPunctuator(t, _TCHAR(';')) && depth == 0)
+			return t + 1;
+
+		t++;
+	}
+
+}
+
+int CHeaderParser::SkipTemplateParameters(int first, CString& parameters) const
+/* ============================================================
+	Function :		CHeaderParser::SkipTemplateParameters
+	Description :	Skips a list in angle brackets.
+	Access :		Private
+
+	Return :		int					-	Token after the
+											closing bracket.
+	Parameters :	int first			-	The opening bracket.
+					CString& parameters	-	Set to the text
+											between the brackets.
+
+	Usage :			Brackets inside parentheses, as in
+					"template< int N = (1 > 0) >", are not
+					counted.
+
+   ============================================================*/
+{
+
+	int angle = 0;
+	int depth = 0;
+	int t = first;
+	while (m_lexer.GetAt(t).type != HEADER_TOKEN_END)
+	{
+		if (m_lexer.IsPunctuator(t, _TCHAR('(')) || m_lexer.IsPunctuator(t, _TCHAR('[')))
+			depth++;
+		else if ((m_lexer.IsPunctuator(t, _TCHAR(')')) || m_lexer.IsPunctuator(t, _TCHAR(']'))) && depth > 0)
+			depth--;
+		else if (depth == 0 && m_lexer.IsPunctuator(t, _TCHAR('<')))
+			angle++;
+		else if (depth == 0 && m_lexer.IsPunctuator(t, _TCHAR('>')))
+		{
+			angle--;
+			if (angle == 0)
+			{
+				parameters = JoinTokens(first + 1, t);
+				return t + 1;
+			}
+		}
+		else if (m_lexer.IsPunctuator(t, _TCHAR('{')) || m_lexer.IsPunctuator(t, _TCHAR(';')))
+			break;	// Not a template list
+
+		t++;
+	}
+
+	parameters.Empty();
+	return t;
+
+}
+
+int CHeaderParser::MatchBracket(int open) const
+/* ============================================================
+	Function :		CHeaderParser::MatchBracket
+	Description :	Finds the closing bracket of a parenthesis,
+					bracket or brace.
+	Access :		Private
+
+	Return :		int			-	The closing bracket, or -1
+									if it is missing.
+	Parameters :	int open	-	The opening bracket.
+
+	Usage :			All three kinds of brackets are counted
+					together, so a wrong closing bracket ends
+					the search at its level.
+
+   ============================================================*/
+{
+
+	int depth = 0;
+	int t = open;
+	while (m_lexer.GetAt(t).type != HEADER_TOKEN_END)
+	{
+		if (m_lexer.IsPunctuator(t, _TCHAR('(')) || m_lexer.IsPunctuator(t, _TCHAR('[')) || m_lexer.IsPunctuator(t, _TCHAR('{')))
+			depth++;
+		else if (m_lexer.IsPunctuator(t, _TCHAR(')')) || m_lexer.IsPunctuator(t, _TCHAR(']')) || m_lexer.IsPunctuator(t, _TCHAR('}')))
+		{
+			depth--;
+			if (depth == 0)
+				return t;
+		}
+
+		t++;
+	}
+
+	return -1;
+
+}
+
+int CHeaderParser::FindName(int first, int last) const
+/* ============================================================
+	Function :		CHeaderParser::FindName
+	Description :	Finds the name in a declarator.
+	Access :		Private
+
+	Return :		int			-	The name, or -1.
+	Parameters :	int first	-	First token.
+					int last	-	Token after the declarator.
+
+	Usage :			The name is the last word outside angle
+					brackets before an initializer, an array
+					size or a bit-field width.
+
+   ============================================================*/
+{
+
+	int name = -1;
+	int angle = 0;
+	for (int t = first; t < last; t++)
+	{
+		if (m_lexer.IsPunctuator(t, _TCHAR('<')) && t > first && m_lexer.GetAt(t - 1).type == HEADER_TOKEN_IDENTIFIER)
+			angle++;
+		else if (m_lexer.IsPunctuator(t, _TCHAR('>')) && angle > 0)
+			angle--;
+		else if (angle == 0)
+		{
+			if (m_lexer.IsPunctuator(t, _TCHAR('=')) || m_lexer.IsPunctuator(t, _TCHAR('[')) ||
+				m_lexer.IsPunctuator(t, _TCHAR(':')) || m_lexer.IsPunctuator(t, _TCHAR('{')) ||
+				m_lexer.IsPunctuator(t, _TCHAR('(')))
+				return name;
+			if (m_lexer.GetAt(t).type == HEADER_TOKEN_IDENTIFIER)
+				name = t;
+		}
+	}
+
+	return name;
+
+}
+
+BOOL CHeaderParser::IsSpecifier(int index) const
+/* ============================================================
+	Function :		CHeaderParser::IsSpecifier
+	Description :	Checks if a token is a specifier the
+					parser skips.
+	Access :		Private
+
+	Return :		BOOL		-	"TRUE" if skipped.
+	Parameters :	int index	-	Token to check.
+
+	Usage :			Such as "inline", "afx_msg" and calling
+					conventions.
+
+   ============================================================*/
+{
+
+	return IsInList(m_lexer, index, s_specifiers);
+
+}
+
+BOOL CHeaderParser::IsAccess(int index) const
+/* ============================================================
+	Function :		CHeaderParser::IsAccess
+	Description :	Checks if a token is an access keyword.
+	Access :		Private
+
+	Return :		BOOL		-	"TRUE" if "public",
+									"protected" or "private".
+	Parameters :	int index	-	Token to check.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	return m_lexer.IsText(index, _T("public")) || m_lexer.IsText(index, _T("protected")) || m_lexer.IsText(index, _T("private"));
+
+}
+
+CString CHeaderParser::JoinTokens(int first, int last) const
+/* ============================================================
+	Function :		CHeaderParser::JoinTokens
+	Description :	Makes a string of a range of tokens.
+	Access :		Private
+
+	Return :		CString		-	The tokens.
+	Parameters :	int first	-	First token.
+					int last	-	Token after the range.
+
+	Usage :			Spaces are put between words, after commas,
+					and before a word after "*", "&" or ">",
+					so "CArray<int,int>  *p" becomes
+					"CArray<int, int>* p".
+
+   ============================================================*/
+{
+
+	CString result;
+	BOOL previousWord = FALSE;
+	TCHAR previous = _TCHAR('\0');
+	for (int t = first; t < last; t++)
+	{
+		const CHeaderToken& token = m_lexer.GetAt(t);
+		if (token.type == HEADER_TOKEN_END)
+			break;
+
+		BOOL word = token.type != HEADER_TOKEN_PUNCTUATOR;
+		if (t > first)
+		{
+			if ((word && previousWord) || previous == _TCHAR(',') ||
+				(word && (previous == _TCHAR('*') || previous == _TCHAR('&') || previous == _TCHAR('>'))))
+				result += _TCHAR(' ');
+		}
+
+		int length = result.GetLength();
+		m_lexer.AppendText(t, result);
+		previousWord = word;
+		previous = (!word && token.length == 1) ? result[length] : _TCHAR('\0');
+	}
+
+	return result;
+
+}
+
+void CHeaderParser::AddError(int code, int token)
+/* ============================================================
+	Function :		CHeaderParser::AddError
+	Description :	Adds an error at a token.
+	Access :		Private
+
+	Return :		void
+	Parameters :	int code	-	"HEADER_ERROR_BRACKET" etc.
+					int token	-	Token of the error.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	const CHeaderToken& position = m_lexer.GetAt(token);
+	AddError(code, position.line, position.column);
+
+}
+
+void CHeaderParser::AddError(int code, int line, int column)
+/* ============================================================
+	Function :		CHeaderParser::AddError
+	Description :	Adds an error at a position.
+	Access :		Private
+
+	Return :		void
+	Parameters :	int code	-	"HEADER_ERROR_BRACKET" etc.
+					int line	-	Line of the error.
+					int column	-	Column of the error.
+
+	Usage :
+
+   ============================================================*/
+{
+
+	CHeaderError error;
+	error.code = code;
+	error.line = line;
+	error.column = column;
+	m_errors.Add(error);
+
+}
@@ -0,0 +1,139 @@
+#ifndef _CHEADERPARSER_H_8D2F4B19_A7C3_4E65_9F08B3D6E1A27
+#define _CHEADERPARSER_H_8D2F4B19_A7C3_4E65_9F08B3D6E1A27
+
+///////////////////////////////////////////////////////////
+// File :		HeaderParser.h
+// Created :	10/19/26
+//
+
+#include "HeaderLexer.h"
+
+// Member access, the same values as "ACCESS_TYPE_PRIVATE" etc.
+#define HEADER_ACCESS_PRIVATE		0
+#define HEADER_ACCESS_PROTECTED		1
+#define HEADER_ACCESS_PUBLIC		2
+
+// Errors
+#define HEADER_ERROR_COMMENT		1	// A comment is not closed
+#define HEADER_ERROR_BRACKET		2	// A bracket is not closed, or closed twice
+#define HEADER_ERROR_DECLARATION	3	// A member could not be read, and was skipped
+
+// A parameter of a member function
+class CHeaderParameter : public CObject
+{
+public:
+	CString	type;			// Type as written, such as "const CString&"
+	CString	name;			// Empty if not named
+	CString	defaultvalue;
+
+};
+
+// An attribute or a member function
+class CHeaderMember : public CObject
+{
+public:
+	// Construction/destruction
+	CHeaderMember();
+	virtual ~CHeaderMember();
+
+	// Attributes
+	BOOL	operation;		// TRUE for a member function
+	int		access;			// "HEADER_ACCESS_PRIVATE" etc.
+	CString	type;			// Type, or return type. Empty for constructors and "void"
+	CString	name;
+	CString	multiplicity;	// Array size of an attribute
+	CString	defaultvalue;	// Initializer of an attribute
+
+	BOOL	isStatic;
+	BOOL	isVirtual;		// "virtual" or "override"
+	BOOL	isConst;		// A "const" member function
+	BOOL	isAbstract;		// A pure virtual member function
+
+	int		line;			// Where the member starts in the file
+
+	CObArray	parameters;	// "CHeaderParameter" objects
+
+};
+
+// A class or struct definition
+class CHeaderClass : public CObject
+{
+public:
+	// Construction/destruction
+	CHeaderClass();
+	virtual ~CHeaderClass();
+
+	// Attributes
+	CString			name;
+	CString			templateParameters;	// Inside "template< >", empty if not a template
+	BOOL			isStruct;
+	int				line;				// Line of the class head
+
+	CStringArray	baseClasses;		// As written, such as "CArray<int,int>"
+	CStringArray	baseAccess;			// "public", "protected" or "private"
+
+	CObArray		members;			// "CHeaderMember" objects
+
+};
+
+// An error found while parsing
+struct CHeaderError
+{
+	int		code;		// "HEADER_ERROR_COMMENT" etc.
+	int		line;
+	int		column;
+};
+
+class CHeaderParser
+{
+public:
+	// Construction/destruction
+	CHeaderParser();
+	virtual ~CHeaderParser();
+
+	// Operations
+	BOOL			Parse(LPCTSTR text, int length);
+	void			Clear();
+
+	// Results
+	INT_PTR			GetClassCount() const;
+	CHeaderClass*	GetClass(INT_PTR index) const;
+	CHeaderClass*	FindClass(LPCTSTR title) const;
+	INT_PTR			GetErrorCount() const;
+	const CHeaderError& GetError(INT_PTR index) const;
+	int				GetTokenCount() const;
+
+private:
+	// Data
+	CHeaderLexer	m_lexer;
+	int				m_pos;			// Current token
+	int				m_tokens;		// Tokens of the last parse
+
+	CObArray		m_classes;
+	CArray< CHeaderError, CHeaderError& > m_errors;
+
+	// Declarations
+	void	ParseDeclarations(BOOL nested);
+	void	ParseClass(const CString& templateParameters);
+	void	ParseBaseClasses(CHeaderClass* cls);
+	void	ParseClassBody(CHeaderClass* cls, int open);
+	void	ParseMember(CHeaderClass* cls, int first, int last, int access);
+	void	ParseOperation(CHeaderMember* member, int first, int open, int last);
+	void	ParseAttributes(CHeaderClass* cls, int first, int last, int access, BOOL isStatic);
+	void	ParseParameter(CHeaderMember* member, int first, int last);
+
+	// Helpers
+	int		FindStatementEnd(int first, BOOL braces) const;
+	int		SkipDeclaration(int first) const;
+	int		SkipTemplateParameters(int first, CString& parameters) const;
+	int		MatchBracket(int open) const;
+	int		FindName(int first, int last) const;
+	BOOL	IsSpecifier(int index) const;
+	BOOL	IsAccess(int index) const;
+	CString	JoinTokens(int first, int last) const;
+	void	AddError(int code, int token);
+	void	AddError(int code, int line, int column);
+
+};
+
+#endif //_CHEADERPARSER_H_8D2F4B19_A7C3_4E65_9F08B3D6E1A27
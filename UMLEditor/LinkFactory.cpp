@@ -3,14 +3,18 @@
 
 	Date :			2004-04-29
 
-	Purpose :		"CLinkFactory" is a simple class with one single static
-					function, returning and updating a single static int
-					value to use as a unique id for drawing objects.
+	Purpose :		"CLinkFactory" is a simple class with static functions
+					returning and updating a single static 64-bit value to
+					use as a unique id for drawing objects.
 
 	Description :	See below
 
 	Usage :			Call "CLinkFactory::GetID" to get a unique id during this
-					session.
+					session. Object names are the string form of these
+					ids, and links store them as numbers, converted with
+					"ToString" and "ToID" when they are saved and read.
+					Call "Reserve" with the names of loaded objects, so
+					that new ids will not collide with them.
 
    ========================================================================*/
 #include "stdafx.h"
@@ -25,7 +29,7 @@ static char THIS_FILE[] = __FILE__;
 CString CLinkFactory::GetID()
 /* ============================================================
 	Function :		CLinkFactory::GetID
-	Description :	Returns a unique int every time it is
+	Description :	Returns a unique id every time it is
 					called.
 	Access :		Public
 
@@ -37,14 +41,145 @@ CString CLinkFactory::GetID()
 
    ============================================================*/
 {
-	CString str;
 
-	str.Format(_T("%i"), CLinkFactory::s_currentID);
-	CLinkFactory::s_currentID++;
+	return ToString(GetNumericID());
+
+}
+
+ULONGLONG CLinkFactory::GetNumericID()
+/* ============================================================
+	Function :		CLinkFactory::GetNumericID
+	Description :	Returns a unique 64-bit id every time it
+					is called.
+	Access :		Public
+
+	Return :		ULONGLONG	-	The unique id.
+	Parameters :	none
+
+	Usage :			Call to get a unique id in numeric form.
+					Safe to call from several threads.
+
+   ============================================================*/
+{
+
+	return static_cast<ULONGLONG>(::InterlockedIncrement64(&CLinkFactory::s_currentID) - 1);
+
+}
+
+void CLinkFactory::Reserve(const CString& id)
+/* ============================================================
+	Function :		CLinkFactory::Reserve
+	Description :	Makes sure that "id" will never be returned
+					by "GetID".
+	Access :		Public
+
+	Return :		void
+	Parameters :	const CString& id	-	Id to reserve.
+
+	Usage :			Call for objects loaded from file, as they
+					keep the names they were saved with. Names
+					that are not numeric ids are ignored.
+
+   ============================================================*/
+{
+
+	ULONGLONG value;
+	if (FromString(id, value))
+	{
+		LONGLONG next = static_cast<LONGLONG>(value + 1);
+		LONGLONG current = CLinkFactory::s_currentID;
+		while (current < next)
+		{
+			LONGLONG previous = ::InterlockedCompareExchange64(&CLinkFactory::s_currentID, next, current);
+			if (previous == current)
+				break;
+			current = previous;
+		}
+	}
+
+}
+
+CString CLinkFactory::ToString(ULONGLONG id)
+/* ============================================================
+	Function :		CLinkFactory::ToString
+	Description :	Formats a numeric id.
+	Access :		Public
+
+	Return :		CString			-	The id as a string,
+										empty for
+										"LINK_ID_NONE".
+	Parameters :	ULONGLONG id	-	Id to format.
 
+	Usage :			Call to get the string form of an id, as
+					used for object names and in files.
+
+   ============================================================*/
+{
+
+	CString str;
+	if (id != LINK_ID_NONE)
+		str.Format(_T("%I64u"), id);
 	return str;
 
 }
 
-int CLinkFactory::s_currentID = 0;
+BOOL CLinkFactory::FromString(const CString& str, ULONGLONG& id)
+/* ============================================================
+	Function :		CLinkFactory::FromString
+	Description :	Parses the string form of an id.
+	Access :		Public
+
+	Return :		BOOL				-	"TRUE" if "str" is a
+											numeric id.
+	Parameters :	const CString& str	-	String to parse.
+					ULONGLONG& id		-	Result.
+
+	Usage :			Call to get the numeric form of an object
+					name.
+
+   ============================================================*/
+{
+
+	int length = str.GetLength();
+	if (length == 0 || length > 19)
+		return FALSE;
+
+	ULONGLONG value = 0;
+	for (int t = 0; t < length; t++)
+	{
+		TCHAR c = str[t];
+		if (c < _TCHAR('0') || c > _TCHAR('9'))
+			return FALSE;
+		value = value * 10 + (c - _TCHAR('0'));
+	}
+
+	id = value;
+	return TRUE;
+
+}
+
+ULONGLONG CLinkFactory::ToID(const CString& str)
+/* ============================================================
+	Function :		CLinkFactory::ToID
+	Description :	Parses the string form of a link.
+	Access :		Public
+
+	Return :		ULONGLONG			-	The id, "LINK_ID_NONE"
+											if "str" is empty or
+											not a numeric id.
+	Parameters :	const CString& str	-	String to parse.
+
+	Usage :			Call when reading links from a file.
+
+   ============================================================*/
+{
+
+	ULONGLONG id;
+	if (!FromString(str, id))
+		id = LINK_ID_NONE;
+
+	return id;
+
+}
 
+volatile LONGLONG CLinkFactory::s_currentID = 0;
@@ -1,16 +1,26 @@
 #if !defined(AFX_LINKFACTORY_H__8BBDE424_2729_426C_89EC_B3E3E1021F92__INCLUDED_)
 #define AFX_LINKFACTORY_H__8BBDE424_2729_426C_89EC_B3E3E1021F92__INCLUDED_
 
+// Id of no object, for links that are not attached and names that are
+// not numeric ids
+#define LINK_ID_NONE	static_cast<ULONGLONG>(-1)
+
 class CLinkFactory
 {
 
 public:
 	// Implementation
 	static CString GetID();
+	static ULONGLONG GetNumericID();
+	static void Reserve(const CString& id);
+
+	static CString ToString(ULONGLONG id);
+	static BOOL FromString(const CString& str, ULONGLONG& id);
+	static ULONGLONG ToID(const CString& str);
 
 private:
 	// Private data
-	static int s_currentID;
+	static volatile LONGLONG s_currentID;
 
 };
 
@@ -16,6 +16,7 @@
 
    ========================================================================
 	Changes :		12/7 2004	Added support for template C++-generation.
+					19/10 2026	Allocated from a class-wide "CObjectPool".
    ========================================================================*/
 
 #include "stdafx.h"
@@ -30,6 +31,8 @@
 static char THIS_FILE[] = __FILE__;
 #endif
 
+IMPLEMENT_POOLED_ALLOC(COperation, 256)
+
 // Construction/destruction
 COperation::COperation()
 /* ============================================================
@@ -241,7 +244,7 @@ CString COperation::GetString(int format) const
 	{
 	case STRING_FORMAT_SAVE:
 	{
-		CString type(type);
+		CString type(this->type);
 		CString propertylist(properties.GetString());
 		CString stereo(stereotype);
 		CString getset(getsetvariable);
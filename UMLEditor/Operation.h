@@ -9,9 +9,12 @@
 #include "StringHelpers.h"
 #include "PropertyContainer.h"
 #include "ParameterContainer.h"
+#include "../DiagramEditor/ObjectPool.h"
 
 class COperation : public CObject
 {
+	DECLARE_POOLED_ALLOC(COperation)
+
 public:
 	// Construction/destruction
 	COperation();
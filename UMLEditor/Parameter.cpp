@@ -25,6 +25,8 @@
 static char THIS_FILE[] = __FILE__;
 #endif
 
+IMPLEMENT_POOLED_ALLOC(CParameter, 256)
+
 
 // Construction/destruction
 CParameter::CParameter()
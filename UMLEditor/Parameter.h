@@ -7,9 +7,12 @@
 //
 
 #include "StringHelpers.h"
+#include "../DiagramEditor/ObjectPool.h"
 
 class CParameter : public CObject
 {
+	DECLARE_POOLED_ALLOC(CParameter)
+
 public:
 	// Construction/destruction
 	CParameter();
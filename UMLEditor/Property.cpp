@@ -26,6 +26,8 @@
 static char THIS_FILE[] = __FILE__;
 #endif
 
+IMPLEMENT_POOLED_ALLOC(CProperty, 256)
+
 // Construction/destruction
 CProperty::CProperty()
 /* ============================================================
@@ -7,9 +7,12 @@
 //
 
 #include "StringHelpers.h"
+#include "../DiagramEditor/ObjectPool.h"
 
 class CProperty : public CObject
 {
+	DECLARE_POOLED_ALLOC(CProperty)
+
 public:
 	// Construction/destruction
 	CProperty();
@@ -30,6 +30,7 @@
    ========================================================================*/
 #include "stdafx.h"
 #include "UMLClipboardHandler.h"
+#include "../DiagramEditor/DiagramTrace.h"
 #include "LinkFactory.h"
 #include "UMLLineSegment.h"
 #include "UMLEntityContainer.h"
@@ -137,6 +138,8 @@ void CUMLClipboardHandler::Paste(CDiagramEntityContainer* container)
    ============================================================*/
 {
 
+	DIAGRAM_TRACE_SPAN(_T("CUMLClipboardHandler::Paste"));
+
 	CUMLEntityContainer* objs = static_cast<CUMLEntityContainer*>(container);
 	INT_PTR count = GetData()->GetSize();
 	CString package = objs->GetPackage();
@@ -175,30 +178,6 @@ void CUMLClipboardHandler::FixLinks()
    ============================================================*/
 {
 
-	INT_PTR count = GetData()->GetSize();
-	for (INT_PTR t = 0; t < count; t++)
-	{
-
-		CUMLEntity* obj = static_cast<CUMLEntity*>(GetData()->GetAt(t));
-		if (obj->GetOldId().GetLength())
-		{
-			for (INT_PTR i = 0; i < count; i++)
-			{
-				if (t != i)
-				{
-					CUMLLineSegment* line = dynamic_cast<CUMLLineSegment*>(GetData()->GetAt(i));
-					if (line)
-					{
-						if (line->GetLink(LINK_START) == obj->GetOldId())
-							line->SetLink(LINK_START, obj->GetName());
-						if (line->GetLink(LINK_END) == obj->GetOldId())
-							line->SetLink(LINK_END, obj->GetName());
-					}
-				}
-			}
-
-			obj->SetOldId(_T(""));
-		}
-	}
+	CUMLEntityContainer::FixLinks(GetData());
 
 }
@@ -33,6 +33,7 @@
 #include "UMLEntityInterface.h"
 #include "UMLEntityClassTemplate.h"
 #include "UMLLineSegment.h"
+#include "../DiagramEditor/DiagramTrace.h"
 
 #ifdef _DEBUG
 #define new DEBUG_NEW
@@ -63,6 +64,8 @@ CDiagramEntity* CUMLControlFactory::CreateFromString(const CString& str)
 
    ============================================================*/
 {
+	DIAGRAM_TRACE_SPAN(_T("CUMLControlFactory::CreateFromString"));
+
 	CDiagramEntity* obj;
 
 	obj = CUMLEntityClass::CreateFromString(str);
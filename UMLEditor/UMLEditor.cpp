@@ -28,6 +28,17 @@
 					5/8 2004	Corrected jog-drawing when zoomed.
    ========================================================================
 					27/8 2004	Corrected jog-drawing when scrolling.
+   ========================================================================
+					19/10 2026	Objects are identified by kind tags instead
+								of "dynamic_cast". Tunnels are drawn from
+								the segment view of the container.
+					19/10 2026	Added AutoLayout.
+					19/10 2026	Added RouteLinks.
+					19/10 2026	ExportEMF exports to PNG if a ".png" file
+								is chosen.
+					19/10 2026	ExportEMF exports to SVG and PDF too.
+					19/10 2026	Added ImportFolder, importing the classes
+								of a folder of header files.
    ========================================================================*/
 
 #include "stdafx.h"
@@ -36,7 +47,9 @@
 #include "UMLLineSegment.h"
 #include "UMLEntityPackage.h"
 #include "../TextFile/TextFile.h"
+#include "../DiagramEditor/DiagramTrace.h"
 #include "DiskObject/DiskObject.h"
+#include "HeaderImport.h"
 
 #include <math.h>
 #include <shlobj.h>
@@ -49,6 +62,9 @@ static char THIS_FILE[] = __FILE__;
 
 #pragma warning( disable : 4706 )
 
+// Errors listed after a folder import
+#define MAX_IMPORT_ERRORS	20
+
 int CALLBACK BFFCallbackProc(HWND hwnd, UINT uMsg, LPARAM /*lParam*/, LPARAM lpData)
 {
 	if (uMsg == BFFM_INITIALIZED)
@@ -149,6 +165,8 @@ void CUMLEditor::DrawObjects(CDC* dc, double zoom) const
    ============================================================*/
 {
 
+	DIAGRAM_TRACE_SPAN(_T("CUMLEditor::DrawObjects"));
+
 	CString package = GetPackage();
 	if (package.GetLength())
 	{
@@ -186,13 +204,19 @@ void CUMLEditor::DrawObjects(CDC* dc, double zoom) const
 	}
 
 	INT_PTR count = GetObjectCount();
+	INT_PTR drawn = 0;
 	for (INT_PTR i = 0; i < count; i++)
 	{
 		CUMLEntity* obj = GetObjectAt(i);
 		if (obj && package == obj->GetPackage())
+		{
 			obj->DrawObject(dc, zoom);
+			drawn++;
+		}
 	}
 
+	CountDrawn(count, drawn);
+
 	CPen gridPen;
 	gridPen.CreatePen(PS_SOLID, 0, GetGridColor());
 	CPen bgPen;
@@ -204,17 +228,19 @@ void CUMLEditor::DrawObjects(CDC* dc, double zoom) const
 	int topscroll = GetScrollPos(SB_VERT);
 	int leftscroll = GetScrollPos(SB_LEFT);
 
-	for (int i = 0; i < count; i++)
+	CObArray segments;
+	count = GetUMLEntityContainer()->GetSegments(segments);
+	for (INT_PTR i = 0; i < count; i++)
 	{
 
-		CUMLLineSegment* obj = dynamic_cast<CUMLLineSegment*>(GetObjectAt(i));
-		if (obj && package == obj->GetPackage())
+		CUMLLineSegment* obj = static_cast<CUMLLineSegment*>(segments.GetAt(i));
+		if (package == obj->GetPackage())
 		{
 			// Drawing tunnels
 			BOOL horz = obj->IsHorizontal();
-			for (int t = i + 1; t < count; t++)
+			for (INT_PTR t = i + 1; t < count; t++)
 			{
-				CUMLLineSegment* line = dynamic_cast<CUMLLineSegment*>(GetObjectAt(t));
+				CUMLLineSegment* line = static_cast<CUMLLineSegment*>(segments.GetAt(t));
 				if (line)
 				{
 					dc->SelectStockObject(NULL_BRUSH);
@@ -367,7 +393,7 @@ void CUMLEditor::OnObjectCommand(UINT nID)
    ============================================================*/
 {
 
-	CUMLEntityPackage* package = dynamic_cast<CUMLEntityPackage*>(GetSelectedObject());
+	CUMLEntityPackage* package = CUMLEntityPackage::Cast(GetSelectedObject());
 	if (package && nID == CMD_OPEN)
 	{
 		UnselectAll();
@@ -444,7 +470,7 @@ void CUMLEditor::OnLButtonDown(UINT nFlags, CPoint point)
 	ScreenToVirtual(virtpoint);
 	CUMLLineSegment* seg = NULL;
 	if (m_drawingLine && GetInteractMode() == MODE_RESIZING)
-		seg = dynamic_cast<CUMLLineSegment*>(GetSelectedObject());
+		seg = CUMLLineSegment::Cast(GetSelectedObject());
 
 	// If we are starting to draw a new link, we save the object 
 	// link point under the cursor, as we want to set the start 
@@ -456,7 +482,7 @@ void CUMLEditor::OnLButtonDown(UINT nFlags, CPoint point)
 	if (GetInteractMode() == MODE_DRAWING)
 	{
 		m_drawingLine = FALSE;
-		CUMLLineSegment* seg = dynamic_cast<CUMLLineSegment*>(GetDrawingObject());
+		CUMLLineSegment* seg = CUMLLineSegment::Cast(GetDrawingObject());
 		if (seg)
 		{
 			int count = 0;
@@ -487,10 +513,10 @@ void CUMLEditor::OnLButtonDown(UINT nFlags, CPoint point)
 	if (GetInteractMode() == MODE_RESIZING && m_drawingLine && mainobj && savedtype != LINK_NONE)
 	{
 		// We have added a line segment, and set the link start point to it
-		CUMLLineSegment* seg = dynamic_cast<CUMLLineSegment*>(GetSelectedObject());
+		CUMLLineSegment* seg = CUMLLineSegment::Cast(GetSelectedObject());
 		if (seg)
 		{
-			seg->SetLink(LINK_START, mainobj->GetName());
+			seg->SetLink(LINK_START, mainobj->GetID());
 			seg->SetLinkType(LINK_START, savedtype);
 
 			int diff = 0;
@@ -511,8 +537,8 @@ void CUMLEditor::OnLButtonDown(UINT nFlags, CPoint point)
 
 			if (savedtype == LINK_END)
 			{
-				CUMLLineSegment* line = dynamic_cast<CUMLLineSegment*>(mainobj);
-				line->SetLink(LINK_END, seg->GetName());
+				CUMLLineSegment* line = CUMLLineSegment::Cast(mainobj);
+				line->SetLink(LINK_END, seg->GetID());
 				line->SetLinkType(LINK_END, LINK_START);
 			}
 			else
@@ -569,7 +595,7 @@ void CUMLEditor::OnLButtonUp(UINT nFlags, CPoint point)
 	// We get this before the base class implementation
 	// to avoid any unselects in there. 
 	CUMLEntityContainer* objs = GetUMLEntityContainer();
-	CUMLLineSegment* selobj = dynamic_cast<CUMLLineSegment*>(GetSelectedObject());
+	CUMLLineSegment* selobj = CUMLLineSegment::Cast(GetSelectedObject());
 
 	CDiagramEditor::OnLButtonUp(nFlags, point);
 
@@ -602,7 +628,7 @@ void CUMLEditor::OnLButtonUp(UINT nFlags, CPoint point)
 							// We have a hit
 							// Attach to an object
 							attached = TRUE;
-							selobj->SetLink(LINK_END, obj->GetName());
+							selobj->SetLink(LINK_END, obj->GetID());
 							selobj->SetLinkType(LINK_END, linkCode);
 
 							int diff = 0;
@@ -623,10 +649,10 @@ void CUMLEditor::OnLButtonUp(UINT nFlags, CPoint point)
 
 							if (linkCode == LINK_START || linkCode == LINK_END)
 							{
-								CUMLLineSegment* line = dynamic_cast<CUMLLineSegment*>(obj);
+								CUMLLineSegment* line = CUMLLineSegment::Cast(obj);
 								if (line)
 								{
-									line->SetLink(LINK_START, selobj->GetName());
+									line->SetLink(LINK_START, selobj->GetID());
 									line->SetLinkType(LINK_START, LINK_END);
 								}
 							}
@@ -663,9 +689,9 @@ void CUMLEditor::OnLButtonUp(UINT nFlags, CPoint point)
 
 				// Create a link between selobj and newobj
 				selobj->SetLinkType(LINK_END, LINK_START);
-				selobj->SetLink(LINK_END, line->GetName());
+				selobj->SetLink(LINK_END, line->GetID());
 
-				line->SetLink(LINK_START, selobj->GetName());
+				line->SetLink(LINK_START, selobj->GetID());
 				line->SetLinkType(LINK_START, LINK_END);
 
 				objs->ReduceLine(selobj);
@@ -726,7 +752,7 @@ void CUMLEditor::OnMouseMove(UINT nFlags, CPoint point)
 			if (GetSelectCount() == 1)
 			{
 
-				CUMLLineSegment* obj = dynamic_cast<CUMLLineSegment*>(GetSelectedObject());
+				CUMLLineSegment* obj = CUMLLineSegment::Cast(GetSelectedObject());
 				if (obj)
 				{
 					if (IsConnected(obj))
@@ -793,7 +819,7 @@ void CUMLEditor::OnKeyDown(UINT nChar, UINT nRepCnt, UINT nFlags)
 		CUMLLineSegment* savedobj = NULL;
 		if (GetSelectCount() == 1)
 		{
-			CUMLLineSegment* obj = dynamic_cast<CUMLLineSegment*>(GetSelectedObject());
+			CUMLLineSegment* obj = CUMLLineSegment::Cast(GetSelectedObject());
 			if (obj && IsConnected(obj))
 			{
 				rect = obj->GetRect();
@@ -876,7 +902,7 @@ void CUMLEditor::OnRButtonDown(UINT nFlags, CPoint point)
 	// link - if any - dangling, and so we start by deleting it.
 	if (GetSelectCount() == 1)
 	{
-		CUMLLineSegment* seg = dynamic_cast<CUMLLineSegment*>(GetSelectedObject());
+		CUMLLineSegment* seg = CUMLLineSegment::Cast(GetSelectedObject());
 		if (seg && !IsConnected(seg))
 			GetDiagramEntityContainer()->Remove(seg);
 	}
@@ -911,7 +937,7 @@ void CUMLEditor::OnRButtonUp(UINT nFlags, CPoint point)
 /////////////////////////////////////////////////////////////////////////////
 // CUMLEditor private helpers
 
-void CUMLEditor::ModifyLinkedPositions()
+int CUMLEditor::ModifyLinkedPositions()
 /* ============================================================
 	Function :		CUMLEditor::ModifyLinkedPositions
 	Description :	Will modify the position of all unselected
@@ -920,21 +946,27 @@ void CUMLEditor::ModifyLinkedPositions()
 					offset.
 	Access :		Protected
 
-	Return :		void
+	Return :		int		-	Number of objects moved or
+								resized.
 	Parameters :	none
 
 	Usage :			Should be called after all operations that
 					might move an object. Movement direction is
-					dependent on the link type.
+					dependent on the link type. All the
+					selected objects are adjusted for in a
+					single pass.
 
    ============================================================*/
 {
 
+	CObArray moved;
 	CUMLEntity* obj = NULL;
 	int count = 0;
 	while ((obj = GetObjectAt(count++)))
 		if (obj->GetPackage() == GetPackage() && obj->IsSelected())
-			GetUMLEntityContainer()->AdjustLinkedObjects(obj);
+			moved.Add(obj);
+
+	return GetUMLEntityContainer()->AdjustLinkedObjects(moved);
 
 }
 
@@ -1025,9 +1057,8 @@ BOOL CUMLEditor::IsConnected(CUMLLineSegment* link) const
    ============================================================*/
 {
 
-	CString name = link->GetName();
 	BOOL result = FALSE;
-	if (link->GetLink(LINK_START).GetLength() && link->GetLink(LINK_END).GetLength())
+	if (link->GetLink(LINK_START) != LINK_ID_NONE && link->GetLink(LINK_END) != LINK_ID_NONE)
 		result = TRUE;
 
 	return result;
@@ -1115,7 +1146,7 @@ BOOL CUMLEditor::PartialLinesSelected() const
 	{
 		while ((obj = GetObjectAt(count++)))
 		{
-			CUMLLineSegment* line = dynamic_cast<CUMLLineSegment*>(obj);
+			CUMLLineSegment* line = CUMLLineSegment::Cast(obj);
 			if (line && line->IsSelected())
 				if (!GetUMLEntityContainer()->LineSelected(line))
 					return TRUE;
@@ -1144,8 +1175,8 @@ void CUMLEditor::SetCursor(CPoint point)
 
 	m_currentCursor = NULL;
 
-	CUMLLineSegment* seg = dynamic_cast<CUMLLineSegment*>(GetSelectedObject());
-	CUMLLineSegment* draw = dynamic_cast<CUMLLineSegment*>(GetDrawingObject());
+	CUMLLineSegment* seg = CUMLLineSegment::Cast(GetSelectedObject());
+	CUMLLineSegment* draw = CUMLLineSegment::Cast(GetDrawingObject());
 
 	if (seg && GetInteractMode() == MODE_RESIZING)
 	{
@@ -1294,17 +1325,20 @@ CUMLEntityContainer * CUMLEditor::GetUMLEntityContainer() const
 
 }
 
-CString CUMLEditor::BrowseForFolder()
+CString CUMLEditor::BrowseForFolder(UINT title, CString& path)
 /* ============================================================
 	Function :		CUMLEditor::BrowseForFolder
 	Description :	Displays the Windows folder browsing dialog.
 	Access :		Private
 
-	Return :		CString	-	Selected folder.
-	Parameters :	none
+	Return :		CString			-	Selected folder.
+	Parameters :	UINT title		-	Resource id of the
+										dialog title.
+					CString& path	-	Initial folder, set to
+										the selected folder.
 
 	Usage :			Call to let the user enter a folder (to save
-					c++-code to).
+					c++-code to, or to import headers from).
 
    ============================================================*/
 {
@@ -1314,10 +1348,10 @@ CString CUMLEditor::BrowseForFolder()
 	ZeroMemory(&bi, sizeof(BROWSEINFO));
 	CString str;
 
-	CString title;
+	CString caption;
 
 	_TCHAR initialPath[_MAX_PATH];
-	lstrcpy(initialPath, m_exportPath);
+	lstrcpyn(initialPath, path, _MAX_PATH);
 
 	_TCHAR buffer[_MAX_PATH];
 	ZeroMemory(buffer, _MAX_PATH);
@@ -1325,9 +1359,9 @@ CString CUMLEditor::BrowseForFolder()
 	bi.hwndOwner = AfxGetMainWnd()->m_hWnd;
 	bi.pidlRoot = NULL;
 	bi.pszDisplayName = NULL;
-	if (title.LoadString(IDS_UML_SELECT_FOLDER) > 0)
+	if (caption.LoadString(title) > 0)
 	{
-		bi.lpszTitle = title;
+		bi.lpszTitle = caption;
 	}
 
 	bi.ulFlags = BIF_USENEWUI;
@@ -1339,7 +1373,7 @@ CString CUMLEditor::BrowseForFolder()
 	{
 		if (::SHGetPathFromIDList(pidl, buffer) == TRUE)
 		{
-			m_exportPath = buffer;
+			path = buffer;
 			str = buffer;
 		}
 
@@ -1366,14 +1400,36 @@ void CUMLEditor::ExportEMF(const CString& filename)
 
 	Usage :			Call to export the diagram to an EMF file
 					for - for example - inclusion into a
-					word-processing document.
+					word-processing document. If a ".png",
+					".svg" or ".pdf" file is chosen, the
+					diagram is exported to that format
+					instead, see "ExportPNG", "ExportSVG" and
+					"ExportPDF".
 
    ============================================================*/
 {
 
-	CFileDialog dlg(FALSE, _T("emf"), filename, OFN_HIDEREADONLY | OFN_OVERWRITEPROMPT, _T("Enhanced MetaFile (*.emf)|*.emf|All Files (*.*)|*.*||"));
+	CFileDialog dlg(FALSE, _T("emf"), filename, OFN_HIDEREADONLY | OFN_OVERWRITEPROMPT, _T("Enhanced MetaFile (*.emf)|*.emf|PNG Image (*.png)|*.png|SVG Image (*.svg)|*.svg|PDF Document (*.pdf)|*.pdf|All Files (*.*)|*.*||"));
 	if (dlg.DoModal() == IDOK)
 	{
+		CString extension = dlg.GetPathName().Right(4);
+		if (extension.CompareNoCase(_T(".png")) == 0)
+		{
+			ExportPNG(dlg.GetPathName());
+			return;
+		}
+		if (extension.CompareNoCase(_T(".svg")) == 0)
+		{
+			ExportSVG(dlg.GetPathName());
+			return;
+		}
+		if (extension.CompareNoCase(_T(".pdf")) == 0)
+		{
+			ExportPDF(dlg.GetPathName());
+			return;
+		}
+
+		DIAGRAM_TRACE_SPAN(_T("CUMLEditor::ExportEMF"));
 
 		CClientDC	dc(this);
 		CMetaFileDC	metaDC;
@@ -1439,7 +1495,7 @@ void CUMLEditor::ExportCPP(const CString& project, BOOL bHeaderOnly)
 
 	if (container)
 	{
-		CString location = BrowseForFolder();
+		CString location = BrowseForFolder(IDS_UML_SELECT_FOLDER, m_exportPath);
 		if (location.GetLength())
 		{
 			BOOL modified0 = container->BaseClassClasses();
@@ -1489,6 +1545,8 @@ void CUMLEditor::ExportHTML(const CString& filename)
 	CFileDialog dlg(FALSE, _T("html"), filename, OFN_HIDEREADONLY | OFN_OVERWRITEPROMPT, _T("HTML File (*.html)|*.html;*.htm||All Files (*.*)|*.*||"));
 	if (dlg.DoModal() == IDOK)
 	{
+		DIAGRAM_TRACE_SPAN(_T("CUMLEditor::ExportHTML"));
+
 		CUMLEntityContainer* container = GetUMLEntityContainer();
 		if (container)
 		{
@@ -1531,6 +1589,7 @@ void CUMLEditor::MakeSameSizeSelected()
 {
 	if (GetSelectCount() > 1)
 	{
+		BeginTransaction();
 		GetUMLEntityContainer()->Snapshot();
 		CDiagramEntity* obj = GetSelectedObject();
 		if (obj)
@@ -1543,7 +1602,8 @@ void CUMLEditor::MakeSameSizeSelected()
 					obj->SetRect(obj->GetLeft(), obj->GetTop(), obj->GetLeft() + width, obj->GetTop() + height);
 		}
 		SetModified(TRUE);
-		RedrawWindow();
+		RequestRedraw();
+		CommitTransaction();
 	}
 }
 
@@ -1636,6 +1696,74 @@ void CUMLEditor::FlipLink()
 
 }
 
+void CUMLEditor::AutoLayout()
+/* ============================================================
+	Function :		CUMLEditor::AutoLayout
+	Description :	Arranges the current package in layers.
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Call to tidy up the diagram. Can be
+					undone. The virtual size is grown if the
+					result does not fit.
+
+   ============================================================*/
+{
+
+	CUMLEntityContainer* objs = GetUMLEntityContainer();
+	if (objs && objs->GetSize())
+	{
+		objs->Snapshot();
+		objs->AutoLayout();
+
+		const CBoundsArray* bounds = objs->GetBounds();
+		CSize size = GetVirtualSize();
+		CSize needed(round(bounds->GetMax(BOUNDS_RIGHT, 0)) + 1, round(bounds->GetMax(BOUNDS_BOTTOM, 0)) + 1);
+		if (needed.cx > size.cx || needed.cy > size.cy)
+			SetVirtualSize(CSize(max(size.cx, needed.cx), max(size.cy, needed.cy)));
+
+		SetModified(TRUE);
+		RedrawWindow();
+	}
+
+}
+
+void CUMLEditor::RouteLinks()
+/* ============================================================
+	Function :		CUMLEditor::RouteLinks
+	Description :	Reroutes the lines around the objects.
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Call to untangle the lines of the selection,
+					or of the whole package if nothing is
+					selected. Can be undone.
+
+   ============================================================*/
+{
+
+	CUMLEntityContainer* objs = GetUMLEntityContainer();
+	if (objs && objs->GetSize())
+	{
+		objs->Snapshot();
+		objs->RouteLines();
+
+		const CBoundsArray* bounds = objs->GetBounds();
+		CSize size = GetVirtualSize();
+		CSize needed(round(bounds->GetMax(BOUNDS_RIGHT, 0)) + 1, round(bounds->GetMax(BOUNDS_BOTTOM, 0)) + 1);
+		if (needed.cx > size.cx || needed.cy > size.cy)
+			SetVirtualSize(CSize(max(size.cx, needed.cx), max(size.cy, needed.cy)));
+
+		SetModified(TRUE);
+		RedrawWindow();
+	}
+
+}
+
 void CUMLEditor::Import()
 /* ============================================================
 	Function :		CUMLEditor::Import
@@ -1657,6 +1785,113 @@ void CUMLEditor::Import()
 
 }
 
+void CUMLEditor::ImportFolder()
+/* ============================================================
+	Function :		CUMLEditor::ImportFolder
+	Description :	Imports the classes of all header files in
+					a folder and its subfolders.
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Call to let the user select a folder to
+					import. The classes are added to a new
+					package in the current package, with one
+					package for each subfolder. Can be undone.
+					Files that could not be read completely are
+					listed when the import is done.
+
+   ============================================================*/
+{
+
+	CUMLEntityContainer* objs = GetUMLEntityContainer();
+	if (objs == NULL)
+		return;
+
+	CString folder = BrowseForFolder(IDS_UML_SELECT_IMPORT_FOLDER, m_importPath);
+	if (folder.IsEmpty())
+		return;
+
+	CWaitCursor wait;
+	CHeaderImport import;
+	if (!import.Parse(folder))
+	{
+		AfxMessageBox(import.GetErrorMessage());
+		return;
+	}
+
+	if (import.GetClassCount() == 0)
+	{
+		AfxMessageBox(IDS_UML_NO_CLASSES_FOUND);
+		return;
+	}
+
+	objs->Snapshot();
+	objs->ImportFolder(import);
+
+	const CBoundsArray* bounds = objs->GetBounds();
+	CSize size = GetVirtualSize();
+	CSize needed(round(bounds->GetMax(BOUNDS_RIGHT, 0)) + 1, round(bounds->GetMax(BOUNDS_BOTTOM, 0)) + 1);
+	if (needed.cx > size.cx || needed.cy > size.cy)
+		SetVirtualSize(CSize(max(size.cx, needed.cx), max(size.cy, needed.cy)));
+
+	SetModified(TRUE);
+	RedrawWindow();
+
+	// The report, with the first errors
+	CString format;
+	format.LoadString(IDS_UML_IMPORT_FINISHED);
+	CString report;
+	report.Format(format, static_cast<int>(import.GetClassCount()), static_cast<int>(import.GetFileCount()));
+
+	int errors = 0;
+	INT_PTR files = import.GetFileCount();
+	for (INT_PTR t = 0; t < files; t++)
+	{
+		CHeaderFile* file = import.GetFile(t);
+		CString name = file->filename.Mid(import.GetFolder().GetLength() + 1);
+		if (file->error.GetLength())
+		{
+			if (errors < MAX_IMPORT_ERRORS)
+				report += _T("\n") + name + _T(": ") + file->error;
+			errors++;
+		}
+
+		INT_PTR max = file->parser.GetErrorCount();
+		for (INT_PTR i = 0; i < max; i++)
+		{
+			if (errors < MAX_IMPORT_ERRORS)
+			{
+				const CHeaderError& error = file->parser.GetError(i);
+				UINT id = IDS_UML_UNKNOWN_DECLARATION;
+				if (error.code == HEADER_ERROR_COMMENT)
+					id = IDS_UML_MALFORMED_COMMENT;
+				else if (error.code == HEADER_ERROR_BRACKET)
+					id = IDS_UML_MISSING_BRACKET;
+
+				CString message;
+				message.LoadString(id);
+				CString line;
+				line.Format(_T("\n%s(%d): %s"), static_cast<LPCTSTR>(name), error.line, static_cast<LPCTSTR>(message));
+				report += line;
+			}
+			errors++;
+		}
+	}
+
+	if (errors > MAX_IMPORT_ERRORS)
+	{
+		format.LoadString(IDS_UML_IMPORT_MORE_ERRORS);
+		CString more;
+		more.Format(format, errors - MAX_IMPORT_ERRORS);
+		report += _T("\n") + more;
+	}
+
+	AfxMessageBox(report);
+
+}
+
 void CUMLEditor::Save(CString& filename)
 /* ============================================================
 	Function :		CUMLEditor::Save
@@ -1696,6 +1931,8 @@ void CUMLEditor::Load(CString& filename)
    ============================================================*/
 {
 
+	DIAGRAM_TRACE_SPAN(_T("CUMLEditor::Load"));
+
 	if (GetUMLEntityContainer())
 		GetUMLEntityContainer()->Load(filename);
 
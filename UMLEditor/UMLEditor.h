@@ -19,6 +19,8 @@ public:
 	// Operations
 	BOOL	IsLinkSelected() const;
 	void	FlipLink();
+	void	AutoLayout();
+	void	RouteLinks();
 
 	CString GetPackage() const;
 	void SetPackage(const CString& package);
@@ -41,6 +43,7 @@ public:
 	BOOL GetStripLeadingClassCharacter() const;
 
 	void	Import();
+	void	ImportFolder();
 
 protected:
 	// Overrides:
@@ -58,14 +61,14 @@ protected:
 
 private:
 	// Private helpers
-	void			ModifyLinkedPositions();
+	int				ModifyLinkedPositions();
 	CUMLEntity*		GetNamedObject(const CString& name) const;
 
 	BOOL			IsConnected(CUMLLineSegment* link) const;
 	CUMLEntity*		GetObjectAt(INT_PTR index) const;
 
 	BOOL			PartialLinesSelected() const;
-	CString			BrowseForFolder();
+	CString			BrowseForFolder(UINT title, CString& path);
 
 	// Private data
 	BOOL	m_drawingLine;
@@ -83,6 +86,7 @@ private:
 
 	CUMLEntityContainer*	m_data;
 	CString					m_exportPath;
+	CString					m_importPath;
 
 };
 
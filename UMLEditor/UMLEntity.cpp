@@ -22,6 +22,10 @@
 #include "UMLEntity.h"
 #include "LinkFactory.h"
 #include "../DiagramEditor/Tokenizer.h"
+#include "../DiagramEditor/StringTable.h"
+#include "../DiagramEditor/DiagramMemoryUsage.h"
+#include "../DiagramEditor/DiagramTrace.h"
+#include "../DiagramEditor/DiagramEntityContainer.h"
 #include "StringHelpers.h"
 
 #ifdef _DEBUG
@@ -50,6 +54,7 @@ CUMLEntity::CUMLEntity()
 	SetDefaultSize(CSize(0, 0));
 	SetConstraints(CSize(0, 0), CSize(0, 0));
 	SetType(_T("uml_entity"));
+	AddKind(KIND_UML_ENTITY);
 
 	SetName(CLinkFactory::GetID());
 
@@ -262,6 +267,57 @@ void CUMLEntity::Copy(CDiagramEntity* obj)
 
 }
 
+void CUMLEntity::InternStrings(CStringTable* table)
+/* ============================================================
+	Function :		CUMLEntity::InternStrings
+	Description :	Replaces the string members with their
+					interned copies from "table".
+	Access :		Public
+
+	Return :		void
+	Parameters :	CStringTable* table	-	Document string
+											table.
+
+	Usage :			Called by the container when the object is
+					added. The package is compared against the
+					current package for every object access,
+					so sharing it makes that test a pointer
+					compare.
+
+   ============================================================*/
+{
+
+	CDiagramEntity::InternStrings(table);
+	table->InternString(m_package);
+	table->InternString(m_fontName);
+	table->InternString(m_stereotype);
+
+}
+
+void CUMLEntity::GetMemoryUsage(CDiagramMemoryUsage& usage) const
+/* ============================================================
+	Function :		CUMLEntity::GetMemoryUsage
+	Description :	Adds the memory held by the object to
+					"usage".
+	Access :		Public
+
+	Return :		void
+	Parameters :	CDiagramMemoryUsage& usage	-	Breakdown
+													to add to.
+
+	Usage :			Called by the container.
+
+   ============================================================*/
+{
+
+	CDiagramEntity::GetMemoryUsage(usage);
+	usage.AddString(m_package);
+	usage.AddString(m_fontName);
+	usage.AddString(m_stereotype);
+	usage.AddString(m_oldid);
+
+}
+
 void CUMLEntity::SetPackage(const CString& package)
 /* ============================================================
 	Function :		CUMLEntity::SetPackage
@@ -280,6 +336,11 @@ void CUMLEntity::SetPackage(const CString& package)
 
 	m_package = package;
 
+	// Moving the object to another package
+	// changes what the container shows.
+	if (GetParent())
+		GetParent()->InvalidateBounds();
+
 }
 
 CString CUMLEntity::GetPackage() const
@@ -600,6 +661,8 @@ void CUMLEntity::CalcRestraints()
 
    ============================================================*/
 {
+	DIAGRAM_TRACE_SPAN(_T("CUMLEntity::CalcRestraints"));
+
 	// No specific default implementation
 }
 
@@ -42,8 +42,15 @@ class CUMLEntityContainer;
 #define ACCESS_TYPE_PROTECTED		1
 #define ACCESS_TYPE_PUBLIC			2
 
+#define KIND_UML_ENTITY				0x00000100
+#define KIND_UML_LINESEGMENT		0x00000200
+#define KIND_UML_CLASS				0x00000400
+#define KIND_UML_INTERFACE			0x00000800
+#define KIND_UML_PACKAGE			0x00001000
+
 class CUMLEntity : public CDiagramEntity
 {
+	DECLARE_ENTITY_SIZE(CUMLEntity)
 
 public:
 	// Construction/initialization/destruction
@@ -62,6 +69,8 @@ public:
 
 	virtual void	SetRect(double left, double top, double right, double bottom);
 	virtual void	Copy(CDiagramEntity* obj);
+	virtual void	InternStrings(CStringTable* table);
+	virtual void	GetMemoryUsage(CDiagramMemoryUsage& usage) const;
 
 	void			SetPackage(const CString& package);
 	CString			GetPackage() const;
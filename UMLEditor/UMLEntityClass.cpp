@@ -32,12 +32,26 @@
    ========================================================================
 					27/8 2004	Removes prefixing "ClassName::" in function
 								names while importing a class from a h-file.
+   ========================================================================
+					19/10 2026	Allocated from a class-wide "CObjectPool".
+					19/10 2026	Added GetMemoryUsage
+					19/10 2026	Added ImportClass, filling the class from
+								a class read by "CHeaderParser".
+					19/10 2026	ImportH reads the header with
+								"CHeaderParser" instead of rewriting the
+								text line by line.
+					19/10 2026	Draw replaced by Render, so the class box
+								can be drawn to a memory buffer.
    ========================================================================*/
 
 #include "stdafx.h"
 #include "UMLEntityClass.h"
+#include "../DiagramEditor/DiagramTrace.h"
+#include "../DiagramEditor/DiagramMemoryUsage.h"
 #include "UMLEntityContainer.h"
 #include "StringHelpers.h"
+#include "HeaderParser.h"
+#include "../DiagramEditor/DiagramRenderer.h"
 
 #include "../TextFile/TextFile.h"
 
@@ -47,6 +61,8 @@
 static char THIS_FILE[] = __FILE__;
 #endif
 
+IMPLEMENT_POOLED_ALLOC(CUMLEntityClass, 64)
+
 CUMLEntityClass::CUMLEntityClass()
 /* ============================================================
 	Function :		CUMLEntityClass::CUMLEntityClass
@@ -67,6 +83,7 @@ CUMLEntityClass::CUMLEntityClass()
 	SetConstraints(GetDefaultSize(), CSize(-1, -1));
 	SetBkColor(RGB(255, 255, 217));
 	SetType(_T("uml_class"));
+	AddKind(KIND_UML_CLASS);
 
 	CString title;
 	if (title.LoadString(IDS_UML_CLASS) > 0)
@@ -104,21 +121,21 @@ CUMLEntityClass::~CUMLEntityClass()
 
 }
 
-void CUMLEntityClass::Draw(CDC* dc, CRect rect)
+void CUMLEntityClass::Render(CDiagramRenderer* renderer, CRect rect)
 /* ============================================================
-	Function :		CUMLEntityClass::Draw
+	Function :		CUMLEntityClass::Render
 	Description :	Draws the object.
 	Access :		Public
 
 	Return :		void
-	Parameters :	CDC* dc		-	The "CDC" to draw to.
-					CRect rect	-	The real rectangle of the
-									object.
+	Parameters :	CDiagramRenderer* renderer	-	The renderer to
+													draw with.
+					CRect rect					-	The real rectangle
+													of the object.
 
-	Usage :			The function should clean up all selected
-					objects. Note that the "CDC" is a memory "CDC",
-					so creating a memory "CDC" in this function
-					will probably not speed up the function.
+	Usage :			Called from "Draw", or to draw to a memory
+					buffer. Static members are underlined and
+					abstract members in italics.
 
    ============================================================*/
 {
@@ -130,39 +147,19 @@ void CUMLEntityClass::Draw(CDC* dc, CRect rect)
 	// The box
 	//
 
-	dc->SelectStockObject(BLACK_PEN);
-	CBrush bk;
-	bk.CreateSolidBrush(GetBkColor());
-	dc->SelectObject(&bk);
+	renderer->SetPen(PS_SOLID, 0, RGB(0, 0, 0));
+	renderer->SetBrush(GetBkColor());
+	renderer->SetBkMode(TRANSPARENT);
 
-	int mode = dc->SetBkMode(TRANSPARENT);
-	int height = round(12.0 * GetZoom());
+	int fontheight = round(12.0 * GetZoom());
 
-	dc->Rectangle(rect);
+	renderer->Rectangle(rect);
 
 	////////////////////////////////////////////////////////////////////
 	// Set up
 	//
 
-	CFont font;
-	font.CreateFont(-height, 0, 0, 0, FW_NORMAL, 0, 0, 0, 0, 0, 0, 0, 0, GetFont());
-	CFont fontItalic;
-	fontItalic.CreateFont(-height, 0, 0, 0, FW_NORMAL, TRUE, 0, 0, 0, 0, 0, 0, 0, GetFont());
-	CFont fontUnderline;
-	fontUnderline.CreateFont(-height, 0, 0, 0, FW_NORMAL, 0, TRUE, 0, 0, 0, 0, 0, 0, GetFont());
-	CFont fontBold;
-	fontBold.CreateFont(-height, 0, 0, 0, FW_BOLD, 0, 0, 0, 0, 0, 0, 0, 0, GetFont());
-	CFont fontBoldItalic;
-	fontBoldItalic.CreateFont(-height, 0, 0, 0, FW_BOLD, TRUE, 0, 0, 0, 0, 0, 0, 0, GetFont());
-	CFont fontBoldUnderline;
-	fontBoldUnderline.CreateFont(-height, 0, 0, 0, FW_BOLD, 0, TRUE, 0, 0, 0, 0, 0, 0, GetFont());
-	CFont fontUnderlineItalic;
-	fontUnderlineItalic.CreateFont(-height, 0, 0, 0, FW_NORMAL, TRUE, TRUE, 0, 0, 0, 0, 0, 0, GetFont());
-
-	height = (int)floor(14.0 * GetZoom());
-
-	CFont* oldfont = NULL;
-	oldfont = dc->SelectObject(&fontBold);
+	int height = (int)floor(14.0 * GetZoom());
 
 	////////////////////////////////////////////////////////////////////
 	// Title
@@ -173,32 +170,27 @@ void CUMLEntityClass::Draw(CDC* dc, CRect rect)
 	if (stereotype.GetLength())
 	{
 		stereotype = _T(" ") + stereotype + _T(" ");
-		dc->SelectObject(&font);
-		dc->DrawText(stereotype, r, DT_SINGLELINE | DT_NOPREFIX | DT_CENTER);
+		renderer->SetFont(GetFont(), -fontheight);
+		renderer->DrawText(stereotype, r, DT_SINGLELINE | DT_NOPREFIX | DT_CENTER);
 		lines++;
 		r.top += height;
 	}
 
-	BOOL abstract = IsAbstract();
-
-	if (abstract)
-		dc->SelectObject(&fontBoldItalic);
-	else
-		dc->SelectObject(&fontBold);
+	renderer->SetFont(GetFont(), -fontheight, FW_BOLD, IsAbstract());
 
 	CRect textRect(r);
 	textRect.bottom = textRect.top + height;
-	dc->DrawText(GetTitle(), textRect, DT_SINGLELINE | DT_NOPREFIX | DT_CENTER);
+	renderer->DrawText(GetTitle(), textRect, DT_SINGLELINE | DT_NOPREFIX | DT_CENTER);
 
 	CString propertylist = m_properties.GetString(STRING_FORMAT_UML);
 	if (propertylist.GetLength())
 	{
-		dc->SelectObject(&font);
+		renderer->SetFont(GetFont(), -fontheight);
 		propertylist.Replace(_T(", "), _T("\r\n"));
 		r.top += height;
 		textRect = r;
 		textRect.bottom = textRect.top + (LONG)m_properties.GetSize() * height;
-		dc->DrawText(propertylist, textRect, DT_NOPREFIX | DT_WORDBREAK | DT_CENTER);
+		renderer->DrawText(propertylist, textRect, DT_NOPREFIX | DT_WORDBREAK | DT_CENTER);
 		lines += (int)m_properties.GetSize();
 		r.top += height * (LONG)m_properties.GetSize();
 	}
@@ -207,8 +199,7 @@ void CUMLEntityClass::Draw(CDC* dc, CRect rect)
 	// Attributes
 	//
 
-	dc->MoveTo(rect.left, rect.top + height * lines + cut);
-	dc->LineTo(rect.right, rect.top + height * lines + cut);
+	renderer->Line(CPoint(rect.left, rect.top + height * lines + cut), CPoint(rect.right, rect.top + height * lines + cut));
 
 	INT_PTR max = GetAttributes();
 	int top = rect.top + cut + height * lines;
@@ -223,16 +214,11 @@ void CUMLEntityClass::Draw(CDC* dc, CRect rect)
 				if (!(GetDisplayOptions() & DISPLAY_ONLY_PUBLIC) || obj->access == ACCESS_TYPE_PUBLIC)
 				{
 					CString output = obj->ToString((GetDisplayOptions() & DISPLAY_NO_MARKERS));
-					if (obj->maintype & ENTITY_TYPE_STATIC && obj->maintype & ENTITY_TYPE_ABSTRACT)
-						dc->SelectObject(&fontUnderlineItalic);
-					else if (obj->maintype & ENTITY_TYPE_STATIC)
-						dc->SelectObject(&fontUnderline);
-					else if (obj->maintype & ENTITY_TYPE_ABSTRACT)
-						dc->SelectObject(&fontItalic);
-					else
-						dc->SelectObject(&font);
+					renderer->SetFont(GetFont(), -fontheight, FW_NORMAL,
+						(obj->maintype & ENTITY_TYPE_ABSTRACT) != 0,
+						(obj->maintype & ENTITY_TYPE_STATIC) != 0);
 
-					dc->DrawText(output, r, DT_SINGLELINE | DT_NOPREFIX);
+					renderer->DrawText(output, r, DT_SINGLELINE | DT_NOPREFIX);
 					top += height;
 				}
 			}
@@ -242,9 +228,9 @@ void CUMLEntityClass::Draw(CDC* dc, CRect rect)
 
 	if (GetAttributes() != GetVisibleAttributes())
 	{
-		dc->SelectObject(&font);
+		renderer->SetFont(GetFont(), -fontheight);
 		r.SetRect(rect.left + cut / 2, top, rect.right - cut / 2, top + height);
-		dc->DrawText(CString(_T("...")), r, DT_SINGLELINE | DT_NOPREFIX);
+		renderer->DrawText(CString(_T("...")), r, DT_SINGLELINE | DT_NOPREFIX);
 		top += height;
 	}
 
@@ -252,8 +238,7 @@ void CUMLEntityClass::Draw(CDC* dc, CRect rect)
 		top += height; // Empty dummy line
 
 	top += cut / 2;
-	dc->MoveTo(rect.left, top);
-	dc->LineTo(rect.right, top);
+	renderer->Line(CPoint(rect.left, top), CPoint(rect.right, top));
 
 	////////////////////////////////////////////////////////////////////
 	// Operations
@@ -270,16 +255,11 @@ void CUMLEntityClass::Draw(CDC* dc, CRect rect)
 			if (!(GetDisplayOptions() & DISPLAY_ONLY_PUBLIC) || obj->access == ACCESS_TYPE_PUBLIC)
 			{
 				CString output = obj->ToString((GetDisplayOptions() & DISPLAY_NO_MARKERS), (GetDisplayOptions() & DISPLAY_NO_OPERATION_ATTRIBUTE_NAMES));
-				if (obj->maintype & ENTITY_TYPE_STATIC && obj->maintype & ENTITY_TYPE_ABSTRACT)
-					dc->SelectObject(&fontUnderlineItalic);
-				else if (obj->maintype & ENTITY_TYPE_STATIC)
-					dc->SelectObject(&fontUnderline);
-				else if (obj->maintype & ENTITY_TYPE_ABSTRACT)
-					dc->SelectObject(&fontItalic);
-				else
-					dc->SelectObject(&font);
-
-				dc->DrawText(output, r, DT_SINGLELINE | DT_NOPREFIX);
+				renderer->SetFont(GetFont(), -fontheight, FW_NORMAL,
+					(obj->maintype & ENTITY_TYPE_ABSTRACT) != 0,
+					(obj->maintype & ENTITY_TYPE_STATIC) != 0);
+
+				renderer->DrawText(output, r, DT_SINGLELINE | DT_NOPREFIX);
 				top += height;
 			}
 
@@ -288,20 +268,11 @@ void CUMLEntityClass::Draw(CDC* dc, CRect rect)
 
 	if (GetOperations() != GetVisibleOperations())
 	{
-		dc->SelectObject(&font);
+		renderer->SetFont(GetFont(), -fontheight);
 		r.SetRect(rect.left + cut / 2, top, rect.right - cut / 2, top + height);
-		dc->DrawText(CString(_T("...")), r, DT_SINGLELINE | DT_NOPREFIX);
+		renderer->DrawText(CString(_T("...")), r, DT_SINGLELINE | DT_NOPREFIX);
 	}
 
-	////////////////////////////////////////////////////////////////////
-	// Clean up
-	//
-
-	dc->SelectObject(oldfont);
-	dc->SelectStockObject(BLACK_PEN);
-	dc->SelectStockObject(WHITE_BRUSH);
-	dc->SetBkMode(mode);
-
 }
 
 CDiagramEntity* CUMLEntityClass::Clone()
@@ -359,6 +330,30 @@ CDiagramEntity* CUMLEntityClass::CreateFromString(const CString& str)
 
 }
 
+CUMLEntityClass* CUMLEntityClass::Cast(CDiagramEntity* obj)
+/* ============================================================
+	Function :		CUMLEntityClass::Cast
+	Description :	Casts "obj" to a "CUMLEntityClass" pointer,
+					using the kind tag instead of RTTI.
+	Access :		Public
+
+	Return :		CUMLEntityClass*	-	"obj", or "NULL" if "obj" is
+						not a class.
+	Parameters :	CDiagramEntity* obj	-	Object to cast.
+
+	Usage :			Use instead of "dynamic_cast" in loops over
+					the container data.
+
+   ============================================================*/
+{
+
+	if (obj && obj->IsKind(KIND_UML_CLASS))
+		return static_cast<CUMLEntityClass*>(obj);
+
+	return NULL;
+
+}
+
 BOOL CUMLEntityClass::FromString(const CString& str)
 /* ============================================================
 	Function :		CUMLEntityClass::FromString
@@ -692,6 +687,8 @@ void CUMLEntityClass::CalcRestraints()
    ============================================================*/
 {
 
+	DIAGRAM_TRACE_SPAN(_T("CUMLEntityClass::CalcRestraints"));
+
 	int titlewidth = 0;
 	if (GetTitle().GetLength() && AfxGetMainWnd())
 	{
@@ -731,7 +728,7 @@ void CUMLEntityClass::CalcRestraints()
 	CUMLEntityContainer* container = GetUMLContainer();
 	if (container)
 	{
-		CSize sz = container->CalcMinimumRestraints(GetName());
+		CSize sz = container->CalcMinimumRestraints(GetID());
 		if (sz.cx > totalheight)
 			totalheight = sz.cx;
 		if (sz.cy > totalwidth)
@@ -1679,9 +1676,6 @@ BOOL CUMLEntityClass::DoMessage(UINT msg, CDiagramEntity* sender, CWnd* from)
 
 }
 
-#define STATE_STARTING	0
-#define STATE_READING	1
-
 BOOL CUMLEntityClass::ImportH(const CString& filename)
 /* ============================================================
 	Function :		CUMLEntityClass::ImportH
@@ -1695,424 +1689,170 @@ BOOL CUMLEntityClass::ImportH(const CString& filename)
 												file.
 
 	Usage :			Call to import data for this object from a
-					c++ header-file.
+					c++ header-file. The class named as the file
+					is imported, or the first class if there is
+					no such class. The header is read with
+					"CHeaderParser", so a declaration that can't
+					be read is skipped - the rest of the class
+					is still imported, and the first error is
+					displayed.
 
    ============================================================*/
 {
 
-	CTextFile		file(_T(""), _T("\n"));;
+	CTextFile		file(_T(""), _T("\n"));
 	CString			localfilename(filename);
 	CString			str;
 	if (file.ReadTextFile(localfilename, str))
 	{
-		// Clear the class, only if we can open the file
-		ClearAttributes();
-		ClearOperations();
-		ClearProperties();
+		CHeaderParser parser;
+		BOOL result = parser.Parse(str, str.GetLength());
 
-		int comment = str.Find(_T("/*"));
-		while (comment != -1)
-		{
-			int endcomment = str.Find(_T("*/"));
-			if (endcomment != -1)
-				str = str.Left(comment) + str.Right(str.GetLength() - (endcomment + 2));
-			else
-			{
-				CString err;
-				if (err.LoadString(IDS_UML_MALFORMED_COMMENT) > 0)
-				{
-					GetUMLContainer()->SetErrorMessage(err);
-				}
+		CString title = localfilename.Mid(localfilename.ReverseFind(_TCHAR('\\')) + 1);
+		int found = title.ReverseFind(_TCHAR('.'));
+		if (found != -1)
+			title = title.Left(found);
 
-				return FALSE;
-			}
-
-			comment = str.Find(_T("/*"));
-		}
+		CHeaderClass* cls = parser.FindClass(title);
 
-		CTokenizer tok(str, _T("\n"));
-		CStringArray classContents;
-		INT_PTR max = tok.GetSize();
-		int state = STATE_STARTING;
-		int rb = 0;
-		for (INT_PTR t = 0; t < max; t++)
+		// Clear the class, only if there is something to import
+		if (cls)
 		{
-			CString data;
-			tok.GetAt(t, data);
-			data.TrimLeft();
-			int found = data.Find(_T("//"));
-			if (found != -1)
-				data = data.Left(found);
-			data.TrimRight();
-			if (data.GetLength())
-			{
-				switch (state)
-				{
-				case STATE_STARTING:
-					if (data.Left(6) == _T("class ") && data[data.GetLength() - 1] != _TCHAR(';'))
-					{
-						if (data.Find(_TCHAR('{')) != -1)
-							rb++;
-						state = STATE_READING;
-						classContents.Add(data);
-					}
-					break;
-				case STATE_READING:
-					if (data.Find(_TCHAR('{')) != -1)
-						rb++;
-					if (data.Find(_TCHAR('}')) != -1)
-						rb--;
-
-					if (rb && data.GetLength() && data[0] != _TCHAR('#'))
-						classContents.Add(data);
-
-					break;
-				}
-			}
+			ImportClass(cls);
+			CalcRestraints();
 		}
 
-		// Now, we assemble the cleaned contents into one single string,
-		// to be able to clear out inline functions.
-		max = classContents.GetSize();
-		str = _T("");
-		for (int t = 0; t < max; t++)
-			str += classContents[t] + _T("\n");
-		int leftbracket = str.Find(_TCHAR('{'));
-		// We must remove the first bracket found
-		if (leftbracket != -1)
-			str = str.Left(leftbracket) + str.Right(str.GetLength() - (leftbracket + 1));
-
-		leftbracket = str.Find(_TCHAR('{'));
-		while (leftbracket != -1)
+		if (!result)
 		{
-			// See if the inline function is in or after the class definition
-			int rightbracket = str.Find(_T("};"));
-			if (rightbracket != -1)
+			const CHeaderError& error = parser.GetError(0);
+			UINT id = IDS_UML_UNKNOWN_DECLARATION;
+			if (error.code == HEADER_ERROR_COMMENT)
+				id = IDS_UML_MALFORMED_COMMENT;
+			else if (error.code == HEADER_ERROR_BRACKET)
+				id = IDS_UML_MISSING_BRACKET;
+
+			CString message;
+			if (message.LoadString(id) > 0)
 			{
-				CString str1 = str.Left(leftbracket);
-				CString str2 = str.Right(str.GetLength() - (rightbracket + 1));
-				str = str1 + str2;
-			}
-			else
-			{
-				str = str.Left(leftbracket);
+				CString err;
+				err.Format(_T("%s(%d,%d): %s"), static_cast<LPCTSTR>(title), error.line, error.column, static_cast<LPCTSTR>(message));
+				AfxMessageBox(err);
 			}
-
-			leftbracket = str.Find(_TCHAR('{'));
 		}
 
-		// To make sure declarations are ended with a ";"
-		str.Replace(_T("\n;"), _T(";"));
+		return result && cls != NULL;
+	}
 
-		// Now, we tokenize again
-		CString className;
-		CString baseClass;
+	// Display the error message
+	AfxMessageBox(file.GetErrorMessage());
+	return FALSE;
+}
 
-		tok.Init(str, _T("\n"));
-		max = tok.GetSize();
-		classContents.RemoveAll();
-		for (int t = 0; t < max; t++)
-		{
-			CString data;
-			tok.GetAt(t, data);
-			data.TrimRight();
+void CUMLEntityClass::ImportClass(const CHeaderClass* cls)
+/* ============================================================
+	Function :		CUMLEntityClass::ImportClass
+	Description :	Replaces the contents of this object with
+					a class read from a header file.
+	Access :		Public
 
-			if (data.GetLength())
-			{
-				data.Replace(_TCHAR('\t'), _TCHAR(' '));
-				data.Replace(_T(" *"), _T("*"));
-				data.Replace(_T(" &"), _T("&"));
-				data.Replace(_T(" ("), _T("("));
-				data.Replace(_T("( "), _T("("));
-				data.Replace(_T(" )"), _T(")"));
-				data.Replace(_T(" ;"), _T(";"));
-				data.Replace(_T(" ["), _T("["));
-				data.Replace(_T(" ]"), _T("]"));
-				data.Replace(_T(" ="), _T("="));
-				data.Replace(_T("= "), _T("="));
-
-				data.Replace(_T("*"), _T("* "));
-				data.Replace(_T("&"), _T("& "));
-
-				data.Replace(_T("  "), _T(" "));
-				data.Replace(_T("  "), _T(" "));
-
-				if (t == 0)
-				{
-					// The first line should contain the class name
-					int colon = data.Find(_TCHAR(':'));
-					if (colon != -1)
-					{
-						baseClass = data.Right(data.GetLength() - (colon + 1));
-						className = data.Left(colon);
-						className = className.Right(className.GetLength() - 5); // remove 'class'
-						className.TrimLeft();
-						className.TrimRight();
-						baseClass.TrimLeft();
-						baseClass.TrimRight();
-					}
-					else
-						className = data.Right(data.GetLength() - 5); // remove 'class'
-				}
-				else
-				{
-					if (data[data.GetLength() - 1] == _TCHAR(';') || data[data.GetLength() - 1] == _TCHAR(':'))
-						// We want to keep only access markers and declarations
-						classContents.Add(data);
+	Return :		void
+	Parameters :	const CHeaderClass* cls	-	Class to import.
 
-				}
-			}
-		}
+	Usage :			Used when importing a folder of headers.
+					Call before the object is added to the
+					container, so the size is calculated
+					once.
 
-		if (className.IsEmpty())
-		{
-			return FALSE;
-		}
+   ============================================================*/
+{
+
+	ClearAttributes();
+	ClearOperations();
+	ClearProperties();
 
-		// Now, we are left with a list of the declarations and access markers from the header file. Now, we will start to create attributes and operations from those. We will recognize an operation as it will have a paranthesis somewhere in the string.
-		max = classContents.GetSize();
-		int access = ACCESS_TYPE_PRIVATE;
-		for (int t = 0; t < max; t++)
+	INT_PTR max = cls->members.GetSize();
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		const CHeaderMember* member = static_cast<const CHeaderMember*>(cls->members.GetAt(t));
+		if (member->operation)
 		{
-			CString data = classContents[t];
-			if (data[data.GetLength() - 1] == _TCHAR(':'))
-			{
-				// An access marker
-				if (data == _T("private:"))
-					access = ACCESS_TYPE_PRIVATE;
-				else if (data == _T("protected:"))
-					access = ACCESS_TYPE_PROTECTED;
-				else if (data == _T("public:"))
-					access = ACCESS_TYPE_PUBLIC;
-			}
-			else if (data.Find(_TCHAR('(')) != -1)
+			COperation* op = new COperation;
+			op->access = member->access;
+			op->name = member->name;
+			op->type = member->type;
+			if (member->isStatic)
+				op->maintype |= ENTITY_TYPE_STATIC;
+			if (member->isAbstract)
+				op->maintype |= ENTITY_TYPE_ABSTRACT;
+			if (member->isVirtual)
+				op->properties.Add(_T("virtual"));
+			if (member->isConst)
+				op->properties.Add(_T("query"));
+
+			INT_PTR size = member->parameters.GetSize();
+			for (INT_PTR i = 0; i < size; i++)
 			{
-				// A member function
-				COperation* op = new COperation;
-				op->access = access;
-
-				// Get the main type of the function
-				CString afxmsgmarker(_T("afx_msg "));
-				int afxmsgmarkerfound = data.Find(afxmsgmarker);
-				if (afxmsgmarkerfound != -1)
-					data = data.Left(afxmsgmarkerfound) + data.Right(data.GetLength() - (afxmsgmarkerfound + afxmsgmarker.GetLength()));
-
-				CString virtualmarker(_T("virtual "));
-				int virtualmarkerfound = data.Find(virtualmarker);
-				if (virtualmarkerfound != -1)
+				const CHeaderParameter* source = static_cast<const CHeaderParameter*>(member->parameters.GetAt(i));
+				CParameter* param = new CParameter;
+				param->name = source->name;
+				param->defaultvalue = source->defaultvalue;
+				param->in = TRUE;
+				param->out = FALSE;
+
+				// "const", "&" and one "*" are flags of the parameter
+				CString type = source->type;
+				if (type.Left(6) == _T("const "))
 				{
-					data = data.Left(virtualmarkerfound) + data.Right(data.GetLength() - (virtualmarkerfound + virtualmarker.GetLength()));
-					op->properties.Add(_T("virtual"));
+					type = type.Right(type.GetLength() - 6);
+					param->constant = TRUE;
 				}
 
-				CString staticmarker(_T("static "));
-				int staticmarkerfound = data.Find(staticmarker);
-				if (staticmarkerfound != -1)
+				int length = type.GetLength();
+				if (length > 1 && type[length - 1] == _TCHAR('&') && type[length - 2] != _TCHAR('&'))
 				{
-					data = data.Left(staticmarkerfound) + data.Right(data.GetLength() - (staticmarkerfound + staticmarker.GetLength()));
-					op->maintype |= ENTITY_TYPE_STATIC;
+					type = type.Left(length - 1);
+					param->reference = TRUE;
+					param->out = !param->constant;
 				}
-
-				// Get the return value of the function
-				int space = data.Find(_TCHAR(' '));
-				int paramstart = data.Find(_TCHAR('('));
-				if (space != -1 && paramstart > space)
-				{
-					CString type = data.Left(space);
-					data = data.Right(data.GetLength() - (space + 1));
-					if (type == _T("void"))
-						type = _T("");
-
-					op->type = type;
-				}
-
-				// Strip away class names prefixing the function name
-				if (data.GetLength() > className.GetLength() + 2)
-				{
-					if (data.Left(className.GetLength() + 2) == CString(className + _T("::")))
-						data = data.Right(data.GetLength() - (className.GetLength() + 2));
-				}
-
-				paramstart = data.Find(_TCHAR('('));
-				if (paramstart != -1)
-				{
-					CString name = data.Left(paramstart);
-					data = data.Right(data.GetLength() - (paramstart + 1));
-					op->name = name;
-				}
-
-				//////////////////////////////////////////////////////
-				// Function parameters
-				// 
-				int paramend = data.ReverseFind(_TCHAR(')'));
-				if (paramend != -1)
+				else if (length > 1 && type[length - 1] == _TCHAR('*'))
 				{
-					CString params = data.Left(paramend);
-					data = data.Right(data.GetLength() - (paramend + 1));
-					int paramlen = params.GetLength();
-					if (paramlen)
-					{
-						tok.Init(params, _T(","), _T("<"), _T(">"));
-						INT_PTR size = tok.GetSize();
-						for (INT_PTR i = 0; i < size; i++)
-						{
-							CString param;
-							tok.GetAt(i, param);
-							param.TrimLeft();
-							param.TrimRight();
-							int space = param.ReverseFind(_TCHAR(' '));
-							if (space != -1)
-							{
-								CString type = param.Left(space);
-								CString name = param.Right(param.GetLength() - (space + 1));
-								CString defval;
-								int eq = name.Find(_TCHAR('='));
-								if (eq != -1)
-								{
-									defval = name.Right(name.GetLength() - (eq + 1));
-									name = name.Left(eq);
-								}
-
-								CParameter* param = new CParameter;
-								param->name = name;
-								param->defaultvalue = defval;
-								param->in = TRUE;
-
-								param->out = FALSE;
-								if (type.Remove(_TCHAR('&')))
-								{
-									param->out = TRUE;
-									param->reference = TRUE;
-								}
-
-								if (type.Remove(_TCHAR('*')))
-									param->out = TRUE;
-
-								CString constmarker(_T("const "));
-								int constmarkerfound = type.Find(constmarker);
-								if (constmarkerfound != -1)
-								{
-									type = type.Left(constmarkerfound) + type.Right(type.GetLength() - (constmarkerfound + constmarker.GetLength()));
-									param->out = FALSE;
-									param->constant = TRUE;
-								}
-
-								param->type = type;
-								op->parameters.Add(param);
-
-							}
-						}
-					}
+					type = type.Left(length - 1);
+					param->out = TRUE;
 				}
 
-				CString constmarker(_T("const"));
-				int constmarkerfound = data.Find(constmarker);
-				if (constmarkerfound != -1)
-				{
-					data = data.Left(constmarkerfound) + data.Right(data.GetLength() - (constmarkerfound + constmarker.GetLength()));
-					op->properties.Add(_T("query"));
-				}
-
-				CString virtmarker(_T("=0"));
-				int virtmarkerfound = data.Find(virtmarker);
-				if (virtmarkerfound != -1)
-				{
-					data = data.Left(virtmarkerfound) + data.Right(data.GetLength() - (virtmarkerfound + virtmarker.GetLength()));
-					op->maintype |= ENTITY_TYPE_ABSTRACT;
-				}
-
-				AddOperation(op);
+				type.TrimRight();
+				param->type = type;
+				op->parameters.Add(param);
 			}
-			else
-			{
-				// A member variable
-				// Parse into type and name
-				data = data.Left(data.GetLength() - 1); // remove semicolon
-				int space = data.Find(_TCHAR(' '));
-				if (space != -1)
-				{
-					CAttribute* attr = new CAttribute;
-					attr->maintype = ENTITY_TYPE_NONE;
-
-					CString staticmarker(_T("static "));
-					int staticmarkerfound = data.Find(staticmarker);
-					if (staticmarkerfound != -1)
-					{
-						data = data.Left(staticmarkerfound) + data.Right(data.GetLength() - (staticmarkerfound + staticmarker.GetLength()));
-						attr->maintype |= ENTITY_TYPE_STATIC;
-					}
 
-					// See if there is an end angle bracked (i.e. this is a map)
-					int escapeStart = data.Find(_TCHAR('<'));
-					int escapeEnd = -1;
-					if (escapeStart > -1)
-					{
-						escapeEnd = data.Find(_TCHAR('>'), escapeStart);
-					}
-
-					// Look for the space
-					int space = data.Find(_TCHAR(' '));
-
-					// Make sure the delimiter is after the escape end
-					if (space < escapeEnd)
-					{
-						space = data.Find(_TCHAR(' '), escapeEnd);
-					}
-
-					// Get the type
-					CString type = data.Left(space);
-					CString name = data.Right(data.GetLength() - (space + 1));
-					int bracket = name.Find(_TCHAR('['));
-					if (bracket != -1)
-					{
-						CString multiplicity = name.Right(name.GetLength() - (bracket + 1));
-						name = name.Left(bracket);
-						if (multiplicity.GetLength())
-							multiplicity = multiplicity.Left(multiplicity.GetLength() - 1); // Removing closing bracket
-						attr->multiplicity = multiplicity;
-					}
-
-					attr->access = access;
-					attr->name = name;
-					attr->type = type;
-
-					AddAttribute(attr);
-				}
-			}
+			AddOperation(op);
 		}
-
-		SetTitle(className);
-
-		if (baseClass.GetLength())
+		else
 		{
-			CString base;
-			CTokenizer tok(baseClass);
-			INT_PTR max = tok.GetSize();
-			for (INT_PTR t = 0; t < max; t++)
-			{
-				CString cls;
-				tok.GetAt(t, cls);
-				cls.TrimLeft();
-				int find = cls.Find(_TCHAR(' '));
-				if (find != -1)
-					cls = cls.Right(cls.GetLength() - (find + 1));
-				cls.TrimLeft();
-				cls.TrimRight();
-				base += cls + _T(" ");
-			}
-
-			base.TrimRight();
-			GetProperties()->Add(_T("baseClass"), base);
-
+			CAttribute* attr = new CAttribute;
+			attr->maintype = member->isStatic ? ENTITY_TYPE_STATIC : ENTITY_TYPE_NONE;
+			attr->access = member->access;
+			attr->name = member->name;
+			attr->type = member->type;
+			attr->multiplicity = member->multiplicity;
+			attr->defaultvalue = member->defaultvalue;
+			AddAttribute(attr);
 		}
+	}
 
-		CalcRestraints();
-		return TRUE;
+	if (cls->baseClasses.GetSize())
+	{
+		CString base;
+		max = cls->baseClasses.GetSize();
+		for (INT_PTR t = 0; t < max; t++)
+			base += cls->baseClasses[t] + _T(" ");
+
+		base.TrimRight();
+		GetProperties()->Add(_T("baseClass"), base);
 	}
 
-	// Display the error message
-	AfxMessageBox(file.GetErrorMessage());
-	return FALSE;
+	SetTitle(cls->name);
+
 }
 
 void CUMLEntityClass::SetTitle(CString title)
@@ -2142,6 +1882,81 @@ void CUMLEntityClass::SetTitle(CString title)
 
 }
 
+static void AddPropertyMemoryUsage(CDiagramMemoryUsage& usage, const CPropertyContainer& properties)
+{
+	INT_PTR max = properties.GetSize();
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		CProperty* property = properties.GetAt(t);
+		usage.Add(_T("UML members"), _T("Properties"), 1, sizeof(CProperty) + sizeof(CObject*));
+		usage.AddString(property->key);
+		usage.AddString(property->value);
+	}
+}
+
+void CUMLEntityClass::GetMemoryUsage(CDiagramMemoryUsage& usage) const
+/* ============================================================
+	Function :		CUMLEntityClass::GetMemoryUsage
+	Description :	Adds the memory held by the object to
+					"usage".
+	Access :		Public
+
+	Return :		void
+	Parameters :	CDiagramMemoryUsage& usage	-	Breakdown
+													to add to.
+
+	Usage :			Called by the container. Attributes,
+					operations, parameters and properties are
+					counted under "UML members", including
+					their slot in the owning array.
+
+   ============================================================*/
+{
+
+	CUMLEntity::GetMemoryUsage(usage);
+	usage.AddStrings(m_baseClassArray);
+	usage.AddStrings(m_baseClassAccessArray);
+	usage.AddStrings(m_baseClassFilenameArray);
+	usage.AddString(m_filename);
+	AddPropertyMemoryUsage(usage, m_properties);
+
+	INT_PTR max = m_attributes.GetSize();
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		CAttribute* attribute = m_attributes.GetAt(t);
+		usage.Add(_T("UML members"), _T("Attributes"), 1, sizeof(CAttribute) + sizeof(CObject*));
+		usage.AddString(attribute->name);
+		usage.AddString(attribute->type);
+		usage.AddString(attribute->multiplicity);
+		usage.AddString(attribute->defaultvalue);
+		usage.AddString(attribute->stereotype);
+		AddPropertyMemoryUsage(usage, attribute->properties);
+	}
+
+	max = m_operations.GetSize();
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		COperation* operation = m_operations.GetAt(t);
+		usage.Add(_T("UML members"), _T("Operations"), 1, sizeof(COperation) + sizeof(CObject*));
+		usage.AddString(operation->name);
+		usage.AddString(operation->type);
+		usage.AddString(operation->stereotype);
+		usage.AddString(operation->getsetvariable);
+		AddPropertyMemoryUsage(usage, operation->properties);
+
+		INT_PTR parameters = operation->parameters.GetSize();
+		for (INT_PTR i = 0; i < parameters; i++)
+		{
+			CParameter* parameter = operation->parameters.GetAt(i);
+			usage.Add(_T("UML members"), _T("Parameters"), 1, sizeof(CParameter) + sizeof(CObject*));
+			usage.AddString(parameter->name);
+			usage.AddString(parameter->defaultvalue);
+			usage.AddString(parameter->type);
+		}
+	}
+
+}
+
 CString CUMLEntityClass::GetIncludeList() const
 /* ============================================================
 	Function :		CUMLEntityClass::GetIncludeList
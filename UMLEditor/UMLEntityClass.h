@@ -10,9 +10,15 @@
 #include "PropertyContainer.h"
 #include "OperationContainer.h"
 #include "AttributeContainer.h"
+#include "../DiagramEditor/ObjectPool.h"
+
+class CHeaderClass;
 
 class CUMLEntityClass : public CUMLEntity
 {
+	DECLARE_POOLED_ALLOC(CUMLEntityClass)
+	DECLARE_ENTITY_SIZE(CUMLEntityClass)
+
 
 public:
 // Construction/initialization/destruction
@@ -20,9 +26,10 @@ public:
 	virtual ~CUMLEntityClass();
 	virtual CDiagramEntity* Clone();
 	static	CDiagramEntity* CreateFromString( const CString& str );
+	static	CUMLEntityClass* Cast(CDiagramEntity* obj);
 
 // Overrides
-	virtual void Draw( CDC* dc, CRect rect );
+	virtual void Render( CDiagramRenderer* renderer, CRect rect );
 
 	virtual CString GetString() const;
 	virtual BOOL	FromString( const CString& str );
@@ -31,6 +38,7 @@ public:
 	virtual BOOL	DoMessage( UINT msg, CDiagramEntity* sender, CWnd* from = NULL );
 	virtual int		GetMenuResourceId() const;
 	virtual void	SetTitle( CString title );
+	virtual void	GetMemoryUsage( CDiagramMemoryUsage& usage ) const;
 
 // Implementation
 	INT_PTR	GetAttributes() const;
@@ -44,6 +52,7 @@ public:
 
 	void AddAttribute( CAttribute* obj );
 	void AddOperation( COperation* obj );
+	virtual void ImportClass( const CHeaderClass* cls );
 
 	virtual void CalcRestraints();
 
@@ -6,6 +6,8 @@
 
 class CUMLEntityClassTemplate : public CUMLEntityClass
 {
+	DECLARE_ENTITY_SIZE(CUMLEntityClassTemplate)
+
 public:
 	CUMLEntityClassTemplate();
 	~CUMLEntityClassTemplate();
@@ -14,13 +16,14 @@ public:
 	virtual CDiagramEntity* Clone();
 	static	CDiagramEntity* CreateFromString(const CString& str);
 
-	virtual void Draw(CDC* dc, CRect rect);
+	virtual void Render(CDiagramRenderer* renderer, CRect rect);
 
 	virtual CString GetString() const;
 	virtual BOOL	FromString(const CString& str);
 	virtual void	Copy(CDiagramEntity* obj);
 	virtual CString	Export(UINT format = 0) const;
-	virtual BOOL	ImportH(const CString& filename);
+	virtual void	ImportClass(const CHeaderClass* cls);
+	virtual void	GetMemoryUsage(CDiagramMemoryUsage& usage) const;
 
 	// Implementation
 	void SetParameterType(const CString& parameterType);
@@ -25,14 +25,47 @@
    ========================================================================
 					5/8 2004	Added support for private and protected
 								base classes through line stereotypes.
+   ========================================================================
+					19/10 2026	The current package is interned, and names,
+								packages and links are compared with
+								CStringTable::IsEqual.
+					19/10 2026	Objects are identified by kind tags instead
+								of "dynamic_cast". Added the GetSegments and
+								GetNodes views.
+					19/10 2026	Added AutoLayout.
+					19/10 2026	Added RouteLines.
+					19/10 2026	AdjustLinkedObjects uses a worklist instead
+								of recursion.
+					19/10 2026	Undo history is unlimited, with older levels
+								spilled to disk.
+					19/10 2026	Diagrams with packages are saved as a
+								manifest and one file per package. Package
+								files are read when the package is opened,
+								and only changed packages are written.
+					19/10 2026	Added GetMemoryUsage
+					19/10 2026	Added ImportFolder, adding the classes of
+								a folder of header files as packages.
+					19/10 2026	Package files are only used when asked for
+								with SetPackageFiles, and are named from a
+								cleaned package name and its hash.
+					19/10 2026	Line segments are linked by numeric ids,
+								found through the id index of the base
+								class.
    ========================================================================*/
 
 #include "stdafx.h"
 #include "UMLEntityContainer.h"
 #include "UMLControlFactory.h"
+#include "LinkFactory.h"
 #include "../DiskObject/DiskObject.h"
 #include "../TextFile/TextFile.h"
 #include "UMLEntityInterface.h"
+#include "UMLEntityPackage.h"
+#include "UMLEntityClassTemplate.h"
+#include "HeaderImport.h"
+#include "../DiagramEditor/LayeredLayout.h"
+#include "../DiagramEditor/LinkRouter.h"
+#include "../DiagramEditor/DiagramTrace.h"
 
 #include <math.h>
 
@@ -44,6 +77,15 @@ static char THIS_FILE[] = __FILE__;
 
 #pragma warning( disable : 4706 )
 
+// Times "AdjustLinkedObjects" follows an object
+#define MAX_ADJUST_VISITS	4
+
+// Space around the objects added by "ImportFolder"
+#define IMPORT_MARGIN		16
+
+// Characters of the package name kept in the name of its file
+#define PACKAGE_FILE_NAME_LENGTH	64
+
 CUMLEntityContainer::CUMLEntityContainer()
 /* ============================================================
 	Function :		CUMLEntityContainer::CUMLEntityContainer
@@ -59,8 +101,12 @@ CUMLEntityContainer::CUMLEntityContainer()
 {
 
 	m_displayOptions = 0;
+	m_packageFiles = FALSE;
 
-	SetUndoStackSize(10);
+	// Older undo levels are spilled to disk, so
+	// the history can be unlimited
+	SetEntityFactory(CUMLControlFactory::CreateFromString);
+	SetUndoStackSize(-1);
 
 }
 
@@ -102,7 +148,7 @@ void CUMLEntityContainer::RemoveAt(INT_PTR index)
 	if (obj)
 	{
 
-		CUMLLineSegment* line = dynamic_cast<CUMLLineSegment*>(obj);
+		CUMLLineSegment* line = CUMLLineSegment::Cast(obj);
 
 		if (line)
 		{
@@ -110,12 +156,10 @@ void CUMLEntityContainer::RemoveAt(INT_PTR index)
 		}
 		else
 		{
-			CString link;
-
-			link = obj->GetName();
+			ULONGLONG link = obj->GetID();
 			for (INT_PTR t = GetSize() - 1; t >= 0; t--)
 			{
-				CUMLLineSegment* del = dynamic_cast<CUMLLineSegment*>(GetAt(t));
+				CUMLLineSegment* del = CUMLLineSegment::Cast(GetAt(t));
 				if (del)
 				{
 					if (del->GetLink(LINK_START) == link ||
@@ -130,6 +174,8 @@ void CUMLEntityContainer::RemoveAt(INT_PTR index)
 			index = Find(obj);
 			if (index != -1)
 			{
+				InvalidateBounds();
+				InvalidateObjectIDs();
 				GetData()->RemoveAt(index);
 				delete obj;
 			}
@@ -157,18 +203,18 @@ CUMLLineSegment* CUMLEntityContainer::GetNextSegment(CUMLLineSegment* from) cons
    ============================================================*/
 {
 	CUMLLineSegment* result = NULL;
-	CString name = from->GetLink(LINK_END);
-	if (name.GetLength())
-		result = dynamic_cast<CUMLLineSegment*>(GetNamedObject(name));
+	ULONGLONG id = from->GetLink(LINK_END);
+	if (id != LINK_ID_NONE)
+		result = CUMLLineSegment::Cast(GetNamedObject(id));
 	else
 	{
-		name = from->GetName();
+		id = from->GetID();
 		CUMLLineSegment* obj = NULL;
 		INT_PTR max = GetSize();
 		for (INT_PTR t = 0; t < max && result == NULL; t++)
 		{
-			obj = dynamic_cast<CUMLLineSegment*>(GetAt(t));
-			if (obj && obj->GetLink(LINK_START) == name)
+			obj = CUMLLineSegment::Cast(GetAt(t));
+			if (obj && obj->GetLink(LINK_START) == id)
 				return obj;
 		}
 	}
@@ -193,18 +239,18 @@ CUMLLineSegment* CUMLEntityContainer::GetPrevSegment(CUMLLineSegment* from) cons
    ============================================================*/
 {
 	CUMLLineSegment* result = NULL;
-	CString name = from->GetLink(LINK_START);
-	if (name.GetLength())
-		result = dynamic_cast<CUMLLineSegment*>(GetNamedObject(name));
+	ULONGLONG id = from->GetLink(LINK_START);
+	if (id != LINK_ID_NONE)
+		result = CUMLLineSegment::Cast(GetNamedObject(id));
 	else
 	{
-		name = from->GetName();
+		id = from->GetID();
 		CUMLLineSegment* obj = NULL;
 		INT_PTR max = GetSize();
 		for (INT_PTR t = 0; t < max && result == NULL; t++)
 		{
-			obj = dynamic_cast<CUMLLineSegment*>(GetAt(t));
-			if (obj && obj->GetLink(LINK_END) == name)
+			obj = CUMLLineSegment::Cast(GetAt(t));
+			if (obj && obj->GetLink(LINK_END) == id)
 				return obj;
 		}
 	}
@@ -295,6 +341,8 @@ void CUMLEntityContainer::DeleteLine(CUMLLineSegment* from)
 	{
 		int index = Find(obj);
 		next = GetNextSegment(obj);
+		InvalidateBounds();
+		InvalidateObjectIDs();
 		GetData()->RemoveAt(index);
 		delete obj;
 		obj = next;
@@ -328,7 +376,7 @@ CUMLEntity* CUMLEntityContainer::GetNamedObject(const CString& name) const
 	for (INT_PTR t = 0; t < max; t++)
 	{
 		test = GetObjectAt(t);
-		if (test->GetName() == name)
+		if (CStringTable::IsEqual(test->GetName(), name))
 			return test;
 	}
 
@@ -336,6 +384,33 @@ CUMLEntity* CUMLEntityContainer::GetNamedObject(const CString& name) const
 
 }
 
+CUMLEntity* CUMLEntityContainer::GetNamedObject(ULONGLONG id) const
+/* ============================================================
+	Function :		CUMLEntityContainer::GetNamedObject
+	Description :	Gets the object with the numeric id "id"
+					from the data container.
+	Access :		Public
+
+	Return :		CUMLEntity*		-	Result, "NULL" if not found.
+	Parameters :	ULONGLONG id	-	Id to search for, see
+										"CDiagramEntity::GetID".
+
+	Usage :			Call to get the object a line segment is
+					linked to. As "GetAt", only objects in the
+					current package are found, unless the
+					package name is set to 'all'.
+
+   ============================================================*/
+{
+
+	CUMLEntity* result = static_cast<CUMLEntity*>(GetObjectByID(id));
+	if (result && m_package != _T("all") && !CStringTable::IsEqual(result->GetPackage(), m_package))
+		result = NULL;
+
+	return result;
+
+}
+
 CUMLEntity* CUMLEntityContainer::GetTitledObject(const CString& name) const
 /* ============================================================
 	Function :		CUMLEntityContainer::GetTitledObject
@@ -367,30 +442,187 @@ CUMLEntity* CUMLEntityContainer::GetTitledObject(const CString& name) const
 
 }
 
-void CUMLEntityContainer::RemoveAllSelected()
+INT_PTR CUMLEntityContainer::RemoveIf(ENTITYPREDICATE predicate, LPVOID data)
 /* ============================================================
-	Function :		CUMLEntityContainer::RemoveAllSelected
-	Description :	Removes all selected objects in the
-					container.
+	Function :		CUMLEntityContainer::RemoveIf
+	Description :	Removes all objects in the current package
+					matching "predicate", together with all
+					lines attached to them.
 	Access :		Public
 
-	Return :		void
-	Parameters :	none
+	Return :		INT_PTR						-	The number of
+													removed objects.
+	Parameters :	ENTITYPREDICATE predicate	-	Function
+													returning "TRUE"
+													for objects to
+													remove.
+					LPVOID data					-	Passed to
+													"predicate".
+
+	Usage :			Overridden to remove linked segments as
+					well. If a segment matches, the complete
+					line it is a part of is removed, just as
+					for "RemoveAt". The links are indexed once,
+					so the cost is linear in the number of
+					objects.
+
+   ============================================================*/
+{
+
+	CObArray* objs = GetData();
+	INT_PTR max = objs->GetSize();
+	void* value;
+
+	// Index the segments by the ids they are linked to. Only
+	// objects in the current package are visible, as for
+	// "GetNamedObject".
+	CMapIDToPtr ends;
+	CMapIDToPtr starts;
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		CUMLEntity* obj = GetObjectAt(t);
+		if (obj == objs->GetAt(t))
+		{
+			CUMLLineSegment* line = CUMLLineSegment::Cast(obj);
+			if (line)
+			{
+				ULONGLONG end = line->GetLink(LINK_END);
+				ULONGLONG start = line->GetLink(LINK_START);
+				if (end != LINK_ID_NONE && !ends.Lookup(end, value))
+					ends.SetAt(end, line);
+				if (start != LINK_ID_NONE && !starts.Lookup(start, value))
+					starts.SetAt(start, line);
+			}
+		}
+	}
+
+	CMapPtrToPtr marked;
+	CMapPtrToPtr attached;
+	CMapIDToPtr removed;
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		CUMLEntity* obj = GetObjectAt(t);
+		if (obj == objs->GetAt(t) && predicate(obj, data))
+		{
+			CUMLLineSegment* line = CUMLLineSegment::Cast(obj);
+			if (line)
+			{
+				if (!marked.Lookup(line, value))
+					MarkLine(line, ends, starts, marked, attached);
+			}
+			else
+			{
+				marked.SetAt(obj, obj);
+				removed.SetAt(obj->GetID(), obj);
+			}
+		}
+	}
+
+	// Lines attached to removed objects must go as well
+	if (removed.GetCount())
+	{
+		for (INT_PTR t = 0; t < max; t++)
+		{
+			CUMLLineSegment* line = CUMLLineSegment::Cast(GetObjectAt(t));
+			if (line && line == objs->GetAt(t) && !marked.Lookup(line, value))
+			{
+				if (removed.Lookup(line->GetLink(LINK_START), value) ||
+					removed.Lookup(line->GetLink(LINK_END), value))
+					MarkLine(line, ends, starts, marked, attached);
+			}
+		}
+	}
+
+	INT_PTR result = RemoveMarked(marked);
+
+	// The remaining objects that lost a line
+	// must recalculate their restraints
+	POSITION pos = attached.GetStartPosition();
+	while (pos)
+	{
+		void* key;
+		attached.GetNextAssoc(pos, key, value);
+		if (!marked.Lookup(key, value))
+			static_cast<CUMLEntity*>(key)->CalcRestraints();
+	}
+
+	return result;
 
-	Usage :			Call to delete all selected objects in the
-					container. The function will also remove
-					attached links.
+}
+
+void CUMLEntityContainer::MarkLine(CUMLLineSegment* from, const CMapIDToPtr& ends, const CMapIDToPtr& starts, CMapPtrToPtr& marked, CMapPtrToPtr& attached) const
+/* ============================================================
+	Function :		CUMLEntityContainer::MarkLine
+	Description :	Marks all segments in the line containing
+					the line segment "from".
+	Access :		Private
+
+	Return :		void
+	Parameters :	CUMLLineSegment* from			-	Segment in the
+														line to mark.
+					const CMapIDToPtr& ends			-	Segments by
+														end link.
+					const CMapIDToPtr& starts		-	Segments by
+														start link.
+					CMapPtrToPtr& marked			-	Receives the
+														segments.
+					CMapPtrToPtr& attached			-	Receives the
+														objects at
+														the line ends.
+
+	Usage :			Internal function. The indexed counterpart
+					of "DeleteLine", used by "RemoveIf". The
+					segments are followed in the same way as
+					"GetPrevSegment" and "GetNextSegment" does.
 
    ============================================================*/
 {
 
-	for (INT_PTR t = GetSize() - 1; t >= 0; t--)
+	void* value;
+	INT_PTR guard = GetSize();
+
+	// Find the start segment
+	CUMLLineSegment* seg = from;
+	while (guard-- > 0)
 	{
-		if (GetAt(t)->IsSelected())
+		CUMLLineSegment* prev = NULL;
+		ULONGLONG link = seg->GetLink(LINK_START);
+		if (link != LINK_ID_NONE)
+			prev = CUMLLineSegment::Cast(GetNamedObject(link));
+		else if (ends.Lookup(seg->GetID(), value))
+			prev = static_cast<CUMLLineSegment*>(value);
+
+		if (!prev || prev == from)
+			break;
+		seg = prev;
+	}
+
+	CUMLEntity* start = GetNamedObject(seg->GetLink(LINK_START));
+	if (start)
+		attached.SetAt(start, start);
+
+	// Mark all segments to the end of the line
+	guard = GetSize();
+	while (seg && !marked.Lookup(seg, value) && guard-- > 0)
+	{
+		marked.SetAt(seg, seg);
+
+		CUMLLineSegment* next = NULL;
+		ULONGLONG link = seg->GetLink(LINK_END);
+		if (link != LINK_ID_NONE)
 		{
-			RemoveAt(t);
-			t = GetSize();
+			CUMLEntity* obj = GetNamedObject(link);
+			if (obj)
+			{
+				next = CUMLLineSegment::Cast(obj);
+				if (!next)
+					attached.SetAt(obj, obj);
+			}
 		}
+		else if (starts.Lookup(seg->GetID(), value))
+			next = static_cast<CUMLLineSegment*>(value);
+
+		seg = next;
 	}
 
 }
@@ -415,8 +647,7 @@ CUMLEntity* CUMLEntityContainer::GetStartNode(CUMLLineSegment* from) const
 	CUMLLineSegment* line = GetStartSegment(from);
 	if (line)
 	{
-		CString start = line->GetLink(LINK_START);
-		result = GetNamedObject(start);
+		result = GetNamedObject(line->GetLink(LINK_START));
 	}
 	return result;
 
@@ -443,8 +674,7 @@ CUMLEntity* CUMLEntityContainer::GetEndNode(CUMLLineSegment* from) const
 	CUMLLineSegment* line = GetEndSegment(from);
 	if (line)
 	{
-		CString end = line->GetLink(LINK_END);
-		result = GetNamedObject(end);
+		result = GetNamedObject(line->GetLink(LINK_END));
 	}
 	return result;
 
@@ -496,7 +726,7 @@ void CUMLEntityContainer::DeleteDanglingLines()
 
 	for (int t = 0; t < GetSize(); t++)
 	{
-		CUMLLineSegment* obj = dynamic_cast<CUMLLineSegment*>(GetAt(t));
+		CUMLLineSegment* obj = CUMLLineSegment::Cast(GetAt(t));
 		if (obj)
 		{
 			CUMLEntity* end = GetEndNode(obj);
@@ -537,7 +767,7 @@ CDiagramEntity* CUMLEntityContainer::GetAt(INT_PTR index) const
 	if (index < objs->GetSize() && index >= 0)
 	{
 		result = static_cast<CUMLEntity*>(objs->GetAt(index));
-		if (GetPackage() != _T("all") && result->GetPackage() != GetPackage())
+		if (m_package != _T("all") && !CStringTable::IsEqual(result->GetPackage(), m_package))
 			result = &(local->m_dummy);
 	}
 
@@ -558,11 +788,17 @@ void CUMLEntityContainer::SetPackage(const CString& package)
 					operations only work on things in the
 					current package. Note that if the package
 					is set to 'all', all objects are accessible.
+					If the diagram is saved as package files,
+					the file of the package is read the first
+					time it is set.
 
    ============================================================*/
 {
 
-	m_package = package;
+	m_package = GetStringTable()->Intern(package);
+	if (package != _T("all"))
+		LoadPackage(package);
+	InvalidateBounds();
 
 }
 
@@ -608,14 +844,84 @@ CUMLEntity* CUMLEntityContainer::GetObjectAt(INT_PTR index) const
 
 }
 
-void CUMLEntityContainer::AdjustLinkedObjects(CUMLEntity* in, CUMLEntity* filter)
+INT_PTR CUMLEntityContainer::GetSegments(CObArray& segments) const
+/* ============================================================
+	Function :		CUMLEntityContainer::GetSegments
+	Description :	Gets the line segments of the current
+					package.
+	Access :		Public
+
+	Return :		INT_PTR				-	Number of segments.
+	Parameters :	CObArray& segments	-	Gets the segments, in
+											z-order.
+
+	Usage :			Call to loop over the lines only, without
+					checking the type of every object. The
+					array is built in one pass using the kind
+					tags, and must be fetched again after the
+					container is changed.
+
+   ============================================================*/
+{
+
+	segments.RemoveAll();
+
+	INT_PTR max = GetSize();
+	segments.SetSize(0, max);
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		CUMLLineSegment* line = CUMLLineSegment::Cast(GetAt(t));
+		if (line)
+			segments.Add(line);
+	}
+
+	return segments.GetSize();
+
+}
+
+INT_PTR CUMLEntityContainer::GetNodes(CObArray& nodes) const
+/* ============================================================
+	Function :		CUMLEntityContainer::GetNodes
+	Description :	Gets the objects of the current package
+					that are not line segments.
+	Access :		Public
+
+	Return :		INT_PTR			-	Number of nodes.
+	Parameters :	CObArray& nodes	-	Gets the nodes, in
+										z-order.
+
+	Usage :			Call to loop over the classes, interfaces,
+					packages, notes and labels only. The array
+					must be fetched again after the container
+					is changed.
+
+   ============================================================*/
+{
+
+	nodes.RemoveAll();
+
+	INT_PTR max = GetSize();
+	nodes.SetSize(0, max);
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		CDiagramEntity* obj = GetAt(t);
+		if (obj && !obj->IsKind(KIND_UML_LINESEGMENT) && obj != &m_dummy)
+			nodes.Add(obj);
+	}
+
+	return nodes.GetSize();
+
+}
+
+int CUMLEntityContainer::AdjustLinkedObjects(CUMLEntity* in, CUMLEntity* filter)
 /* ============================================================
 	Function :		CUMLEntityContainer::AdjustLinkedObjects
 	Description :	Moves all objects in relation to "in",
 					skipping "filter".
 	Access :		Public
 
-	Return :		void
+	Return :		int					-	Number of objects
+											moved or resized.
 	Parameters :	CUMLEntity* in		-	Object to move in relation to
 					CUMLEntity* filter	-	Optional object to skip.
 
@@ -624,302 +930,307 @@ void CUMLEntityContainer::AdjustLinkedObjects(CUMLEntity* in, CUMLEntity* filter
 
    ============================================================*/
 {
-	CPoint point;
-	CPoint objpoint;
-	double posdiff = 0.0;
-	CString name = in->GetName();
-	CString link;
-	int linktype;
 
-	CUMLLineSegment* line = dynamic_cast<CUMLLineSegment*>(in);
-	if (line)
+	CObArray moved;
+	moved.Add(in);
+	return AdjustLinkedObjects(moved, filter);
+
+}
+
+int CUMLEntityContainer::AdjustLinkedObjects(const CObArray& moved, CUMLEntity* filter)
+/* ============================================================
+	Function :		CUMLEntityContainer::AdjustLinkedObjects
+	Description :	Moves all objects in relation to the
+					objects in "moved", skipping "filter".
+	Access :		Public
+
+	Return :		int						-	Number of objects
+												moved or resized.
+	Parameters :	const CObArray& moved	-	Objects to move in
+												relation to.
+					CUMLEntity* filter		-	Optional object
+												to skip.
+
+	Usage :			Call once with all the objects moved by an
+					operation, as the names and links are only
+					indexed once. The attached objects are
+					adjusted from a worklist, breadth first, so
+					long lines do not use up the stack. Objects
+					are followed at most "MAX_ADJUST_VISITS"
+					times, so cycles of lines always end. Only
+					the objects attached to "moved", directly
+					or through other adjusted objects, are
+					visited.
+
+   ============================================================*/
+{
+
+	DIAGRAM_TRACE_SPAN(_T("CUMLEntityContainer::AdjustLinkedObjects"));
+
+	void* value;
+
+	// Index the segment ends by the ids they are linked to.
+	// Entry "2 * n" is the start of segment "n", "2 * n + 1"
+	// the end, and "next" chains the entries linked to the
+	// same id.
+	CObArray segments;
+	INT_PTR count = GetSegments(segments);
+	CMapIDToPtr attached;
+	CArray< INT_PTR, INT_PTR > next;
+	next.SetSize(count * 2);
+	for (INT_PTR entry = count * 2 - 1; entry >= 0; entry--)
+	{
+		CUMLLineSegment* line = static_cast<CUMLLineSegment*>(segments[entry / 2]);
+		ULONGLONG link = line->GetLink((entry % 2) ? LINK_END : LINK_START);
+		next[entry] = -1;
+		if (link != LINK_ID_NONE)
+		{
+			if (attached.Lookup(link, value))
+				next[entry] = reinterpret_cast<INT_PTR>(value);
+			attached.SetAt(link, reinterpret_cast<void*>(entry));
+		}
+	}
+
+	// Each queued object is adjusted, and its attached objects
+	// follow it, except the object it followed itself
+	CObArray queue;
+	CObArray sources;
+	CMapPtrToPtr visits;
+	CMapPtrToPtr touched;
+	INT_PTR size = moved.GetSize();
+	for (INT_PTR t = 0; t < size; t++)
 	{
-		link = line->GetLink(LINK_END);
-		if (link.GetLength() && link != name)
+		queue.Add(moved[t]);
+		sources.Add(filter);
+	}
+
+	for (INT_PTR head = 0; head < queue.GetSize(); head++)
+	{
+		CUMLEntity* in = static_cast<CUMLEntity*>(queue[head]);
+		CUMLEntity* source = static_cast<CUMLEntity*>(sources[head]);
+
+		INT_PTR visited = 0;
+		if (visits.Lookup(in, value))
+			visited = reinterpret_cast<INT_PTR>(value);
+		if (visited >= MAX_ADJUST_VISITS)
+			continue;
+		visits.SetAt(in, reinterpret_cast<void*>(visited + 1));
+
+		ULONGLONG id = in->GetID();
+		CUMLLineSegment* line = CUMLLineSegment::Cast(in);
+		if (line)
 		{
-			CUMLEntity* obj = static_cast<CUMLEntity*>(GetNamedObject(link));
-			if (obj  && obj != filter && !obj->IsSelected())
+			for (int side = 0; side < 2; side++)
 			{
-				objpoint = line->GetLinkPosition(LINK_END);
-				linktype = line->GetLinkType(LINK_END);
-				if (linktype == LINK_TOP)
-				{
-					CPoint linkpoint = GetLinkPosition(obj, line);
-					posdiff = objpoint.x - linkpoint.x;
-					if (posdiff)
-					{
-						obj->MoveRect(posdiff, 0);
-						AdjustLinkedObjects(obj, in);
-					}
-				}
-				if (linktype == LINK_BOTTOM)
-				{
-					CPoint linkpoint = GetLinkPosition(obj, line);
-					posdiff = objpoint.x - linkpoint.x;
-					if (posdiff)
-					{
-						obj->MoveRect(posdiff, 0);
-						AdjustLinkedObjects(obj, in);
-					}
-				}
-				if (linktype == LINK_RIGHT)
-				{
-					CPoint linkpoint = GetLinkPosition(obj, line);
-					posdiff = objpoint.y - linkpoint.y;
-					if (posdiff)
-					{
-						obj->MoveRect(0, posdiff);
-						AdjustLinkedObjects(obj, in);
-					}
-				}
-				if (linktype == LINK_LEFT)
+				int end = side ? LINK_START : LINK_END;
+				ULONGLONG link = line->GetLink(end);
+				CUMLEntity* obj = NULL;
+				if (link != LINK_ID_NONE && link != id)
+					obj = GetNamedObject(link);
+				if (obj)
 				{
-					CPoint linkpoint = GetLinkPosition(obj, line);
-					posdiff = objpoint.y - linkpoint.y;
-					if (posdiff)
+					if (obj != source && !obj->IsSelected() && FollowSegment(obj, line, end))
 					{
-						obj->MoveRect(0, posdiff);
-						AdjustLinkedObjects(obj, in);
+						touched.SetAt(obj, obj);
+						queue.Add(obj);
+						sources.Add(in);
 					}
 				}
-				if (linktype == LINK_START)
-				{
-					CRect first = obj->GetRect();
-					obj->SetLeft(objpoint.x);
-					obj->SetTop(objpoint.y);
-					if (static_cast<CUMLLineSegment*>(obj)->IsHorizontal())
-						obj->SetBottom(obj->GetTop());
-					else
-						obj->SetRight(obj->GetLeft());
-					if (first != obj->GetRect())
-						AdjustLinkedObjects(obj, in);
-				}
-				if (linktype == LINK_END)
-				{
-					CRect first = obj->GetRect();
-					obj->SetRight(objpoint.x);
-					obj->SetBottom(objpoint.y);
-					if (static_cast<CUMLLineSegment*>(obj)->IsHorizontal())
-						obj->SetTop(obj->GetBottom());
-					else
-						obj->SetLeft(obj->GetRight());
-					if (first != obj->GetRect())
-						AdjustLinkedObjects(obj, in);
-				}
 			}
 		}
-
-		link = line->GetLink(LINK_START);
-		if (link.GetLength() && link != name)
+		else if (attached.Lookup(id, value))
 		{
-			CUMLEntity* obj = static_cast<CUMLEntity*>(GetNamedObject(link));
-			if (obj  && obj != filter && !obj->IsSelected())
+			for (INT_PTR entry = reinterpret_cast<INT_PTR>(value); entry != -1; entry = next[entry])
 			{
-				objpoint = line->GetLinkPosition(LINK_START);
-				linktype = line->GetLinkType(LINK_START);
-				if (linktype == LINK_TOP)
-				{
-					CPoint linkpoint = GetLinkPosition(obj, line);
-					posdiff = objpoint.x - linkpoint.x;
-					if (posdiff)
-					{
-						obj->MoveRect(posdiff, 0);
-						AdjustLinkedObjects(obj, in);
-					}
-				}
-				if (linktype == LINK_BOTTOM)
-				{
-					CPoint linkpoint = GetLinkPosition(obj, line);
-					posdiff = objpoint.x - linkpoint.x;
-					if (posdiff)
-					{
-						obj->MoveRect(posdiff, 0);
-						AdjustLinkedObjects(obj, in);
-					}
-				}
-				if (linktype == LINK_RIGHT)
-				{
-					CPoint linkpoint = GetLinkPosition(obj, line);
-					posdiff = objpoint.y - linkpoint.y;
-					if (posdiff)
-					{
-						obj->MoveRect(0, posdiff);
-						AdjustLinkedObjects(obj, in);
-					}
-				}
-				if (linktype == LINK_LEFT)
+				CUMLLineSegment* segment = static_cast<CUMLLineSegment*>(segments[entry / 2]);
+				if (segment != source && !segment->IsSelected() && FollowObject(segment, in, (entry % 2) ? LINK_END : LINK_START))
 				{
-					CPoint linkpoint = GetLinkPosition(obj, line);
-					posdiff = objpoint.y - linkpoint.y;
-					if (posdiff)
-					{
-						obj->MoveRect(0, posdiff);
-						AdjustLinkedObjects(obj, in);
-					}
-				}
-				if (linktype == LINK_START)
-				{
-					CRect first = obj->GetRect();
-					obj->SetLeft(objpoint.x);
-					obj->SetTop(objpoint.y);
-					if (static_cast<CUMLLineSegment*>(obj)->IsHorizontal())
-						obj->SetBottom(obj->GetTop());
-					else
-						obj->SetRight(obj->GetLeft());
-					if (first != obj->GetRect())
-						AdjustLinkedObjects(obj, in);
-				}
-				if (linktype == LINK_END)
-				{
-					CRect first = obj->GetRect();
-					obj->SetRight(objpoint.x);
-					obj->SetBottom(objpoint.y);
-					if (static_cast<CUMLLineSegment*>(obj)->IsHorizontal())
-						obj->SetTop(obj->GetBottom());
-					else
-						obj->SetLeft(obj->GetRight());
-					if (first != obj->GetRect())
-						AdjustLinkedObjects(obj, in);
+					touched.SetAt(segment, segment);
+					queue.Add(segment);
+					sources.Add(in);
 				}
 			}
 		}
 	}
-	else
-	{
-		CUMLEntity* obj = NULL;
-		int count = 0;
-		while ((obj = GetObjectAt(count++)))
-		{
-			if (obj->GetPackage() == GetPackage())
-			{
-				if (obj != in)
-				{
-					CUMLLineSegment* line = dynamic_cast<CUMLLineSegment*>(obj);
-					if (line)
-					{
-						link = line->GetLink(LINK_START);
-						if (link == name)
-						{
-							if (line && line != filter && !line->IsSelected())
-							{
-								linktype = line->GetLinkType(LINK_START);
-								objpoint = GetLinkPosition(in, line);
-								CRect first = line->GetRect();
-								if (linktype == LINK_RIGHT || linktype == LINK_LEFT)
-								{
-									line->SetTop(objpoint.y);
-									line->SetLeft(objpoint.x);
-
-									line->SetBottom(objpoint.y);
-								}
-								if (linktype == LINK_TOP || linktype == LINK_BOTTOM)
-								{
-									line->SetTop(objpoint.y);
-									line->SetLeft(objpoint.x);
-
-									line->SetRight(objpoint.x);
-								}
-
-								if (linktype == LINK_END)
-								{
-									line->SetLeft(objpoint.x);
-									line->SetTop(objpoint.y);
-									if (line->IsHorizontal())
-										line->SetBottom(objpoint.y);
-									else
-										line->SetRight(objpoint.x);
-								}
-
-								if (linktype == LINK_START)
-								{
-									line->SetRight(objpoint.x);
-									line->SetBottom(objpoint.y);
-									if (line->IsHorizontal())
-										line->SetTop(objpoint.y);
-									else
-										line->SetLeft(objpoint.x);
-								}
 
-								if (first != line->GetRect())
-									AdjustLinkedObjects(line, in);
-							}
-						}
+	return static_cast<int>(touched.GetCount());
 
-						link = line->GetLink(LINK_END);
-						if (link == name)
-						{
-							if (line && line != filter && !line->IsSelected())
-							{
-								objpoint = GetLinkPosition(in, line);
-								linktype = line->GetLinkType(LINK_END);
-								CRect first = line->GetRect();
-								if (linktype == LINK_RIGHT || linktype == LINK_LEFT)
-								{
-									line->SetBottom(objpoint.y);
-									line->SetRight(objpoint.x);
+}
 
-									line->SetTop(objpoint.y);
-								}
-								if (linktype == LINK_TOP || linktype == LINK_BOTTOM)
-								{
-									line->SetBottom(objpoint.y);
-									line->SetRight(objpoint.x);
+BOOL CUMLEntityContainer::FollowSegment(CUMLEntity* obj, CUMLLineSegment* line, int end)
+/* ============================================================
+	Function :		CUMLEntityContainer::FollowSegment
+	Description :	Moves "obj" to the end "end" of "line".
+	Access :		Private
 
-									line->SetLeft(objpoint.x);
-								}
+	Return :		BOOL					-	"TRUE" if "obj"
+												was changed.
+	Parameters :	CUMLEntity* obj			-	Object linked to
+												"line".
+					CUMLLineSegment* line	-	Segment to follow.
+					int end					-	"LINK_START" or
+												"LINK_END".
 
-								if (linktype == LINK_END)
-								{
-									line->SetLeft(objpoint.x);
-									line->SetTop(objpoint.y);
-									if (line->IsHorizontal())
-										line->SetBottom(objpoint.y);
-									else
-										line->SetRight(objpoint.x);
-								}
+	Usage :			Internal function, used by
+					"AdjustLinkedObjects". Objects are moved
+					along the side the line is attached to,
+					segments have their linked end moved.
 
-								if (linktype == LINK_START)
-								{
-									line->SetRight(objpoint.x);
-									line->SetBottom(objpoint.y);
-									if (line->IsHorizontal())
-										line->SetTop(objpoint.y);
-									else
-										line->SetLeft(objpoint.x);
-								}
+   ============================================================*/
+{
 
-								if (first != line->GetRect())
-									AdjustLinkedObjects(line, in);
-							}
-						}
-					}
-				}
-			}
+	CPoint objpoint = line->GetLinkPosition(end);
+	int linktype = line->GetLinkType(end);
+	if (linktype == LINK_TOP || linktype == LINK_BOTTOM)
+	{
+		CPoint linkpoint = GetLinkPosition(obj, line);
+		double posdiff = objpoint.x - linkpoint.x;
+		if (posdiff)
+		{
+			obj->MoveRect(posdiff, 0);
+			return TRUE;
+		}
+	}
+	if (linktype == LINK_RIGHT || linktype == LINK_LEFT)
+	{
+		CPoint linkpoint = GetLinkPosition(obj, line);
+		double posdiff = objpoint.y - linkpoint.y;
+		if (posdiff)
+		{
+			obj->MoveRect(0, posdiff);
+			return TRUE;
 		}
 	}
+	if (linktype == LINK_START)
+	{
+		CRect first = obj->GetRect();
+		obj->SetLeft(objpoint.x);
+		obj->SetTop(objpoint.y);
+		if (static_cast<CUMLLineSegment*>(obj)->IsHorizontal())
+			obj->SetBottom(obj->GetTop());
+		else
+			obj->SetRight(obj->GetLeft());
+		return first != obj->GetRect();
+	}
+	if (linktype == LINK_END)
+	{
+		CRect first = obj->GetRect();
+		obj->SetRight(objpoint.x);
+		obj->SetBottom(objpoint.y);
+		if (static_cast<CUMLLineSegment*>(obj)->IsHorizontal())
+			obj->SetTop(obj->GetBottom());
+		else
+			obj->SetLeft(obj->GetRight());
+		return first != obj->GetRect();
+	}
+
+	return FALSE;
 
 }
 
-void CUMLEntityContainer::ReduceLine(CUMLLineSegment* line)
+BOOL CUMLEntityContainer::FollowObject(CUMLLineSegment* line, CUMLEntity* obj, int end)
 /* ============================================================
-	Function :		CUMLEntityContainer::ReduceLine
-	Description :	Removes adjacent line segments with the
-					same orientation.
-	Access :		Public
+	Function :		CUMLEntityContainer::FollowObject
+	Description :	Moves the end "end" of "line" to "obj".
+	Access :		Private
 
-	Return :		void
-	Parameters :	CUMLLineSegment* line	-	Line to check
+	Return :		BOOL					-	"TRUE" if "line"
+												was changed.
+	Parameters :	CUMLLineSegment* line	-	Segment linked to
+												"obj".
+					CUMLEntity* obj			-	Object to follow.
+					int end					-	"LINK_START" or
+												"LINK_END".
 
-	Usage :			Expands segments to cover a complete
-					horizontal or vertical stretch.
+	Usage :			Internal function, used by
+					"AdjustLinkedObjects". The segment keeps
+					its orientation.
 
    ============================================================*/
 {
 
-	SetDefaultLineStyle(line);
-
-	CUMLLineSegment* test = GetPrevSegment(line);
-	if (test)
+	CPoint objpoint = GetLinkPosition(obj, line);
+	int linktype = line->GetLinkType(end);
+	CRect first = line->GetRect();
+	if (linktype == LINK_RIGHT || linktype == LINK_LEFT)
+	{
+		if (end == LINK_START)
+		{
+			line->SetTop(objpoint.y);
+			line->SetLeft(objpoint.x);
+
+			line->SetBottom(objpoint.y);
+		}
+		else
+		{
+			line->SetBottom(objpoint.y);
+			line->SetRight(objpoint.x);
+
+			line->SetTop(objpoint.y);
+		}
+	}
+	if (linktype == LINK_TOP || linktype == LINK_BOTTOM)
+	{
+		if (end == LINK_START)
+		{
+			line->SetTop(objpoint.y);
+			line->SetLeft(objpoint.x);
+
+			line->SetRight(objpoint.x);
+		}
+		else
+		{
+			line->SetBottom(objpoint.y);
+			line->SetRight(objpoint.x);
+
+			line->SetLeft(objpoint.x);
+		}
+	}
+
+	if (linktype == LINK_END)
+	{
+		line->SetLeft(objpoint.x);
+		line->SetTop(objpoint.y);
+		if (line->IsHorizontal())
+			line->SetBottom(objpoint.y);
+		else
+			line->SetRight(objpoint.x);
+	}
+
+	if (linktype == LINK_START)
+	{
+		line->SetRight(objpoint.x);
+		line->SetBottom(objpoint.y);
+		if (line->IsHorizontal())
+			line->SetTop(objpoint.y);
+		else
+			line->SetLeft(objpoint.x);
+	}
+
+	return first != line->GetRect();
+
+}
+
+void CUMLEntityContainer::ReduceLine(CUMLLineSegment* line)
+/* ============================================================
+	Function :		CUMLEntityContainer::ReduceLine
+	Description :	Removes adjacent line segments with the
+					same orientation.
+	Access :		Public
+
+	Return :		void
+	Parameters :	CUMLLineSegment* line	-	Line to check
+
+	Usage :			Expands segments to cover a complete
+					horizontal or vertical stretch.
+
+   ============================================================*/
+{
+
+	SetDefaultLineStyle(line);
+
+	CUMLLineSegment* test = GetPrevSegment(line);
+	if (test)
 	{
 		if ((line->IsHorizontal() && test->IsHorizontal()) ||
 			(!line->IsHorizontal() && !test->IsHorizontal()))
@@ -941,10 +1252,12 @@ void CUMLEntityContainer::ReduceLine(CUMLLineSegment* line)
 			// we must rename it as well
 			CUMLLineSegment* prev = GetPrevSegment(test);
 			if (prev)
-				prev->SetLink(LINK_END, line->GetName());
+				prev->SetLink(LINK_END, line->GetID());
 
 			// Remove test
 			int index = Find(test);
+			InvalidateBounds();
+			InvalidateObjectIDs();
 			GetData()->RemoveAt(index);
 			delete test;
 		}
@@ -1016,12 +1329,12 @@ CPoint CUMLEntityContainer::GetLinkPosition(CUMLEntity* obj, CUMLLineSegment* li
 	int linkOffset = 0;
 	int type = LINK_NONE;
 
-	if (line->GetLink(LINK_START) == obj->GetName())
+	if (line->GetLink(LINK_START) == obj->GetID())
 	{
 		type = line->GetLinkType(LINK_START);
 		linkOffset = line->GetOffset(LINK_START);
 	}
-	else if (line->GetLink(LINK_END) == obj->GetName())
+	else if (line->GetLink(LINK_END) == obj->GetID())
 	{
 		type = line->GetLinkType(LINK_END);
 		linkOffset = line->GetOffset(LINK_END);
@@ -1060,11 +1373,23 @@ void CUMLEntityContainer::Save(CArchive& ar)
 	Return :		void
 	Parameters :	CArchive& ar	-	Archive to save to
 
-	Usage :			Call to save the container data.
+	Usage :			Call to save the container data. If the
+					diagram is saved as package files, see
+					"SetPackageFiles", and the project path
+					is set, a manifest is written to "ar" and
+					the changed packages to their own files.
+					Otherwise the diagram is written to "ar"
+					as a single file.
 
    ============================================================*/
 {
 
+	if (m_packageFiles && m_projectPath.GetLength())
+	{
+		SaveProject(ar);
+		return;
+	}
+
 	CString package = GetPackage();
 	SetPackage(_T("all"));
 	ar.WriteString(GetString() + _T("\r\n"));
@@ -1092,10 +1417,14 @@ void CUMLEntityContainer::Save(CString& filename)
 					file dialog will be displayed, and the
 					variable will contain the selected filename
 					on return.
+					Always saves a single file, with all
+					packages.
 
    ============================================================*/
 {
 
+	LoadAllPackages();
+
 	CString package = GetPackage();
 	SetPackage(_T("all"));
 	CTextFile		file;
@@ -1259,35 +1588,55 @@ void CUMLEntityContainer::Undo()
 
    ============================================================*/
 {
+	DIAGRAM_TRACE_SPAN(_T("CUMLEntityContainer::Undo"));
+
 	if (GetUndo()->GetSize())
 	{
+		InvalidateCoalescing();
+
+		// We get the last entry from the undo-stack,
+		// reading it back if it is spilled. If it
+		// can't be read, the current data is kept so
+		// the stacks stay in step
+		CUMLUndoItem* undo = static_cast<CUMLUndoItem*>(GetUndo()->GetAt(GetUndo()->GetUpperBound()));
+		BOOL loaded = LoadUndoItem(undo);
+
 		// Push the current state to the redo stack
 		Push(GetRedo());
 
-		// We remove all current data
-		RemoveAll();
-
-		// We get the last entry from the undo-stack
-		// and clone it into the container data
-		CUMLUndoItem* undo = static_cast<CUMLUndoItem*>(GetUndo()->GetAt(GetUndo()->GetUpperBound()));
-		INT_PTR count = (undo->arr).GetSize();
-		for (INT_PTR t = 0; t < count; t++)
+		if (loaded)
 		{
-			CDiagramEntity* obj = static_cast<CDiagramEntity*>((undo->arr).GetAt(t));
-			CDiagramEntity* newObj = obj->Clone();
-			newObj->SetName(obj->GetName());
-			Add(newObj);
-		}
+			// Clone the entry into the container data,
+			// replacing all current data
+			INT_PTR count = (undo->arr).GetSize();
+			CObArray arr;
+			arr.SetSize(count);
+			for (INT_PTR t = 0; t < count; t++)
+			{
+				CDiagramEntity* obj = static_cast<CDiagramEntity*>((undo->arr).GetAt(t));
+				CDiagramEntity* newObj = obj->Clone();
+				newObj->SetName(obj->GetName());
+				arr.SetAt(t, newObj);
+			}
+
+			ReplaceAll(&arr);
+
+			FixLinks(GetData());
 
-		FixLinks(GetData());
+			// Packages read after the level was recorded
+			// are dropped, and read again when opened
+			SetPackageModified(GetPackage());
+			SetPackageModified(undo->package);
+			SetUnloadedPackages(undo->unloaded);
 
-		// Set the saved virtual size, background color, and package
-		SetVirtualSize(undo->pt);
-		SetColor(undo->col);
-		SetPackage(undo->package);
+			// Set the saved virtual size, background color, and package
+			SetVirtualSize(undo->pt);
+			SetColor(undo->col);
+			SetPackage(undo->package);
+		}
 
 		// We remove the entry from the undo-stack
-		delete undo;
+		DeleteUndoItem(undo);
 		GetUndo()->RemoveAt(GetUndo()->GetUpperBound());
 	}
 }
@@ -1302,10 +1651,19 @@ void CUMLEntityContainer::Snapshot()
 	Parameters :	none
 
 	Usage :			We fix links and get the paper size, color
-					and package as well.
+					and package as well. Inside a transaction,
+					only the first call is recorded. The
+					current package is marked as changed.
 
    ============================================================*/
 {
+	DIAGRAM_TRACE_SPAN(_T("CUMLEntityContainer::Snapshot"));
+
+	if (!BeginSnapshot())
+		return;
+
+	SetPackageModified(GetPackage());
+
 	// Clear the redo stack
 	ClearRedo();
 
@@ -1327,39 +1685,110 @@ void CUMLEntityContainer::Redo()
 
    ============================================================*/
 {
+	DIAGRAM_TRACE_SPAN(_T("CUMLEntityContainer::Redo"));
+
 	if (GetRedo()->GetSize())
 	{
+		InvalidateCoalescing();
+
+		// We get the last entry from the redo-stack,
+		// reading it back if it is spilled. If it
+		// can't be read, the current data is kept so
+		// the stacks stay in step
+		CUMLUndoItem* redo = static_cast<CUMLUndoItem*>(GetRedo()->GetAt(GetRedo()->GetUpperBound()));
+		BOOL loaded = LoadUndoItem(redo);
+
 		// Push the current state to the undo stack
 		Push(GetUndo());
 
-		// We remove all current data
-		RemoveAll();
-
-		// We get the last entry from the redo-stack
-		// and clone it into the container data
-		CUMLUndoItem* redo = static_cast<CUMLUndoItem*>(GetRedo()->GetAt(GetRedo()->GetUpperBound()));
-		INT_PTR count = (redo->arr).GetSize();
-		for (INT_PTR t = 0; t < count; t++)
+		if (loaded)
 		{
-			CDiagramEntity* obj = static_cast<CDiagramEntity*>((redo->arr).GetAt(t));
-			CDiagramEntity* newObj = obj->Clone();
-			newObj->SetName(obj->GetName());
-			Add(newObj);
-		}
+			// Clone the entry into the container data,
+			// replacing all current data
+			INT_PTR count = (redo->arr).GetSize();
+			CObArray arr;
+			arr.SetSize(count);
+			for (INT_PTR t = 0; t < count; t++)
+			{
+				CDiagramEntity* obj = static_cast<CDiagramEntity*>((redo->arr).GetAt(t));
+				CDiagramEntity* newObj = obj->Clone();
+				newObj->SetName(obj->GetName());
+				arr.SetAt(t, newObj);
+			}
 
-		FixLinks(GetData());
+			ReplaceAll(&arr);
 
-		// Set the saved virtual size, background color, and package
-		SetVirtualSize(redo->pt);
-		SetColor(redo->col);
-		SetPackage(redo->package);
+			FixLinks(GetData());
+
+			// Packages read after the level was recorded
+			// are dropped, and read again when opened
+			SetPackageModified(GetPackage());
+			SetPackageModified(redo->package);
+			SetUnloadedPackages(redo->unloaded);
+
+			// Set the saved virtual size, background color, and package
+			SetVirtualSize(redo->pt);
+			SetColor(redo->col);
+			SetPackage(redo->package);
+		}
 
 		// We remove the entry from the redo-stack
-		delete redo;
+		DeleteUndoItem(redo);
 		GetRedo()->RemoveAt(GetRedo()->GetUpperBound());
 	}
 }
 
+void CUMLEntityContainer::GetMemoryUsage(CDiagramMemoryUsage& usage) const
+/* ============================================================
+	Function :		CUMLEntityContainer::GetMemoryUsage
+	Description :	Adds the memory held by the container to
+					"usage".
+	Access :		Public
+
+	Return :		void
+	Parameters :	CDiagramMemoryUsage& usage	-	Breakdown
+													to add to.
+
+	Usage :			Overridden to add the package data of the
+					undo levels and the manifest.
+
+   ============================================================*/
+{
+
+	CDiagramEntityContainer::GetMemoryUsage(usage);
+
+	CUMLEntityContainer* const local = const_cast<CUMLEntityContainer* const>(this);
+	CString scope = usage.GetScope();
+	CObArray* stacks[2] = { local->GetUndo(), local->GetRedo() };
+	LPCTSTR scopes[2] = { _T("Undo"), _T("Redo") };
+	for (int s = 0; s < 2; s++)
+	{
+		usage.SetScope(scopes[s]);
+		INT_PTR levels = stacks[s]->GetSize();
+		for (INT_PTR t = 0; t < levels; t++)
+		{
+			CUMLUndoItem* item = static_cast<CUMLUndoItem*>(stacks[s]->GetAt(t));
+			usage.Add(_T("Levels"), _T("Packages"), 0, sizeof(CUMLUndoItem) - sizeof(CUndoItem));
+			usage.AddString(item->package);
+			usage.AddStrings(item->unloaded);
+		}
+	}
+
+	usage.SetScope(scope);
+	usage.Add(_T("Packages"), _T("Manifest links"), m_packageLinks.GetSize(), m_packageLinks.GetSize() * sizeof(CPackageLink));
+	INT_PTR max = m_packageLinks.GetSize();
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		usage.AddString(m_packageLinks[t].object);
+		usage.AddString(m_packageLinks[t].package);
+		usage.AddString(m_packageLinks[t].source);
+	}
+
+	INT_PTR packages = m_packageParents.GetCount() + m_loadedPackages.GetCount() + m_modifiedPackages.GetCount();
+	usage.Add(_T("Packages"), _T("Package maps"), packages, packages * (sizeof(void*) * 3 + sizeof(CString) * 2));
+
+}
+
 void CUMLEntityContainer::Push(CObArray* stack)
 /* ============================================================
 	Function :		CUMLEntityContainer::PushRedo
@@ -1379,7 +1808,7 @@ void CUMLEntityContainer::Push(CObArray* stack)
 {
 	if (GetUndoStackSize() > 0 && stack->GetSize() == GetUndoStackSize())
 	{
-		delete stack->GetAt(0);
+		DeleteUndoItem(static_cast<CUndoItem*>(stack->GetAt(0)));
 		stack->RemoveAt(0);
 	}
 
@@ -1389,7 +1818,7 @@ void CUMLEntityContainer::Push(CObArray* stack)
 	{
 		// We seem - however unlikely - to be out of memory.
 		// Remove first element in stack and try again
-		delete stack->GetAt(0);
+		DeleteUndoItem(static_cast<CUndoItem*>(stack->GetAt(0)));
 		stack->RemoveAt(0);
 		item = new CUMLUndoItem;
 	}
@@ -1402,8 +1831,9 @@ void CUMLEntityContainer::Push(CObArray* stack)
 		// Save current virtual size
 		item->pt = GetVirtualSize();
 
-		// Save the package
+		// Save the package, and the package files not read
 		item->package = GetPackage();
+		GetUnloadedPackages(item->unloaded);
 
 		// Save all objects
 		INT_PTR count = GetData()->GetSize();
@@ -1419,6 +1849,7 @@ void CUMLEntityContainer::Push(CObArray* stack)
 
 		// Add to stack
 		stack->Add(item);
+		SpillStack(stack);
 	}
 }
 
@@ -1436,48 +1867,60 @@ void CUMLEntityContainer::FixLinks(CObArray *arr)
 					name, and objects get a new name when
 					copied, therefore we must restore links in
 					the container.
+					The old ids are collected in a map first,
+					and the links remapped in a single pass,
+					so the cost is linear in the number of
+					objects.
 
    ============================================================*/
 {
 
 	INT_PTR count = arr->GetSize();
 
+	// Map old ids to new ones. Objects that kept their
+	// name, such as undo clones, need no remapping.
+	CMap< ULONGLONG, ULONGLONG, ULONGLONG, ULONGLONG > ids;
 	for (INT_PTR t = 0; t < count; t++)
 	{
 		CUMLEntity* obj = static_cast<CUMLEntity*>(arr->GetAt(t));
-		if (obj->GetOldId().GetLength())
+		CString oldid = obj->GetOldId();
+		if (oldid.GetLength())
 		{
-			for (INT_PTR i = 0; i < count; i++)
-			{
+			ULONGLONG old = CLinkFactory::ToID(oldid);
+			if (old != LINK_ID_NONE && old != obj->GetID())
+				ids.SetAt(old, obj->GetID());
+			obj->SetOldId(_T(""));
+		}
+	}
 
-				if (t != i)
-				{
-					CUMLLineSegment* line = dynamic_cast<CUMLLineSegment*>(arr->GetAt(i));
-					if (line)
-					{
-						if (line->GetLink(LINK_START) == obj->GetOldId())
-							line->SetLink(LINK_START, obj->GetName());
-						if (line->GetLink(LINK_END) == obj->GetOldId())
-							line->SetLink(LINK_END, obj->GetName());
-					}
-				}
+	if (ids.GetCount())
+	{
+		ULONGLONG id;
+		for (INT_PTR t = 0; t < count; t++)
+		{
+			CUMLLineSegment* line = CUMLLineSegment::Cast(static_cast<CDiagramEntity*>(arr->GetAt(t)));
+			if (line)
+			{
+				if (ids.Lookup(line->GetLink(LINK_START), id))
+					line->SetLink(LINK_START, id);
+				if (ids.Lookup(line->GetLink(LINK_END), id))
+					line->SetLink(LINK_END, id);
 			}
-			obj->SetOldId(_T(""));
 		}
 	}
 
 }
 
-CSize CUMLEntityContainer::CalcMinimumRestraints(const CString& name)
+CSize CUMLEntityContainer::CalcMinimumRestraints(ULONGLONG id)
 /* ============================================================
 	Function :		CUMLEntityContainer::CalcMinimumRestraints
 	Description :	Calculates the minimum size for the object
-					with the name "name" as regards to
-					attached links.
+					with the id "id" as regards to attached
+					links.
 	Access :		Public
 
-	Return :		CSize				-	Minimum size
-	Parameters :	const CString& name	-	Name of object to test
+	Return :		CSize			-	Minimum size
+	Parameters :	ULONGLONG id	-	Id of object to test
 
 	Usage :			The objects themselves don't know about the
 					attached links. Therefore, they have to ask
@@ -1490,19 +1933,19 @@ CSize CUMLEntityContainer::CalcMinimumRestraints(const CString& name)
 	CSize result(-1, -1);
 	BOOL horz = FALSE;
 	BOOL vert = FALSE;
-	if (name.GetLength())
+	if (id != LINK_ID_NONE)
 	{
 		INT_PTR max = GetSize();
 		for (INT_PTR t = 0; t < max; t++)
 		{
-			CUMLLineSegment* line = dynamic_cast<CUMLLineSegment*>(GetAt(t));
+			CUMLLineSegment* line = CUMLLineSegment::Cast(GetAt(t));
 			if (line)
 			{
 				int offset = -1;
-				if (line->GetLink(LINK_START) == name)
+				if (line->GetLink(LINK_START) == id)
 					offset = line->GetOffset(LINK_START);
 
-				if (line->GetLink(LINK_END) == name)
+				if (line->GetLink(LINK_END) == id)
 					offset = line->GetOffset(LINK_END);
 
 				if (offset != -1)
@@ -1632,9 +2075,16 @@ void CUMLEntityContainer::Export(CStringArray& stra, UINT format) const
 						"EXPORT_H" Export to header files
 						"EXPORT_HTML" Export to HTML-files
 
+					All package files are read first.
+
    ============================================================*/
 {
 
+	DIAGRAM_TRACE_SPAN(_T("CUMLEntityContainer::Export"));
+
+	CUMLEntityContainer* const local = const_cast<CUMLEntityContainer* const>(this);
+	local->LoadAllPackages();
+
 	switch (format)
 	{
 	case EXPORT_HTML:
@@ -1666,6 +2116,8 @@ void CUMLEntityContainer::ExportHTML(CStringArray& stra) const
    ============================================================*/
 {
 
+	DIAGRAM_TRACE_SPAN(_T("CUMLEntityContainer::ExportHTML"));
+
 	// Creating headers
 	CStringArray	ext;
 	CTextFile		file;
@@ -1700,18 +2152,18 @@ void CUMLEntityContainer::ExportHTML(CStringArray& stra) const
 	INT_PTR max = GetSize();
 	for (INT_PTR t = 0; t < max; t++)
 	{
-		CUMLLineSegment* obj = dynamic_cast<CUMLLineSegment*>(GetObjectAt(t));
+		CUMLLineSegment* obj = CUMLLineSegment::Cast(GetObjectAt(t));
 		if (obj)
-			if (GetPackage() == obj->GetPackage())
+			if (CStringTable::IsEqual(GetPackage(), obj->GetPackage()))
 				stra.Add(obj->Export(EXPORT_HTML));
 	}
 
 	for (INT_PTR t = 0; t < max; t++)
 	{
 		CUMLEntity* obj = GetObjectAt(t);
-		CUMLLineSegment* seg = dynamic_cast<CUMLLineSegment*>(GetObjectAt(t));
+		CUMLLineSegment* seg = CUMLLineSegment::Cast(GetObjectAt(t));
 		if (!seg)
-			if (GetPackage() == obj->GetPackage())
+			if (CStringTable::IsEqual(GetPackage(), obj->GetPackage()))
 				stra.Add(obj->Export(EXPORT_HTML));
 	}
 
@@ -1723,16 +2175,17 @@ void CUMLEntityContainer::ExportHTML(CStringArray& stra) const
 	CString horzTemplate(_T("<div style='position:absolute;left:%i;top:%i;width:16;height:8;background-image:url(\"%s\");background-repeat:no-repeat;);'>&nbsp;&nbsp;&nbsp;&nbsp;</div>"));
 	CString vertTemplate(_T("<div style='position:absolute;left:%i;top:%i;width:8;height:16;background-image:url(\"%s\");background-repeat:no-repeat;);'>&nbsp;</div>"));
 	CString result;
-	max = GetSize();
+	CObArray segments;
+	max = GetSegments(segments);
 	for (INT_PTR i = 0; i < max; i++)
 	{
-		CUMLLineSegment* obj = dynamic_cast<CUMLLineSegment*>(GetObjectAt(i));
-		if (obj && GetPackage() == obj->GetPackage())
+		CUMLLineSegment* obj = static_cast<CUMLLineSegment*>(segments.GetAt(i));
+		if (CStringTable::IsEqual(GetPackage(), obj->GetPackage()))
 		{
 			BOOL horz = obj->IsHorizontal();
 			for (INT_PTR t = i + 1; t < max; t++)
 			{
-				CUMLLineSegment* line = dynamic_cast<CUMLLineSegment*>(GetObjectAt(t));
+				CUMLLineSegment* line = static_cast<CUMLLineSegment*>(segments.GetAt(t));
 				if (line)
 				{
 					if (horz && !line->IsHorizontal())
@@ -1797,6 +2250,8 @@ void CUMLEntityContainer::ExportCPP() const
    ============================================================*/
 {
 
+	DIAGRAM_TRACE_SPAN(_T("CUMLEntityContainer::ExportCPP"));
+
 	CUMLEntityContainer* const local = const_cast<CUMLEntityContainer* const>(this);
 	CString current = GetPackage();
 	local->SetPackage(_T("all"));
@@ -1810,7 +2265,7 @@ void CUMLEntityContainer::ExportCPP() const
 	{
 		for (int t = 0; t < max; t++)
 		{
-			CUMLEntityClass* obj = dynamic_cast<CUMLEntityClass*>(GetAt(t));
+			CUMLEntityClass* obj = CUMLEntityClass::Cast(GetAt(t));
 			if (obj)
 			{
 				CString title = obj->GetTitle();
@@ -1899,7 +2354,7 @@ void CUMLEntityContainer::ExportH() const
 	{
 		for (INT_PTR t = 0; t < max; t++)
 		{
-			CUMLEntityClass* obj = dynamic_cast<CUMLEntityClass*>(GetAt(t));
+			CUMLEntityClass* obj = CUMLEntityClass::Cast(GetAt(t));
 			if (obj)
 			{
 				CString title = obj->GetTitle();
@@ -1991,22 +2446,22 @@ void CUMLEntityContainer::GetBaseClassArray(CUMLEntityClass* obj, CStringArray&
 		INT_PTR max = GetSize();
 		for (INT_PTR t = 0; t < max; t++)
 		{
-			CUMLLineSegment* line = dynamic_cast<CUMLLineSegment*>(GetAt(t));
+			CUMLLineSegment* line = CUMLLineSegment::Cast(GetAt(t));
 			if (line)
 			{
-				if (line->GetLink(LINK_START) == obj->GetName())
+				if (line->GetLink(LINK_START) == obj->GetID())
 				{
 					// Check if this is an inherited class
 					CUMLLineSegment* seg = GetEndSegment(line);
 					if (seg && seg->GetStyle() & STYLE_ARROWHEAD)
 					{
-						CUMLEntityClass* node = dynamic_cast<CUMLEntityClass*>(GetEndNode(seg));
+						CUMLEntityClass* node = CUMLEntityClass::Cast(GetEndNode(seg));
 						if (node)
 							result.Add(node->GetTitle());
 						else
 						{
 							// Might be a 
-							CUMLEntityInterface* node = dynamic_cast<CUMLEntityInterface*>(GetEndNode(seg));
+							CUMLEntityInterface* node = CUMLEntityInterface::Cast(GetEndNode(seg));
 							if (node)
 								result.Add(node->GetTitle());
 						}
@@ -2017,13 +2472,13 @@ void CUMLEntityContainer::GetBaseClassArray(CUMLEntityClass* obj, CStringArray&
 				// If we have a multi-segment line, it might be flipped
 				if (GetNextSegment(line) || GetPrevSegment(line))
 				{
-					if (line->GetLink(LINK_END) == obj->GetName())
+					if (line->GetLink(LINK_END) == obj->GetID())
 					{
 						// Check if this is an inherited class
 						CUMLLineSegment* seg = GetStartSegment(line);
 						if (seg && seg->GetStyle() & STYLE_ARROWHEAD)
 						{
-							CUMLEntityClass* node = dynamic_cast<CUMLEntityClass*>(GetStartNode(seg));
+							CUMLEntityClass* node = CUMLEntityClass::Cast(GetStartNode(seg));
 							if (node)
 								result.Add(node->GetTitle());
 						}
@@ -2129,7 +2584,7 @@ BOOL CUMLEntityContainer::IsLinkSelected() const
 
 	if (GetSelectCount() == 1)
 	{
-		CUMLLineSegment* line = dynamic_cast<CUMLLineSegment*>(GetSelectedObject());
+		CUMLLineSegment* line = CUMLLineSegment::Cast(GetSelectedObject());
 		if (line)
 			return TRUE;
 	}
@@ -2157,7 +2612,7 @@ void CUMLEntityContainer::FlipLink()
 
 	if (GetSelectCount() == 1)
 	{
-		CUMLLineSegment* line = dynamic_cast<CUMLLineSegment*>(GetSelectedObject());
+		CUMLLineSegment* line = CUMLLineSegment::Cast(GetSelectedObject());
 		if (line)
 		{
 			if (line->IsSingleLineSegment())
@@ -2182,129 +2637,753 @@ void CUMLEntityContainer::FlipLink()
 
 }
 
-CDiagramEntity* CUMLEntityContainer::GetSelectedObject() const
+void CUMLEntityContainer::AutoLayout()
 /* ============================================================
-	Function :		CUMLEntityContainer::GetSelectedObject
-	Description :	Returns the top selected object in the
-					container.
+	Function :		CUMLEntityContainer::AutoLayout
+	Description :	Arranges the objects of the current package
+					in layers, and reroutes the lines between
+					them.
 	Access :		Public
 
-	Return :		CDiagramEntity*	-	The top selected object,
-										or "NULL" if none.
+	Return :		void
 	Parameters :	none
 
-	Usage :			Call to get the currently selected object.
-					Note that this function will return a single
-					object (top in the z-order) even if several
-					are selected.
+	Usage :			Call to tidy up a diagram. The object a
+					line ends at is placed above the object it
+					starts from, so base classes end up above
+					derived classes. Lines keep their style,
+					labels and title, but get new segments.
+					Objects without lines are placed in rows
+					below the rest.
 
    ============================================================*/
 {
 
-	int count = 0;
-	CDiagramEntity* obj;
+	CObArray nodes;
+	INT_PTR count = GetNodes(nodes);
+	if (count == 0)
+		return;
 
-	while ((obj = GetAt(count++)))
-		if (obj->IsSelected())
-			return obj;
+	// Nodes, indexed by object
+	CLayeredLayout layout;
+	CMapPtrToPtr indices;
+	double left = 0;
+	double top = 0;
+	for (INT_PTR t = 0; t < count; t++)
+	{
+		CUMLEntity* obj = static_cast<CUMLEntity*>(nodes[t]);
+		indices.SetAt(obj, reinterpret_cast<void*>(t));
+		layout.AddNode(round(obj->GetRight() - obj->GetLeft()), round(obj->GetBottom() - obj->GetTop()));
+		if (t == 0 || obj->GetLeft() < left)
+			left = obj->GetLeft();
+		if (t == 0 || obj->GetTop() < top)
+			top = obj->GetTop();
+	}
 
-	return NULL;
+	CObArray segments;
+	INT_PTR max = GetSegments(segments);
+
+	// Lines between two nodes. The end node goes above the
+	// start node.
+	CObArray lines;
+	CObArray chain;
+	CArray< CUMLEntity*, CUMLEntity* > starts;
+	CArray< CUMLEntity*, CUMLEntity* > ends;
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		CUMLLineSegment* line = static_cast<CUMLLineSegment*>(segments[t]);
+		if (line->GetLinkType(LINK_START) == LINK_END)
+			continue;
+
+		CUMLLineSegment* last = line;
+		for (INT_PTR step = 0; step < max && last->GetLinkType(LINK_END) == LINK_START; step++)
+		{
+			CUMLLineSegment* next = CUMLLineSegment::Cast(GetNamedObject(last->GetLink(LINK_END)));
+			if (next == NULL)
+				break;
+			last = next;
+		}
+
+		void* start = NULL;
+		void* end = NULL;
+		if (indices.Lookup(GetNamedObject(line->GetLink(LINK_START)), start) &&
+			indices.Lookup(GetNamedObject(last->GetLink(LINK_END)), end))
+		{
+			lines.Add(line);
+			starts.Add(static_cast<CUMLEntity*>(nodes[reinterpret_cast<INT_PTR>(start)]));
+			ends.Add(static_cast<CUMLEntity*>(nodes[reinterpret_cast<INT_PTR>(end)]));
+			layout.AddEdge(static_cast<int>(reinterpret_cast<INT_PTR>(end)), static_cast<int>(reinterpret_cast<INT_PTR>(start)));
+		}
+	}
+
+	layout.Layout();
+
+	// Move the nodes, keeping the top-left corner of the diagram
+	for (INT_PTR t = 0; t < count; t++)
+	{
+		CUMLEntity* obj = static_cast<CUMLEntity*>(nodes[t]);
+		CPoint pos = layout.GetNodePosition(static_cast<int>(t));
+		obj->MoveRect(left + pos.x - obj->GetLeft(), top + pos.y - obj->GetTop());
+	}
+
+	// Rebuild the lines along the routes, reusing the existing
+	// segments
+	CMapPtrToPtr surplus;
+	CArray< CPoint, CPoint > route;
+	INT_PTR lineCount = lines.GetSize();
+	for (INT_PTR t = 0; t < lineCount; t++)
+	{
+		CUMLLineSegment* line = static_cast<CUMLLineSegment*>(lines[t]);
+		CUMLEntity* start = starts[t];
+		CUMLEntity* end = ends[t];
+
+		// The route runs from the end node to the start node
+		INT_PTR points = layout.GetEdgeRoute(static_cast<int>(t), route);
+		if (points < 2)
+			continue;
+		for (INT_PTR i = 0; i < points / 2; i++)
+		{
+			CPoint pt = route[i];
+			route[i] = route[points - 1 - i];
+			route[points - 1 - i] = pt;
+		}
+		for (INT_PTR i = 0; i < points; i++)
+			route[i].Offset(round(left), round(top));
+
+		int startType = (route[0].y == round(start->GetTop())) ? LINK_TOP : LINK_BOTTOM;
+		int endType = (route[points - 1].y == round(end->GetTop())) ? LINK_TOP : LINK_BOTTOM;
+
+		GetChain(line, chain);
+		SetLineRoute(chain, start, startType, end, endType, route, surplus);
+	}
+
+	DeleteSegments(surplus);
+	InvalidateBounds();
 
 }
 
-void CUMLEntityContainer::Import()
+void CUMLEntityContainer::RouteLines()
 /* ============================================================
-	Function :		CUMLEntityContainer::Import
-	Description :	Imports content into the currently selected
-					object from a h-file.
+	Function :		CUMLEntityContainer::RouteLines
+	Description :	Reroutes the lines of the current package
+					around the objects.
 	Access :		Public
 
 	Return :		void
 	Parameters :	none
 
-	Usage :			Call to import information from a h-file
-					into an object.
+	Usage :			Call to untangle lines running through
+					objects. If anything is selected, only the
+					lines attached to, or part of, the
+					selection are rerouted. Lines keep their
+					end points, style, labels and title, but
+					get new segments, horizontal and vertical
+					in turn.
 
    ============================================================*/
 {
 
-	SendMessageToObjects(CMD_IMPORT, TRUE);
+	CObArray nodes;
+	INT_PTR count = GetNodes(nodes);
+	if (count == 0)
+		return;
+
+	// Every object is an obstacle
+	CLinkRouter router;
+	CMapPtrToPtr nodeSet;
+	BOOL selection = FALSE;
+	for (INT_PTR t = 0; t < count; t++)
+	{
+		CUMLEntity* obj = static_cast<CUMLEntity*>(nodes[t]);
+		nodeSet.SetAt(obj, obj);
+		router.AddObstacle(obj->GetRect());
+		if (obj->IsSelected())
+			selection = TRUE;
+	}
+
+	CObArray segments;
+	INT_PTR max = GetSegments(segments);
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		CUMLLineSegment* line = static_cast<CUMLLineSegment*>(segments[t]);
+		if (line->IsSelected())
+			selection = TRUE;
+	}
+
+	CObArray chain;
+	CMapPtrToPtr surplus;
+	CArray< CPoint, CPoint > route;
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		// Start at the first segment of each line
+		CUMLLineSegment* line = static_cast<CUMLLineSegment*>(segments[t]);
+		if (line->GetLinkType(LINK_START) == LINK_END)
+			continue;
+
+		INT_PTR size = GetChain(line, chain);
+		CUMLLineSegment* last = static_cast<CUMLLineSegment*>(chain[size - 1]);
+
+		void* ptr = NULL;
+		CUMLEntity* start = GetNamedObject(line->GetLink(LINK_START));
+		if (!nodeSet.Lookup(start, ptr))
+			continue;
+		CUMLEntity* end = GetNamedObject(last->GetLink(LINK_END));
+		if (!nodeSet.Lookup(end, ptr))
+			continue;
+
+		int startType = line->GetLinkType(LINK_START);
+		int endType = last->GetLinkType(LINK_END);
+		if (!(startType & LINK_ALL) || !(endType & LINK_ALL))
+			continue;
+
+		if (selection)
+		{
+			BOOL selected = start->IsSelected() || end->IsSelected();
+			for (INT_PTR i = 0; i < size && !selected; i++)
+				selected = static_cast<CUMLLineSegment*>(chain[i])->IsSelected();
+			if (!selected)
+				continue;
+		}
+
+		router.Route(GetLinkPosition(start, line), startType, GetLinkPosition(end, last), endType, route);
+		SetLineRoute(chain, start, startType, end, endType, route, surplus);
+	}
+
+	DeleteSegments(surplus);
+	InvalidateBounds();
 
 }
 
-void CUMLEntityContainer::GetIncludeList(CUMLEntityClass* inobj, CStringArray& stringarray) const
+INT_PTR CUMLEntityContainer::GetChain(CUMLLineSegment* line, CObArray& chain) const
 /* ============================================================
-	Function :		CUMLEntityContainer::GetIncludeList
-	Description :	Get a list of the "inobj" class inlcudes.
+	Function :		CUMLEntityContainer::GetChain
+	Description :	Gets the segments of a line.
 	Access :		Private
 
-	Return :		void
-	Parameters :	CUMLEntityClass* inobj		-	The object to get
-													includes for
-					CStringArray& stringarray	-	Results
-
-	Usage :			Call to get a list of the classes "inobj"
-					is composed of. This is a list that will be
-					used to generate includes and forward
-					declarations for a h-file. Strings prefixed
-					with a hash-mark should be converted to a forward
-					declaration.
+	Return :		INT_PTR					-	Number of
+												segments.
+	Parameters :	CUMLLineSegment* line	-	First segment
+												of the line.
+					CObArray& chain			-	Gets the
+												segments, from
+												start to end.
 
-					The list is created from both connections,
-					class members and operation parameters
+	Usage :			Faster than "GetNextSegment" for more
+					than one line, as the segments are looked
+					up by id.
 
    ============================================================*/
 {
 
-	CStringArray stra;
+	chain.RemoveAll();
+	chain.Add(line);
+
 	INT_PTR max = GetSize();
-	CStringArray classes;
-	GetClassList(classes);
+	CUMLLineSegment* last = line;
+	while (chain.GetSize() < max && last->GetLinkType(LINK_END) == LINK_START)
+	{
+		last = CUMLLineSegment::Cast(GetNamedObject(last->GetLink(LINK_END)));
+		if (last == NULL)
+			break;
+		chain.Add(last);
+	}
 
-	CStringArray baseClassArray;
-	CStringArray baseClassAccessArray;
-	GetBaseClassArray(inobj, baseClassArray, baseClassAccessArray);
-	INT_PTR size = baseClassArray.GetSize();
-	for (INT_PTR t = 0; t < size; t++)
+	return chain.GetSize();
+
+}
+
+void CUMLEntityContainer::SetLineRoute(CObArray& chain, CUMLEntity* start, int startType, CUMLEntity* end, int endType, const CArray< CPoint, CPoint >& route, CMapPtrToPtr& surplus)
+/* ============================================================
+	Function :		CUMLEntityContainer::SetLineRoute
+	Description :	Rebuilds a line along a route.
+	Access :		Private
+
+	Return :		void
+	Parameters :	CObArray& chain			-	Segments of the
+												line, from start
+												to end.
+					CUMLEntity* start		-	Object at the
+												start.
+					int startType			-	Link type at the
+												start.
+					CUMLEntity* end			-	Object at the end.
+					int endType				-	Link type at the
+												end.
+					const CArray< CPoint, CPoint >& route	-
+												Corners of the
+												route, from start
+												to end.
+					CMapPtrToPtr& surplus	-	Gets the segments
+												no longer needed.
+
+	Usage :			The existing segments are reused, and
+					cloned from the first segment if more are
+					needed. Segments no longer needed are put
+					in "surplus", to be removed with
+					"DeleteSegments". The line keeps its style,
+					labels and title.
+
+   ============================================================*/
+{
+
+	CUMLLineSegment* line = static_cast<CUMLLineSegment*>(chain[0]);
+	CUMLLineSegment* last = static_cast<CUMLLineSegment*>(chain[chain.GetSize() - 1]);
+	int style = 0;
+	INT_PTR size = chain.GetSize();
+	for (INT_PTR i = 0; i < size; i++)
+		style |= static_cast<CUMLLineSegment*>(chain[i])->GetStyle();
+
+	CString title = line->GetTitle();
+	CString startLabel = line->GetStartLabel();
+	CString secondaryStartLabel = line->GetSecondaryStartLabel();
+	CString endLabel = last->GetEndLabel();
+	CString secondaryEndLabel = last->GetSecondaryEndLabel();
+
+	INT_PTR needed = route.GetSize() - 1;
+	while (chain.GetSize() < needed)
 	{
-		if (InClasslist(baseClassArray[t], classes))
-			stra.Add(baseClassArray[t]);
+		CUMLLineSegment* segment = static_cast<CUMLLineSegment*>(line->Clone());
+		Add(segment);
+		chain.Add(segment);
+	}
+	while (chain.GetSize() > needed)
+	{
+		surplus.SetAt(chain[chain.GetSize() - 1], NULL);
+		chain.RemoveAt(chain.GetSize() - 1);
 	}
 
-	for (INT_PTR t = 0; t < max; t++)
+	for (INT_PTR i = 0; i < needed; i++)
 	{
-		CUMLLineSegment* line = dynamic_cast<CUMLLineSegment*>(GetAt(t));
-		if (line)
+		CUMLLineSegment* segment = static_cast<CUMLLineSegment*>(chain[i]);
+
+		// Set the coordinates directly, "SetRect" would
+		// keep the old orientation of the segment.
+		segment->SetLeft(route[i].x);
+		segment->SetTop(route[i].y);
+		segment->SetRight(route[i + 1].x);
+		segment->SetBottom(route[i + 1].y);
+
+		for (int side = 0; side < 2; side++)
 		{
-			if (line->IsSingleLineSegment())
+			int type = side ? LINK_END : LINK_START;
+			BOOL atNode = side ? (i == needed - 1) : (i == 0);
+			if (atNode)
 			{
-				if (line->GetLink(LINK_END) == inobj->GetName())
+				CUMLEntity* obj = side ? end : start;
+				CPoint pt = route[side ? i + 1 : i];
+				int linkCode = side ? endType : startType;
+				segment->SetLink(type, obj->GetID());
+				segment->SetLinkType(type, linkCode);
+
+				CSize minsize = obj->GetMinimumSize();
+				if (linkCode == LINK_LEFT || linkCode == LINK_RIGHT)
 				{
-					if (line->GetStyle() & STYLE_FILLED_DIAMOND)
-					{
-						CUMLEntityClass* node = NULL;
-						node = dynamic_cast<CUMLEntityClass*>(GetStartNode(line));
-
-						if (node && node != inobj)
-						{
-							CString title = node->GetTitle();
-							AddString(title, stra);
-
-						}
-					}
+					int diff = pt.y - round(obj->GetTop());
+					segment->SetOffset(type, diff);
+					if (minsize.cy < diff)
+						obj->SetMinimumSize(CSize(minsize.cx, diff));
+				}
+				else
+				{
+					int diff = pt.x - round(obj->GetLeft());
+					segment->SetOffset(type, diff);
+					if (minsize.cx < diff)
+						obj->SetMinimumSize(CSize(diff, minsize.cy));
+				}
+			}
+			else
+			{
+				CUMLLineSegment* other = static_cast<CUMLLineSegment*>(chain[side ? i + 1 : i - 1]);
+				segment->SetLink(type, other->GetID());
+				segment->SetLinkType(type, side ? LINK_START : LINK_END);
+				segment->SetOffset(type, 0);
+			}
+		}
+
+		// Same styles and labels as "AddLineStyle" would give
+		int segmentStyle = style & (STYLE_DASHED | STYLE_INVISIBLE);
+		if (i == 0)
+			segmentStyle |= style & STYLE_FILLED_ARROWHEAD;
+		if (i == needed - 1)
+			segmentStyle |= style & (STYLE_ARROWHEAD | STYLE_FILLED_DIAMOND | STYLE_CIRCLECROSS);
+		segment->SetStyle(segmentStyle);
+
+		segment->SetTitle(i == 0 ? title : CString());
+		segment->SetStartLabel(i == 0 ? startLabel : CString());
+		segment->SetSecondaryStartLabel(i == 0 ? secondaryStartLabel : CString());
+		segment->SetEndLabel(i == needed - 1 ? endLabel : CString());
+		segment->SetSecondaryEndLabel(i == needed - 1 ? secondaryEndLabel : CString());
+	}
+
+}
+
+void CUMLEntityContainer::DeleteSegments(const CMapPtrToPtr& segments)
+/* ============================================================
+	Function :		CUMLEntityContainer::DeleteSegments
+	Description :	Removes and deletes segments.
+	Access :		Private
+
+	Return :		void
+	Parameters :	const CMapPtrToPtr& segments	-	Segments
+													to delete.
+
+	Usage :			Removes all the segments in one pass over
+					the data, with "RemoveMarked".
+
+   ============================================================*/
+{
+
+	RemoveMarked(segments);
+
+}
+
+CDiagramEntity* CUMLEntityContainer::GetSelectedObject() const
+/* ============================================================
+	Function :		CUMLEntityContainer::GetSelectedObject
+	Description :	Returns the top selected object in the
+					container.
+	Access :		Public
+
+	Return :		CDiagramEntity*	-	The top selected object,
+										or "NULL" if none.
+	Parameters :	none
+
+	Usage :			Call to get the currently selected object.
+					Note that this function will return a single
+					object (top in the z-order) even if several
+					are selected.
+
+   ============================================================*/
+{
+
+	int count = 0;
+	CDiagramEntity* obj;
+
+	while ((obj = GetAt(count++)))
+		if (obj->IsSelected())
+			return obj;
+
+	return NULL;
+
+}
+
+void CUMLEntityContainer::Import()
+/* ============================================================
+	Function :		CUMLEntityContainer::Import
+	Description :	Imports content into the currently selected
+					object from a h-file.
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Call to import information from a h-file
+					into an object.
+
+   ============================================================*/
+{
+
+	SendMessageToObjects(CMD_IMPORT, TRUE);
+
+}
+
+void CUMLEntityContainer::ImportFolder(const CHeaderImport& import)
+/* ============================================================
+	Function :		CUMLEntityContainer::ImportFolder
+	Description :	Adds the classes read from a folder of
+					header files to the diagram.
+	Access :		Public
+
+	Return :		void
+	Parameters :	const CHeaderImport& import	-	The parsed
+													folder.
+
+	Usage :			Call after "CHeaderImport::Parse". A package
+					is added to the current package for the
+					folder, and one package inside it for each
+					subfolder with headers. Each class goes into
+					the package of its folder, and is linked to
+					its base classes in the same package. The
+					packages are laid out with "AutoLayout".
+
+   ============================================================*/
+{
+
+	DIAGRAM_TRACE_SPAN(_T("CUMLEntityContainer::ImportFolder"));
+
+	if (import.GetClassCount() == 0)
+		return;
+
+	CString current = GetPackage();
+
+	// Titles in use, as package titles must be unique
+	CMapStringToPtr titles;
+	CObArray* data = GetData();
+	INT_PTR max = data->GetSize();
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		CDiagramEntity* obj = static_cast<CDiagramEntity*>(data->GetAt(t));
+		titles.SetAt(obj->GetTitle(), obj);
+	}
+
+	// The package of the folder itself goes below the current
+	// package contents
+	const CBoundsArray* bounds = GetBounds();
+	double top = bounds->GetMax(BOUNDS_BOTTOM, 0) + IMPORT_MARGIN;
+
+	CString title = import.GetFolder();
+	int found = title.ReverseFind(_TCHAR('\\'));
+	if (found != -1)
+		title = title.Mid(found + 1);
+
+	CUMLEntityPackage* root = new CUMLEntityPackage;
+	root->SetTitle(title);
+	title = root->GetTitle();
+	CString unique(title);
+	void* ptr = NULL;
+	for (int t = 2; titles.Lookup(unique, ptr); t++)
+		unique.Format(_T("%s%d"), static_cast<LPCTSTR>(title), t);
+	root->SetTitle(unique);
+	titles.SetAt(unique, root);
+
+	root->SetPackage(current);
+	root->SetDisplayOptions(GetDisplayOptions());
+	CSize size = root->GetMinimumSize();
+	root->SetRect(IMPORT_MARGIN, top, IMPORT_MARGIN + size.cx, top + size.cy);
+	Add(root);
+
+	CMapStringToPtr folders;
+	folders.SetAt(_T(""), root);
+	CObArray packages;
+	packages.Add(root);
+
+	// The classes. Only the first class with a name in a
+	// package gets lines from derived classes.
+	CMapStringToPtr classes;
+	CObArray added;
+	INT_PTR files = import.GetFileCount();
+	for (INT_PTR t = 0; t < files; t++)
+	{
+		CHeaderFile* file = import.GetFile(t);
+		INT_PTR count = file->parser.GetClassCount();
+		if (count == 0)
+			continue;
+
+		CUMLEntityPackage* package = GetImportPackage(file->folder, folders, titles, packages);
+		for (INT_PTR i = 0; i < count; i++)
+		{
+			CHeaderClass* cls = file->parser.GetClass(i);
+			CUMLEntityClass* obj;
+			if (cls->templateParameters.GetLength())
+				obj = new CUMLEntityClassTemplate;
+			else
+				obj = new CUMLEntityClass;
+
+			obj->ImportClass(cls);
+			obj->SetPackage(package->GetName());
+			obj->SetDisplayOptions(GetDisplayOptions());
+			size = obj->GetMinimumSize();
+			obj->SetRect(IMPORT_MARGIN, IMPORT_MARGIN, IMPORT_MARGIN + size.cx, IMPORT_MARGIN + size.cy);
+			Add(obj);
+
+			CString key = package->GetName() + _T(":") + cls->name;
+			if (!classes.Lookup(key, ptr))
+				classes.SetAt(key, obj);
+			titles.SetAt(obj->GetTitle(), obj);
+			added.Add(obj);
+		}
+	}
+
+	// Lines from the derived classes to their base classes
+	INT_PTR count = added.GetSize();
+	for (INT_PTR t = 0; t < count; t++)
+	{
+		CUMLEntityClass* obj = static_cast<CUMLEntityClass*>(added[t]);
+		CStringArray bases;
+		CStringArray access;
+		GetBaseClassArray(obj, bases, access);
+		INT_PTR baseCount = bases.GetSize();
+		for (INT_PTR i = 0; i < baseCount; i++)
+		{
+			// Template arguments and namespaces are not part
+			// of the class title
+			CString base = bases[i];
+			found = base.Find(_TCHAR('<'));
+			if (found != -1)
+				base = base.Left(found);
+			found = base.ReverseFind(_TCHAR(':'));
+			if (found != -1)
+				base = base.Mid(found + 1);
+
+			if (classes.Lookup(obj->GetPackage() + _T(":") + base, ptr) && ptr != obj)
+			{
+				CUMLEntityClass* target = static_cast<CUMLEntityClass*>(ptr);
+				CUMLLineSegment* line = new CUMLLineSegment;
+				line->SetStyle(STYLE_ARROWHEAD);
+				line->SetLink(LINK_START, obj->GetID());
+				line->SetLinkType(LINK_START, LINK_TOP);
+				line->SetLink(LINK_END, target->GetID());
+				line->SetLinkType(LINK_END, LINK_BOTTOM);
+				line->SetPackage(obj->GetPackage());
+
+				CRect start = obj->GetRect();
+				CRect end = target->GetRect();
+				line->SetRect(start.CenterPoint().x, start.top, end.CenterPoint().x, end.bottom);
+				Add(line);
+			}
+		}
+	}
+
+	// Arranging the contents of each new package
+	INT_PTR packageCount = packages.GetSize();
+	for (INT_PTR t = 0; t < packageCount; t++)
+	{
+		CUMLEntityPackage* package = static_cast<CUMLEntityPackage*>(packages[t]);
+		SetPackage(package->GetName());
+		AutoLayout();
+	}
+
+	SetPackage(current);
+
+}
+
+CUMLEntityPackage* CUMLEntityContainer::GetImportPackage(const CString& folder, CMapStringToPtr& folders, CMapStringToPtr& titles, CObArray& packages)
+/* ============================================================
+	Function :		CUMLEntityContainer::GetImportPackage
+	Description :	Gets the package of a folder in a header
+					import, adding it if needed.
+	Access :		Private
+
+	Return :		CUMLEntityPackage*			-	The package.
+	Parameters :	const CString& folder		-	Folder,
+													relative to
+													the import
+													folder.
+					CMapStringToPtr& folders	-	Packages by
+													folder.
+					CMapStringToPtr& titles		-	Titles in use.
+					CObArray& packages			-	Packages
+													added.
+
+	Usage :			Called from "ImportFolder". The package of
+					the parent folder is added first, so the
+					packages nest as the folders do. "folders"
+					must hold the package of the import folder
+					itself, with an empty key.
+
+   ============================================================*/
+{
+
+	void* ptr = NULL;
+	if (folders.Lookup(folder, ptr))
+		return static_cast<CUMLEntityPackage*>(ptr);
+
+	CString parentFolder;
+	CString title(folder);
+	int found = folder.ReverseFind(_TCHAR('\\'));
+	if (found != -1)
+	{
+		parentFolder = folder.Left(found);
+		title = folder.Mid(found + 1);
+	}
+
+	CUMLEntityPackage* parent = GetImportPackage(parentFolder, folders, titles, packages);
+
+	CUMLEntityPackage* package = new CUMLEntityPackage;
+	package->SetTitle(title);
+	title = package->GetTitle();
+	CString unique(title);
+	for (int t = 2; titles.Lookup(unique, ptr); t++)
+		unique.Format(_T("%s%d"), static_cast<LPCTSTR>(title), t);
+	package->SetTitle(unique);
+	titles.SetAt(unique, package);
+
+	package->SetPackage(parent->GetName());
+	package->SetDisplayOptions(GetDisplayOptions());
+	CSize size = package->GetMinimumSize();
+	package->SetRect(IMPORT_MARGIN, IMPORT_MARGIN, IMPORT_MARGIN + size.cx, IMPORT_MARGIN + size.cy);
+	Add(package);
+
+	folders.SetAt(folder, package);
+	packages.Add(package);
+
+	return package;
+
+}
+
+void CUMLEntityContainer::GetIncludeList(CUMLEntityClass* inobj, CStringArray& stringarray) const
+/* ============================================================
+	Function :		CUMLEntityContainer::GetIncludeList
+	Description :	Get a list of the "inobj" class inlcudes.
+	Access :		Private
+
+	Return :		void
+	Parameters :	CUMLEntityClass* inobj		-	The object to get
+													includes for
+					CStringArray& stringarray	-	Results
+
+	Usage :			Call to get a list of the classes "inobj"
+					is composed of. This is a list that will be
+					used to generate includes and forward
+					declarations for a h-file. Strings prefixed
+					with a hash-mark should be converted to a forward
+					declaration.
+
+					The list is created from both connections,
+					class members and operation parameters
+
+   ============================================================*/
+{
+
+	CStringArray stra;
+	INT_PTR max = GetSize();
+	CStringArray classes;
+	GetClassList(classes);
+
+	CStringArray baseClassArray;
+	CStringArray baseClassAccessArray;
+	GetBaseClassArray(inobj, baseClassArray, baseClassAccessArray);
+	INT_PTR size = baseClassArray.GetSize();
+	for (INT_PTR t = 0; t < size; t++)
+	{
+		if (InClasslist(baseClassArray[t], classes))
+			stra.Add(baseClassArray[t]);
+	}
+
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		CUMLLineSegment* line = CUMLLineSegment::Cast(GetAt(t));
+		if (line)
+		{
+			if (line->IsSingleLineSegment())
+			{
+				if (line->GetLink(LINK_END) == inobj->GetID())
+				{
+					if (line->GetStyle() & STYLE_FILLED_DIAMOND)
+					{
+						CUMLEntityClass* node = NULL;
+						node = CUMLEntityClass::Cast(GetStartNode(line));
+
+						if (node && node != inobj)
+						{
+							CString title = node->GetTitle();
+							AddString(title, stra);
+
+						}
+					}
 				}
 			}
 			else
 			{
-				if (line->GetLink(LINK_END) == inobj->GetName() || line->GetLink(LINK_START) == inobj->GetName())
+				if (line->GetLink(LINK_END) == inobj->GetID() || line->GetLink(LINK_START) == inobj->GetID())
 				{
 					if (line->GetStyle() & STYLE_FILLED_DIAMOND)
 					{
 						CUMLEntityClass* node = NULL;
-						if (line->GetLink(LINK_END) == inobj->GetName())
-							node = dynamic_cast<CUMLEntityClass*>(GetStartNode(line));
+						if (line->GetLink(LINK_END) == inobj->GetID())
+							node = CUMLEntityClass::Cast(GetStartNode(line));
 						else
-							node = dynamic_cast<CUMLEntityClass*>(GetEndNode(line));
+							node = CUMLEntityClass::Cast(GetEndNode(line));
 
 						if (node && node != inobj)
 						{
@@ -2416,17 +3495,17 @@ void CUMLEntityContainer::GetDependencyList(CUMLEntityClass* inobj, CStringArray
 	INT_PTR max = GetSize();
 	for (INT_PTR t = 0; t < max; t++)
 	{
-		CUMLLineSegment* line = dynamic_cast<CUMLLineSegment*>(GetAt(t));
+		CUMLLineSegment* line = CUMLLineSegment::Cast(GetAt(t));
 		if (line)
 		{
 			if (line->IsSingleLineSegment())
 			{
-				if (line->GetLink(LINK_END) == inobj->GetName())
+				if (line->GetLink(LINK_END) == inobj->GetID())
 				{
 					if (line->GetStyle() & STYLE_FILLED_ARROWHEAD && line->GetStyle() & STYLE_DASHED)
 					{
 						CUMLEntityClass* node = NULL;
-						node = dynamic_cast<CUMLEntityClass*>(GetStartNode(line));
+						node = CUMLEntityClass::Cast(GetStartNode(line));
 
 						if (node && node != inobj)
 						{
@@ -2440,15 +3519,15 @@ void CUMLEntityContainer::GetDependencyList(CUMLEntityClass* inobj, CStringArray
 			}
 			else
 			{
-				if (line->GetLink(LINK_START) == inobj->GetName() || line->GetLink(LINK_END) == inobj->GetName())
+				if (line->GetLink(LINK_START) == inobj->GetID() || line->GetLink(LINK_END) == inobj->GetID())
 				{
 					if (!(line->GetStyle() & STYLE_FILLED_ARROWHEAD) && line->GetStyle() & STYLE_DASHED)
 					{
 						CUMLEntityClass* node = NULL;
-						if (line->GetLink(LINK_START) == inobj->GetName())
-							node = dynamic_cast<CUMLEntityClass*>(GetEndNode(line));
+						if (line->GetLink(LINK_START) == inobj->GetID())
+							node = CUMLEntityClass::Cast(GetEndNode(line));
 						else
-							node = dynamic_cast<CUMLEntityClass*>(GetStartNode(line));
+							node = CUMLEntityClass::Cast(GetStartNode(line));
 
 						if (node && node != inobj)
 						{
@@ -2553,7 +3632,7 @@ BOOL CUMLEntityContainer::VirtualizeClasses()
 	INT_PTR max = GetSize();
 	for (INT_PTR t = 0; t < max; t++)
 	{
-		CUMLEntityClass* obj = dynamic_cast<CUMLEntityClass*>(GetAt(t));
+		CUMLEntityClass* obj = CUMLEntityClass::Cast(GetAt(t));
 		if (obj)
 		{
 			CStringArray baseClassArray;
@@ -2563,7 +3642,7 @@ BOOL CUMLEntityContainer::VirtualizeClasses()
 			{
 				for (INT_PTR i = 0; i < baseClassArray.GetSize(); i++)
 				{
-					CUMLEntityClass* base = dynamic_cast<CUMLEntityClass*>(GetTitledObject(baseClassArray[i]));
+					CUMLEntityClass* base = CUMLEntityClass::Cast(GetTitledObject(baseClassArray[i]));
 					if (base)
 					{
 						INT_PTR operations = obj->GetOperations();
@@ -2642,7 +3721,7 @@ BOOL CUMLEntityContainer::BaseClassClasses()
 	INT_PTR max = GetSize();
 	for (INT_PTR t = 0; t < max; t++)
 	{
-		CUMLEntityClass* obj = dynamic_cast<CUMLEntityClass*>(GetAt(t));
+		CUMLEntityClass* obj = CUMLEntityClass::Cast(GetAt(t));
 		if (obj)
 		{
 			CStringArray baseClassArray;
@@ -2690,7 +3769,7 @@ BOOL CUMLEntityContainer::AddInterfacesToClasses()
 	INT_PTR max = GetSize();
 	for (INT_PTR t = 0; t < max; t++)
 	{
-		CUMLEntityClass* obj = dynamic_cast<CUMLEntityClass*>(GetAt(t));
+		CUMLEntityClass* obj = CUMLEntityClass::Cast(GetAt(t));
 		if (obj)
 		{
 			CStringArray baseClassArray;
@@ -2700,7 +3779,7 @@ BOOL CUMLEntityContainer::AddInterfacesToClasses()
 			{
 				for (INT_PTR i = 0; i < baseClassArray.GetSize(); i++)
 				{
-					CUMLEntityClass* base = dynamic_cast<CUMLEntityClass*>(GetTitledObject(baseClassArray[i]));
+					CUMLEntityClass* base = CUMLEntityClass::Cast(GetTitledObject(baseClassArray[i]));
 					if (base)
 					{
 						INT_PTR operations = obj->GetOperations();
@@ -2807,7 +3886,7 @@ void CUMLEntityContainer::GetClassList(CStringArray& stra) const
 	for (INT_PTR t = 0; t < max; t++)
 	{
 
-		CUMLEntityClass* obj = dynamic_cast<CUMLEntityClass*>(GetAt(t));
+		CUMLEntityClass* obj = CUMLEntityClass::Cast(GetAt(t));
 		if (obj)
 		{
 			CString name = obj->GetTitle();
@@ -2942,16 +4021,22 @@ void CUMLEntityContainer::Load(CArchive& ar)
 	Parameters :	CArchive& ar	-	Archive to load from
 
 	Usage :			Call to load a diagram from a "CArchive".
+					If it is a manifest, only the top level
+					package is read. Set the project path
+					first, to find the package files.
 
    ============================================================*/
 {
 
+	DIAGRAM_TRACE_SPAN(_T("CUMLEntityContainer::Load"));
+
 	Clear();
+	ClearProject();
 	CString str;
 	while (ar.ReadString(str))
 	{
 
-		if (!FromString(str))
+		if (!FromString(str) && !ProjectFromString(str))
 		{
 			CDiagramEntity* obj = CUMLControlFactory::CreateFromString(str);
 			if (obj)
@@ -2959,6 +4044,7 @@ void CUMLEntityContainer::Load(CArchive& ar)
 		}
 	}
 
+	LoadPackage(_T(""));
 	SetModified(TRUE);
 
 }
@@ -2981,27 +4067,756 @@ void CUMLEntityContainer::Load(CString& filename)
    ============================================================*/
 {
 
+	DIAGRAM_TRACE_SPAN(_T("CUMLEntityContainer::Load"));
+
 	CTextFile		file;
 	CStringArray	stra;
 	if (file.ReadTextFile(filename, stra))
 	{
 		Clear();
+		ClearProject();
+		m_projectPath = filename;
 		INT_PTR max = stra.GetSize();
 		for (INT_PTR t = 0; t < max; t++)
 		{
-			if (!FromString(stra[t]))
+			if (!FromString(stra[t]) && !ProjectFromString(stra[t]))
 			{
 				CDiagramEntity* obj = CUMLControlFactory::CreateFromString(stra[t]);
 				if (obj)
 					Add(obj);
 			}
 		}
+
+		LoadPackage(_T(""));
 	}
 	else
 		AfxMessageBox(file.GetErrorMessage());
 
 }
 
+void CUMLEntityContainer::SetProjectPath(const CString& path)
+/* ============================================================
+	Function :		CUMLEntityContainer::SetProjectPath
+	Description :	Sets the path of the diagram file.
+	Access :		Public
+
+	Return :		void
+	Parameters :	const CString& path	-	Path of the file.
+
+	Usage :			Call before "Load", so the package files
+					of a manifest can be found. They are kept
+					in a directory named as the file, with the
+					extension ".packages".
+
+   ============================================================*/
+{
+
+	m_projectPath = path;
+
+}
+
+void CUMLEntityContainer::MoveProject(const CString& path)
+/* ============================================================
+	Function :		CUMLEntityContainer::MoveProject
+	Description :	Sets the path the diagram will be saved to.
+	Access :		Public
+
+	Return :		void
+	Parameters :	const CString& path	-	Path of the file.
+
+	Usage :			Call before "Save". If the diagram is
+					saved as package files to a new path, all
+					packages are read from the old path first,
+					and written to the new one.
+
+   ============================================================*/
+{
+
+	if (m_packageFiles && path.CompareNoCase(m_projectPath) != 0)
+	{
+		LoadAllPackages();
+		SetPackageModified(_T("all"));
+	}
+
+	m_projectPath = path;
+
+}
+
+CString CUMLEntityContainer::GetProjectPath() const
+/* ============================================================
+	Function :		CUMLEntityContainer::GetProjectPath
+	Description :	Gets the path of the diagram file.
+	Access :		Public
+
+	Return :		CString	-	The path, empty if not set.
+	Parameters :	none
+
+	Usage :			Call to get the path of the manifest.
+
+   ============================================================*/
+{
+
+	return m_projectPath;
+
+}
+
+BOOL CUMLEntityContainer::HasPackageFiles() const
+/* ============================================================
+	Function :		CUMLEntityContainer::HasPackageFiles
+	Description :	Checks if the diagram is saved as a
+					manifest and package files.
+	Access :		Public
+
+	Return :		BOOL	-	"TRUE" if it is.
+	Parameters :	none
+
+	Usage :			Diagrams are saved as package files if
+					they were read from a manifest, or if
+					"SetPackageFiles" was called.
+
+   ============================================================*/
+{
+
+	return m_packageFiles;
+
+}
+
+void CUMLEntityContainer::SetPackageFiles(BOOL packageFiles)
+/* ============================================================
+	Function :		CUMLEntityContainer::SetPackageFiles
+	Description :	Sets if the diagram is saved as a manifest
+					and package files.
+	Access :		Public
+
+	Return :		void
+	Parameters :	BOOL packageFiles	-	"TRUE" to save as
+											package files,
+											"FALSE" to save a
+											single file.
+
+	Usage :			Call before "Save", when the user picks
+					the format. When package files are turned
+					on, all packages are written by the next
+					save. When they are turned off, all
+					packages are read first.
+
+   ============================================================*/
+{
+
+	if (packageFiles == m_packageFiles)
+		return;
+
+	if (packageFiles)
+	{
+		// Everything is in memory
+		m_packageFiles = TRUE;
+		m_loadedPackages.SetAt(_T(""), NULL);
+		m_modifiedPackages.SetAt(_T(""), NULL);
+
+		INT_PTR max = GetData()->GetSize();
+		for (INT_PTR t = 0; t < max; t++)
+		{
+			CUMLEntity* obj = static_cast<CUMLEntity*>(GetData()->GetAt(t));
+			m_modifiedPackages.SetAt(obj->GetPackage(), NULL);
+			if (CUMLEntityPackage::Cast(obj))
+				m_modifiedPackages.SetAt(obj->GetName(), NULL);
+		}
+	}
+	else
+	{
+		LoadAllPackages();
+		ClearProject();
+	}
+
+}
+
+BOOL CUMLEntityContainer::LoadPackage(const CString& package)
+/* ============================================================
+	Function :		CUMLEntityContainer::LoadPackage
+	Description :	Reads the file of a package.
+	Access :		Public
+
+	Return :		BOOL					-	"FALSE" if the
+												file could not
+												be read.
+	Parameters :	const CString& package	-	Package to read,
+												empty for the
+												top level.
+
+	Usage :			Called by "SetPackage". Does nothing if the
+					package is already read. The packages
+					containing it are read first, as are the
+					packages with lines to or from it in the
+					manifest index, so that links can always
+					be followed.
+
+   ============================================================*/
+{
+
+	DIAGRAM_TRACE_SPAN(_T("CUMLEntityContainer::LoadPackage"));
+
+	if (IsPackageLoaded(package))
+		return TRUE;
+
+	m_loadedPackages.SetAt(package, NULL);
+
+	CString parent;
+	if (package.GetLength() && m_packageParents.Lookup(package, parent))
+		LoadPackage(parent);
+
+	BOOL result = FALSE;
+	BOOL modified = IsModified();
+	CTextFile		file;
+	CStringArray	stra;
+	CString filename = GetPackageFile(package);
+	if (m_projectPath.GetLength() && file.ReadTextFile(filename, stra))
+	{
+		INT_PTR max = stra.GetSize();
+		for (INT_PTR t = 0; t < max; t++)
+		{
+			CDiagramEntity* obj = CUMLControlFactory::CreateFromString(stra[t]);
+			if (obj)
+				Add(obj);
+		}
+		result = TRUE;
+	}
+	else
+		SetErrorMessage(file.GetErrorMessage());
+
+	// Reading is not a change
+	SetModified(modified);
+
+	INT_PTR max = m_packageLinks.GetSize();
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		if (m_packageLinks[t].source == package)
+			LoadPackage(m_packageLinks[t].package);
+		else if (m_packageLinks[t].package == package)
+			LoadPackage(m_packageLinks[t].source);
+	}
+
+	return result;
+
+}
+
+void CUMLEntityContainer::LoadAllPackages()
+/* ============================================================
+	Function :		CUMLEntityContainer::LoadAllPackages
+	Description :	Reads the files of all packages.
+	Access :		Public
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Call before working on the complete
+					diagram, for example when exporting.
+
+   ============================================================*/
+{
+
+	if (!m_packageFiles)
+		return;
+
+	LoadPackage(_T(""));
+
+	CString name;
+	CString parent;
+	POSITION pos = m_packageParents.GetStartPosition();
+	while (pos)
+	{
+		m_packageParents.GetNextAssoc(pos, name, parent);
+		LoadPackage(name);
+	}
+
+}
+
+BOOL CUMLEntityContainer::IsPackageLoaded(const CString& package) const
+/* ============================================================
+	Function :		CUMLEntityContainer::IsPackageLoaded
+	Description :	Checks if the objects of a package are in
+					memory.
+	Access :		Public
+
+	Return :		BOOL					-	"TRUE" if they
+												are.
+	Parameters :	const CString& package	-	Package to check.
+
+	Usage :			Packages not in the manifest were created
+					since it was read, and are always in
+					memory.
+
+   ============================================================*/
+{
+
+	if (!m_packageFiles)
+		return TRUE;
+
+	CString parent;
+	if (package.GetLength() && !m_packageParents.Lookup(package, parent))
+		return TRUE;
+
+	void* ptr;
+	return m_loadedPackages.Lookup(package, ptr);
+
+}
+
+void CUMLEntityContainer::SaveProject(CArchive& ar)
+/* ============================================================
+	Function :		CUMLEntityContainer::SaveProject
+	Description :	Saves the diagram as a manifest and package
+					files.
+	Access :		Private
+
+	Return :		void
+	Parameters :	CArchive& ar	-	Archive to save the
+										manifest to.
+
+	Usage :			The manifest has the paper settings, the
+					packages with their parents, and an index
+					of the lines ending in another package.
+					Package files are only written if the
+					package is in memory and has changed, so
+					the time to save doesn't depend on the
+					size of the diagram. Files of removed
+					packages are deleted.
+
+   ============================================================*/
+{
+
+	CObArray* objs = GetData();
+	INT_PTR max = objs->GetSize();
+
+	// Packages in memory, with their parents. The
+	// objects of a removed package are kept as well.
+	CMapStringToString	parents;
+	CStringArray		packages;
+	CString				parent;
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		CUMLEntity* obj = static_cast<CUMLEntity*>(objs->GetAt(t));
+		if (CUMLEntityPackage::Cast(obj))
+		{
+			if (!parents.Lookup(obj->GetName(), parent))
+				packages.Add(obj->GetName());
+			parents.SetAt(obj->GetName(), obj->GetPackage());
+		}
+	}
+
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		CString package = static_cast<CUMLEntity*>(objs->GetAt(t))->GetPackage();
+		if (package.GetLength() && !parents.Lookup(package, parent))
+		{
+			if (!m_packageParents.Lookup(package, parent))
+				parent.Empty();
+			packages.Add(package);
+			parents.SetAt(package, parent);
+		}
+	}
+
+	// Packages not read are kept if the package holding
+	// them is kept and not read either. If it is read,
+	// the package object shows if they still exist.
+	CString name;
+	BOOL added = TRUE;
+	while (added)
+	{
+		added = FALSE;
+		POSITION pos = m_packageParents.GetStartPosition();
+		while (pos)
+		{
+			CString found;
+			m_packageParents.GetNextAssoc(pos, name, parent);
+			if (!IsPackageLoaded(name) && !parents.Lookup(name, found) &&
+				!IsPackageLoaded(parent) && parents.Lookup(parent, found))
+			{
+				packages.Add(name);
+				parents.SetAt(name, parent);
+				added = TRUE;
+			}
+		}
+	}
+
+	// Index of the lines ending in another package
+	CArray< CPackageLink, CPackageLink& > links;
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		CUMLLineSegment* line = CUMLLineSegment::Cast(static_cast<CDiagramEntity*>(objs->GetAt(t)));
+		if (line)
+		{
+			int ends[2] = { LINK_START, LINK_END };
+			for (int end = 0; end < 2; end++)
+			{
+				ULONGLONG link = line->GetLink(ends[end]);
+				CUMLEntity* obj = static_cast<CUMLEntity*>(GetObjectByID(link));
+				if (obj && !CUMLLineSegment::Cast(obj))
+				{
+					if (!CStringTable::IsEqual(obj->GetPackage(), line->GetPackage()))
+					{
+						CPackageLink item;
+						item.object = CLinkFactory::ToString(link);
+						item.package = obj->GetPackage();
+						item.source = line->GetPackage();
+						links.Add(item);
+					}
+				}
+			}
+		}
+	}
+
+	INT_PTR count = m_packageLinks.GetSize();
+	for (INT_PTR t = 0; t < count; t++)
+		if (!IsPackageLoaded(m_packageLinks[t].source) && parents.Lookup(m_packageLinks[t].source, parent))
+			links.Add(m_packageLinks[t]);
+
+	// Moving an object changes the lines to it from
+	// other packages
+	void* ptr;
+	count = links.GetSize();
+	for (INT_PTR t = 0; t < count; t++)
+	{
+		if (m_modifiedPackages.Lookup(links[t].package, ptr))
+			m_modifiedPackages.SetAt(links[t].source, NULL);
+		else if (m_modifiedPackages.Lookup(links[t].source, ptr))
+			m_modifiedPackages.SetAt(links[t].package, NULL);
+	}
+
+	// The manifest
+	ar.WriteString(GetString() + _T("\r\n"));
+	ar.WriteString(_T("manifest:1;\r\n"));
+	INT_PTR packageCount = packages.GetSize();
+	for (INT_PTR t = 0; t < packageCount; t++)
+	{
+		parents.Lookup(packages[t], parent);
+		ar.WriteString(_T("manifest_package:") + packages[t] + _T(",") + parent + _T(";\r\n"));
+	}
+	for (INT_PTR t = 0; t < count; t++)
+		ar.WriteString(_T("manifest_link:") + links[t].object + _T(",") + links[t].package + _T(",") + links[t].source + _T(";\r\n"));
+
+	// The changed packages, collected in one pass
+	CDiskObject disk;
+	CString directory = GetPackageFile(_T(""));
+	disk.CreateDirectory(directory.Left(directory.ReverseFind(_TCHAR('\\'))));
+
+	packages.InsertAt(0, _T(""));
+	packageCount++;
+	CMapStringToOb contents;
+	for (INT_PTR t = 0; t < packageCount; t++)
+	{
+		if (IsPackageLoaded(packages[t]) &&
+			(m_modifiedPackages.Lookup(packages[t], ptr) || !disk.FileExists(GetPackageFile(packages[t]))))
+			contents.SetAt(packages[t], new CStringArray);
+	}
+
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		CObject* stra;
+		CDiagramEntity* obj = static_cast<CDiagramEntity*>(objs->GetAt(t));
+		if (contents.Lookup(static_cast<CUMLEntity*>(obj)->GetPackage(), stra))
+			static_cast<CStringArray*>(stra)->Add(obj->GetString() + _T("\r\n"));
+	}
+
+	POSITION pos = contents.GetStartPosition();
+	while (pos)
+	{
+		CObject* stra;
+		contents.GetNextAssoc(pos, name, stra);
+
+		CTextFile file;
+		CString filename = GetPackageFile(name);
+		if (file.WriteTextFile(filename, *static_cast<CStringArray*>(stra)))
+			m_modifiedPackages.RemoveKey(name);
+		else
+			AfxMessageBox(file.GetErrorMessage());
+
+		delete stra;
+	}
+
+	// Removed packages
+	pos = m_packageParents.GetStartPosition();
+	while (pos)
+	{
+		m_packageParents.GetNextAssoc(pos, name, parent);
+		if (!parents.Lookup(name, parent))
+		{
+			::DeleteFile(GetPackageFile(name));
+			m_loadedPackages.RemoveKey(name);
+			m_modifiedPackages.RemoveKey(name);
+		}
+	}
+
+	// Packages created since the manifest was read are
+	// now in it, and in memory
+	for (INT_PTR t = 0; t < packageCount; t++)
+		if (IsPackageLoaded(packages[t]))
+			m_loadedPackages.SetAt(packages[t], NULL);
+
+	m_packageParents.RemoveAll();
+	pos = parents.GetStartPosition();
+	while (pos)
+	{
+		parents.GetNextAssoc(pos, name, parent);
+		m_packageParents.SetAt(name, parent);
+	}
+
+	m_packageLinks.Copy(links);
+	SetModified(FALSE);
+
+}
+
+BOOL CUMLEntityContainer::ProjectFromString(const CString& str)
+/* ============================================================
+	Function :		CUMLEntityContainer::ProjectFromString
+	Description :	Reads a manifest line.
+	Access :		Private
+
+	Return :		BOOL				-	"TRUE" if "str" was
+											a manifest line.
+	Parameters :	const CString& str	-	Line to read.
+
+	Usage :			The lines are "manifest:version;",
+					"manifest_package:name,parent;" and
+					"manifest_link:object,package,source;".
+
+   ============================================================*/
+{
+
+	BOOL result = FALSE;
+
+	CTokenizer main(str, _T(":"));
+	CString header;
+	CString data;
+	if (main.GetSize() == 2)
+	{
+		main.GetAt(0, header);
+		main.GetAt(1, data);
+		header.TrimLeft();
+		header.TrimRight();
+		data.TrimLeft();
+		data.TrimRight();
+		data = data.Left(data.GetLength() - 1);
+
+		CTokenizer tok(data);
+		if (header == _T("manifest"))
+		{
+			m_packageFiles = TRUE;
+			result = TRUE;
+		}
+		else if (header == _T("manifest_package") && tok.GetSize() == 2)
+		{
+			CString name;
+			CString parent;
+			tok.GetAt(0, name);
+			tok.GetAt(1, parent);
+			m_packageParents.SetAt(name, parent);
+			result = TRUE;
+		}
+		else if (header == _T("manifest_link") && tok.GetSize() == 3)
+		{
+			CPackageLink link;
+			tok.GetAt(0, link.object);
+			tok.GetAt(1, link.package);
+			tok.GetAt(2, link.source);
+			m_packageLinks.Add(link);
+			result = TRUE;
+		}
+	}
+
+	return result;
+
+}
+
+void CUMLEntityContainer::ClearProject()
+/* ============================================================
+	Function :		CUMLEntityContainer::ClearProject
+	Description :	Forgets the manifest.
+	Access :		Private
+
+	Return :		void
+	Parameters :	none
+
+	Usage :			Called before a diagram is read. The
+					project path is kept.
+
+   ============================================================*/
+{
+
+	m_packageFiles = FALSE;
+	m_packageParents.RemoveAll();
+	m_packageLinks.RemoveAll();
+	m_loadedPackages.RemoveAll();
+	m_modifiedPackages.RemoveAll();
+
+}
+
+CString CUMLEntityContainer::GetPackageFile(const CString& package) const
+/* ============================================================
+	Function :		CUMLEntityContainer::GetPackageFile
+	Description :	Gets the path of a package file.
+	Access :		Private
+
+	Return :		CString					-	The path.
+	Parameters :	const CString& package	-	Package, empty
+												for the top
+												level.
+
+	Usage :			The top level is "root". Package names
+					can have any characters, so the files of
+					packages are named "package-", the name
+					with characters other than letters, digits,
+					"_" and "-" replaced by "_", and a hash of
+					the name. The hash keeps names that only
+					differ in case or in replaced characters
+					apart.
+
+   ============================================================*/
+{
+
+	CString directory(m_projectPath);
+	int found = directory.ReverseFind(_TCHAR('.'));
+	if (found > directory.ReverseFind(_TCHAR('\\')))
+		directory = directory.Left(found);
+
+	CString name(_T("root"));
+	if (package.GetLength())
+	{
+		CString clean(package.Left(PACKAGE_FILE_NAME_LENGTH));
+		int length = clean.GetLength();
+		for (int t = 0; t < length; t++)
+		{
+			TCHAR c = clean[t];
+			if (!_istascii(c) || !(_istalnum(c) || c == _TCHAR('_') || c == _TCHAR('-')))
+				clean.SetAt(t, _TCHAR('_'));
+		}
+
+		// FNV-1a
+		DWORD hash = 2166136261;
+		length = package.GetLength();
+		for (int t = 0; t < length; t++)
+		{
+			hash ^= static_cast<DWORD>(package[t]);
+			hash *= 16777619;
+		}
+
+		name.Format(_T("package-%s-%08x"), clean.GetString(), hash);
+	}
+
+	return directory + _T(".packages\\") + name + _T(".umlpackage");
+
+}
+
+void CUMLEntityContainer::SetPackageModified(const CString& package)
+/* ============================================================
+	Function :		CUMLEntityContainer::SetPackageModified
+	Description :	Marks a package as changed.
+	Access :		Private
+
+	Return :		void
+	Parameters :	const CString& package	-	Package, 'all'
+												for every
+												package.
+
+	Usage :			Changed packages are written by the next
+					save.
+
+   ============================================================*/
+{
+
+	if (package == _T("all"))
+	{
+		m_modifiedPackages.SetAt(_T(""), NULL);
+
+		CString name;
+		CString parent;
+		POSITION pos = m_packageParents.GetStartPosition();
+		while (pos)
+		{
+			m_packageParents.GetNextAssoc(pos, name, parent);
+			m_modifiedPackages.SetAt(name, NULL);
+		}
+	}
+	else
+		m_modifiedPackages.SetAt(package, NULL);
+
+}
+
+void CUMLEntityContainer::GetUnloadedPackages(CStringArray& packages) const
+/* ============================================================
+	Function :		CUMLEntityContainer::GetUnloadedPackages
+	Description :	Gets the packages not read from their
+					files.
+	Access :		Private
+
+	Return :		void
+	Parameters :	CStringArray& packages	-	Gets the
+												packages.
+
+	Usage :			Stored with each undo level.
+
+   ============================================================*/
+{
+
+	packages.RemoveAll();
+	if (!m_packageFiles)
+		return;
+
+	if (!IsPackageLoaded(_T("")))
+		packages.Add(_T(""));
+
+	CString name;
+	CString parent;
+	POSITION pos = m_packageParents.GetStartPosition();
+	while (pos)
+	{
+		m_packageParents.GetNextAssoc(pos, name, parent);
+		if (!IsPackageLoaded(name))
+			packages.Add(name);
+	}
+
+}
+
+void CUMLEntityContainer::SetUnloadedPackages(const CStringArray& packages)
+/* ============================================================
+	Function :		CUMLEntityContainer::SetUnloadedPackages
+	Description :	Sets the packages not read from their
+					files.
+	Access :		Private
+
+	Return :		void
+	Parameters :	const CStringArray& packages	-	The
+														packages.
+
+	Usage :			Called when an undo level is restored.
+					The other packages in the manifest are in
+					the restored data.
+
+   ============================================================*/
+{
+
+	if (!m_packageFiles)
+		return;
+
+	m_loadedPackages.RemoveAll();
+	m_loadedPackages.SetAt(_T(""), NULL);
+
+	CString name;
+	CString parent;
+	POSITION pos = m_packageParents.GetStartPosition();
+	while (pos)
+	{
+		m_packageParents.GetNextAssoc(pos, name, parent);
+		m_loadedPackages.SetAt(name, NULL);
+	}
+
+	INT_PTR max = packages.GetSize();
+	for (INT_PTR t = 0; t < max; t++)
+	{
+		m_loadedPackages.RemoveKey(packages[t]);
+		m_modifiedPackages.RemoveKey(packages[t]);
+	}
+
+}
+
 CUMLLineSegment* CUMLEntityContainer::GetLinkBetween(CUMLEntity* start, CUMLEntity* end) const
 /* ============================================================
 	Function :		CUMLEntityContainer::GetLinkBetween
@@ -3026,7 +4841,7 @@ CUMLLineSegment* CUMLEntityContainer::GetLinkBetween(CUMLEntity* start, CUMLEnti
 	INT_PTR max = GetSize();
 	for (INT_PTR t = 0; t < max; t++)
 	{
-		CUMLLineSegment* link = dynamic_cast<CUMLLineSegment*>(GetAt(t));
+		CUMLLineSegment* link = CUMLLineSegment::Cast(GetAt(t));
 		if (link)
 		{
 			startnode = GetStartNode(link);
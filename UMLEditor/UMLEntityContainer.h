@@ -10,6 +10,12 @@
 #include "UMLEntityDummy.h"
 #include "UMLUndoItem.h"
 
+class CHeaderImport;
+class CUMLEntityPackage;
+
+// Objects or entries by numeric id, see "CDiagramEntity::GetID"
+typedef CMap< ULONGLONG, ULONGLONG, void*, void* > CMapIDToPtr;
+
 class CUMLEntityContainer : public CDiagramEntityContainer {
 
 public:
@@ -21,21 +27,28 @@ public:
 
 	// Overrides
 	virtual void			RemoveAt(INT_PTR index);
-	virtual void			RemoveAllSelected();
+	virtual INT_PTR			RemoveIf(ENTITYPREDICATE predicate, LPVOID data = NULL);
 	virtual CDiagramEntity* GetAt(INT_PTR index) const;
 	virtual void			Undo();
 	virtual void			Redo();
 	virtual void			Snapshot();
 	virtual void			Push(CObArray* stack);
 	virtual void			Export(CStringArray& stra, UINT format = 0) const;
+	virtual void			GetMemoryUsage(CDiagramMemoryUsage& usage) const;
 
 	// Objects
 	CUMLEntity*		GetNamedObject(const CString& name) const;
+	CUMLEntity*		GetNamedObject(ULONGLONG id) const;
 	CUMLEntity*		GetTitledObject(const CString& name) const;
 	CDiagramEntity*	GetSelectedObject() const;
-	void			AdjustLinkedObjects(CUMLEntity* in, CUMLEntity* filter = NULL);
+	int				AdjustLinkedObjects(CUMLEntity* in, CUMLEntity* filter = NULL);
+	int				AdjustLinkedObjects(const CObArray& moved, CUMLEntity* filter = NULL);
 	CUMLEntity*		GetObjectAt(INT_PTR index) const;
 
+	// Views
+	INT_PTR			GetSegments(CObArray& segments) const;
+	INT_PTR			GetNodes(CObArray& nodes) const;
+
 	// Selection
 	INT_PTR			GetSelectCount() const;
 
@@ -59,11 +72,25 @@ public:
 	BOOL		IsLinkSelected() const;
 	void		FlipLink();
 
+	// Layout
+	void		AutoLayout();
+	void		RouteLines();
+
 	// Packages
 	void		SetPackage(const CString& package);
 	CString		GetPackage() const;
 	BOOL		PackageExists(const CString& name, CUMLEntity* filter);
 
+	// Package files
+	void		SetProjectPath(const CString& path);
+	void		MoveProject(const CString& path);
+	CString		GetProjectPath() const;
+	BOOL		HasPackageFiles() const;
+	void		SetPackageFiles(BOOL packageFiles);
+	BOOL		LoadPackage(const CString& package);
+	void		LoadAllPackages();
+	BOOL		IsPackageLoaded(const CString& package) const;
+
 	// Accessors
 	void		SetDisplayOptions(int displayOption);
 	int			GetDisplayOptions() const;
@@ -82,6 +109,7 @@ public:
 	void		Load(CArchive& ar);
 	void		Load(CString& filename);
 	void		Import();
+	void		ImportFolder(const CHeaderImport& import);
 
 	void		GetIncludeList(CUMLEntityClass* inobj, CStringArray& stringarray) const;
 	void		GetDependencyList(CUMLEntityClass* inobj, CStringArray& stringarray) const;
@@ -90,14 +118,30 @@ public:
 	BOOL		AddInterfacesToClasses();
 
 	// Misc
-	void		FixLinks(CObArray *arr);
-	CSize		CalcMinimumRestraints(const CString& name);
+	static void	FixLinks(CObArray *arr);
+	CSize		CalcMinimumRestraints(ULONGLONG id);
 	CString		GetObjectPath(CUMLEntity* inobj) const;
 
 private:
 	// Private helpers
 	void		DeleteLine(CUMLLineSegment* from);
+	void		MarkLine(CUMLLineSegment* from, const CMapIDToPtr& ends, const CMapIDToPtr& starts, CMapPtrToPtr& marked, CMapPtrToPtr& attached) const;
 	CPoint		GetLinkPosition(CUMLEntity* obj, CUMLLineSegment* line) const;
+	INT_PTR		GetChain(CUMLLineSegment* line, CObArray& chain) const;
+	void		SetLineRoute(CObArray& chain, CUMLEntity* start, int startType, CUMLEntity* end, int endType, const CArray< CPoint, CPoint >& route, CMapPtrToPtr& surplus);
+	void		DeleteSegments(const CMapPtrToPtr& segments);
+	BOOL		FollowSegment(CUMLEntity* obj, CUMLLineSegment* line, int end);
+	BOOL		FollowObject(CUMLLineSegment* line, CUMLEntity* obj, int end);
+	CUMLEntityPackage* GetImportPackage(const CString& folder, CMapStringToPtr& folders, CMapStringToPtr& titles, CObArray& packages);
+
+	// Package file helpers
+	void		SaveProject(CArchive& ar);
+	BOOL		ProjectFromString(const CString& str);
+	void		ClearProject();
+	CString		GetPackageFile(const CString& package) const;
+	void		SetPackageModified(const CString& package);
+	void		GetUnloadedPackages(CStringArray& packages) const;
+	void		SetUnloadedPackages(const CStringArray& packages);
 
 	CString			m_package; // Current package
 	int				m_displayOptions; // Current display options
@@ -107,6 +151,21 @@ private:
 	CUMLEntityDummy	m_dummy; // Dummy object (for objects in other packages)
 	CString			m_error; // Current error, if any
 
+	// A line ending in another package, from the manifest
+	struct CPackageLink
+	{
+		CString	object;		// Object the line ends at
+		CString	package;	// Package of the object
+		CString	source;		// Package of the line
+	};
+
+	BOOL				m_packageFiles;		// TRUE if saved as a manifest and one file per package
+	CString				m_projectPath;		// Path of the manifest
+	CMapStringToString	m_packageParents;	// Packages in the manifest, and their parents
+	CArray< CPackageLink, CPackageLink& > m_packageLinks;	// Links between packages in the manifest
+	CMapStringToPtr		m_loadedPackages;	// Manifest packages read from their files
+	CMapStringToPtr		m_modifiedPackages;	// Packages changed since they were saved
+
 	void			ExportHTML(CStringArray& stra) const;
 	void			ExportCPP() const;
 	void			ExportH() const;
@@ -9,6 +9,8 @@
 
 class CUMLEntityDummy : public CUMLEntity
 {
+	DECLARE_ENTITY_SIZE(CUMLEntityDummy)
+
 public:
 	// Construction/destruction
 	CUMLEntityDummy();
@@ -26,6 +26,7 @@
 #include "../DiagramEditor/Tokenizer.h"
 #include "UMLEntityContainer.h"
 #include "StringHelpers.h"
+#include "../DiagramEditor/DiagramRenderer.h"
 
 #ifdef _DEBUG
 #define new DEBUG_NEW
@@ -58,6 +59,7 @@ CUMLEntityInterface::CUMLEntityInterface()
 	}
 
 	SetType(_T("uml_interface"));
+	AddKind(KIND_UML_INTERFACE);
 	SetConstraints(GetDefaultSize(), GetDefaultSize());
 
 	SetBkColor(RGB(255, 255, 217));
@@ -139,43 +141,66 @@ CDiagramEntity* CUMLEntityInterface::CreateFromString(const CString& str)
 
 }
 
-void CUMLEntityInterface::Draw(CDC* dc, CRect rect)
+CUMLEntityInterface* CUMLEntityInterface::Cast(CDiagramEntity* obj)
 /* ============================================================
-	Function :		CUMLEntityInterface::Draw
+	Function :		CUMLEntityInterface::Cast
+	Description :	Casts "obj" to a "CUMLEntityInterface" pointer,
+					using the kind tag instead of RTTI.
+	Access :		Public
+
+	Return :		CUMLEntityInterface*	-	"obj", or "NULL" if "obj" is
+						not an interface.
+	Parameters :	CDiagramEntity* obj	-	Object to cast.
+
+	Usage :			Use instead of "dynamic_cast" in loops over
+					the container data.
+
+   ============================================================*/
+{
+
+	if (obj && obj->IsKind(KIND_UML_INTERFACE))
+		return static_cast<CUMLEntityInterface*>(obj);
+
+	return NULL;
+
+}
+
+void CUMLEntityInterface::Render(CDiagramRenderer* renderer, CRect rect)
+/* ============================================================
+	Function :		CUMLEntityInterface::Render
 	Description :	Draws this object.
 	Access :		Public
 
 	Return :		void
-	Parameters :	CDC* dc		-	"CDC" to draw to
-					CRect rect	-	Rectangle to draw to
+	Parameters :	CDiagramRenderer* renderer	-	Renderer to
+													draw with
+					CRect rect					-	Rectangle to
+													draw to
 
-	Usage :			Call to draw the object.
+	Usage :			Called from "Draw", or to draw to a memory
+					buffer.
 
    ============================================================*/
 {
 
 	int cutoff = round(static_cast<double>(GetMarkerSize().cx) * GetZoom());
 	int height = round(12.0 * GetZoom());
-	dc->SelectStockObject(BLACK_PEN);
-	CBrush bk;
-	bk.CreateSolidBrush(GetBkColor());
-	dc->SelectObject(&bk);
+	renderer->SetPen(PS_SOLID, 0, RGB(0, 0, 0));
+	renderer->SetBrush(GetBkColor());
 
-	dc->Ellipse(rect);
+	renderer->Ellipse(rect);
 
 	CString str = GetTitle();
-	if (str)
+	if (str.GetLength())
 	{
-		CFont font;
-		dc->SetBkMode(TRANSPARENT);
-		font.CreateFont(-height, 0, 0, 0, FW_BOLD, 0, 0, 0, 0, 0, 0, 0, 0, GetFont());
-		CFont* oldfont = dc->SelectObject(&font);
+		renderer->SetBkMode(TRANSPARENT);
+		renderer->SetFont(GetFont(), -height, FW_BOLD);
 
 		CRect textRect(rect);
 		textRect.bottom = textRect.top;
 		textRect.top -= round(14.0 * GetZoom());
 
-		int width = dc->GetTextExtent(str).cx + cutoff * 2;
+		int width = renderer->GetTextExtent(str).cx + cutoff * 2;
 		int diff = width - textRect.Width();
 		if (diff > 0)
 		{
@@ -183,13 +208,9 @@ void CUMLEntityInterface::Draw(CDC* dc, CRect rect)
 			textRect.right += diff / 2;
 		}
 
-		dc->DrawText(str, textRect, DT_SINGLELINE | DT_CENTER);
-		dc->SelectObject(oldfont);
+		renderer->DrawText(str, textRect, DT_SINGLELINE | DT_CENTER);
 	}
 
-	dc->SelectStockObject(BLACK_PEN);
-	dc->SelectStockObject(WHITE_BRUSH);
-
 }
 
 int CUMLEntityInterface::GetLinkCode(CPoint point) const
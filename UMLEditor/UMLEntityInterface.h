@@ -6,13 +6,16 @@
 
 class CUMLEntityInterface : public CUMLEntity
 {
+	DECLARE_ENTITY_SIZE(CUMLEntityInterface)
+
 public:
 	CUMLEntityInterface();
 	virtual ~CUMLEntityInterface();
 
 	virtual CDiagramEntity* Clone();
 	static	CDiagramEntity* CreateFromString(const CString& str);
-	virtual void Draw(CDC* dc, CRect rect);
+	static	CUMLEntityInterface* Cast(CDiagramEntity* obj);
+	virtual void Render(CDiagramRenderer* renderer, CRect rect);
 
 	virtual int		GetLinkCode(CPoint point) const;
 	virtual void	DrawSelectionMarkers(CDC* dc, CRect rect) const;
@@ -24,6 +24,7 @@
 #include "../DiagramEditor/Tokenizer.h"
 #include "UMLEntityContainer.h"
 #include "StringHelpers.h"
+#include "../DiagramEditor/DiagramRenderer.h"
 
 #ifdef _DEBUG
 #define new DEBUG_NEW
@@ -204,17 +205,20 @@ CDiagramEntity* CUMLEntityLabel::CreateFromString(const CString& str)
 
 }
 
-void CUMLEntityLabel::Draw(CDC* dc, CRect rect)
+void CUMLEntityLabel::Render(CDiagramRenderer* renderer, CRect rect)
 /* ============================================================
-	Function :		CUMLEntityLabel::Draw
+	Function :		CUMLEntityLabel::Render
 	Description :	Draws this object.
 	Access :		Public
 
 	Return :		void
-	Parameters :	CDC* dc		-	"CDC" to draw to
-					CRect rect	-	Rectangle to draw to
+	Parameters :	CDiagramRenderer* renderer	-	Renderer to
+													draw with
+					CRect rect					-	Rectangle to
+													draw to
 
-	Usage :			Call to draw the object.
+	Usage :			Called from "Draw", or to draw to a memory
+					buffer.
 
    ============================================================*/
 {
@@ -222,22 +226,18 @@ void CUMLEntityLabel::Draw(CDC* dc, CRect rect)
 	if (GetTitle().GetLength())
 	{
 
-		CFont font;
 		int weight = FW_NORMAL;
 		if (GetBold())
 			weight = FW_BOLD;
 
-		font.CreateFont(-round(static_cast<double>(GetPointsize()) * GetZoom()),
-			0, 0, 0,
+		renderer->SetFont(GetFont(),
+			-round(static_cast<double>(GetPointsize()) * GetZoom()),
 			weight,
-			(BYTE)GetItalic(),
-			(BYTE)GetUnderline(), 0, 0, 0, 0, 0, 0,
-			GetFont());
+			GetItalic(),
+			GetUnderline());
 
-		CFont* oldfont = dc->SelectObject(&font);
-		dc->SetBkMode(TRANSPARENT);
-		dc->DrawText(GetTitle(), rect, DT_WORDBREAK | DT_NOPREFIX);
-		dc->SelectObject(oldfont);
+		renderer->SetBkMode(TRANSPARENT);
+		renderer->DrawText(GetTitle(), rect, DT_WORDBREAK | DT_NOPREFIX);
 
 	}
 
@@ -6,13 +6,15 @@
 
 class CUMLEntityLabel : public CUMLEntity
 {
+	DECLARE_ENTITY_SIZE(CUMLEntityLabel)
+
 public:
 	CUMLEntityLabel();
 	virtual ~CUMLEntityLabel();
 
 	virtual CDiagramEntity* Clone();
 	static	CDiagramEntity* CreateFromString(const CString& str);
-	virtual void Draw(CDC* dc, CRect rect);
+	virtual void Render(CDiagramRenderer* renderer, CRect rect);
 
 	virtual CString GetString() const;
 	virtual BOOL	FromString(const CString& str);
@@ -24,6 +24,7 @@
 #include "UMLEntityNote.h"
 #include "../DiagramEditor/Tokenizer.h"
 #include "UMLEntityContainer.h"
+#include "../DiagramEditor/DiagramRenderer.h"
 
 #ifdef _DEBUG
 #define new DEBUG_NEW
@@ -137,29 +138,30 @@ CDiagramEntity* CUMLEntityNote::CreateFromString(const CString& str)
 
 }
 
-void CUMLEntityNote::Draw(CDC* dc, CRect rect)
+void CUMLEntityNote::Render(CDiagramRenderer* renderer, CRect rect)
 /* ============================================================
-	Function :		CUMLEntityNote::Draw
+	Function :		CUMLEntityNote::Render
 	Description :	Draws this object.
 	Access :		Public
 
 	Return :		void
-	Parameters :	CDC* dc		-	"CDC" to draw to
-					CRect rect	-	Rectangle to draw to
+	Parameters :	CDiagramRenderer* renderer	-	Renderer to
+													draw with
+					CRect rect					-	Rectangle to
+													draw to
 
-	Usage :			Call to draw the object.
+	Usage :			Called from "Draw", or to draw to a memory
+					buffer.
 
    ============================================================*/
 {
 
 	int cutoff = round(static_cast<double>(GetMarkerSize().cx) * GetZoom());
 
-	dc->SelectStockObject(BLACK_PEN);
-	CBrush bk;
-	bk.CreateSolidBrush(GetBkColor());
-	dc->SelectObject(&bk);
+	renderer->SetPen(PS_SOLID, 0, RGB(0, 0, 0));
+	renderer->SetBrush(GetBkColor());
 
-	POINT pts[5];
+	CPoint pts[5];
 
 	pts[0].x = rect.left;
 	pts[0].y = rect.top;
@@ -176,27 +178,25 @@ void CUMLEntityNote::Draw(CDC* dc, CRect rect)
 	pts[4].x = rect.left;
 	pts[4].y = rect.bottom;
 
-	dc->Polygon(pts, 5);
+	renderer->Polygon(pts, 5);
 
-	dc->MoveTo(rect.right - cutoff, rect.top);
-	dc->LineTo(rect.right - cutoff, rect.top + cutoff);
-	dc->LineTo(rect.right, rect.top + cutoff);
+	CPoint fold[3] = {
+		CPoint(rect.right - cutoff, rect.top),
+		CPoint(rect.right - cutoff, rect.top + cutoff),
+		CPoint(rect.right, rect.top + cutoff)
+	};
+	renderer->Polyline(fold, 3);
 
 	if (GetTitle().GetLength())
 	{
 		CRect textRect = GetTextRect(rect);
 
-		CFont font;
-		dc->SetBkMode(OPAQUE);
-		dc->SetBkColor(GetBkColor());
-		font.CreateFont(-round(12.0 * GetZoom()), 0, 0, 0, FW_NORMAL, 0, 0, 0, 0, 0, 0, 0, 0, GetFont());
-		CFont* oldfont = dc->SelectObject(&font);
-		dc->DrawText(GetTitle(), textRect, DT_WORDBREAK);
-		dc->SelectObject(oldfont);
+		renderer->SetBkMode(OPAQUE);
+		renderer->SetBkColor(GetBkColor());
+		renderer->SetFont(GetFont(), -round(12.0 * GetZoom()));
+		renderer->DrawText(GetTitle(), textRect, DT_WORDBREAK);
 	}
 
-	dc->SelectStockObject(WHITE_BRUSH);
-
 }
 
 void CUMLEntityNote::SetTitle(CString title)
@@ -323,7 +323,7 @@ void CUMLEntityNote::CalcRestraints()
 		CUMLEntityContainer* container = GetUMLContainer();
 		if (container)
 		{
-			CSize sz = container->CalcMinimumRestraints(GetName());
+			CSize sz = container->CalcMinimumRestraints(GetID());
 			if (sz.cx > totalheight)
 				totalheight = sz.cx;
 			if (sz.cy > totalwidth)
@@ -6,13 +6,15 @@
 
 class CUMLEntityNote : public CUMLEntity
 {
+	DECLARE_ENTITY_SIZE(CUMLEntityNote)
+
 public:
 	CUMLEntityNote();
 	virtual ~CUMLEntityNote();
 
 	virtual CDiagramEntity* Clone();
 	static	CDiagramEntity* CreateFromString(const CString& str);
-	virtual void Draw(CDC* dc, CRect rect);
+	virtual void Render(CDiagramRenderer* renderer, CRect rect);
 
 	virtual void	SetTitle(CString title);
 	virtual void	SetRect(CRect rect);
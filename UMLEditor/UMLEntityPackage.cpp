@@ -27,6 +27,7 @@
 #include "../DiagramEditor/Tokenizer.h"
 #include "UMLEntityContainer.h"
 #include "StringHelpers.h"
+#include "../DiagramEditor/DiagramRenderer.h"
 
 #ifdef _DEBUG
 #define new DEBUG_NEW
@@ -51,6 +52,7 @@ CUMLEntityPackage::CUMLEntityPackage()
 {
 
 	SetDefaultSize(CSize(112, 80));
+	AddKind(KIND_UML_PACKAGE);
 
 	SetPropertyDialog(&m_dlg, CUMLPackagePropertyDialog::IDD);
 
@@ -141,17 +143,44 @@ CDiagramEntity* CUMLEntityPackage::CreateFromString(const CString& str)
 
 }
 
-void CUMLEntityPackage::Draw(CDC* dc, CRect rect)
+CUMLEntityPackage* CUMLEntityPackage::Cast(CDiagramEntity* obj)
 /* ============================================================
-	Function :		CUMLEntityPackage::Draw
+	Function :		CUMLEntityPackage::Cast
+	Description :	Casts "obj" to a "CUMLEntityPackage" pointer,
+					using the kind tag instead of RTTI.
+	Access :		Public
+
+	Return :		CUMLEntityPackage*	-	"obj", or "NULL" if "obj" is
+						not a package.
+	Parameters :	CDiagramEntity* obj	-	Object to cast.
+
+	Usage :			Use instead of "dynamic_cast" in loops over
+					the container data.
+
+   ============================================================*/
+{
+
+	if (obj && obj->IsKind(KIND_UML_PACKAGE))
+		return static_cast<CUMLEntityPackage*>(obj);
+
+	return NULL;
+
+}
+
+void CUMLEntityPackage::Render(CDiagramRenderer* renderer, CRect rect)
+/* ============================================================
+	Function :		CUMLEntityPackage::Render
 	Description :	Draws this object.
 	Access :		Public
 
 	Return :		void
-	Parameters :	CDC* dc		-	"CDC" to draw to
-					CRect rect	-	Rectangle to draw to
+	Parameters :	CDiagramRenderer* renderer	-	Renderer to
+													draw with
+					CRect rect					-	Rectangle to
+													draw to
 
-	Usage :			Call to draw the object.
+	Usage :			Called from "Draw", or to draw to a memory
+					buffer.
 
    ============================================================*/
 {
@@ -168,29 +197,21 @@ void CUMLEntityPackage::Draw(CDC* dc, CRect rect)
 
 	bigbox.top = tabbox.bottom - 1;
 
-	dc->SelectStockObject(BLACK_PEN);
-	CBrush bk;
-	bk.CreateSolidBrush(GetBkColor());
-	dc->SelectObject(&bk);
+	renderer->SetPen(PS_SOLID, 0, RGB(0, 0, 0));
+	renderer->SetBrush(GetBkColor());
 
-	dc->Rectangle(tabbox);
-	dc->Rectangle(bigbox);
+	renderer->Rectangle(tabbox);
+	renderer->Rectangle(bigbox);
 
 	if (GetTitle().GetLength())
 	{
 		bigbox.top += cutoff;
-		CFont font;
-		dc->SetBkMode(OPAQUE);
-		dc->SetBkColor(GetBkColor());
-		font.CreateFont(-round(12.0 * GetZoom()), 0, 0, 0, FW_BOLD, 0, 0, 0, 0, 0, 0, 0, 0, GetFont());
-		CFont* oldfont = dc->SelectObject(&font);
-		dc->DrawText(GetTitle(), bigbox, DT_SINGLELINE | DT_CENTER);
-		dc->SelectObject(oldfont);
+		renderer->SetBkMode(OPAQUE);
+		renderer->SetBkColor(GetBkColor());
+		renderer->SetFont(GetFont(), -round(12.0 * GetZoom()), FW_BOLD);
+		renderer->DrawText(GetTitle(), bigbox, DT_SINGLELINE | DT_CENTER);
 	}
 
-	dc->SelectStockObject(BLACK_PEN);
-	dc->SelectStockObject(WHITE_BRUSH);
-
 }
 
 CPoint CUMLEntityPackage::GetLinkPosition(int type) const
@@ -292,7 +313,7 @@ void CUMLEntityPackage::CalcRestraints()
 	CUMLEntityContainer* container = GetUMLContainer();
 	if (container)
 	{
-		CSize sz = container->CalcMinimumRestraints(GetName());
+		CSize sz = container->CalcMinimumRestraints(GetID());
 		if (sz.cy > minwidth)
 			minwidth = sz.cy;
 	}
@@ -6,13 +6,16 @@
 
 class CUMLEntityPackage : public CUMLEntity
 {
+	DECLARE_ENTITY_SIZE(CUMLEntityPackage)
+
 public:
 	CUMLEntityPackage();
 	virtual ~CUMLEntityPackage();
 
 	virtual CDiagramEntity* Clone();
 	static	CDiagramEntity* CreateFromString(const CString& str);
-	virtual void Draw(CDC* dc, CRect rect);
+	static	CUMLEntityPackage* Cast(CDiagramEntity* obj);
+	virtual void Render(CDiagramRenderer* renderer, CRect rect);
 
 	virtual CPoint	GetLinkPosition(int type) const;
 	virtual int		GetMenuResourceId() const;
@@ -28,13 +28,22 @@
    ========================================================================
 		28/8 2004	Not calling CDiagramEntity::SetRect when setting rects,
 					to keep non-normalization.
+   ========================================================================
+		19/10 2026	Allocated from a class-wide "CObjectPool".
+		19/10 2026	The linked objects are stored as numeric ids.
+		19/10 2026	Added GetMemoryUsage.
+		19/10 2026	Draw replaced by Render, so the line and its
+					markers can be drawn to a memory buffer.
    ========================================================================*/
 #include "stdafx.h"
 #include "UMLLineSegment.h"
 #include "UMLEntityContainer.h"
 #include "../DiagramEditor/DiagramLine.h"
 #include "../DiagramEditor/Tokenizer.h"
+#include "../DiagramEditor/DiagramMemoryUsage.h"
+#include "../DiagramEditor/DiagramRenderer.h"
 #include "StringHelpers.h"
+#include "LinkFactory.h"
 
 #include <math.h>
 
@@ -44,6 +53,8 @@
 static char THIS_FILE[] = __FILE__;
 #endif
 
+IMPLEMENT_POOLED_ALLOC(CUMLLineSegment, 256)
+
 
 //////////////////////////////////////////
 // LineDDA callbacks from CDiagramLine
@@ -70,12 +81,15 @@ CUMLLineSegment::CUMLLineSegment()
 
 	SetPropertyDialog(&m_dlg, CUMLLinkPropertyDialog::IDD);
 
+	SetLink(LINK_START, LINK_ID_NONE);
+	SetLink(LINK_END, LINK_ID_NONE);
 	SetLinkType(LINK_START, 0);
 	SetLinkType(LINK_END, 0);
 
 	SetMinimumSize(CSize(-1, -1));
 	SetMaximumSize(CSize(-1, -1));
 	SetType(_T("uml_line"));
+	AddKind(KIND_UML_LINESEGMENT);
 	SetTitle(_T(""));
 	SetStyle(0);
 	SetStartLabel(_T(""));
@@ -127,53 +141,44 @@ CDiagramEntity* CUMLLineSegment::Clone()
 
 }
 
-void CUMLLineSegment::Draw(CDC* dc, CRect rect)
+void CUMLLineSegment::Render(CDiagramRenderer* renderer, CRect rect)
 /* ============================================================
-	Function :		CUMLLineSegment::Draw
+	Function :		CUMLLineSegment::Render
 	Description :	Draws the object.
 	Access :		Public
 
 	Return :		void
-	Parameters :	CDC* dc		-	The "CDC" to draw to.
-					CRect rect	-	The real rectangle of the
-									object.
+	Parameters :	CDiagramRenderer* renderer	-	The renderer to
+													draw with.
+					CRect rect					-	The real rectangle
+													of the object.
 
-	Usage :			The function should clean up all selected
-					objects. Note that the "CDC" is a memory "CDC",
-					so creating a memory "CDC" in this function
-					will probably not speed up the function.
+	Usage :			Called from "Draw", or to draw to a memory
+					buffer.
 
    ============================================================*/
 {
 
-	int mode = dc->SetBkMode(TRANSPARENT);
+	renderer->SetBkMode(TRANSPARENT);
 
 	if (!(GetStyle() & STYLE_INVISIBLE))
 	{
-		CPen pen;
 		if (GetStyle() & STYLE_DASHED)
-			pen.CreatePen(PS_DOT, 0, RGB(0, 0, 0));
+			renderer->SetPen(PS_DOT, 0, RGB(0, 0, 0));
 		else
-			pen.CreatePen(PS_SOLID, 0, RGB(0, 0, 0));
-
-		CPen* oldpen = dc->SelectObject(&pen);
+			renderer->SetPen(PS_SOLID, 0, RGB(0, 0, 0));
 
 		// Draw line
-		dc->MoveTo(rect.TopLeft());
-		dc->LineTo(rect.BottomRight());
-
-		dc->SelectObject(oldpen);
+		renderer->Line(rect.TopLeft(), rect.BottomRight());
 	}
 
-	dc->SelectStockObject(BLACK_PEN);
-	dc->SelectStockObject(BLACK_BRUSH);
+	renderer->SetPen(PS_SOLID, 0, RGB(0, 0, 0));
+	renderer->SetBrush(RGB(0, 0, 0));
 
 	int cut = round(static_cast<double>(GetMarkerSize().cx) * GetZoom() / 2);
 	int cy = round(14.0 * GetZoom());
 
-	CFont font;
-	font.CreateFont(-round(12.0 * GetZoom()), 0, 0, 0, FW_NORMAL, 0, 0, 0, 0, 0, 0, 0, 0, GetFont());
-	CFont* oldfont = dc->SelectObject(&font);
+	renderer->SetFont(GetFont(), -round(12.0 * GetZoom()));
 
 	/////////////////////////////////////////////////////////////
 	// Draw title
@@ -189,13 +194,13 @@ void CUMLLineSegment::Draw(CDC* dc, CRect rect)
 		{
 			CRect r(rect.left, rect.top - (cy + cut), rect.right, rect.bottom);
 			r.NormalizeRect();
-			dc->DrawText(str, r, DT_NOPREFIX | DT_SINGLELINE | DT_CENTER);
+			renderer->DrawText(str, r, DT_NOPREFIX | DT_SINGLELINE | DT_CENTER);
 		}
 		else
 		{
-			CRect r(rect.right - (dc->GetTextExtent(str).cx + cut * 2), rect.top, rect.right - cut, rect.bottom);
+			CRect r(rect.right - (renderer->GetTextExtent(str).cx + cut * 2), rect.top, rect.right - cut, rect.bottom);
 			r.NormalizeRect();
-			dc->DrawText(str, r, DT_NOPREFIX | DT_SINGLELINE | DT_VCENTER | DT_RIGHT);
+			renderer->DrawText(str, r, DT_NOPREFIX | DT_SINGLELINE | DT_VCENTER | DT_RIGHT);
 		}
 
 	}
@@ -216,20 +221,20 @@ void CUMLLineSegment::Draw(CDC* dc, CRect rect)
 			{
 				rectTemp.left += cut;
 				rectTemp.right -= cut;
-				dc->DrawText(str, rectTemp, DT_NOPREFIX | DT_SINGLELINE | DT_VCENTER | DT_LEFT);
+				renderer->DrawText(str, rectTemp, DT_NOPREFIX | DT_SINGLELINE | DT_VCENTER | DT_LEFT);
 			}
 			else
 			{
 				int temp = rectTemp.left;
 				rectTemp.left = rectTemp.right + cut;
 				rectTemp.right = temp - cut;
-				dc->DrawText(str, rectTemp, DT_NOPREFIX | DT_SINGLELINE | DT_VCENTER | DT_RIGHT);
+				renderer->DrawText(str, rectTemp, DT_NOPREFIX | DT_SINGLELINE | DT_VCENTER | DT_RIGHT);
 			}
 
 		}
 		else
 		{
-			rectTemp.left -= dc->GetTextExtent(str).cx + 2 * cut;
+			rectTemp.left -= renderer->GetTextExtent(str).cx + 2 * cut;
 			rectTemp.right -= cut;
 			if (rectTemp.top < rectTemp.bottom)
 				rectTemp.bottom = rectTemp.top + cy;
@@ -239,7 +244,7 @@ void CUMLLineSegment::Draw(CDC* dc, CRect rect)
 				rectTemp.bottom = rectTemp.top + cy;
 			}
 
-			dc->DrawText(str, rectTemp, DT_NOPREFIX | DT_SINGLELINE | DT_VCENTER | DT_RIGHT);
+			renderer->DrawText(str, rectTemp, DT_NOPREFIX | DT_SINGLELINE | DT_VCENTER | DT_RIGHT);
 		}
 
 	}
@@ -257,20 +262,20 @@ void CUMLLineSegment::Draw(CDC* dc, CRect rect)
 			{
 				rectTemp.left += cut;
 				rectTemp.right -= cut;
-				dc->DrawText(str, rectTemp, DT_NOPREFIX | DT_SINGLELINE | DT_VCENTER | DT_LEFT);
+				renderer->DrawText(str, rectTemp, DT_NOPREFIX | DT_SINGLELINE | DT_VCENTER | DT_LEFT);
 			}
 			else
 			{
 				int temp = rectTemp.left;
 				rectTemp.left = rectTemp.right + cut;
 				rectTemp.right = temp - cut;
-				dc->DrawText(str, rectTemp, DT_NOPREFIX | DT_SINGLELINE | DT_VCENTER | DT_RIGHT);
+				renderer->DrawText(str, rectTemp, DT_NOPREFIX | DT_SINGLELINE | DT_VCENTER | DT_RIGHT);
 			}
 
 		}
 		else
 		{
-			rectTemp.right += dc->GetTextExtent(str).cx + 2 * cut;
+			rectTemp.right += renderer->GetTextExtent(str).cx + 2 * cut;
 			rectTemp.left += cut;
 
 			if (rectTemp.top < rectTemp.bottom)
@@ -281,7 +286,7 @@ void CUMLLineSegment::Draw(CDC* dc, CRect rect)
 				rectTemp.bottom = rectTemp.top + cy;
 			}
 
-			dc->DrawText(str, rectTemp, DT_NOPREFIX | DT_SINGLELINE | DT_VCENTER | DT_RIGHT);
+			renderer->DrawText(str, rectTemp, DT_NOPREFIX | DT_SINGLELINE | DT_VCENTER | DT_RIGHT);
 		}
 
 	}
@@ -299,20 +304,20 @@ void CUMLLineSegment::Draw(CDC* dc, CRect rect)
 			{
 				rectTemp.left += cut;
 				rectTemp.right -= cut;
-				dc->DrawText(str, rectTemp, DT_NOPREFIX | DT_SINGLELINE | DT_VCENTER | DT_RIGHT);
+				renderer->DrawText(str, rectTemp, DT_NOPREFIX | DT_SINGLELINE | DT_VCENTER | DT_RIGHT);
 			}
 			else
 			{
 				int temp = rectTemp.left;
 				rectTemp.left = rectTemp.right + cut;
 				rectTemp.right = temp - cut;
-				dc->DrawText(str, rectTemp, DT_NOPREFIX | DT_SINGLELINE | DT_VCENTER | DT_LEFT);
+				renderer->DrawText(str, rectTemp, DT_NOPREFIX | DT_SINGLELINE | DT_VCENTER | DT_LEFT);
 			}
 
 		}
 		else
 		{
-			rectTemp.left -= dc->GetTextExtent(str).cx + 2 * cut;
+			rectTemp.left -= renderer->GetTextExtent(str).cx + 2 * cut;
 			rectTemp.right -= cut;
 			if (rectTemp.top < rectTemp.bottom)
 				rectTemp.top = rectTemp.bottom - cy;
@@ -321,7 +326,7 @@ void CUMLLineSegment::Draw(CDC* dc, CRect rect)
 				rectTemp.top = rectTemp.bottom;
 				rectTemp.bottom = rectTemp.top + cy;
 			}
-			dc->DrawText(str, rectTemp, DT_NOPREFIX | DT_SINGLELINE | DT_VCENTER | DT_RIGHT);
+			renderer->DrawText(str, rectTemp, DT_NOPREFIX | DT_SINGLELINE | DT_VCENTER | DT_RIGHT);
 		}
 	}
 
@@ -338,20 +343,20 @@ void CUMLLineSegment::Draw(CDC* dc, CRect rect)
 			{
 				rectTemp.left += cut;
 				rectTemp.right -= cut;
-				dc->DrawText(str, rectTemp, DT_NOPREFIX | DT_SINGLELINE | DT_VCENTER | DT_RIGHT);
+				renderer->DrawText(str, rectTemp, DT_NOPREFIX | DT_SINGLELINE | DT_VCENTER | DT_RIGHT);
 			}
 			else
 			{
 				int temp = rectTemp.left;
 				rectTemp.left = rectTemp.right + cut;
 				rectTemp.right = temp - cut;
-				dc->DrawText(str, rectTemp, DT_NOPREFIX | DT_SINGLELINE | DT_VCENTER | DT_LEFT);
+				renderer->DrawText(str, rectTemp, DT_NOPREFIX | DT_SINGLELINE | DT_VCENTER | DT_LEFT);
 			}
 
 		}
 		else
 		{
-			rectTemp.right += dc->GetTextExtent(str).cx + 2 * cut;
+			rectTemp.right += renderer->GetTextExtent(str).cx + 2 * cut;
 			rectTemp.left += cut;
 			if (rectTemp.top < rectTemp.bottom)
 				rectTemp.top = rectTemp.bottom - cy;
@@ -360,7 +365,7 @@ void CUMLLineSegment::Draw(CDC* dc, CRect rect)
 				rectTemp.top = rectTemp.bottom;
 				rectTemp.bottom = rectTemp.top + cy;
 			}
-			dc->DrawText(str, rectTemp, DT_NOPREFIX | DT_SINGLELINE | DT_VCENTER | DT_RIGHT);
+			renderer->DrawText(str, rectTemp, DT_NOPREFIX | DT_SINGLELINE | DT_VCENTER | DT_RIGHT);
 		}
 	}
 
@@ -414,7 +419,7 @@ void CUMLLineSegment::Draw(CDC* dc, CRect rect)
 
 		}
 
-		DrawDiamond(dc, diamond);
+		DrawDiamond(renderer, diamond);
 	}
 
 	if (GetStyle() & STYLE_CIRCLECROSS)
@@ -424,31 +429,21 @@ void CUMLLineSegment::Draw(CDC* dc, CRect rect)
 		CPoint pos = GetStyleMarkerRect(LINK_END, marker);
 		CRect circ(round(static_cast<double>(pos.x) * GetZoom()), round(static_cast<double>(pos.y) * GetZoom()), round(static_cast<double>(pos.x + marker.cx) * GetZoom()), round(static_cast<double>(pos.y + marker.cy) * GetZoom()));
 
-		dc->SelectStockObject(BLACK_PEN);
-		dc->SelectStockObject(WHITE_BRUSH);
+		renderer->SetPen(PS_SOLID, 0, RGB(0, 0, 0));
+		renderer->SetBrush(RGB(255, 255, 255));
 
-		dc->Ellipse(&circ);
+		renderer->Ellipse(circ);
 
-		dc->MoveTo(circ.left + circ.Width() / 2, circ.top);
-		dc->LineTo(circ.left + circ.Width() / 2, circ.bottom);
-
-		dc->MoveTo(circ.left, circ.top + circ.Height() / 2);
-		dc->LineTo(circ.right, circ.top + circ.Height() / 2);
+		renderer->Line(CPoint(circ.left + circ.Width() / 2, circ.top), CPoint(circ.left + circ.Width() / 2, circ.bottom));
+		renderer->Line(CPoint(circ.left, circ.top + circ.Height() / 2), CPoint(circ.right, circ.top + circ.Height() / 2));
 
 	}
 
 	if (GetStyle() & STYLE_ARROWHEAD)
-		DrawInheritanceArrow(dc);
+		DrawInheritanceArrow(renderer);
 
 	if (GetStyle() & STYLE_FILLED_ARROWHEAD)
-		DrawDirectionArrow(dc);
-
-	/////////////////////////////////////////////////////////////
-	// Cleaning up
-
-	dc->SetBkMode(mode);
-	dc->SelectObject(oldfont);
-	dc->SelectStockObject(WHITE_BRUSH);
+		DrawDirectionArrow(renderer);
 
 }
 
@@ -486,6 +481,30 @@ CDiagramEntity* CUMLLineSegment::CreateFromString(const CString& str)
 
 }
 
+CUMLLineSegment* CUMLLineSegment::Cast(CDiagramEntity* obj)
+/* ============================================================
+	Function :		CUMLLineSegment::Cast
+	Description :	Casts "obj" to a "CUMLLineSegment" pointer,
+					using the kind tag instead of RTTI.
+	Access :		Public
+
+	Return :		CUMLLineSegment*	-	"obj", or "NULL" if "obj" is
+						not a line segment.
+	Parameters :	CDiagramEntity* obj	-	Object to cast.
+
+	Usage :			Use instead of "dynamic_cast" in loops over
+					the container data.
+
+   ============================================================*/
+{
+
+	if (obj && obj->IsKind(KIND_UML_LINESEGMENT))
+		return static_cast<CUMLLineSegment*>(obj);
+
+	return NULL;
+
+}
+
 int CUMLLineSegment::GetHitCode(CPoint point) const
 /* ============================================================
 	Function :		CUMLLineSegment::GetHitCode
@@ -1001,8 +1020,8 @@ BOOL CUMLLineSegment::FromString(const CString& str)
 
 		SetPackage(package);
 		SetStereotype(stereotype);
-		SetLink(LINK_START, startLink);
-		SetLink(LINK_END, endLink);
+		SetLink(LINK_START, CLinkFactory::ToID(startLink));
+		SetLink(LINK_END, CLinkFactory::ToID(endLink));
 		SetLinkType(LINK_START, startLinkType);
 		SetLinkType(LINK_END, endLinkType);
 		SetStyle(style);
@@ -1056,8 +1075,8 @@ CString CUMLLineSegment::GetString() const
 	str.Format(_T(",%s,%s,%s,%s,%i,%i,%i,%s,%i,%s,%s,%i,%i,%s,%s;"),
 		package.GetString(),
 		stereotype.GetString(),
-		GetLink(LINK_START).GetString(),
-		GetLink(LINK_END).GetString(),
+		CLinkFactory::ToString(GetLink(LINK_START)).GetString(),
+		CLinkFactory::ToString(GetLink(LINK_END)).GetString(),
 		GetLinkType(LINK_START),
 		GetLinkType(LINK_END),
 		GetStyle(),
@@ -1076,25 +1095,27 @@ CString CUMLLineSegment::GetString() const
 
 }
 
-void CUMLLineSegment::DrawDiamond(CDC* dc, const CRect& rect)
+void CUMLLineSegment::DrawDiamond(CDiagramRenderer* renderer, const CRect& rect)
 /* ============================================================
 	Function :		CUMLLineSegment::DrawDiamond
 	Description :	Draws the composition diamond.
 	Access :		Private
 
 	Return :		void
-	Parameters :	CDC* dc				-	The "CDC" to draw to
-					const CRect& rect	-	The rect of the diamond
+	Parameters :	CDiagramRenderer* renderer	-	Renderer to
+													draw with
+					const CRect& rect			-	The rect of the
+													diamond
 
-	Usage :			Called from "Draw".
+	Usage :			Called from "Render".
 
    ============================================================*/
 {
 
-	dc->SelectStockObject(BLACK_PEN);
-	dc->SelectStockObject(BLACK_BRUSH);
+	renderer->SetPen(PS_SOLID, 0, RGB(0, 0, 0));
+	renderer->SetBrush(RGB(0, 0, 0));
 
-	POINT pts[4]{};
+	CPoint pts[4];
 	pts[0].x = rect.left + ((rect.right - rect.left) / 2);
 	pts[0].y = rect.top;
 	pts[1].x = rect.right;
@@ -1104,7 +1125,7 @@ void CUMLLineSegment::DrawDiamond(CDC* dc, const CRect& rect)
 	pts[3].x = rect.left;
 	pts[3].y = pts[1].y;
 
-	dc->Polygon(pts, 4);
+	renderer->Polygon(pts, 4);
 
 }
 
@@ -1355,6 +1376,30 @@ void CUMLLineSegment::Copy(CDiagramEntity* obj)
 
 }
 
+void CUMLLineSegment::GetMemoryUsage(CDiagramMemoryUsage& usage) const
+/* ============================================================
+	Function :		CUMLLineSegment::GetMemoryUsage
+	Description :	Adds the memory held by the object to
+					"usage".
+	Access :		Public
+
+	Return :		void
+	Parameters :	CDiagramMemoryUsage& usage	-	Breakdown
+													to add to.
+
+	Usage :			Called by the container.
+
+   ============================================================*/
+{
+
+	CUMLEntity::GetMemoryUsage(usage);
+	usage.AddString(m_startLabel);
+	usage.AddString(m_endLabel);
+	usage.AddString(m_secondaryStartLabel);
+	usage.AddString(m_secondaryEndLabel);
+
+}
+
 int CUMLLineSegment::GetLineStyle() const
 /* ============================================================
 	Function :		CUMLLineSegment::GetLineStyle
@@ -1395,17 +1440,18 @@ int CUMLLineSegment::GetLineStyle() const
 
 }
 
-void CUMLLineSegment::SetLink(int type, const CString& name)
+void CUMLLineSegment::SetLink(int type, ULONGLONG id)
 /* ============================================================
 	Function :		CUMLLineSegment::SetLink
-	Description :	Set that name of the object that is
-					attached to the start or end of this line
-					segment.
+	Description :	Set the id of the object that is attached
+					to the start or end of this line segment.
 	Access :		Public
 
 	Return :		void
-	Parameters :	int type			-	"LINK_START" or "LINK_END"
-					const CString& name	-	Name of object
+	Parameters :	int type		-	"LINK_START" or "LINK_END"
+					ULONGLONG id	-	Id of object, see
+										"CDiagramEntity::GetID",
+										or "LINK_ID_NONE".
 
 	Usage :			Call to attach an object to this line segment.
 
@@ -1415,33 +1461,35 @@ void CUMLLineSegment::SetLink(int type, const CString& name)
 	switch (type)
 	{
 	case LINK_START:
-		m_start = name;
+		m_start = id;
 		break;
 	case LINK_END:
-		m_end = name;
+		m_end = id;
 		break;
 	}
 
 }
 
-CString CUMLLineSegment::GetLink(int type) const
+ULONGLONG CUMLLineSegment::GetLink(int type) const
 /* ============================================================
 	Function :		CUMLLineSegment::GetLink
-	Description :	Get the name of the object attached to the
+	Description :	Get the id of the object attached to the
 					start or end of this line segment.
 	Access :		Public
 
-	Return :		CString		-	Name of object, or empty if
-									none.
+	Return :		ULONGLONG	-	Id of object, or
+									"LINK_ID_NONE" if none.
 	Parameters :	int type	-	"LINK_START" or "LINK_END"
 
-	Usage :			Call to get the name of the object attached
-					to either end of the line segment.
+	Usage :			Call to get the id of the object attached
+					to either end of the line segment. Use
+					"CUMLEntityContainer::GetNamedObject" to
+					get the object.
 
    ============================================================*/
 {
 
-	CString result;
+	ULONGLONG result = LINK_ID_NONE;
 
 	switch (type)
 	{
@@ -1673,12 +1721,12 @@ void CUMLLineSegment::Flip()
    ============================================================*/
 {
 
-	CString tempString;
+	ULONGLONG tempID;
 	int tempInt;
 
-	tempString = GetLink(LINK_END);
+	tempID = GetLink(LINK_END);
 	SetLink(LINK_END, GetLink(LINK_START));
-	SetLink(LINK_START, tempString);
+	SetLink(LINK_START, tempID);
 
 	tempInt = GetLinkType(LINK_END);
 	SetLinkType(LINK_END, GetLinkType(LINK_START));
@@ -1726,7 +1774,7 @@ BOOL CUMLLineSegment::IsSingleLineSegment() const
 
 }
 
-void CUMLLineSegment::DrawDirectionArrow(CDC* dc)
+void CUMLLineSegment::DrawDirectionArrow(CDiagramRenderer* renderer)
 /* ============================================================
 	Function :		CUMLLineSegment::DrawDirectionArrow
 	Description :	Draws the single direction arrow to the
@@ -1734,9 +1782,10 @@ void CUMLLineSegment::DrawDirectionArrow(CDC* dc)
 	Access :		Private
 
 	Return :		void
-	Parameters :	CDC* dc	-	"CDC" to draw to
+	Parameters :	CDiagramRenderer* renderer	-	Renderer to
+													draw with
 
-	Usage :			Called from the "Draw" function
+	Usage :			Called from the "Render" function
 
    ============================================================*/
 {
@@ -1756,7 +1805,7 @@ void CUMLLineSegment::DrawDirectionArrow(CDC* dc)
 		y1 = GetTop();
 	}
 
-	POINT pts[3]{};
+	CPoint pts[3];
 	if (IsHorizontal())
 	{
 		if (x1 < x2)
@@ -1804,23 +1853,24 @@ void CUMLLineSegment::DrawDirectionArrow(CDC* dc)
 		}
 	}
 
-	dc->SelectStockObject(BLACK_PEN);
-	dc->SelectStockObject(BLACK_BRUSH);
+	renderer->SetPen(PS_SOLID, 0, RGB(0, 0, 0));
+	renderer->SetBrush(RGB(0, 0, 0));
 
-	dc->Polygon(pts, 3);
+	renderer->Polygon(pts, 3);
 
 }
 
-void CUMLLineSegment::DrawInheritanceArrow(CDC* dc)
+void CUMLLineSegment::DrawInheritanceArrow(CDiagramRenderer* renderer)
 /* ============================================================
 	Function :		CUMLLineSegment::DrawInheritanceArrow
 	Description :	Draws the inheritance arrow to the screen
 	Access :		Private
 
 	Return :		void
-	Parameters :	CDC* dc	-	"CDC" to draw to
+	Parameters :	CDiagramRenderer* renderer	-	Renderer to
+													draw with
 
-	Usage :			Called from the "Draw" function.
+	Usage :			Called from the "Render" function.
 
    ============================================================*/
 {
@@ -1841,7 +1891,7 @@ void CUMLLineSegment::DrawInheritanceArrow(CDC* dc)
 		y2 = GetTop();
 	}
 
-	POINT pts[3]{};
+	CPoint pts[3];
 	if (IsHorizontal())
 	{
 		if (x1 < x2)
@@ -1889,10 +1939,10 @@ void CUMLLineSegment::DrawInheritanceArrow(CDC* dc)
 		}
 	}
 
-	dc->SelectStockObject(BLACK_PEN);
-	dc->SelectStockObject(WHITE_BRUSH);
+	renderer->SetPen(PS_SOLID, 0, RGB(0, 0, 0));
+	renderer->SetBrush(RGB(255, 255, 255));
 
-	dc->Polygon(pts, 3);
+	renderer->Polygon(pts, 3);
 
 }
 
@@ -2,6 +2,7 @@
 #define AFX_UMLLINESEGMENT_H__8BBDE424_2729_426C_89EC_B3E3E1021F92__INCLUDED_
 
 #include "UMLEntity.h"
+#include "../DiagramEditor/ObjectPool.h"
 
 // Line styles
 #define STYLE_NONE				0
@@ -16,6 +17,9 @@
 
 class CUMLLineSegment : public CUMLEntity
 {
+	DECLARE_POOLED_ALLOC(CUMLLineSegment)
+	DECLARE_ENTITY_SIZE(CUMLLineSegment)
+
 
 public:
 
@@ -26,8 +30,10 @@ public:
 
 	static	CDiagramEntity* CreateFromString(const CString& str);
 
+	static	CUMLLineSegment* Cast(CDiagramEntity* obj);
+
 	// Overrides
-	virtual void		Draw(CDC* dc, CRect rect);
+	virtual void		Render(CDiagramRenderer* renderer, CRect rect);
 	virtual int			GetHitCode(CPoint point) const;
 	virtual HCURSOR		GetCursor(int hit) const;
 	virtual void		SetRect(CRect rect);
@@ -40,6 +46,7 @@ public:
 	virtual int			GetMenuResourceId() const;
 	virtual void		SetRect(double left, double top, double right, double bottom);
 	virtual void		Copy(CDiagramEntity* obj);
+	virtual void		GetMemoryUsage(CDiagramMemoryUsage& usage) const;
 
 	// Link style
 	void				SetStyle(int style);
@@ -65,9 +72,9 @@ public:
 
 
 	// Links
-	virtual void		SetLink(int type, const CString& name);
+	virtual void		SetLink(int type, ULONGLONG id);
 	virtual void		SetLinkType(int type, int targetType);
-	virtual CString		GetLink(int type) const;
+	virtual ULONGLONG	GetLink(int type) const;
 	virtual int			GetLinkType(int type) const;
 	virtual int			GetLinkCode(CPoint point) const;
 
@@ -91,8 +98,8 @@ private:
 	CString		m_secondaryStartLabel;
 	CString		m_secondaryEndLabel;
 
-	CString		m_start;				// Object linked to the start
-	CString		m_end;					// Object linked to the end
+	ULONGLONG	m_start;				// Id of the object linked to the start
+	ULONGLONG	m_end;					// Id of the object linked to the end
 
 	int			m_startType;			// Type of link at the start
 	int 		m_endType;				// Type of link at the end
@@ -110,9 +117,9 @@ private:
 	CString GetFilledDiamondHTML() const;
 
 	// Drawing
-	void	DrawDiamond(CDC* dc, const CRect& rect);
-	void	DrawInheritanceArrow(CDC* dc);
-	void	DrawDirectionArrow(CDC* dc);
+	void	DrawDiamond(CDiagramRenderer* renderer, const CRect& rect);
+	void	DrawInheritanceArrow(CDiagramRenderer* renderer);
+	void	DrawDirectionArrow(CDiagramRenderer* renderer);
 	CPoint	GetStyleMarkerRect(int node, const CSize& size) const;
 
 };
@@ -8,7 +8,7 @@
 //
 #include "../DiagramEditor/DiagramPropertyDlg.h"
 #include "../resource.h"
-#include "ExListbox.h"
+#include "ExListBox.h"
 #include "PropertyContainer.h"
 
 /////////////////////////////////////////////////////////////////////////////
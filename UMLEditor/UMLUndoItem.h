@@ -17,6 +17,7 @@ public:
 
 	// Attributes
 	CString package;
+	CStringArray unloaded;	// Packages not read from their files
 
 };
 
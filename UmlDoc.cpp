@@ -20,6 +20,7 @@
 #endif
 
 #include "UmlDoc.h"
+#include "DiagramEditor/DiagramTrace.h"
 
 #include <propkey.h>
 
@@ -57,19 +58,80 @@ BOOL CUmlDoc::OnNewDocument()
 	return TRUE;
 }
 
+// Called when a document is opened. The path is needed
+// to find the package files of a manifest.
+BOOL CUmlDoc::OnOpenDocument(LPCTSTR lpszPathName)
+{
+	m_objs.SetProjectPath(lpszPathName);
+	return CDocument::OnOpenDocument(lpszPathName);
+}
+
+// Called when a document is saved. Package files are
+// written next to the manifest.
+BOOL CUmlDoc::OnSaveDocument(LPCTSTR lpszPathName)
+{
+	m_objs.MoveProject(lpszPathName);
+	return CDocument::OnSaveDocument(lpszPathName);
+}
+
+// Called to save the document. When there is no path, the
+// user picks the file and the format: a single file, or a
+// manifest with one file per package. Save keeps the format
+// the document was read or last saved with.
+BOOL CUmlDoc::DoSave(LPCTSTR lpszPathName, BOOL bReplace)
+{
+	if (lpszPathName)
+		return CDocument::DoSave(lpszPathName, bReplace);
+
+	CString filename = GetPathName();
+	if (filename.IsEmpty())
+		filename = GetTitle();
+
+	CFileDialog dlg(FALSE, _T("umldiagram"), filename, OFN_HIDEREADONLY | OFN_OVERWRITEPROMPT, _T("UML Diagram (*.umldiagram)|*.umldiagram|UML Diagram, one file per package (*.umldiagram)|*.umldiagram||"));
+	dlg.m_ofn.nFilterIndex = m_objs.HasPackageFiles() ? 2 : 1;
+	if (dlg.DoModal() != IDOK)
+		return FALSE;
+
+	BOOL packageFiles = m_objs.HasPackageFiles();
+	m_objs.SetPackageFiles(dlg.m_ofn.nFilterIndex == 2);
+	if (CDocument::DoSave(dlg.GetPathName(), bReplace))
+		return TRUE;
+
+	m_objs.SetPackageFiles(packageFiles);
+	return FALSE;
+}
+
 
 
 
 // CUmlDoc serialization
 
+// Predicate for the objects shown at the top level of the diagram.
+static BOOL IsTopLevel(CDiagramEntity* obj, LPVOID /*data*/)
+{
+	CUMLEntity* uml = dynamic_cast<CUMLEntity*>(obj);
+	return uml && uml->GetPackage().IsEmpty();
+}
+
 void CUmlDoc::Serialize(CArchive& ar)
 {
+	DIAGRAM_TRACE_SPAN(_T("CUmlDoc::Serialize"));
+
 	if (ar.IsStoring())
 	{
 		m_objs.Save(ar);
+
+		// The preview is written last, where it can be read without the diagram
+		m_thumbnail.Update(&m_objs, IsTopLevel);
+		m_thumbnail.WriteTrailer(ar);
 	}
 	else
 	{
+#ifdef SHARED_HANDLERS
+		// Thumbnail handlers only need the preview
+		if (m_bGetThumbnailMode && m_thumbnail.ReadTrailer(ar))
+			return;
+#endif // SHARED_HANDLERS
 		m_objs.Load(ar);
 	}
 }
@@ -79,22 +141,11 @@ void CUmlDoc::Serialize(CArchive& ar)
 // Support for thumbnails
 void CUmlDoc::OnDrawThumbnail(CDC& dc, LPRECT lprcBounds)
 {
-	// Modify this code to draw the document's data
-	dc.FillSolidRect(lprcBounds, RGB(255, 255, 255));
-
-	CString strText = _T("TODO: implement thumbnail drawing here");
-	LOGFONT lf;
-
-	CFont* pDefaultGUIFont = CFont::FromHandle((HFONT)GetStockObject(DEFAULT_GUI_FONT));
-	pDefaultGUIFont->GetLogFont(&lf);
-	lf.lfHeight = 36;
-
-	CFont fontDraw;
-	fontDraw.CreateFontIndirect(&lf);
+	// Older files have no preview, draw the diagram instead
+	if (m_thumbnail.IsEmpty())
+		m_thumbnail.Create(m_objs.GetData(), IsTopLevel);
 
-	CFont* pOldFont = dc.SelectObject(&fontDraw);
-	dc.DrawText(strText, lprcBounds, DT_CENTER | DT_WORDBREAK);
-	dc.SelectObject(pOldFont);
+	m_thumbnail.Draw(dc, lprcBounds);
 }
 
 // Support for Search Handlers
@@ -16,6 +16,7 @@
 #pragma once
 
 #include "UMLEditor/UMLEntityContainer.h"
+#include "DiagramEditor/DiagramThumbnail.h"
 
 class CUmlDoc : public CDocument
 {
@@ -32,6 +33,8 @@ public:
 	// Overrides
 public:
 	virtual BOOL OnNewDocument();
+	virtual BOOL OnOpenDocument(LPCTSTR lpszPathName);
+	virtual BOOL OnSaveDocument(LPCTSTR lpszPathName);
 	virtual void Serialize(CArchive& ar);
 #ifdef SHARED_HANDLERS
 	virtual void InitializeSearchContent();
@@ -39,6 +42,7 @@ public:
 #endif // SHARED_HANDLERS
 protected:
 	virtual BOOL SaveModified();
+	virtual BOOL DoSave(LPCTSTR lpszPathName, BOOL bReplace = TRUE);
 
 	// Implementation
 public:
@@ -62,4 +66,5 @@ protected:
 
 private:
 	CUMLEntityContainer m_objs;
+	CDiagramThumbnail m_thumbnail;
 };
@@ -77,8 +77,13 @@ BEGIN_MESSAGE_MAP(CUmlView, CDiagramView)
 	ON_UPDATE_COMMAND_UI(ID_PROPERTY, OnUpdateProperty)
 	ON_COMMAND(ID_IMPORT, OnImport)
 	ON_UPDATE_COMMAND_UI(ID_IMPORT, OnUpdateImport)
+	ON_COMMAND(ID_IMPORT_FOLDER, OnImportFolder)
 	ON_COMMAND(ID_UML_OPEN_PACKAGE, OnOpenPackage)
 	ON_UPDATE_COMMAND_UI(ID_UML_OPEN_PACKAGE, OnUpdateOpenPackage)
+	ON_COMMAND(ID_AUTO_LAYOUT, OnAutoLayout)
+	ON_UPDATE_COMMAND_UI(ID_AUTO_LAYOUT, OnUpdateExport)
+	ON_COMMAND(ID_ROUTE_LINKS, OnRouteLinks)
+	ON_UPDATE_COMMAND_UI(ID_ROUTE_LINKS, OnUpdateExport)
 	// Standard printing commands
 	ON_COMMAND(ID_FILE_PRINT, &CView::OnFilePrint)
 	ON_COMMAND(ID_FILE_PRINT_DIRECT, &CView::OnFilePrint)
@@ -440,6 +445,9 @@ void CUmlView::OnButtonDisplayProperties()
 	displayOptions = DISPLAY_ALL;
 	if (dlg.DoModal() == IDOK)
 	{
+		// Apply all the settings with a single redraw
+		m_editor.BeginTransaction();
+
 		// Check if we need to snapshot for undo
 		if (m_editor.GetBackgroundColor() != dlg.m_color)
 		{
@@ -477,7 +485,8 @@ void CUmlView::OnButtonDisplayProperties()
 		}
 
 		m_editor.SetDisplayOptions(displayOptions);
-		m_editor.RedrawWindow();
+		m_editor.RequestRedraw();
+		m_editor.CommitTransaction();
 	}
 }
 
@@ -487,6 +496,16 @@ void CUmlView::OnFlipLink()
 	m_editor.RedrawWindow();
 }
 
+void CUmlView::OnAutoLayout()
+{
+	m_editor.AutoLayout();
+}
+
+void CUmlView::OnRouteLinks()
+{
+	m_editor.RouteLinks();
+}
+
 void CUmlView::OnProperty()
 {
 	if (m_editor.GetSelectCount() == 1)
@@ -509,6 +528,11 @@ void CUmlView::OnImport()
 	m_editor.Import();
 }
 
+void CUmlView::OnImportFolder()
+{
+	m_editor.ImportFolder();
+}
+
 void CUmlView::OnOpenPackage()
 {
 	CUMLEntityPackage* package = dynamic_cast<CUMLEntityPackage*>(m_editor.GetSelectedObject());
@@ -87,8 +87,11 @@ protected:
 	afx_msg virtual void OnUpdateProperty(CCmdUI* pCmdUI);
 	afx_msg void OnImport();
 	afx_msg void OnUpdateImport(CCmdUI* pCmdUI);
+	afx_msg void OnImportFolder();
 	afx_msg void OnOpenPackage();
 	afx_msg void OnUpdateOpenPackage(CCmdUI* pCmdUI);
+	afx_msg void OnAutoLayout();
+	afx_msg void OnRouteLinks();
 	DECLARE_MESSAGE_MAP()
 
 private: